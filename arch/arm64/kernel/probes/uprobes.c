@@ -4,6 +4,7 @@
  */
 #include <linux/highmem.h>
 #include <linux/ptrace.h>
+#include <linux/uaccess.h>
 #include <linux/uprobes.h>
 #include <asm/cacheflush.h>
 
@@ -100,15 +101,53 @@ bool arch_uprobe_xol_was_trapped(struct task_struct *t)
 	return false;
 }
 
+/* stp x29, x30, [sp, #imm]! */
+#define UPROBE_STP_FP_LR_MASK	0xffc07fff
+#define UPROBE_STP_FP_LR	0xa9807bfd
+/* mov x29, sp */
+#define UPROBE_MOV_FP_SP	0x910003fd
+
+/*
+ * Function entry probes mostly sit on the frame record setup. Emulate those
+ * two instructions rather than stepping them out of line; fall back to
+ * stepping if the store to the user stack faults so that the fault is taken
+ * on the original instruction.
+ */
+static bool uprobe_emulate_prologue(probe_opcode_t insn, struct pt_regs *regs)
+{
+	unsigned long sp;
+	u64 frame[2];
+
+	if (insn == UPROBE_MOV_FP_SP) {
+		regs->regs[29] = regs->sp;
+	} else if ((insn & UPROBE_STP_FP_LR_MASK) == UPROBE_STP_FP_LR) {
+		if (!IS_ALIGNED(regs->sp, 16))
+			return false;
+
+		sp = regs->sp + sign_extend64((insn >> 15) & 0x7f, 6) * 8;
+		frame[0] = regs->regs[29];
+		frame[1] = regs->regs[30];
+		if (copy_to_user((void __user *)sp, frame, sizeof(frame)))
+			return false;
+		regs->sp = sp;
+	} else {
+		return false;
+	}
+
+	instruction_pointer_set(regs, instruction_pointer(regs) + 4);
+	return true;
+}
+
 bool arch_uprobe_skip_sstep(struct arch_uprobe *auprobe, struct pt_regs *regs)
 {
 	probe_opcode_t insn;
 	unsigned long addr;
 
+	insn = *(probe_opcode_t *)(&auprobe->insn[0]);
+
 	if (!auprobe->simulate)
-		return false;
+		return uprobe_emulate_prologue(insn, regs);
 
-	insn = *(probe_opcode_t *)(&auprobe->insn[0]);
 	addr = instruction_pointer(regs);
 
 	if (auprobe->api.handler)
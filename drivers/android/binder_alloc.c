@@ -236,6 +236,7 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 
 			on_lru = list_lru_del(&binder_alloc_lru, &page->lru);
 			WARN_ON(!on_lru);
+			alloc->pages_reused++;
 
 			trace_binder_alloc_lru_end(alloc, index);
 			continue;
@@ -266,6 +267,7 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 
 		if (index + 1 > alloc->pages_high)
 			alloc->pages_high = index + 1;
+		alloc->pages_installed++;
 
 		trace_binder_alloc_page_end(alloc, index);
 	}
@@ -309,6 +311,16 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 	return vma ? -ENOMEM : -ESRCH;
 }
 
+/*
+ * Lockless check used by the allocation path, the mmap lock is only taken
+ * when pages have to be installed, see binder_update_page_range().
+ */
+static inline bool binder_alloc_is_mapped(struct binder_alloc *alloc)
+{
+	/* pairs with smp_store_release() in binder_alloc_mmap_handler() */
+	return smp_load_acquire(&alloc->vma_addr);
+}
+
 static inline struct vm_area_struct *binder_alloc_get_vma(
 		struct binder_alloc *alloc)
 {
@@ -365,6 +377,8 @@ static bool debug_low_async_space_locked(struct binder_alloc *alloc, int pid)
 
 static struct binder_buffer *binder_alloc_new_buf_locked(
 				struct binder_alloc *alloc,
+				struct binder_buffer **new_buffer,
+				size_t size,
 				size_t data_size,
 				size_t offsets_size,
 				size_t extra_buffers_size,
@@ -377,35 +391,15 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	struct rb_node *best_fit = NULL;
 	void __user *has_page_addr;
 	void __user *end_page_addr;
-	size_t size, data_offsets_size;
 	int ret;
 
-	mmap_read_lock(alloc->mm);
-	if (!binder_alloc_get_vma(alloc)) {
-		mmap_read_unlock(alloc->mm);
+	if (!binder_alloc_is_mapped(alloc)) {
 		binder_alloc_debug(BINDER_DEBUG_USER_ERROR,
 				   "%d: binder_alloc_buf, no vma\n",
 				   alloc->pid);
 		return ERR_PTR(-ESRCH);
 	}
-	mmap_read_unlock(alloc->mm);
 
-	data_offsets_size = ALIGN(data_size, sizeof(void *)) +
-		ALIGN(offsets_size, sizeof(void *));
-
-	if (data_offsets_size < data_size || data_offsets_size < offsets_size) {
-		binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
-				"%d: got transaction with invalid size %zd-%zd\n",
-				alloc->pid, data_size, offsets_size);
-		return ERR_PTR(-EINVAL);
-	}
-	size = data_offsets_size + ALIGN(extra_buffers_size, sizeof(void *));
-	if (size < data_offsets_size || size < extra_buffers_size) {
-		binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
-				"%d: got transaction with invalid extra_buffers_size %zd\n",
-				alloc->pid, extra_buffers_size);
-		return ERR_PTR(-EINVAL);
-	}
 	if (is_async &&
 	    alloc->free_async_space < size + sizeof(struct binder_buffer)) {
 		binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
@@ -414,9 +408,6 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 		return ERR_PTR(-ENOSPC);
 	}
 
-	/* Pad 0-size buffers so they get assigned unique addresses */
-	size = max(size, sizeof(void *));
-
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(!buffer->free);
@@ -490,18 +481,14 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 		return ERR_PTR(ret);
 
 	if (buffer_size != size) {
-		struct binder_buffer *new_buffer;
-
-		new_buffer = kzalloc(sizeof(*buffer), GFP_KERNEL);
-		if (!new_buffer) {
-			pr_err("%s: %d failed to alloc new buffer struct\n",
-			       __func__, alloc->pid);
-			goto err_alloc_buf_struct_failed;
-		}
-		new_buffer->user_data = (u8 __user *)buffer->user_data + size;
-		list_add(&new_buffer->entry, &buffer->entry);
-		new_buffer->free = 1;
-		binder_insert_free_buffer(alloc, new_buffer);
+		struct binder_buffer *free_buffer = *new_buffer;
+
+		/* Consume the buffer struct preallocated by the caller */
+		*new_buffer = NULL;
+		free_buffer->user_data = (u8 __user *)buffer->user_data + size;
+		list_add(&free_buffer->entry, &buffer->entry);
+		free_buffer->free = 1;
+		binder_insert_free_buffer(alloc, free_buffer);
 	}
 
 	rb_erase(best_fit, &alloc->free_buffers);
@@ -534,12 +521,6 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 		}
 	}
 	return buffer;
-
-err_alloc_buf_struct_failed:
-	binder_update_page_range(alloc, 0, (void __user *)
-				 PAGE_ALIGN((uintptr_t)buffer->user_data),
-				 end_page_addr);
-	return ERR_PTR(-ENOMEM);
 }
 
 /**
@@ -556,6 +537,10 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
  * is the sum of the three given sizes (each rounded up to
  * pointer-sized boundary)
  *
+ * The size checks and the allocation of the struct binder_buffer that may be
+ * needed to split a free buffer are done before taking alloc->mutex, to keep
+ * the section that serializes all transactions to this proc short.
+ *
  * Return:	The allocated buffer or %NULL if error
  */
 struct binder_buffer *binder_alloc_new_buf(struct binder_alloc *alloc,
@@ -565,12 +550,45 @@ struct binder_buffer *binder_alloc_new_buf(struct binder_alloc *alloc,
 					   int is_async,
 					   int pid)
 {
-	struct binder_buffer *buffer;
+	struct binder_buffer *buffer, *new_buffer;
+	size_t size, data_offsets_size;
+
+	data_offsets_size = ALIGN(data_size, sizeof(void *)) +
+		ALIGN(offsets_size, sizeof(void *));
+
+	if (data_offsets_size < data_size || data_offsets_size < offsets_size) {
+		binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
+				"%d: got transaction with invalid size %zd-%zd\n",
+				alloc->pid, data_size, offsets_size);
+		return ERR_PTR(-EINVAL);
+	}
+	size = data_offsets_size + ALIGN(extra_buffers_size, sizeof(void *));
+	if (size < data_offsets_size || size < extra_buffers_size) {
+		binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
+				"%d: got transaction with invalid extra_buffers_size %zd\n",
+				alloc->pid, extra_buffers_size);
+		return ERR_PTR(-EINVAL);
+	}
+
+	/* Pad 0-size buffers so they get assigned unique addresses */
+	size = max(size, sizeof(void *));
+
+	new_buffer = kzalloc(sizeof(*new_buffer), GFP_KERNEL);
+	if (!new_buffer) {
+		pr_err("%s: %d failed to alloc new buffer struct\n",
+		       __func__, alloc->pid);
+		return ERR_PTR(-ENOMEM);
+	}
 
 	mutex_lock(&alloc->mutex);
-	buffer = binder_alloc_new_buf_locked(alloc, data_size, offsets_size,
+	buffer = binder_alloc_new_buf_locked(alloc, &new_buffer, size,
+					     data_size, offsets_size,
 					     extra_buffers_size, is_async, pid);
 	mutex_unlock(&alloc->mutex);
+
+	/* Not needed if the free buffer was used as a whole */
+	kfree(new_buffer);
+
 	return buffer;
 }
 
@@ -772,7 +790,9 @@ int binder_alloc_mmap_handler(struct binder_alloc *alloc,
 	buffer->free = 1;
 	binder_insert_free_buffer(alloc, buffer);
 	alloc->free_async_space = alloc->buffer_size / 2;
-	alloc->vma_addr = vma->vm_start;
+
+	/* Signal binder_alloc is fully initialized */
+	smp_store_release(&alloc->vma_addr, vma->vm_start);
 
 	return 0;
 
@@ -931,6 +951,8 @@ void binder_alloc_print_pages(struct seq_file *m,
 	mutex_unlock(&alloc->mutex);
 	seq_printf(m, "  pages: %d:%d:%d\n", active, lru, free);
 	seq_printf(m, "  pages high watermark: %zu\n", alloc->pages_high);
+	seq_printf(m, "  pages installed: %zu reused: %zu\n",
+		   alloc->pages_installed, alloc->pages_reused);
 }
 
 /**
@@ -962,7 +984,7 @@ int binder_alloc_get_allocated_count(struct binder_alloc *alloc)
  */
 void binder_alloc_vma_close(struct binder_alloc *alloc)
 {
-	alloc->vma_addr = 0;
+	WRITE_ONCE(alloc->vma_addr, 0);
 }
 
 /**
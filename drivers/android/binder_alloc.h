@@ -89,6 +89,9 @@ struct binder_lru_page {
  * @buffer_size:        size of address space specified via mmap
  * @pid:                pid for associated binder_proc (invariant after init)
  * @pages_high:         high watermark of offset in @pages
+ * @pages_installed:    number of pages allocated and mapped on demand
+ * @pages_reused:       number of times an allocation found its page still
+ *                      installed, taking it back from the shrinker LRU
  * @oneway_spam_detected: %true if oneway spam detection fired, clear that
  * flag once the async buffer has returned to a healthy state
  *
@@ -110,6 +113,8 @@ struct binder_alloc {
 	size_t buffer_size;
 	int pid;
 	size_t pages_high;
+	size_t pages_installed;
+	size_t pages_reused;
 	bool oneway_spam_detected;
 };
 
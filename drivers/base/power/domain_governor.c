@@ -343,7 +343,7 @@ static bool cpu_power_down_ok(struct dev_pm_domain *pd)
 {
 	struct generic_pm_domain *genpd = pd_to_genpd(pd);
 	struct cpuidle_device *dev;
-	ktime_t domain_wakeup, next_hrtimer;
+	ktime_t domain_wakeup, next_hrtimer, next_irq;
 	ktime_t now = ktime_get();
 	s64 idle_duration_ns;
 	int cpu, i;
@@ -359,6 +359,10 @@ static bool cpu_power_down_ok(struct dev_pm_domain *pd)
 	 * Find the next wakeup for any of the online CPUs within the PM domain
 	 * and its subdomains. Note, we only need the genpd->cpus, as it already
 	 * contains a mask of all CPUs from subdomains.
+	 *
+	 * Besides the next timer, take the predicted next interrupt of each CPU
+	 * into account if its cpuidle driver provides one. A prediction that is
+	 * already in the past is stale.
 	 */
 	domain_wakeup = ktime_set(KTIME_SEC_MAX, 0);
 	for_each_cpu_and(cpu, genpd->cpus, cpu_online_mask) {
@@ -367,6 +371,11 @@ static bool cpu_power_down_ok(struct dev_pm_domain *pd)
 			next_hrtimer = READ_ONCE(dev->next_hrtimer);
 			if (ktime_before(next_hrtimer, domain_wakeup))
 				domain_wakeup = next_hrtimer;
+
+			next_irq = READ_ONCE(dev->next_irq_event);
+			if (ktime_after(next_irq, now) &&
+			    ktime_before(next_irq, domain_wakeup))
+				domain_wakeup = next_irq;
 		}
 	}
 
@@ -77,6 +77,13 @@ enum {
 	NULL_IRQ_TIMER		= 2,
 };
 
+/* Completion time distributions for NULL_IRQ_TIMER */
+enum {
+	NULL_LAT_FIXED		= 0,
+	NULL_LAT_NORMAL		= 1,
+	NULL_LAT_LONGTAIL	= 2,
+};
+
 static bool g_virt_boundary = false;
 module_param_named(virt_boundary, g_virt_boundary, bool, 0444);
 MODULE_PARM_DESC(virt_boundary, "Require a virtual boundary for the device. Default: False");
@@ -403,6 +410,14 @@ static int nullb_apply_poll_queues(struct nullb_device *dev,
 
 NULLB_DEVICE_ATTR(size, ulong, NULL);
 NULLB_DEVICE_ATTR(completion_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(read_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(write_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(zone_mgmt_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(qd_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(latency_dist, uint, NULL);
+NULLB_DEVICE_ATTR(latency_spread_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(latency_tail_pct, uint, NULL);
+NULLB_DEVICE_ATTR(latency_seed, uint, NULL);
 NULLB_DEVICE_ATTR(submit_queues, uint, nullb_apply_submit_queues);
 NULLB_DEVICE_ATTR(poll_queues, uint, nullb_apply_poll_queues);
 NULLB_DEVICE_ATTR(home_node, uint, NULL);
@@ -526,6 +541,14 @@ CONFIGFS_ATTR(nullb_device_, badblocks);
 static struct configfs_attribute *nullb_device_attrs[] = {
 	&nullb_device_attr_size,
 	&nullb_device_attr_completion_nsec,
+	&nullb_device_attr_read_nsec,
+	&nullb_device_attr_write_nsec,
+	&nullb_device_attr_zone_mgmt_nsec,
+	&nullb_device_attr_qd_nsec,
+	&nullb_device_attr_latency_dist,
+	&nullb_device_attr_latency_spread_nsec,
+	&nullb_device_attr_latency_tail_pct,
+	&nullb_device_attr_latency_seed,
 	&nullb_device_attr_submit_queues,
 	&nullb_device_attr_poll_queues,
 	&nullb_device_attr_home_node,
@@ -610,11 +633,13 @@ static ssize_t memb_group_features_show(struct config_item *item, char *page)
 	return snprintf(page, PAGE_SIZE,
 			"badblocks,blocking,blocksize,cache_size,"
 			"completion_nsec,discard,home_node,hw_queue_depth,"
-			"irqmode,max_sectors,mbps,memory_backed,no_sched,"
-			"poll_queues,power,queue_mode,shared_tag_bitmap,size,"
-			"submit_queues,use_per_node_hctx,virt_boundary,zoned,"
-			"zone_capacity,zone_max_active,zone_max_open,"
-			"zone_nr_conv,zone_size\n");
+			"irqmode,latency_dist,latency_seed,"
+			"latency_spread_nsec,latency_tail_pct,max_sectors,"
+			"mbps,memory_backed,no_sched,poll_queues,power,"
+			"qd_nsec,queue_mode,read_nsec,shared_tag_bitmap,size,"
+			"submit_queues,use_per_node_hctx,virt_boundary,"
+			"write_nsec,zoned,zone_capacity,zone_max_active,"
+			"zone_max_open,zone_mgmt_nsec,zone_nr_conv,zone_size\n");
 }
 
 CONFIGFS_ATTR_RO(memb_group_, features);
@@ -793,14 +818,84 @@ static void end_cmd(struct nullb_cmd *cmd)
 
 static enum hrtimer_restart null_cmd_timer_expired(struct hrtimer *timer)
 {
-	end_cmd(container_of(timer, struct nullb_cmd, timer));
+	struct nullb_cmd *cmd = container_of(timer, struct nullb_cmd, timer);
+
+	atomic_dec(&cmd->nq->nr_timer_inflight);
+	end_cmd(cmd);
 
 	return HRTIMER_NORESTART;
 }
 
+/*
+ * Approximates a standard normal deviate scaled by 2^16 as the sum of twelve
+ * uniform variables minus their mean.
+ */
+static s64 null_rand_normal(struct nullb_queue *nq)
+{
+	s64 sum = 0;
+	int i;
+
+	for (i = 0; i < 12; i++)
+		sum += prandom_u32_state(&nq->rnd) >> 16;
+
+	return sum - 6 * 65536;
+}
+
+/*
+ * Computes the completion time of a command in timer mode: a per operation
+ * base time, a penalty for every other command in flight on the queue and a
+ * random component drawn from the configured distribution. The random
+ * sequence only depends on latency_seed, so runs are reproducible.
+ */
+static u64 null_cmd_latency(struct nullb_cmd *cmd, unsigned int inflight)
+{
+	struct nullb_queue *nq = cmd->nq;
+	struct nullb_device *dev = nq->dev;
+	u64 lat = dev->completion_nsec;
+	enum req_op op;
+	s64 delta;
+
+	if (dev->queue_mode == NULL_Q_MQ)
+		op = req_op(cmd->rq);
+	else
+		op = bio_op(cmd->bio);
+
+	if (op == REQ_OP_READ && dev->read_nsec)
+		lat = dev->read_nsec;
+	else if ((op == REQ_OP_WRITE || op == REQ_OP_ZONE_APPEND) &&
+		 dev->write_nsec)
+		lat = dev->write_nsec;
+	else if (op_is_zone_mgmt(op) && dev->zone_mgmt_nsec)
+		lat = dev->zone_mgmt_nsec;
+
+	lat += (u64)dev->qd_nsec * inflight;
+
+	switch (dev->latency_dist) {
+	case NULL_LAT_NORMAL:
+		spin_lock(&nq->rnd_lock);
+		delta = null_rand_normal(nq);
+		spin_unlock(&nq->rnd_lock);
+		delta = div_s64(delta * (s64)dev->latency_spread_nsec, 65536);
+		if (delta < 0 && -delta >= lat)
+			lat = 0;
+		else
+			lat += delta;
+		break;
+	case NULL_LAT_LONGTAIL:
+		spin_lock(&nq->rnd_lock);
+		if (prandom_u32_state(&nq->rnd) % 100 < dev->latency_tail_pct)
+			lat += dev->latency_spread_nsec;
+		spin_unlock(&nq->rnd_lock);
+		break;
+	}
+
+	return lat;
+}
+
 static void null_cmd_end_timer(struct nullb_cmd *cmd)
 {
-	ktime_t kt = cmd->nq->dev->completion_nsec;
+	unsigned int inflight = atomic_inc_return(&cmd->nq->nr_timer_inflight);
+	ktime_t kt = null_cmd_latency(cmd, inflight - 1);
 
 	hrtimer_start(&cmd->timer, kt, HRTIMER_MODE_REL);
 }
@@ -1716,6 +1811,10 @@ static void null_init_queue(struct nullb *nullb, struct nullb_queue *nq)
 	nq->dev = nullb->dev;
 	INIT_LIST_HEAD(&nq->poll_list);
 	spin_lock_init(&nq->poll_lock);
+	atomic_set(&nq->nr_timer_inflight, 0);
+	spin_lock_init(&nq->rnd_lock);
+	prandom_seed_state(&nq->rnd,
+			   nullb->dev->latency_seed + (nq - nullb->queues));
 }
 
 static int null_init_hctx(struct blk_mq_hw_ctx *hctx, void *driver_data,
@@ -1963,6 +2062,9 @@ static int null_validate_conf(struct nullb_device *dev)
 
 	dev->queue_mode = min_t(unsigned int, dev->queue_mode, NULL_Q_MQ);
 	dev->irqmode = min_t(unsigned int, dev->irqmode, NULL_IRQ_TIMER);
+	dev->latency_dist = min_t(unsigned int, dev->latency_dist,
+				  NULL_LAT_LONGTAIL);
+	dev->latency_tail_pct = min_t(unsigned int, dev->latency_tail_pct, 100);
 
 	/* Do memory allocation, so set blocking */
 	if (dev->memory_backed)
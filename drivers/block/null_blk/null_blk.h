@@ -14,6 +14,7 @@
 #include <linux/fault-inject.h>
 #include <linux/spinlock.h>
 #include <linux/mutex.h>
+#include <linux/prandom.h>
 
 struct nullb_cmd {
 	union {
@@ -37,6 +38,11 @@ struct nullb_queue {
 	struct list_head poll_list;
 	spinlock_t poll_lock;
 
+	/* Timer mode latency model state */
+	atomic_t nr_timer_inflight;
+	spinlock_t rnd_lock;
+	struct rnd_state rnd;
+
 	struct nullb_cmd *cmds;
 };
 
@@ -88,6 +94,14 @@ struct nullb_device {
 
 	unsigned long size; /* device size in MB */
 	unsigned long completion_nsec; /* time in ns to complete a request */
+	unsigned long read_nsec; /* completion time of reads, if non-zero */
+	unsigned long write_nsec; /* completion time of writes, if non-zero */
+	unsigned long zone_mgmt_nsec; /* completion time of zone management */
+	unsigned long qd_nsec; /* extra time per command in flight */
+	unsigned long latency_spread_nsec; /* std deviation or tail latency */
+	unsigned int latency_dist; /* completion time distribution */
+	unsigned int latency_tail_pct; /* percentage of long-tail commands */
+	unsigned int latency_seed; /* seed of the latency distribution */
 	unsigned long cache_size; /* disk cache size in MB */
 	unsigned long zone_size; /* zone size in MB if device is zoned */
 	unsigned long zone_capacity; /* zone capacity in MB if device is zoned */
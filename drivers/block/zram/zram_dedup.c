@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Content based deduplication of zram compressed objects.
+ *
+ * Every compressed object stored while deduplication is enabled is tracked
+ * by an entry that is hashed twice: by the checksum of its compressed data,
+ * so that writes of identical content can find and share it, and by its
+ * zsmalloc handle, so that zram_free_page() can drop its reference.
+ */
+
+#include <linux/hash.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/xxhash.h>
+#include <linux/zsmalloc.h>
+
+#include "zram_drv.h"
+#include "zram_dedup.h"
+
+struct zram_dedup_entry {
+	struct hlist_node csum_node;
+	struct hlist_node handle_node;
+	unsigned long handle;
+	unsigned int len;
+	u32 checksum;
+	/* number of slots sharing the handle, protected by dedup->lock */
+	unsigned int refcount;
+};
+
+struct zram_dedup {
+	spinlock_t lock;
+	unsigned int bits;
+	struct hlist_head *csum_heads;
+	struct hlist_head *handle_heads;
+};
+
+u32 zram_dedup_checksum(void *mem, unsigned int len)
+{
+	return xxh32(mem, len, 0);
+}
+
+bool zram_dedup_enabled(struct zram *zram)
+{
+	return zram->dedup;
+}
+
+/*
+ * Returns the handle of an object whose compressed data equals @mem and
+ * takes a reference on it, or 0 if there is none.
+ */
+unsigned long zram_dedup_find(struct zram *zram, u32 checksum,
+			      void *mem, unsigned int len)
+{
+	struct zram_dedup *dedup = zram->dedup;
+	struct zram_dedup_entry *entry;
+	unsigned long handle = 0;
+	bool match;
+	void *obj;
+
+	spin_lock(&dedup->lock);
+	hlist_for_each_entry(entry,
+			     &dedup->csum_heads[hash_32(checksum, dedup->bits)],
+			     csum_node) {
+		if (entry->checksum != checksum || entry->len != len)
+			continue;
+
+		obj = zs_map_object(zram->mem_pool, entry->handle, ZS_MM_RO);
+		match = !memcmp(obj, mem, len);
+		zs_unmap_object(zram->mem_pool, entry->handle);
+		if (match) {
+			entry->refcount++;
+			handle = entry->handle;
+			break;
+		}
+	}
+	spin_unlock(&dedup->lock);
+
+	return handle;
+}
+
+/*
+ * Starts tracking a newly stored object. Returns false if no entry could be
+ * allocated, in which case the object is simply not shared.
+ */
+bool zram_dedup_insert(struct zram *zram, u32 checksum,
+		       unsigned long handle, unsigned int len)
+{
+	struct zram_dedup *dedup = zram->dedup;
+	struct zram_dedup_entry *entry;
+
+	entry = kmalloc(sizeof(*entry), GFP_NOIO | __GFP_NOWARN);
+	if (!entry)
+		return false;
+
+	entry->handle = handle;
+	entry->len = len;
+	entry->checksum = checksum;
+	entry->refcount = 1;
+
+	spin_lock(&dedup->lock);
+	hlist_add_head(&entry->csum_node,
+		       &dedup->csum_heads[hash_32(checksum, dedup->bits)]);
+	hlist_add_head(&entry->handle_node,
+		       &dedup->handle_heads[hash_long(handle, dedup->bits)]);
+	spin_unlock(&dedup->lock);
+
+	return true;
+}
+
+/*
+ * Drops a reference on a tracked object. Returns true if it was the last
+ * one and the caller has to free the handle.
+ */
+bool zram_dedup_put(struct zram *zram, unsigned long handle)
+{
+	struct zram_dedup *dedup = zram->dedup;
+	struct zram_dedup_entry *entry;
+
+	spin_lock(&dedup->lock);
+	hlist_for_each_entry(entry,
+			     &dedup->handle_heads[hash_long(handle, dedup->bits)],
+			     handle_node) {
+		if (entry->handle != handle)
+			continue;
+
+		if (--entry->refcount) {
+			spin_unlock(&dedup->lock);
+			return false;
+		}
+
+		hlist_del(&entry->csum_node);
+		hlist_del(&entry->handle_node);
+		spin_unlock(&dedup->lock);
+		kfree(entry);
+		return true;
+	}
+	spin_unlock(&dedup->lock);
+
+	WARN_ON_ONCE(1);
+	return true;
+}
+
+/*
+ * Returns true if more than one slot currently references a tracked object.
+ * The answer can go stale as soon as the lock is dropped, which is fine for
+ * callers that only use it to skip work: a slot that replaces its object
+ * drops its reference through zram_dedup_put() either way.
+ */
+bool zram_dedup_shared(struct zram *zram, unsigned long handle)
+{
+	struct zram_dedup *dedup = zram->dedup;
+	struct zram_dedup_entry *entry;
+	bool shared = false;
+
+	spin_lock(&dedup->lock);
+	hlist_for_each_entry(entry,
+			     &dedup->handle_heads[hash_long(handle, dedup->bits)],
+			     handle_node) {
+		if (entry->handle == handle) {
+			shared = entry->refcount > 1;
+			break;
+		}
+	}
+	spin_unlock(&dedup->lock);
+
+	return shared;
+}
+
+int zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	struct zram_dedup *dedup;
+
+	if (!zram->use_dedup)
+		return 0;
+
+	dedup = kzalloc(sizeof(*dedup), GFP_KERNEL);
+	if (!dedup)
+		return -ENOMEM;
+
+	/* One bucket for every four pages of disk size */
+	dedup->bits = ilog2(roundup_pow_of_two(max_t(size_t, num_pages / 4, 1)));
+	dedup->csum_heads = kvcalloc(1UL << dedup->bits,
+				     sizeof(*dedup->csum_heads), GFP_KERNEL);
+	dedup->handle_heads = kvcalloc(1UL << dedup->bits,
+				       sizeof(*dedup->handle_heads), GFP_KERNEL);
+	if (!dedup->csum_heads || !dedup->handle_heads) {
+		kvfree(dedup->csum_heads);
+		kvfree(dedup->handle_heads);
+		kfree(dedup);
+		return -ENOMEM;
+	}
+
+	spin_lock_init(&dedup->lock);
+	zram->dedup = dedup;
+
+	return 0;
+}
+
+/*
+ * Must be called after all slots have been freed, when no entry should be
+ * left.
+ */
+void zram_dedup_fini(struct zram *zram)
+{
+	struct zram_dedup *dedup = zram->dedup;
+	struct zram_dedup_entry *entry;
+	struct hlist_node *tmp;
+	unsigned long i;
+
+	if (!dedup)
+		return;
+
+	for (i = 0; i < 1UL << dedup->bits; i++) {
+		hlist_for_each_entry_safe(entry, tmp, &dedup->csum_heads[i],
+					  csum_node) {
+			WARN_ON_ONCE(1);
+			kfree(entry);
+		}
+	}
+
+	kvfree(dedup->csum_heads);
+	kvfree(dedup->handle_heads);
+	kfree(dedup);
+	zram->dedup = NULL;
+}
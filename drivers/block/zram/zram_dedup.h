@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Content based deduplication of zram compressed objects.
+ */
+
+#ifndef _ZRAM_DEDUP_H_
+#define _ZRAM_DEDUP_H_
+
+struct zram;
+
+#ifdef CONFIG_ZRAM_DEDUP
+u32 zram_dedup_checksum(void *mem, unsigned int len);
+unsigned long zram_dedup_find(struct zram *zram, u32 checksum,
+			      void *mem, unsigned int len);
+bool zram_dedup_insert(struct zram *zram, u32 checksum,
+		       unsigned long handle, unsigned int len);
+bool zram_dedup_put(struct zram *zram, unsigned long handle);
+bool zram_dedup_shared(struct zram *zram, unsigned long handle);
+bool zram_dedup_enabled(struct zram *zram);
+int zram_dedup_init(struct zram *zram, size_t num_pages);
+void zram_dedup_fini(struct zram *zram);
+#else
+static inline u32 zram_dedup_checksum(void *mem, unsigned int len)
+{
+	return 0;
+}
+static inline unsigned long zram_dedup_find(struct zram *zram, u32 checksum,
+					    void *mem, unsigned int len)
+{
+	return 0;
+}
+static inline bool zram_dedup_insert(struct zram *zram, u32 checksum,
+				     unsigned long handle, unsigned int len)
+{
+	return false;
+}
+static inline bool zram_dedup_put(struct zram *zram, unsigned long handle)
+{
+	return true;
+}
+static inline bool zram_dedup_shared(struct zram *zram, unsigned long handle)
+{
+	return false;
+}
+static inline bool zram_dedup_enabled(struct zram *zram) { return false; }
+static inline int zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	return 0;
+}
+static inline void zram_dedup_fini(struct zram *zram) {}
+#endif
+
+#endif /* _ZRAM_DEDUP_H_ */
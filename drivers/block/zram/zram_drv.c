@@ -35,6 +35,7 @@
 #include <linux/part_stat.h>
 
 #include "zram_drv.h"
+#include "zram_dedup.h"
 
 static DEFINE_IDR(zram_index_idr);
 /* idr index must be protected */
@@ -634,18 +635,99 @@ static int read_from_bdev_async(struct zram *zram, struct bio_vec *bvec,
 #define IDLE_WRITEBACK (1<<1)
 
 
+/*
+ * Maximum number of pages that writeback_store() keeps in flight. Slots of a
+ * batch get consecutive backing blocks, so the writes can be merged under the
+ * plug and later swap readahead of neighbouring slots reads contiguous blocks.
+ */
+#define ZRAM_WB_BATCH 32
+
+struct zram_wb_req {
+	unsigned long blk_idx;
+	u32 index;
+	struct page *page;
+	struct bio bio;
+	struct bio_vec bio_vec;
+};
+
+struct zram_wb_ctl {
+	atomic_t inflight;
+	wait_queue_head_t wait;
+};
+
+static void zram_wb_end_io(struct bio *bio)
+{
+	struct zram_wb_ctl *ctl = bio->bi_private;
+
+	if (atomic_dec_and_test(&ctl->inflight))
+		wake_up(&ctl->wait);
+}
+
+static void zram_wb_limit_refund(struct zram *zram)
+{
+	spin_lock(&zram->wb_limit_lock);
+	if (zram->wb_limit_enable)
+		zram->bd_wb_limit += 1UL << (PAGE_SHIFT - 12);
+	spin_unlock(&zram->wb_limit_lock);
+}
+
+static int zram_wb_complete(struct zram *zram, struct zram_wb_req *req)
+{
+	u32 index = req->index;
+	int err = blk_status_to_errno(req->bio.bi_status);
+
+	zram_slot_lock(zram, index);
+	if (err) {
+		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+		zram_clear_flag(zram, index, ZRAM_IDLE);
+		goto out;
+	}
+
+	atomic64_inc(&zram->stats.bd_writes);
+	/*
+	 * We released zram_slot_lock so need to check if the slot was
+	 * changed. If there is freeing for the slot, we can catch it
+	 * easily by zram_allocated.
+	 * A subtle case is the slot is freed/reallocated/marked as
+	 * ZRAM_IDLE again. To close the race, idle_store doesn't
+	 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
+	 * Thus, we could close the race by checking ZRAM_IDLE bit.
+	 */
+	if (!zram_allocated(zram, index) ||
+		  !zram_test_flag(zram, index, ZRAM_IDLE)) {
+		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+		zram_clear_flag(zram, index, ZRAM_IDLE);
+		goto out;
+	}
+
+	zram_free_page(zram, index);
+	zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+	zram_set_flag(zram, index, ZRAM_WB);
+	zram_set_element(zram, index, req->blk_idx);
+	req->blk_idx = 0;
+	atomic64_inc(&zram->stats.pages_stored);
+	zram_slot_unlock(zram, index);
+	return 0;
+out:
+	zram_slot_unlock(zram, index);
+	/* The block is reused by the next batch */
+	zram_wb_limit_refund(zram);
+	return err;
+}
+
 static ssize_t writeback_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
 	struct zram *zram = dev_to_zram(dev);
 	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
 	unsigned long index = 0;
-	struct bio bio;
-	struct bio_vec bio_vec;
-	struct page *page;
+	struct zram_wb_req *reqs;
+	struct zram_wb_ctl ctl;
+	struct blk_plug plug;
+	unsigned int batch, nr_reqs, i;
 	ssize_t ret = len;
 	int mode, err;
-	unsigned long blk_idx = 0;
+	bool done = false;
 
 	if (sysfs_streq(buf, "idle"))
 		mode = IDLE_WRITEBACK;
@@ -676,125 +758,133 @@ static ssize_t writeback_store(struct device *dev,
 		goto release_init_lock;
 	}
 
-	page = alloc_page(GFP_KERNEL);
-	if (!page) {
+	batch = min_t(unsigned long, nr_pages, ZRAM_WB_BATCH);
+	reqs = kcalloc(batch, sizeof(*reqs), GFP_KERNEL);
+	if (!reqs) {
 		ret = -ENOMEM;
 		goto release_init_lock;
 	}
 
-	for (; nr_pages != 0; index++, nr_pages--) {
-		struct bio_vec bvec;
-
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
-
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && !zram->bd_wb_limit) {
-			spin_unlock(&zram->wb_limit_lock);
-			ret = -EIO;
-			break;
+	for (i = 0; i < batch; i++) {
+		reqs[i].page = alloc_page(GFP_KERNEL);
+		if (!reqs[i].page) {
+			ret = -ENOMEM;
+			goto free_reqs;
 		}
-		spin_unlock(&zram->wb_limit_lock);
+	}
 
-		if (!blk_idx) {
-			blk_idx = alloc_block_bdev(zram);
-			if (!blk_idx) {
-				ret = -ENOSPC;
+	atomic_set(&ctl.inflight, 0);
+	init_waitqueue_head(&ctl.wait);
+
+	while (nr_pages != 0 && !done) {
+		nr_reqs = 0;
+		blk_start_plug(&plug);
+		for (; nr_pages != 0 && nr_reqs < batch; index++, nr_pages--) {
+			struct zram_wb_req *req = &reqs[nr_reqs];
+			struct bio_vec bvec;
+
+			bvec.bv_page = req->page;
+			bvec.bv_len = PAGE_SIZE;
+			bvec.bv_offset = 0;
+
+			spin_lock(&zram->wb_limit_lock);
+			if (zram->wb_limit_enable && !zram->bd_wb_limit) {
+				spin_unlock(&zram->wb_limit_lock);
+				ret = -EIO;
+				done = true;
 				break;
 			}
-		}
-
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index))
-			goto next;
+			spin_unlock(&zram->wb_limit_lock);
 
-		if (zram_test_flag(zram, index, ZRAM_WB) ||
-				zram_test_flag(zram, index, ZRAM_SAME) ||
-				zram_test_flag(zram, index, ZRAM_UNDER_WB))
-			goto next;
+			if (!req->blk_idx) {
+				req->blk_idx = alloc_block_bdev(zram);
+				if (!req->blk_idx) {
+					ret = -ENOSPC;
+					done = true;
+					break;
+				}
+			}
 
-		if (mode & IDLE_WRITEBACK &&
-			  !zram_test_flag(zram, index, ZRAM_IDLE))
-			goto next;
-		if (mode & HUGE_WRITEBACK &&
-			  !zram_test_flag(zram, index, ZRAM_HUGE))
-			goto next;
-		/*
-		 * Clearing ZRAM_UNDER_WB is duty of caller.
-		 * IOW, zram_free_page never clear it.
-		 */
-		zram_set_flag(zram, index, ZRAM_UNDER_WB);
-		/* Need for hugepage writeback racing */
-		zram_set_flag(zram, index, ZRAM_IDLE);
-		zram_slot_unlock(zram, index);
-		if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
 			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
+			if (!zram_allocated(zram, index))
+				goto next;
+
+			if (zram_test_flag(zram, index, ZRAM_WB) ||
+			    zram_test_flag(zram, index, ZRAM_SAME) ||
+			    zram_test_flag(zram, index, ZRAM_UNDER_WB))
+				goto next;
+
+			if (mode & IDLE_WRITEBACK &&
+				  !zram_test_flag(zram, index, ZRAM_IDLE))
+				goto next;
+			if (mode & HUGE_WRITEBACK &&
+				  !zram_test_flag(zram, index, ZRAM_HUGE))
+				goto next;
+			/*
+			 * Clearing ZRAM_UNDER_WB is duty of caller.
+			 * IOW, zram_free_page never clear it.
+			 */
+			zram_set_flag(zram, index, ZRAM_UNDER_WB);
+			/* Need for hugepage writeback racing */
+			zram_set_flag(zram, index, ZRAM_IDLE);
 			zram_slot_unlock(zram, index);
+			if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
+				zram_slot_lock(zram, index);
+				zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+				zram_clear_flag(zram, index, ZRAM_IDLE);
+				zram_slot_unlock(zram, index);
+				continue;
+			}
+
+			/* Charge the limit now, zram_wb_complete refunds it */
+			spin_lock(&zram->wb_limit_lock);
+			if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
+				zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
+			spin_unlock(&zram->wb_limit_lock);
+
+			req->index = index;
+			bio_init(&req->bio, zram->bdev, &req->bio_vec, 1,
+				 REQ_OP_WRITE);
+			req->bio.bi_iter.bi_sector =
+				req->blk_idx * (PAGE_SIZE >> 9);
+			req->bio.bi_end_io = zram_wb_end_io;
+			req->bio.bi_private = &ctl;
+			bio_add_page(&req->bio, bvec.bv_page, bvec.bv_len,
+					bvec.bv_offset);
+
+			atomic_inc(&ctl.inflight);
+			submit_bio(&req->bio);
+			nr_reqs++;
 			continue;
+next:
+			zram_slot_unlock(zram, index);
 		}
+		blk_finish_plug(&plug);
 
-		bio_init(&bio, zram->bdev, &bio_vec, 1,
-			 REQ_OP_WRITE | REQ_SYNC);
-		bio.bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
+		wait_event(ctl.wait, !atomic_read(&ctl.inflight));
 
-		bio_add_page(&bio, bvec.bv_page, bvec.bv_len,
-				bvec.bv_offset);
-		/*
-		 * XXX: A single page IO would be inefficient for write
-		 * but it would be not bad as starter.
-		 */
-		err = submit_bio_wait(&bio);
-		if (err) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
+		for (i = 0; i < nr_reqs; i++) {
 			/*
 			 * Return last IO error unless every IO were
 			 * not suceeded.
 			 */
-			ret = err;
-			continue;
+			err = zram_wb_complete(zram, &reqs[i]);
+			if (err)
+				ret = err;
+			bio_uninit(&reqs[i].bio);
 		}
 
-		atomic64_inc(&zram->stats.bd_writes);
-		/*
-		 * We released zram_slot_lock so need to check if the slot was
-		 * changed. If there is freeing for the slot, we can catch it
-		 * easily by zram_allocated.
-		 * A subtle case is the slot is freed/reallocated/marked as
-		 * ZRAM_IDLE again. To close the race, idle_store doesn't
-		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
-		 * Thus, we could close the race by checking ZRAM_IDLE bit.
-		 */
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index) ||
-			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			goto next;
-		}
-
-		zram_free_page(zram, index);
-		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-		zram_set_flag(zram, index, ZRAM_WB);
-		zram_set_element(zram, index, blk_idx);
-		blk_idx = 0;
-		atomic64_inc(&zram->stats.pages_stored);
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
-			zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
-		spin_unlock(&zram->wb_limit_lock);
-next:
-		zram_slot_unlock(zram, index);
+		cond_resched();
 	}
 
-	if (blk_idx)
-		free_block_bdev(zram, blk_idx);
-	__free_page(page);
+free_reqs:
+	for (i = 0; i < batch; i++) {
+		if (reqs[i].blk_idx)
+			free_block_bdev(zram, reqs[i].blk_idx);
+		if (reqs[i].page)
+			__free_page(reqs[i].page);
+	}
+	kfree(reqs);
 release_init_lock:
 	up_read(&zram->init_lock);
 
@@ -1041,6 +1131,42 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return len;
 }
 
+#ifdef CONFIG_ZRAM_DEDUP
+static ssize_t use_dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	down_read(&zram->init_lock);
+	val = zram->use_dedup;
+	up_read(&zram->init_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", val);
+}
+
+static ssize_t use_dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (kstrtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dedup usage for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->use_dedup = val;
+	up_write(&zram->init_lock);
+	return len;
+}
+#endif
+
 static ssize_t compact_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
@@ -1097,7 +1223,7 @@ static ssize_t mm_stat_show(struct device *dev,
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
 
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu\n",
+			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu %8llu\n",
 			orig_size << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.compr_data_size),
 			mem_used << PAGE_SHIFT,
@@ -1106,7 +1232,8 @@ static ssize_t mm_stat_show(struct device *dev,
 			(u64)atomic64_read(&zram->stats.same_pages),
 			atomic_long_read(&pool_stats.pages_compacted),
 			(u64)atomic64_read(&zram->stats.huge_pages),
-			(u64)atomic64_read(&zram->stats.huge_pages_since));
+			(u64)atomic64_read(&zram->stats.huge_pages_since),
+			(u64)atomic64_read(&zram->stats.dup_data_size));
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1205,6 +1332,9 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (zram_test_flag(zram, index, ZRAM_IDLE))
 		zram_clear_flag(zram, index, ZRAM_IDLE);
 
+	zram_clear_flag(zram, index, ZRAM_RECOMP);
+	zram_clear_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+
 	if (zram_test_flag(zram, index, ZRAM_HUGE)) {
 		zram_clear_flag(zram, index, ZRAM_HUGE);
 		atomic64_dec(&zram->stats.huge_pages);
@@ -1230,6 +1360,16 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (!handle)
 		return;
 
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		/* Other slots still share the object */
+		if (!zram_dedup_put(zram, handle)) {
+			atomic64_sub(zram_get_obj_size(zram, index),
+					&zram->stats.dup_data_size);
+			goto out;
+		}
+	}
+
 	zs_free(zram->mem_pool, handle);
 
 	atomic64_sub(zram_get_obj_size(zram, index),
@@ -1242,32 +1382,29 @@ static void zram_free_page(struct zram *zram, size_t index)
 		~(1UL << ZRAM_LOCK | 1UL << ZRAM_UNDER_WB));
 }
 
-static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
-				struct bio *bio, bool partial_io)
+static struct zcomp *zram_slot_comp(struct zram *zram, u32 index)
+{
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram_test_flag(zram, index, ZRAM_RECOMP))
+		return zram->recomp;
+#endif
+	return zram->comp;
+}
+
+/*
+ * Reads a page that is stored in the zsmalloc pool or is same element
+ * filled. The caller must hold the slot lock of @index.
+ */
+static int zram_read_from_zspool(struct zram *zram, struct page *page,
+				 u32 index)
 {
 	struct zcomp_strm *zstrm;
+	struct zcomp *comp;
 	unsigned long handle;
 	unsigned int size;
 	void *src, *dst;
 	int ret;
 
-	zram_slot_lock(zram, index);
-	if (zram_test_flag(zram, index, ZRAM_WB)) {
-		struct bio_vec bvec;
-
-		zram_slot_unlock(zram, index);
-		/* A null bio means rw_page was used, we must fallback to bio */
-		if (!bio)
-			return -EOPNOTSUPP;
-
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
-		return read_from_bdev(zram, &bvec,
-				zram_get_element(zram, index),
-				bio, partial_io);
-	}
-
 	handle = zram_get_handle(zram, index);
 	if (!handle || zram_test_flag(zram, index, ZRAM_SAME)) {
 		unsigned long value;
@@ -1277,14 +1414,14 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		mem = kmap_atomic(page);
 		zram_fill_page(mem, PAGE_SIZE, value);
 		kunmap_atomic(mem);
-		zram_slot_unlock(zram, index);
 		return 0;
 	}
 
 	size = zram_get_obj_size(zram, index);
+	comp = zram_slot_comp(zram, index);
 
 	if (size != PAGE_SIZE)
-		zstrm = zcomp_stream_get(zram->comp);
+		zstrm = zcomp_stream_get(comp);
 
 	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
 	if (size == PAGE_SIZE) {
@@ -1296,9 +1433,36 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		zcomp_stream_put(comp);
 	}
 	zs_unmap_object(zram->mem_pool, handle);
+
+	return ret;
+}
+
+static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
+				struct bio *bio, bool partial_io)
+{
+	int ret;
+
+	zram_slot_lock(zram, index);
+	if (zram_test_flag(zram, index, ZRAM_WB)) {
+		struct bio_vec bvec;
+
+		zram_slot_unlock(zram, index);
+		/* A null bio means rw_page was used, we must fallback to bio */
+		if (!bio)
+			return -EOPNOTSUPP;
+
+		bvec.bv_page = page;
+		bvec.bv_len = PAGE_SIZE;
+		bvec.bv_offset = 0;
+		return read_from_bdev(zram, &bvec,
+				zram_get_element(zram, index),
+				bio, partial_io);
+	}
+
+	ret = zram_read_from_zspool(zram, page, index);
 	zram_slot_unlock(zram, index);
 
 	/* Should NEVER happen. Return bio error if it does. */
@@ -1351,6 +1515,8 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	struct page *page = bvec->bv_page;
 	unsigned long element = 0;
 	enum zram_pageflags flags = 0;
+	bool dedup = false;
+	u32 checksum = 0;
 
 	mem = kmap_atomic(page);
 	if (page_same_filled(mem, &element)) {
@@ -1377,6 +1543,22 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 
 	if (comp_len >= huge_class_size)
 		comp_len = PAGE_SIZE;
+
+	if (zram_dedup_enabled(zram) && comp_len != PAGE_SIZE) {
+		unsigned long dup_handle;
+
+		checksum = zram_dedup_checksum(zstrm->buffer, comp_len);
+		dup_handle = zram_dedup_find(zram, checksum, zstrm->buffer,
+					     comp_len);
+		if (dup_handle) {
+			zcomp_stream_put(zram->comp);
+			zs_free(zram->mem_pool, handle);
+			handle = dup_handle;
+			dedup = true;
+			atomic64_add(comp_len, &zram->stats.dup_data_size);
+			goto out;
+		}
+	}
 	/*
 	 * handle allocation has 2 paths:
 	 * a) fast path is executed with preemption disabled (for
@@ -1438,6 +1620,9 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	zcomp_stream_put(zram->comp);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
+
+	if (zram_dedup_enabled(zram) && comp_len != PAGE_SIZE)
+		dedup = zram_dedup_insert(zram, checksum, handle, comp_len);
 out:
 	/*
 	 * Free memory associated with this sector
@@ -1458,6 +1643,8 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	}  else {
 		zram_set_handle(zram, index, handle);
 		zram_set_obj_size(zram, index, comp_len);
+		if (dedup)
+			zram_set_flag(zram, index, ZRAM_DEDUP);
 	}
 	zram_slot_unlock(zram, index);
 
@@ -1504,6 +1691,208 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	return ret;
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recomp_algorithm, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recomp_algorithm)];
+	size_t sz;
+
+	strscpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[sz - 1] = 0x00;
+
+	if (!zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recomp_algorithm, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+
+/*
+ * Recompress the page of @index with the secondary algorithm and replace the
+ * old object if the new one is smaller. Pages that do not shrink are marked
+ * ZRAM_INCOMPRESSIBLE so later passes skip them until they are rewritten.
+ * The caller must hold the slot lock of @index.
+ */
+static int zram_recompress(struct zram *zram, u32 index, struct page *page)
+{
+	unsigned int old_len, new_len;
+	unsigned long alloced_pages;
+	struct zcomp_strm *zstrm;
+	unsigned long handle;
+	void *src, *dst;
+	bool idle;
+	int ret;
+
+	old_len = zram_get_obj_size(zram, index);
+	ret = zram_read_from_zspool(zram, page, index);
+	if (ret)
+		return ret;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &new_len);
+	kunmap_atomic(src);
+
+	if (unlikely(ret)) {
+		zcomp_stream_put(zram->recomp);
+		return ret;
+	}
+
+	if (new_len >= old_len || new_len >= huge_class_size) {
+		zcomp_stream_put(zram->recomp);
+		zram_set_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+		return 0;
+	}
+
+	/* The slot lock is held, so we cannot enter direct reclaim */
+	handle = zs_malloc(zram->mem_pool, new_len,
+			__GFP_KSWAPD_RECLAIM |
+			__GFP_NOWARN |
+			__GFP_HIGHMEM |
+			__GFP_MOVABLE);
+	if (IS_ERR((void *)handle)) {
+		zcomp_stream_put(zram->recomp);
+		return PTR_ERR((void *)handle);
+	}
+
+	alloced_pages = zs_get_total_pages(zram->mem_pool);
+	update_used_max(zram, alloced_pages);
+
+	if (zram->limit_pages && alloced_pages > zram->limit_pages) {
+		zcomp_stream_put(zram->recomp);
+		zs_free(zram->mem_pool, handle);
+		return -ENOMEM;
+	}
+
+	dst = zs_map_object(zram->mem_pool, handle, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, new_len);
+	zcomp_stream_put(zram->recomp);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	idle = zram_test_flag(zram, index, ZRAM_IDLE);
+	zram_free_page(zram, index);
+	zram_set_handle(zram, index, handle);
+	zram_set_obj_size(zram, index, new_len);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+	if (idle)
+		zram_set_flag(zram, index, ZRAM_IDLE);
+
+	atomic64_add(new_len, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.pages_stored);
+
+	return 0;
+}
+
+#define RECOMPRESS_IDLE (1<<0)
+#define RECOMPRESS_HUGE (1<<1)
+
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	unsigned long index;
+	struct page *page;
+	ssize_t ret = len;
+	int mode, err;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = RECOMPRESS_IDLE;
+	else if (sysfs_streq(buf, "huge"))
+		mode = RECOMPRESS_HUGE;
+	else if (sysfs_streq(buf, "huge_idle"))
+		mode = RECOMPRESS_IDLE | RECOMPRESS_HUGE;
+	else
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		ret = -EINVAL;
+		goto release_init_lock;
+	}
+
+	if (!zram->recomp) {
+		ret = -ENODEV;
+		goto release_init_lock;
+	}
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page) {
+		ret = -ENOMEM;
+		goto release_init_lock;
+	}
+
+	for (index = 0; index < nr_pages; index++) {
+		err = 0;
+
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index))
+			goto next;
+
+		if (zram_test_flag(zram, index, ZRAM_WB) ||
+				zram_test_flag(zram, index, ZRAM_SAME) ||
+				zram_test_flag(zram, index, ZRAM_UNDER_WB) ||
+				zram_test_flag(zram, index, ZRAM_RECOMP) ||
+				zram_test_flag(zram, index, ZRAM_INCOMPRESSIBLE))
+			goto next;
+
+		/* Recompressing a shared object would only unshare it */
+		if (zram_test_flag(zram, index, ZRAM_DEDUP) &&
+		    zram_dedup_shared(zram, zram_get_handle(zram, index)))
+			goto next;
+
+		if (mode & RECOMPRESS_IDLE &&
+			  !zram_test_flag(zram, index, ZRAM_IDLE))
+			goto next;
+		if (mode & RECOMPRESS_HUGE &&
+			  !zram_test_flag(zram, index, ZRAM_HUGE))
+			goto next;
+
+		err = zram_recompress(zram, index, page);
+next:
+		zram_slot_unlock(zram, index);
+		if (err) {
+			ret = err;
+			break;
+		}
+
+		cond_resched();
+	}
+
+	__free_page(page);
+release_init_lock:
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#endif
+
 /*
  * zram_bio_discard - handler on discard request
  * @index: physical block index in PAGE_SIZE units
@@ -1726,10 +2115,16 @@ static void zram_reset_device(struct zram *zram)
 
 	/* I/O operation under all of CPU are done so let's free */
 	zram_meta_free(zram, zram->disksize);
+	zram_dedup_fini(zram);
 	zram->disksize = 0;
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(zram->comp);
 	zram->comp = NULL;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp)
+		zcomp_destroy(zram->recomp);
+	zram->recomp = NULL;
+#endif
 	reset_bdev(zram);
 
 	up_write(&zram->init_lock);
@@ -1760,6 +2155,10 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_unlock;
 	}
 
+	err = zram_dedup_init(zram, disksize >> PAGE_SHIFT);
+	if (err)
+		goto out_free_meta;
+
 	comp = zcomp_create(zram->compressor);
 	if (IS_ERR(comp)) {
 		pr_err("Cannot initialise %s compressing backend\n",
@@ -1768,6 +2167,21 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp_algorithm[0]) {
+		struct zcomp *recomp = zcomp_create(zram->recomp_algorithm);
+
+		if (IS_ERR(recomp)) {
+			pr_err("Cannot initialise %s recompressing backend\n",
+					zram->recomp_algorithm);
+			zcomp_destroy(comp);
+			err = PTR_ERR(recomp);
+			goto out_free_meta;
+		}
+		zram->recomp = recomp;
+	}
+#endif
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity_and_notify(zram->disk, zram->disksize >> SECTOR_SHIFT);
@@ -1776,6 +2190,7 @@ static ssize_t disksize_store(struct device *dev,
 	return len;
 
 out_free_meta:
+	zram_dedup_fini(zram);
 	zram_meta_free(zram, disksize);
 out_unlock:
 	up_write(&zram->init_lock);
@@ -1854,6 +2269,13 @@ static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_WO(idle);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+#ifdef CONFIG_ZRAM_DEDUP
+static DEVICE_ATTR_RW(use_dedup);
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
 static DEVICE_ATTR_WO(writeback);
@@ -1871,6 +2293,13 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_idle.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+#ifdef CONFIG_ZRAM_DEDUP
+	&dev_attr_use_dedup.attr,
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
 	&dev_attr_writeback.attr,
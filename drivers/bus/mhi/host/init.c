@@ -154,12 +154,39 @@ void mhi_deinit_free_irq(struct mhi_controller *mhi_cntrl)
 		if (mhi_event->offload_ev)
 			continue;
 
+		irq_set_affinity_hint(mhi_cntrl->irq[mhi_event->irq], NULL);
 		free_irq(mhi_cntrl->irq[mhi_event->irq], mhi_event);
 	}
 
 	free_irq(mhi_cntrl->irq[0], mhi_cntrl);
 }
 
+/*
+ * Spread the interrupts of the hardware (data) event rings over the CPUs
+ * local to the controller, so that the event processing of busy channels
+ * isn't serialized on whichever CPU happens to take every MSI. Only done
+ * when each event ring has a vector of its own; a shared vector would
+ * just get its affinity overwritten.
+ */
+static void mhi_init_irq_affinity(struct mhi_controller *mhi_cntrl)
+{
+	struct mhi_event *mhi_event = mhi_cntrl->mhi_event;
+	int node = dev_to_node(mhi_cntrl->cntrl_dev);
+	unsigned int cpu = 0;
+	int i;
+
+	if (mhi_cntrl->nr_irqs <= mhi_cntrl->total_ev_rings)
+		return;
+
+	for (i = 0; i < mhi_cntrl->total_ev_rings; i++, mhi_event++) {
+		if (mhi_event->offload_ev || !mhi_event->hw_ring)
+			continue;
+
+		irq_set_affinity_hint(mhi_cntrl->irq[mhi_event->irq],
+				      cpumask_of(cpumask_local_spread(cpu++, node)));
+	}
+}
+
 int mhi_init_irq_setup(struct mhi_controller *mhi_cntrl)
 {
 	struct mhi_event *mhi_event = mhi_cntrl->mhi_event;
@@ -209,6 +236,8 @@ int mhi_init_irq_setup(struct mhi_controller *mhi_cntrl)
 		disable_irq(mhi_cntrl->irq[mhi_event->irq]);
 	}
 
+	mhi_init_irq_affinity(mhi_cntrl);
+
 	return 0;
 
 error_request:
@@ -189,6 +189,9 @@ struct mhi_buf_info {
 	bool pre_mapped; /* Already pre-mapped by client */
 };
 
+/* Max events handled by one run of a data event ring tasklet */
+#define MHI_EV_TASK_BUDGET				256
+
 struct mhi_event {
 	struct mhi_controller *mhi_cntrl;
 	struct mhi_chan *mhi_chan; /* dedicated to channel */
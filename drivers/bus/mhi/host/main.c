@@ -1042,11 +1042,21 @@ void mhi_ev_task(unsigned long data)
 {
 	struct mhi_event *mhi_event = (struct mhi_event *)data;
 	struct mhi_controller *mhi_cntrl = mhi_event->mhi_cntrl;
+	int count;
 
-	/* process all pending events */
+	/* process up to a budget of pending events */
 	spin_lock_bh(&mhi_event->lock);
-	mhi_event->process_event(mhi_cntrl, mhi_event, U32_MAX);
+	count = mhi_event->process_event(mhi_cntrl, mhi_event,
+					 MHI_EV_TASK_BUDGET);
 	spin_unlock_bh(&mhi_event->lock);
+
+	/*
+	 * The budget was exhausted, so more events are likely pending. Give
+	 * other softirq work a chance to run and come back for the rest
+	 * rather than draining a busy data ring in a single pass.
+	 */
+	if (count >= MHI_EV_TASK_BUDGET)
+		tasklet_schedule(&mhi_event->task);
 }
 
 void mhi_ctrl_ev_task(unsigned long data)
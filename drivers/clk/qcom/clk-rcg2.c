@@ -28,6 +28,8 @@
 #define CMD_DIRTY_N		BIT(5)
 #define CMD_DIRTY_M		BIT(6)
 #define CMD_DIRTY_D		BIT(7)
+#define CMD_DIRTY_MASK		(CMD_DIRTY_CFG | CMD_DIRTY_N | CMD_DIRTY_M | \
+				 CMD_DIRTY_D)
 #define CMD_ROOT_OFF		BIT(31)
 
 #define CFG_REG			0x4
@@ -282,25 +284,32 @@ static int clk_rcg2_determine_floor_rate(struct clk_hw *hw,
 	return _freq_tbl_determine_rate(hw, rcg->freq_tbl, req, FLOOR);
 }
 
+/*
+ * Program the M, N and D registers for @f and compute the matching CFG value
+ * into @_cfg. @mnd_changed, if not NULL, tells whether any of M, N or D had
+ * to be written.
+ */
 static int __clk_rcg2_configure(struct clk_rcg2 *rcg, const struct freq_tbl *f,
-				u32 *_cfg)
+				u32 *_cfg, bool *mnd_changed)
 {
 	u32 cfg, mask, d_val, not2d_val, n_minus_m;
 	struct clk_hw *hw = &rcg->clkr.hw;
 	int ret, index = qcom_find_src_index(hw, rcg->parent_map, f->src);
+	bool m_changed = false, n_changed = false, d_changed = false;
 
 	if (index < 0)
 		return index;
 
 	if (rcg->mnd_width && f->n) {
 		mask = BIT(rcg->mnd_width) - 1;
-		ret = regmap_update_bits(rcg->clkr.regmap,
-				RCG_M_OFFSET(rcg), mask, f->m);
+		ret = regmap_update_bits_check(rcg->clkr.regmap,
+				RCG_M_OFFSET(rcg), mask, f->m, &m_changed);
 		if (ret)
 			return ret;
 
-		ret = regmap_update_bits(rcg->clkr.regmap,
-				RCG_N_OFFSET(rcg), mask, ~(f->n - f->m));
+		ret = regmap_update_bits_check(rcg->clkr.regmap,
+				RCG_N_OFFSET(rcg), mask, ~(f->n - f->m),
+				&n_changed);
 		if (ret)
 			return ret;
 
@@ -313,12 +322,15 @@ static int __clk_rcg2_configure(struct clk_rcg2 *rcg, const struct freq_tbl *f,
 		d_val = clamp_t(u32, d_val, f->m, n_minus_m);
 		not2d_val = ~d_val & mask;
 
-		ret = regmap_update_bits(rcg->clkr.regmap,
-				RCG_D_OFFSET(rcg), mask, not2d_val);
+		ret = regmap_update_bits_check(rcg->clkr.regmap,
+				RCG_D_OFFSET(rcg), mask, not2d_val, &d_changed);
 		if (ret)
 			return ret;
 	}
 
+	if (mnd_changed)
+		*mnd_changed = m_changed || n_changed || d_changed;
+
 	mask = BIT(rcg->hid_width) - 1;
 	mask |= CFG_SRC_SEL_MASK | CFG_MODE_MASK | CFG_HW_CLK_CTRL_MASK;
 	cfg = f->pre_div << CFG_SRC_DIV_SHIFT;
@@ -334,17 +346,35 @@ static int __clk_rcg2_configure(struct clk_rcg2 *rcg, const struct freq_tbl *f,
 
 static int clk_rcg2_configure(struct clk_rcg2 *rcg, const struct freq_tbl *f)
 {
-	u32 cfg;
+	u32 cfg, old_cfg, cmd;
+	bool mnd_changed;
 	int ret;
 
 	ret = regmap_read(rcg->clkr.regmap, RCG_CFG_OFFSET(rcg), &cfg);
 	if (ret)
 		return ret;
 
-	ret = __clk_rcg2_configure(rcg, f, &cfg);
+	old_cfg = cfg;
+	ret = __clk_rcg2_configure(rcg, f, &cfg, &mnd_changed);
 	if (ret)
 		return ret;
 
+	/*
+	 * Rate changes during DVFS transitions frequently target the
+	 * configuration the RCG already has. Skip the update handshake, and
+	 * the polling it involves, unless something was written now or an
+	 * earlier write is still pending.
+	 */
+	if (!mnd_changed && cfg == old_cfg) {
+		ret = regmap_read(rcg->clkr.regmap, rcg->cmd_rcgr + CMD_REG,
+				  &cmd);
+		if (ret)
+			return ret;
+
+		if (!(cmd & CMD_DIRTY_MASK))
+			return 0;
+	}
+
 	ret = regmap_write(rcg->clkr.regmap, RCG_CFG_OFFSET(rcg), cfg);
 	if (ret)
 		return ret;
@@ -1040,7 +1070,7 @@ static int clk_rcg2_shared_set_rate(struct clk_hw *hw, unsigned long rate,
 	 * register.
 	 */
 	if (!clk_hw_is_enabled(hw))
-		return __clk_rcg2_configure(rcg, f, &rcg->parked_cfg);
+		return __clk_rcg2_configure(rcg, f, &rcg->parked_cfg, NULL);
 
 	return clk_rcg2_shared_force_enable_clear(hw, f);
 }
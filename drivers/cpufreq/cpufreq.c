@@ -373,6 +373,7 @@ static void cpufreq_notify_transition(struct cpufreq_policy *policy,
 					 CPUFREQ_PRECHANGE, freqs);
 
 		adjust_jiffies(CPUFREQ_PRECHANGE, freqs);
+		cpufreq_stats_record_request(policy);
 		break;
 
 	case CPUFREQ_POSTCHANGE:
@@ -2119,6 +2120,7 @@ unsigned int cpufreq_driver_fast_switch(struct cpufreq_policy *policy,
 	int cpu;
 
 	target_freq = clamp_val(target_freq, policy->min, policy->max);
+	cpufreq_stats_record_request(policy);
 	freq = cpufreq_driver->fast_switch(policy, target_freq);
 
 	if (!freq)
@@ -22,6 +22,10 @@ struct cpufreq_stats {
 	unsigned int *freq_table;
 	unsigned int *trans_table;
 
+	/* Transition latency, from the request to the frequency being set */
+	unsigned long long request_time;
+	u64 *trans_time;
+
 	/* Deferred reset */
 	unsigned int reset_pending;
 	unsigned long long reset_time;
@@ -42,6 +46,7 @@ static void cpufreq_stats_reset_table(struct cpufreq_stats *stats)
 
 	memset(stats->time_in_state, 0, count * sizeof(u64));
 	memset(stats->trans_table, 0, count * count * sizeof(int));
+	memset(stats->trans_time, 0, count * count * sizeof(u64));
 	stats->last_time = local_clock();
 	stats->total_trans = 0;
 
@@ -172,11 +177,67 @@ static ssize_t show_trans_table(struct cpufreq_policy *policy, char *buf)
 }
 cpufreq_freq_attr_ro(trans_table);
 
+/* Same layout as trans_table, with the mean latencies in microseconds */
+static ssize_t show_trans_latency(struct cpufreq_policy *policy, char *buf)
+{
+	struct cpufreq_stats *stats = policy->stats;
+	bool pending = READ_ONCE(stats->reset_pending);
+	unsigned int count, idx;
+	ssize_t len = 0;
+	u64 latency;
+	int i, j;
+
+	len += scnprintf(buf + len, PAGE_SIZE - len, "   From  :    To\n");
+	len += scnprintf(buf + len, PAGE_SIZE - len, "         : ");
+	for (i = 0; i < stats->state_num; i++) {
+		if (len >= PAGE_SIZE)
+			break;
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%9u ",
+				stats->freq_table[i]);
+	}
+	if (len >= PAGE_SIZE)
+		return PAGE_SIZE;
+
+	len += scnprintf(buf + len, PAGE_SIZE - len, "\n");
+
+	for (i = 0; i < stats->state_num; i++) {
+		if (len >= PAGE_SIZE)
+			break;
+
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%9u: ",
+				stats->freq_table[i]);
+
+		for (j = 0; j < stats->state_num; j++) {
+			if (len >= PAGE_SIZE)
+				break;
+
+			idx = i * stats->max_state + j;
+			count = pending ? 0 : stats->trans_table[idx];
+			latency = count ? div_u64(div64_u64(stats->trans_time[idx], count),
+						  NSEC_PER_USEC) : 0;
+
+			len += scnprintf(buf + len, PAGE_SIZE - len, "%9llu ",
+					 latency);
+		}
+		if (len >= PAGE_SIZE)
+			break;
+		len += scnprintf(buf + len, PAGE_SIZE - len, "\n");
+	}
+
+	if (len >= PAGE_SIZE) {
+		pr_warn_once("cpufreq transition latency table exceeds PAGE_SIZE. Disabling\n");
+		return -EFBIG;
+	}
+	return len;
+}
+cpufreq_freq_attr_ro(trans_latency);
+
 static struct attribute *default_attrs[] = {
 	&total_trans.attr,
 	&time_in_state.attr,
 	&reset.attr,
 	&trans_table.attr,
+	&trans_latency.attr,
 	NULL
 };
 static const struct attribute_group stats_attr_group = {
@@ -232,12 +293,19 @@ void cpufreq_stats_create_table(struct cpufreq_policy *policy)
 
 	alloc_size += count * count * sizeof(int);
 
-	/* Allocate memory for time_in_state/freq_table/trans_table in one go */
+	alloc_size += count * count * sizeof(u64);
+
+	/*
+	 * Allocate memory for time_in_state/trans_time/freq_table/trans_table
+	 * in one go
+	 */
 	stats->time_in_state = kzalloc(alloc_size, GFP_KERNEL);
 	if (!stats->time_in_state)
 		goto free_stat;
 
-	stats->freq_table = (unsigned int *)(stats->time_in_state + count);
+	stats->trans_time = stats->time_in_state + count;
+
+	stats->freq_table = (unsigned int *)(stats->trans_time + count * count);
 
 	stats->trans_table = stats->freq_table + count;
 
@@ -263,10 +331,19 @@ void cpufreq_stats_create_table(struct cpufreq_policy *policy)
 	kfree(stats);
 }
 
+void cpufreq_stats_record_request(struct cpufreq_policy *policy)
+{
+	struct cpufreq_stats *stats = policy->stats;
+
+	if (likely(stats))
+		stats->request_time = local_clock();
+}
+
 void cpufreq_stats_record_transition(struct cpufreq_policy *policy,
 				     unsigned int new_freq)
 {
 	struct cpufreq_stats *stats = policy->stats;
+	unsigned long long request_time;
 	int old_index, new_index;
 
 	if (unlikely(!stats))
@@ -275,6 +352,10 @@ void cpufreq_stats_record_transition(struct cpufreq_policy *policy,
 	if (unlikely(READ_ONCE(stats->reset_pending)))
 		cpufreq_stats_reset_table(stats);
 
+	/* Consume the request so that it is not accounted twice */
+	request_time = stats->request_time;
+	stats->request_time = 0;
+
 	old_index = stats->last_index;
 	new_index = freq_table_get_index(stats, new_freq);
 
@@ -287,4 +368,8 @@ void cpufreq_stats_record_transition(struct cpufreq_policy *policy,
 	stats->last_index = new_index;
 	stats->trans_table[old_index * stats->max_state + new_index]++;
 	stats->total_trans++;
+
+	if (request_time && stats->last_time > request_time)
+		stats->trans_time[old_index * stats->max_state + new_index] +=
+			stats->last_time - request_time;
 }
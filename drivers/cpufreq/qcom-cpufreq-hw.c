@@ -8,6 +8,7 @@
 #include <linux/init.h>
 #include <linux/interconnect.h>
 #include <linux/interrupt.h>
+#include <linux/irq_work.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/of_address.h>
@@ -17,6 +18,7 @@
 #include <linux/slab.h>
 #include <linux/spinlock.h>
 #include <linux/units.h>
+#include <linux/workqueue.h>
 
 #define LUT_MAX_ENTRIES			40U
 #define LUT_SRC				GENMASK(31, 30)
@@ -58,6 +60,15 @@ struct qcom_cpufreq_data {
 
 	bool per_core_dcvs;
 
+	/*
+	 * Fast switches run in scheduler context and cannot vote for the
+	 * interconnect bandwidth, which may sleep. They record the frequency
+	 * and leave the vote to bw_work, kicked through bw_irq_work.
+	 */
+	struct irq_work bw_irq_work;
+	struct work_struct bw_work;
+	unsigned int bw_freq;
+
 	struct freq_qos_request throttle_freq_req;
 };
 
@@ -160,9 +171,31 @@ static unsigned int qcom_cpufreq_hw_fast_switch(struct cpufreq_policy *policy,
 		for (i = 1; i < cpumask_weight(policy->related_cpus); i++)
 			writel_relaxed(index, data->base + soc_data->reg_perf_state + i * 4);
 
+	if (icc_scaling_enabled) {
+		WRITE_ONCE(data->bw_freq, policy->freq_table[index].frequency);
+		irq_work_queue(&data->bw_irq_work);
+	}
+
 	return policy->freq_table[index].frequency;
 }
 
+static void qcom_cpufreq_bw_work(struct work_struct *work)
+{
+	struct qcom_cpufreq_data *data = container_of(work, struct qcom_cpufreq_data,
+						      bw_work);
+
+	qcom_cpufreq_set_bw(data->policy, READ_ONCE(data->bw_freq));
+}
+
+/* queue_work() may wake up a worker and must not run in scheduler context. */
+static void qcom_cpufreq_bw_irq_work(struct irq_work *irq_work)
+{
+	struct qcom_cpufreq_data *data = container_of(irq_work, struct qcom_cpufreq_data,
+						      bw_irq_work);
+
+	queue_work(system_highpri_wq, &data->bw_work);
+}
+
 static int qcom_cpufreq_hw_read_lut(struct device *cpu_dev,
 				    struct cpufreq_policy *policy)
 {
@@ -195,7 +228,6 @@ static int qcom_cpufreq_hw_read_lut(struct device *cpu_dev,
 		dev_err(cpu_dev, "Invalid opp table in device tree\n");
 		return ret;
 	} else {
-		policy->fast_switch_possible = true;
 		icc_scaling_enabled = false;
 	}
 
@@ -363,9 +395,13 @@ static irqreturn_t qcom_lmh_dcvs_handle_irq(int irq, void *data)
 {
 	struct qcom_cpufreq_data *c_data = data;
 
-	/* Disable interrupt and enable polling */
+	/*
+	 * Disable interrupt and enable polling. Use the same high priority
+	 * workqueue as the polling so that the throttled frequency reaches
+	 * the scheduler without waiting behind regular work.
+	 */
 	disable_irq_nosync(c_data->throttle_irq);
-	schedule_delayed_work(&c_data->throttle_work, 0);
+	mod_delayed_work(system_highpri_wq, &c_data->throttle_work, 0);
 
 	if (c_data->soc_data->reg_intr_clr)
 		writel_relaxed(GT_IRQ_STATUS,
@@ -427,7 +463,6 @@ static int qcom_cpufreq_hw_lmh_init(struct cpufreq_policy *policy, int index)
 	}
 
 	data->cancel_throttle = false;
-	data->policy = policy;
 
 	mutex_init(&data->throttle_lock);
 	INIT_DEFERRABLE_WORK(&data->throttle_work, qcom_lmh_dcvs_poll);
@@ -554,6 +589,9 @@ static int qcom_cpufreq_hw_cpu_init(struct cpufreq_policy *policy)
 	data->soc_data = of_device_get_match_data(&pdev->dev);
 	data->base = base;
 	data->res = res;
+	data->policy = policy;
+	init_irq_work(&data->bw_irq_work, qcom_cpufreq_bw_irq_work);
+	INIT_WORK(&data->bw_work, qcom_cpufreq_bw_work);
 
 	/* HW should be in enabled state to proceed */
 	if (!(readl_relaxed(base + data->soc_data->reg_enable) & 0x1)) {
@@ -581,6 +619,9 @@ static int qcom_cpufreq_hw_cpu_init(struct cpufreq_policy *policy)
 		goto error;
 	}
 
+	/* Bandwidth votes of fast switches are deferred, see bw_work */
+	policy->fast_switch_possible = true;
+
 	ret = dev_pm_opp_get_opp_count(cpu_dev);
 	if (ret <= 0) {
 		dev_err(cpu_dev, "Failed to add OPPs\n");
@@ -615,6 +656,8 @@ static int qcom_cpufreq_hw_cpu_exit(struct cpufreq_policy *policy)
 	struct resource *res = data->res;
 	void __iomem *base = data->base;
 
+	irq_work_sync(&data->bw_irq_work);
+	cancel_work_sync(&data->bw_work);
 	dev_pm_opp_remove_all_dynamic(cpu_dev);
 	dev_pm_opp_of_cpumask_remove_table(policy->related_cpus);
 	qcom_cpufreq_hw_lmh_exit(data);
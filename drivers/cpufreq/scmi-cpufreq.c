@@ -128,6 +128,7 @@ static int scmi_cpufreq_init(struct cpufreq_policy *policy)
 {
 	int ret, nr_opp;
 	unsigned int latency;
+	u32 rate_limit;
 	struct device *cpu_dev;
 	struct scmi_data *priv;
 	struct cpufreq_frequency_table *freq_table;
@@ -226,6 +227,14 @@ static int scmi_cpufreq_init(struct cpufreq_policy *policy)
 	policy->fast_switch_possible =
 		perf_ops->fast_switch_possible(ph, cpu_dev);
 
+	/*
+	 * Don't let schedutil send DVFS requests faster than the platform
+	 * accepts them, they would only queue up on the transport.
+	 */
+	if (!perf_ops->rate_limit_get(ph, priv->domain_id, &rate_limit) &&
+	    rate_limit)
+		policy->transition_delay_us = rate_limit;
+
 	return 0;
 
 out_free_opp:
@@ -11,6 +11,7 @@
 
 #include <linux/cpu.h>
 #include <linux/device.h>
+#include <linux/interrupt.h>
 #include <linux/kernel.h>
 #include <linux/platform_device.h>
 #include <linux/pm_domain.h>
@@ -181,6 +182,11 @@ static int psci_cpuidle_domain_probe(struct platform_device *pdev)
 	if (ret)
 		goto remove_pd;
 
+#ifdef CONFIG_IRQ_TIMINGS
+	/* Predict the next interrupt of each CPU for the domain governor. */
+	irq_timings_enable();
+#endif
+
 	pr_info("Initialized CPU PM domain topology\n");
 	return 0;
 
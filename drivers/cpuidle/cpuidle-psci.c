@@ -91,6 +91,9 @@ static int __psci_enter_domain_idle_state(struct cpuidle_device *dev,
 
 	cpu_pm_exit();
 
+	/* No prediction while running, see cpu_power_down_ok(). */
+	WRITE_ONCE(dev->next_irq_event, 0);
+
 	/* Clear the domain state to start fresh when back from idle. */
 	psci_set_domain_state(0);
 	return ret;
@@ -20,6 +20,7 @@
 #include <linux/cpuidle.h>
 #include <linux/ktime.h>
 #include <linux/hrtimer.h>
+#include <linux/interrupt.h>
 #include <linux/module.h>
 #include <linux/suspend.h>
 #include <linux/tick.h>
@@ -308,6 +309,32 @@ int cpuidle_enter_state(struct cpuidle_device *dev, struct cpuidle_driver *drv,
 	return entered_state;
 }
 
+/*
+ * Predict the next device interrupt of this CPU once per idle period.
+ * Reading the prediction consumes the IRQ timings buffer, so it is kept in
+ * @dev both for the governor, see cpuidle_governor_irq_next_ns(), and for
+ * the CPU PM domain governor, which looks at the next_irq_event of every CPU
+ * in the domain.  The IRQ timings are based on local_clock(), the domain
+ * governor works with ktime_get().
+ */
+static void cpuidle_predict_irq(struct cpuidle_device *dev)
+{
+#ifdef CONFIG_IRQ_TIMINGS
+	u64 now = local_clock();
+	u64 next = irq_timings_next_event(now);
+
+	if (next == U64_MAX) {
+		dev->next_irq_ns = U64_MAX;
+		WRITE_ONCE(dev->next_irq_event, KTIME_MAX);
+		return;
+	}
+
+	dev->next_irq_ns = next - now;
+	WRITE_ONCE(dev->next_irq_event,
+		   ktime_add_ns(ktime_get(), dev->next_irq_ns));
+#endif
+}
+
 /**
  * cpuidle_select - ask the cpuidle framework to choose an idle state
  *
@@ -324,6 +351,8 @@ int cpuidle_enter_state(struct cpuidle_device *dev, struct cpuidle_driver *drv,
 int cpuidle_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 		   bool *stop_tick)
 {
+	cpuidle_predict_irq(dev);
+
 	return cpuidle_curr_governor->select(drv, dev, stop_tick);
 }
 
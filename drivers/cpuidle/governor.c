@@ -10,6 +10,7 @@
 
 #include <linux/cpu.h>
 #include <linux/cpuidle.h>
+#include <linux/interrupt.h>
 #include <linux/mutex.h>
 #include <linux/module.h>
 #include <linux/pm_qos.h>
@@ -110,10 +111,19 @@ s64 cpuidle_governor_latency_req(unsigned int cpu)
 {
 	struct device *device = get_cpu_device(cpu);
 	int device_req = dev_pm_qos_raw_resume_latency(device);
-	int global_req = cpu_latency_qos_limit();
+	int global_req = cpu_latency_qos_cpu_limit(cpu);
 
 	if (device_req > global_req)
 		device_req = global_req;
 
 	return (s64)device_req * NSEC_PER_USEC;
 }
+
+#ifdef CONFIG_CPU_IDLE_GOV_IRQ_TIMINGS
+static int __init cpuidle_irq_timings_init(void)
+{
+	irq_timings_enable();
+	return 0;
+}
+core_initcall(cpuidle_irq_timings_init);
+#endif
@@ -75,6 +75,12 @@
  * intervals and if the stand deviation of these 8 intervals is below a
  * threshold value, we use the average of these intervals as prediction.
  *
+ * With CONFIG_CPU_IDLE_GOV_IRQ_TIMINGS the interrupt timings code predicts
+ * the next device interrupt from the periods of the individual interrupts,
+ * which also works when several periodic sources (audio, touch, vsync) mix
+ * their wakeups into intervals that look random as a whole. That prediction
+ * caps the expected idle duration too.
+ *
  * Limiting Performance Impact
  * ---------------------------
  * C states, especially those with large exit latencies, can have a real
@@ -268,7 +274,7 @@ static int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	struct menu_device *data = this_cpu_ptr(&menu_devices);
 	s64 latency_req = cpuidle_governor_latency_req(dev->cpu);
 	unsigned int predicted_us;
-	u64 predicted_ns;
+	u64 predicted_ns, irq_ns;
 	u64 interactivity_req;
 	unsigned int nr_iowaiters;
 	ktime_t delta, delta_tick;
@@ -312,6 +318,9 @@ static int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	predicted_ns = (u64)min(predicted_us,
 				get_typical_interval(data, predicted_us)) *
 				NSEC_PER_USEC;
+	/* A device interrupt expected earlier ends the idle period too. */
+	irq_ns = cpuidle_governor_irq_next_ns(dev);
+	predicted_ns = min(predicted_ns, irq_ns);
 
 	if (tick_nohz_tick_stopped()) {
 		/*
@@ -320,10 +329,10 @@ static int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 		 * may be stuck in a shallow idle state for a long time as a
 		 * result of it.  In that case say we might mispredict and use
 		 * the known time till the closest timer event for the idle
-		 * state selection.
+		 * state selection, unless an interrupt is expected before it.
 		 */
 		if (predicted_ns < TICK_NSEC)
-			predicted_ns = data->next_timer_ns;
+			predicted_ns = min(data->next_timer_ns, irq_ns);
 	} else {
 		/*
 		 * Use the performance multiplier and the user-configurable
@@ -99,6 +99,12 @@
  *      select the given idle state instead of the candidate one.
  *
  * 3. By default, select the candidate state.
+ *
+ * With CONFIG_CPU_IDLE_GOV_IRQ_TIMINGS the sleep length used for the idle
+ * state selection is capped by the time till the next device interrupt as
+ * predicted by the interrupt timings code, so periodic device interrupts do
+ * not have to show up as intercepts first before they are taken into account.
+ * The metrics are still updated relative to the time till the closest timer.
  */
 
 #include <linux/cpuidle.h>
@@ -298,6 +304,7 @@ static int teo_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	bool alt_intercepts, alt_recent;
 	ktime_t delta_tick;
 	s64 duration_ns;
+	u64 irq_ns;
 	int i;
 
 	if (dev->last_state_idx >= 0) {
@@ -310,6 +317,11 @@ static int teo_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	duration_ns = tick_nohz_get_sleep_length(&delta_tick);
 	cpu_data->sleep_length_ns = duration_ns;
 
+	/* A device interrupt expected before the timer wakes the CPU first. */
+	irq_ns = cpuidle_governor_irq_next_ns(dev);
+	if (irq_ns < S64_MAX && (s64)irq_ns < duration_ns)
+		duration_ns = irq_ns;
+
 	/* Check if there is any choice in the first place. */
 	if (drv->state_count < 2) {
 		idx = 0;
@@ -5,6 +5,7 @@
  */
 #include <linux/dma-mapping.h>
 #include <linux/interrupt.h>
+#include <linux/moduleparam.h>
 #include <crypto/gcm.h>
 #include <crypto/authenc.h>
 #include <crypto/internal/aead.h>
@@ -18,6 +19,13 @@
 #define CCM_NONCE_AUTHSIZE_SHIFT	3
 #define MAX_CCM_ADATA_HEADER_LEN        6
 
+static unsigned int aead_sw_max_len = CONFIG_CRYPTO_DEV_QCE_SW_MAX_LEN;
+module_param(aead_sw_max_len, uint, 0644);
+MODULE_PARM_DESC(aead_sw_max_len,
+		 "Only use hardware for AEAD requests whose associated data "
+		 "and payload are larger than this [0=always use hardware; "
+		 "default=" __stringify(CONFIG_CRYPTO_DEV_QCE_SW_MAX_LEN)"]");
+
 static LIST_HEAD(aead_algs);
 
 static void qce_aead_done(void *data)
@@ -506,6 +514,7 @@ static int qce_aead_crypt(struct aead_request *req, int encrypt)
 	struct qce_aead_ctx *ctx = crypto_aead_ctx(tfm);
 	struct qce_alg_template *tmpl = to_aead_tmpl(tfm);
 	unsigned int blocksize = crypto_aead_blocksize(tfm);
+	bool use_fallback;
 
 	rctx->flags  = tmpl->alg_flags;
 	rctx->flags |= encrypt ? QCE_ENCRYPT : QCE_DECRYPT;
@@ -521,8 +530,15 @@ static int qce_aead_crypt(struct aead_request *req, int encrypt)
 			ctx->need_fallback = true;
 	}
 
+	/*
+	 * Setting up the BAM transfer and taking the completion interrupt
+	 * costs more than doing small requests on the CPU.
+	 */
+	use_fallback = ctx->need_fallback ||
+		       rctx->cryptlen + req->assoclen <= aead_sw_max_len;
+
 	/* If fallback is needed, schedule and exit */
-	if (ctx->need_fallback) {
+	if (use_fallback) {
 		/* Reset need_fallback in case the same ctx is used for another transaction */
 		ctx->need_fallback = false;
 
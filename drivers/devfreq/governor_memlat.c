@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * linux/drivers/devfreq/governor_memlat.c
+ *
+ * Memory latency governor: scales a memory or interconnect device (L3,
+ * DDR, ...) from the memory-bound stalls of the CPUs that use it, as
+ * measured with the CPU performance counters.
+ *
+ * For every CPU the governor samples the number of core cycles and of
+ * cycles stalled on memory. A CPU whose stall share is at least the
+ * configured threshold is memory-bound, and its effective frequency (core
+ * cycles over wall time, so idle time counts as zero) is mapped linearly
+ * onto the frequency range of the device. The device runs at the highest
+ * frequency requested by any memory-bound CPU, or at its lowest frequency
+ * when no CPU is memory-bound. The counters of a CPU only exist while the
+ * CPU is online.
+ */
+
+#include <linux/cpu.h>
+#include <linux/cpuhotplug.h>
+#include <linux/cpufreq.h>
+#include <linux/devfreq.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/perf_event.h>
+#include <linux/slab.h>
+#include "governor.h"
+
+/* Default share of stalled cycles (%) from which a CPU is memory-bound */
+#define MEMLAT_STALL_PCT		(40)
+
+static enum cpuhp_state memlat_hp_state;
+
+struct devfreq_memlat_cpu {
+	struct perf_event *cycles;
+	struct perf_event *stalls;
+	u64 prev_cycles;
+	u64 prev_stalls;
+	ktime_t prev_time;
+};
+
+static struct perf_event *memlat_create_event(int cpu, u32 type, u64 config)
+{
+	struct perf_event_attr attr = {
+		.type		= type,
+		.size		= sizeof(attr),
+		.config		= config,
+		.pinned		= 1,
+	};
+	struct perf_event *event;
+
+	event = perf_event_create_kernel_counter(&attr, cpu, NULL, NULL, NULL);
+
+	return IS_ERR(event) ? NULL : event;
+}
+
+static u64 memlat_read_event(struct perf_event *event)
+{
+	u64 enabled, running;
+
+	return perf_event_read_value(event, &enabled, &running);
+}
+
+static void memlat_release_cpu_events(struct devfreq_memlat_data *data,
+				      int cpu)
+{
+	struct devfreq_memlat_cpu *cpu_data = &data->cpu_data[cpu];
+
+	if (cpu_data->cycles)
+		perf_event_release_kernel(cpu_data->cycles);
+	if (cpu_data->stalls)
+		perf_event_release_kernel(cpu_data->stalls);
+
+	cpu_data->cycles = NULL;
+	cpu_data->stalls = NULL;
+}
+
+/* Returns true if both counters of @cpu could be created */
+static bool memlat_create_cpu_events(struct devfreq_memlat_data *data, int cpu)
+{
+	struct devfreq_memlat_cpu *cpu_data = &data->cpu_data[cpu];
+
+	cpu_data->cycles = memlat_create_event(cpu, PERF_TYPE_HARDWARE,
+					       PERF_COUNT_HW_CPU_CYCLES);
+	if (data->stall_event)
+		cpu_data->stalls = memlat_create_event(cpu, PERF_TYPE_RAW,
+						       data->stall_event);
+	else
+		cpu_data->stalls = memlat_create_event(cpu, PERF_TYPE_HARDWARE,
+						       PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+
+	if (!cpu_data->cycles || !cpu_data->stalls)
+		return false;
+
+	cpu_data->prev_cycles = memlat_read_event(cpu_data->cycles);
+	cpu_data->prev_stalls = memlat_read_event(cpu_data->stalls);
+	cpu_data->prev_time = ktime_get();
+
+	return true;
+}
+
+static void memlat_release_events(struct devfreq_memlat_data *data)
+{
+	int cpu;
+
+	if (!data->cpu_data)
+		return;
+
+	cpuhp_state_remove_instance_nocalls(memlat_hp_state, &data->node);
+
+	for_each_possible_cpu(cpu)
+		memlat_release_cpu_events(data, cpu);
+
+	kfree(data->cpu_data);
+	data->cpu_data = NULL;
+}
+
+static int memlat_create_events(struct devfreq *devfreq)
+{
+	struct devfreq_memlat_data *data = devfreq->data;
+	const struct cpumask *cpus = data->cpus ?: cpu_possible_mask;
+	int cpu, ret, nr = 0;
+
+	data->cpu_data = kcalloc(nr_cpu_ids, sizeof(*data->cpu_data),
+				 GFP_KERNEL);
+	if (!data->cpu_data)
+		return -ENOMEM;
+
+	data->this = devfreq;
+
+	/* Counters of CPUs coming online later are created by memlat_cpu_online() */
+	cpus_read_lock();
+	for_each_cpu_and(cpu, cpus, cpu_online_mask)
+		if (memlat_create_cpu_events(data, cpu))
+			nr++;
+
+	ret = nr ? cpuhp_state_add_instance_nocalls_cpuslocked(memlat_hp_state,
+							       &data->node)
+		 : -ENODEV;
+	cpus_read_unlock();
+
+	if (ret) {
+		for_each_possible_cpu(cpu)
+			memlat_release_cpu_events(data, cpu);
+		kfree(data->cpu_data);
+		data->cpu_data = NULL;
+	}
+
+	return ret;
+}
+
+/* Called with the hotplug lock held, so it can't race with GOV_START/STOP */
+static int memlat_cpu_online(unsigned int cpu, struct hlist_node *node)
+{
+	struct devfreq_memlat_data *data =
+		hlist_entry(node, struct devfreq_memlat_data, node);
+	const struct cpumask *cpus = data->cpus ?: cpu_possible_mask;
+
+	if (!cpumask_test_cpu(cpu, cpus))
+		return 0;
+
+	/* A CPU whose counters can't be created is just not sampled */
+	mutex_lock(&data->this->lock);
+	memlat_create_cpu_events(data, cpu);
+	mutex_unlock(&data->this->lock);
+
+	return 0;
+}
+
+static int memlat_cpu_offline(unsigned int cpu, struct hlist_node *node)
+{
+	struct devfreq_memlat_data *data =
+		hlist_entry(node, struct devfreq_memlat_data, node);
+
+	mutex_lock(&data->this->lock);
+	memlat_release_cpu_events(data, cpu);
+	mutex_unlock(&data->this->lock);
+
+	return 0;
+}
+
+/*
+ * Returns the effective frequency of @cpu in kHz over the last sample if the
+ * CPU was memory-bound, 0 otherwise.
+ */
+static unsigned long memlat_cpu_khz(struct devfreq_memlat_data *data, int cpu)
+{
+	struct devfreq_memlat_cpu *cpu_data = &data->cpu_data[cpu];
+	unsigned int stall_pct = data->stall_pct ?: MEMLAT_STALL_PCT;
+	u64 cur_cycles, cur_stalls, cycles, stalls, delta_us;
+	ktime_t now;
+
+	if (!cpu_data->cycles || !cpu_data->stalls)
+		return 0;
+
+	now = ktime_get();
+	cur_cycles = memlat_read_event(cpu_data->cycles);
+	cur_stalls = memlat_read_event(cpu_data->stalls);
+
+	delta_us = ktime_us_delta(now, cpu_data->prev_time);
+	cycles = cur_cycles - cpu_data->prev_cycles;
+	stalls = cur_stalls - cpu_data->prev_stalls;
+
+	cpu_data->prev_cycles = cur_cycles;
+	cpu_data->prev_stalls = cur_stalls;
+	cpu_data->prev_time = now;
+
+	if (!cycles || !delta_us)
+		return 0;
+
+	if (stalls * 100 < cycles * stall_pct)
+		return 0;
+
+	/* Cycles per microsecond are MHz */
+	return div64_u64(cycles * 1000, delta_us);
+}
+
+static int devfreq_memlat_func(struct devfreq *df, unsigned long *freq)
+{
+	struct devfreq_memlat_data *data = df->data;
+	const struct cpumask *cpus = data->cpus ?: cpu_possible_mask;
+	unsigned long min_freq, max_freq, cpu_khz, cpu_max_khz;
+	unsigned long target = DEVFREQ_MIN_FREQ;
+	int cpu;
+
+	if (!data->cpu_data)
+		return -EINVAL;
+
+	devfreq_get_freq_range(df, &min_freq, &max_freq);
+
+	for_each_cpu_and(cpu, cpus, cpu_online_mask) {
+		cpu_khz = memlat_cpu_khz(data, cpu);
+		if (!cpu_khz)
+			continue;
+
+		/* Without cpufreq, a memory-bound CPU asks for the maximum */
+		cpu_max_khz = cpufreq_quick_get_max(cpu);
+		if (!cpu_max_khz || cpu_khz >= cpu_max_khz) {
+			target = max_freq;
+			break;
+		}
+
+		target = max(target, min_freq +
+			     (unsigned long)div64_u64((u64)(max_freq - min_freq) * cpu_khz,
+						      cpu_max_khz));
+	}
+
+	*freq = target;
+
+	return 0;
+}
+
+static int devfreq_memlat_handler(struct devfreq *devfreq,
+				  unsigned int event, void *data)
+{
+	struct devfreq_memlat_data *m_data = devfreq->data;
+	int ret;
+
+	if (!m_data)
+		return -EINVAL;
+
+	switch (event) {
+	case DEVFREQ_GOV_START:
+		ret = memlat_create_events(devfreq);
+		if (ret)
+			return ret;
+		devfreq_monitor_start(devfreq);
+		break;
+
+	case DEVFREQ_GOV_STOP:
+		devfreq_monitor_stop(devfreq);
+		memlat_release_events(m_data);
+		break;
+
+	case DEVFREQ_GOV_UPDATE_INTERVAL:
+		devfreq_update_interval(devfreq, (unsigned int *)data);
+		break;
+
+	case DEVFREQ_GOV_SUSPEND:
+		devfreq_monitor_suspend(devfreq);
+		break;
+
+	case DEVFREQ_GOV_RESUME:
+		devfreq_monitor_resume(devfreq);
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static struct devfreq_governor devfreq_memlat = {
+	.name = DEVFREQ_GOV_MEMLAT,
+	.flags = DEVFREQ_GOV_FLAG_IMMUTABLE,
+	.attrs = DEVFREQ_GOV_ATTR_POLLING_INTERVAL
+		| DEVFREQ_GOV_ATTR_TIMER,
+	.get_target_freq = devfreq_memlat_func,
+	.event_handler = devfreq_memlat_handler,
+};
+
+static int __init devfreq_memlat_init(void)
+{
+	int ret;
+
+	ret = cpuhp_setup_state_multi(CPUHP_AP_ONLINE_DYN, "devfreq/memlat:online",
+				      memlat_cpu_online, memlat_cpu_offline);
+	if (ret < 0)
+		return ret;
+	memlat_hp_state = ret;
+
+	ret = devfreq_add_governor(&devfreq_memlat);
+	if (ret)
+		cpuhp_remove_multi_state(memlat_hp_state);
+
+	return ret;
+}
+subsys_initcall(devfreq_memlat_init);
+
+static void __exit devfreq_memlat_exit(void)
+{
+	int ret;
+
+	ret = devfreq_remove_governor(&devfreq_memlat);
+	if (ret)
+		pr_err("%s: failed remove governor %d\n", __func__, ret);
+
+	cpuhp_remove_multi_state(memlat_hp_state);
+}
+module_exit(devfreq_memlat_exit);
+
+MODULE_DESCRIPTION("DEVFREQ memory latency governor");
+MODULE_LICENSE("GPL");
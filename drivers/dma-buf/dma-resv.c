@@ -380,6 +380,18 @@ static void dma_resv_iter_walk_unlocked(struct dma_resv_iter *cursor)
 		dma_resv_list_entry(cursor->fences, cursor->index++,
 				    cursor->obj, &cursor->fence,
 				    &cursor->fence_usage);
+
+		/*
+		 * Skip fences we are not interested in, or which are already
+		 * known to be signaled, without bouncing their refcount.
+		 */
+		if (cursor->usage < cursor->fence_usage ||
+		    test_bit(DMA_FENCE_FLAG_SIGNALED_BIT,
+			     &cursor->fence->flags)) {
+			cursor->fence = NULL;
+			continue;
+		}
+
 		cursor->fence = dma_fence_get_rcu(cursor->fence);
 		if (!cursor->fence) {
 			dma_resv_iter_restart_unlocked(cursor);
@@ -696,7 +708,35 @@ EXPORT_SYMBOL_GPL(dma_resv_wait_timeout);
 bool dma_resv_test_signaled(struct dma_resv *obj, enum dma_resv_usage usage)
 {
 	struct dma_resv_iter cursor;
+	struct dma_resv_list *list;
 	struct dma_fence *fence;
+	bool signaled = true;
+	unsigned int i;
+
+	/*
+	 * Fast path: if every relevant fence already has the signaled bit
+	 * set, we can answer under RCU without grabbing any references.
+	 * Otherwise fall back to the iterator, which also gives the fences
+	 * a chance to poll for completion.
+	 */
+	rcu_read_lock();
+	list = dma_resv_fences_list(obj);
+	for (i = 0; list && i < list->num_fences; ++i) {
+		enum dma_resv_usage fence_usage;
+
+		dma_resv_list_entry(list, i, obj, &fence, &fence_usage);
+		if (fence_usage <= usage &&
+		    !test_bit(DMA_FENCE_FLAG_SIGNALED_BIT, &fence->flags)) {
+			signaled = false;
+			break;
+		}
+	}
+	if (list != dma_resv_fences_list(obj))
+		signaled = false;
+	rcu_read_unlock();
+
+	if (signaled)
+		return true;
 
 	dma_resv_iter_begin(&cursor, obj, usage);
 	dma_resv_for_each_fence_unlocked(&cursor, fence) {
@@ -18,8 +18,10 @@
 #include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/scatterlist.h>
+#include <linux/shrinker.h>
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 static struct dma_heap *sys_heap;
 
@@ -38,6 +40,8 @@ struct dma_heap_attachment {
 	struct sg_table *table;
 	struct list_head list;
 	bool mapped;
+	bool cached;
+	enum dma_data_direction dir;
 };
 
 #define LOW_ORDER_GFP (GFP_HIGHUSER | __GFP_ZERO | __GFP_COMP)
@@ -55,6 +59,137 @@ static gfp_t order_flags[] = {HIGH_ORDER_GFP, MID_ORDER_GFP, LOW_ORDER_GFP};
 static const unsigned int orders[] = {8, 4, 0};
 #define NUM_ORDERS ARRAY_SIZE(orders)
 
+/*
+ * Pages of freed buffers are kept in per-order pools rather than handed
+ * back to the buddy allocator, and zeroed in the background, so that
+ * allocations can be satisfied without going through the page allocator
+ * and without clearing pages in the allocating task's context.  Only
+ * zeroed ("clean") pages are ever handed out again.  The pools are
+ * emptied by a shrinker under memory pressure.
+ */
+static unsigned int pool_max_mb = 64;
+module_param(pool_max_mb, uint, 0644);
+MODULE_PARM_DESC(pool_max_mb, "Maximum amount of freed memory kept for reuse, in MiB (default 64)");
+
+struct system_heap_pool {
+	spinlock_t lock;
+	struct list_head clean;
+	struct list_head dirty;
+};
+
+static struct system_heap_pool pools[NUM_ORDERS];
+static atomic_long_t pool_pages;	/* in units of PAGE_SIZE */
+static struct work_struct pool_zero_work;
+static struct shrinker pool_shrinker;
+
+static struct page *pool_get_clean(int i)
+{
+	struct system_heap_pool *pool = &pools[i];
+	struct page *page;
+
+	spin_lock(&pool->lock);
+	page = list_first_entry_or_null(&pool->clean, struct page, lru);
+	if (page)
+		list_del(&page->lru);
+	spin_unlock(&pool->lock);
+
+	if (page)
+		atomic_long_sub(1 << orders[i], &pool_pages);
+
+	return page;
+}
+
+static void pool_put_dirty(struct page *page)
+{
+	unsigned int order = compound_order(page);
+	unsigned long max = (unsigned long)READ_ONCE(pool_max_mb) <<
+				(20 - PAGE_SHIFT);
+	int i;
+
+	for (i = 0; i < NUM_ORDERS; i++)
+		if (orders[i] == order)
+			break;
+
+	if (i == NUM_ORDERS ||
+	    atomic_long_add_return(1 << order, &pool_pages) > max) {
+		if (i != NUM_ORDERS)
+			atomic_long_sub(1 << order, &pool_pages);
+		__free_pages(page, order);
+		return;
+	}
+
+	spin_lock(&pools[i].lock);
+	list_add_tail(&page->lru, &pools[i].dirty);
+	spin_unlock(&pools[i].lock);
+}
+
+static void pool_zero_worker(struct work_struct *work)
+{
+	int i, j;
+
+	for (i = 0; i < NUM_ORDERS; i++) {
+		struct system_heap_pool *pool = &pools[i];
+		struct page *page;
+
+		spin_lock(&pool->lock);
+		while ((page = list_first_entry_or_null(&pool->dirty,
+							struct page, lru))) {
+			list_del(&page->lru);
+			spin_unlock(&pool->lock);
+
+			for (j = 0; j < (1 << orders[i]); j++)
+				clear_highpage(page + j);
+
+			cond_resched();
+
+			spin_lock(&pool->lock);
+			list_add(&page->lru, &pool->clean);
+		}
+		spin_unlock(&pool->lock);
+	}
+}
+
+static unsigned long pool_shrink_count(struct shrinker *shrinker,
+				       struct shrink_control *sc)
+{
+	return atomic_long_read(&pool_pages) ? : SHRINK_EMPTY;
+}
+
+static unsigned long pool_shrink_scan(struct shrinker *shrinker,
+				      struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	int i;
+
+	/* Drop the largest, and dirty ones, first: */
+	for (i = 0; i < NUM_ORDERS && freed < sc->nr_to_scan; i++) {
+		struct system_heap_pool *pool = &pools[i];
+		struct list_head *lists[] = { &pool->dirty, &pool->clean };
+		int l;
+
+		for (l = 0; l < ARRAY_SIZE(lists) && freed < sc->nr_to_scan; l++) {
+			struct page *page;
+
+			spin_lock(&pool->lock);
+			while (freed < sc->nr_to_scan &&
+			       (page = list_first_entry_or_null(lists[l],
+							struct page, lru))) {
+				list_del(&page->lru);
+				spin_unlock(&pool->lock);
+
+				atomic_long_sub(1 << orders[i], &pool_pages);
+				__free_pages(page, orders[i]);
+				freed += 1 << orders[i];
+
+				spin_lock(&pool->lock);
+			}
+			spin_unlock(&pool->lock);
+		}
+	}
+
+	return freed ? : SHRINK_STOP;
+}
+
 static struct sg_table *dup_sg_table(struct sg_table *table)
 {
 	struct sg_table *new_table;
@@ -121,11 +256,33 @@ static void system_heap_detach(struct dma_buf *dmabuf,
 	list_del(&a->list);
 	mutex_unlock(&buffer->lock);
 
+	if (a->cached)
+		dma_unmap_sgtable(a->dev, a->table, a->dir, 0);
 	sg_free_table(a->table);
 	kfree(a->table);
 	kfree(a);
 }
 
+/*
+ * Mapping the buffer for a device which needs no cache maintenance, such as
+ * an IO-coherent one behind an SMMU, is only IOMMU work, and the same work
+ * for every map of the attachment.  Such a mapping is kept when the importer
+ * unmaps it and reused by the next map in the same direction, it is only torn
+ * down on detach or when mapped in another direction.
+ */
+static bool system_heap_need_sync(struct device *dev, struct sg_table *table)
+{
+	struct scatterlist *sg;
+	int i;
+
+	for_each_sgtable_dma_sg(table, sg, i) {
+		if (dma_need_sync(dev, sg_dma_address(sg)))
+			return true;
+	}
+
+	return false;
+}
+
 static struct sg_table *system_heap_map_dma_buf(struct dma_buf_attachment *attachment,
 						enum dma_data_direction direction)
 {
@@ -133,10 +290,20 @@ static struct sg_table *system_heap_map_dma_buf(struct dma_buf_attachment *attac
 	struct sg_table *table = a->table;
 	int ret;
 
+	if (a->cached) {
+		if (a->dir == direction)
+			goto out;
+
+		dma_unmap_sgtable(attachment->dev, table, a->dir, 0);
+		a->cached = false;
+	}
+
 	ret = dma_map_sgtable(attachment->dev, table, direction, 0);
 	if (ret)
 		return ERR_PTR(ret);
 
+	a->dir = direction;
+out:
 	a->mapped = true;
 	return table;
 }
@@ -148,6 +315,11 @@ static void system_heap_unmap_dma_buf(struct dma_buf_attachment *attachment,
 	struct dma_heap_attachment *a = attachment->priv;
 
 	a->mapped = false;
+	if (!system_heap_need_sync(attachment->dev, table)) {
+		a->cached = true;
+		return;
+	}
+
 	dma_unmap_sgtable(attachment->dev, table, direction, 0);
 }
 
@@ -290,13 +462,12 @@ static void system_heap_dma_buf_release(struct dma_buf *dmabuf)
 	int i;
 
 	table = &buffer->sg_table;
-	for_each_sgtable_sg(table, sg, i) {
-		struct page *page = sg_page(sg);
-
-		__free_pages(page, compound_order(page));
-	}
+	for_each_sgtable_sg(table, sg, i)
+		pool_put_dirty(sg_page(sg));
 	sg_free_table(table);
 	kfree(buffer);
+
+	schedule_work(&pool_zero_work);
 }
 
 static const struct dma_buf_ops system_heap_buf_ops = {
@@ -324,6 +495,10 @@ static struct page *alloc_largest_available(unsigned long size,
 		if (max_order < orders[i])
 			continue;
 
+		page = pool_get_clean(i);
+		if (page)
+			return page;
+
 		page = alloc_pages(order_flags[i], orders[i]);
 		if (!page)
 			continue;
@@ -425,14 +600,31 @@ static const struct dma_heap_ops system_heap_ops = {
 static int system_heap_create(void)
 {
 	struct dma_heap_export_info exp_info;
+	int i, ret;
+
+	for (i = 0; i < NUM_ORDERS; i++) {
+		spin_lock_init(&pools[i].lock);
+		INIT_LIST_HEAD(&pools[i].clean);
+		INIT_LIST_HEAD(&pools[i].dirty);
+	}
+	INIT_WORK(&pool_zero_work, pool_zero_worker);
+
+	pool_shrinker.count_objects = pool_shrink_count;
+	pool_shrinker.scan_objects = pool_shrink_scan;
+	pool_shrinker.seeks = DEFAULT_SEEKS;
+	ret = register_shrinker(&pool_shrinker, "dmabuf-system-heap-pool");
+	if (ret)
+		return ret;
 
 	exp_info.name = "system";
 	exp_info.ops = &system_heap_ops;
 	exp_info.priv = NULL;
 
 	sys_heap = dma_heap_add(&exp_info);
-	if (IS_ERR(sys_heap))
+	if (IS_ERR(sys_heap)) {
+		unregister_shrinker(&pool_shrinker);
 		return PTR_ERR(sys_heap);
+	}
 
 	return 0;
 }
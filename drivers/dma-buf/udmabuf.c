@@ -104,17 +104,32 @@ static void unmap_udmabuf(struct dma_buf_attachment *at,
 	return put_sg_table(at->dev, sg, direction);
 }
 
+/* Drop the page references, one atomic per run of pages in the same folio: */
+static void put_udmabuf_pages(struct page **pages, pgoff_t count)
+{
+	pgoff_t pg = 0;
+
+	while (pg < count) {
+		struct folio *folio = page_folio(pages[pg]);
+		int refs = 1;
+
+		while (pg + refs < count && page_folio(pages[pg + refs]) == folio)
+			refs++;
+
+		folio_put_refs(folio, refs);
+		pg += refs;
+	}
+}
+
 static void release_udmabuf(struct dma_buf *buf)
 {
 	struct udmabuf *ubuf = buf->priv;
 	struct device *dev = ubuf->device->this_device;
-	pgoff_t pg;
 
 	if (ubuf->sg)
 		put_sg_table(dev, ubuf->sg, DMA_BIDIRECTIONAL);
 
-	for (pg = 0; pg < ubuf->pagecount; pg++)
-		put_page(ubuf->pages[pg]);
+	put_udmabuf_pages(ubuf->pages, ubuf->pagecount);
 	kfree(ubuf->pages);
 	kfree(ubuf);
 }
@@ -176,8 +191,8 @@ static long udmabuf_create(struct miscdevice *device,
 	struct udmabuf *ubuf;
 	struct dma_buf *buf;
 	pgoff_t pgoff, pgcnt, pgidx, pgbuf = 0, pglimit;
-	struct page *page, *hpage = NULL;
-	pgoff_t subpgoff, maxsubpgs;
+	struct page *page, *hpage;
+	pgoff_t subpgoff, maxsubpgs, nr, j;
 	struct hstate *hpstate;
 	int seals, ret = -EINVAL;
 	u32 i, flags;
@@ -232,25 +247,26 @@ static long udmabuf_create(struct miscdevice *device,
 				    ~huge_page_mask(hpstate)) >> PAGE_SHIFT;
 			maxsubpgs = huge_page_size(hpstate) >> PAGE_SHIFT;
 		}
-		for (pgidx = 0; pgidx < pgcnt; pgidx++) {
+		for (pgidx = 0; pgidx < pgcnt; pgidx += nr) {
 			if (is_file_hugepages(memfd)) {
+				hpage = find_get_page_flags(mapping, pgoff,
+							    FGP_ACCESSED);
 				if (!hpage) {
-					hpage = find_get_page_flags(mapping, pgoff,
-								    FGP_ACCESSED);
-					if (!hpage) {
-						ret = -EINVAL;
-						goto err;
-					}
-				}
-				page = hpage + subpgoff;
-				get_page(page);
-				subpgoff++;
-				if (subpgoff == maxsubpgs) {
-					put_page(hpage);
-					hpage = NULL;
-					subpgoff = 0;
-					pgoff++;
+					ret = -EINVAL;
+					goto err;
 				}
+
+				/*
+				 * Take all the references for the subpages we
+				 * use in one go, the one from the lookup being
+				 * the first of them:
+				 */
+				nr = min(maxsubpgs - subpgoff, pgcnt - pgidx);
+				folio_ref_add(page_folio(hpage), nr - 1);
+				for (j = 0; j < nr; j++)
+					ubuf->pages[pgbuf++] = hpage + subpgoff + j;
+				subpgoff = 0;
+				pgoff++;
 			} else {
 				page = shmem_read_mapping_page(mapping,
 							       pgoff + pgidx);
@@ -258,15 +274,12 @@ static long udmabuf_create(struct miscdevice *device,
 					ret = PTR_ERR(page);
 					goto err;
 				}
+				ubuf->pages[pgbuf++] = page;
+				nr = 1;
 			}
-			ubuf->pages[pgbuf++] = page;
 		}
 		fput(memfd);
 		memfd = NULL;
-		if (hpage) {
-			put_page(hpage);
-			hpage = NULL;
-		}
 	}
 
 	exp_info.ops  = &udmabuf_ops;
@@ -287,8 +300,7 @@ static long udmabuf_create(struct miscdevice *device,
 	return dma_buf_fd(buf, flags);
 
 err:
-	while (pgbuf > 0)
-		put_page(ubuf->pages[--pgbuf]);
+	put_udmabuf_pages(ubuf->pages, pgbuf);
 	if (memfd)
 		fput(memfd);
 	kfree(ubuf->pages);
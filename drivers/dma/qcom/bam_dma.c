@@ -344,6 +344,11 @@ static const struct reg_offset_data bam_v1_7_reg_info[] = {
 #define IS_BUSY(chan)	(CIRC_SPACE(bchan->tail, bchan->head,\
 			 MAX_DESCRIPTORS + 1) == 0)
 
+static unsigned int bam_irq_coalesce = 1;
+module_param(bam_irq_coalesce, uint, 0644);
+MODULE_PARM_DESC(bam_irq_coalesce,
+		 "Number of descriptors with a completion callback per interrupt");
+
 struct bam_chan {
 	struct virt_dma_chan vc;
 
@@ -366,6 +371,7 @@ struct bam_chan {
 	unsigned int initialized;	/* is the channel hw initialized? */
 	unsigned int paused;		/* is the channel paused? */
 	unsigned int reconfigure;	/* new slave config? */
+	unsigned int pending_cb;	/* callbacks queued without an irq */
 	/* list of descriptors currently processed */
 	struct list_head desc_list;
 
@@ -527,6 +533,7 @@ static void bam_chan_init_hw(struct bam_chan *bchan,
 	/* init FIFO pointers */
 	bchan->head = 0;
 	bchan->tail = 0;
+	bchan->pending_cb = 0;
 }
 
 /**
@@ -816,6 +823,65 @@ static int bam_resume(struct dma_chan *chan)
 	return 0;
 }
 
+/**
+ * bam_complete_descs - retire the descriptors the hardware is done with
+ * @bchan: bam channel
+ *
+ * Completes the transactions whose descriptors have all been processed and
+ * pushes partially processed ones back to be restarted.  Returns true if any
+ * descriptors were retired.  Must be called with the channel lock held.
+ */
+static bool bam_complete_descs(struct bam_chan *bchan)
+{
+	struct bam_device *bdev = bchan->bdev;
+	struct bam_async_desc *async_desc, *tmp;
+	u32 offset, avail;
+	bool retired = false;
+
+	lockdep_assert_held(&bchan->vc.lock);
+
+	offset = readl_relaxed(bam_addr(bdev, bchan->id, BAM_P_SW_OFSTS)) &
+			       P_SW_OFSTS_MASK;
+	offset /= sizeof(struct bam_desc_hw);
+
+	/* Number of bytes available to read */
+	avail = CIRC_CNT(offset, bchan->head, MAX_DESCRIPTORS + 1);
+
+	if (offset < bchan->head)
+		avail--;
+
+	list_for_each_entry_safe(async_desc, tmp,
+				 &bchan->desc_list, desc_node) {
+		/* Not enough data to read */
+		if (avail < async_desc->xfer_len)
+			break;
+
+		/* manage FIFO */
+		bchan->head += async_desc->xfer_len;
+		bchan->head %= MAX_DESCRIPTORS;
+
+		async_desc->num_desc -= async_desc->xfer_len;
+		async_desc->curr_desc += async_desc->xfer_len;
+		avail -= async_desc->xfer_len;
+
+		/*
+		 * if complete, process cookie. Otherwise
+		 * push back to front of desc_issued so that
+		 * it gets restarted by the tasklet
+		 */
+		if (!async_desc->num_desc) {
+			vchan_cookie_complete(&async_desc->vd);
+		} else {
+			list_add(&async_desc->vd.node,
+				 &bchan->vc.desc_issued);
+		}
+		list_del(&async_desc->desc_node);
+		retired = true;
+	}
+
+	return retired;
+}
+
 /**
  * process_channel_irqs - processes the channel interrupts
  * @bdev: bam controller
@@ -825,9 +891,8 @@ static int bam_resume(struct dma_chan *chan)
  */
 static u32 process_channel_irqs(struct bam_device *bdev)
 {
-	u32 i, srcs, pipe_stts, offset, avail;
+	u32 i, srcs, pipe_stts;
 	unsigned long flags;
-	struct bam_async_desc *async_desc, *tmp;
 
 	srcs = readl_relaxed(bam_addr(bdev, 0, BAM_IRQ_SRCS_EE));
 
@@ -847,45 +912,7 @@ static u32 process_channel_irqs(struct bam_device *bdev)
 		writel_relaxed(pipe_stts, bam_addr(bdev, i, BAM_P_IRQ_CLR));
 
 		spin_lock_irqsave(&bchan->vc.lock, flags);
-
-		offset = readl_relaxed(bam_addr(bdev, i, BAM_P_SW_OFSTS)) &
-				       P_SW_OFSTS_MASK;
-		offset /= sizeof(struct bam_desc_hw);
-
-		/* Number of bytes available to read */
-		avail = CIRC_CNT(offset, bchan->head, MAX_DESCRIPTORS + 1);
-
-		if (offset < bchan->head)
-			avail--;
-
-		list_for_each_entry_safe(async_desc, tmp,
-					 &bchan->desc_list, desc_node) {
-			/* Not enough data to read */
-			if (avail < async_desc->xfer_len)
-				break;
-
-			/* manage FIFO */
-			bchan->head += async_desc->xfer_len;
-			bchan->head %= MAX_DESCRIPTORS;
-
-			async_desc->num_desc -= async_desc->xfer_len;
-			async_desc->curr_desc += async_desc->xfer_len;
-			avail -= async_desc->xfer_len;
-
-			/*
-			 * if complete, process cookie. Otherwise
-			 * push back to front of desc_issued so that
-			 * it gets restarted by the tasklet
-			 */
-			if (!async_desc->num_desc) {
-				vchan_cookie_complete(&async_desc->vd);
-			} else {
-				list_add(&async_desc->vd.node,
-					 &bchan->vc.desc_issued);
-			}
-			list_del(&async_desc->desc_node);
-		}
-
+		bam_complete_descs(bchan);
 		spin_unlock_irqrestore(&bchan->vc.lock, flags);
 	}
 
@@ -933,6 +960,39 @@ static irqreturn_t bam_dma_irq(int irq, void *data)
 	return IRQ_HANDLED;
 }
 
+/**
+ * bam_poll_complete - check the hardware for completed descriptors
+ * @bchan: bam channel
+ *
+ * Lets clients that busy-wait on small synchronous transfers through
+ * dmaengine_tx_status() see them complete without waiting for the interrupt,
+ * which may be deferred by interrupt coalescing.
+ */
+static void bam_poll_complete(struct bam_chan *bchan)
+{
+	struct bam_device *bdev = bchan->bdev;
+	unsigned long flags;
+	bool retired;
+
+	/*
+	 * Called from dmaengine_tx_status(), which may run in atomic context:
+	 * don't resume the device, a suspended BAM has nothing in flight.
+	 */
+	if (bchan->paused || pm_runtime_get_if_active(bdev->dev, true) <= 0)
+		return;
+
+	spin_lock_irqsave(&bchan->vc.lock, flags);
+	retired = !list_empty(&bchan->desc_list) && bam_complete_descs(bchan);
+	spin_unlock_irqrestore(&bchan->vc.lock, flags);
+
+	/* restart whatever got pushed back or is still queued */
+	if (retired)
+		tasklet_schedule(&bdev->task);
+
+	pm_runtime_mark_last_busy(bdev->dev);
+	pm_runtime_put_autosuspend(bdev->dev);
+}
+
 /**
  * bam_tx_status - returns status of transaction
  * @chan: dma channel
@@ -952,6 +1012,12 @@ static enum dma_status bam_tx_status(struct dma_chan *chan, dma_cookie_t cookie,
 	unsigned int i;
 	unsigned long flags;
 
+	ret = dma_cookie_status(chan, cookie, txstate);
+	if (ret == DMA_COMPLETE)
+		return ret;
+
+	bam_poll_complete(bchan);
+
 	ret = dma_cookie_status(chan, cookie, txstate);
 	if (ret == DMA_COMPLETE)
 		return ret;
@@ -1023,6 +1089,7 @@ static void bam_start_dma(struct bam_chan *bchan)
 	int ret;
 	unsigned int avail;
 	struct dmaengine_desc_callback cb;
+	bool irq;
 
 	lockdep_assert_held(&bchan->vc.lock);
 
@@ -1071,10 +1138,18 @@ static void bam_start_dma(struct bam_chan *bchan)
 		 *  - If a callback completion was requested for this DESC,
 		 *     In this case, BAM will deliver the completion callback
 		 *     for this desc and continue processing the next desc.
+		 *     With bam_irq_coalesce > 1 only every Nth such desc
+		 *     interrupts, the earlier callbacks are delivered with it.
 		 */
-		if (((avail <= async_desc->xfer_len) || !vd ||
-		     dmaengine_desc_callback_valid(&cb)) &&
-		    !(async_desc->flags & DESC_FLAG_EOT))
+		irq = avail <= async_desc->xfer_len || !vd;
+		if (dmaengine_desc_callback_valid(&cb) &&
+		    ++bchan->pending_cb >= bam_irq_coalesce)
+			irq = true;
+
+		if (irq || (async_desc->flags & DESC_FLAG_EOT))
+			bchan->pending_cb = 0;
+
+		if (irq && !(async_desc->flags & DESC_FLAG_EOT))
 			desc[async_desc->xfer_len - 1].flags |=
 				cpu_to_le16(DESC_FLAG_INT);
 
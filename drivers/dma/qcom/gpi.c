@@ -529,8 +529,8 @@ struct gpi_desc {
 	size_t len;
 	void *db; /* DB register to program */
 	struct gchan *gchan;
-	struct gpi_tre tre[MAX_TRE];
 	u32 num_tre;
+	struct gpi_tre tre[];
 };
 
 static const u32 GPII_CHAN_DIR[MAX_CHANNELS_PER_GPII] = {
@@ -1710,11 +1710,13 @@ static int gpi_create_i2c_tre(struct gchan *chan, struct gpi_desc *desc,
 }
 
 static int gpi_create_spi_tre(struct gchan *chan, struct gpi_desc *desc,
-			      struct scatterlist *sgl, enum dma_transfer_direction direction)
+			      struct scatterlist *sgl, unsigned int sg_len,
+			      enum dma_transfer_direction direction)
 {
 	struct gpi_spi_config *spi = chan->config;
 	struct device *dev = chan->gpii->gpi_dev->dev;
 	unsigned int tre_idx = 0;
+	struct scatterlist *sg;
 	dma_addr_t address;
 	struct gpi_tre *tre;
 	unsigned int i;
@@ -1764,19 +1766,26 @@ static int gpi_create_spi_tre(struct gchan *chan, struct gpi_desc *desc,
 		}
 	}
 
-	/* create the dma tre */
-	tre = &desc->tre[tre_idx];
-	tre_idx++;
+	/*
+	 * create the dma tres, chained so that a scattered buffer is still
+	 * moved as one transfer with a single completion on the last one
+	 */
+	for_each_sg(sgl, sg, sg_len, i) {
+		tre = &desc->tre[tre_idx];
+		tre_idx++;
 
-	address = sg_dma_address(sgl);
-	tre->dword[0] = lower_32_bits(address);
-	tre->dword[1] = upper_32_bits(address);
+		address = sg_dma_address(sg);
+		tre->dword[0] = lower_32_bits(address);
+		tre->dword[1] = upper_32_bits(address);
 
-	tre->dword[2] = u32_encode_bits(sg_dma_len(sgl), TRE_DMA_LEN);
+		tre->dword[2] = u32_encode_bits(sg_dma_len(sg), TRE_DMA_LEN);
 
-	tre->dword[3] = u32_encode_bits(TRE_TYPE_DMA, TRE_FLAGS_TYPE);
-	if (direction == DMA_MEM_TO_DEV)
-		tre->dword[3] |= u32_encode_bits(1, TRE_FLAGS_IEOT);
+		tre->dword[3] = u32_encode_bits(TRE_TYPE_DMA, TRE_FLAGS_TYPE);
+		if (!sg_is_last(sg))
+			tre->dword[3] |= u32_encode_bits(1, TRE_FLAGS_CHAIN);
+		else if (direction == DMA_MEM_TO_DEV)
+			tre->dword[3] |= u32_encode_bits(1, TRE_FLAGS_IEOT);
+	}
 
 	for (i = 0; i < tre_idx; i++)
 		dev_dbg(dev, "TRE:%d %x:%x:%x:%x\n", i, desc->tre[i].dword[0],
@@ -1796,7 +1805,9 @@ gpi_prep_slave_sg(struct dma_chan *chan, struct scatterlist *sgl,
 	struct device *dev = gpii->gpi_dev->dev;
 	struct gpi_ring *ch_ring = &gchan->ch_ring;
 	struct gpi_desc *gpi_desc;
+	struct scatterlist *sg;
 	u32 nr, nr_tre = 0;
+	size_t len = 0;
 	u8 set_config;
 	int i;
 
@@ -1806,17 +1817,22 @@ gpi_prep_slave_sg(struct dma_chan *chan, struct scatterlist *sgl,
 		return NULL;
 	}
 
-	if (sg_len > 1) {
+	if (sg_len > 1 && gchan->protocol != QCOM_GPI_SPI) {
 		dev_err(dev, "Multi sg sent, we support only one atm: %d\n", sg_len);
 		return NULL;
 	}
 
-	nr_tre = 3;
+	/* config and go tres ahead of one dma tre per sg entry */
+	nr_tre = 2;
 	set_config = *(u32 *)gchan->config;
 	if (!set_config)
-		nr_tre = 2;
-	if (direction == DMA_DEV_TO_MEM) /* rx */
 		nr_tre = 1;
+	if (direction == DMA_DEV_TO_MEM) /* rx */
+		nr_tre = 0;
+	nr_tre += sg_len;
+
+	for_each_sg(sgl, sg, sg_len, i)
+		len += sg_dma_len(sg);
 
 	/* calculate # of elements required & available */
 	nr = gpi_ring_num_elements_avail(ch_ring);
@@ -1825,13 +1841,14 @@ gpi_prep_slave_sg(struct dma_chan *chan, struct scatterlist *sgl,
 		return NULL;
 	}
 
-	gpi_desc = kzalloc(sizeof(*gpi_desc), GFP_NOWAIT);
+	gpi_desc = kzalloc(struct_size(gpi_desc, tre, MAX_TRE - 1 + sg_len),
+			   GFP_NOWAIT);
 	if (!gpi_desc)
 		return NULL;
 
 	/* create TREs for xfer */
 	if (gchan->protocol == QCOM_GPI_SPI) {
-		i = gpi_create_spi_tre(gchan, gpi_desc, sgl, direction);
+		i = gpi_create_spi_tre(gchan, gpi_desc, sgl, sg_len, direction);
 	} else if (gchan->protocol == QCOM_GPI_I2C) {
 		i = gpi_create_i2c_tre(gchan, gpi_desc, sgl, direction);
 	} else {
@@ -1842,7 +1859,7 @@ gpi_prep_slave_sg(struct dma_chan *chan, struct scatterlist *sgl,
 
 	/* set up the descriptor */
 	gpi_desc->gchan = gchan;
-	gpi_desc->len = sg_dma_len(sgl);
+	gpi_desc->len = len;
 	gpi_desc->num_tre  = i;
 
 	return vchan_tx_prep(&gchan->vc, &gpi_desc->vd, flags);
@@ -1854,35 +1871,39 @@ static void gpi_issue_pending(struct dma_chan *chan)
 	struct gchan *gchan = to_gchan(chan);
 	struct gpii *gpii = gchan->gpii;
 	unsigned long flags, pm_lock_flags;
-	struct virt_dma_desc *vd = NULL;
+	struct virt_dma_desc *vd;
 	struct gpi_desc *gpi_desc;
 	struct gpi_ring *ch_ring = &gchan->ch_ring;
-	void *tre, *wp = NULL;
+	void *tre, *wp = NULL, *db = NULL;
 	int i;
 
 	read_lock_irqsave(&gpii->pm_lock, pm_lock_flags);
 
-	/* move all submitted discriptors to issued list */
+	/*
+	 * move all submitted discriptors to issued list and copy the tres of
+	 * every one not yet in the transfer ring, then ring the doorbell once
+	 * for the whole batch
+	 */
 	spin_lock_irqsave(&gchan->vc.lock, flags);
-	if (vchan_issue_pending(&gchan->vc))
-		vd = list_last_entry(&gchan->vc.desc_issued,
-				     struct virt_dma_desc, node);
-	spin_unlock_irqrestore(&gchan->vc.lock, flags);
+	vchan_issue_pending(&gchan->vc);
+	list_for_each_entry(vd, &gchan->vc.desc_issued, node) {
+		gpi_desc = to_gpi_desc(vd);
+		if (gpi_desc->db)
+			continue;
 
-	/* nothing to do list is empty */
-	if (!vd) {
-		read_unlock_irqrestore(&gpii->pm_lock, pm_lock_flags);
-		return;
-	}
+		for (i = 0; i < gpi_desc->num_tre; i++) {
+			tre = &gpi_desc->tre[i];
+			gpi_queue_xfer(gpii, gchan, tre, &wp);
+		}
 
-	gpi_desc = to_gpi_desc(vd);
-	for (i = 0; i < gpi_desc->num_tre; i++) {
-		tre = &gpi_desc->tre[i];
-		gpi_queue_xfer(gpii, gchan, tre, &wp);
+		gpi_desc->db = ch_ring->wp;
+		db = gpi_desc->db;
 	}
+	spin_unlock_irqrestore(&gchan->vc.lock, flags);
 
-	gpi_desc->db = ch_ring->wp;
-	gpi_write_ch_db(gchan, &gchan->ch_ring, gpi_desc->db);
+	/* nothing new was queued */
+	if (db)
+		gpi_write_ch_db(gchan, &gchan->ch_ring, db);
 	read_unlock_irqrestore(&gpii->pm_lock, pm_lock_flags);
 }
 
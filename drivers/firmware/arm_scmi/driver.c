@@ -1311,7 +1311,7 @@ static void
 scmi_common_fastchannel_init(const struct scmi_protocol_handle *ph,
 			     u8 describe_id, u32 message_id, u32 valid_size,
 			     u32 domain, void __iomem **p_addr,
-			     struct scmi_fc_db_info **p_db)
+			     struct scmi_fc_db_info **p_db, u32 *rate_limit)
 {
 	int ret;
 	u32 flags;
@@ -1365,6 +1365,9 @@ scmi_common_fastchannel_init(const struct scmi_protocol_handle *ph,
 
 	*p_addr = addr;
 
+	if (rate_limit)
+		*rate_limit = le32_to_cpu(resp->rate_limit) & GENMASK(19, 0);
+
 	if (p_db && SUPPORTS_DOORBELL(flags)) {
 		db = devm_kzalloc(ph->dev, sizeof(*db), GFP_KERNEL);
 		if (!db) {
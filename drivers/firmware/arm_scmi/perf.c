@@ -128,6 +128,7 @@ struct perf_dom_info {
 	bool perf_limit_notify;
 	bool perf_level_notify;
 	bool perf_fastchannels;
+	u32 rate_limit_us;
 	u32 opp_count;
 	u32 sustained_freq_khz;
 	u32 sustained_perf_level;
@@ -213,6 +214,8 @@ scmi_perf_domain_attributes_get(const struct scmi_protocol_handle *ph,
 		dom_info->perf_limit_notify = SUPPORTS_PERF_LIMIT_NOTIFY(flags);
 		dom_info->perf_level_notify = SUPPORTS_PERF_LEVEL_NOTIFY(flags);
 		dom_info->perf_fastchannels = SUPPORTS_PERF_FASTCHANNELS(flags);
+		dom_info->rate_limit_us =
+			le32_to_cpu(attr->rate_limit_us) & GENMASK(19, 0);
 		dom_info->sustained_freq_khz =
 					le32_to_cpu(attr->sustained_freq_khz);
 		dom_info->sustained_perf_level =
@@ -537,20 +540,21 @@ static void scmi_perf_domain_init_fc(const struct scmi_protocol_handle *ph,
 	ph->hops->fastchannel_init(ph, PERF_DESCRIBE_FASTCHANNEL,
 				   PERF_LEVEL_SET, 4, domain,
 				   &fc[PERF_FC_LEVEL].set_addr,
-				   &fc[PERF_FC_LEVEL].set_db);
+				   &fc[PERF_FC_LEVEL].set_db,
+				   &fc[PERF_FC_LEVEL].rate_limit);
 
 	ph->hops->fastchannel_init(ph, PERF_DESCRIBE_FASTCHANNEL,
 				   PERF_LEVEL_GET, 4, domain,
-				   &fc[PERF_FC_LEVEL].get_addr, NULL);
+				   &fc[PERF_FC_LEVEL].get_addr, NULL, NULL);
 
 	ph->hops->fastchannel_init(ph, PERF_DESCRIBE_FASTCHANNEL,
 				   PERF_LIMITS_SET, 8, domain,
 				   &fc[PERF_FC_LIMIT].set_addr,
-				   &fc[PERF_FC_LIMIT].set_db);
+				   &fc[PERF_FC_LIMIT].set_db, NULL);
 
 	ph->hops->fastchannel_init(ph, PERF_DESCRIBE_FASTCHANNEL,
 				   PERF_LIMITS_GET, 8, domain,
-				   &fc[PERF_FC_LIMIT].get_addr, NULL);
+				   &fc[PERF_FC_LIMIT].get_addr, NULL, NULL);
 
 	*p_fc = fc;
 }
@@ -678,6 +682,26 @@ static bool scmi_fast_switch_possible(const struct scmi_protocol_handle *ph,
 	return dom->fc_info && dom->fc_info[PERF_FC_LEVEL].set_addr;
 }
 
+static int scmi_dvfs_rate_limit_get(const struct scmi_protocol_handle *ph,
+				    u32 domain, u32 *rate_limit)
+{
+	struct perf_dom_info *dom;
+	struct scmi_perf_info *pi = ph->get_priv(ph);
+
+	if (!rate_limit || domain >= pi->num_domains)
+		return -EINVAL;
+
+	dom = pi->dom_info + domain;
+
+	/* Fast channels advertise their own limit */
+	if (dom->fc_info && dom->fc_info[PERF_FC_LEVEL].set_addr)
+		*rate_limit = dom->fc_info[PERF_FC_LEVEL].rate_limit;
+	else
+		*rate_limit = dom->rate_limit_us;
+
+	return 0;
+}
+
 static enum scmi_power_scale
 scmi_power_scale_get(const struct scmi_protocol_handle *ph)
 {
@@ -698,6 +722,7 @@ static const struct scmi_perf_proto_ops perf_proto_ops = {
 	.freq_get = scmi_dvfs_freq_get,
 	.est_power_get = scmi_dvfs_est_power_get,
 	.fast_switch_possible = scmi_fast_switch_possible,
+	.rate_limit_get = scmi_dvfs_rate_limit_get,
 	.power_scale_get = scmi_power_scale_get,
 };
 
@@ -885,10 +885,11 @@ static int msm_ioctl_gem_info(struct drm_device *dev, void *data,
 	return ret;
 }
 
-static int wait_fence(struct msm_gpu_submitqueue *queue, uint32_t fence_id,
-		      ktime_t timeout)
+static int wait_fence(struct msm_gpu *gpu, struct msm_gpu_submitqueue *queue,
+		      uint32_t fence_id, ktime_t timeout)
 {
 	struct dma_fence *fence;
+	unsigned long remaining;
 	int ret;
 
 	if (fence_after(fence_id, queue->last_fence)) {
@@ -916,7 +917,17 @@ static int wait_fence(struct msm_gpu_submitqueue *queue, uint32_t fence_id,
 	if (!fence)
 		return 0;
 
-	ret = dma_fence_wait_timeout(fence, true, timeout_to_jiffies(&timeout));
+	remaining = timeout_to_jiffies(&timeout);
+
+	/*
+	 * Someone blocking on the result is the closest thing we have to
+	 * a deadline, so ramp up the GPU freq now rather than waiting for
+	 * the governor to notice the load:
+	 */
+	if (remaining && !dma_fence_is_signaled(fence))
+		msm_devfreq_boost(gpu, 2);
+
+	ret = dma_fence_wait_timeout(fence, true, remaining);
 	if (ret == 0) {
 		ret = -ETIMEDOUT;
 	} else if (ret != -ERESTARTSYS) {
@@ -948,7 +959,7 @@ static int msm_ioctl_wait_fence(struct drm_device *dev, void *data,
 	if (!queue)
 		return -ENOENT;
 
-	ret = wait_fence(queue, args->fence, to_ktime(args->timeout));
+	ret = wait_fence(priv->gpu, queue, args->fence, to_ktime(args->timeout));
 
 	msm_submitqueue_put(queue);
 
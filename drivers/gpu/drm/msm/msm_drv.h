@@ -222,6 +222,16 @@ struct msm_drm_private {
 	struct notifier_block vmap_notifier;
 	struct shrinker shrinker;
 
+	/**
+	 * shrinker_work:
+	 *
+	 * Background reclaim of cold BOs, kicked when direct reclaim
+	 * reaches the shrinker.  shrinker_target accumulates the number
+	 * of pages the worker should try to free.
+	 */
+	struct work_struct shrinker_work;
+	atomic_long_t shrinker_target;
+
 	struct drm_atomic_state *pm_state;
 
 	/* For hang detection, in ms */
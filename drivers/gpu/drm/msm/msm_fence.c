@@ -26,6 +26,7 @@ msm_fence_context_alloc(struct drm_device *dev, volatile uint32_t *fenceptr,
 	fctx->context = dma_fence_context_alloc(1);
 	fctx->index = index++;
 	fctx->fenceptr = fenceptr;
+	INIT_LIST_HEAD(&fctx->pending);
 	spin_lock_init(&fctx->spinlock);
 
 	/*
@@ -68,6 +69,7 @@ void msm_update_fence(struct msm_fence_context *fctx, uint32_t fence)
 struct msm_fence {
 	struct dma_fence base;
 	struct msm_fence_context *fctx;
+	struct list_head node;   /* node in msm_fence_context::pending */
 };
 
 static inline struct msm_fence *to_msm_fence(struct dma_fence *fence)
@@ -75,6 +77,35 @@ static inline struct msm_fence *to_msm_fence(struct dma_fence *fence)
 	return container_of(fence, struct msm_fence, base);
 }
 
+/*
+ * Signal all the fences that have completed, in a single pass under the
+ * fence lock, rather than taking the lock again for each fence as they
+ * are retired.
+ */
+void msm_fence_signal_completed(struct msm_fence_context *fctx)
+{
+	struct msm_fence *f, *tmp;
+	unsigned long flags;
+	uint32_t fence;
+
+	spin_lock_irqsave(&fctx->spinlock, flags);
+
+	/* Only read the (slow, write-combined) fenceptr once: */
+	fence = *fctx->fenceptr;
+	if (fence_after(fctx->completed_fence, fence))
+		fence = fctx->completed_fence;
+
+	list_for_each_entry_safe(f, tmp, &fctx->pending, node) {
+		if (fence_after(f->base.seqno, fence))
+			break;
+
+		list_del_init(&f->node);
+		dma_fence_signal_locked(&f->base);
+	}
+
+	spin_unlock_irqrestore(&fctx->spinlock, flags);
+}
+
 static const char *msm_fence_get_driver_name(struct dma_fence *fence)
 {
 	return "msm";
@@ -92,16 +123,33 @@ static bool msm_fence_signaled(struct dma_fence *fence)
 	return msm_fence_completed(f->fctx, f->base.seqno);
 }
 
+static void msm_fence_release(struct dma_fence *fence)
+{
+	struct msm_fence *f = to_msm_fence(fence);
+	unsigned long flags;
+
+	/* Fences are never re-added to the list once removed: */
+	if (!list_empty(&f->node)) {
+		spin_lock_irqsave(&f->fctx->spinlock, flags);
+		list_del(&f->node);
+		spin_unlock_irqrestore(&f->fctx->spinlock, flags);
+	}
+
+	dma_fence_free(fence);
+}
+
 static const struct dma_fence_ops msm_fence_ops = {
 	.get_driver_name = msm_fence_get_driver_name,
 	.get_timeline_name = msm_fence_get_timeline_name,
 	.signaled = msm_fence_signaled,
+	.release = msm_fence_release,
 };
 
 struct dma_fence *
 msm_fence_alloc(struct msm_fence_context *fctx)
 {
 	struct msm_fence *f;
+	unsigned long flags;
 
 	f = kzalloc(sizeof(*f), GFP_KERNEL);
 	if (!f)
@@ -112,5 +160,9 @@ msm_fence_alloc(struct msm_fence_context *fctx)
 	dma_fence_init(&f->base, &msm_fence_ops, &fctx->spinlock,
 		       fctx->context, ++fctx->last_fence);
 
+	spin_lock_irqsave(&fctx->spinlock, flags);
+	list_add_tail(&f->node, &fctx->pending);
+	spin_unlock_irqrestore(&fctx->spinlock, flags);
+
 	return &f->base;
 }
@@ -51,6 +51,14 @@ struct msm_fence_context {
 	 */
 	volatile uint32_t *fenceptr;
 
+	/**
+	 * pending:
+	 *
+	 * List of not yet signaled fences, in seqno order, protected by
+	 * spinlock.  See msm_fence_signal_completed()
+	 */
+	struct list_head pending;
+
 	spinlock_t spinlock;
 };
 
@@ -60,6 +68,7 @@ void msm_fence_context_free(struct msm_fence_context *fctx);
 
 bool msm_fence_completed(struct msm_fence_context *fctx, uint32_t fence);
 void msm_update_fence(struct msm_fence_context *fctx, uint32_t fence);
+void msm_fence_signal_completed(struct msm_fence_context *fctx);
 
 struct dma_fence * msm_fence_alloc(struct msm_fence_context *fctx);
 
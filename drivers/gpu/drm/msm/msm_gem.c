@@ -314,6 +314,8 @@ static struct msm_gem_vma *add_vma(struct drm_gem_object *obj,
 		return ERR_PTR(-ENOMEM);
 
 	vma->aspace = aspace;
+	/* Object vmas map the whole object: */
+	vma->offset = 0;
 
 	list_add_tail(&vma->list, &msm_obj->vmas);
 
@@ -437,7 +439,8 @@ int msm_gem_pin_vma_locked(struct drm_gem_object *obj, struct msm_gem_vma *vma)
 	if (IS_ERR(pages))
 		return PTR_ERR(pages);
 
-	ret = msm_gem_map_vma(vma->aspace, vma, prot, msm_obj->sgt, obj->size);
+	ret = msm_gem_map_vma(vma->aspace, vma, prot, msm_obj->sgt,
+			      vma->node.size);
 	if (ret)
 		msm_gem_unpin_locked(obj);
 
@@ -1048,8 +1051,23 @@ static const struct vm_operations_struct vm_ops = {
 	.close = drm_gem_vm_close,
 };
 
+static void msm_gem_close(struct drm_gem_object *obj, struct drm_file *file)
+{
+	struct msm_file_private *ctx = file->driver_priv;
+
+	/*
+	 * Invalidate any cached handle lookups in the submitqueues.  This
+	 * runs before the handle drops its reference, and table_lock orders
+	 * it against submit_lookup_cached():
+	 */
+	spin_lock(&file->table_lock);
+	atomic_inc(&ctx->handle_seqno);
+	spin_unlock(&file->table_lock);
+}
+
 static const struct drm_gem_object_funcs msm_gem_object_funcs = {
 	.free = msm_gem_free_object,
+	.close = msm_gem_close,
 	.pin = msm_gem_prime_pin,
 	.unpin = msm_gem_prime_unpin,
 	.get_sg_table = msm_gem_prime_get_sg_table,
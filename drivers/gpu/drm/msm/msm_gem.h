@@ -60,6 +60,7 @@ struct msm_fence_context;
 struct msm_gem_vma {
 	struct drm_mm_node node;
 	uint64_t iova;
+	uint64_t offset;          /* offset of the mapping within the object */
 	struct msm_gem_address_space *aspace;
 	struct list_head list;    /* node in msm_gem_object::vmas */
 	bool mapped;
@@ -275,6 +276,8 @@ struct msm_gem_submit {
 	bool fault_dumped;  /* Limit devcoredump dumping to one per submit */
 	bool valid;         /* true if no cmdstream patching needed */
 	bool in_rb;         /* "sudo" mode, copy cmds into RB */
+	ktime_t queue_time; /* when the submit was pushed to the scheduler */
+	ktime_t run_time;   /* when the submit was written to the ringbuffer */
 	struct msm_ringbuffer *ring;
 	unsigned int nr_cmds;
 	unsigned int nr_bos;
@@ -132,9 +132,52 @@ msm_gem_shrinker_scan(struct shrinker *shrinker, struct shrink_control *sc)
 				     stages[3].freed);
 	}
 
+	/*
+	 * If we got here from direct reclaim, kswapd isn't keeping up.  Get
+	 * ahead of the next allocation by asking the background worker to
+	 * release another batch of the coldest idle BOs, so that the next
+	 * direct reclaim finds less to do on the GPU LRUs.
+	 */
+	if (!current_is_kswapd() && (sc->gfp_mask & __GFP_DIRECT_RECLAIM)) {
+		atomic_long_add(sc->nr_to_scan, &priv->shrinker_target);
+		queue_work(system_unbound_wq, &priv->shrinker_work);
+	}
+
 	return (freed > 0) ? freed : SHRINK_STOP;
 }
 
+static void
+msm_gem_shrinker_worker(struct work_struct *work)
+{
+	struct msm_drm_private *priv =
+		container_of(work, struct msm_drm_private, shrinker_work);
+	struct {
+		struct drm_gem_lru *lru;
+		bool (*shrink)(struct drm_gem_object *obj);
+		bool cond;
+		unsigned long freed;
+	} stages[] = {
+		/* Coldest idle BOs first, then wait for busy dontneed BOs: */
+		{ &priv->lru.dontneed, purge,        true },
+		{ &priv->lru.willneed, evict,        can_swap() },
+		{ &priv->lru.dontneed, active_purge, true },
+	};
+	long nr = atomic_long_xchg(&priv->shrinker_target, 0);
+
+	for (unsigned i = 0; (nr > 0) && (i < ARRAY_SIZE(stages)); i++) {
+		if (!stages[i].cond)
+			continue;
+		stages[i].freed =
+			drm_gem_lru_scan(stages[i].lru, nr, stages[i].shrink);
+		nr -= stages[i].freed;
+	}
+
+	if (stages[0].freed || stages[1].freed || stages[2].freed) {
+		trace_msm_gem_shrink(0, stages[0].freed, stages[1].freed,
+				     stages[2].freed, 0);
+	}
+}
+
 #ifdef CONFIG_DEBUG_FS
 unsigned long
 msm_gem_shrinker_shrink(struct drm_device *dev, unsigned long nr_to_scan)
@@ -149,6 +192,9 @@ msm_gem_shrinker_shrink(struct drm_device *dev, unsigned long nr_to_scan)
 	ret = msm_gem_shrinker_scan(&priv->shrinker, &sc);
 	fs_reclaim_release(GFP_KERNEL);
 
+	/* Don't return with background reclaim still changing the LRUs: */
+	flush_work(&priv->shrinker_work);
+
 	return ret;
 }
 #endif
@@ -206,6 +252,10 @@ msm_gem_shrinker_vmap(struct notifier_block *nb, unsigned long event, void *ptr)
 void msm_gem_shrinker_init(struct drm_device *dev)
 {
 	struct msm_drm_private *priv = dev->dev_private;
+
+	INIT_WORK(&priv->shrinker_work, msm_gem_shrinker_worker);
+	atomic_long_set(&priv->shrinker_target, 0);
+
 	priv->shrinker.count_objects = msm_gem_shrinker_count;
 	priv->shrinker.scan_objects = msm_gem_shrinker_scan;
 	priv->shrinker.seeks = DEFAULT_SEEKS;
@@ -228,5 +278,6 @@ void msm_gem_shrinker_cleanup(struct drm_device *dev)
 	if (priv->shrinker.nr_deferred) {
 		WARN_ON(unregister_vmap_purge_notifier(&priv->vmap_notifier));
 		unregister_shrinker(&priv->shrinker);
+		cancel_work_sync(&priv->shrinker_work);
 	}
 }
@@ -89,11 +89,84 @@ void __msm_gem_submit_destroy(struct kref *kref)
 	kfree(submit);
 }
 
+/*
+ * Userspace tends to submit the same (often large) bo table over and over
+ * again, so the queue remembers the result of the last handle lookup.  The
+ * cache is invalidated whenever a handle is closed on the drm_file, since
+ * the handle could then be re-used for a different object.
+ *
+ * The cache holds no references, so it never keeps a closed object alive.
+ * The bump of the seqno on handle close is done under table_lock, before
+ * the handle drops its reference.  So while the seqno is unchanged under
+ * table_lock, every cached object is still pinned by its handle.
+ */
+#define BO_CACHE_MIN_BOS 16
+
+static bool submit_lookup_cached(struct msm_gem_submit *submit,
+		struct drm_file *file)
+{
+	struct msm_file_private *ctx = file->driver_priv;
+	struct msm_gpu_submitqueue *queue = submit->queue;
+	unsigned i;
+
+	if (queue->bo_cache.nr_bos != submit->nr_bos)
+		return false;
+
+	for (i = 0; i < submit->nr_bos; i++)
+		if (queue->bo_cache.bos[i].handle != submit->bos[i].handle)
+			return false;
+
+	spin_lock(&file->table_lock);
+
+	if (queue->bo_cache.seqno != atomic_read(&ctx->handle_seqno)) {
+		spin_unlock(&file->table_lock);
+		return false;
+	}
+
+	for (i = 0; i < submit->nr_bos; i++) {
+		struct msm_gem_object *msm_obj = queue->bo_cache.bos[i].obj;
+
+		drm_gem_object_get(&msm_obj->base);
+		submit->bos[i].obj = msm_obj;
+	}
+
+	spin_unlock(&file->table_lock);
+
+	return true;
+}
+
+static void submit_update_cache(struct msm_gem_submit *submit,
+		const uint32_t *handles, int seqno)
+{
+	struct msm_gpu_submitqueue *queue = submit->queue;
+	unsigned i;
+
+	msm_submitqueue_bo_cache_release(queue);
+
+	if (submit->nr_bos < BO_CACHE_MIN_BOS)
+		return;
+
+	queue->bo_cache.bos = kvmalloc_array(submit->nr_bos,
+			sizeof(queue->bo_cache.bos[0]), GFP_KERNEL);
+	if (!queue->bo_cache.bos)
+		return;
+
+	for (i = 0; i < submit->nr_bos; i++) {
+		queue->bo_cache.bos[i].handle = handles[i];
+		queue->bo_cache.bos[i].obj = submit->bos[i].obj;
+	}
+
+	queue->bo_cache.nr_bos = submit->nr_bos;
+	queue->bo_cache.seqno = seqno;
+}
+
 static int submit_lookup_objects(struct msm_gem_submit *submit,
 		struct drm_msm_gem_submit *args, struct drm_file *file)
 {
+	struct msm_file_private *ctx = file->driver_priv;
+	uint32_t *handles = NULL;
 	unsigned i;
-	int ret = 0;
+	int seqno, ret = 0;
 
 	for (i = 0; i < args->nr_bos; i++) {
 		struct drm_msm_gem_submit_bo submit_bo;
@@ -128,8 +201,26 @@ static int submit_lookup_objects(struct msm_gem_submit *submit,
 		submit->bos[i].iova  = submit_bo.presumed;
 	}
 
+	submit->nr_bos = args->nr_bos;
+	if (submit_lookup_cached(submit, file))
+		return 0;
+
+	/*
+	 * The handles share storage with the obj pointers, so stash
+	 * a copy for the cache before they are overwritten:
+	 */
+	if (args->nr_bos >= BO_CACHE_MIN_BOS) {
+		handles = kvmalloc_array(args->nr_bos, sizeof(*handles),
+					 GFP_KERNEL);
+		for (i = 0; handles && i < args->nr_bos; i++)
+			handles[i] = submit->bos[i].handle;
+	}
+
 	spin_lock(&file->table_lock);
 
+	/* Handles are closed with table_lock held, see msm_gem_close(): */
+	seqno = atomic_read(&ctx->handle_seqno);
+
 	for (i = 0; i < args->nr_bos; i++) {
 		struct drm_gem_object *obj;
 
@@ -154,6 +245,11 @@ static int submit_lookup_objects(struct msm_gem_submit *submit,
 out:
 	submit->nr_bos = i;
 
+	if (!ret && handles)
+		submit_update_cache(submit, handles, seqno);
+
+	kvfree(handles);
+
 	return ret;
 }
 
@@ -927,6 +1023,7 @@ int msm_ioctl_gem_submit(struct drm_device *dev, void *data,
 	/* The scheduler owns a ref now: */
 	msm_gem_submit_get(submit);
 
+	submit->queue_time = ktime_get();
 	drm_sched_entity_push_job(&submit->base);
 
 	args->fence = submit->fence_id;
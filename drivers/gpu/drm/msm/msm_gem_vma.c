@@ -113,7 +113,7 @@ msm_gem_map_vma(struct msm_gem_address_space *aspace,
 
 	if (aspace && aspace->mmu)
 		ret = aspace->mmu->funcs->map(aspace->mmu, vma->iova, sgt,
-				size, prot);
+				vma->offset, size, prot);
 
 	if (ret) {
 		vma->mapped = false;
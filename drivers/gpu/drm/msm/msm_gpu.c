@@ -156,6 +156,8 @@ void msm_gpu_show_fdinfo(struct msm_gpu *gpu, struct msm_file_private *ctx,
 	drm_printf(p, "drm-client-id:\t%u\n", ctx->seqno);
 	drm_printf(p, "drm-engine-gpu:\t%llu ns\n", ctx->elapsed_ns);
 	drm_printf(p, "drm-cycles-gpu:\t%llu\n", ctx->cycles);
+	drm_printf(p, "msm-sched-wait-gpu:\t%llu ns\n", ctx->sched_wait_ns);
+	drm_printf(p, "msm-ring-wait-gpu:\t%llu ns\n", ctx->ring_wait_ns);
 	drm_printf(p, "drm-maxfreq-gpu:\t%u Hz\n", gpu->fast_rate);
 }
 
@@ -630,6 +632,7 @@ static void retire_submit(struct msm_gpu *gpu, struct msm_ringbuffer *ring,
 {
 	int index = submit->seqno % MSM_GPU_SUBMIT_STATS_COUNT;
 	volatile struct msm_gpu_submit_stats *stats;
+	struct msm_file_private *ctx = submit->queue->ctx;
 	u64 elapsed, clock = 0, cycles;
 	unsigned long flags;
 
@@ -646,8 +649,11 @@ static void retire_submit(struct msm_gpu *gpu, struct msm_ringbuffer *ring,
 		do_div(clock, elapsed);
 	}
 
-	submit->queue->ctx->elapsed_ns += elapsed;
-	submit->queue->ctx->cycles     += cycles;
+	ctx->elapsed_ns += elapsed;
+	ctx->cycles     += cycles;
+
+	ctx->sched_wait_ns += ktime_to_ns(ktime_sub(submit->run_time,
+						    submit->queue_time));
 
 	trace_msm_gpu_submit_retired(submit, elapsed, clock,
 		stats->alwayson_start, stats->alwayson_end);
@@ -682,6 +688,8 @@ static void retire_submits(struct msm_gpu *gpu)
 	for (i = 0; i < gpu->nr_rings; i++) {
 		struct msm_ringbuffer *ring = gpu->rb[i];
 
+		msm_fence_signal_completed(ring->fctx);
+
 		while (true) {
 			struct msm_gem_submit *submit = NULL;
 			unsigned long flags;
@@ -733,6 +741,7 @@ void msm_gpu_submit(struct msm_gpu *gpu, struct msm_gem_submit *submit)
 	struct msm_drm_private *priv = dev->dev_private;
 	struct msm_ringbuffer *ring = submit->ring;
 	unsigned long flags;
+	ktime_t start;
 
 	WARN_ON(!mutex_is_locked(&gpu->lock));
 
@@ -741,6 +750,7 @@ void msm_gpu_submit(struct msm_gpu *gpu, struct msm_gem_submit *submit)
 	msm_gpu_hw_init(gpu);
 
 	submit->seqno = submit->hw_fence->seqno;
+	submit->run_time = ktime_get();
 
 	msm_rd_dump_submit(priv->rd, submit, NULL);
 
@@ -765,7 +775,14 @@ void msm_gpu_submit(struct msm_gpu *gpu, struct msm_gem_submit *submit)
 	gpu->active_submits++;
 	mutex_unlock(&gpu->active_lock);
 
+	/*
+	 * The backend waits for room in the ringbuffer while it writes the
+	 * commands, which is what makes up most of the time spent in here:
+	 */
+	start = ktime_get();
 	gpu->funcs->submit(gpu, submit);
+	submit->queue->ctx->ring_wait_ns +=
+		ktime_to_ns(ktime_sub(ktime_get(), start));
 	gpu->cur_ctx_seqno = submit->queue->ctx->seqno;
 
 	pm_runtime_put(&gpu->pdev->dev);
@@ -960,6 +977,8 @@ int msm_gpu_init(struct drm_device *drm, struct platform_device *pdev,
 
 	refcount_set(&gpu->sysprof_active, 1);
 
+	msm_perf_pmu_init(gpu);
+
 	return 0;
 
 fail:
@@ -980,6 +999,8 @@ void msm_gpu_cleanup(struct msm_gpu *gpu)
 
 	DBG("%s", gpu->name);
 
+	msm_perf_pmu_cleanup(gpu);
+
 	for (i = 0; i < ARRAY_SIZE(gpu->rb); i++) {
 		msm_ringbuffer_destroy(gpu->rb[i]);
 		gpu->rb[i] = NULL;
@@ -11,6 +11,7 @@
 #include <linux/clk.h>
 #include <linux/devfreq.h>
 #include <linux/interconnect.h>
+#include <linux/perf_event.h>
 #include <linux/pm_opp.h>
 #include <linux/regulator/consumer.h>
 #include <linux/reset.h>
@@ -166,6 +167,13 @@ struct msm_gpu {
 	uint32_t last_cntrs[5];            /* hw counters */
 	const struct msm_gpu_perfcntr *perfcntrs;
 	uint32_t num_perfcntrs;
+#ifdef CONFIG_PERF_EVENTS
+	struct pmu pmu;                    /* perf PMU, see msm_perf.c */
+	bool pmu_registered;
+	unsigned int pmu_cpu;              /* CPU the PMU counts on */
+	int pmu_cpuhp_state;
+	struct hlist_node pmu_node;        /* cpuhp instance */
+#endif
 
 	struct msm_ringbuffer *rb[MSM_GPU_MAX_RINGS];
 	int nr_rings;
@@ -388,6 +396,24 @@ struct msm_file_private {
 	 */
 	uint64_t cycles;
 
+	/**
+	 * sched_wait_ns:
+	 *
+	 * The total (cumulative) time submits from this context spent
+	 * queued in the scheduler before being written to the ringbuffer,
+	 * ie. waiting behind other contexts' jobs or on their dependencies.
+	 */
+	uint64_t sched_wait_ns;
+
+	/**
+	 * ring_wait_ns:
+	 *
+	 * The total (cumulative) time spent writing submits from this
+	 * context to the ringbuffer, ie. mostly waiting for the GPU to free
+	 * up enough space in it.
+	 */
+	uint64_t ring_wait_ns;
+
 	/**
 	 * entities:
 	 *
@@ -400,6 +426,15 @@ struct msm_file_private {
 	 * level.
 	 */
 	struct drm_sched_entity *entities[NR_SCHED_PRIORITIES * MSM_GPU_MAX_RINGS];
+
+	/**
+	 * handle_seqno:
+	 *
+	 * Incremented each time a GEM handle is closed on the associated
+	 * &drm_file, to invalidate submitqueue bo lookup caches which may
+	 * have a stale handle-to-object mapping.
+	 */
+	atomic_t handle_seqno;
 };
 
 /**
@@ -472,6 +507,9 @@ static inline int msm_gpu_convert_priority(struct msm_gpu *gpu, int prio,
  * @lock:      submitqueue lock for serializing submits on a queue
  * @ref:       reference count
  * @entity:    the submit job-queue
+ * @bo_cache:  handle-to-object lookup result of the last submit's bo table,
+ *             reused when the next submit references the same handles,
+ *             protected by submitqueue lock; holds no object references
  */
 struct msm_gpu_submitqueue {
 	int id;
@@ -486,6 +524,14 @@ struct msm_gpu_submitqueue {
 	struct mutex lock;
 	struct kref ref;
 	struct drm_sched_entity *entity;
+	struct {
+		unsigned int nr_bos;
+		int seqno;
+		struct {
+			uint32_t handle;
+			struct msm_gem_object *obj;
+		} *bos;
+	} bo_cache;
 };
 
 struct msm_gpu_state_bo {
@@ -589,6 +635,7 @@ int msm_submitqueue_remove(struct msm_file_private *ctx, u32 id);
 void msm_submitqueue_close(struct msm_file_private *ctx);
 
 void msm_submitqueue_destroy(struct kref *kref);
+void msm_submitqueue_bo_cache_release(struct msm_gpu_submitqueue *queue);
 
 int msm_file_private_set_sysprof(struct msm_file_private *ctx,
 				 struct msm_gpu *gpu, int sysprof);
@@ -616,6 +663,14 @@ void msm_devfreq_idle(struct msm_gpu *gpu);
 
 int msm_gpu_hw_init(struct msm_gpu *gpu);
 
+#ifdef CONFIG_PERF_EVENTS
+void msm_perf_pmu_init(struct msm_gpu *gpu);
+void msm_perf_pmu_cleanup(struct msm_gpu *gpu);
+#else
+static inline void msm_perf_pmu_init(struct msm_gpu *gpu) {}
+static inline void msm_perf_pmu_cleanup(struct msm_gpu *gpu) {}
+#endif
+
 void msm_gpu_perfcntr_start(struct msm_gpu *gpu);
 void msm_gpu_perfcntr_stop(struct msm_gpu *gpu);
 int msm_gpu_perfcntr_sample(struct msm_gpu *gpu, uint32_t *activetime,
@@ -361,6 +361,13 @@ static void msm_devfreq_idle_work(struct kthread_work *work)
 
 	df->idle_time = ktime_get();
 
+	/*
+	 * The work that the boost was for has completed, so drop it
+	 * now rather than holding the higher freq until it expires:
+	 */
+	if (hrtimer_try_to_cancel(&df->boost_work.timer) > 0)
+		dev_pm_qos_update_request(&df->boost_freq, 0);
+
 	if (gpu->clamp_to_idle)
 		dev_pm_qos_update_request(&df->idle_freq, 0);
 }
@@ -26,10 +26,11 @@ static void msm_gpummu_detach(struct msm_mmu *mmu)
 }
 
 static int msm_gpummu_map(struct msm_mmu *mmu, uint64_t iova,
-		struct sg_table *sgt, size_t len, int prot)
+		struct sg_table *sgt, size_t off, size_t len, int prot)
 {
 	struct msm_gpummu *gpummu = to_msm_gpummu(mmu);
 	unsigned idx = (iova - GPUMMU_VA_START) / GPUMMU_PAGE_SIZE;
+	unsigned end = idx + len / GPUMMU_PAGE_SIZE;
 	struct sg_dma_page_iter dma_iter;
 	unsigned prot_bits = 0;
 
@@ -38,10 +39,13 @@ static int msm_gpummu_map(struct msm_mmu *mmu, uint64_t iova,
 	if (prot & IOMMU_READ)
 		prot_bits |= 2;
 
-	for_each_sgtable_dma_page(sgt, &dma_iter, 0) {
+	for_each_sgtable_dma_page(sgt, &dma_iter, off >> PAGE_SHIFT) {
 		dma_addr_t addr = sg_page_iter_dma_address(&dma_iter);
 		int i;
 
+		if (idx >= end)
+			break;
+
 		for (i = 0; i < PAGE_SIZE; i += GPUMMU_PAGE_SIZE)
 			gpummu->table[idx++] = (addr + i) | prot_bits;
 	}
@@ -111,7 +111,7 @@ static int msm_iommu_pagetable_unmap(struct msm_mmu *mmu, u64 iova,
 }
 
 static int msm_iommu_pagetable_map(struct msm_mmu *mmu, u64 iova,
-		struct sg_table *sgt, size_t len, int prot)
+		struct sg_table *sgt, size_t off, size_t len, int prot)
 {
 	struct msm_iommu_pagetable *pagetable = to_pagetable(mmu);
 	struct io_pgtable_ops *ops = pagetable->pgtbl_ops;
@@ -123,6 +123,20 @@ static int msm_iommu_pagetable_map(struct msm_mmu *mmu, u64 iova,
 		size_t size = sg->length;
 		phys_addr_t phys = sg_phys(sg);
 
+		/* skip over the part of the object before the mapping: */
+		if (off >= size) {
+			off -= size;
+			continue;
+		}
+
+		phys += off;
+		size -= off;
+		off = 0;
+
+		size = min_t(size_t, size, len - (addr - iova));
+		if (!size)
+			break;
+
 		while (size) {
 			size_t pgsize, count, mapped = 0;
 			int ret;
@@ -324,8 +338,60 @@ static void msm_iommu_detach(struct msm_mmu *mmu)
 	iommu_detach_device(iommu->domain, mmu->dev);
 }
 
+/*
+ * The sgt of an object is only DMA mapped for WC buffers, and then for the
+ * DMA API's domain, not the GPU's.  Like iommu_map_sgtable(), only look at
+ * the CPU side of the entries: their physical addresses and lengths.
+ */
+static size_t sgt_size(struct sg_table *sgt)
+{
+	struct scatterlist *sg;
+	size_t size = 0;
+	unsigned int i;
+
+	for_each_sgtable_sg(sgt, sg, i)
+		size += sg->length;
+
+	return size;
+}
+
+static int msm_iommu_map_range(struct msm_iommu *iommu, uint64_t iova,
+		struct sg_table *sgt, size_t off, size_t len, int prot)
+{
+	struct scatterlist *sg;
+	size_t mapped = 0;
+	unsigned int i;
+	int ret;
+
+	for_each_sgtable_sg(sgt, sg, i) {
+		size_t size = sg->length;
+		phys_addr_t phys = sg_phys(sg);
+
+		if (off >= size) {
+			off -= size;
+			continue;
+		}
+
+		phys += off;
+		size = min_t(size_t, size - off, len - mapped);
+		off = 0;
+
+		ret = iommu_map(iommu->domain, iova + mapped, phys, size, prot);
+		if (ret) {
+			iommu_unmap(iommu->domain, iova, mapped);
+			return ret;
+		}
+
+		mapped += size;
+		if (mapped == len)
+			break;
+	}
+
+	return (mapped == len) ? 0 : -EINVAL;
+}
+
 static int msm_iommu_map(struct msm_mmu *mmu, uint64_t iova,
-		struct sg_table *sgt, size_t len, int prot)
+		struct sg_table *sgt, size_t off, size_t len, int prot)
 {
 	struct msm_iommu *iommu = to_msm_iommu(mmu);
 	size_t ret;
@@ -334,6 +400,10 @@ static int msm_iommu_map(struct msm_mmu *mmu, uint64_t iova,
 	if (iova & BIT_ULL(48))
 		iova |= GENMASK_ULL(63, 49);
 
+	/* Partial mapping of the object: */
+	if (off || (len != sgt_size(sgt)))
+		return msm_iommu_map_range(iommu, iova, sgt, off, len, prot);
+
 	ret = iommu_map_sgtable(iommu->domain, iova, sgt, prot);
 	WARN_ON(!ret);
 
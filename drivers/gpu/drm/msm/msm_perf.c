@@ -12,9 +12,9 @@
  * and any gpu specific performance counters that are supported.
  */
 
-#ifdef CONFIG_DEBUG_FS
-
+#include <linux/cpuhotplug.h>
 #include <linux/debugfs.h>
+#include <linux/pm_runtime.h>
 #include <linux/uaccess.h>
 
 #include <drm/drm_file.h>
@@ -22,6 +22,8 @@
 #include "msm_drv.h"
 #include "msm_gpu.h"
 
+#ifdef CONFIG_DEBUG_FS
+
 struct msm_perf_state {
 	struct drm_device *dev;
 
@@ -234,3 +236,246 @@ void msm_perf_debugfs_cleanup(struct msm_drm_private *priv)
 }
 
 #endif
+
+#ifdef CONFIG_PERF_EVENTS
+
+/* The same counters are also exposed as a system-wide, counting only, perf
+ * PMU, so that GPU activity can be correlated with CPU side profiling:
+ *
+ *   perf stat -a -I 100 -e msm_gpu/event=0/,msm_gpu/event=1/ ...
+ *
+ * Event zero counts GPU busy cycles, events 1..N count the hw counters in
+ * the order they are listed in the header of the debugfs "perf" file.
+ *
+ * The counters don't count (or keep their state) while the GPU is
+ * suspended, so reading them doesn't wake it up.  Whatever counted between
+ * resume and the next read is lost.
+ */
+
+#define MSM_PMU_EVENT_BUSY	0
+#define MSM_PMU_STALE		U64_MAX
+
+static struct msm_gpu *pmu_to_gpu(struct pmu *pmu)
+{
+	return container_of(pmu, struct msm_gpu, pmu);
+}
+
+static void msm_pmu_event_update(struct perf_event *event)
+{
+	struct msm_gpu *gpu = pmu_to_gpu(event->pmu);
+	struct hw_perf_event *hwc = &event->hw;
+	u64 config = event->attr.config;
+	unsigned long sample_rate;
+	u64 prev, now, mask;
+
+	if (pm_runtime_get_if_in_use(&gpu->pdev->dev) <= 0) {
+		local64_set(&hwc->prev_count, MSM_PMU_STALE);
+		return;
+	}
+
+	if (config == MSM_PMU_EVENT_BUSY) {
+		now = gpu->funcs->gpu_busy(gpu, &sample_rate);
+		mask = U64_MAX;
+	} else {
+		now = gpu_read(gpu, gpu->perfcntrs[config - 1].sample_reg);
+		mask = U32_MAX;
+	}
+
+	pm_runtime_put_autosuspend(&gpu->pdev->dev);
+
+	prev = local64_read(&hwc->prev_count);
+	local64_set(&hwc->prev_count, now);
+
+	if (prev != MSM_PMU_STALE)
+		local64_add((now - prev) & mask, &event->count);
+}
+
+static int msm_pmu_event_init(struct perf_event *event)
+{
+	struct msm_gpu *gpu = pmu_to_gpu(event->pmu);
+	u64 config = event->attr.config;
+
+	if (event->attr.type != event->pmu->type)
+		return -ENOENT;
+
+	/* Only system-wide counting, there is no overflow interrupt: */
+	if (is_sampling_event(event) || (event->attach_state & PERF_ATTACH_TASK))
+		return -EOPNOTSUPP;
+
+	if (event->cpu < 0)
+		return -EINVAL;
+
+	/* All events of the PMU are counted on the same CPU: */
+	event->cpu = gpu->pmu_cpu;
+
+	if (config == MSM_PMU_EVENT_BUSY) {
+		if (!gpu->funcs->gpu_busy)
+			return -ENOENT;
+	} else if (config > gpu->num_perfcntrs) {
+		return -ENOENT;
+	}
+
+	local64_set(&event->hw.prev_count, MSM_PMU_STALE);
+
+	return 0;
+}
+
+static void msm_pmu_event_start(struct perf_event *event, int flags)
+{
+	event->hw.state = 0;
+	local64_set(&event->hw.prev_count, MSM_PMU_STALE);
+	msm_pmu_event_update(event);
+}
+
+static void msm_pmu_event_stop(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hwc = &event->hw;
+
+	if (hwc->state & PERF_HES_STOPPED)
+		return;
+
+	hwc->state |= PERF_HES_STOPPED;
+
+	if (flags & PERF_EF_UPDATE) {
+		msm_pmu_event_update(event);
+		hwc->state |= PERF_HES_UPTODATE;
+	}
+}
+
+static int msm_pmu_event_add(struct perf_event *event, int flags)
+{
+	event->hw.state = PERF_HES_STOPPED | PERF_HES_UPTODATE;
+
+	if (flags & PERF_EF_START)
+		msm_pmu_event_start(event, PERF_EF_RELOAD);
+
+	return 0;
+}
+
+static void msm_pmu_event_del(struct perf_event *event, int flags)
+{
+	msm_pmu_event_stop(event, PERF_EF_UPDATE);
+}
+
+static void msm_pmu_event_read(struct perf_event *event)
+{
+	msm_pmu_event_update(event);
+}
+
+PMU_FORMAT_ATTR(event, "config:0-7");
+
+static struct attribute *msm_pmu_format_attrs[] = {
+	&format_attr_event.attr,
+	NULL,
+};
+
+static const struct attribute_group msm_pmu_format_group = {
+	.name = "format",
+	.attrs = msm_pmu_format_attrs,
+};
+
+/* Counters are global to the GPU, so only count them on a single CPU: */
+static ssize_t cpumask_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct msm_gpu *gpu = pmu_to_gpu(dev_get_drvdata(dev));
+
+	return cpumap_print_to_pagebuf(true, buf, cpumask_of(gpu->pmu_cpu));
+}
+static DEVICE_ATTR_RO(cpumask);
+
+static struct attribute *msm_pmu_cpumask_attrs[] = {
+	&dev_attr_cpumask.attr,
+	NULL,
+};
+
+static const struct attribute_group msm_pmu_cpumask_group = {
+	.attrs = msm_pmu_cpumask_attrs,
+};
+
+static const struct attribute_group *msm_pmu_attr_groups[] = {
+	&msm_pmu_format_group,
+	&msm_pmu_cpumask_group,
+	NULL,
+};
+
+/* Move the events off a CPU going offline, like the uncore PMUs do: */
+static int msm_pmu_offline_cpu(unsigned int cpu, struct hlist_node *node)
+{
+	struct msm_gpu *gpu = hlist_entry_safe(node, struct msm_gpu, pmu_node);
+	unsigned int target;
+
+	if (cpu != gpu->pmu_cpu)
+		return 0;
+
+	target = cpumask_any_but(cpu_online_mask, cpu);
+	if (target >= nr_cpu_ids)
+		return 0;
+
+	perf_pmu_migrate_context(&gpu->pmu, cpu, target);
+	gpu->pmu_cpu = target;
+
+	return 0;
+}
+
+void msm_perf_pmu_init(struct msm_gpu *gpu)
+{
+	int ret;
+
+	ret = cpuhp_setup_state_multi(CPUHP_AP_ONLINE_DYN,
+				      "perf/msm_gpu:online", NULL,
+				      msm_pmu_offline_cpu);
+	if (ret < 0) {
+		DRM_DEV_INFO(&gpu->pdev->dev,
+			     "could not set up perf PMU hotplug: %d\n", ret);
+		return;
+	}
+	gpu->pmu_cpuhp_state = ret;
+
+	gpu->pmu_cpu = raw_smp_processor_id();
+	ret = cpuhp_state_add_instance_nocalls(gpu->pmu_cpuhp_state,
+					       &gpu->pmu_node);
+	if (ret)
+		goto out_remove_state;
+
+	gpu->pmu = (struct pmu) {
+		.module		= THIS_MODULE,
+		.task_ctx_nr	= perf_invalid_context,
+		.attr_groups	= msm_pmu_attr_groups,
+		.capabilities	= PERF_PMU_CAP_NO_EXCLUDE,
+		.event_init	= msm_pmu_event_init,
+		.add		= msm_pmu_event_add,
+		.del		= msm_pmu_event_del,
+		.start		= msm_pmu_event_start,
+		.stop		= msm_pmu_event_stop,
+		.read		= msm_pmu_event_read,
+	};
+
+	ret = perf_pmu_register(&gpu->pmu, "msm_gpu", -1);
+	if (ret)
+		goto out_remove_instance;
+
+	gpu->pmu_registered = true;
+	return;
+
+out_remove_instance:
+	cpuhp_state_remove_instance_nocalls(gpu->pmu_cpuhp_state,
+					    &gpu->pmu_node);
+out_remove_state:
+	cpuhp_remove_multi_state(gpu->pmu_cpuhp_state);
+	DRM_DEV_INFO(&gpu->pdev->dev, "could not register perf PMU: %d\n", ret);
+}
+
+void msm_perf_pmu_cleanup(struct msm_gpu *gpu)
+{
+	if (!gpu->pmu_registered)
+		return;
+
+	perf_pmu_unregister(&gpu->pmu);
+	cpuhp_state_remove_instance_nocalls(gpu->pmu_cpuhp_state,
+					    &gpu->pmu_node);
+	cpuhp_remove_multi_state(gpu->pmu_cpuhp_state);
+	gpu->pmu_registered = false;
+}
+
+#endif
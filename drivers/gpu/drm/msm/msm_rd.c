@@ -27,6 +27,13 @@
  * all (non-written) buffers in the submit, rather than just cmdstream bo's.
  * This is useful to capture the contents of (for example) vbo's or textures,
  * or shader programs (if not emitted inline in cmdstream).
+ *
+ * Since writing into the fifo stalls the submit path until userspace has
+ * read it out, the module-params "rd_sample" and "rd_pid" can be used to
+ * limit the capture to every Nth submit, and/or to submits from a single
+ * process, to keep the overhead down when recording on a live system.
+ * These only apply to "rd", submits which triggered a hang are always
+ * captured to "hangrd".
  */
 
 #include <linux/circ_buf.h>
@@ -45,6 +52,14 @@ bool rd_full = false;
 MODULE_PARM_DESC(rd_full, "If true, $debugfs/.../rd will snapshot all buffer contents");
 module_param_named(rd_full, rd_full, bool, 0600);
 
+static uint rd_sample = 1;
+MODULE_PARM_DESC(rd_sample, "Only capture every Nth submit in $debugfs/.../rd (default 1, ie. all)");
+module_param(rd_sample, uint, 0600);
+
+static int rd_pid;
+MODULE_PARM_DESC(rd_pid, "Only capture submits from this pid in $debugfs/.../rd (default 0, ie. all)");
+module_param(rd_pid, int, 0600);
+
 #ifdef CONFIG_DEBUG_FS
 
 enum rd_sect_type {
@@ -86,6 +101,9 @@ struct msm_rd_state {
 	/* current submit to read out: */
 	struct msm_gem_submit *submit;
 
+	/* number of submits seen, for rd_sample: */
+	unsigned count;
+
 	/* fifo access is synchronized on the producer side by
 	 * gpu->lock held by submit code (otherwise we could
 	 * end up w/ cmds logged in different order than they
@@ -198,6 +216,7 @@ static int rd_open(struct inode *inode, struct file *file)
 
 	/* Reset fifo to clear any previously unread data: */
 	rd->fifo.head = rd->fifo.tail = 0;
+	rd->count = 0;
 
 	/* the parsing tools need to know gpu-id to know which
 	 * register database to load.
@@ -369,6 +388,18 @@ void msm_rd_dump_submit(struct msm_rd_state *rd, struct msm_gem_submit *submit,
 	 */
 	WARN_ON(!mutex_is_locked(&submit->gpu->lock));
 
+	/* sampling only applies to regular submits, not hangs: */
+	if (!fmt) {
+		unsigned sample = READ_ONCE(rd_sample);
+		int pid = READ_ONCE(rd_pid);
+
+		if (pid && (pid != pid_nr(submit->pid)))
+			return;
+
+		if ((sample > 1) && (rd->count++ % sample))
+			return;
+	}
+
 	if (fmt) {
 		va_list args;
 
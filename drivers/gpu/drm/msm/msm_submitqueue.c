@@ -66,11 +66,19 @@ void __msm_file_private_destroy(struct kref *kref)
 	kfree(ctx);
 }
 
+void msm_submitqueue_bo_cache_release(struct msm_gpu_submitqueue *queue)
+{
+	kvfree(queue->bo_cache.bos);
+	queue->bo_cache.bos = NULL;
+	queue->bo_cache.nr_bos = 0;
+}
+
 void msm_submitqueue_destroy(struct kref *kref)
 {
 	struct msm_gpu_submitqueue *queue = container_of(kref,
 		struct msm_gpu_submitqueue, ref);
 
+	msm_submitqueue_bo_cache_release(queue);
 	idr_destroy(&queue->fence_idr);
 
 	msm_file_private_put(queue->ctx);
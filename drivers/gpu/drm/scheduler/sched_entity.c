@@ -479,14 +479,23 @@ void drm_sched_entity_select_rq(struct drm_sched_entity *entity)
 	if (fence && !dma_fence_is_signaled(fence))
 		return;
 
-	spin_lock(&entity->rq_lock);
+	/*
+	 * Picking the least loaded scheduler only needs atomic score reads,
+	 * so do it without the lock.  Most of the time the entity stays on
+	 * the same run queue, in which case there is nothing to update.
+	 * A racing priority change is picked up on a later call.
+	 */
 	sched = drm_sched_pick_best(entity->sched_list, entity->num_sched_list);
-	rq = sched ? &sched->sched_rq[entity->priority] : NULL;
-	if (rq != entity->rq) {
-		drm_sched_rq_remove_entity(entity->rq, entity);
-		entity->rq = rq;
+	rq = sched ? &sched->sched_rq[READ_ONCE(entity->priority)] : NULL;
+	if (rq != READ_ONCE(entity->rq)) {
+		spin_lock(&entity->rq_lock);
+		rq = sched ? &sched->sched_rq[entity->priority] : NULL;
+		if (rq != entity->rq) {
+			drm_sched_rq_remove_entity(entity->rq, entity);
+			entity->rq = rq;
+		}
+		spin_unlock(&entity->rq_lock);
 	}
-	spin_unlock(&entity->rq_lock);
 
 	if (entity->num_sched_list == 1)
 		entity->sched_list = NULL;
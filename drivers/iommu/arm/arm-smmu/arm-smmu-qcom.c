@@ -260,6 +260,11 @@ static int qcom_smmu_init_context(struct arm_smmu_domain *smmu_domain,
 		struct io_pgtable_cfg *pgtbl_cfg, struct device *dev)
 {
 	smmu_domain->cfg.flush_walk_prefer_tlbiasid = true;
+	/*
+	 * Streaming DMA clients unmap at a high rate: issue the leaf TLBIs of
+	 * an unmap as one range at sync time rather than page by page.
+	 */
+	smmu_domain->cfg.gather_leaf_tlbi = true;
 
 	return 0;
 }
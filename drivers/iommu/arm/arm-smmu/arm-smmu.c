@@ -53,6 +53,12 @@
 #define MSI_IOVA_BASE			0x8000000
 #define MSI_IOVA_LENGTH			0x100000
 
+/*
+ * Above this many pages, invalidating the whole ASID costs less than walking
+ * the gathered range one TLBIVAL at a time.
+ */
+#define ARM_SMMU_MAX_TLBI_OPS		512
+
 static int force_stage;
 module_param(force_stage, int, S_IRUGO);
 MODULE_PARM_DESC(force_stage,
@@ -326,6 +332,15 @@ static void arm_smmu_tlb_add_page_s1(struct iommu_iotlb_gather *gather,
 				     unsigned long iova, size_t granule,
 				     void *cookie)
 {
+	struct arm_smmu_domain *smmu_domain = cookie;
+
+	/* Leave it to arm_smmu_iotlb_sync() to invalidate the whole range */
+	if (smmu_domain->cfg.gather_leaf_tlbi && gather) {
+		iommu_iotlb_gather_add_page(&smmu_domain->domain, gather, iova,
+					    granule);
+		return;
+	}
+
 	arm_smmu_tlb_inv_range_s1(iova, granule, granule, cookie,
 				  ARM_SMMU_CB_S1_TLBIVAL);
 }
@@ -1227,6 +1242,31 @@ static void arm_smmu_flush_iotlb_all(struct iommu_domain *domain)
 	}
 }
 
+/*
+ * Invalidate the leaf entries collected by arm_smmu_tlb_add_page_s1() and wait
+ * for the invalidation to complete.
+ */
+static void arm_smmu_tlb_inv_gather_s1(struct arm_smmu_domain *smmu_domain,
+				       struct iommu_iotlb_gather *gather)
+{
+	size_t size;
+
+	if (!gather->pgsize || gather->start > gather->end) {
+		arm_smmu_tlb_sync_context(smmu_domain);
+		return;
+	}
+
+	size = gather->end - gather->start + 1;
+	if (size / gather->pgsize > ARM_SMMU_MAX_TLBI_OPS) {
+		arm_smmu_tlb_inv_context_s1(smmu_domain);
+		return;
+	}
+
+	arm_smmu_tlb_inv_range_s1(gather->start, size, gather->pgsize,
+				  smmu_domain, ARM_SMMU_CB_S1_TLBIVAL);
+	arm_smmu_tlb_sync_context(smmu_domain);
+}
+
 static void arm_smmu_iotlb_sync(struct iommu_domain *domain,
 				struct iommu_iotlb_gather *gather)
 {
@@ -1237,6 +1277,13 @@ static void arm_smmu_iotlb_sync(struct iommu_domain *domain,
 		return;
 
 	arm_smmu_rpm_get(smmu);
+	if (smmu_domain->cfg.gather_leaf_tlbi &&
+	    smmu_domain->stage == ARM_SMMU_DOMAIN_S1) {
+		arm_smmu_tlb_inv_gather_s1(smmu_domain, gather);
+		arm_smmu_rpm_put(smmu);
+		return;
+	}
+
 	if (smmu->version == ARM_SMMU_V2 ||
 	    smmu_domain->stage == ARM_SMMU_DOMAIN_S1)
 		arm_smmu_tlb_sync_context(smmu_domain);
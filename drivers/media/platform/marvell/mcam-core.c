@@ -372,6 +372,13 @@ static int mcam_alloc_dma_bufs(struct mcam_camera *cam, int loadtime)
 	if (n_dma_bufs > 3)
 		n_dma_bufs = 3;
 
+	/*
+	 * Let CMA migrate the pages for all buffers in parallel rather
+	 * than one buffer after the other.
+	 */
+	dma_contiguous_prefill(cam->dev, cam->dma_buf_size, n_dma_bufs,
+			       GFP_KERNEL);
+
 	cam->nbufs = 0;
 	for (i = 0; i < n_dma_bufs; i++) {
 		cam->dma_bufs[i] = dma_alloc_coherent(cam->dev,
@@ -383,6 +390,7 @@ static int mcam_alloc_dma_bufs(struct mcam_camera *cam, int loadtime)
 		}
 		(cam->nbufs)++;
 	}
+	dma_contiguous_drain(cam->dev, cam->dma_buf_size);
 
 	switch (cam->nbufs) {
 	case 1:
@@ -474,6 +474,7 @@ static int vfe_enable_output(struct vfe_line *line)
 	output->state = VFE_OUTPUT_ON;
 
 	output->sequence = 0;
+	vfe_stats_reset(output);
 	output->wait_reg_update = 0;
 	reinit_completion(&output->reg_update);
 
@@ -600,7 +601,12 @@ static int vfe_disable(struct vfe_line *line)
  */
 static void vfe_isr_sof(struct vfe_device *vfe, enum vfe_line_id line_id)
 {
-	/* nop */
+	u64 ts = ktime_get_ns();
+	unsigned long flags;
+
+	spin_lock_irqsave(&vfe->output_lock, flags);
+	vfe_stats_sof(&vfe->line[line_id].output, ts);
+	spin_unlock_irqrestore(&vfe->output_lock, flags);
 }
 
 /*
@@ -665,6 +671,7 @@ static void vfe_isr_wm_done(struct vfe_device *vfe, u8 wm)
 		index = 1;
 
 	output->buf[index] = vfe_buf_get_pending(output);
+	vfe_stats_buf_done(output, ts, !output->buf[index]);
 
 	if (output->buf[index])
 		vfe_wm_update(vfe, output->wm_idx[0], output->buf[index]->addr[0], line);
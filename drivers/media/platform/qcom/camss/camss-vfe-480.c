@@ -291,6 +291,7 @@ static int vfe_enable_output(struct vfe_line *line)
 	output->state = VFE_OUTPUT_ON;
 
 	output->sequence = 0;
+	vfe_stats_reset(output);
 	output->wait_reg_update = 0;
 	reinit_completion(&output->reg_update);
 
@@ -472,6 +473,7 @@ static void vfe_isr_wm_done(struct vfe_device *vfe, u8 wm)
 		index = 1;
 
 	output->buf[index] = vfe_buf_get_pending(output);
+	vfe_stats_buf_done(output, ts, !output->buf[index]);
 
 	if (output->buf[index])
 		vfe_wm_update(vfe, output->wm_idx[0], output->buf[index]->addr[0], line);
@@ -228,6 +228,7 @@ static int vfe_enable_output(struct vfe_line *line)
 	}
 
 	output->sequence = 0;
+	vfe_stats_reset(output);
 	output->gen1.wait_sof = 0;
 	output->wait_reg_update = 0;
 	reinit_completion(&output->sof);
@@ -526,6 +527,7 @@ static void vfe_isr_sof(struct vfe_device *vfe, enum vfe_line_id line_id)
 
 	spin_lock_irqsave(&vfe->output_lock, flags);
 	output = &vfe->line[line_id].output;
+	vfe_stats_sof(output, ktime_get_ns());
 	if (output->gen1.wait_sof) {
 		output->gen1.wait_sof = 0;
 		complete(&output->sof);
@@ -646,6 +648,7 @@ static void vfe_isr_wm_done(struct vfe_device *vfe, u8 wm)
 
 	/* Get next buffer */
 	output->buf[!active_index] = vfe_buf_get_pending(output);
+	vfe_stats_buf_done(output, ts, !output->buf[!active_index]);
 	if (!output->buf[!active_index]) {
 		/* No next buffer - set same address */
 		new_addr = ready_buf->addr;
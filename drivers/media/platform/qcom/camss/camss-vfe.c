@@ -9,12 +9,15 @@
  */
 #include <linux/clk.h>
 #include <linux/completion.h>
+#include <linux/debugfs.h>
 #include <linux/interrupt.h>
 #include <linux/iommu.h>
+#include <linux/math64.h>
 #include <linux/mutex.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
 #include <linux/pm_runtime.h>
+#include <linux/seq_file.h>
 #include <linux/spinlock_types.h>
 #include <linux/spinlock.h>
 #include <media/media-entity.h>
@@ -372,6 +375,82 @@ void vfe_buf_add_pending(struct vfe_output *output,
 	list_add_tail(&buffer->queue, &output->pending_bufs);
 }
 
+/*
+ * Frame timing statistics. These are called with output_lock held, from the
+ * interrupt handlers, and let userspace see how close the pipeline gets to
+ * running out of buffers at high frame rates.
+ */
+void vfe_stats_reset(struct vfe_output *output)
+{
+	memset(&output->stats, 0, sizeof(output->stats));
+}
+
+void vfe_stats_sof(struct vfe_output *output, u64 ts)
+{
+	output->stats.sof_ts = ts;
+}
+
+void vfe_stats_buf_done(struct vfe_output *output, u64 ts, bool underrun)
+{
+	struct vfe_output_stats *stats = &output->stats;
+	u64 latency;
+
+	stats->frames++;
+	if (underrun)
+		stats->underruns++;
+
+	if (stats->done_ts)
+		stats->interval_max = max(stats->interval_max,
+					  ts - stats->done_ts);
+	stats->done_ts = ts;
+
+	if (!stats->sof_ts || stats->sof_ts > ts)
+		return;
+
+	latency = ts - stats->sof_ts;
+	if (!stats->latency_cnt || latency < stats->latency_min)
+		stats->latency_min = latency;
+	stats->latency_max = max(stats->latency_max, latency);
+	stats->latency_sum += latency;
+	stats->latency_cnt++;
+	stats->sof_ts = 0;
+}
+
+static int vfe_stats_show(struct seq_file *s, void *data)
+{
+	struct vfe_device *vfe = s->private;
+	struct vfe_output_stats stats;
+	struct camss_buffer *buf;
+	unsigned long flags;
+	unsigned int pending;
+	int i;
+
+	for (i = 0; i < vfe->line_num; i++) {
+		struct vfe_output *output = &vfe->line[i].output;
+
+		spin_lock_irqsave(&vfe->output_lock, flags);
+		stats = output->stats;
+		pending = 0;
+		list_for_each_entry(buf, &output->pending_bufs, queue)
+			pending++;
+		spin_unlock_irqrestore(&vfe->output_lock, flags);
+
+		seq_printf(s, "line%d: frames %llu underruns %llu pending %u\n",
+			   i, stats.frames, stats.underruns, pending);
+		/* Not every VFE version gets a start of frame interrupt */
+		if (stats.latency_cnt)
+			seq_printf(s, "  sof-done latency ns: min %llu max %llu avg %llu\n",
+				   stats.latency_min, stats.latency_max,
+				   div64_u64(stats.latency_sum,
+					     stats.latency_cnt));
+		seq_printf(s, "  max frame interval ns: %llu\n",
+			   stats.interval_max);
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(vfe_stats);
+
 /*
  * vfe_buf_flush_pending - Flush all pending buffers.
  * @output: VFE output
@@ -1493,6 +1572,7 @@ int msm_vfe_register_entities(struct vfe_device *vfe,
 	struct v4l2_subdev *sd;
 	struct media_pad *pads;
 	struct camss_video *video_out;
+	char dbg_name[16];
 	int ret;
 	int i;
 
@@ -1568,6 +1648,10 @@ int msm_vfe_register_entities(struct vfe_device *vfe,
 		}
 	}
 
+	snprintf(dbg_name, ARRAY_SIZE(dbg_name), "vfe%d_stats", vfe->id);
+	debugfs_create_file(dbg_name, 0444, vfe->camss->debugfs, vfe,
+			    &vfe_stats_fops);
+
 	return 0;
 
 error_link:
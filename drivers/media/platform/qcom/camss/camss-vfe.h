@@ -58,6 +58,30 @@ enum vfe_line_id {
 	VFE_LINE_NUM_MAX = 4
 };
 
+/*
+ * struct vfe_output_stats - per output frame timing, all times in ns
+ * @frames: number of buffers completed
+ * @underruns: completions after which no buffer was left to program
+ * @sof_ts: time of the last start of frame not yet matched by a buffer done
+ * @done_ts: time of the last buffer done
+ * @latency_min: minimum start of frame to buffer done latency
+ * @latency_max: maximum start of frame to buffer done latency
+ * @latency_sum: sum of all start of frame to buffer done latencies
+ * @latency_cnt: number of latency samples
+ * @interval_max: maximum time between two buffer done events
+ */
+struct vfe_output_stats {
+	u64 frames;
+	u64 underruns;
+	u64 sof_ts;
+	u64 done_ts;
+	u64 latency_min;
+	u64 latency_max;
+	u64 latency_sum;
+	u64 latency_cnt;
+	u64 interval_max;
+};
+
 struct vfe_output {
 	u8 wm_num;
 	u8 wm_idx[3];
@@ -83,6 +107,8 @@ struct vfe_output {
 	int wait_reg_update;
 	struct completion sof;
 	struct completion reg_update;
+
+	struct vfe_output_stats stats;
 };
 
 struct vfe_line {
@@ -172,6 +198,10 @@ void vfe_buf_add_pending(struct vfe_output *output, struct camss_buffer *buffer)
 
 struct camss_buffer *vfe_buf_get_pending(struct vfe_output *output);
 
+void vfe_stats_reset(struct vfe_output *output);
+void vfe_stats_sof(struct vfe_output *output, u64 ts);
+void vfe_stats_buf_done(struct vfe_output *output, u64 ts, bool underrun);
+
 int vfe_flush_buffers(struct camss_video *vid, enum vb2_buffer_state state);
 
 /*
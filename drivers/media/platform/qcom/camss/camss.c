@@ -8,6 +8,7 @@
  * Copyright (C) 2015-2018 Linaro Ltd.
  */
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/interconnect.h>
 #include <linux/media-bus-format.h>
 #include <linux/media.h>
@@ -1637,6 +1638,8 @@ static int camss_probe(struct platform_device *pdev)
 		goto err_cleanup;
 	}
 
+	camss->debugfs = debugfs_create_dir(dev_name(dev), NULL);
+
 	ret = camss_register_entities(camss);
 	if (ret < 0)
 		goto err_register_entities;
@@ -1681,6 +1684,7 @@ static int camss_probe(struct platform_device *pdev)
 err_register_subdevs:
 	camss_unregister_entities(camss);
 err_register_entities:
+	debugfs_remove_recursive(camss->debugfs);
 	v4l2_device_unregister(&camss->v4l2_dev);
 err_cleanup:
 	v4l2_async_nf_cleanup(&camss->notifier);
@@ -1716,6 +1720,7 @@ static int camss_remove(struct platform_device *pdev)
 
 	v4l2_async_nf_unregister(&camss->notifier);
 	v4l2_async_nf_cleanup(&camss->notifier);
+	debugfs_remove_recursive(camss->debugfs);
 	camss_unregister_entities(camss);
 
 	if (atomic_read(&camss->ref_count) == 0)
@@ -22,6 +22,7 @@
 
 #include "core.h"
 #include "firmware.h"
+#include "helpers.h"
 #include "pm_helpers.h"
 #include "hfi_venus_io.h"
 
@@ -330,6 +331,8 @@ static int venus_probe(struct platform_device *pdev)
 
 	INIT_LIST_HEAD(&core->instances);
 	mutex_init(&core->lock);
+	INIT_LIST_HEAD(&core->intbuf_pool);
+	mutex_init(&core->intbuf_pool_lock);
 	INIT_DELAYED_WORK(&core->work, venus_sys_error_handler);
 	init_waitqueue_head(&core->sys_err_done);
 
@@ -444,8 +447,11 @@ static int venus_remove(struct platform_device *pdev)
 
 	hfi_destroy(core);
 
+	venus_helper_intbuf_pool_drain(core);
+
 	mutex_destroy(&core->pm_lock);
 	mutex_destroy(&core->lock);
+	mutex_destroy(&core->intbuf_pool_lock);
 	venus_dbgfs_deinit(core);
 
 	return ret;
@@ -471,6 +477,9 @@ static __maybe_unused int venus_runtime_suspend(struct device *dev)
 	if (ret)
 		return ret;
 
+	/* nothing is using the pooled buffers while the core is idle */
+	venus_helper_intbuf_pool_drain(core);
+
 	if (pm_ops->core_power) {
 		ret = pm_ops->core_power(core, POWER_OFF);
 		if (ret)
@@ -144,6 +144,9 @@ struct venus_format {
  * @core0_usage_count: usage counter for core0
  * @core1_usage_count: usage counter for core1
  * @root:	debugfs root directory
+ * @intbuf_pool:	a list of internal buffers released by past sessions
+ * @intbuf_pool_size:	total size of buffers in @intbuf_pool
+ * @intbuf_pool_lock:	a lock for @intbuf_pool
  */
 struct venus_core {
 	void __iomem *base;
@@ -202,6 +205,9 @@ struct venus_core {
 	unsigned int core0_usage_count;
 	unsigned int core1_usage_count;
 	struct dentry *root;
+	struct list_head intbuf_pool;
+	size_t intbuf_pool_size;
+	struct mutex intbuf_pool_lock;
 };
 
 struct vdec_controls {
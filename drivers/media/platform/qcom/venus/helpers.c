@@ -6,6 +6,7 @@
 #include <linux/idr.h>
 #include <linux/list.h>
 #include <linux/mutex.h>
+#include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/kernel.h>
 #include <media/videobuf2-dma-contig.h>
@@ -38,6 +39,105 @@ struct intbuf {
 	u32 dpb_out_tag;
 };
 
+/*
+ * Upper bound on the memory kept in the core wide pool of released internal
+ * and DPB buffers. Buffers beyond that are freed right away.
+ */
+#define INTBUF_POOL_MAX_SIZE	SZ_64M
+
+#define INTBUF_ATTRS	(DMA_ATTR_WRITE_COMBINE | DMA_ATTR_NO_KERNEL_MAPPING)
+
+static bool intbuf_is_persist(u32 type)
+{
+	return type == HFI_BUFFER_INTERNAL_PERSIST ||
+	       type == HFI_BUFFER_INTERNAL_PERSIST_1;
+}
+
+/*
+ * Internal and DPB buffers are allocated and mapped every time a session
+ * starts or the stream resolution changes. Take them from a pool of buffers
+ * released by earlier sessions first, which saves the allocation and the
+ * IOMMU mapping when streams are restarted at the same resolution. Persist
+ * buffers carry firmware session state and are always freshly allocated.
+ */
+static struct intbuf *intbuf_get(struct venus_core *core, u32 type, size_t size)
+{
+	struct intbuf *buf;
+
+	if (!intbuf_is_persist(type)) {
+		mutex_lock(&core->intbuf_pool_lock);
+		list_for_each_entry(buf, &core->intbuf_pool, list) {
+			if (buf->size != size)
+				continue;
+
+			list_del_init(&buf->list);
+			core->intbuf_pool_size -= buf->size;
+			mutex_unlock(&core->intbuf_pool_lock);
+
+			buf->type = type;
+			return buf;
+		}
+		mutex_unlock(&core->intbuf_pool_lock);
+	}
+
+	buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return NULL;
+
+	INIT_LIST_HEAD(&buf->list);
+	buf->type = type;
+	buf->size = size;
+	buf->attrs = INTBUF_ATTRS;
+	buf->va = dma_alloc_attrs(core->dev, buf->size, &buf->da, GFP_KERNEL,
+				  buf->attrs);
+	if (!buf->va) {
+		kfree(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
+static void intbuf_destroy(struct venus_core *core, struct intbuf *buf)
+{
+	dma_free_attrs(core->dev, buf->size, buf->va, buf->da, buf->attrs);
+	kfree(buf);
+}
+
+/* The buffer must already be off the instance lists and released by the firmware */
+static void intbuf_put(struct venus_core *core, struct intbuf *buf)
+{
+	if (intbuf_is_persist(buf->type))
+		goto destroy;
+
+	mutex_lock(&core->intbuf_pool_lock);
+	if (core->intbuf_pool_size + buf->size <= INTBUF_POOL_MAX_SIZE) {
+		buf->owned_by = DRIVER;
+		list_add(&buf->list, &core->intbuf_pool);
+		core->intbuf_pool_size += buf->size;
+		buf = NULL;
+	}
+	mutex_unlock(&core->intbuf_pool_lock);
+
+	if (!buf)
+		return;
+destroy:
+	intbuf_destroy(core, buf);
+}
+
+void venus_helper_intbuf_pool_drain(struct venus_core *core)
+{
+	struct intbuf *buf, *n;
+
+	mutex_lock(&core->intbuf_pool_lock);
+	list_for_each_entry_safe(buf, n, &core->intbuf_pool, list) {
+		list_del(&buf->list);
+		intbuf_destroy(core, buf);
+	}
+	core->intbuf_pool_size = 0;
+	mutex_unlock(&core->intbuf_pool_lock);
+}
+
 bool venus_helper_check_codec(struct venus_inst *inst, u32 v4l2_pixfmt)
 {
 	struct venus_core *core = inst->core;
@@ -95,9 +195,7 @@ static void free_dpb_buf(struct venus_inst *inst, struct intbuf *buf)
 	ida_free(&inst->dpb_ids, buf->dpb_out_tag);
 
 	list_del_init(&buf->list);
-	dma_free_attrs(inst->core->dev, buf->size, buf->va, buf->da,
-		       buf->attrs);
-	kfree(buf);
+	intbuf_put(inst->core, buf);
 }
 
 int venus_helper_queue_dpb_bufs(struct venus_inst *inst)
@@ -111,6 +209,8 @@ int venus_helper_queue_dpb_bufs(struct venus_inst *inst)
 	else if (inst->dpb_buftype == HFI_BUFFER_OUTPUT2)
 		dpb_size = inst->output2_buf_size;
 
+	hfi_session_batch_begin(inst);
+
 	list_for_each_entry_safe(buf, next, &inst->dpbbufs, list) {
 		struct hfi_frame_data fdata;
 
@@ -138,6 +238,7 @@ int venus_helper_queue_dpb_bufs(struct venus_inst *inst)
 	}
 
 fail:
+	hfi_session_batch_end(inst);
 	return ret;
 }
 EXPORT_SYMBOL_GPL(venus_helper_queue_dpb_bufs);
@@ -162,7 +263,6 @@ EXPORT_SYMBOL_GPL(venus_helper_free_dpb_bufs);
 int venus_helper_alloc_dpb_bufs(struct venus_inst *inst)
 {
 	struct venus_core *core = inst->core;
-	struct device *dev = core->dev;
 	enum hfi_version ver = core->res->hfi_version;
 	struct hfi_buffer_requirements bufreq;
 	u32 buftype = inst->dpb_buftype;
@@ -192,26 +292,16 @@ int venus_helper_alloc_dpb_bufs(struct venus_inst *inst)
 	count = HFI_BUFREQ_COUNT_MIN(&bufreq, ver);
 
 	for (i = 0; i < count; i++) {
-		buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+		buf = intbuf_get(core, buftype, dpb_size);
 		if (!buf) {
 			ret = -ENOMEM;
 			goto fail;
 		}
-
-		buf->type = buftype;
-		buf->size = dpb_size;
-		buf->attrs = DMA_ATTR_WRITE_COMBINE |
-			     DMA_ATTR_NO_KERNEL_MAPPING;
-		buf->va = dma_alloc_attrs(dev, buf->size, &buf->da, GFP_KERNEL,
-					  buf->attrs);
-		if (!buf->va) {
-			ret = -ENOMEM;
-			goto fail;
-		}
 		buf->owned_by = DRIVER;
 
 		id = ida_alloc_min(&inst->dpb_ids, VB2_MAX_FRAME, GFP_KERNEL);
 		if (id < 0) {
+			intbuf_put(core, buf);
 			ret = id;
 			goto fail;
 		}
@@ -224,7 +314,6 @@ int venus_helper_alloc_dpb_bufs(struct venus_inst *inst)
 	return 0;
 
 fail:
-	kfree(buf);
 	venus_helper_free_dpb_bufs(inst);
 	return ret;
 }
@@ -248,22 +337,9 @@ static int intbufs_set_buffer(struct venus_inst *inst, u32 type)
 		return 0;
 
 	for (i = 0; i < bufreq.count_actual; i++) {
-		buf = kzalloc(sizeof(*buf), GFP_KERNEL);
-		if (!buf) {
-			ret = -ENOMEM;
-			goto fail;
-		}
-
-		buf->type = bufreq.type;
-		buf->size = bufreq.size;
-		buf->attrs = DMA_ATTR_WRITE_COMBINE |
-			     DMA_ATTR_NO_KERNEL_MAPPING;
-		buf->va = dma_alloc_attrs(dev, buf->size, &buf->da, GFP_KERNEL,
-					  buf->attrs);
-		if (!buf->va) {
-			ret = -ENOMEM;
-			goto fail;
-		}
+		buf = intbuf_get(core, bufreq.type, bufreq.size);
+		if (!buf)
+			return -ENOMEM;
 
 		memset(&bd, 0, sizeof(bd));
 		bd.buffer_size = buf->size;
@@ -274,19 +350,14 @@ static int intbufs_set_buffer(struct venus_inst *inst, u32 type)
 		ret = hfi_session_set_buffers(inst, &bd);
 		if (ret) {
 			dev_err(dev, "set session buffers failed\n");
-			goto dma_free;
+			intbuf_destroy(core, buf);
+			return ret;
 		}
 
 		list_add_tail(&buf->list, &inst->internalbufs);
 	}
 
 	return 0;
-
-dma_free:
-	dma_free_attrs(dev, buf->size, buf->va, buf->da, buf->attrs);
-fail:
-	kfree(buf);
-	return ret;
 }
 
 static int intbufs_unset_buffers(struct venus_inst *inst)
@@ -305,9 +376,10 @@ static int intbufs_unset_buffers(struct venus_inst *inst)
 		ret = hfi_session_unset_buffers(inst, &bd);
 
 		list_del_init(&buf->list);
-		dma_free_attrs(inst->core->dev, buf->size, buf->va, buf->da,
-			       buf->attrs);
-		kfree(buf);
+		if (ret)
+			intbuf_destroy(inst->core, buf);
+		else
+			intbuf_put(inst->core, buf);
 	}
 
 	return ret;
@@ -395,11 +467,11 @@ int venus_helper_intbufs_realloc(struct venus_inst *inst)
 
 		ret = hfi_session_unset_buffers(inst, &bd);
 
-		dma_free_attrs(inst->core->dev, buf->size, buf->va, buf->da,
-			       buf->attrs);
-
 		list_del_init(&buf->list);
-		kfree(buf);
+		if (ret)
+			intbuf_destroy(inst->core, buf);
+		else
+			intbuf_put(inst->core, buf);
 	}
 
 	ret = intbufs_set_buffer(inst, HFI_BUFFER_INTERNAL_SCRATCH(ver));
@@ -1360,6 +1432,7 @@ static void delayed_process_buf_func(struct work_struct *work)
 	if (!(inst->streamon_out & inst->streamon_cap))
 		goto unlock;
 
+	hfi_session_batch_begin(inst);
 	list_for_each_entry_safe(buf, n, &inst->delayed_process, ref_list) {
 		if (buf->flags & HFI_BUFFERFLAG_READONLY)
 			continue;
@@ -1370,6 +1443,7 @@ static void delayed_process_buf_func(struct work_struct *work)
 
 		list_del_init(&buf->ref_list);
 	}
+	hfi_session_batch_end(inst);
 unlock:
 	mutex_unlock(&inst->lock);
 }
@@ -1600,17 +1674,21 @@ int venus_helper_process_initial_cap_bufs(struct venus_inst *inst)
 {
 	struct v4l2_m2m_ctx *m2m_ctx = inst->m2m_ctx;
 	struct v4l2_m2m_buffer *buf, *n;
-	int ret;
+	int ret = 0;
+
+	hfi_session_batch_begin(inst);
 
 	v4l2_m2m_for_each_dst_buf_safe(m2m_ctx, buf, n) {
 		ret = session_process_buf(inst, &buf->vb);
 		if (ret) {
 			return_buf_error(inst, &buf->vb);
-			return ret;
+			break;
 		}
 	}
 
-	return 0;
+	hfi_session_batch_end(inst);
+
+	return ret;
 }
 EXPORT_SYMBOL_GPL(venus_helper_process_initial_cap_bufs);
 
@@ -1618,17 +1696,21 @@ int venus_helper_process_initial_out_bufs(struct venus_inst *inst)
 {
 	struct v4l2_m2m_ctx *m2m_ctx = inst->m2m_ctx;
 	struct v4l2_m2m_buffer *buf, *n;
-	int ret;
+	int ret = 0;
+
+	hfi_session_batch_begin(inst);
 
 	v4l2_m2m_for_each_src_buf_safe(m2m_ctx, buf, n) {
 		ret = session_process_buf(inst, &buf->vb);
 		if (ret) {
 			return_buf_error(inst, &buf->vb);
-			return ret;
+			break;
 		}
 	}
 
-	return 0;
+	hfi_session_batch_end(inst);
+
+	return ret;
 }
 EXPORT_SYMBOL_GPL(venus_helper_process_initial_out_bufs);
 
@@ -1674,6 +1756,7 @@ void venus_helper_m2m_device_run(void *priv)
 	int ret;
 
 	mutex_lock(&inst->lock);
+	hfi_session_batch_begin(inst);
 
 	v4l2_m2m_for_each_dst_buf_safe(m2m_ctx, buf, n) {
 		ret = session_process_buf(inst, &buf->vb);
@@ -1687,6 +1770,7 @@ void venus_helper_m2m_device_run(void *priv)
 			return_buf_error(inst, &buf->vb);
 	}
 
+	hfi_session_batch_end(inst);
 	mutex_unlock(&inst->lock);
 }
 EXPORT_SYMBOL_GPL(venus_helper_m2m_device_run);
@@ -553,6 +553,28 @@ int hfi_session_process_buf(struct venus_inst *inst, struct hfi_frame_data *fd)
 }
 EXPORT_SYMBOL_GPL(hfi_session_process_buf);
 
+/*
+ * Buffers queued between hfi_session_batch_begin() and hfi_session_batch_end()
+ * are signalled to the firmware with a single interrupt.
+ */
+void hfi_session_batch_begin(struct venus_inst *inst)
+{
+	const struct hfi_ops *ops = inst->core->ops;
+
+	if (ops->session_batch_begin)
+		ops->session_batch_begin(inst);
+}
+EXPORT_SYMBOL_GPL(hfi_session_batch_begin);
+
+void hfi_session_batch_end(struct venus_inst *inst)
+{
+	const struct hfi_ops *ops = inst->core->ops;
+
+	if (ops->session_batch_end)
+		ops->session_batch_end(inst);
+}
+EXPORT_SYMBOL_GPL(hfi_session_batch_end);
+
 irqreturn_t hfi_isr_thread(int irq, void *dev_id)
 {
 	struct venus_core *core = dev_id;
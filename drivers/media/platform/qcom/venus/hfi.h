@@ -121,6 +121,8 @@ struct hfi_ops {
 	int (*session_continue)(struct venus_inst *inst);
 	int (*session_etb)(struct venus_inst *inst, struct hfi_frame_data *fd);
 	int (*session_ftb)(struct venus_inst *inst, struct hfi_frame_data *fd);
+	void (*session_batch_begin)(struct venus_inst *inst);
+	void (*session_batch_end)(struct venus_inst *inst);
 	int (*session_set_buffers)(struct venus_inst *inst,
 				   struct hfi_buffer_desc *bd);
 	int (*session_unset_buffers)(struct venus_inst *inst,
@@ -172,6 +174,8 @@ int hfi_session_get_property(struct venus_inst *inst, u32 ptype,
 			     union hfi_get_property *hprop);
 int hfi_session_set_property(struct venus_inst *inst, u32 ptype, void *pdata);
 int hfi_session_process_buf(struct venus_inst *inst, struct hfi_frame_data *f);
+void hfi_session_batch_begin(struct venus_inst *inst);
+void hfi_session_batch_end(struct venus_inst *inst);
 irqreturn_t hfi_isr_thread(int irq, void *dev_id);
 irqreturn_t hfi_isr(int irq, void *dev);
 
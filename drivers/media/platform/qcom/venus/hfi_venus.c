@@ -120,6 +120,9 @@ struct venus_hfi_device {
 	enum venus_state state;
 	/* serialize read / write to the shared memory */
 	struct mutex lock;
+	/* nesting depth of command batches and a deferred host interrupt */
+	unsigned int cmdq_batch;
+	bool cmdq_kick;
 	struct completion pwr_collapse_prep;
 	struct completion release_resource;
 	struct mem_desc ifaceq_table;
@@ -403,8 +406,21 @@ static int venus_iface_cmdq_write_nolock(struct venus_hfi_device *hdev,
 		wmb();
 	}
 
-	if (rx_req)
-		venus_soft_int(hdev);
+	if (!rx_req)
+		return 0;
+
+	/*
+	 * Within a batch only note that the firmware asked to be woken up,
+	 * one interrupt at the end of the batch covers every queued packet.
+	 * Synchronous commands are waited upon, so kick the firmware now.
+	 */
+	if (hdev->cmdq_batch && !sync) {
+		hdev->cmdq_kick = true;
+		return 0;
+	}
+
+	hdev->cmdq_kick = false;
+	venus_soft_int(hdev);
 
 	return 0;
 }
@@ -664,35 +680,36 @@ static int venus_power_on(struct venus_hfi_device *hdev)
 }
 
 static int venus_iface_msgq_read_nolock(struct venus_hfi_device *hdev,
-					void *pkt)
+					void *pkt, u32 *tx_req)
 {
 	struct iface_queue *queue;
-	u32 tx_req;
-	int ret;
 
 	if (!venus_is_valid_state(hdev))
 		return -EINVAL;
 
 	queue = &hdev->queues[IFACEQ_MSG_IDX];
 
-	ret = venus_read_queue(hdev, queue, pkt, &tx_req);
-	if (ret)
-		return ret;
-
-	if (tx_req)
-		venus_soft_int(hdev);
-
-	return 0;
+	return venus_read_queue(hdev, queue, pkt, tx_req);
 }
 
-static int venus_iface_msgq_read(struct venus_hfi_device *hdev, void *pkt)
+/*
+ * Read one message. A firmware request for room in the message queue is
+ * accumulated in @tx_pending, the caller raises a single interrupt for it
+ * once it has drained the queue.
+ */
+static int venus_iface_msgq_read(struct venus_hfi_device *hdev, void *pkt,
+				 bool *tx_pending)
 {
+	u32 tx_req = 0;
 	int ret;
 
 	mutex_lock(&hdev->lock);
-	ret = venus_iface_msgq_read_nolock(hdev, pkt);
+	ret = venus_iface_msgq_read_nolock(hdev, pkt, &tx_req);
 	mutex_unlock(&hdev->lock);
 
+	if (tx_req)
+		*tx_pending = true;
+
 	return ret;
 }
 
@@ -1082,6 +1099,7 @@ static irqreturn_t venus_isr_thread(struct venus_core *core)
 {
 	struct venus_hfi_device *hdev = to_hfi_priv(core);
 	const struct venus_resources *res;
+	bool tx_pending = false;
 	void *pkt;
 	u32 msg_ret;
 
@@ -1092,7 +1110,7 @@ static irqreturn_t venus_isr_thread(struct venus_core *core)
 	pkt = hdev->pkt_buf;
 
 
-	while (!venus_iface_msgq_read(hdev, pkt)) {
+	while (!venus_iface_msgq_read(hdev, pkt, &tx_pending)) {
 		msg_ret = hfi_process_msg_packet(core, pkt);
 		switch (msg_ret) {
 		case HFI_MSG_EVENT_NOTIFY:
@@ -1115,6 +1133,13 @@ static irqreturn_t venus_isr_thread(struct venus_core *core)
 		}
 	}
 
+	if (tx_pending) {
+		mutex_lock(&hdev->lock);
+		if (venus_is_valid_state(hdev))
+			venus_soft_int(hdev);
+		mutex_unlock(&hdev->lock);
+	}
+
 	venus_flush_debug_queue(hdev);
 
 	return IRQ_HANDLED;
@@ -1335,6 +1360,29 @@ static int venus_session_ftb(struct venus_inst *inst,
 	return venus_iface_cmdq_write(hdev, &pkt, false);
 }
 
+static void venus_session_batch_begin(struct venus_inst *inst)
+{
+	struct venus_hfi_device *hdev = to_hfi_priv(inst->core);
+
+	mutex_lock(&hdev->lock);
+	hdev->cmdq_batch++;
+	mutex_unlock(&hdev->lock);
+}
+
+static void venus_session_batch_end(struct venus_inst *inst)
+{
+	struct venus_hfi_device *hdev = to_hfi_priv(inst->core);
+
+	mutex_lock(&hdev->lock);
+	if (!WARN_ON(!hdev->cmdq_batch) && !--hdev->cmdq_batch &&
+	    hdev->cmdq_kick) {
+		hdev->cmdq_kick = false;
+		if (venus_is_valid_state(hdev))
+			venus_soft_int(hdev);
+	}
+	mutex_unlock(&hdev->lock);
+}
+
 static int venus_session_set_buffers(struct venus_inst *inst,
 				     struct hfi_buffer_desc *bd)
 {
@@ -1665,6 +1713,8 @@ static const struct hfi_ops venus_hfi_ops = {
 	.session_continue		= venus_session_continue,
 	.session_etb			= venus_session_etb,
 	.session_ftb			= venus_session_ftb,
+	.session_batch_begin		= venus_session_batch_begin,
+	.session_batch_end		= venus_session_batch_end,
 	.session_set_buffers		= venus_session_set_buffers,
 	.session_unset_buffers		= venus_session_unset_buffers,
 	.session_load_res		= venus_session_load_res,
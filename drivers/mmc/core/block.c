@@ -1533,12 +1533,13 @@ static void mmc_blk_cqe_req_done(struct mmc_request *mrq)
 		blk_mq_complete_request(req);
 }
 
-static int mmc_blk_cqe_start_req(struct mmc_host *host, struct mmc_request *mrq)
+static int mmc_blk_cqe_start_req(struct mmc_queue *mq, struct mmc_request *mrq)
 {
 	mrq->done		= mmc_blk_cqe_req_done;
 	mrq->recovery_notifier	= mmc_cqe_recovery_notifier;
+	mrq->cqe_defer_start	= mq->cqe_defer_start;
 
-	return mmc_cqe_start_req(host, mrq);
+	return mmc_cqe_start_req(mq->card->host, mrq);
 }
 
 static struct mmc_request *mmc_blk_cqe_prep_dcmd(struct mmc_queue_req *mqrq,
@@ -1566,7 +1567,7 @@ static int mmc_blk_cqe_issue_flush(struct mmc_queue *mq, struct request *req)
 			EXT_CSD_CMD_SET_NORMAL;
 	mrq->cmd->flags = MMC_CMD_AC | MMC_RSP_R1B;
 
-	return mmc_blk_cqe_start_req(mq->card->host, mrq);
+	return mmc_blk_cqe_start_req(mq, mrq);
 }
 
 static int mmc_blk_hsq_issue_rw_rq(struct mmc_queue *mq, struct request *req)
@@ -1596,7 +1597,7 @@ static int mmc_blk_cqe_issue_rw_rq(struct mmc_queue *mq, struct request *req)
 
 	mmc_blk_data_prep(mq, mqrq, 0, NULL, NULL);
 
-	return mmc_blk_cqe_start_req(mq->card->host, &mqrq->brq.mrq);
+	return mmc_blk_cqe_start_req(mq, &mqrq->brq.mrq);
 }
 
 static void mmc_blk_rw_rq_prep(struct mmc_queue_req *mqrq,
@@ -261,10 +261,12 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 		break;
 	case MMC_ISSUE_ASYNC:
 		/*
-		 * For MMC host software queue, we only allow 2 requests in
-		 * flight to avoid a long latency.
+		 * For MMC host software queue, limit the requests in flight to
+		 * avoid a long latency. The host software queue raises the
+		 * limit while it is fed small requests.
 		 */
-		if (host->hsq_enabled && mq->in_flight[issue_type] > 2) {
+		if (host->hsq_enabled &&
+		    mq->in_flight[issue_type] > host->hsq_depth) {
 			spin_unlock_irq(&mq->lock);
 			return BLK_STS_RESOURCE;
 		}
@@ -301,6 +303,9 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 	if (host->cqe_enabled) {
 		host->retune_now = host->need_retune && cqe_retune_ok &&
 				   !host->hold_retune;
+		/* ->commit_rqs() follows if this is not the last request */
+		mq->cqe_defer_start = !bd->last &&
+				      host->cqe_ops->cqe_commit_rqs;
 	}
 
 	blk_mq_start_request(req);
@@ -337,8 +342,18 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 	return ret;
 }
 
+static void mmc_mq_commit_rqs(struct blk_mq_hw_ctx *hctx)
+{
+	struct mmc_queue *mq = hctx->queue->queuedata;
+	struct mmc_host *host = mq->card->host;
+
+	if (host->cqe_enabled)
+		mmc_cqe_commit_rqs(host);
+}
+
 static const struct blk_mq_ops mmc_mq_ops = {
 	.queue_rq	= mmc_mq_queue_rq,
+	.commit_rqs	= mmc_mq_commit_rqs,
 	.init_request	= mmc_mq_init_request,
 	.exit_request	= mmc_mq_exit_request,
 	.complete	= mmc_blk_mq_complete,
@@ -82,6 +82,7 @@ struct mmc_queue {
 	unsigned int		cqe_busy;
 #define MMC_CQE_DCMD_BUSY	BIT(0)
 	bool			busy;
+	bool			cqe_defer_start;
 	bool			recovery_needed;
 	bool			in_recovery;
 	bool			rw_wait;
@@ -589,6 +589,34 @@ static inline int cqhci_tag(struct mmc_request *mrq)
 	return mrq->cmd ? DCMD_SLOT : mrq->tag;
 }
 
+/* Ring the doorbell for every task issued since the last commit */
+static void __cqhci_commit(struct cqhci_host *cq_host)
+{
+	u32 pending = cq_host->pending_db;
+
+	if (!pending)
+		return;
+
+	cq_host->pending_db = 0;
+	/* Make sure descriptors are ready before ringing the doorbell */
+	wmb();
+	cqhci_writel(cq_host, pending, CQHCI_TDBR);
+	if ((cqhci_readl(cq_host, CQHCI_TDBR) & pending) != pending)
+		pr_debug("%s: cqhci: doorbell not set for tags %#x\n",
+			 mmc_hostname(cq_host->mmc), pending);
+}
+
+static void cqhci_commit_rqs(struct mmc_host *mmc)
+{
+	struct cqhci_host *cq_host = mmc->cqe_private;
+	unsigned long flags;
+
+	spin_lock_irqsave(&cq_host->lock, flags);
+	if (!cq_host->recovery_halt)
+		__cqhci_commit(cq_host);
+	spin_unlock_irqrestore(&cq_host->lock, flags);
+}
+
 static int cqhci_request(struct mmc_host *mmc, struct mmc_request *mrq)
 {
 	int err = 0;
@@ -644,12 +672,9 @@ static int cqhci_request(struct mmc_host *mmc, struct mmc_request *mrq)
 	cq_host->slot[tag].flags = 0;
 
 	cq_host->qcnt += 1;
-	/* Make sure descriptors are ready before ringing the doorbell */
-	wmb();
-	cqhci_writel(cq_host, 1 << tag, CQHCI_TDBR);
-	if (!(cqhci_readl(cq_host, CQHCI_TDBR) & (1 << tag)))
-		pr_debug("%s: cqhci: doorbell not set for tag %d\n",
-			 mmc_hostname(mmc), tag);
+	cq_host->pending_db |= 1 << tag;
+	if (!mrq->cqe_defer_start)
+		__cqhci_commit(cq_host);
 out_unlock:
 	spin_unlock_irqrestore(&cq_host->lock, flags);
 
@@ -885,6 +910,9 @@ static int cqhci_wait_for_idle(struct mmc_host *mmc)
 	struct cqhci_host *cq_host = mmc->cqe_private;
 	int ret;
 
+	/* Deferred tasks would never complete without their doorbell */
+	cqhci_commit_rqs(mmc);
+
 	wait_event(cq_host->wait_queue, cqhci_is_idle(cq_host, &ret));
 
 	return ret;
@@ -1104,6 +1132,7 @@ static void cqhci_recovery_finish(struct mmc_host *mmc)
 
 	spin_lock_irqsave(&cq_host->lock, flags);
 	cq_host->qcnt = 0;
+	cq_host->pending_db = 0;
 	cq_host->recovery_halt = false;
 	mmc->cqe_on = false;
 	spin_unlock_irqrestore(&cq_host->lock, flags);
@@ -1128,6 +1157,7 @@ static const struct mmc_cqe_ops cqhci_cqe_ops = {
 	.cqe_timeout = cqhci_timeout,
 	.cqe_recovery_start = cqhci_recovery_start,
 	.cqe_recovery_finish = cqhci_recovery_finish,
+	.cqe_commit_rqs = cqhci_commit_rqs,
 };
 
 struct cqhci_host *cqhci_pltfm_init(struct platform_device *pdev)
@@ -229,6 +229,8 @@ struct cqhci_host {
 	bool dma64;
 	int num_slots;
 	int qcnt;
+	/* tags whose doorbell has been deferred by cqe_defer_start */
+	u32 pending_db;
 
 	u32 dcmd_slot;
 	u32 caps;
@@ -10,12 +10,10 @@
 #include <linux/mmc/card.h>
 #include <linux/mmc/host.h>
 #include <linux/module.h>
+#include <linux/sizes.h>
 
 #include "mmc_hsq.h"
 
-#define HSQ_NUM_SLOTS	64
-#define HSQ_INVALID_TAG	HSQ_NUM_SLOTS
-
 static void mmc_hsq_retry_handler(struct work_struct *work)
 {
 	struct mmc_hsq *hsq = container_of(work, struct mmc_hsq, retry_work);
@@ -209,6 +207,29 @@ static void mmc_hsq_recovery_finish(struct mmc_host *mmc)
 		mmc_hsq_pump_requests(hsq);
 }
 
+/*
+ * Pick the queue depth from the requests currently queued: two or more small
+ * data requests switch to the deeper queue. Called with hsq->lock held.
+ */
+static void mmc_hsq_modify_threshold(struct mmc_hsq *hsq)
+{
+	struct mmc_host *mmc = hsq->mmc;
+	struct mmc_request *mrq;
+	unsigned int tag, small = 0;
+
+	for (tag = 0; tag < HSQ_NUM_SLOTS; tag++) {
+		mrq = hsq->slot[tag].mrq;
+		if (mrq && mrq->data &&
+		    mrq->data->blksz * mrq->data->blocks <= HSQ_SMALL_REQ_SIZE &&
+		    ++small == 2) {
+			mmc->hsq_depth = HSQ_PERFORMANCE_DEPTH;
+			return;
+		}
+	}
+
+	mmc->hsq_depth = HSQ_NORMAL_DEPTH;
+}
+
 static int mmc_hsq_request(struct mmc_host *mmc, struct mmc_request *mrq)
 {
 	struct mmc_hsq *hsq = mmc->cqe_private;
@@ -229,6 +250,8 @@ static int mmc_hsq_request(struct mmc_host *mmc, struct mmc_request *mrq)
 
 	hsq->slot[tag].mrq = mrq;
 
+	mmc_hsq_modify_threshold(hsq);
+
 	/*
 	 * Set the next tag as current request tag if no available
 	 * next tag.
@@ -350,6 +373,7 @@ int mmc_hsq_init(struct mmc_hsq *hsq, struct mmc_host *mmc)
 	hsq->mmc = mmc;
 	hsq->mmc->cqe_private = hsq;
 	mmc->cqe_ops = &mmc_hsq_ops;
+	mmc->hsq_depth = HSQ_NORMAL_DEPTH;
 
 	INIT_WORK(&hsq->retry_work, mmc_hsq_retry_handler);
 	spin_lock_init(&hsq->lock);
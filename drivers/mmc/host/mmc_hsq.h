@@ -2,6 +2,19 @@
 #ifndef LINUX_MMC_HSQ_H
 #define LINUX_MMC_HSQ_H
 
+#define HSQ_NUM_SLOTS		64
+#define HSQ_INVALID_TAG		HSQ_NUM_SLOTS
+
+/*
+ * For MMC host software queue, we allow 2 requests in flight by default to
+ * avoid a long latency. While small requests dominate, the per-request setup
+ * cost matters more than the latency of the queue, so allow more of them to
+ * be queued and DMA-mapped ahead of the running one.
+ */
+#define HSQ_NORMAL_DEPTH	2
+#define HSQ_PERFORMANCE_DEPTH	5
+#define HSQ_SMALL_REQ_SIZE	SZ_16K
+
 struct hsq_slot {
 	struct mmc_request *mrq;
 };
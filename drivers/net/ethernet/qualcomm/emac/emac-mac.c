@@ -1443,7 +1443,10 @@ netdev_tx_t emac_mac_tx_buf_send(struct emac_adapter *adpt,
 
 	if (emac_tso_csum(adpt, tx_q, skb, &tpd) != 0) {
 		dev_kfree_skb_any(skb);
-		return NETDEV_TX_OK;
+		/* Earlier frames of the batch may still wait for the kick */
+		if (netdev_xmit_more())
+			return NETDEV_TX_OK;
+		goto update_prod_idx;
 	}
 
 	if (skb_vlan_tag_present(skb)) {
@@ -1460,8 +1463,6 @@ netdev_tx_t emac_mac_tx_buf_send(struct emac_adapter *adpt,
 	len = skb->len;
 	emac_tx_fill_tpd(adpt, tx_q, skb, &tpd);
 
-	netdev_sent_queue(adpt->netdev, len);
-
 	/* Make sure the are enough free descriptors to hold one
 	 * maximum-sized SKB.  We need one desc for each fragment,
 	 * one for the checksum (emac_tso_csum), one for TSO, and
@@ -1470,6 +1471,13 @@ netdev_tx_t emac_mac_tx_buf_send(struct emac_adapter *adpt,
 	if (emac_tpd_num_free_descs(tx_q) < (MAX_SKB_FRAGS + 3))
 		netif_stop_queue(adpt->netdev);
 
+	/* Only update the produce idx once the stack has no more packets
+	 * queued for us, or the queue has been stopped by BQL or above.
+	 */
+	if (!__netdev_sent_queue(adpt->netdev, len, netdev_xmit_more()))
+		return NETDEV_TX_OK;
+
+update_prod_idx:
 	/* update produce idx */
 	prod_idx = (tx_q->tpd.produce_idx << tx_q->produce_shift) &
 		    tx_q->produce_mask;
@@ -97,7 +97,9 @@ __rmnet_map_ingress_handler(struct sk_buff *skb,
 			skb->ip_summed = CHECKSUM_UNNECESSARY;
 	}
 
-	skb_trim(skb, len);
+	/* Deaggregated packets may carry their payload in a page fragment */
+	if (pskb_trim(skb, len))
+		goto free_skb;
 	rmnet_deliver_skb(skb);
 	return;
 
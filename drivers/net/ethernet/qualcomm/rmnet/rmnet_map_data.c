@@ -8,6 +8,7 @@
 #include <linux/ip.h>
 #include <linux/ipv6.h>
 #include <net/ip6_checksum.h>
+#include <net/page_pool.h>
 #include <linux/bitfield.h>
 #include "rmnet_config.h"
 #include "rmnet_map.h"
@@ -15,6 +16,10 @@
 
 #define RMNET_MAP_DEAGGR_SPACING  64
 #define RMNET_MAP_DEAGGR_HEADROOM (RMNET_MAP_DEAGGR_SPACING / 2)
+/* Packets longer than this are attached as page fragments, not copied */
+#define RMNET_MAP_DEAGGR_COPYBREAK 256
+/* Bytes copied into the linear area of a fragmented packet */
+#define RMNET_MAP_DEAGGR_COPY_LEN  128
 
 static __sum16 *rmnet_map_get_csum_field(unsigned char protocol,
 					 const void *txporthdr)
@@ -332,6 +337,74 @@ struct rmnet_map_header *rmnet_map_add_map_header(struct sk_buff *skb,
 	return map_header;
 }
 
+/* Large data packets can reference the aggregate's page instead of being
+ * copied out of it.  MAPv4 checksum offload needs the trailer at the end
+ * of the packet in the linear area, so those are always copied.  A page
+ * pool page can only be shared if its pool counts fragment references.
+ */
+static bool rmnet_map_deaggr_can_frag(struct sk_buff *skb,
+				      struct rmnet_port *port,
+				      struct rmnet_map_header *maph,
+				      u32 packet_len)
+{
+	if (packet_len <= RMNET_MAP_DEAGGR_COPYBREAK)
+		return false;
+
+	if (maph->flags & MAP_CMD_FLAG)
+		return false;
+
+	if (port->data_format & RMNET_FLAGS_INGRESS_MAP_CKSUMV4)
+		return false;
+
+	if (!skb->head_frag || skb_is_nonlinear(skb))
+		return false;
+
+	if (skb->pp_recycle &&
+	    !(virt_to_head_page(skb->data)->pp->p.flags & PP_FLAG_PAGE_FRAG))
+		return false;
+
+	return true;
+}
+
+/* Build a packet with the MAP, checksum and network headers in its linear
+ * area and the rest of the payload in a fragment of the aggregate's page,
+ * which GRO can then coalesce without copying.
+ */
+static struct sk_buff *rmnet_map_deaggr_frag(struct sk_buff *skb,
+					     u32 packet_len)
+{
+	u32 copy_len = RMNET_MAP_DEAGGR_COPY_LEN;
+	u32 frag_len = packet_len - copy_len;
+	void *frag = skb->data + copy_len;
+	struct sk_buff *skbn;
+	struct page *page;
+
+	skbn = alloc_skb(copy_len + RMNET_MAP_DEAGGR_SPACING, GFP_ATOMIC);
+	if (!skbn)
+		return NULL;
+
+	skb_reserve(skbn, RMNET_MAP_DEAGGR_HEADROOM);
+	skb_put_data(skbn, skb->data, copy_len);
+
+	/* Page pool pages are shared by fragment count, so they still
+	 * return to their pool once the last packet is freed.  The
+	 * aggregate is charged for its buffer as a whole; each packet is
+	 * charged for its share of it.
+	 */
+	page = virt_to_head_page(frag);
+	if (skb->pp_recycle) {
+		atomic_long_inc(&page->pp_frag_count);
+		skb_mark_for_recycle(skbn);
+	} else {
+		get_page(page);
+	}
+	skb_add_rx_frag(skbn, 0, page, frag - page_address(page), frag_len,
+			SKB_DATA_ALIGN(frag_len));
+	skb_pull(skb, packet_len);
+
+	return skbn;
+}
+
 /* Deaggregates a single packet
  * A whole new buffer is allocated for each portion of an aggregated frame.
  * Caller should keep calling deaggregate() on the source skb until 0 is
@@ -381,6 +454,9 @@ struct sk_buff *rmnet_map_deaggregate(struct sk_buff *skb,
 			return NULL;
 	}
 
+	if (rmnet_map_deaggr_can_frag(skb, port, maph, packet_len))
+		return rmnet_map_deaggr_frag(skb, packet_len);
+
 	skbn = alloc_skb(packet_len + RMNET_MAP_DEAGGR_SPACING, GFP_ATOMIC);
 	if (!skbn)
 		return NULL;
@@ -501,6 +501,26 @@ static int ethqos_clks_config(void *priv, bool enabled)
 	return ret;
 }
 
+/* Use the per-channel DMA interrupts only when the DT provides one for every
+ * RX and TX channel in use, otherwise channels without a vector would never
+ * be serviced.
+ */
+static bool ethqos_has_queue_irqs(struct plat_stmmacenet_data *plat_dat,
+				  struct stmmac_resources *res)
+{
+	int i;
+
+	for (i = 0; i < plat_dat->rx_queues_to_use; i++)
+		if (res->rx_irq[i] <= 0)
+			return false;
+
+	for (i = 0; i < plat_dat->tx_queues_to_use; i++)
+		if (res->tx_irq[i] <= 0)
+			return false;
+
+	return true;
+}
+
 static int qcom_ethqos_probe(struct platform_device *pdev)
 {
 	struct device_node *np = pdev->dev.of_node;
@@ -561,6 +581,8 @@ static int qcom_ethqos_probe(struct platform_device *pdev)
 	plat_dat->pmt = 1;
 	plat_dat->tso_en = of_property_read_bool(np, "snps,tso");
 
+	plat_dat->multi_msi_en = ethqos_has_queue_irqs(plat_dat, &stmmac_res);
+
 	ret = stmmac_dvr_probe(&pdev->dev, plat_dat, &stmmac_res);
 	if (ret)
 		goto err_clk;
@@ -12,6 +12,7 @@
 #define STMMAC_RESOURCE_NAME   "stmmaceth"
 
 #include <linux/clk.h>
+#include <linux/dim.h>
 #include <linux/hrtimer.h>
 #include <linux/if_vlan.h>
 #include <linux/stmmac.h>
@@ -123,6 +124,14 @@ struct stmmac_channel {
 	struct stmmac_priv *priv_data;
 	spinlock_t lock;
 	u32 index;
+	/* Adaptive RX interrupt moderation, see stmmac_rx_dim_work().
+	 * DIM programs the RX watchdog directly and leaves rx_riwt[], the
+	 * value set through ethtool, alone.
+	 */
+	struct dim rx_dim;
+	bool rx_dim_enabled;
+	u16 rx_dim_events;
+	u64 rx_dim_bytes;
 };
 
 struct stmmac_tc_entry {
@@ -337,6 +346,7 @@ int stmmac_mdio_register(struct net_device *ndev);
 int stmmac_mdio_reset(struct mii_bus *mii);
 int stmmac_xpcs_setup(struct mii_bus *mii);
 void stmmac_set_ethtool_ops(struct net_device *netdev);
+u32 stmmac_usec2riwt(u32 usec, struct stmmac_priv *priv);
 
 int stmmac_init_tstamp_counter(struct stmmac_priv *priv, u32 systime_flags);
 void stmmac_ptp_register(struct stmmac_priv *priv);
@@ -819,7 +819,7 @@ static int stmmac_ethtool_op_set_eee(struct net_device *dev,
 	return 0;
 }
 
-static u32 stmmac_usec2riwt(u32 usec, struct stmmac_priv *priv)
+u32 stmmac_usec2riwt(u32 usec, struct stmmac_priv *priv)
 {
 	unsigned long clk = clk_get_rate(priv->plat->stmmac_clk);
 
@@ -871,6 +871,12 @@ static int __stmmac_get_coalesce(struct net_device *dev,
 		ec->tx_max_coalesced_frames = 0;
 	}
 
+	if (queue < rx_cnt)
+		ec->use_adaptive_rx_coalesce =
+			priv->channel[queue].rx_dim_enabled;
+	else
+		ec->use_adaptive_rx_coalesce = 0;
+
 	if (priv->use_riwt && queue < rx_cnt) {
 		ec->rx_max_coalesced_frames = priv->rx_coal_frames[queue];
 		ec->rx_coalesce_usecs = stmmac_riwt2usec(priv->rx_riwt[queue],
@@ -897,6 +903,23 @@ static int stmmac_get_per_queue_coalesce(struct net_device *dev, u32 queue,
 	return __stmmac_get_coalesce(dev, ec, queue);
 }
 
+static void stmmac_set_rx_dim(struct stmmac_priv *priv, u32 queue,
+			      bool enable)
+{
+	struct stmmac_channel *ch = &priv->channel[queue];
+
+	if (ch->rx_dim_enabled == enable)
+		return;
+
+	WRITE_ONCE(ch->rx_dim_enabled, enable);
+	if (enable)
+		return;
+
+	/* Back to the watchdog value set through ethtool */
+	cancel_work_sync(&ch->rx_dim.work);
+	stmmac_rx_watchdog(priv, priv->ioaddr, priv->rx_riwt[queue], queue);
+}
+
 static int __stmmac_set_coalesce(struct net_device *dev,
 				 struct ethtool_coalesce *ec,
 				 int queue)
@@ -917,6 +940,19 @@ static int __stmmac_set_coalesce(struct net_device *dev,
 	else if (queue >= max_cnt)
 		return -EINVAL;
 
+	/* DIM drives the RX watchdog, so it needs RIWT support */
+	if (ec->use_adaptive_rx_coalesce && !priv->use_riwt)
+		return -EOPNOTSUPP;
+	if (all_queues) {
+		int i;
+
+		for (i = 0; i < rx_cnt; i++)
+			stmmac_set_rx_dim(priv, i,
+					  ec->use_adaptive_rx_coalesce);
+	} else if (queue < rx_cnt) {
+		stmmac_set_rx_dim(priv, queue, ec->use_adaptive_rx_coalesce);
+	}
+
 	if (priv->use_riwt && (ec->rx_coalesce_usecs > 0)) {
 		rx_riwt = stmmac_usec2riwt(ec->rx_coalesce_usecs, priv);
 
@@ -1151,7 +1187,8 @@ static int stmmac_set_tunable(struct net_device *dev,
 
 static const struct ethtool_ops stmmac_ethtool_ops = {
 	.supported_coalesce_params = ETHTOOL_COALESCE_USECS |
-				     ETHTOOL_COALESCE_MAX_FRAMES,
+				     ETHTOOL_COALESCE_MAX_FRAMES |
+				     ETHTOOL_COALESCE_USE_ADAPTIVE_RX,
 	.begin = stmmac_check_if_running,
 	.get_drvinfo = stmmac_ethtool_getdrvinfo,
 	.get_msglevel = stmmac_ethtool_getmsglevel,
@@ -2393,31 +2393,35 @@ static bool stmmac_xdp_xmit_zc(struct stmmac_priv *priv, u32 queue, u32 budget)
 	struct netdev_queue *nq = netdev_get_tx_queue(priv->dev, queue);
 	struct stmmac_tx_queue *tx_q = &priv->dma_conf.tx_queue[queue];
 	struct xsk_buff_pool *pool = tx_q->xsk_pool;
+	struct xdp_desc *descs = pool->tx_descs;
 	unsigned int entry = tx_q->cur_tx;
-	struct dma_desc *tx_desc = NULL;
-	struct xdp_desc xdp_desc;
-	bool work_done = true;
+	struct dma_desc *tx_desc;
+	u32 avail, nb_pkts, i;
 
 	/* Avoids TX time-out as we are sharing with slow path */
 	txq_trans_cond_update(nq);
 
-	budget = min(budget, stmmac_tx_avail(priv, queue));
+	/* We are sharing with slow path and stop XSK TX desc submission when
+	 * available TX ring is less than threshold.
+	 */
+	avail = stmmac_tx_avail(priv, queue);
+	if (unlikely(avail < STMMAC_TX_XSK_AVAIL) ||
+	    !netif_carrier_ok(priv->dev))
+		return false;
 
-	while (budget-- > 0) {
-		dma_addr_t dma_addr;
-		bool set_ic;
+	budget = min(budget, avail - STMMAC_TX_XSK_AVAIL + 1);
 
-		/* We are sharing with slow path and stop XSK TX desc submission when
-		 * available TX ring is less than threshold.
-		 */
-		if (unlikely(stmmac_tx_avail(priv, queue) < STMMAC_TX_XSK_AVAIL) ||
-		    !netif_carrier_ok(priv->dev)) {
-			work_done = false;
-			break;
-		}
+	/* Pull the whole batch off the XSK TX ring at once, this also
+	 * reserves the matching completion queue entries.
+	 */
+	nb_pkts = xsk_tx_peek_release_desc_batch(pool, budget);
+	if (!nb_pkts)
+		return true;
 
-		if (!xsk_tx_peek_desc(pool, &xdp_desc))
-			break;
+	for (i = 0; i < nb_pkts; i++) {
+		struct xdp_desc *xdp_desc = &descs[i];
+		dma_addr_t dma_addr;
+		bool set_ic;
 
 		if (likely(priv->extend_desc))
 			tx_desc = (struct dma_desc *)(tx_q->dma_etx + entry);
@@ -2426,8 +2430,8 @@ static bool stmmac_xdp_xmit_zc(struct stmmac_priv *priv, u32 queue, u32 budget)
 		else
 			tx_desc = tx_q->dma_tx + entry;
 
-		dma_addr = xsk_buff_raw_get_dma(pool, xdp_desc.addr);
-		xsk_buff_raw_dma_sync_for_device(pool, dma_addr, xdp_desc.len);
+		dma_addr = xsk_buff_raw_get_dma(pool, xdp_desc->addr);
+		xsk_buff_raw_dma_sync_for_device(pool, dma_addr, xdp_desc->len);
 
 		tx_q->tx_skbuff_dma[entry].buf_type = STMMAC_TXBUF_T_XSK_TX;
 
@@ -2439,7 +2443,7 @@ static bool stmmac_xdp_xmit_zc(struct stmmac_priv *priv, u32 queue, u32 budget)
 		tx_q->xdpf[entry] = NULL;
 
 		tx_q->tx_skbuff_dma[entry].map_as_page = false;
-		tx_q->tx_skbuff_dma[entry].len = xdp_desc.len;
+		tx_q->tx_skbuff_dma[entry].len = xdp_desc->len;
 		tx_q->tx_skbuff_dma[entry].last_segment = true;
 		tx_q->tx_skbuff_dma[entry].is_jumbo = false;
 
@@ -2460,27 +2464,22 @@ static bool stmmac_xdp_xmit_zc(struct stmmac_priv *priv, u32 queue, u32 budget)
 			priv->xstats.tx_set_ic_bit++;
 		}
 
-		stmmac_prepare_tx_desc(priv, tx_desc, 1, xdp_desc.len,
+		stmmac_prepare_tx_desc(priv, tx_desc, 1, xdp_desc->len,
 				       true, priv->mode, true, true,
-				       xdp_desc.len);
-
-		stmmac_enable_dma_transmission(priv, priv->ioaddr);
+				       xdp_desc->len);
 
 		tx_q->cur_tx = STMMAC_GET_ENTRY(tx_q->cur_tx, priv->dma_conf.dma_tx_size);
 		entry = tx_q->cur_tx;
 	}
 
-	if (tx_desc) {
-		stmmac_flush_tx_descriptors(priv, queue);
-		xsk_tx_release(pool);
-	}
+	/* Kick the DMA and move the tail pointer once for the whole batch */
+	stmmac_enable_dma_transmission(priv, priv->ioaddr);
+	stmmac_flush_tx_descriptors(priv, queue);
 
-	/* Return true if all of the 3 conditions are met
-	 *  a) TX Budget is still available
-	 *  b) work_done = true when XSK TX desc peek is empty (no more
-	 *     pending XSK TX for transmission)
+	/* Return true if the XSK TX ring was drained before the budget or
+	 * the TX ring threshold was reached.
 	 */
-	return !!budget && work_done;
+	return nb_pkts < budget;
 }
 
 static void stmmac_bump_dma_threshold(struct stmmac_priv *priv, u32 chan)
@@ -3469,8 +3468,8 @@ static void stmmac_free_irq(struct net_device *dev,
 static int stmmac_request_irq_multi_msi(struct net_device *dev)
 {
 	struct stmmac_priv *priv = netdev_priv(dev);
+	int node = dev_to_node(priv->device);
 	enum request_irq_err irq_err;
-	cpumask_t cpu_mask;
 	int irq_idx = 0;
 	char *int_name;
 	int ret;
@@ -3581,9 +3580,8 @@ static int stmmac_request_irq_multi_msi(struct net_device *dev)
 			irq_idx = i;
 			goto irq_error;
 		}
-		cpumask_clear(&cpu_mask);
-		cpumask_set_cpu(i % num_online_cpus(), &cpu_mask);
-		irq_set_affinity_hint(priv->rx_irq[i], &cpu_mask);
+		irq_set_affinity_hint(priv->rx_irq[i],
+				      cpumask_of(cpumask_local_spread(i, node)));
 	}
 
 	/* Request Tx MSI irq */
@@ -3606,9 +3604,8 @@ static int stmmac_request_irq_multi_msi(struct net_device *dev)
 			irq_idx = i;
 			goto irq_error;
 		}
-		cpumask_clear(&cpu_mask);
-		cpumask_set_cpu(i % num_online_cpus(), &cpu_mask);
-		irq_set_affinity_hint(priv->tx_irq[i], &cpu_mask);
+		irq_set_affinity_hint(priv->tx_irq[i],
+				      cpumask_of(cpumask_local_spread(i, node)));
 	}
 
 	return 0;
@@ -3895,6 +3892,9 @@ static int stmmac_release(struct net_device *dev)
 	for (chan = 0; chan < priv->plat->tx_queues_to_use; chan++)
 		hrtimer_cancel(&priv->dma_conf.tx_queue[chan].txtimer);
 
+	for (chan = 0; chan < priv->plat->rx_queues_to_use; chan++)
+		cancel_work_sync(&priv->channel[chan].rx_dim.work);
+
 	netif_tx_disable(dev);
 
 	/* Free the IRQ lines */
@@ -5399,6 +5399,7 @@ static int stmmac_rx(struct stmmac_priv *priv, int limit, u32 queue)
 
 		priv->dev->stats.rx_packets++;
 		priv->dev->stats.rx_bytes += len;
+		ch->rx_dim_bytes += len;
 		count++;
 	}
 
@@ -5419,6 +5420,40 @@ static int stmmac_rx(struct stmmac_priv *priv, int limit, u32 queue)
 	return count;
 }
 
+/* Apply the moderation profile net_dim picked for a channel to its RX
+ * interrupt watchdog.
+ */
+static void stmmac_rx_dim_work(struct work_struct *work)
+{
+	struct dim *dim = container_of(work, struct dim, work);
+	struct stmmac_channel *ch =
+		container_of(dim, struct stmmac_channel, rx_dim);
+	struct stmmac_priv *priv = ch->priv_data;
+	struct dim_cq_moder moder;
+	u32 riwt;
+
+	/* Turned off meanwhile, the ethtool value is back in place */
+	if (READ_ONCE(ch->rx_dim_enabled)) {
+		moder = net_dim_get_rx_moderation(dim->mode, dim->profile_ix);
+		riwt = clamp_t(u32, stmmac_usec2riwt(moder.usec, priv),
+			       MIN_DMA_RIWT, MAX_DMA_RIWT);
+		stmmac_rx_watchdog(priv, priv->ioaddr, riwt, ch->index);
+	}
+
+	dim->state = DIM_START_MEASURE;
+}
+
+static void stmmac_rx_dim_update(struct stmmac_priv *priv,
+				 struct stmmac_channel *ch)
+{
+	struct dim_sample dim_sample = {};
+
+	dim_update_sample(++ch->rx_dim_events,
+			  priv->xstats.rxq_stats[ch->index].rx_pkt_n,
+			  ch->rx_dim_bytes, &dim_sample);
+	net_dim(&ch->rx_dim, dim_sample);
+}
+
 static int stmmac_napi_poll_rx(struct napi_struct *napi, int budget)
 {
 	struct stmmac_channel *ch =
@@ -5433,6 +5468,9 @@ static int stmmac_napi_poll_rx(struct napi_struct *napi, int budget)
 	if (work_done < budget && napi_complete_done(napi, work_done)) {
 		unsigned long flags;
 
+		if (READ_ONCE(ch->rx_dim_enabled))
+			stmmac_rx_dim_update(priv, ch);
+
 		spin_lock_irqsave(&ch->lock, flags);
 		stmmac_enable_dma_irq(priv, priv->ioaddr, chan, 1, 0);
 		spin_unlock_irqrestore(&ch->lock, flags);
@@ -6889,6 +6927,8 @@ static void stmmac_napi_add(struct net_device *dev)
 
 		if (queue < priv->plat->rx_queues_to_use) {
 			netif_napi_add(dev, &ch->rx_napi, stmmac_napi_poll_rx);
+			INIT_WORK(&ch->rx_dim.work, stmmac_rx_dim_work);
+			ch->rx_dim.mode = DIM_CQ_PERIOD_MODE_START_FROM_EQE;
 		}
 		if (queue < priv->plat->tx_queues_to_use) {
 			netif_napi_add_tx(dev, &ch->tx_napi,
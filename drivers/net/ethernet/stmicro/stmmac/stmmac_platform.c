@@ -658,9 +658,45 @@ void stmmac_remove_config_dt(struct platform_device *pdev,
 EXPORT_SYMBOL_GPL(stmmac_probe_config_dt);
 EXPORT_SYMBOL_GPL(stmmac_remove_config_dt);
 
+/**
+ * stmmac_get_platform_queue_irqs - look up the per-channel DMA interrupts
+ * @pdev: platform_device structure
+ * @stmmac_res: resources to fill in
+ * Description: some platforms route the interrupt of each RX and TX DMA
+ * channel to a dedicated line, named "rx-queue-N" and "tx-queue-N". They
+ * are all optional; the glue driver decides whether to use them by setting
+ * multi_msi_en.
+ */
+static int stmmac_get_platform_queue_irqs(struct platform_device *pdev,
+					  struct stmmac_resources *stmmac_res)
+{
+	char name[16];
+	int i, irq;
+
+	for (i = 0; i < MTL_MAX_RX_QUEUES; i++) {
+		snprintf(name, sizeof(name), "rx-queue-%d", i);
+		irq = platform_get_irq_byname_optional(pdev, name);
+		if (irq == -EPROBE_DEFER)
+			return irq;
+		stmmac_res->rx_irq[i] = irq > 0 ? irq : 0;
+	}
+
+	for (i = 0; i < MTL_MAX_TX_QUEUES; i++) {
+		snprintf(name, sizeof(name), "tx-queue-%d", i);
+		irq = platform_get_irq_byname_optional(pdev, name);
+		if (irq == -EPROBE_DEFER)
+			return irq;
+		stmmac_res->tx_irq[i] = irq > 0 ? irq : 0;
+	}
+
+	return 0;
+}
+
 int stmmac_get_platform_resources(struct platform_device *pdev,
 				  struct stmmac_resources *stmmac_res)
 {
+	int ret;
+
 	memset(stmmac_res, 0, sizeof(*stmmac_res));
 
 	/* Get IRQ information early to have an ability to ask for deferred
@@ -694,6 +730,10 @@ int stmmac_get_platform_resources(struct platform_device *pdev,
 		dev_info(&pdev->dev, "IRQ eth_lpi not found\n");
 	}
 
+	ret = stmmac_get_platform_queue_irqs(pdev, stmmac_res);
+	if (ret)
+		return ret;
+
 	stmmac_res->addr = devm_platform_ioremap_resource(pdev, 0);
 
 	return PTR_ERR_OR_ZERO(stmmac_res->addr);
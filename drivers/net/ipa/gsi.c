@@ -1560,6 +1560,11 @@ static int gsi_channel_poll(struct napi_struct *napi, int budget)
 		gsi_trans_complete(trans);
 	}
 
+	/* Receive buffers replenished while polling are handed off at once */
+	if (!channel->toward_ipa)
+		ipa_gsi_channel_rx_poll_done(channel->gsi,
+					     gsi_channel_id(channel));
+
 	if (count < budget && napi_complete(napi))
 		gsi_irq_ieob_enable_one(channel->gsi, channel->evt_ring_id);
 
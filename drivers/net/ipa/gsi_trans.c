@@ -587,8 +587,12 @@ static void __gsi_trans_commit(struct gsi_trans *trans, bool ring_db)
 
 	gsi_trans_move_committed(trans);
 
-	/* Ring doorbell if requested, or if all TREs are allocated */
-	if (ring_db || !atomic_read(&channel->trans_info.tre_avail)) {
+	/* Ring doorbell if requested, or if all TREs are allocated.  A full
+	 * RX channel is left to the caller, which rings the doorbell once
+	 * using gsi_channel_doorbell_flush() when done replenishing.
+	 */
+	if (ring_db || (channel->toward_ipa &&
+			!atomic_read(&channel->trans_info.tre_avail))) {
 		/* Report what we're handing off to hardware for TX channels */
 		if (channel->toward_ipa)
 			gsi_trans_tx_queued(trans);
@@ -606,6 +610,27 @@ void gsi_trans_commit(struct gsi_trans *trans, bool ring_db)
 		gsi_trans_free(trans);
 }
 
+void gsi_channel_doorbell_flush(struct gsi *gsi, u32 channel_id)
+{
+	struct gsi_channel *channel = &gsi->channel[channel_id];
+	struct gsi_trans_info *trans_info = &channel->trans_info;
+	struct gsi_trans *trans;
+	u16 trans_index;
+
+	/* Nothing to do unless there are committed transactions */
+	if (trans_info->committed_id == trans_info->allocated_id)
+		return;
+
+	/* The last committed transaction precedes the first allocated one */
+	trans_index = (trans_info->allocated_id - 1) % channel->tre_count;
+	trans = &trans_info->trans[trans_index];
+
+	if (channel->toward_ipa)
+		gsi_trans_tx_queued(trans);
+	gsi_trans_move_pending(trans);
+	gsi_channel_doorbell(channel);
+}
+
 /* Commit a GSI transaction and wait for it to complete */
 void gsi_trans_commit_wait(struct gsi_trans *trans)
 {
@@ -664,6 +689,32 @@ void gsi_channel_trans_cancel_pending(struct gsi_channel *channel)
 	napi_schedule(&channel->napi);
 }
 
+/* Complete a stopped channel's transactions after it has been reset */
+void gsi_channel_trans_drain(struct gsi *gsi, u32 channel_id)
+{
+	struct gsi_channel *channel = &gsi->channel[channel_id];
+	struct gsi_trans_info *trans_info = &channel->trans_info;
+	u16 trans_id = trans_info->committed_id;
+
+	/* NAPI is disabled, so nothing else completes transactions now */
+
+	/* Committed transactions never made it to hardware; cancel them */
+	while (trans_id != trans_info->allocated_id)
+		trans_info->trans[trans_id++ % channel->tre_count].cancelled = true;
+	trans_info->committed_id = trans_id;
+	trans_info->pending_id = trans_id;
+
+	/* All remaining transactions are cancelled, complete them here */
+	while (trans_info->completed_id != trans_info->pending_id) {
+		struct gsi_trans *trans;
+
+		trans_id = trans_info->completed_id % channel->tre_count;
+		trans = &trans_info->trans[trans_id];
+		gsi_trans_move_polled(trans);
+		gsi_trans_complete(trans);
+	}
+}
+
 /* Issue a command to read a single byte from a channel */
 int gsi_trans_read_byte(struct gsi *gsi, u32 channel_id, dma_addr_t addr)
 {
@@ -142,6 +142,16 @@ void gsi_trans_pool_exit_dma(struct device *dev, struct gsi_trans_pool *pool);
  */
 bool gsi_channel_trans_idle(struct gsi *gsi, u32 channel_id);
 
+/**
+ * gsi_channel_trans_drain() - Complete all transactions of a reset channel
+ * @gsi:	GSI pointer
+ * @channel_id:	Channel whose transactions are completed
+ *
+ * The channel must be stopped and reset.  Its outstanding transactions
+ * are cancelled and completed, which releases their resources.
+ */
+void gsi_channel_trans_drain(struct gsi *gsi, u32 channel_id);
+
 /**
  * gsi_channel_trans_alloc() - Allocate a GSI transaction on a channel
  * @gsi:	GSI pointer
@@ -199,6 +209,16 @@ int gsi_trans_skb_add(struct gsi_trans *trans, struct sk_buff *skb);
  */
 void gsi_trans_commit(struct gsi_trans *trans, bool ring_db);
 
+/**
+ * gsi_channel_doorbell_flush() - Ring the doorbell for committed transfers
+ * @gsi:	GSI pointer
+ * @channel_id:	Channel whose committed transactions should be handed off
+ *
+ * Tells the hardware about all transactions committed (but not yet
+ * reported to hardware) on a channel.  Does nothing if there are none.
+ */
+void gsi_channel_doorbell_flush(struct gsi *gsi, u32 channel_id);
+
 /**
  * gsi_trans_commit_wait() - Commit a GSI transaction and wait for it
  *			     to complete
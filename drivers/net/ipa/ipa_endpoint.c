@@ -10,6 +10,7 @@
 #include <linux/bitfield.h>
 #include <linux/if_rmnet.h>
 #include <linux/dma-direction.h>
+#include <net/page_pool.h>
 
 #include "gsi.h"
 #include "gsi_trans.h"
@@ -1149,6 +1150,31 @@ static void ipa_endpoint_status(struct ipa_endpoint *endpoint)
 	iowrite32(val, ipa->reg_virt + ipa_reg_n_offset(reg, endpoint_id));
 }
 
+/* Receive buffers come from the endpoint's page pool, if it has one.
+ * Pool pages are handed out as a single fragment spanning the whole page,
+ * so that users of the received data can share it by fragment count.
+ */
+static struct page *ipa_endpoint_page_alloc(struct ipa_endpoint *endpoint)
+{
+	u32 buffer_size = endpoint->config.rx.buffer_size;
+	unsigned int offset;
+
+	if (endpoint->page_pool)
+		return page_pool_dev_alloc_frag(endpoint->page_pool, &offset,
+						PAGE_SIZE << get_order(buffer_size));
+
+	return dev_alloc_pages(get_order(buffer_size));
+}
+
+static void ipa_endpoint_page_free(struct ipa_endpoint *endpoint,
+				   struct page *page)
+{
+	if (endpoint->page_pool)
+		page_pool_put_full_page(endpoint->page_pool, page, false);
+	else
+		put_page(page);
+}
+
 static int ipa_endpoint_replenish_one(struct ipa_endpoint *endpoint,
 				      struct gsi_trans *trans)
 {
@@ -1159,7 +1185,7 @@ static int ipa_endpoint_replenish_one(struct ipa_endpoint *endpoint,
 	int ret;
 
 	buffer_size = endpoint->config.rx.buffer_size;
-	page = dev_alloc_pages(get_order(buffer_size));
+	page = ipa_endpoint_page_alloc(endpoint);
 	if (!page)
 		return -ENOMEM;
 
@@ -1169,16 +1195,33 @@ static int ipa_endpoint_replenish_one(struct ipa_endpoint *endpoint,
 
 	ret = gsi_trans_page_add(trans, page, len, offset);
 	if (ret)
-		put_page(page);
+		ipa_endpoint_page_free(endpoint, page);
 	else
 		trans->data = page;	/* transaction owns page now */
 
 	return ret;
 }
 
+/* Ring the doorbell for buffers committed but not yet handed to hardware,
+ * or defer that to the end of the current poll.  Caller holds (has set)
+ * IPA_REPLENISH_ACTIVE.
+ */
+static void ipa_endpoint_replenish_flush(struct ipa_endpoint *endpoint,
+					 bool in_poll)
+{
+	if (in_poll) {
+		set_bit(IPA_REPLENISH_DEFERRED, endpoint->replenish_flags);
+		return;
+	}
+
+	clear_bit(IPA_REPLENISH_DEFERRED, endpoint->replenish_flags);
+	gsi_channel_doorbell_flush(&endpoint->ipa->gsi, endpoint->channel_id);
+}
+
 /**
  * ipa_endpoint_replenish() - Replenish endpoint receive buffers
  * @endpoint:	Endpoint to be replenished
+ * @in_poll:	Whether called while polling the endpoint's channel
  *
  * The IPA hardware can hold a fixed number of receive buffers for an RX
  * endpoint, based on the number of entries in the underlying channel ring
@@ -1186,9 +1229,15 @@ static int ipa_endpoint_replenish_one(struct ipa_endpoint *endpoint,
  * more receive buffers can be supplied to the hardware.  Replenishing for
  * an endpoint can be disabled, in which case buffers are not queued to
  * the hardware.
+ *
+ * Buffers are handed to the hardware in batches.  While polling, the
+ * doorbell for the last partial batch is deferred to the end of the poll
+ * (see ipa_endpoint_rx_poll_done()), so a poll that completes many
+ * transactions rings the doorbell only once per batch.
  */
-static void ipa_endpoint_replenish(struct ipa_endpoint *endpoint)
+static void ipa_endpoint_replenish(struct ipa_endpoint *endpoint, bool in_poll)
 {
+	struct gsi *gsi = &endpoint->ipa->gsi;
 	struct gsi_trans *trans;
 
 	if (!test_bit(IPA_REPLENISH_ENABLED, endpoint->replenish_flags))
@@ -1210,12 +1259,14 @@ static void ipa_endpoint_replenish(struct ipa_endpoint *endpoint)
 		gsi_trans_commit(trans, doorbell);
 	}
 
+	ipa_endpoint_replenish_flush(endpoint, in_poll);
 	clear_bit(IPA_REPLENISH_ACTIVE, endpoint->replenish_flags);
 
 	return;
 
 try_again_later:
 	gsi_trans_free(trans);
+	ipa_endpoint_replenish_flush(endpoint, in_poll);
 	clear_bit(IPA_REPLENISH_ACTIVE, endpoint->replenish_flags);
 
 	/* Whenever a receive buffer transaction completes we'll try to
@@ -1224,18 +1275,32 @@ static void ipa_endpoint_replenish(struct ipa_endpoint *endpoint)
 	 * If the hardware has no receive buffers queued, schedule work to
 	 * try replenishing again.
 	 */
-	if (gsi_channel_trans_idle(&endpoint->ipa->gsi, endpoint->channel_id))
+	if (gsi_channel_trans_idle(gsi, endpoint->channel_id))
 		schedule_delayed_work(&endpoint->replenish_work,
 				      msecs_to_jiffies(1));
 }
 
+/* Called at the end of each NAPI poll of an RX endpoint's channel */
+void ipa_endpoint_rx_poll_done(struct ipa_endpoint *endpoint)
+{
+	if (!test_bit(IPA_REPLENISH_DEFERRED, endpoint->replenish_flags))
+		return;
+
+	/* An active replenish (from the workqueue) flushes when done */
+	if (test_and_set_bit(IPA_REPLENISH_ACTIVE, endpoint->replenish_flags))
+		return;
+
+	ipa_endpoint_replenish_flush(endpoint, false);
+	clear_bit(IPA_REPLENISH_ACTIVE, endpoint->replenish_flags);
+}
+
 static void ipa_endpoint_replenish_enable(struct ipa_endpoint *endpoint)
 {
 	set_bit(IPA_REPLENISH_ENABLED, endpoint->replenish_flags);
 
 	/* Start replenishing if hardware currently has no buffers */
 	if (gsi_channel_trans_idle(&endpoint->ipa->gsi, endpoint->channel_id))
-		ipa_endpoint_replenish(endpoint);
+		ipa_endpoint_replenish(endpoint, false);
 }
 
 static void ipa_endpoint_replenish_disable(struct ipa_endpoint *endpoint)
@@ -1250,7 +1315,7 @@ static void ipa_endpoint_replenish_work(struct work_struct *work)
 
 	endpoint = container_of(dwork, struct ipa_endpoint, replenish_work);
 
-	ipa_endpoint_replenish(endpoint);
+	ipa_endpoint_replenish(endpoint, false);
 }
 
 static void ipa_endpoint_skb_copy(struct ipa_endpoint *endpoint,
@@ -1289,6 +1354,9 @@ static bool ipa_endpoint_skb_build(struct ipa_endpoint *endpoint,
 		/* Reserve the headroom and account for the data */
 		skb_reserve(skb, NET_SKB_PAD);
 		skb_put(skb, len);
+		/* Return the page to the pool when the skb is freed */
+		if (endpoint->page_pool)
+			skb_mark_for_recycle(skb);
 	}
 
 	/* Receive the buffer (or record drop if unable to build it) */
@@ -1460,7 +1528,7 @@ void ipa_endpoint_trans_complete(struct ipa_endpoint *endpoint,
 	else if (ipa_endpoint_skb_build(endpoint, page, trans->len))
 		trans->data = NULL;	/* Pages have been consumed */
 done:
-	ipa_endpoint_replenish(endpoint);
+	ipa_endpoint_replenish(endpoint, true);
 }
 
 void ipa_endpoint_trans_release(struct ipa_endpoint *endpoint,
@@ -1480,7 +1548,7 @@ void ipa_endpoint_trans_release(struct ipa_endpoint *endpoint,
 		struct page *page = trans->data;
 
 		if (page)
-			put_page(page);
+			ipa_endpoint_page_free(endpoint, page);
 	}
 }
 
@@ -1775,6 +1843,36 @@ void ipa_endpoint_resume(struct ipa *ipa)
 		ipa_modem_resume(ipa->modem_netdev);
 }
 
+/* Receive buffers are recycled through a page pool sized to fill the
+ * channel.  The GSI layer maps each page when it's queued to hardware, so
+ * the pool itself doesn't do DMA mapping.  Pool pages are fragment counted,
+ * so rmnet can keep parts of an aggregate without taking them out of the
+ * pool.  If the pool can't be created buffers are allocated from the page
+ * allocator.
+ */
+static void ipa_endpoint_page_pool_create(struct ipa_endpoint *endpoint)
+{
+	struct gsi *gsi = &endpoint->ipa->gsi;
+	struct page_pool_params pp_params = { };
+	struct page_pool *pool;
+
+	pp_params.flags = PP_FLAG_PAGE_FRAG;
+	pp_params.order = get_order(endpoint->config.rx.buffer_size);
+	pp_params.pool_size = gsi->channel[endpoint->channel_id].tre_count;
+	pp_params.nid = NUMA_NO_NODE;
+	pp_params.dev = &endpoint->ipa->pdev->dev;
+	pp_params.dma_dir = DMA_FROM_DEVICE;
+
+	pool = page_pool_create(&pp_params);
+	if (IS_ERR(pool)) {
+		dev_warn(&endpoint->ipa->pdev->dev,
+			 "endpoint %u: unable to create page pool (%ld)\n",
+			 endpoint->endpoint_id, PTR_ERR(pool));
+		pool = NULL;
+	}
+	endpoint->page_pool = pool;
+}
+
 static void ipa_endpoint_setup_one(struct ipa_endpoint *endpoint)
 {
 	struct gsi *gsi = &endpoint->ipa->gsi;
@@ -1793,6 +1891,7 @@ static void ipa_endpoint_setup_one(struct ipa_endpoint *endpoint)
 		clear_bit(IPA_REPLENISH_ACTIVE, endpoint->replenish_flags);
 		INIT_DELAYED_WORK(&endpoint->replenish_work,
 				  ipa_endpoint_replenish_work);
+		ipa_endpoint_page_pool_create(endpoint);
 	}
 
 	ipa_endpoint_program(endpoint);
@@ -1808,6 +1907,18 @@ static void ipa_endpoint_teardown_one(struct ipa_endpoint *endpoint)
 		cancel_delayed_work_sync(&endpoint->replenish_work);
 
 	ipa_endpoint_reset(endpoint);
+
+	/* Return the buffers of outstanding receive transactions first;
+	 * pages still held by the network stack keep the pool alive.
+	 */
+	if (!endpoint->toward_ipa)
+		gsi_channel_trans_drain(&endpoint->ipa->gsi,
+					endpoint->channel_id);
+
+	if (endpoint->page_pool) {
+		page_pool_destroy(endpoint->page_pool);
+		endpoint->page_pool = NULL;
+	}
 }
 
 void ipa_endpoint_setup(struct ipa *ipa)
@@ -14,6 +14,7 @@
 #include "ipa_reg.h"
 
 struct net_device;
+struct page_pool;
 struct sk_buff;
 
 struct ipa;
@@ -126,11 +127,13 @@ struct ipa_endpoint_config {
  *
  * @IPA_REPLENISH_ENABLED:	Whether receive buffer replenishing is enabled
  * @IPA_REPLENISH_ACTIVE:	Whether replenishing is underway
+ * @IPA_REPLENISH_DEFERRED:	Whether buffers await a doorbell at poll end
  * @IPA_REPLENISH_COUNT:	Number of defined replenish flags
  */
 enum ipa_replenish_flag {
 	IPA_REPLENISH_ENABLED,
 	IPA_REPLENISH_ACTIVE,
+	IPA_REPLENISH_DEFERRED,
 	IPA_REPLENISH_COUNT,	/* Number of flags (must be last) */
 };
 
@@ -167,6 +170,7 @@ struct ipa_endpoint {
 	DECLARE_BITMAP(replenish_flags, IPA_REPLENISH_COUNT);
 	u64 replenish_count;
 	struct delayed_work replenish_work;		/* global wq */
+	struct page_pool *page_pool;	/* Receive buffers; may be NULL */
 };
 
 void ipa_endpoint_modem_hol_block_clear_all(struct ipa *ipa);
@@ -204,4 +208,6 @@ void ipa_endpoint_trans_complete(struct ipa_endpoint *ipa,
 void ipa_endpoint_trans_release(struct ipa_endpoint *ipa,
 				struct gsi_trans *trans);
 
+void ipa_endpoint_rx_poll_done(struct ipa_endpoint *endpoint);
+
 #endif /* _IPA_ENDPOINT_H_ */
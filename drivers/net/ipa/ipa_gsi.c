@@ -48,6 +48,13 @@ void ipa_gsi_channel_tx_completed(struct gsi *gsi, u32 channel_id, u32 count,
 		netdev_completed_queue(endpoint->netdev, count, byte_count);
 }
 
+void ipa_gsi_channel_rx_poll_done(struct gsi *gsi, u32 channel_id)
+{
+	struct ipa *ipa = container_of(gsi, struct ipa, gsi);
+
+	ipa_endpoint_rx_poll_done(ipa->channel_map[channel_id]);
+}
+
 /* Indicate whether an endpoint config data entry is "empty" */
 bool ipa_gsi_endpoint_data_empty(const struct ipa_gsi_endpoint_data *data)
 {
@@ -57,6 +57,17 @@ void ipa_gsi_channel_tx_queued(struct gsi *gsi, u32 channel_id, u32 count,
 void ipa_gsi_channel_tx_completed(struct gsi *gsi, u32 channel_id, u32 count,
 				  u32 byte_count);
 
+/**
+ * ipa_gsi_channel_rx_poll_done() - GSI RX channel poll completion callback
+ * @gsi:	GSI pointer
+ * @channel_id:	Channel number
+ *
+ * This called from the GSI layer at the end of each NAPI poll of an RX
+ * channel, to let the IPA layer hand off receive buffers it queued
+ * while completing received transactions.
+ */
+void ipa_gsi_channel_rx_poll_done(struct gsi *gsi, u32 channel_id);
+
 /* ipa_gsi_endpoint_data_empty() - Empty endpoint config data test
  * @data:	endpoint configuration data
  *
@@ -354,7 +354,8 @@ static int set_allowedip(struct wg_peer *peer, struct nlattr **attrs)
 	return ret;
 }
 
-static int set_peer(struct wg_device *wg, struct nlattr **attrs)
+static int set_peer(struct wg_device *wg, struct nlattr **attrs,
+		    struct list_head *dead_peers)
 {
 	u8 *public_key = NULL, *preshared_key = NULL;
 	struct wg_peer *peer = NULL;
@@ -422,7 +423,7 @@ static int set_peer(struct wg_device *wg, struct nlattr **attrs)
 	}
 
 	if (flags & WGPEER_F_REMOVE_ME) {
-		wg_peer_remove(peer);
+		wg_peer_remove_deferred(peer, dead_peers);
 		goto out;
 	}
 
@@ -493,6 +494,7 @@ static int set_peer(struct wg_device *wg, struct nlattr **attrs)
 static int wg_set_device(struct sk_buff *skb, struct genl_info *info)
 {
 	struct wg_device *wg = lookup_interface(info->attrs, skb);
+	LIST_HEAD(dead_peers);
 	u32 flags = 0;
 	int ret;
 
@@ -585,7 +587,7 @@ static int wg_set_device(struct sk_buff *skb, struct genl_info *info)
 					       peer_policy, NULL);
 			if (ret < 0)
 				goto out;
-			ret = set_peer(wg, peer);
+			ret = set_peer(wg, peer, &dead_peers);
 			if (ret < 0)
 				goto out;
 		}
@@ -593,6 +595,8 @@ static int wg_set_device(struct sk_buff *skb, struct genl_info *info)
 	ret = 0;
 
 out:
+	/* Peers removed by this message share one grace period. */
+	wg_peer_remove_finish(&dead_peers);
 	mutex_unlock(&wg->device_update_lock);
 	rtnl_unlock();
 	dev_put(wg->dev);
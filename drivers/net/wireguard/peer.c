@@ -91,42 +91,54 @@ static void peer_make_dead(struct wg_peer *peer)
 	/* The caller must now synchronize_net() for this to take effect. */
 }
 
-static void peer_remove_after_dead(struct wg_peer *peer)
+static void peer_remove_after_dead(struct list_head *dead_peers)
 {
-	WARN_ON(!peer->is_dead);
+	struct wg_device *wg = NULL;
+	struct wg_peer *peer, *temp;
 
-	/* No more keypairs can be created for this peer, since is_dead protects
-	 * add_new_keypair, so we can now destroy existing ones.
-	 */
-	wg_noise_keypairs_clear(&peer->keypairs);
+	list_for_each_entry(peer, dead_peers, peer_list) {
+		WARN_ON(!peer->is_dead);
+		wg = peer->device;
 
-	/* Destroy all ongoing timers that were in-flight at the beginning of
-	 * this function.
-	 */
-	wg_timers_stop(peer);
+		/* No more keypairs can be created for this peer, since is_dead
+		 * protects add_new_keypair, so we can now destroy existing ones.
+		 */
+		wg_noise_keypairs_clear(&peer->keypairs);
+
+		/* Destroy all ongoing timers that were in-flight at the
+		 * beginning of this function.
+		 */
+		wg_timers_stop(peer);
+	}
+	if (!wg)
+		return;
 
 	/* The transition between packet encryption/decryption queues isn't
 	 * guarded by is_dead, but each reference's life is strictly bounded by
 	 * two generations: once for parallel crypto and once for serial
 	 * ingestion, so we can simply flush twice, and be sure that we no
-	 * longer have references inside these queues.
+	 * longer have references inside these queues. The flushes cover every
+	 * dead peer at once, so removing many peers costs the same number of
+	 * workqueue generations as removing one.
 	 */
 
 	/* a) For encrypt/decrypt. */
-	flush_workqueue(peer->device->packet_crypt_wq);
+	flush_workqueue(wg->packet_crypt_wq);
 	/* b.1) For send (but not receive, since that's napi). */
-	flush_workqueue(peer->device->packet_crypt_wq);
-	/* b.2.1) For receive (but not send, since that's wq). */
-	napi_disable(&peer->napi);
-	/* b.2.1) It's now safe to remove the napi struct, which must be done
-	 * here from process context.
-	 */
-	netif_napi_del(&peer->napi);
+	flush_workqueue(wg->packet_crypt_wq);
+	list_for_each_entry(peer, dead_peers, peer_list) {
+		/* b.2.1) For receive (but not send, since that's wq). */
+		napi_disable(&peer->napi);
+		/* b.2.1) It's now safe to remove the napi struct, which must be
+		 * done here from process context.
+		 */
+		netif_napi_del(&peer->napi);
+	}
 
 	/* Ensure any workstructs we own (like transmit_handshake_work or
 	 * clear_peer_work) no longer are in use.
 	 */
-	flush_workqueue(peer->device->handshake_send_wq);
+	flush_workqueue(wg->handshake_send_wq);
 
 	/* After the above flushes, a peer might still be active in a few
 	 * different contexts: 1) from xmit(), before hitting is_dead and
@@ -145,8 +157,11 @@ static void peer_remove_after_dead(struct wg_peer *peer)
 	 * with a refcount of zero, so no new reference is taken.
 	 */
 
-	--peer->device->num_peers;
-	wg_peer_put(peer);
+	list_for_each_entry_safe(peer, temp, dead_peers, peer_list) {
+		list_del_init(&peer->peer_list);
+		--wg->num_peers;
+		wg_peer_put(peer);
+	}
 }
 
 /* We have a separate "remove" function make sure that all active places where
@@ -154,14 +169,39 @@ static void peer_remove_after_dead(struct wg_peer *peer)
  * their reference onto another context.
  */
 void wg_peer_remove(struct wg_peer *peer)
+{
+	LIST_HEAD(dead_peers);
+
+	if (unlikely(!peer))
+		return;
+	lockdep_assert_held(&peer->device->device_update_lock);
+
+	wg_peer_remove_deferred(peer, &dead_peers);
+	wg_peer_remove_finish(&dead_peers);
+}
+
+/* Removing a peer costs a full RCU grace period plus several workqueue
+ * flushes, so callers that remove more than one peer under a single
+ * device_update_lock critical section should make each of them dead with
+ * wg_peer_remove_deferred() and then pay for all of them at once with
+ * wg_peer_remove_finish().
+ */
+void wg_peer_remove_deferred(struct wg_peer *peer, struct list_head *dead_peers)
 {
 	if (unlikely(!peer))
 		return;
 	lockdep_assert_held(&peer->device->device_update_lock);
 
 	peer_make_dead(peer);
+	list_add_tail(&peer->peer_list, dead_peers);
+}
+
+void wg_peer_remove_finish(struct list_head *dead_peers)
+{
+	if (list_empty(dead_peers))
+		return;
 	synchronize_net();
-	peer_remove_after_dead(peer);
+	peer_remove_after_dead(dead_peers);
 }
 
 void wg_peer_remove_all(struct wg_device *wg)
@@ -178,9 +218,7 @@ void wg_peer_remove_all(struct wg_device *wg)
 		peer_make_dead(peer);
 		list_add_tail(&peer->peer_list, &dead_peers);
 	}
-	synchronize_net();
-	list_for_each_entry_safe(peer, temp, &dead_peers, peer_list)
-		peer_remove_after_dead(peer);
+	wg_peer_remove_finish(&dead_peers);
 }
 
 static void rcu_release(struct rcu_head *rcu)
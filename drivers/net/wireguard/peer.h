@@ -78,6 +78,8 @@ static inline struct wg_peer *wg_peer_get(struct wg_peer *peer)
 }
 void wg_peer_put(struct wg_peer *peer);
 void wg_peer_remove(struct wg_peer *peer);
+void wg_peer_remove_deferred(struct wg_peer *peer, struct list_head *dead_peers);
+void wg_peer_remove_finish(struct list_head *dead_peers);
 void wg_peer_remove_all(struct wg_device *wg);
 
 int wg_peer_init(void);
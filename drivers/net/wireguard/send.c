@@ -293,6 +293,11 @@ void wg_packet_encrypt_worker(struct work_struct *work)
 	while ((first = ptr_ring_consume_bh(&queue->ring)) != NULL) {
 		enum packet_state state = PACKET_STATE_CRYPTED;
 
+		/* Each packet has its own nonce, so the bundle is encrypted one
+		 * skb at a time; the SIMD implementations behind the
+		 * chacha20poly1305 library already process several blocks of a
+		 * packet in parallel.
+		 */
 		skb_list_walk_safe(first, skb, next) {
 			if (likely(encrypt_packet(skb,
 					PACKET_CB(first)->keypair))) {
@@ -702,6 +702,8 @@ static u32 ath10k_ahb_qca4019_targ_cpu_to_ce_addr(struct ath10k *ar, u32 addr)
 
 static const struct ath10k_hif_ops ath10k_ahb_hif_ops = {
 	.tx_sg                  = ath10k_pci_hif_tx_sg,
+	.tx_batch_start         = ath10k_pci_hif_tx_batch_start,
+	.tx_batch_end           = ath10k_pci_hif_tx_batch_end,
 	.diag_read              = ath10k_pci_hif_diag_read,
 	.diag_write             = ath10k_pci_diag_write_mem,
 	.exchange_bmi_msg       = ath10k_pci_hif_exchange_bmi_msg,
@@ -534,8 +534,13 @@ static int _ath10k_ce_send_nolock(struct ath10k_ce_pipe *ce_state,
 	write_index = CE_RING_IDX_INCR(nentries_mask, write_index);
 
 	/* WORKAROUND */
-	if (!(flags & CE_SEND_FLAG_GATHER))
-		ath10k_ce_src_ring_write_index_set(ar, ctrl_addr, write_index);
+	if (!(flags & CE_SEND_FLAG_GATHER)) {
+		if (ce_state->send_defer)
+			ce_state->send_pending = true;
+		else
+			ath10k_ce_src_ring_write_index_set(ar, ctrl_addr,
+							   write_index);
+	}
 
 	src_ring->write_index = write_index;
 exit:
@@ -610,7 +615,9 @@ static int _ath10k_ce_send_nolock_64(struct ath10k_ce_pipe *ce_state,
 	write_index = CE_RING_IDX_INCR(nentries_mask, write_index);
 
 	if (!(flags & CE_SEND_FLAG_GATHER)) {
-		if (ar->hw_params.shadow_reg_support)
+		if (ce_state->send_defer)
+			ce_state->send_pending = true;
+		else if (ar->hw_params.shadow_reg_support)
 			ath10k_ce_shadow_src_ring_write_index_set(ar, ce_state,
 								  write_index);
 		else
@@ -663,6 +670,50 @@ void __ath10k_ce_send_revert(struct ath10k_ce_pipe *pipe)
 }
 EXPORT_SYMBOL(__ath10k_ce_send_revert);
 
+/*
+ * Batch source ring doorbells: sends issued between ath10k_ce_send_defer()
+ * and the matching ath10k_ce_send_flush() only advance the software write
+ * index, and the hardware is told about all of them with a single register
+ * write once the last deferring caller flushes. Calls may nest.
+ */
+void ath10k_ce_send_defer(struct ath10k_ce_pipe *ce_state)
+{
+	struct ath10k_ce *ce = ath10k_ce_priv(ce_state->ar);
+
+	spin_lock_bh(&ce->ce_lock);
+	ce_state->send_defer++;
+	spin_unlock_bh(&ce->ce_lock);
+}
+EXPORT_SYMBOL(ath10k_ce_send_defer);
+
+void ath10k_ce_send_flush(struct ath10k_ce_pipe *ce_state)
+{
+	struct ath10k *ar = ce_state->ar;
+	struct ath10k_ce *ce = ath10k_ce_priv(ar);
+	unsigned int write_index;
+
+	spin_lock_bh(&ce->ce_lock);
+
+	if (WARN_ON_ONCE(!ce_state->send_defer))
+		goto unlock;
+
+	if (--ce_state->send_defer || !ce_state->send_pending)
+		goto unlock;
+
+	write_index = ce_state->src_ring->write_index;
+	if (ar->hw_params.shadow_reg_support)
+		ath10k_ce_shadow_src_ring_write_index_set(ar, ce_state,
+							  write_index);
+	else
+		ath10k_ce_src_ring_write_index_set(ar, ce_state->ctrl_addr,
+						   write_index);
+	ce_state->send_pending = false;
+
+unlock:
+	spin_unlock_bh(&ce->ce_lock);
+}
+EXPORT_SYMBOL(ath10k_ce_send_flush);
+
 int ath10k_ce_send(struct ath10k_ce_pipe *ce_state,
 		   void *per_transfer_context,
 		   dma_addr_t buffer,
@@ -125,6 +125,14 @@ struct ath10k_ce_pipe {
 	void (*recv_cb)(struct ath10k_ce_pipe *);
 
 	unsigned int src_sz_max;
+
+	/* Nesting count of ath10k_ce_send_defer() callers. While non-zero
+	 * the source ring write index is only updated in software and is
+	 * written to the hardware by the final ath10k_ce_send_flush().
+	 */
+	unsigned int send_defer;
+	bool send_pending;
+
 	struct ath10k_ce_ring *src_ring;
 	struct ath10k_ce_ring *dest_ring;
 	const struct ath10k_ce_ops *ops;
@@ -188,6 +196,9 @@ int ath10k_ce_send_nolock(struct ath10k_ce_pipe *ce_state,
 
 void __ath10k_ce_send_revert(struct ath10k_ce_pipe *pipe);
 
+void ath10k_ce_send_defer(struct ath10k_ce_pipe *ce_state);
+void ath10k_ce_send_flush(struct ath10k_ce_pipe *ce_state);
+
 int ath10k_ce_num_free_src_entries(struct ath10k_ce_pipe *pipe);
 
 /*==================Recv=======================*/
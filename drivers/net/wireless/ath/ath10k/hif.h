@@ -31,6 +31,10 @@ struct ath10k_hif_ops {
 	int (*tx_sg)(struct ath10k *ar, u8 pipe_id,
 		     struct ath10k_hif_sg_item *items, int n_items);
 
+	/* defer and then ring the doorbell for tx_sg() calls on a pipe */
+	void (*tx_batch_start)(struct ath10k *ar, u8 pipe_id);
+	void (*tx_batch_end)(struct ath10k *ar, u8 pipe_id);
+
 	/* read firmware memory through the diagnose interface */
 	int (*diag_read)(struct ath10k *ar, u32 address, void *buf,
 			 size_t buf_len);
@@ -106,6 +110,18 @@ static inline int ath10k_hif_tx_sg(struct ath10k *ar, u8 pipe_id,
 	return ar->hif.ops->tx_sg(ar, pipe_id, items, n_items);
 }
 
+static inline void ath10k_hif_tx_batch_start(struct ath10k *ar, u8 pipe_id)
+{
+	if (ar->hif.ops->tx_batch_start)
+		ar->hif.ops->tx_batch_start(ar, pipe_id);
+}
+
+static inline void ath10k_hif_tx_batch_end(struct ath10k *ar, u8 pipe_id)
+{
+	if (ar->hif.ops->tx_batch_end)
+		ar->hif.ops->tx_batch_end(ar, pipe_id);
+}
+
 static inline int ath10k_hif_diag_read(struct ath10k *ar, u32 address, void *buf,
 				       size_t buf_len)
 {
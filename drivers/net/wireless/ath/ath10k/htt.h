@@ -14,6 +14,7 @@
 #include <linux/hashtable.h>
 #include <linux/kfifo.h>
 #include <net/mac80211.h>
+#include <net/page_pool.h>
 
 #include "htc.h"
 #include "hw.h"
@@ -1854,6 +1855,9 @@ struct ath10k_htt {
 		 */
 		struct timer_list refill_retry_timer;
 
+		/* recycles the pages backing the rx buffers */
+		struct page_pool *page_pool;
+
 		/* Protects access to all rx ring buffer state variables */
 		spinlock_t lock;
 	} rx_ring;
@@ -39,6 +39,60 @@ ath10k_htt_rx_find_skb_paddr(struct ath10k *ar, u64 paddr)
 	return NULL;
 }
 
+/* Rx buffers are built on page pool pages, which stay DMA mapped by the pool.
+ * Only the part the device may have written is synced back to the CPU, and
+ * skbs return their page to the pool when freed by the stack.
+ */
+static struct page_pool *ath10k_htt_rx_page_pool_create(struct ath10k_htt *htt)
+{
+	struct page_pool_params pp_params = {
+		.flags = PP_FLAG_DMA_MAP | PP_FLAG_DMA_SYNC_DEV,
+		.order = 0,
+		.pool_size = HTT_RX_RING_SIZE,
+		.nid = NUMA_NO_NODE,
+		.dev = htt->ar->dev,
+		.dma_dir = DMA_FROM_DEVICE,
+		.offset = NET_SKB_PAD,
+		.max_len = HTT_RX_BUF_SIZE,
+	};
+
+	BUILD_BUG_ON(NET_SKB_PAD + HTT_RX_BUF_SIZE +
+		     SKB_DATA_ALIGN(sizeof(struct skb_shared_info)) > PAGE_SIZE);
+
+	return page_pool_create(&pp_params);
+}
+
+static struct sk_buff *ath10k_htt_rx_alloc_skb(struct ath10k_htt *htt,
+					       dma_addr_t *paddr)
+{
+	struct page_pool *pool = htt->rx_ring.page_pool;
+	struct sk_buff *skb;
+	struct page *page;
+
+	page = page_pool_dev_alloc_pages(pool);
+	if (!page)
+		return NULL;
+
+	skb = build_skb(page_address(page), PAGE_SIZE);
+	if (!skb) {
+		page_pool_put_full_page(pool, page, false);
+		return NULL;
+	}
+
+	skb_reserve(skb, NET_SKB_PAD);
+	skb_mark_for_recycle(skb);
+	*paddr = page_pool_get_dma_addr(page) + NET_SKB_PAD;
+
+	return skb;
+}
+
+static void ath10k_htt_rx_sync_for_cpu(struct ath10k_htt *htt,
+				       struct sk_buff *skb)
+{
+	dma_sync_single_for_cpu(htt->ar->dev, ATH10K_SKB_RXCB(skb)->paddr,
+				HTT_RX_BUF_SIZE, DMA_FROM_DEVICE);
+}
+
 static void ath10k_htt_rx_ring_free(struct ath10k_htt *htt)
 {
 	struct sk_buff *skb;
@@ -49,9 +103,6 @@ static void ath10k_htt_rx_ring_free(struct ath10k_htt *htt)
 	if (htt->rx_ring.in_ord_rx) {
 		hash_for_each_safe(htt->rx_ring.skb_table, i, n, rxcb, hlist) {
 			skb = ATH10K_RXCB_SKB(rxcb);
-			dma_unmap_single(htt->ar->dev, rxcb->paddr,
-					 skb->len + skb_tailroom(skb),
-					 DMA_FROM_DEVICE);
 			hash_del(&rxcb->hlist);
 			dev_kfree_skb_any(skb);
 		}
@@ -61,10 +112,6 @@ static void ath10k_htt_rx_ring_free(struct ath10k_htt *htt)
 			if (!skb)
 				continue;
 
-			rxcb = ATH10K_SKB_RXCB(skb);
-			dma_unmap_single(htt->ar->dev, rxcb->paddr,
-					 skb->len + skb_tailroom(skb),
-					 DMA_FROM_DEVICE);
 			dev_kfree_skb_any(skb);
 		}
 	}
@@ -155,30 +202,18 @@ static int __ath10k_htt_rx_ring_fill_n(struct ath10k_htt *htt, int num)
 	}
 
 	while (num > 0) {
-		skb = dev_alloc_skb(HTT_RX_BUF_SIZE + HTT_RX_DESC_ALIGN);
+		skb = ath10k_htt_rx_alloc_skb(htt, &paddr);
 		if (!skb) {
 			ret = -ENOMEM;
 			goto fail;
 		}
 
-		if (!IS_ALIGNED((unsigned long)skb->data, HTT_RX_DESC_ALIGN))
-			skb_pull(skb,
-				 PTR_ALIGN(skb->data, HTT_RX_DESC_ALIGN) -
-				 skb->data);
-
 		/* Clear rx_desc attention word before posting to Rx ring */
 		rx_desc = HTT_RX_BUF_TO_RX_DESC(hw, skb->data);
 		ath10k_htt_rx_desc_get_attention(hw, rx_desc)->flags = __cpu_to_le32(0);
-
-		paddr = dma_map_single(htt->ar->dev, skb->data,
-				       skb->len + skb_tailroom(skb),
-				       DMA_FROM_DEVICE);
-
-		if (unlikely(dma_mapping_error(htt->ar->dev, paddr))) {
-			dev_kfree_skb_any(skb);
-			ret = -ENOMEM;
-			goto fail;
-		}
+		dma_sync_single_for_device(htt->ar->dev, paddr,
+					   hw->rx_desc_ops->rx_desc_size,
+					   DMA_FROM_DEVICE);
 
 		rxcb = ATH10K_SKB_RXCB(skb);
 		rxcb->paddr = paddr;
@@ -296,6 +331,9 @@ void ath10k_htt_rx_free(struct ath10k_htt *htt)
 	ath10k_htt_rx_ring_free(htt);
 	spin_unlock_bh(&htt->rx_ring.lock);
 
+	page_pool_destroy(htt->rx_ring.page_pool);
+	htt->rx_ring.page_pool = NULL;
+
 	dma_free_coherent(htt->ar->dev,
 			  ath10k_htt_get_rx_ring_size(htt),
 			  ath10k_htt_get_vaddr_ring(htt),
@@ -336,10 +374,7 @@ static inline struct sk_buff *ath10k_htt_rx_netbuf_pop(struct ath10k_htt *htt)
 	htt->rx_ring.sw_rd_idx.msdu_payld = idx;
 	htt->rx_ring.fill_cnt--;
 
-	dma_unmap_single(htt->ar->dev,
-			 ATH10K_SKB_RXCB(msdu)->paddr,
-			 msdu->len + skb_tailroom(msdu),
-			 DMA_FROM_DEVICE);
+	ath10k_htt_rx_sync_for_cpu(htt, msdu);
 	ath10k_dbg_dump(ar, ATH10K_DBG_HTT_DUMP, NULL, "htt rx netbuf pop: ",
 			msdu->data, msdu->len + skb_tailroom(msdu));
 
@@ -476,9 +511,7 @@ static struct sk_buff *ath10k_htt_rx_pop_paddr(struct ath10k_htt *htt,
 	hash_del(&rxcb->hlist);
 	htt->rx_ring.fill_cnt--;
 
-	dma_unmap_single(htt->ar->dev, rxcb->paddr,
-			 msdu->len + skb_tailroom(msdu),
-			 DMA_FROM_DEVICE);
+	ath10k_htt_rx_sync_for_cpu(htt, msdu);
 	ath10k_dbg_dump(ar, ATH10K_DBG_HTT_DUMP, NULL, "htt rx netbuf pop: ",
 			msdu->data, msdu->len + skb_tailroom(msdu));
 
@@ -824,6 +857,13 @@ int ath10k_htt_rx_alloc(struct ath10k_htt *htt)
 
 	htt->rx_ring.alloc_idx.vaddr = vaddr;
 	htt->rx_ring.alloc_idx.paddr = paddr;
+
+	htt->rx_ring.page_pool = ath10k_htt_rx_page_pool_create(htt);
+	if (IS_ERR(htt->rx_ring.page_pool)) {
+		htt->rx_ring.page_pool = NULL;
+		goto err_page_pool;
+	}
+
 	htt->rx_ring.sw_rd_idx.msdu_payld = htt->rx_ring.size_mask;
 	*htt->rx_ring.alloc_idx.vaddr = 0;
 
@@ -845,6 +885,12 @@ int ath10k_htt_rx_alloc(struct ath10k_htt *htt)
 		   htt->rx_ring.size, htt->rx_ring.fill_level);
 	return 0;
 
+err_page_pool:
+	dma_free_coherent(htt->ar->dev,
+			  sizeof(*htt->rx_ring.alloc_idx.vaddr),
+			  htt->rx_ring.alloc_idx.vaddr,
+			  htt->rx_ring.alloc_idx.paddr);
+	htt->rx_ring.alloc_idx.vaddr = NULL;
 err_dma_idx:
 	dma_free_coherent(htt->ar->dev,
 			  ath10k_htt_get_rx_ring_size(htt),
@@ -3229,7 +3275,10 @@ static void ath10k_htt_rx_h_rx_offload(struct ath10k *ar,
 		skb_put(msdu, sizeof(*rx));
 		skb_pull(msdu, sizeof(*rx));
 
-		if (skb_tailroom(msdu) < __le16_to_cpu(rx->msdu_len)) {
+		/* The page is larger than what the target may write */
+		if (min_t(size_t, skb_tailroom(msdu),
+			  HTT_RX_BUF_SIZE - sizeof(*rx)) <
+		    __le16_to_cpu(rx->msdu_len)) {
 			ath10k_warn(ar, "dropping frame: offloaded rx msdu is too long!\n");
 			dev_kfree_skb_any(msdu);
 			continue;
@@ -4448,11 +4448,26 @@ int ath10k_mac_tx_push_txq(struct ieee80211_hw *hw,
 	return skb_len;
 }
 
+/* Let the HIF ring the HTT tx pipe doorbell once per burst of pushed frames
+ * instead of once per frame.
+ */
+static void ath10k_mac_tx_batch_start(struct ath10k *ar)
+{
+	ath10k_hif_tx_batch_start(ar, ar->htc.endpoint[ar->htt.eid].ul_pipe_id);
+}
+
+static void ath10k_mac_tx_batch_end(struct ath10k *ar)
+{
+	ath10k_hif_tx_batch_end(ar, ar->htc.endpoint[ar->htt.eid].ul_pipe_id);
+}
+
 static int ath10k_mac_schedule_txq(struct ieee80211_hw *hw, u32 ac)
 {
+	struct ath10k *ar = hw->priv;
 	struct ieee80211_txq *txq;
 	int ret = 0;
 
+	ath10k_mac_tx_batch_start(ar);
 	ieee80211_txq_schedule_start(hw, ac);
 	while ((txq = ieee80211_next_txq(hw, ac))) {
 		while (ath10k_mac_tx_can_push(hw, txq)) {
@@ -4466,6 +4481,7 @@ static int ath10k_mac_schedule_txq(struct ieee80211_hw *hw, u32 ac)
 			break;
 	}
 	ieee80211_txq_schedule_end(hw, ac);
+	ath10k_mac_tx_batch_end(ar);
 
 	return ret;
 }
@@ -4739,6 +4755,7 @@ static void ath10k_mac_op_wake_tx_queue(struct ieee80211_hw *hw,
 		return;
 
 	ac = txq->ac;
+	ath10k_mac_tx_batch_start(ar);
 	ieee80211_txq_schedule_start(hw, ac);
 	txq = ieee80211_next_txq(hw, ac);
 	if (!txq)
@@ -4753,6 +4770,7 @@ static void ath10k_mac_op_wake_tx_queue(struct ieee80211_hw *hw,
 	ath10k_htt_tx_txq_update(hw, txq);
 out:
 	ieee80211_txq_schedule_end(hw, ac);
+	ath10k_mac_tx_batch_end(ar);
 }
 
 /* Must not be called with conf_mutex held as workers can use that also. */
@@ -1416,6 +1416,20 @@ int ath10k_pci_hif_tx_sg(struct ath10k *ar, u8 pipe_id,
 	return err;
 }
 
+void ath10k_pci_hif_tx_batch_start(struct ath10k *ar, u8 pipe_id)
+{
+	struct ath10k_pci *ar_pci = ath10k_pci_priv(ar);
+
+	ath10k_ce_send_defer(ar_pci->pipe_info[pipe_id].ce_hdl);
+}
+
+void ath10k_pci_hif_tx_batch_end(struct ath10k *ar, u8 pipe_id)
+{
+	struct ath10k_pci *ar_pci = ath10k_pci_priv(ar);
+
+	ath10k_ce_send_flush(ar_pci->pipe_info[pipe_id].ce_hdl);
+}
+
 int ath10k_pci_hif_diag_read(struct ath10k *ar, u32 address, void *buf,
 			     size_t buf_len)
 {
@@ -3071,6 +3085,8 @@ static int ath10k_pci_hif_fetch_cal_eeprom(struct ath10k *ar, void **data,
 
 static const struct ath10k_hif_ops ath10k_pci_hif_ops = {
 	.tx_sg			= ath10k_pci_hif_tx_sg,
+	.tx_batch_start		= ath10k_pci_hif_tx_batch_start,
+	.tx_batch_end		= ath10k_pci_hif_tx_batch_end,
 	.diag_read		= ath10k_pci_hif_diag_read,
 	.diag_write		= ath10k_pci_diag_write_mem,
 	.exchange_bmi_msg	= ath10k_pci_hif_exchange_bmi_msg,
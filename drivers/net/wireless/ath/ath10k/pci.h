@@ -219,6 +219,8 @@ u32 ath10k_pci_reg_read32(struct ath10k *ar, u32 addr);
 
 int ath10k_pci_hif_tx_sg(struct ath10k *ar, u8 pipe_id,
 			 struct ath10k_hif_sg_item *items, int n_items);
+void ath10k_pci_hif_tx_batch_start(struct ath10k *ar, u8 pipe_id);
+void ath10k_pci_hif_tx_batch_end(struct ath10k *ar, u8 pipe_id);
 int ath10k_pci_hif_diag_read(struct ath10k *ar, u32 address, void *buf,
 			     size_t buf_len);
 int ath10k_pci_diag_write_mem(struct ath10k *ar, u32 address,
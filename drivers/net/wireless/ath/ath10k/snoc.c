@@ -736,6 +736,20 @@ static int ath10k_snoc_hif_tx_sg(struct ath10k *ar, u8 pipe_id,
 	return err;
 }
 
+static void ath10k_snoc_hif_tx_batch_start(struct ath10k *ar, u8 pipe_id)
+{
+	struct ath10k_snoc *ar_snoc = ath10k_snoc_priv(ar);
+
+	ath10k_ce_send_defer(ar_snoc->pipe_info[pipe_id].ce_hdl);
+}
+
+static void ath10k_snoc_hif_tx_batch_end(struct ath10k *ar, u8 pipe_id)
+{
+	struct ath10k_snoc *ar_snoc = ath10k_snoc_priv(ar);
+
+	ath10k_ce_send_flush(ar_snoc->pipe_info[pipe_id].ce_hdl);
+}
+
 static int ath10k_snoc_hif_get_target_info(struct ath10k *ar,
 					   struct bmi_target_info *target_info)
 {
@@ -1164,6 +1178,8 @@ static const struct ath10k_hif_ops ath10k_snoc_hif_ops = {
 	.power_up		= ath10k_snoc_hif_power_up,
 	.power_down		= ath10k_snoc_hif_power_down,
 	.tx_sg			= ath10k_snoc_hif_tx_sg,
+	.tx_batch_start		= ath10k_snoc_hif_tx_batch_start,
+	.tx_batch_end		= ath10k_snoc_hif_tx_batch_end,
 	.send_complete_check	= ath10k_snoc_hif_send_complete_check,
 	.get_free_queue_number	= ath10k_snoc_hif_get_free_queue_number,
 	.get_target_info	= ath10k_snoc_hif_get_target_info,
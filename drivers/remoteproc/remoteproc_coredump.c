@@ -10,6 +10,9 @@
 #include <linux/device.h>
 #include <linux/kernel.h>
 #include <linux/remoteproc.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+#include <linux/zstd.h>
 #include "remoteproc_internal.h"
 #include "remoteproc_elf_helpers.h"
 
@@ -219,6 +222,197 @@ static ssize_t rproc_coredump_read(char *buffer, loff_t offset, size_t count,
 	return count - bytes_left;
 }
 
+#ifdef CONFIG_REMOTEPROC_COREDUMP_ZSTD
+
+#define RPROC_COREDUMP_ZSTD_LEVEL	1
+#define RPROC_COREDUMP_CHUNK_SZ		SZ_256K
+#define RPROC_COREDUMP_BOUNCE_SZ	SZ_64K
+
+/*
+ * Compressed dumps are kept in a list of fixed size chunks, so the output
+ * never needs to be sized for the worst case or moved while it grows.
+ */
+struct rproc_coredump_zstd {
+	void **chunks;
+	unsigned int nr_chunks;
+	size_t size;
+};
+
+static void rproc_coredump_zstd_free(void *data)
+{
+	struct rproc_coredump_zstd *dump = data;
+	unsigned int i;
+
+	for (i = 0; i < dump->nr_chunks; i++)
+		vfree(dump->chunks[i]);
+	kfree(dump->chunks);
+	kfree(dump);
+}
+
+static ssize_t rproc_coredump_zstd_read(char *buffer, loff_t offset,
+					size_t count, void *data,
+					size_t datalen)
+{
+	struct rproc_coredump_zstd *dump = data;
+	size_t copied = 0;
+	size_t chunk_off;
+	size_t len;
+
+	while (copied < count && offset < dump->size) {
+		chunk_off = offset % RPROC_COREDUMP_CHUNK_SZ;
+		len = min3(count - copied, RPROC_COREDUMP_CHUNK_SZ - chunk_off,
+			   (size_t)(dump->size - offset));
+
+		memcpy(buffer + copied,
+		       dump->chunks[offset / RPROC_COREDUMP_CHUNK_SZ] + chunk_off,
+		       len);
+
+		copied += len;
+		offset += len;
+	}
+
+	return copied;
+}
+
+/* Make sure @out has room, starting a new chunk once the current is full */
+static int rproc_coredump_zstd_out(struct rproc_coredump_zstd *dump,
+				   zstd_out_buffer *out)
+{
+	void **chunks;
+	void *chunk;
+
+	if (out->dst && out->pos < out->size)
+		return 0;
+
+	chunks = krealloc_array(dump->chunks, dump->nr_chunks + 1,
+				sizeof(*chunks), GFP_KERNEL);
+	if (!chunks)
+		return -ENOMEM;
+	dump->chunks = chunks;
+
+	chunk = vmalloc(RPROC_COREDUMP_CHUNK_SZ);
+	if (!chunk)
+		return -ENOMEM;
+	dump->chunks[dump->nr_chunks++] = chunk;
+
+	out->dst = chunk;
+	out->size = RPROC_COREDUMP_CHUNK_SZ;
+	out->pos = 0;
+
+	return 0;
+}
+
+static int rproc_coredump_zstd_feed(struct rproc_coredump_zstd *dump,
+				    zstd_cstream *cstream,
+				    zstd_out_buffer *out,
+				    const void *src, size_t len)
+{
+	zstd_in_buffer in = { .src = src, .size = len, .pos = 0 };
+	size_t ret;
+	int err;
+
+	while (in.pos < in.size) {
+		err = rproc_coredump_zstd_out(dump, out);
+		if (err)
+			return err;
+
+		ret = zstd_compress_stream(cstream, out, &in);
+		if (zstd_is_error(ret))
+			return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * Compress the ELF header and the segments, read from device memory through
+ * a small bounce buffer, into a single zstd frame. Only the compressed image
+ * is held until userspace reads it, instead of a copy of every segment.
+ */
+static void rproc_coredump_compressed(struct rproc *rproc, void *header,
+				      size_t header_sz, size_t dump_sz)
+{
+	struct rproc_dump_segment *segment;
+	struct rproc_coredump_zstd *dump;
+	zstd_out_buffer out = { };
+	zstd_parameters params;
+	zstd_cstream *cstream;
+	void *bounce = NULL;
+	void *wksp = NULL;
+	size_t wksp_size;
+	size_t offset;
+	size_t len;
+	size_t ret;
+	int err = -ENOMEM;
+
+	dump = kzalloc(sizeof(*dump), GFP_KERNEL);
+	if (!dump)
+		goto out;
+
+	params = zstd_get_params(RPROC_COREDUMP_ZSTD_LEVEL, dump_sz);
+	wksp_size = zstd_cstream_workspace_bound(&params.cParams);
+	wksp = kvmalloc(wksp_size, GFP_KERNEL);
+	bounce = kvmalloc(RPROC_COREDUMP_BOUNCE_SZ, GFP_KERNEL);
+	if (!wksp || !bounce)
+		goto out;
+
+	cstream = zstd_init_cstream(&params, dump_sz, wksp, wksp_size);
+	if (!cstream) {
+		err = -EINVAL;
+		goto out;
+	}
+
+	err = rproc_coredump_zstd_feed(dump, cstream, &out, header, header_sz);
+
+	list_for_each_entry(segment, &rproc->dump_segments, node) {
+		for (offset = 0; !err && offset < segment->size; offset += len) {
+			len = min_t(size_t, segment->size - offset,
+				    RPROC_COREDUMP_BOUNCE_SZ);
+			rproc_copy_segment(rproc, bounce, segment, offset, len);
+			err = rproc_coredump_zstd_feed(dump, cstream, &out,
+						       bounce, len);
+		}
+	}
+
+	while (!err) {
+		err = rproc_coredump_zstd_out(dump, &out);
+		if (err)
+			break;
+
+		ret = zstd_end_stream(cstream, &out);
+		if (zstd_is_error(ret))
+			err = -EIO;
+		else if (!ret)
+			break;
+	}
+
+out:
+	kvfree(bounce);
+	kvfree(wksp);
+	vfree(header);
+
+	if (err) {
+		dev_err(&rproc->dev, "failed to compress coredump: %d\n", err);
+		if (dump)
+			rproc_coredump_zstd_free(dump);
+		return;
+	}
+
+	dump->size = (dump->nr_chunks - 1) * RPROC_COREDUMP_CHUNK_SZ + out.pos;
+	dev_info(&rproc->dev, "coredump compressed from %zu to %zu bytes\n",
+		 dump_sz, dump->size);
+
+	dev_coredumpm(&rproc->dev, NULL, dump, dump->size, GFP_KERNEL,
+		      rproc_coredump_zstd_read, rproc_coredump_zstd_free);
+}
+#else
+static void rproc_coredump_compressed(struct rproc *rproc, void *header,
+				      size_t header_sz, size_t dump_sz)
+{
+	vfree(header);
+}
+#endif
+
 /**
  * rproc_coredump() - perform coredump
  * @rproc:	rproc handle
@@ -313,6 +507,11 @@ void rproc_coredump(struct rproc *rproc)
 		return;
 	}
 
+	if (dump_conf == RPROC_COREDUMP_COMPRESSED) {
+		rproc_coredump_compressed(rproc, data, data_size, offset);
+		return;
+	}
+
 	/* Initialize the dump state struct to be used by rproc_coredump_read */
 	dump_state.rproc = rproc;
 	dump_state.header = data;
@@ -360,6 +559,10 @@ void rproc_coredump_using_sections(struct rproc *rproc)
 	    dump_conf == RPROC_COREDUMP_DISABLED)
 		return;
 
+	/* Only segment based dumps are compressed, copy sections as is */
+	if (dump_conf == RPROC_COREDUMP_COMPRESSED)
+		dump_conf = RPROC_COREDUMP_ENABLED;
+
 	if (class == ELFCLASSNONE) {
 		dev_err(&rproc->dev, "Elf class is not set\n");
 		return;
@@ -36,6 +36,7 @@ static const char * const rproc_coredump_str[] = {
 	[RPROC_COREDUMP_DISABLED]	= "disabled",
 	[RPROC_COREDUMP_ENABLED]	= "enabled",
 	[RPROC_COREDUMP_INLINE]		= "inline",
+	[RPROC_COREDUMP_COMPRESSED]	= "compressed",
 };
 
 /* Expose the current coredump configuration via debugfs */
@@ -67,6 +68,9 @@ static ssize_t rproc_coredump_read(struct file *filp, char __user *userbuf,
  * inline:	The coredump will not be copied to a separate buffer and the
  *		recovery process will have to wait until data is read by
  *		userspace. But this avoid usage of extra memory.
+ *
+ * compressed:	The coredump is compressed with zstd into a separate buffer
+ *		and exposed to userspace, recovery carries on.
  */
 static ssize_t rproc_coredump_write(struct file *filp,
 				    const char __user *user_buf, size_t count,
@@ -99,6 +103,9 @@ static ssize_t rproc_coredump_write(struct file *filp,
 		rproc->dump_conf = RPROC_COREDUMP_ENABLED;
 	} else if (!strncmp(buf, "inline", count)) {
 		rproc->dump_conf = RPROC_COREDUMP_INLINE;
+	} else if (!strncmp(buf, "compressed", count) &&
+		   IS_ENABLED(CONFIG_REMOTEPROC_COREDUMP_ZSTD)) {
+		rproc->dump_conf = RPROC_COREDUMP_COMPRESSED;
 	} else {
 		dev_err(&rproc->dev, "Invalid coredump configuration\n");
 		err = -EINVAL;
@@ -74,6 +74,7 @@ static const char * const rproc_coredump_str[] = {
 	[RPROC_COREDUMP_DISABLED]	= "disabled",
 	[RPROC_COREDUMP_ENABLED]	= "enabled",
 	[RPROC_COREDUMP_INLINE]		= "inline",
+	[RPROC_COREDUMP_COMPRESSED]	= "compressed",
 };
 
 /* Expose the current coredump configuration via debugfs */
@@ -100,6 +101,9 @@ static ssize_t coredump_show(struct device *dev,
  * inline:	The coredump will not be copied to a separate buffer and the
  *		recovery process will have to wait until data is read by
  *		userspace. But this avoid usage of extra memory.
+ *
+ * compressed:	The coredump is compressed with zstd into a separate buffer
+ *		and exposed to userspace, recovery carries on.
  */
 static ssize_t coredump_store(struct device *dev,
 			      struct device_attribute *attr,
@@ -118,6 +122,9 @@ static ssize_t coredump_store(struct device *dev,
 		rproc->dump_conf = RPROC_COREDUMP_ENABLED;
 	} else if (sysfs_streq(buf, "inline")) {
 		rproc->dump_conf = RPROC_COREDUMP_INLINE;
+	} else if (sysfs_streq(buf, "compressed") &&
+		   IS_ENABLED(CONFIG_REMOTEPROC_COREDUMP_ZSTD)) {
+		rproc->dump_conf = RPROC_COREDUMP_COMPRESSED;
 	} else {
 		dev_err(&rproc->dev, "Invalid coredump configuration\n");
 		return -EINVAL;
@@ -94,6 +94,8 @@ struct glink_core_rx_intent {
  * @intentless:	flag to indicate that there is no intent
  * @tx_avail_notify: Waitqueue for pending tx tasks
  * @sent_read_notify: flag to check cmd sent or not
+ * @tx_unkicked: data was written to the tx fifo without signalling the
+ *		remote, protected by @tx_lock
  */
 struct qcom_glink {
 	struct device *dev;
@@ -120,6 +122,7 @@ struct qcom_glink {
 	bool intentless;
 	wait_queue_head_t tx_avail_notify;
 	bool sent_read_notify;
+	bool tx_unkicked;
 };
 
 enum {
@@ -317,9 +320,32 @@ static void qcom_glink_send_read_notify(struct qcom_glink *glink)
 	mbox_client_txdone(glink->mbox_chan, 0);
 }
 
-static int qcom_glink_tx(struct qcom_glink *glink,
-			 const void *hdr, size_t hlen,
-			 const void *data, size_t dlen, bool wait)
+static void __qcom_glink_tx_kick(struct qcom_glink *glink)
+{
+	mbox_send_message(glink->mbox_chan, NULL);
+	mbox_client_txdone(glink->mbox_chan, 0);
+	glink->tx_unkicked = false;
+}
+
+/* Signal the remote about data written by __qcom_glink_tx() without kick */
+static void qcom_glink_tx_kick(struct qcom_glink *glink)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&glink->tx_lock, flags);
+	if (glink->tx_unkicked)
+		__qcom_glink_tx_kick(glink);
+	spin_unlock_irqrestore(&glink->tx_lock, flags);
+}
+
+/*
+ * Write a packet to the tx fifo. Unless @kick is set the remote is not
+ * signalled, which allows a batch of packets to be written with a single
+ * doorbell; the batch must then be completed with qcom_glink_tx_kick().
+ */
+static int __qcom_glink_tx(struct qcom_glink *glink,
+			   const void *hdr, size_t hlen,
+			   const void *data, size_t dlen, bool wait, bool kick)
 {
 	unsigned int tlen = hlen + dlen;
 	unsigned long flags;
@@ -340,6 +366,10 @@ static int qcom_glink_tx(struct qcom_glink *glink,
 		if (!glink->sent_read_notify) {
 			glink->sent_read_notify = true;
 			qcom_glink_send_read_notify(glink);
+			glink->tx_unkicked = false;
+		} else if (glink->tx_unkicked) {
+			/* The remote has to drain the fifo for us to proceed */
+			__qcom_glink_tx_kick(glink);
 		}
 
 		/* Wait without holding the tx_lock */
@@ -356,8 +386,10 @@ static int qcom_glink_tx(struct qcom_glink *glink,
 
 	qcom_glink_tx_write(glink, hdr, hlen, data, dlen);
 
-	mbox_send_message(glink->mbox_chan, NULL);
-	mbox_client_txdone(glink->mbox_chan, 0);
+	if (kick)
+		__qcom_glink_tx_kick(glink);
+	else
+		glink->tx_unkicked = true;
 
 out:
 	spin_unlock_irqrestore(&glink->tx_lock, flags);
@@ -365,6 +397,13 @@ static int qcom_glink_tx(struct qcom_glink *glink,
 	return ret;
 }
 
+static int qcom_glink_tx(struct qcom_glink *glink,
+			 const void *hdr, size_t hlen,
+			 const void *data, size_t dlen, bool wait)
+{
+	return __qcom_glink_tx(glink, hdr, hlen, data, dlen, wait, true);
+}
+
 static int qcom_glink_send_version(struct qcom_glink *glink)
 {
 	struct glink_msg msg;
@@ -523,7 +562,7 @@ static void qcom_glink_rx_done_work(struct work_struct *work)
 		cmd.lcid = cid;
 		cmd.liid = iid;
 
-		qcom_glink_tx(glink, &cmd, sizeof(cmd), NULL, 0, true);
+		__qcom_glink_tx(glink, &cmd, sizeof(cmd), NULL, 0, true, false);
 		if (!reuse) {
 			kfree(intent->data);
 			kfree(intent);
@@ -531,6 +570,9 @@ static void qcom_glink_rx_done_work(struct work_struct *work)
 		spin_lock_irqsave(&channel->intent_lock, flags);
 	}
 	spin_unlock_irqrestore(&channel->intent_lock, flags);
+
+	/* Signal all the rx_done commands at once */
+	qcom_glink_tx_kick(glink);
 }
 
 static void qcom_glink_rx_done(struct qcom_glink *glink,
@@ -1344,7 +1386,9 @@ static int __qcom_glink_send(struct glink_channel *channel,
 	req.chunk_size = cpu_to_le32(chunk_size);
 	req.left_size = cpu_to_le32(left_size);
 
-	ret = qcom_glink_tx(glink, &req, sizeof(req), data, chunk_size, wait);
+	/* Signal the remote once, after the last chunk */
+	ret = __qcom_glink_tx(glink, &req, sizeof(req), data, chunk_size, wait,
+			      !left_size);
 
 	/* Mark intent available if we failed */
 	if (ret && intent) {
@@ -1365,8 +1409,8 @@ static int __qcom_glink_send(struct glink_channel *channel,
 		req.chunk_size = cpu_to_le32(chunk_size);
 		req.left_size = cpu_to_le32(left_size);
 
-		ret = qcom_glink_tx(glink, &req, sizeof(req), data,
-				    chunk_size, wait);
+		ret = __qcom_glink_tx(glink, &req, sizeof(req), data,
+				      chunk_size, wait, !left_size);
 
 		/* Mark intent available if we failed */
 		if (ret && intent) {
@@ -1374,6 +1418,11 @@ static int __qcom_glink_send(struct glink_channel *channel,
 			break;
 		}
 	}
+
+	/* Flush the chunks written before a failure */
+	if (ret)
+		qcom_glink_tx_kick(glink);
+
 	return ret;
 }
 
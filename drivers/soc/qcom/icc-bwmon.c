@@ -17,6 +17,7 @@
 #include <linux/pm_opp.h>
 #include <linux/regmap.h>
 #include <linux/sizes.h>
+#include <linux/sysfs.h>
 
 /*
  * The BWMON samples data throughput within 'sample_ms' time. With three
@@ -29,6 +30,14 @@
  * Zone 3: THRES_HIGH < byte count
  *
  * Zones 0 and 2 are not used by this driver.
+ *
+ * On every zone 1 or zone 3 interrupt the measured bandwidth selects the new
+ * OPP, whose bandwidth also sets the thresholds for the next interrupts.
+ * Only the vote is scaled up by 'io_percent', as the hardware compares the
+ * thresholds against the raw traffic.  Lowering the vote is delayed until the
+ * zone 1 interrupt has fired 'hyst_count' times in a row, while a rise of
+ * more than 'fast_ramp_percent' above the current bandwidth goes straight to
+ * the highest OPP.  All three are tunable through sysfs.
  */
 
 /* Internal sampling clock frequency */
@@ -113,6 +122,10 @@
 #define BWMON_V4_ZONE_MAX(zone)			(0x2e0 + 4 * (zone))
 #define BWMON_V5_ZONE_MAX(zone)			(0x044 + 4 * (zone))
 
+#define BWMON_DEFAULT_IO_PERCENT		100
+#define BWMON_DEFAULT_HYST_COUNT		0
+#define BWMON_DEFAULT_FAST_RAMP_PERCENT		0
+
 /* Quirks for specific BWMON types */
 #define BWMON_HAS_GLOBAL_IRQ			BIT(0)
 #define BWMON_NEEDS_FORCE_CLEAR			BIT(1)
@@ -171,6 +184,13 @@ struct icc_bwmon {
 	unsigned int min_bw_kbps;
 	unsigned int target_kbps;
 	unsigned int current_kbps;
+
+	/* Governor tunables, see the comment at the top of the file */
+	unsigned int io_percent;
+	unsigned int hyst_count;
+	unsigned int fast_ramp_percent;
+	/* Consecutive samples below the current vote */
+	unsigned int down_count;
 };
 
 /* BWMON v4 */
@@ -497,15 +517,60 @@ static irqreturn_t bwmon_intr(int irq, void *dev_id)
 	return IRQ_WAKE_THREAD;
 }
 
+/*
+ * Vote for @target_opp, or for the OPP of its bandwidth scaled up by
+ * @io_percent. The thresholds follow the raw traffic, only the vote gets the
+ * headroom.
+ */
+static void bwmon_set_vote(struct icc_bwmon *bwmon,
+			   struct dev_pm_opp *target_opp, unsigned int bw_kbps,
+			   unsigned int io_percent)
+{
+	struct dev_pm_opp *vote_opp = NULL;
+	unsigned int vote_kbps;
+
+	if (io_percent < 100) {
+		vote_kbps = mult_frac(bw_kbps, 100, io_percent);
+		vote_opp = dev_pm_opp_find_bw_ceil(bwmon->dev, &vote_kbps, 0);
+		if (IS_ERR(vote_opp) && PTR_ERR(vote_opp) == -ERANGE)
+			vote_opp = dev_pm_opp_find_bw_floor(bwmon->dev,
+							    &vote_kbps, 0);
+		if (IS_ERR(vote_opp))
+			vote_opp = NULL;
+	}
+
+	dev_pm_opp_set_opp(bwmon->dev, vote_opp ?: target_opp);
+	if (vote_opp)
+		dev_pm_opp_put(vote_opp);
+}
+
 static irqreturn_t bwmon_intr_thread(int irq, void *dev_id)
 {
 	struct icc_bwmon *bwmon = dev_id;
 	unsigned int irq_enable = 0;
 	struct dev_pm_opp *opp, *target_opp;
 	unsigned int bw_kbps, up_kbps, down_kbps;
+	unsigned int io_percent = READ_ONCE(bwmon->io_percent);
+	unsigned int fast_ramp_percent = READ_ONCE(bwmon->fast_ramp_percent);
 
 	bw_kbps = bwmon->target_kbps;
 
+	if (bw_kbps < bwmon->current_kbps &&
+	    ++bwmon->down_count <= READ_ONCE(bwmon->hyst_count)) {
+		/*
+		 * Hold the current vote; keeping the thresholds around it
+		 * makes zone 1 fire again if the bandwidth stays low.
+		 */
+		bw_kbps = bwmon->current_kbps;
+	} else {
+		bwmon->down_count = 0;
+	}
+
+	if (fast_ramp_percent && bwmon->current_kbps &&
+	    bw_kbps > bwmon->current_kbps +
+		      mult_frac(bwmon->current_kbps, fast_ramp_percent, 100))
+		bw_kbps = bwmon->max_bw_kbps;
+
 	target_opp = dev_pm_opp_find_bw_ceil(bwmon->dev, &bw_kbps, 0);
 	if (IS_ERR(target_opp) && PTR_ERR(target_opp) == -ERANGE)
 		target_opp = dev_pm_opp_find_bw_floor(bwmon->dev, &bw_kbps, 0);
@@ -539,7 +604,7 @@ static irqreturn_t bwmon_intr_thread(int irq, void *dev_id)
 	if (bwmon->target_kbps == bwmon->current_kbps)
 		goto out;
 
-	dev_pm_opp_set_opp(bwmon->dev, target_opp);
+	bwmon_set_vote(bwmon, target_opp, bwmon->target_kbps, io_percent);
 	bwmon->current_kbps = bwmon->target_kbps;
 
 out:
@@ -550,6 +615,93 @@ static irqreturn_t bwmon_intr_thread(int irq, void *dev_id)
 	return IRQ_HANDLED;
 }
 
+static ssize_t cur_kbps_show(struct device *dev, struct device_attribute *attr,
+			     char *buf)
+{
+	struct icc_bwmon *bwmon = dev_get_drvdata(dev);
+
+	return sysfs_emit(buf, "%u\n", READ_ONCE(bwmon->current_kbps));
+}
+static DEVICE_ATTR_RO(cur_kbps);
+
+#define BWMON_TUNABLE_SHOW(_name)					\
+static ssize_t _name##_show(struct device *dev,				\
+			    struct device_attribute *attr, char *buf)	\
+{									\
+	struct icc_bwmon *bwmon = dev_get_drvdata(dev);			\
+									\
+	return sysfs_emit(buf, "%u\n", READ_ONCE(bwmon->_name));	\
+}
+
+#define BWMON_TUNABLE_ATTR(_name, _min, _max)				\
+BWMON_TUNABLE_SHOW(_name)						\
+static ssize_t _name##_store(struct device *dev,			\
+			     struct device_attribute *attr,		\
+			     const char *buf, size_t count)		\
+{									\
+	struct icc_bwmon *bwmon = dev_get_drvdata(dev);			\
+	unsigned int val;						\
+	int ret;							\
+									\
+	ret = kstrtouint(buf, 0, &val);					\
+	if (ret)							\
+		return ret;						\
+	if (val < (_min) || val > (_max))				\
+		return -EINVAL;						\
+									\
+	WRITE_ONCE(bwmon->_name, val);					\
+	return count;							\
+}									\
+static DEVICE_ATTR_RW(_name)
+
+BWMON_TUNABLE_SHOW(io_percent)
+
+/* The new headroom applies to the current vote right away */
+static ssize_t io_percent_store(struct device *dev,
+				struct device_attribute *attr,
+				const char *buf, size_t count)
+{
+	struct icc_bwmon *bwmon = dev_get_drvdata(dev);
+	struct dev_pm_opp *opp;
+	unsigned int val, bw_kbps;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+	if (val < 1 || val > 100)
+		return -EINVAL;
+
+	/* Keep the interrupt thread from voting at the same time */
+	disable_irq(bwmon->irq);
+	WRITE_ONCE(bwmon->io_percent, val);
+
+	bw_kbps = bwmon->current_kbps;
+	if (bw_kbps) {
+		opp = dev_pm_opp_find_bw_ceil(bwmon->dev, &bw_kbps, 0);
+		if (!IS_ERR(opp)) {
+			bwmon_set_vote(bwmon, opp, bwmon->current_kbps, val);
+			dev_pm_opp_put(opp);
+		}
+	}
+	enable_irq(bwmon->irq);
+
+	return count;
+}
+static DEVICE_ATTR_RW(io_percent);
+
+BWMON_TUNABLE_ATTR(hyst_count, 0, 64);
+BWMON_TUNABLE_ATTR(fast_ramp_percent, 0, 1000);
+
+static struct attribute *bwmon_attrs[] = {
+	&dev_attr_cur_kbps.attr,
+	&dev_attr_io_percent.attr,
+	&dev_attr_hyst_count.attr,
+	&dev_attr_fast_ramp_percent.attr,
+	NULL
+};
+ATTRIBUTE_GROUPS(bwmon);
+
 static int bwmon_init_regmap(struct platform_device *pdev,
 			     struct icc_bwmon *bwmon)
 {
@@ -611,6 +763,9 @@ static int bwmon_probe(struct platform_device *pdev)
 		return dev_err_probe(dev, ret, "failed to find min peak bandwidth\n");
 
 	bwmon->dev = dev;
+	bwmon->io_percent = BWMON_DEFAULT_IO_PERCENT;
+	bwmon->hyst_count = BWMON_DEFAULT_HYST_COUNT;
+	bwmon->fast_ramp_percent = BWMON_DEFAULT_FAST_RAMP_PERCENT;
 
 	bwmon_disable(bwmon);
 	ret = devm_request_threaded_irq(dev, bwmon->irq, bwmon_intr,
@@ -693,6 +848,7 @@ static struct platform_driver bwmon_driver = {
 	.driver = {
 		.name = "qcom-bwmon",
 		.of_match_table = bwmon_of_match,
+		.dev_groups = bwmon_groups,
 	},
 };
 module_platform_driver(bwmon_driver);
@@ -7,16 +7,30 @@
  * Copyright (c) 2012-2013, The Linux Foundation. All rights reserved.
  */
 
+#include <linux/async.h>
 #include <linux/device.h>
 #include <linux/elf.h>
 #include <linux/firmware.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
 #include <linux/qcom_scm.h>
 #include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/soc/qcom/mdt_loader.h>
 
+#define CREATE_TRACE_POINTS
+#include "trace-mdt-loader.h"
+
+struct mdt_segment_load {
+	struct device *dev;
+	const struct elf32_phdr *phdrs;
+	const char *fw_name;
+	void *ptr;
+	unsigned int segment;
+	int *err;
+};
+
 static bool mdt_phdr_valid(const struct elf32_phdr *phdr)
 {
 	if (phdr->p_type != PT_LOAD)
@@ -69,6 +83,54 @@ static ssize_t mdt_load_split_segment(void *ptr, const struct elf32_phdr *phdrs,
 	return ret;
 }
 
+static void mdt_load_segment_async(void *data, async_cookie_t cookie)
+{
+	struct mdt_segment_load *load = data;
+	const struct elf32_phdr *phdr = &load->phdrs[load->segment];
+	ktime_t start = ktime_get();
+	ssize_t ret;
+
+	ret = mdt_load_split_segment(load->ptr, load->phdrs, load->segment,
+				     load->fw_name, load->dev);
+	if (ret)
+		cmpxchg(load->err, 0, (int)ret);
+
+	trace_qcom_mdt_segment(load->fw_name, load->segment, phdr->p_filesz,
+			       true, ktime_to_ns(ktime_sub(ktime_get(), start)));
+	kfree(load);
+}
+
+/*
+ * Split-out segments are read from the filesystem straight into the carveout,
+ * so reading them one after the other makes firmware boot time the sum of all
+ * the reads. Issue them concurrently instead; the caller waits for the domain
+ * before looking at the result.
+ */
+static int mdt_load_split_segment_async(void *ptr,
+					const struct elf32_phdr *phdrs,
+					unsigned int segment,
+					const char *fw_name,
+					struct device *dev,
+					struct async_domain *domain, int *err)
+{
+	struct mdt_segment_load *load;
+
+	load = kzalloc(sizeof(*load), GFP_KERNEL);
+	if (!load)
+		return mdt_load_split_segment(ptr, phdrs, segment, fw_name, dev);
+
+	load->dev = dev;
+	load->phdrs = phdrs;
+	load->fw_name = fw_name;
+	load->ptr = ptr;
+	load->segment = segment;
+	load->err = err;
+
+	async_schedule_domain(mdt_load_segment_async, load, domain);
+
+	return 0;
+}
+
 /**
  * qcom_mdt_get_size() - acquire size of the memory region needed to load mdt
  * @fw:		firmware object for the mdt file
@@ -268,8 +330,12 @@ static int __qcom_mdt_load(struct device *dev, const struct firmware *fw,
 	const struct elf32_hdr *ehdr;
 	phys_addr_t mem_reloc;
 	phys_addr_t min_addr = PHYS_ADDR_MAX;
+	ASYNC_DOMAIN_EXCLUSIVE(domain);
+	unsigned int segments = 0;
+	ktime_t start, seg_start;
 	ssize_t offset;
 	bool relocate = false;
+	int async_err = 0;
 	void *ptr;
 	int ret = 0;
 	int i;
@@ -277,6 +343,8 @@ static int __qcom_mdt_load(struct device *dev, const struct firmware *fw,
 	if (!fw || !mem_region || !mem_phys || !mem_size)
 		return -EINVAL;
 
+	start = ktime_get();
+
 	ehdr = (struct elf32_hdr *)fw->data;
 	phdrs = (struct elf32_phdr *)(ehdr + 1);
 
@@ -329,6 +397,7 @@ static int __qcom_mdt_load(struct device *dev, const struct firmware *fw,
 		}
 
 		ptr = mem_region + offset;
+		segments++;
 
 		if (phdr->p_filesz && phdr->p_offset < fw->size &&
 		    phdr->p_offset + phdr->p_filesz <= fw->size) {
@@ -340,10 +409,15 @@ static int __qcom_mdt_load(struct device *dev, const struct firmware *fw,
 				break;
 			}
 
+			seg_start = ktime_get();
 			memcpy(ptr, fw->data + phdr->p_offset, phdr->p_filesz);
+			trace_qcom_mdt_segment(fw_name, i, phdr->p_filesz, false,
+					       ktime_to_ns(ktime_sub(ktime_get(), seg_start)));
 		} else if (phdr->p_filesz) {
 			/* Firmware not large enough, load split-out segments */
-			ret = mdt_load_split_segment(ptr, phdrs, i, fw_name, dev);
+			ret = mdt_load_split_segment_async(ptr, phdrs, i, fw_name,
+							   dev, &domain,
+							   &async_err);
 			if (ret)
 				break;
 		}
@@ -352,9 +426,16 @@ static int __qcom_mdt_load(struct device *dev, const struct firmware *fw,
 			memset(ptr + phdr->p_filesz, 0, phdr->p_memsz - phdr->p_filesz);
 	}
 
+	async_synchronize_full_domain(&domain);
+	if (!ret)
+		ret = async_err;
+
 	if (reloc_base)
 		*reloc_base = mem_reloc;
 
+	trace_qcom_mdt_load(fw_name, segments,
+			    ktime_to_ns(ktime_sub(ktime_get(), start)), ret);
+
 	return ret;
 }
 
@@ -166,16 +166,66 @@ static int qmi_calc_min_msg_len(const struct qmi_elem_info *ei_array,
 static int qmi_encode_basic_elem(void *buf_dst, const void *buf_src,
 				 u32 elem_len, u32 elem_size)
 {
-	u32 i, rc = 0;
+	u32 rc = elem_len * elem_size;
 
-	for (i = 0; i < elem_len; i++) {
-		QMI_ENCDEC_ENCODE_N_BYTES(buf_dst, buf_src, elem_size);
-		rc += elem_size;
-	}
+	/* The elements are contiguous, so encode them in one go */
+	QMI_ENCDEC_ENCODE_N_BYTES(buf_dst, buf_src, rc);
 
 	return rc;
 }
 
+/**
+ * qmi_packed_struct_size() - Check if a struct is encoded as a plain copy
+ * @ei_array: Struct info array describing the struct element.
+ *
+ * Nested structures carry no TLV headers, so a structure made only of
+ * fixed size elements (or nested structures thereof) without padding has
+ * the same layout in the C structure and on the wire.  Arrays of such
+ * structures can then be encoded and decoded with a single copy instead
+ * of interpreting @ei_array->ei_array once per array element.
+ *
+ * Return: The size of the struct if it is packed, 0 otherwise.
+ */
+static u32 qmi_packed_struct_size(const struct qmi_elem_info *ei_array)
+{
+	const struct qmi_elem_info *temp_ei = ei_array->ei_array;
+	u32 size = 0, elem_size;
+
+	if (!temp_ei)
+		return 0;
+
+	for (; temp_ei->data_type != QMI_EOTI; temp_ei++) {
+		if (temp_ei->array_type == NO_ARRAY)
+			elem_size = temp_ei->elem_size;
+		else if (temp_ei->array_type == STATIC_ARRAY)
+			elem_size = temp_ei->elem_len * temp_ei->elem_size;
+		else
+			return 0;
+
+		switch (temp_ei->data_type) {
+		case QMI_UNSIGNED_1_BYTE:
+		case QMI_UNSIGNED_2_BYTE:
+		case QMI_UNSIGNED_4_BYTE:
+		case QMI_UNSIGNED_8_BYTE:
+		case QMI_SIGNED_2_BYTE_ENUM:
+		case QMI_SIGNED_4_BYTE_ENUM:
+			break;
+		case QMI_STRUCT:
+			if (qmi_packed_struct_size(temp_ei) != temp_ei->elem_size)
+				return 0;
+			break;
+		default:
+			return 0;
+		}
+
+		if (temp_ei->offset != size)
+			return 0;
+		size += elem_size;
+	}
+
+	return size == ei_array->elem_size ? size : 0;
+}
+
 /**
  * qmi_encode_struct_elem() - Encodes elements of struct data type
  * @ei_array: Struct info array descibing the struct element.
@@ -201,6 +251,17 @@ static int qmi_encode_struct_elem(const struct qmi_elem_info *ei_array,
 {
 	int i, rc, encoded_bytes = 0;
 	const struct qmi_elem_info *temp_ei = ei_array;
+	u32 size = qmi_packed_struct_size(temp_ei);
+
+	if (size) {
+		/* Check to avoid out of range buffer access */
+		if ((elem_len * size) + TLV_LEN_SIZE + TLV_TYPE_SIZE >
+		    out_buf_len) {
+			pr_err("%s: Too Small Buffer @STRUCT\n", __func__);
+			return -ETOOSMALL;
+		}
+		return qmi_encode_basic_elem(buf_dst, buf_src, elem_len, size);
+	}
 
 	for (i = 0; i < elem_len; i++) {
 		rc = qmi_encode(temp_ei->ei_array, buf_dst, buf_src,
@@ -439,12 +500,10 @@ static int qmi_encode(const struct qmi_elem_info *ei_array, void *out_buf,
 static int qmi_decode_basic_elem(void *buf_dst, const void *buf_src,
 				 u32 elem_len, u32 elem_size)
 {
-	u32 i, rc = 0;
+	u32 rc = elem_len * elem_size;
 
-	for (i = 0; i < elem_len; i++) {
-		QMI_ENCDEC_DECODE_N_BYTES(buf_dst, buf_src, elem_size);
-		rc += elem_size;
-	}
+	/* The elements are contiguous, so decode them in one go */
+	QMI_ENCDEC_DECODE_N_BYTES(buf_dst, buf_src, rc);
 
 	return rc;
 }
@@ -475,6 +534,15 @@ static int qmi_decode_struct_elem(const struct qmi_elem_info *ei_array,
 {
 	int i, rc, decoded_bytes = 0;
 	const struct qmi_elem_info *temp_ei = ei_array;
+	u32 size = qmi_packed_struct_size(temp_ei);
+
+	/* Plain copy when all elements are present, see qmi_packed_struct_size() */
+	if (size && (u64)elem_len * size <= tlv_len) {
+		decoded_bytes = qmi_decode_basic_elem(buf_dst, buf_src,
+						      elem_len, size);
+		i = elem_len;
+		goto out;
+	}
 
 	for (i = 0; i < elem_len && decoded_bytes < tlv_len; i++) {
 		rc = qmi_decode(temp_ei->ei_array, buf_dst, buf_src,
@@ -486,6 +554,7 @@ static int qmi_decode_struct_elem(const struct qmi_elem_info *ei_array,
 		decoded_bytes += rc;
 	}
 
+out:
 	if ((dec_level <= 2 && decoded_bytes != tlv_len) ||
 	    (dec_level > 2 && (i < elem_len || decoded_bytes > tlv_len))) {
 		pr_err("%s: Fault in decoding: dl(%d), db(%d), tl(%d), i(%d), el(%d)\n",
@@ -16,6 +16,17 @@
 #define MAX_TCS_PER_TYPE		3
 #define MAX_TCS_NR			(MAX_TCS_PER_TYPE * TCS_TYPE_NR)
 #define MAX_TCS_SLOTS			(MAX_CMDS_PER_TCS * MAX_TCS_PER_TYPE)
+#define RSC_WAIT_HIST_NR		12
+
+/*
+ * Priority classes for ACTIVE_ONLY transfers.  While a latency critical
+ * vote waits for a TCS, bulk votes may not claim one.
+ */
+enum rsc_prio {
+	RSC_PRIO_BULK,
+	RSC_PRIO_CRITICAL,
+	RSC_PRIO_NR,
+};
 
 struct rsc_drv;
 
@@ -86,6 +97,22 @@ struct rpmh_ctrlr {
 	struct list_head batch_cache;
 };
 
+/**
+ * struct rsc_wait_stats: time spent waiting for a free active TCS
+ *
+ * @count:    Number of ACTIVE_ONLY transfers.
+ * @total_ns: Total wait time.
+ * @max_ns:   Longest wait.
+ * @hist:     log2 histogram of the wait time in microseconds; the last
+ *            bucket collects everything above.
+ */
+struct rsc_wait_stats {
+	u64 count;
+	u64 total_ns;
+	u64 max_ns;
+	u32 hist[RSC_WAIT_HIST_NR];
+};
+
 /**
  * struct rsc_drv: the Direct Resource Voter (DRV) of the
  * Resource State Coordinator controller (RSC)
@@ -109,6 +136,10 @@ struct rpmh_ctrlr {
  *                      cache_lock.
  * @tcs_wait:           Wait queue used to wait for @tcs_in_use to free up a
  *                      slot
+ * @wait_stats:         Per priority class TCS wait statistics, protected
+ *                      by @lock.
+ * @critical_waiters:   Number of RSC_PRIO_CRITICAL transfers waiting for a
+ *                      free tcs, protected by @lock.
  * @client:             Handle to the DRV's client.
  */
 struct rsc_drv {
@@ -122,6 +153,8 @@ struct rsc_drv {
 	DECLARE_BITMAP(tcs_in_use, MAX_TCS_NR);
 	spinlock_t lock;
 	wait_queue_head_t tcs_wait;
+	struct rsc_wait_stats wait_stats[RSC_PRIO_NR];
+	unsigned int critical_waiters;
 	struct rpmh_ctrlr client;
 };
 
@@ -7,12 +7,15 @@
 
 #include <linux/atomic.h>
 #include <linux/cpu_pm.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
 #include <linux/iopoll.h>
 #include <linux/kernel.h>
+#include <linux/ktime.h>
 #include <linux/list.h>
+#include <linux/log2.h>
 #include <linux/module.h>
 #include <linux/of.h>
 #include <linux/of_irq.h>
@@ -31,6 +34,9 @@
 #define CREATE_TRACE_POINTS
 #include "trace-rpmh.h"
 
+/* Resource type encoded in a cmd-db address, see cmd_db_read_slave_id() */
+#define RSC_SLAVE_ID(addr)		(((addr) >> 16) & 0x7)
+
 #define RSC_DRV_TCS_OFFSET		672
 #define RSC_DRV_CMD_OFFSET		20
 
@@ -528,21 +534,50 @@ static int check_for_req_inflight(struct rsc_drv *drv, struct tcs_group *tcs,
 	return 0;
 }
 
+/**
+ * get_msg_prio() - Get the priority class of an active-only message.
+ * @msg: The message we want to send.
+ *
+ * Bandwidth (BCM) votes gate display and interconnect scaling and must not
+ * queue behind regulator (VRM) or power domain (ARC) votes, which may have
+ * to wait for a slow ramp to complete.
+ *
+ * Return: RSC_PRIO_CRITICAL if @msg carries a BCM vote, else RSC_PRIO_BULK.
+ */
+static enum rsc_prio get_msg_prio(const struct tcs_request *msg)
+{
+	int i;
+
+	for (i = 0; i < msg->num_cmds; i++)
+		if (RSC_SLAVE_ID(msg->cmds[i].addr) == CMD_DB_HW_BCM)
+			return RSC_PRIO_CRITICAL;
+
+	return RSC_PRIO_BULK;
+}
+
 /**
  * find_free_tcs() - Find free tcs in the given tcs_group; only for active.
  * @tcs: A pointer to the active-only tcs_group (or the wake tcs_group if
  *       we borrowed it because there are zero active-only ones).
+ * @prio: The priority class of the message.
+ *
+ * Every tcs is available to every message, but while a RSC_PRIO_CRITICAL
+ * message is waiting the next free tcs goes to it rather than to bulk
+ * messages.
  *
  * Must be called with the drv->lock held since that protects tcs_in_use.
  *
  * Return: The first tcs that's free or -EBUSY if all in use.
  */
-static int find_free_tcs(struct tcs_group *tcs)
+static int find_free_tcs(struct tcs_group *tcs, enum rsc_prio prio)
 {
 	const struct rsc_drv *drv = tcs->drv;
 	unsigned long i;
 	unsigned long max = tcs->offset + tcs->num_tcs;
 
+	if (prio != RSC_PRIO_CRITICAL && drv->critical_waiters)
+		return -EBUSY;
+
 	i = find_next_zero_bit(drv->tcs_in_use, max, tcs->offset);
 	if (i >= max)
 		return -EBUSY;
@@ -555,6 +590,7 @@ static int find_free_tcs(struct tcs_group *tcs)
  * @drv: The controller.
  * @tcs: The tcs_group used for ACTIVE_ONLY transfers.
  * @msg: The data to be sent.
+ * @prio: The priority class of @msg.
  *
  * Claims a tcs in the given tcs_group while making sure that no existing cmd
  * is in flight that would conflict with the one in @msg.
@@ -566,7 +602,7 @@ static int find_free_tcs(struct tcs_group *tcs)
  * or the tcs_group is full.
  */
 static int claim_tcs_for_req(struct rsc_drv *drv, struct tcs_group *tcs,
-			     const struct tcs_request *msg)
+			     const struct tcs_request *msg, enum rsc_prio prio)
 {
 	int ret;
 
@@ -578,7 +614,29 @@ static int claim_tcs_for_req(struct rsc_drv *drv, struct tcs_group *tcs,
 	if (ret)
 		return ret;
 
-	return find_free_tcs(tcs);
+	return find_free_tcs(tcs, prio);
+}
+
+/**
+ * account_tcs_wait() - Record the time a message waited for a free tcs.
+ * @drv: The controller.
+ * @prio: The priority class of the message.
+ * @start: When the message started waiting.
+ *
+ * Context: Must be called with the drv->lock held.
+ */
+static void account_tcs_wait(struct rsc_drv *drv, enum rsc_prio prio,
+			     ktime_t start)
+{
+	struct rsc_wait_stats *stats = &drv->wait_stats[prio];
+	u64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	u64 us = div_u64(ns, NSEC_PER_USEC);
+	int bucket = us ? ilog2(us) + 1 : 0;
+
+	stats->count++;
+	stats->total_ns += ns;
+	stats->max_ns = max(stats->max_ns, ns);
+	stats->hist[min(bucket, RSC_WAIT_HIST_NR - 1)]++;
 }
 
 /**
@@ -606,6 +664,8 @@ static int claim_tcs_for_req(struct rsc_drv *drv, struct tcs_group *tcs,
 int rpmh_rsc_send_data(struct rsc_drv *drv, const struct tcs_request *msg)
 {
 	struct tcs_group *tcs;
+	enum rsc_prio prio;
+	ktime_t start;
 	int tcs_id;
 	unsigned long flags;
 
@@ -613,13 +673,25 @@ int rpmh_rsc_send_data(struct rsc_drv *drv, const struct tcs_request *msg)
 	if (IS_ERR(tcs))
 		return PTR_ERR(tcs);
 
+	prio = get_msg_prio(msg);
+	start = ktime_get();
+
 	spin_lock_irqsave(&drv->lock, flags);
 
+	if (prio == RSC_PRIO_CRITICAL)
+		drv->critical_waiters++;
+
 	/* Wait forever for a free tcs. It better be there eventually! */
 	wait_event_lock_irq(drv->tcs_wait,
-			    (tcs_id = claim_tcs_for_req(drv, tcs, msg)) >= 0,
+			    (tcs_id = claim_tcs_for_req(drv, tcs, msg, prio)) >= 0,
 			    drv->lock);
 
+	/* Let bulk messages have a go at any tcs that is still free */
+	if (prio == RSC_PRIO_CRITICAL && !--drv->critical_waiters)
+		wake_up(&drv->tcs_wait);
+
+	account_tcs_wait(drv, prio, start);
+
 	tcs->req[tcs_id - tcs->offset] = msg;
 	set_bit(tcs_id, drv->tcs_in_use);
 	if (msg->state == RPMH_ACTIVE_ONLY_STATE && tcs->type != ACTIVE_TCS) {
@@ -906,6 +978,42 @@ static int rpmh_probe_tcs_config(struct platform_device *pdev,
 	return 0;
 }
 
+static struct dentry *rpmh_rsc_debugfs;
+
+static int rpmh_rsc_wait_stats_show(struct seq_file *s, void *unused)
+{
+	static const char * const prio_names[RSC_PRIO_NR] = {
+		[RSC_PRIO_BULK] = "bulk",
+		[RSC_PRIO_CRITICAL] = "critical",
+	};
+	struct rsc_drv *drv = s->private;
+	struct rsc_wait_stats stats[RSC_PRIO_NR];
+	unsigned long flags;
+	int i, j;
+
+	spin_lock_irqsave(&drv->lock, flags);
+	memcpy(stats, drv->wait_stats, sizeof(stats));
+	spin_unlock_irqrestore(&drv->lock, flags);
+
+	for (i = 0; i < RSC_PRIO_NR; i++) {
+		seq_printf(s, "%s: count %llu total_ns %llu max_ns %llu\n",
+			   prio_names[i], stats[i].count, stats[i].total_ns,
+			   stats[i].max_ns);
+		for (j = 0; j < RSC_WAIT_HIST_NR; j++) {
+			if (j == RSC_WAIT_HIST_NR - 1)
+				seq_printf(s, "  >= %6uus", 1U << (j - 1));
+			else if (j)
+				seq_printf(s, "   < %6uus", 1U << j);
+			else
+				seq_printf(s, "   < %6uus", 1U);
+			seq_printf(s, " %u\n", stats[i].hist[j]);
+		}
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(rpmh_rsc_wait_stats);
+
 static int rpmh_rsc_probe(struct platform_device *pdev)
 {
 	struct device_node *dn = pdev->dev.of_node;
@@ -985,6 +1093,9 @@ static int rpmh_rsc_probe(struct platform_device *pdev)
 
 	dev_set_drvdata(&pdev->dev, drv);
 
+	debugfs_create_file(drv->name, 0400, rpmh_rsc_debugfs, drv,
+			    &rpmh_rsc_wait_stats_fops);
+
 	return devm_of_platform_populate(&pdev->dev);
 }
 
@@ -1005,6 +1116,8 @@ static struct platform_driver rpmh_driver = {
 
 static int __init rpmh_driver_init(void)
 {
+	rpmh_rsc_debugfs = debugfs_create_dir("rpmh-rsc", NULL);
+
 	return platform_driver_register(&rpmh_driver);
 }
 arch_initcall(rpmh_driver_init);
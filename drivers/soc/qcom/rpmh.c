@@ -21,6 +21,7 @@
 #include <soc/qcom/rpmh.h>
 
 #include "rpmh-internal.h"
+#include "trace-rpmh.h"
 
 #define RPMH_TIMEOUT_MS			msecs_to_jiffies(10000)
 
@@ -46,12 +47,14 @@
  * @addr: the address of the resource
  * @sleep_val: the sleep vote
  * @wake_val: the wake vote
+ * @active_val: the last active vote sent, UINT_MAX if unknown
  * @list: linked list obj
  */
 struct cache_req {
 	u32 addr;
 	u32 sleep_val;
 	u32 wake_val;
+	u32 active_val;
 	struct list_head list;
 };
 
@@ -76,6 +79,25 @@ static struct rpmh_ctrlr *get_rpmh_ctrlr(const struct device *dev)
 	return &drv->client;
 }
 
+static struct cache_req *__find_req(struct rpmh_ctrlr *ctrlr, u32 addr);
+
+/* Forget the last active votes for the resources in @msg, see __rpmh_write() */
+static void forget_active_votes(struct rpmh_ctrlr *ctrlr,
+				const struct tcs_request *msg)
+{
+	struct cache_req *req;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&ctrlr->cache_lock, flags);
+	for (i = 0; i < msg->num_cmds; i++) {
+		req = __find_req(ctrlr, msg->cmds[i].addr);
+		if (req)
+			req->active_val = UINT_MAX;
+	}
+	spin_unlock_irqrestore(&ctrlr->cache_lock, flags);
+}
+
 void rpmh_tx_done(const struct tcs_request *msg, int r)
 {
 	struct rpmh_request *rpm_msg = container_of(msg, struct rpmh_request,
@@ -85,9 +107,12 @@ void rpmh_tx_done(const struct tcs_request *msg, int r)
 
 	rpm_msg->err = r;
 
-	if (r)
+	if (r) {
 		dev_err(rpm_msg->dev, "RPMH TX fail in msg addr=%#x, err=%d\n",
 			rpm_msg->msg.cmds[0].addr, r);
+		if (rpm_msg->dev && msg->state == RPMH_ACTIVE_ONLY_STATE)
+			forget_active_votes(get_rpmh_ctrlr(rpm_msg->dev), msg);
+	}
 
 	if (!compl)
 		goto exit;
@@ -116,7 +141,7 @@ static struct cache_req *__find_req(struct rpmh_ctrlr *ctrlr, u32 addr)
 
 static struct cache_req *cache_rpm_request(struct rpmh_ctrlr *ctrlr,
 					   enum rpmh_state state,
-					   struct tcs_cmd *cmd)
+					   struct tcs_cmd *cmd, bool *changed)
 {
 	struct cache_req *req;
 	unsigned long flags;
@@ -134,7 +159,7 @@ static struct cache_req *cache_rpm_request(struct rpmh_ctrlr *ctrlr,
 	}
 
 	req->addr = cmd->addr;
-	req->sleep_val = req->wake_val = UINT_MAX;
+	req->sleep_val = req->wake_val = req->active_val = UINT_MAX;
 	list_add_tail(&req->list, &ctrlr->cache);
 
 existing:
@@ -143,7 +168,13 @@ static struct cache_req *cache_rpm_request(struct rpmh_ctrlr *ctrlr,
 
 	switch (state) {
 	case RPMH_ACTIVE_ONLY_STATE:
+		*changed |= req->active_val != cmd->data;
+		req->active_val = cmd->data;
+		req->wake_val = cmd->data;
+		break;
 	case RPMH_WAKE_ONLY_STATE:
+		/* The resource returns to this value on wakeup: */
+		req->active_val = UINT_MAX;
 		req->wake_val = cmd->data;
 		break;
 	case RPMH_SLEEP_STATE:
@@ -172,6 +203,13 @@ static struct cache_req *cache_rpm_request(struct rpmh_ctrlr *ctrlr,
  * Cache the RPMH request and send if the state is ACTIVE_ONLY.
  * SLEEP/WAKE_ONLY requests are not sent to the controller at
  * this time. Use rpmh_flush() to send them to the controller.
+ *
+ * Clients tend to re-send the same active vote, eg. on every DVFS
+ * transition for resources which didn't change level.  If every command
+ * in an ACTIVE_ONLY request matches the last active vote sent for its
+ * resource, the request is redundant and is completed without occupying
+ * a TCS.  Each resource is owned by a single client which serializes its
+ * own votes, so the last vote tracked here is the one the hardware has.
  */
 static int __rpmh_write(const struct device *dev, enum rpmh_state state,
 			struct rpmh_request *rpm_msg)
@@ -179,18 +217,26 @@ static int __rpmh_write(const struct device *dev, enum rpmh_state state,
 	struct rpmh_ctrlr *ctrlr = get_rpmh_ctrlr(dev);
 	int ret = -EINVAL;
 	struct cache_req *req;
+	bool changed = false;
 	int i;
 
 	/* Cache the request in our store and link the payload */
 	for (i = 0; i < rpm_msg->msg.num_cmds; i++) {
-		req = cache_rpm_request(ctrlr, state, &rpm_msg->msg.cmds[i]);
+		req = cache_rpm_request(ctrlr, state, &rpm_msg->msg.cmds[i],
+					&changed);
 		if (IS_ERR(req))
 			return PTR_ERR(req);
 	}
 
-	if (state == RPMH_ACTIVE_ONLY_STATE) {
+	if (state == RPMH_ACTIVE_ONLY_STATE && !changed) {
+		trace_rpmh_skip_msg(ctrlr_to_drv(ctrlr), &rpm_msg->msg);
+		rpmh_tx_done(&rpm_msg->msg, 0);
+		ret = 0;
+	} else if (state == RPMH_ACTIVE_ONLY_STATE) {
 		WARN_ON(irqs_disabled());
 		ret = rpmh_rsc_send_data(ctrlr_to_drv(ctrlr), &rpm_msg->msg);
+		if (ret)
+			forget_active_votes(ctrlr, &rpm_msg->msg);
 	} else {
 		/* Clean up our call by spoofing tx_done */
 		ret = 0;
@@ -236,6 +282,7 @@ int rpmh_write_async(const struct device *dev, enum rpmh_state state,
 	if (!rpm_msg)
 		return -ENOMEM;
 	rpm_msg->needs_free = true;
+	rpm_msg->dev = dev;
 
 	ret = __fill_rpmh_msg(rpm_msg, state, cmd, n);
 	if (ret) {
@@ -371,6 +418,9 @@ int rpmh_write_batch(const struct device *dev, enum rpmh_state state,
 	for (i = 0; i < count; i++) {
 		struct completion *compl = &compls[i];
 
+		/* Batches bypass the cache, so its last active votes are stale: */
+		forget_active_votes(ctrlr, &rpm_msgs[i].msg);
+
 		init_completion(compl);
 		rpm_msgs[i].completion = compl;
 		ret = rpmh_rsc_send_data(ctrlr_to_drv(ctrlr), &rpm_msgs[i].msg);
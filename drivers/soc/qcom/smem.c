@@ -14,6 +14,7 @@
 #include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/soc/qcom/smem.h>
+#include <linux/xarray.h>
 
 /*
  * The Qualcomm shared memory system is a allocate only heap structure that
@@ -268,6 +269,7 @@ struct smem_region {
  * @global_partition: describes for global partition when in use
  * @partitions: list of partitions of current processor/host
  * @item_count: max accepted item number
+ * @items:	index of items already looked up, see qcom_smem_get()
  * @socinfo:	platform device pointer
  * @num_regions: number of @regions
  * @regions:	list of the memory regions defining the shared memory
@@ -278,6 +280,7 @@ struct qcom_smem {
 	struct hwspinlock *hwlock;
 
 	u32 item_count;
+	struct xarray items;
 	struct platform_device *socinfo;
 	struct smem_ptable *ptable;
 	struct smem_partition global_partition;
@@ -631,6 +634,29 @@ static void *qcom_smem_get_private(struct qcom_smem *smem,
 	return ERR_PTR(-EINVAL);
 }
 
+/**
+ * struct smem_item_ref - cached location of an smem item
+ * @ptr:	pointer to the item
+ * @size:	size of the item
+ */
+struct smem_item_ref {
+	void *ptr;
+	size_t size;
+};
+
+/*
+ * Index key of @item as seen by @host; the partition used for a lookup is
+ * only determined by @host, see qcom_smem_get().
+ */
+static unsigned long qcom_smem_item_key(struct qcom_smem *smem,
+					unsigned host, unsigned item)
+{
+	if (host >= SMEM_HOST_COUNT || !smem->partitions[host].virt_base)
+		host = SMEM_HOST_COUNT;
+
+	return (unsigned long)host << 16 | item;
+}
+
 /**
  * qcom_smem_get() - resolve ptr of size of a smem item
  * @host:	the remote processor, or -1
@@ -639,11 +665,18 @@ static void *qcom_smem_get_private(struct qcom_smem *smem,
  *
  * Looks up smem item and returns pointer to it. Size of smem
  * item is returned in @size.
+ *
+ * Items are never freed or moved once allocated, so items that have been
+ * found once are kept in an index and later lookups of them neither walk
+ * the partition nor take the remote spinlock.
  */
 void *qcom_smem_get(unsigned host, unsigned item, size_t *size)
 {
 	struct smem_partition *part;
+	struct smem_item_ref *ref;
 	unsigned long flags;
+	unsigned long key;
+	size_t item_size;
 	int ret;
 	void *ptr = ERR_PTR(-EPROBE_DEFER);
 
@@ -653,6 +686,14 @@ void *qcom_smem_get(unsigned host, unsigned item, size_t *size)
 	if (WARN_ON(item >= __smem->item_count))
 		return ERR_PTR(-EINVAL);
 
+	key = qcom_smem_item_key(__smem, host, item);
+	ref = xa_load(&__smem->items, key);
+	if (ref) {
+		if (size != NULL)
+			*size = ref->size;
+		return ref->ptr;
+	}
+
 	ret = hwspin_lock_timeout_irqsave(__smem->hwlock,
 					  HWSPINLOCK_TIMEOUT,
 					  &flags);
@@ -661,18 +702,38 @@ void *qcom_smem_get(unsigned host, unsigned item, size_t *size)
 
 	if (host < SMEM_HOST_COUNT && __smem->partitions[host].virt_base) {
 		part = &__smem->partitions[host];
-		ptr = qcom_smem_get_private(__smem, part, item, size);
+		ptr = qcom_smem_get_private(__smem, part, item, &item_size);
 	} else if (__smem->global_partition.virt_base) {
 		part = &__smem->global_partition;
-		ptr = qcom_smem_get_private(__smem, part, item, size);
+		ptr = qcom_smem_get_private(__smem, part, item, &item_size);
 	} else {
-		ptr = qcom_smem_get_global(__smem, item, size);
+		ptr = qcom_smem_get_global(__smem, item, &item_size);
 	}
 
 	hwspin_unlock_irqrestore(__smem->hwlock, &flags);
 
-	return ptr;
+	if (IS_ERR(ptr))
+		return ptr;
+
+	if (size != NULL)
+		*size = item_size;
+
+	/*
+	 * Failing to index the item only costs a slow lookup next time. The
+	 * caller may have interrupts disabled, so keep their state.
+	 */
+	ref = kmalloc(sizeof(*ref), GFP_ATOMIC);
+	if (ref) {
+		ref->ptr = ptr;
+		ref->size = item_size;
+		xa_lock_irqsave(&__smem->items, flags);
+		ret = __xa_insert(&__smem->items, key, ref, GFP_ATOMIC);
+		xa_unlock_irqrestore(&__smem->items, flags);
+		if (ret)
+			kfree(ref);
+	}
 
+	return ptr;
 }
 EXPORT_SYMBOL(qcom_smem_get);
 
@@ -1054,6 +1115,7 @@ static int qcom_smem_probe(struct platform_device *pdev)
 		return -ENOMEM;
 
 	smem->dev = &pdev->dev;
+	xa_init_flags(&smem->items, XA_FLAGS_LOCK_IRQ);
 	smem->num_regions = num_regions;
 
 	rmem = of_reserved_mem_lookup(pdev->dev.of_node);
@@ -1156,9 +1218,16 @@ static int qcom_smem_probe(struct platform_device *pdev)
 
 static int qcom_smem_remove(struct platform_device *pdev)
 {
+	struct smem_item_ref *ref;
+	unsigned long key;
+
 	platform_device_unregister(__smem->socinfo);
 
 	hwspin_lock_free(__smem->hwlock);
+
+	xa_for_each(&__smem->items, key, ref)
+		kfree(ref);
+	xa_destroy(&__smem->items);
 	__smem = NULL;
 
 	return 0;
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+#if !defined(_TRACE_MDT_LOADER_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_MDT_LOADER_H
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM mdt_loader
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(qcom_mdt_segment,
+
+	TP_PROTO(const char *fw_name, unsigned int segment, size_t size,
+		 bool split, u64 duration_ns),
+
+	TP_ARGS(fw_name, segment, size, split, duration_ns),
+
+	TP_STRUCT__entry(
+			 __string(name, fw_name)
+			 __field(unsigned int, segment)
+			 __field(size_t, size)
+			 __field(bool, split)
+			 __field(u64, duration_ns)
+	),
+
+	TP_fast_assign(
+		       __assign_str(name, fw_name);
+		       __entry->segment = segment;
+		       __entry->size = size;
+		       __entry->split = split;
+		       __entry->duration_ns = duration_ns;
+	),
+
+	TP_printk("%s: segment: %u size: %zu split: %d duration: %llu ns",
+		  __get_str(name), __entry->segment, __entry->size,
+		  __entry->split, __entry->duration_ns)
+);
+
+TRACE_EVENT(qcom_mdt_load,
+
+	TP_PROTO(const char *fw_name, unsigned int segments, u64 duration_ns,
+		 int err),
+
+	TP_ARGS(fw_name, segments, duration_ns, err),
+
+	TP_STRUCT__entry(
+			 __string(name, fw_name)
+			 __field(unsigned int, segments)
+			 __field(u64, duration_ns)
+			 __field(int, err)
+	),
+
+	TP_fast_assign(
+		       __assign_str(name, fw_name);
+		       __entry->segments = segments;
+		       __entry->duration_ns = duration_ns;
+		       __entry->err = err;
+	),
+
+	TP_printk("%s: segments: %u duration: %llu ns errno: %d",
+		  __get_str(name), __entry->segments, __entry->duration_ns,
+		  __entry->err)
+);
+
+#endif /* _TRACE_MDT_LOADER_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE trace-mdt-loader
+
+#include <trace/define_trace.h>
@@ -71,6 +71,30 @@ TRACE_EVENT(rpmh_send_msg,
 		  __entry->addr, __entry->data, __entry->wait)
 );
 
+TRACE_EVENT(rpmh_skip_msg,
+
+	TP_PROTO(struct rsc_drv *d, const struct tcs_request *r),
+
+	TP_ARGS(d, r),
+
+	TP_STRUCT__entry(
+			 __string(name, d->name)
+			 __field(u32, n)
+			 __field(u32, addr)
+			 __field(u32, data)
+	),
+
+	TP_fast_assign(
+		       __assign_str(name, d->name);
+		       __entry->n = r->num_cmds;
+		       __entry->addr = r->cmds[0].addr;
+		       __entry->data = r->cmds[0].data;
+	),
+
+	TP_printk("%s: skip-msg: redundant cmd(n): %u addr: %#x data: %#x",
+		  __get_str(name), __entry->n, __entry->addr, __entry->data)
+);
+
 #endif /* _TRACE_RPMH_H */
 
 #undef TRACE_INCLUDE_PATH
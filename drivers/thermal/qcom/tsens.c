@@ -146,20 +146,14 @@ static inline int code_to_degc(u32 adc_code, const struct tsens_sensor *s)
  * Return: Temperature in milliCelsius on success, a negative errno will
  * be returned in error cases
  */
-static int tsens_hw_to_mC(const struct tsens_sensor *s, int field)
+static int tsens_code_to_mC(const struct tsens_sensor *s, u32 temp)
 {
 	struct tsens_priv *priv = s->priv;
 	u32 resolution;
-	u32 temp = 0;
-	int ret;
 
 	resolution = priv->fields[LAST_TEMP_0].msb -
 		priv->fields[LAST_TEMP_0].lsb;
 
-	ret = regmap_field_read(priv->rf[field], &temp);
-	if (ret)
-		return ret;
-
 	/* Convert temperature from ADC code to milliCelsius */
 	if (priv->feat->adc)
 		return code_to_degc(temp, s) * 1000;
@@ -168,6 +162,24 @@ static int tsens_hw_to_mC(const struct tsens_sensor *s, int field)
 	return sign_extend32(temp, resolution) * 100;
 }
 
+static int tsens_hw_to_mC(const struct tsens_sensor *s, int field)
+{
+	struct tsens_priv *priv = s->priv;
+	u32 temp = 0;
+	int ret;
+
+	ret = regmap_field_read(priv->rf[field], &temp);
+	if (ret)
+		return ret;
+
+	return tsens_code_to_mC(s, temp);
+}
+
+static inline u32 tsens_field_get(const struct reg_field *f, u32 val)
+{
+	return (val & GENMASK(f->msb, f->lsb)) >> f->lsb;
+}
+
 /**
  * tsens_mC_to_hw - Convert temperature to hardware register value
  * @s: Pointer to sensor struct
@@ -307,6 +319,86 @@ static int tsens_threshold_violated(struct tsens_priv *priv, u32 hw_id,
 	return 0;
 }
 
+/**
+ * tsens_status_violated - Decode the threshold status of a sensor
+ * @priv: Pointer to tsens controller private data
+ * @hw_id: Hardware ID aka. sensor number
+ * @status: Value of the TM_Sn_STATUS register of the sensor
+ * @d: Pointer to irq state data
+ *
+ * Same as tsens_threshold_violated() but working on a status register value
+ * read beforehand, see tsens_read_status().
+ *
+ * Return: 0 if threshold was not violated, 1 if it was violated
+ */
+static int tsens_status_violated(struct tsens_priv *priv, u32 hw_id,
+				 u32 status, struct tsens_irq_data *d)
+{
+	const struct reg_field *f = priv->fields;
+
+	d->up_viol = tsens_field_get(&f[UPPER_STATUS_0 + hw_id], status);
+	d->low_viol = tsens_field_get(&f[LOWER_STATUS_0 + hw_id], status);
+	d->crit_viol = 0;
+	if (priv->feat->crit_int)
+		d->crit_viol = tsens_field_get(&f[CRITICAL_STATUS_0 + hw_id],
+					       status);
+
+	if (d->up_viol || d->low_viol || d->crit_viol)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * From TSENS v1 on, the LAST_TEMP, VALID and threshold status fields of a
+ * sensor all live in its TM_Sn_STATUS register, and the status registers of
+ * consecutive sensors are adjacent. The state of all sensors can then be
+ * fetched with a single bulk read instead of up to five field reads each.
+ */
+static bool tsens_status_batchable(struct tsens_priv *priv)
+{
+	const struct reg_field *f = priv->fields;
+	unsigned int i, reg;
+
+	if (tsens_version(priv) < VER_1_X)
+		return false;
+
+	for (i = 0; i < priv->feat->max_sensors; i++) {
+		reg = f[LAST_TEMP_0].reg + i * 4;
+
+		if (f[LAST_TEMP_0 + i].reg != reg ||
+		    f[VALID_0 + i].reg != reg ||
+		    f[UPPER_STATUS_0 + i].reg != reg ||
+		    f[LOWER_STATUS_0 + i].reg != reg)
+			return false;
+		if (priv->feat->crit_int && f[CRITICAL_STATUS_0 + i].reg != reg)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Read the TM_Sn_STATUS registers of all sensors into priv->status.
+ * Return: true on success, false if the per-field accessors must be used.
+ */
+static bool tsens_read_status(struct tsens_priv *priv)
+{
+	int ret;
+
+	if (!priv->status)
+		return false;
+
+	ret = regmap_bulk_read(priv->tm_map, priv->fields[LAST_TEMP_0].reg,
+			       priv->status, priv->num_status);
+	if (ret) {
+		dev_dbg(priv->dev, "%s: bulk read failed: %d\n", __func__, ret);
+		return false;
+	}
+
+	return true;
+}
+
 static int tsens_read_irq_state(struct tsens_priv *priv, u32 hw_id,
 				const struct tsens_sensor *s,
 				struct tsens_irq_data *d)
@@ -462,23 +554,41 @@ static irqreturn_t tsens_irq_thread(int irq, void *data)
 	bool enable = true, disable = false;
 	unsigned long flags;
 	int temp, ret, i;
+	bool batched;
+
+	batched = tsens_read_status(priv);
 
 	for (i = 0; i < priv->num_sensors; i++) {
 		bool trigger = false;
 		const struct tsens_sensor *s = &priv->sensor[i];
+		const struct reg_field *f = priv->fields;
 		u32 hw_id = s->hw_id;
+		u32 status;
 
 		if (!s->tzd)
 			continue;
-		if (!tsens_threshold_violated(priv, hw_id, &d))
-			continue;
-		ret = get_temp_tsens_valid(s, &temp);
-		if (ret) {
-			dev_err(priv->dev, "[%u] %s: error reading sensor\n",
-				hw_id, __func__);
+
+		if (batched) {
+			status = priv->status[hw_id];
+			if (!tsens_status_violated(priv, hw_id, status, &d))
+				continue;
+		} else if (!tsens_threshold_violated(priv, hw_id, &d)) {
 			continue;
 		}
 
+		/* Only poll for a valid reading if the batched one was not */
+		if (batched && tsens_field_get(&f[VALID_0 + hw_id], status)) {
+			status = tsens_field_get(&f[LAST_TEMP_0 + hw_id], status);
+			temp = tsens_code_to_mC(s, status);
+		} else {
+			ret = get_temp_tsens_valid(s, &temp);
+			if (ret) {
+				dev_err(priv->dev, "[%u] %s: error reading sensor\n",
+					hw_id, __func__);
+				continue;
+			}
+		}
+
 		spin_lock_irqsave(&priv->ul_lock, flags);
 
 		tsens_read_irq_state(priv, hw_id, s, &d);
@@ -912,6 +1022,18 @@ int __init init_common(struct tsens_priv *priv)
 		regmap_field_write(priv->rf[CC_MON_MASK], 1);
 	}
 
+	if (tsens_status_batchable(priv)) {
+		for (i = 0; i < priv->num_sensors; i++)
+			priv->num_status = max(priv->num_status,
+					       priv->sensor[i].hw_id + 1);
+		priv->status = devm_kcalloc(dev, priv->num_status,
+					    sizeof(*priv->status), GFP_KERNEL);
+		if (!priv->status) {
+			ret = -ENOMEM;
+			goto err_put_device;
+		}
+	}
+
 	spin_lock_init(&priv->ul_lock);
 
 	/* VER_0 interrupt doesn't need to be enabled */
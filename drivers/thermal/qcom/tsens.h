@@ -549,6 +549,9 @@ struct tsens_context {
  * @feat: features of the IP
  * @fields: bitfield locations
  * @ops: pointer to list of callbacks supported by this device
+ * @status: TM_Sn_STATUS values of all sensors, read at once by the uplow
+ *          interrupt handler; NULL if the fields do not allow it
+ * @num_status: number of entries in @status
  * @debug_root: pointer to debugfs dentry for all tsens
  * @debug: pointer to debugfs dentry for tsens controller
  * @sensor: list of sensors attached to this device
@@ -569,6 +572,9 @@ struct tsens_priv {
 	const struct reg_field		*fields;
 	const struct tsens_ops		*ops;
 
+	u32				*status;
+	u32				num_status;
+
 	struct dentry			*debug_root;
 	struct dentry			*debug;
 
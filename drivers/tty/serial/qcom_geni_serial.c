@@ -6,6 +6,7 @@
 
 #include <linux/clk.h>
 #include <linux/console.h>
+#include <linux/dma-mapping.h>
 #include <linux/io.h>
 #include <linux/iopoll.h>
 #include <linux/irq.h>
@@ -85,6 +86,11 @@
 /* UART S_CMD OP codes */
 #define UART_START_READ		0x1
 #define UART_PARAM		0x1
+#define UART_PARAM_RFR_OPEN	BIT(7)
+
+/* SE_DMA_RX_IRQ_STAT UART specific fields */
+#define RX_DMA_PARITY_ERR	BIT(5)
+#define RX_DMA_BREAK		GENMASK(8, 7)
 
 #define UART_OVERSAMPLING	32
 #define STALE_TIMEOUT		16
@@ -95,6 +101,7 @@
 #define DEF_TX_WM		2
 #define DEF_FIFO_WIDTH_BITS	32
 #define UART_RX_WM		2
+#define DMA_RX_BUF_SIZE		2048
 
 /* SE_UART_LOOPBACK_CFG */
 #define RX_TX_SORTED	BIT(0)
@@ -140,6 +147,14 @@ struct qcom_geni_serial_port {
 	bool rx_tx_swap;
 	bool cts_rts_swap;
 
+	/* SE DMA mode, used on the non-console ports */
+	bool dma;
+	dma_addr_t tx_dma_addr;
+	void *rx_dma_buf[2];
+	dma_addr_t rx_dma_addr[2];
+	unsigned int rx_dma_idx;
+	bool rx_dma_mapped;
+
 	struct qcom_geni_private_data private_data;
 };
 
@@ -309,6 +324,16 @@ static void qcom_geni_serial_setup_tx(struct uart_port *uport, u32 xmit_size)
 	writel(m_cmd, uport->membase + SE_GENI_M_CMD0);
 }
 
+static bool qcom_geni_serial_main_active(struct uart_port *uport)
+{
+	return readl(uport->membase + SE_GENI_STATUS) & M_GENI_CMD_ACTIVE;
+}
+
+static bool qcom_geni_serial_secondary_active(struct uart_port *uport)
+{
+	return readl(uport->membase + SE_GENI_STATUS) & S_GENI_CMD_ACTIVE;
+}
+
 static void qcom_geni_serial_poll_tx_done(struct uart_port *uport)
 {
 	int done;
@@ -590,11 +615,211 @@ static int handle_rx_uart(struct uart_port *uport, u32 bytes, bool drop)
 	return ret;
 }
 
+static void qcom_geni_serial_start_tx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	struct circ_buf *xmit = &uport->state->xmit;
+	unsigned int xmit_size;
+	int ret;
+
+	if (port->tx_dma_addr)
+		return;
+
+	if (uart_circ_empty(xmit))
+		return;
+
+	xmit_size = CIRC_CNT_TO_END(xmit->head, xmit->tail, UART_XMIT_SIZE);
+
+	qcom_geni_serial_setup_tx(uport, xmit_size);
+
+	ret = geni_se_tx_dma_prep(&port->se, &xmit->buf[xmit->tail],
+				  xmit_size, &port->tx_dma_addr);
+	if (ret) {
+		dev_err(uport->dev, "unable to start TX SE DMA: %d\n", ret);
+		port->tx_dma_addr = 0;
+		geni_se_cancel_m_cmd(&port->se);
+		return;
+	}
+
+	port->tx_remaining = xmit_size;
+}
+
+static void qcom_geni_serial_stop_tx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+
+	if (!qcom_geni_serial_main_active(uport))
+		return;
+
+	if (port->tx_dma_addr) {
+		geni_se_tx_dma_unprep(&port->se, port->tx_dma_addr,
+				      port->tx_remaining);
+		port->tx_dma_addr = 0;
+		port->tx_remaining = 0;
+	}
+
+	geni_se_cancel_m_cmd(&port->se);
+	if (!qcom_geni_serial_poll_bit(uport, SE_GENI_M_IRQ_STATUS,
+						M_CMD_CANCEL_EN, true)) {
+		geni_se_abort_m_cmd(&port->se);
+		qcom_geni_serial_poll_bit(uport, SE_GENI_M_IRQ_STATUS,
+						M_CMD_ABORT_EN, true);
+		writel(M_CMD_ABORT_EN, uport->membase + SE_GENI_M_IRQ_CLEAR);
+	}
+	writel(M_CMD_CANCEL_EN, uport->membase + SE_GENI_M_IRQ_CLEAR);
+}
+
+static void qcom_geni_serial_handle_tx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	struct circ_buf *xmit = &uport->state->xmit;
+
+	if (!port->tx_dma_addr)
+		return;
+
+	uart_xmit_advance(uport, port->tx_remaining);
+	geni_se_tx_dma_unprep(&port->se, port->tx_dma_addr, port->tx_remaining);
+	port->tx_dma_addr = 0;
+	port->tx_remaining = 0;
+
+	if (!uart_circ_empty(xmit))
+		qcom_geni_serial_start_tx_dma(uport);
+
+	if (uart_circ_chars_pending(xmit) < WAKEUP_CHARS)
+		uart_write_wakeup(uport);
+}
+
+/*
+ * RX DMA runs on two buffers that stay mapped while the port is open. The
+ * engine completes a buffer when it fills up or when the line has been idle
+ * for the RX stale count, and the other buffer is handed to it before the
+ * received bytes are pushed to the tty layer, so reception keeps going while
+ * the CPU drains the data.
+ */
+static int qcom_geni_serial_map_rx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	struct device *dev = uport->dev->parent;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(port->rx_dma_buf); i++) {
+		port->rx_dma_addr[i] = dma_map_single(dev, port->rx_dma_buf[i],
+						      DMA_RX_BUF_SIZE,
+						      DMA_FROM_DEVICE);
+		if (dma_mapping_error(dev, port->rx_dma_addr[i]))
+			goto err_unmap;
+	}
+	port->rx_dma_mapped = true;
+
+	return 0;
+
+err_unmap:
+	while (--i >= 0)
+		dma_unmap_single(dev, port->rx_dma_addr[i], DMA_RX_BUF_SIZE,
+				 DMA_FROM_DEVICE);
+	return -EIO;
+}
+
+static void qcom_geni_serial_unmap_rx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	struct device *dev = uport->dev->parent;
+	int i;
+
+	if (!port->rx_dma_mapped)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(port->rx_dma_buf); i++)
+		dma_unmap_single(dev, port->rx_dma_addr[i], DMA_RX_BUF_SIZE,
+				 DMA_FROM_DEVICE);
+	port->rx_dma_mapped = false;
+}
+
+static void qcom_geni_serial_stop_rx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	u32 s_irq_status;
+
+	if (!qcom_geni_serial_secondary_active(uport))
+		return;
+
+	geni_se_cancel_s_cmd(&port->se);
+	qcom_geni_serial_poll_bit(uport, SE_GENI_S_IRQ_STATUS,
+					S_CMD_CANCEL_EN, true);
+
+	s_irq_status = readl(uport->membase + SE_GENI_S_IRQ_STATUS);
+	writel(s_irq_status, uport->membase + SE_GENI_S_IRQ_CLEAR);
+
+	if (qcom_geni_serial_secondary_active(uport))
+		qcom_geni_serial_abort_rx(uport);
+}
+
+static void qcom_geni_serial_start_rx_dma(struct uart_port *uport)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+
+	if (!port->rx_dma_mapped)
+		return;
+
+	if (qcom_geni_serial_secondary_active(uport))
+		qcom_geni_serial_stop_rx_dma(uport);
+
+	geni_se_setup_s_cmd(&port->se, UART_START_READ, UART_PARAM_RFR_OPEN);
+
+	port->rx_dma_idx = 0;
+	geni_se_rx_init_dma(&port->se, port->rx_dma_addr[0], DMA_RX_BUF_SIZE);
+}
+
+static void qcom_geni_serial_handle_rx_dma(struct uart_port *uport, bool drop)
+{
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+	struct tty_port *tport = &uport->state->port;
+	struct device *dev = uport->dev->parent;
+	unsigned int idx = port->rx_dma_idx;
+	u32 rx_in;
+	int ret;
+
+	if (!port->rx_dma_mapped || !qcom_geni_serial_secondary_active(uport))
+		return;
+
+	rx_in = readl(uport->membase + SE_DMA_RX_LEN_IN);
+
+	/* Keep the engine receiving while this buffer is drained */
+	port->rx_dma_idx = !idx;
+	geni_se_rx_init_dma(&port->se, port->rx_dma_addr[port->rx_dma_idx],
+			    DMA_RX_BUF_SIZE);
+
+	if (!rx_in || drop)
+		return;
+
+	rx_in = min_t(u32, rx_in, DMA_RX_BUF_SIZE);
+	dma_sync_single_for_cpu(dev, port->rx_dma_addr[idx], rx_in,
+				DMA_FROM_DEVICE);
+
+	ret = tty_insert_flip_string(tport, port->rx_dma_buf[idx], rx_in);
+	if (ret != rx_in) {
+		dev_err_ratelimited(uport->dev, "%s:Unable to push data ret %d_bytes %u\n",
+				    __func__, ret, rx_in);
+		uport->icount.buf_overrun++;
+	}
+	uport->icount.rx += ret;
+	tty_flip_buffer_push(tport);
+
+	dma_sync_single_for_device(dev, port->rx_dma_addr[idx], rx_in,
+				   DMA_FROM_DEVICE);
+}
+
 static void qcom_geni_serial_start_tx(struct uart_port *uport)
 {
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
 	u32 irq_en;
 	u32 status;
 
+	if (port->dma) {
+		qcom_geni_serial_start_tx_dma(uport);
+		return;
+	}
+
 	status = readl(uport->membase + SE_GENI_STATUS);
 	if (status & M_GENI_CMD_ACTIVE)
 		return;
@@ -615,6 +840,11 @@ static void qcom_geni_serial_stop_tx(struct uart_port *uport)
 	u32 status;
 	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
 
+	if (port->dma) {
+		qcom_geni_serial_stop_tx_dma(uport);
+		return;
+	}
+
 	irq_en = readl(uport->membase + SE_GENI_M_IRQ_EN);
 	irq_en &= ~(M_CMD_DONE_EN | M_TX_FIFO_WATERMARK_EN);
 	writel(0, uport->membase + SE_GENI_TX_WATERMARK_REG);
@@ -641,6 +871,11 @@ static void qcom_geni_serial_start_rx(struct uart_port *uport)
 	u32 status;
 	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
 
+	if (port->dma) {
+		qcom_geni_serial_start_rx_dma(uport);
+		return;
+	}
+
 	status = readl(uport->membase + SE_GENI_STATUS);
 	if (status & S_GENI_CMD_ACTIVE)
 		qcom_geni_serial_stop_rx(uport);
@@ -663,6 +898,11 @@ static void qcom_geni_serial_stop_rx(struct uart_port *uport)
 	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
 	u32 s_irq_status;
 
+	if (port->dma) {
+		qcom_geni_serial_stop_rx_dma(uport);
+		return;
+	}
+
 	irq_en = readl(uport->membase + SE_GENI_S_IRQ_EN);
 	irq_en &= ~(S_RX_FIFO_WATERMARK_EN | S_RX_FIFO_LAST_EN);
 	writel(irq_en, uport->membase + SE_GENI_S_IRQ_EN);
@@ -814,6 +1054,8 @@ static irqreturn_t qcom_geni_serial_isr(int isr, void *dev)
 	u32 m_irq_en;
 	u32 m_irq_status;
 	u32 s_irq_status;
+	u32 dma_tx_status = 0;
+	u32 dma_rx_status = 0;
 	u32 geni_status;
 	struct uart_port *uport = dev;
 	bool drop_rx = false;
@@ -832,6 +1074,13 @@ static irqreturn_t qcom_geni_serial_isr(int isr, void *dev)
 	writel(m_irq_status, uport->membase + SE_GENI_M_IRQ_CLEAR);
 	writel(s_irq_status, uport->membase + SE_GENI_S_IRQ_CLEAR);
 
+	if (port->dma) {
+		dma_tx_status = readl(uport->membase + SE_DMA_TX_IRQ_STAT);
+		dma_rx_status = readl(uport->membase + SE_DMA_RX_IRQ_STAT);
+		writel(dma_tx_status, uport->membase + SE_DMA_TX_IRQ_CLR);
+		writel(dma_rx_status, uport->membase + SE_DMA_RX_IRQ_CLR);
+	}
+
 	if (WARN_ON(m_irq_status & M_ILLEGAL_CMD_EN))
 		goto out_unlock;
 
@@ -840,6 +1089,27 @@ static irqreturn_t qcom_geni_serial_isr(int isr, void *dev)
 		tty_insert_flip_char(tport, 0, TTY_OVERRUN);
 	}
 
+	if (port->dma) {
+		if (dma_tx_status & TX_DMA_DONE)
+			qcom_geni_serial_handle_tx_dma(uport);
+
+		if (dma_rx_status & RX_RESET_DONE)
+			goto out_unlock;
+
+		if (dma_rx_status & RX_DMA_PARITY_ERR) {
+			uport->icount.parity++;
+			drop_rx = true;
+		}
+
+		if (dma_rx_status & RX_DMA_BREAK)
+			uport->icount.brk++;
+
+		if (dma_rx_status & (RX_DMA_DONE | RX_EOT))
+			qcom_geni_serial_handle_rx_dma(uport, drop_rx);
+
+		goto out_unlock;
+	}
+
 	if (m_irq_status & m_irq_en & (M_TX_FIFO_WATERMARK_EN | M_CMD_DONE_EN))
 		qcom_geni_serial_handle_tx(uport, m_irq_status & M_CMD_DONE_EN,
 					geni_status & M_GENI_CMD_ACTIVE);
@@ -879,7 +1149,15 @@ static void get_tx_fifo_size(struct qcom_geni_serial_port *port)
 
 static void qcom_geni_serial_shutdown(struct uart_port *uport)
 {
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+
 	disable_irq(uport->irq);
+
+	if (port->dma) {
+		qcom_geni_serial_stop_tx_dma(uport);
+		qcom_geni_serial_stop_rx_dma(uport);
+		qcom_geni_serial_unmap_rx_dma(uport);
+	}
 }
 
 static int qcom_geni_serial_port_setup(struct uart_port *uport)
@@ -923,7 +1201,7 @@ static int qcom_geni_serial_port_setup(struct uart_port *uport)
 	geni_se_config_packing(&port->se, BITS_PER_BYTE, BYTES_PER_FIFO_WORD,
 			       false, true, true);
 	geni_se_init(&port->se, UART_RX_WM, port->rx_fifo_depth - 2);
-	geni_se_select_mode(&port->se, GENI_SE_FIFO);
+	geni_se_select_mode(&port->se, port->dma ? GENI_SE_DMA : GENI_SE_FIFO);
 	port->setup = true;
 
 	return 0;
@@ -939,6 +1217,12 @@ static int qcom_geni_serial_startup(struct uart_port *uport)
 		if (ret)
 			return ret;
 	}
+
+	if (port->dma) {
+		ret = qcom_geni_serial_map_rx_dma(uport);
+		if (ret)
+			return ret;
+	}
 	enable_irq(uport->irq);
 
 	return 0;
@@ -1124,6 +1408,11 @@ static void qcom_geni_serial_set_termios(struct uart_port *uport,
 
 static unsigned int qcom_geni_serial_tx_empty(struct uart_port *uport)
 {
+	struct qcom_geni_serial_port *port = to_dev_port(uport, uport);
+
+	if (port->dma && port->tx_dma_addr)
+		return 0;
+
 	return !readl(uport->membase + SE_GENI_TX_FIFO_STATUS);
 }
 
@@ -1420,6 +1709,13 @@ static int qcom_geni_serial_probe(struct platform_device *pdev)
 			port->rx_fifo_depth, sizeof(u32), GFP_KERNEL);
 		if (!port->rx_fifo)
 			return -ENOMEM;
+
+		port->rx_dma_buf[0] = devm_kzalloc(uport->dev,
+				2 * DMA_RX_BUF_SIZE, GFP_KERNEL);
+		if (!port->rx_dma_buf[0])
+			return -ENOMEM;
+		port->rx_dma_buf[1] = port->rx_dma_buf[0] + DMA_RX_BUF_SIZE;
+		port->dma = true;
 	}
 
 	ret = geni_icc_get(&port->se, NULL);
@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * UFSHCI 4.0 Multi-Circular Queue (MCQ) support.
+ *
+ * In MCQ mode transfer requests are no longer issued by ringing a bit in the
+ * single UTRLDBR doorbell. Instead every hardware queue owns a submission
+ * queue (SQ) of UTRDs and a completion queue (CQ) of completion entries, and
+ * requests are issued by advancing the SQ tail pointer.
+ */
+
+#include <linux/bitfield.h>
+#include <linux/blk-mq.h>
+#include <linux/cpumask.h>
+#include <linux/dma-mapping.h>
+#include <scsi/scsi_cmnd.h>
+
+#include "ufshcd-priv.h"
+
+static u32 ufshcd_mcq_qcfg_offset(struct ufs_hba *hba)
+{
+	u32 qcfgptr = FIELD_GET(MCQCAP_QCFGPTR_MASK, hba->mcq_capabilities);
+
+	return qcfgptr * MCQCAP_QCFGPTR_UNIT;
+}
+
+static void __iomem *ufshcd_mcq_qcfg_base(struct ufs_hba *hba, int id)
+{
+	return hba->mcq_base + ufshcd_mcq_qcfg_offset(hba) + id * MCQ_QCFG_SIZE;
+}
+
+static int ufshcd_mcq_map_opr(struct ufs_hba *hba, void __iomem *qcfg,
+			      u32 reg, void __iomem **base)
+{
+	u32 offset = readl(qcfg + reg);
+
+	if (offset > hba->mcq_size || hba->mcq_size - offset < MCQ_OPR_SIZE) {
+		dev_err(hba->dev, "MCQ register offset %#x out of range\n",
+			offset);
+		return -EINVAL;
+	}
+
+	*base = hba->mcq_base + offset;
+	return 0;
+}
+
+/*
+ * The operation and runtime register blocks of each queue are described by
+ * offsets relative to the UFSHCI base address that the controller publishes
+ * in the queue configuration registers. They must lie within the region the
+ * variant driver mapped for them.
+ */
+static int ufshcd_mcq_init_regs(struct ufs_hba *hba,
+				struct ufs_hw_queue *hwq)
+{
+	void __iomem *qcfg = ufshcd_mcq_qcfg_base(hba, hwq->id);
+	int ret;
+
+	ret = ufshcd_mcq_map_opr(hba, qcfg, REG_SQDAO, &hwq->mcq_sq_head);
+	if (!ret)
+		ret = ufshcd_mcq_map_opr(hba, qcfg, REG_SQISAO,
+					 &hwq->mcq_sq_is);
+	if (!ret)
+		ret = ufshcd_mcq_map_opr(hba, qcfg, REG_CQDAO,
+					 &hwq->mcq_cq_head);
+	if (!ret)
+		ret = ufshcd_mcq_map_opr(hba, qcfg, REG_CQISAO,
+					 &hwq->mcq_cq_is);
+
+	return ret;
+}
+
+/**
+ * ufshcd_mcq_init - set up the MCQ hardware queues
+ * @hba: per adapter instance
+ *
+ * Allocates one SQ/CQ pair per possible CPU, capped by the number of queues
+ * the controller supports. Each ring holds one entry more than the number of
+ * transfer request slots so that a ring can never fill up completely.
+ *
+ * Returns 0 on success, non-zero value on failure.
+ */
+int ufshcd_mcq_init(struct ufs_hba *hba)
+{
+	struct ufs_hw_queue *hwq;
+	unsigned int nr, i;
+	size_t size;
+	int ret;
+
+	ret = ufshcd_vops_mcq_config_resource(hba);
+	if (ret)
+		return ret;
+
+	hba->mcq_capabilities = ufshcd_readl(hba, REG_MCQCAP);
+
+	/* MAXQ is a 0 based value */
+	nr = FIELD_GET(MCQCAP_MAXQ_MASK, hba->mcq_capabilities) + 1;
+	nr = min(nr, num_possible_cpus());
+
+	if (ufshcd_mcq_qcfg_offset(hba) + nr * MCQ_QCFG_SIZE > hba->mcq_size) {
+		dev_err(hba->dev, "MCQ queue configuration out of range\n");
+		return -EINVAL;
+	}
+
+	hba->uhq = devm_kcalloc(hba->dev, nr, sizeof(*hba->uhq), GFP_KERNEL);
+	if (!hba->uhq)
+		return -ENOMEM;
+
+	for (i = 0; i < nr; i++) {
+		hwq = &hba->uhq[i];
+		hwq->id = i;
+		hwq->max_entries = hba->nutrs + 1;
+		spin_lock_init(&hwq->sq_lock);
+		spin_lock_init(&hwq->cq_lock);
+
+		size = sizeof(*hwq->sqe_base_addr) * hwq->max_entries;
+		hwq->sqe_base_addr = dmam_alloc_coherent(hba->dev, size,
+							 &hwq->sqe_dma_addr,
+							 GFP_KERNEL);
+		size = sizeof(*hwq->cqe_base_addr) * hwq->max_entries;
+		hwq->cqe_base_addr = dmam_alloc_coherent(hba->dev, size,
+							 &hwq->cqe_dma_addr,
+							 GFP_KERNEL);
+		if (!hwq->sqe_base_addr || !hwq->cqe_base_addr) {
+			dev_err(hba->dev, "MCQ queue %u memory allocation failed\n",
+				i);
+			return -ENOMEM;
+		}
+
+		ret = ufshcd_mcq_init_regs(hba, hwq);
+		if (ret)
+			return ret;
+	}
+
+	hba->nr_hw_queues = nr;
+	hba->mcq_enabled = true;
+
+	dev_info(hba->dev, "MCQ enabled with %u hardware queues\n", nr);
+
+	return 0;
+}
+
+/**
+ * ufshcd_mcq_make_queues_operational - program and enable the MCQ queues
+ * @hba: per adapter instance
+ *
+ * Must be called after every host controller enable since HCE clears the
+ * queue configuration.
+ */
+void ufshcd_mcq_make_queues_operational(struct ufs_hba *hba)
+{
+	struct ufs_hw_queue *hwq;
+	void __iomem *qcfg;
+	u32 qsize, val;
+	unsigned int i;
+
+	for (i = 0; i < hba->nr_hw_queues; i++) {
+		hwq = &hba->uhq[i];
+		qcfg = ufshcd_mcq_qcfg_base(hba, i);
+		/* The queue size is a 0 based number of DWORDs */
+		qsize = hwq->max_entries * MCQ_ENTRY_SIZE_IN_DWORD - 1;
+
+		hwq->sq_tail_slot = 0;
+		hwq->cq_head_slot = 0;
+
+		writel(lower_32_bits(hwq->sqe_dma_addr), qcfg + REG_SQLBA);
+		writel(upper_32_bits(hwq->sqe_dma_addr), qcfg + REG_SQUBA);
+		writel(lower_32_bits(hwq->cqe_dma_addr), qcfg + REG_CQLBA);
+		writel(upper_32_bits(hwq->cqe_dma_addr), qcfg + REG_CQUBA);
+
+		writel(MCQ_CQIS_TEPS, hwq->mcq_cq_is + REG_CQIE);
+
+		/* Enable the CQ before the SQ that posts into it */
+		writel(MCQ_QUEUE_EN | FIELD_PREP(MCQ_QUEUE_SIZE_MASK, qsize),
+		       qcfg + REG_CQATTR);
+		writel(MCQ_QUEUE_EN | FIELD_PREP(MCQ_SQ_CQID_MASK, i) |
+		       FIELD_PREP(MCQ_QUEUE_SIZE_MASK, qsize),
+		       qcfg + REG_SQATTR);
+	}
+
+	/* MAC is a 0 based value */
+	val = ufshcd_readl(hba, REG_UFS_MCQ_CFG);
+	val &= ~MCQ_CFG_MAC_MASK;
+	val |= FIELD_PREP(MCQ_CFG_MAC_MASK, hba->nutrs - 1);
+	ufshcd_writel(hba, val, REG_UFS_MCQ_CFG);
+
+	ufshcd_writel(hba, ufshcd_readl(hba, REG_UFS_MEM_CFG) | MCQ_MODE_SELECT,
+		      REG_UFS_MEM_CFG);
+}
+
+/**
+ * ufshcd_mcq_req_to_hwq - look up the hardware queue of a block request
+ * @hba: per adapter instance
+ * @req: block layer request
+ */
+struct ufs_hw_queue *ufshcd_mcq_req_to_hwq(struct ufs_hba *hba,
+					   struct request *req)
+{
+	u32 utag = blk_mq_unique_tag(req);
+
+	return &hba->uhq[blk_mq_unique_tag_to_hwq(utag)];
+}
+
+/**
+ * ufshcd_mcq_send_command - copy a UTRD into a submission queue
+ * @hba: per adapter instance
+ * @hwq: hardware queue to submit to
+ * @lrbp: local reference block of the request
+ *
+ * The caller must have marked the request outstanding before calling this
+ * function since the completion may be reported right away.
+ */
+void ufshcd_mcq_send_command(struct ufs_hba *hba, struct ufs_hw_queue *hwq,
+			     struct ufshcd_lrb *lrbp)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&hwq->sq_lock, flags);
+	memcpy(&hwq->sqe_base_addr[hwq->sq_tail_slot], lrbp->utr_descriptor_ptr,
+	       sizeof(*lrbp->utr_descriptor_ptr));
+	if (++hwq->sq_tail_slot == hwq->max_entries)
+		hwq->sq_tail_slot = 0;
+	/* writel() orders the UTRD copy before the tail pointer update */
+	writel(hwq->sq_tail_slot * sizeof(*hwq->sqe_base_addr),
+	       hwq->mcq_sq_head + REG_SQTP);
+	spin_unlock_irqrestore(&hwq->sq_lock, flags);
+}
+
+static int ufshcd_mcq_get_tag(struct ufs_hba *hba, struct cq_entry *cqe)
+{
+	u64 addr = le64_to_cpu(cqe->command_desc_base_addr) & CQE_UCD_BA;
+
+	return div_u64(addr - hba->ucdl_dma_addr,
+		       sizeof(struct utp_transfer_cmd_desc));
+}
+
+/**
+ * ufshcd_mcq_poll_cqe - consume the posted entries of a completion queue
+ * @hba: per adapter instance
+ * @hwq: hardware queue to poll
+ *
+ * The Overall Command Status of each entry is copied into the UTRD of the
+ * request so that the regular completion path can evaluate it.
+ *
+ * Returns a bitmask of the tags that have been completed.
+ */
+unsigned long ufshcd_mcq_poll_cqe(struct ufs_hba *hba,
+				  struct ufs_hw_queue *hwq)
+{
+	unsigned long completed_reqs = 0;
+	struct ufshcd_lrb *lrbp;
+	struct cq_entry *cqe;
+	unsigned long flags;
+	u32 tail_slot;
+	int tag;
+
+	spin_lock_irqsave(&hwq->cq_lock, flags);
+	tail_slot = readl(hwq->mcq_cq_head + REG_CQTP) /
+		sizeof(*hwq->cqe_base_addr);
+	if (tail_slot == hwq->cq_head_slot)
+		goto unlock;
+
+	/* Do not read the entries before the tail pointer that covers them */
+	dma_rmb();
+
+	while (hwq->cq_head_slot != tail_slot) {
+		cqe = &hwq->cqe_base_addr[hwq->cq_head_slot];
+		tag = ufshcd_mcq_get_tag(hba, cqe);
+		if (!WARN_ON_ONCE(tag < 0 || tag >= hba->nutrs)) {
+			lrbp = &hba->lrb[tag];
+			lrbp->utr_descriptor_ptr->header.dword_2 =
+				cpu_to_le32(le32_to_cpu(cqe->status) & MASK_OCS);
+			__set_bit(tag, &completed_reqs);
+		}
+		if (++hwq->cq_head_slot == hwq->max_entries)
+			hwq->cq_head_slot = 0;
+	}
+
+	writel(hwq->cq_head_slot * sizeof(*hwq->cqe_base_addr),
+	       hwq->mcq_cq_head + REG_CQHP);
+unlock:
+	spin_unlock_irqrestore(&hwq->cq_lock, flags);
+
+	return completed_reqs;
+}
+
+/**
+ * ufshcd_mcq_read_clear_cqis - read and acknowledge CQ interrupt status
+ * @hwq: hardware queue
+ *
+ * Returns the interrupt status bits that were pending.
+ */
+u32 ufshcd_mcq_read_clear_cqis(struct ufs_hw_queue *hwq)
+{
+	u32 events = readl(hwq->mcq_cq_is + REG_CQIS);
+
+	if (events)
+		writel(events, hwq->mcq_cq_is + REG_CQIS);
+
+	return events;
+}
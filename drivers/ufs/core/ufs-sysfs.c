@@ -298,6 +298,95 @@ static ssize_t enable_wb_buf_flush_store(struct device *dev,
 	return res < 0 ? res : count;
 }
 
+/* UTRIACR counts the aggregation timeout in units of 40 us */
+#define UFS_INTR_AGGR_TIMEOUT_UNIT_US	40
+
+static ssize_t intr_aggr_counter_show(struct device *dev,
+				      struct device_attribute *attr,
+				      char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EOPNOTSUPP;
+
+	return sysfs_emit(buf, "%u\n", hba->intr_aggr_cnt);
+}
+
+static ssize_t intr_aggr_counter_store(struct device *dev,
+				       struct device_attribute *attr,
+				       const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned int cnt;
+	int ret = 0;
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EOPNOTSUPP;
+
+	if (kstrtouint(buf, 0, &cnt))
+		return -EINVAL;
+
+	if (!cnt || cnt > hba->nutrs - 1)
+		return -EINVAL;
+
+	down(&hba->host_sem);
+	if (!ufshcd_is_user_access_allowed(hba)) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	ufshcd_intr_aggr_update(hba, cnt, hba->intr_aggr_tmout);
+
+out:
+	up(&hba->host_sem);
+	return ret ? ret : count;
+}
+
+static ssize_t intr_aggr_timeout_us_show(struct device *dev,
+					 struct device_attribute *attr,
+					 char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EOPNOTSUPP;
+
+	return sysfs_emit(buf, "%u\n",
+			  hba->intr_aggr_tmout * UFS_INTR_AGGR_TIMEOUT_UNIT_US);
+}
+
+static ssize_t intr_aggr_timeout_us_store(struct device *dev,
+					  struct device_attribute *attr,
+					  const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned int timeout;
+	int ret = 0;
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EOPNOTSUPP;
+
+	if (kstrtouint(buf, 0, &timeout))
+		return -EINVAL;
+
+	timeout = DIV_ROUND_UP(timeout, UFS_INTR_AGGR_TIMEOUT_UNIT_US);
+	if (!timeout || timeout > INT_AGGR_TIMEOUT_VAL_MASK)
+		return -EINVAL;
+
+	down(&hba->host_sem);
+	if (!ufshcd_is_user_access_allowed(hba)) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	ufshcd_intr_aggr_update(hba, hba->intr_aggr_cnt, timeout);
+
+out:
+	up(&hba->host_sem);
+	return ret ? ret : count;
+}
+
 static DEVICE_ATTR_RW(rpm_lvl);
 static DEVICE_ATTR_RO(rpm_target_dev_state);
 static DEVICE_ATTR_RO(rpm_target_link_state);
@@ -307,6 +396,8 @@ static DEVICE_ATTR_RO(spm_target_link_state);
 static DEVICE_ATTR_RW(auto_hibern8);
 static DEVICE_ATTR_RW(wb_on);
 static DEVICE_ATTR_RW(enable_wb_buf_flush);
+static DEVICE_ATTR_RW(intr_aggr_counter);
+static DEVICE_ATTR_RW(intr_aggr_timeout_us);
 
 static struct attribute *ufs_sysfs_ufshcd_attrs[] = {
 	&dev_attr_rpm_lvl.attr,
@@ -318,6 +409,8 @@ static struct attribute *ufs_sysfs_ufshcd_attrs[] = {
 	&dev_attr_auto_hibern8.attr,
 	&dev_attr_wb_on.attr,
 	&dev_attr_enable_wb_buf_flush.attr,
+	&dev_attr_intr_aggr_counter.attr,
+	&dev_attr_intr_aggr_timeout_us.attr,
 	NULL
 };
 
@@ -61,6 +61,7 @@ int ufshcd_query_attr(struct ufs_hba *hba, enum query_opcode opcode,
 int ufshcd_query_flag(struct ufs_hba *hba, enum query_opcode opcode,
 	enum flag_idn idn, u8 index, bool *flag_res);
 void ufshcd_auto_hibern8_update(struct ufs_hba *hba, u32 ahit);
+void ufshcd_intr_aggr_update(struct ufs_hba *hba, u8 cnt, u8 tmout);
 
 #define SD_ASCII_STD true
 #define SD_RAW false
@@ -75,6 +76,16 @@ void ufshcd_map_desc_id_to_length(struct ufs_hba *hba, enum desc_idn desc_id,
 
 int ufshcd_send_uic_cmd(struct ufs_hba *hba, struct uic_command *uic_cmd);
 
+int ufshcd_mcq_init(struct ufs_hba *hba);
+void ufshcd_mcq_make_queues_operational(struct ufs_hba *hba);
+struct ufs_hw_queue *ufshcd_mcq_req_to_hwq(struct ufs_hba *hba,
+					   struct request *req);
+void ufshcd_mcq_send_command(struct ufs_hba *hba, struct ufs_hw_queue *hwq,
+			     struct ufshcd_lrb *lrbp);
+unsigned long ufshcd_mcq_poll_cqe(struct ufs_hba *hba,
+				  struct ufs_hw_queue *hwq);
+u32 ufshcd_mcq_read_clear_cqis(struct ufs_hw_queue *hwq);
+
 int ufshcd_exec_raw_upiu_cmd(struct ufs_hba *hba,
 			     struct utp_upiu_req *req_upiu,
 			     struct utp_upiu_req *rsp_upiu,
@@ -114,6 +125,13 @@ static inline int ufshcd_vops_clk_scale_notify(struct ufs_hba *hba,
 	return 0;
 }
 
+static inline int ufshcd_vops_mcq_config_resource(struct ufs_hba *hba)
+{
+	if (hba->vops && hba->vops->mcq_config_resource)
+		return hba->vops->mcq_config_resource(hba);
+	return -EOPNOTSUPP;
+}
+
 static inline void ufshcd_vops_event_notify(struct ufs_hba *hba,
 					    enum ufs_event_type evt,
 					    void *data)
@@ -46,6 +46,15 @@
 /* UIC command timeout, unit: ms */
 #define UIC_CMD_TIMEOUT	500
 
+/*
+ * MCQ mode has no way to clear a single request yet, which command abort and
+ * LU reset rely on, so it has to be asked for.
+ */
+static bool use_mcq_mode;
+module_param(use_mcq_mode, bool, 0644);
+MODULE_PARM_DESC(use_mcq_mode,
+		 "Use Multi-Circular Queue mode on controllers that support it (default: false)");
+
 /* NOP OUT retries waiting for NOP IN response */
 #define NOP_OUT_RETRIES    10
 /* Timeout after 50 msecs if NOP OUT hangs without response */
@@ -908,6 +917,42 @@ static inline void ufshcd_disable_intr_aggr(struct ufs_hba *hba)
 	ufshcd_writel(hba, 0, REG_UTP_TRANSFER_REQ_INT_AGG_CONTROL);
 }
 
+/**
+ * ufshcd_intr_aggr_update - Change the interrupt aggregation parameters.
+ * @hba: per adapter instance
+ * @cnt: Interrupt aggregation counter threshold
+ * @tmout: Interrupt aggregation timeout value, unit: 40us
+ *
+ * The new values are also used whenever the controller is made operational
+ * again, and are written to UTRIACR on resume if the device was runtime
+ * suspended when they were changed.
+ */
+void ufshcd_intr_aggr_update(struct ufs_hba *hba, u8 cnt, u8 tmout)
+{
+	unsigned long flags;
+	bool update = false;
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	if (hba->intr_aggr_cnt != cnt || hba->intr_aggr_tmout != tmout) {
+		hba->intr_aggr_cnt = cnt;
+		hba->intr_aggr_tmout = tmout;
+		update = true;
+	}
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	if (update &&
+	    !pm_runtime_suspended(&hba->ufs_device_wlun->sdev_gendev)) {
+		ufshcd_rpm_get_sync(hba);
+		ufshcd_hold(hba, false);
+		ufshcd_config_intr_aggr(hba, cnt, tmout);
+		ufshcd_release(hba);
+		ufshcd_rpm_put_sync(hba);
+	}
+}
+
 /**
  * ufshcd_enable_run_stop_reg - Enable run-stop registers,
  *			When run-stop registers are set to 1, it indicates the
@@ -2156,8 +2201,19 @@ void ufshcd_send_command(struct ufs_hba *hba, unsigned int task_tag)
 	if (hba->vops && hba->vops->setup_xfer_req)
 		hba->vops->setup_xfer_req(hba, task_tag, !!lrbp->cmd);
 	__set_bit(task_tag, &hba->outstanding_reqs);
-	ufshcd_writel(hba, 1 << task_tag, REG_UTP_TRANSFER_REQ_DOOR_BELL);
+	if (!is_mcq_enabled(hba))
+		ufshcd_writel(hba, 1 << task_tag,
+			      REG_UTP_TRANSFER_REQ_DOOR_BELL);
 	spin_unlock_irqrestore(&hba->outstanding_lock, flags);
+
+	if (is_mcq_enabled(hba)) {
+		/* Device management commands always use the first queue */
+		struct ufs_hw_queue *hwq = lrbp->cmd ?
+			ufshcd_mcq_req_to_hwq(hba, scsi_cmd_to_rq(lrbp->cmd)) :
+			&hba->uhq[0];
+
+		ufshcd_mcq_send_command(hba, hwq, lrbp);
+	}
 }
 
 /**
@@ -2240,6 +2296,11 @@ static inline int ufshcd_hba_capabilities(struct ufs_hba *hba)
 	((hba->capabilities & MASK_TASK_MANAGEMENT_REQUEST_SLOTS) >> 16) + 1;
 	hba->reserved_slot = hba->nutrs - 1;
 
+	hba->intr_aggr_cnt = hba->nutrs - 1;
+	hba->intr_aggr_tmout = INT_AGGR_DEF_TO;
+
+	hba->mcq_sup = hba->capabilities & MASK_MCQ_SUPPORT;
+
 	/* Read crypto capabilities */
 	err = ufshcd_hba_init_crypto_capabilities(hba);
 	if (err)
@@ -2704,11 +2765,12 @@ static inline bool is_device_wlun(struct scsi_device *sdev)
 }
 
 /*
- * Associate the UFS controller queue with the default and poll HCTX types.
+ * Associate the UFS controller queues with the default and poll HCTX types.
  * Initialize the mq_map[] arrays.
  */
 static void ufshcd_map_queues(struct Scsi_Host *shost)
 {
+	struct ufs_hba *hba = shost_priv(shost);
 	int i;
 
 	for (i = 0; i < shost->nr_maps; i++) {
@@ -2717,7 +2779,7 @@ static void ufshcd_map_queues(struct Scsi_Host *shost)
 		switch (i) {
 		case HCTX_TYPE_DEFAULT:
 		case HCTX_TYPE_POLL:
-			map->nr_queues = 1;
+			map->nr_queues = hba->nr_hw_queues;
 			break;
 		case HCTX_TYPE_READ:
 			map->nr_queues = 0;
@@ -2831,7 +2893,12 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 	lrbp->cmd = cmd;
 	lrbp->task_tag = tag;
 	lrbp->lun = ufshcd_scsi_to_upiu_lun(cmd->device->lun);
-	lrbp->intr_cmd = !ufshcd_is_intr_aggr_allowed(hba);
+	/*
+	 * Polled requests are reaped by ufshcd_poll(), so do not ask for a
+	 * completion interrupt on their behalf.
+	 */
+	lrbp->intr_cmd = !ufshcd_is_intr_aggr_allowed(hba) &&
+		!(scsi_cmd_to_rq(cmd)->cmd_flags & REQ_POLLED);
 
 	ufshcd_prepare_lrbp_crypto(scsi_cmd_to_rq(cmd), lrbp);
 
@@ -2886,6 +2953,10 @@ static int ufshcd_clear_cmds(struct ufs_hba *hba, u32 mask)
 {
 	unsigned long flags;
 
+	/* There is no per-slot clear for requests in an MCQ submission queue */
+	if (is_mcq_enabled(hba))
+		return -EOPNOTSUPP;
+
 	/* clear outstanding transaction before retry */
 	spin_lock_irqsave(hba->host->host_lock, flags);
 	ufshcd_utrl_clear(hba, mask);
@@ -4525,11 +4596,13 @@ int ufshcd_make_hba_operational(struct ufs_hba *hba)
 	u32 reg;
 
 	/* Enable required interrupts */
-	ufshcd_enable_intr(hba, UFSHCD_ENABLE_INTRS);
+	ufshcd_enable_intr(hba, UFSHCD_ENABLE_INTRS |
+			   (is_mcq_enabled(hba) ? MCQ_CQ_EVENT_STATUS : 0));
 
 	/* Configure interrupt aggregation */
 	if (ufshcd_is_intr_aggr_allowed(hba))
-		ufshcd_config_intr_aggr(hba, hba->nutrs - 1, INT_AGGR_DEF_TO);
+		ufshcd_config_intr_aggr(hba, hba->intr_aggr_cnt,
+					hba->intr_aggr_tmout);
 	else
 		ufshcd_disable_intr_aggr(hba);
 
@@ -4543,6 +4616,9 @@ int ufshcd_make_hba_operational(struct ufs_hba *hba)
 	ufshcd_writel(hba, upper_32_bits(hba->utmrdl_dma_addr),
 			REG_UTP_TASK_REQ_LIST_BASE_H);
 
+	if (is_mcq_enabled(hba))
+		ufshcd_mcq_make_queues_operational(hba);
+
 	/*
 	 * Make sure base address and interrupt setup are updated before
 	 * enabling the run/stop registers below.
@@ -5392,6 +5468,17 @@ static int ufshcd_poll(struct Scsi_Host *shost, unsigned int queue_num)
 	unsigned long completed_reqs, flags;
 	u32 tr_doorbell;
 
+	if (is_mcq_enabled(hba)) {
+		completed_reqs = ufshcd_mcq_poll_cqe(hba,
+						     &hba->uhq[queue_num]);
+		spin_lock_irqsave(&hba->outstanding_lock, flags);
+		/* Requests completed by the error handler are skipped */
+		completed_reqs &= hba->outstanding_reqs;
+		hba->outstanding_reqs &= ~completed_reqs;
+		spin_unlock_irqrestore(&hba->outstanding_lock, flags);
+		goto complete;
+	}
+
 	spin_lock_irqsave(&hba->outstanding_lock, flags);
 	tr_doorbell = ufshcd_readl(hba, REG_UTP_TRANSFER_REQ_DOOR_BELL);
 	completed_reqs = ~tr_doorbell & hba->outstanding_reqs;
@@ -5401,6 +5488,8 @@ static int ufshcd_poll(struct Scsi_Host *shost, unsigned int queue_num)
 	hba->outstanding_reqs &= ~completed_reqs;
 	spin_unlock_irqrestore(&hba->outstanding_lock, flags);
 
+complete:
+
 	if (completed_reqs)
 		__ufshcd_transfer_req_compl(hba, completed_reqs);
 
@@ -5417,6 +5506,8 @@ static int ufshcd_poll(struct Scsi_Host *shost, unsigned int queue_num)
  */
 static irqreturn_t ufshcd_transfer_req_compl(struct ufs_hba *hba)
 {
+	unsigned int i;
+
 	/* Resetting interrupt aggregation counters first and reading the
 	 * DOOR_BELL afterward allows us to handle all the completed requests.
 	 * In order to prevent other interrupts starvation the DB is read once
@@ -5435,11 +5526,40 @@ static irqreturn_t ufshcd_transfer_req_compl(struct ufs_hba *hba)
 	 * Ignore the ufshcd_poll() return value and return IRQ_HANDLED since we
 	 * do not want polling to trigger spurious interrupt complaints.
 	 */
-	ufshcd_poll(hba->host, 0);
+	for (i = 0; i < hba->nr_hw_queues; i++)
+		ufshcd_poll(hba->host, i);
 
 	return IRQ_HANDLED;
 }
 
+/**
+ * ufshcd_mcq_cq_events - handle MCQ completion queue events
+ * @hba: per adapter instance
+ *
+ * Returns
+ *  IRQ_HANDLED - If interrupt is valid
+ *  IRQ_NONE    - If invalid interrupt
+ */
+static irqreturn_t ufshcd_mcq_cq_events(struct ufs_hba *hba)
+{
+	irqreturn_t retval = IRQ_NONE;
+	unsigned int i;
+
+	if (ufs_fail_completion())
+		return IRQ_HANDLED;
+
+	for (i = 0; i < hba->nr_hw_queues; i++) {
+		if (!(ufshcd_mcq_read_clear_cqis(&hba->uhq[i]) &
+		      MCQ_CQIS_TEPS))
+			continue;
+
+		ufshcd_poll(hba->host, i);
+		retval = IRQ_HANDLED;
+	}
+
+	return retval;
+}
+
 int __ufshcd_write_ee_control(struct ufs_hba *hba, u32 ee_ctrl_mask)
 {
 	return ufshcd_query_attr_retry(hba, UPIU_QUERY_OPCODE_WRITE_ATTR,
@@ -6628,6 +6748,9 @@ static irqreturn_t ufshcd_sl_intr(struct ufs_hba *hba, u32 intr_status)
 	if (intr_status & UTP_TRANSFER_REQ_COMPL)
 		retval |= ufshcd_transfer_req_compl(hba);
 
+	if (intr_status & MCQ_CQ_EVENT_STATUS)
+		retval |= ufshcd_mcq_cq_events(hba);
+
 	return retval;
 }
 
@@ -7035,8 +7158,11 @@ static int ufshcd_eh_device_reset_handler(struct scsi_cmnd *cmd)
 
 	if (ufshcd_clear_cmds(hba, pending_reqs) < 0) {
 		spin_lock_irqsave(&hba->outstanding_lock, flags);
-		not_cleared = pending_reqs &
-			ufshcd_readl(hba, REG_UTP_TRANSFER_REQ_DOOR_BELL);
+		if (is_mcq_enabled(hba))
+			not_cleared = pending_reqs;
+		else
+			not_cleared = pending_reqs &
+				ufshcd_readl(hba, REG_UTP_TRANSFER_REQ_DOOR_BELL);
 		hba->outstanding_reqs |= not_cleared;
 		spin_unlock_irqrestore(&hba->outstanding_lock, flags);
 
@@ -7045,6 +7171,10 @@ static int ufshcd_eh_device_reset_handler(struct scsi_cmnd *cmd)
 	}
 	__ufshcd_transfer_req_compl(hba, pending_reqs & ~not_cleared);
 
+	/* Requests left in an MCQ submission queue need a host reset */
+	if (not_cleared && is_mcq_enabled(hba))
+		err = -EBUSY;
+
 out:
 	hba->req_abort_count = 0;
 	ufshcd_update_evt_hist(hba, UFS_EVT_DEV_RESET, (u32)err);
@@ -7089,6 +7219,13 @@ static int ufshcd_try_to_abort_task(struct ufs_hba *hba, int tag)
 	u8 resp = 0xF;
 	u32 reg;
 
+	/*
+	 * The doorbell does not reflect MCQ requests and such requests cannot
+	 * be cleared one by one, so leave them to a host reset.
+	 */
+	if (is_mcq_enabled(hba))
+		return -EOPNOTSUPP;
+
 	for (poll_cnt = 100; poll_cnt; poll_cnt--) {
 		err = ufshcd_issue_tm_cmd(hba, lrbp->lun, lrbp->task_tag,
 				UFS_QUERY_TASK, &resp);
@@ -7200,7 +7337,7 @@ static int ufshcd_abort(struct scsi_cmnd *cmd)
 	}
 	hba->req_abort_count++;
 
-	if (!(reg & (1 << tag))) {
+	if (!is_mcq_enabled(hba) && !(reg & (1 << tag))) {
 		dev_err(hba->dev,
 		"%s: cmd was completed, but without a notifying intr, tag = %d",
 		__func__, tag);
@@ -7272,6 +7409,7 @@ static int ufshcd_abort(struct scsi_cmnd *cmd)
  */
 static int ufshcd_host_reset_and_restore(struct ufs_hba *hba)
 {
+	unsigned long flags, pending;
 	int err;
 
 	/*
@@ -7282,6 +7420,17 @@ static int ufshcd_host_reset_and_restore(struct ufs_hba *hba)
 	ufshcd_hba_stop(hba);
 	hba->silence_err_logs = true;
 	ufshcd_complete_requests(hba);
+	if (is_mcq_enabled(hba)) {
+		/*
+		 * A stopped controller discards its queues without posting
+		 * completion entries for the requests still in them.
+		 */
+		spin_lock_irqsave(&hba->outstanding_lock, flags);
+		pending = hba->outstanding_reqs;
+		hba->outstanding_reqs = 0;
+		spin_unlock_irqrestore(&hba->outstanding_lock, flags);
+		__ufshcd_transfer_req_compl(hba, pending);
+	}
 	hba->silence_err_logs = false;
 
 	/* scale up clocks to max frequency before full reinitialization */
@@ -9191,6 +9340,14 @@ static int __ufshcd_wl_resume(struct ufs_hba *hba, enum ufs_pm_op pm_op)
 	/* Enable Auto-Hibernate if configured */
 	ufshcd_auto_hibern8_enable(hba);
 
+	/*
+	 * ufshcd_intr_aggr_update() leaves UTRIACR alone while suspended,
+	 * apply the current values.
+	 */
+	if (ufshcd_is_intr_aggr_allowed(hba))
+		ufshcd_config_intr_aggr(hba, hba->intr_aggr_cnt,
+					hba->intr_aggr_tmout);
+
 	ufshpb_resume(hba);
 	goto out;
 
@@ -9696,6 +9853,22 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 	/* Configure LRB */
 	ufshcd_host_memory_configure(hba);
 
+	hba->nr_hw_queues = 1;
+	if (hba->mcq_sup && use_mcq_mode) {
+		err = ufshcd_mcq_init(hba);
+		if (err) {
+			dev_err(hba->dev, "MCQ init failed (%d), using the doorbell interface\n",
+				err);
+			hba->nr_hw_queues = 1;
+			err = 0;
+		}
+	}
+	if (is_mcq_enabled(hba)) {
+		hba->intr_mask |= MCQ_CQ_EVENT_STATUS;
+		host->host_tagset = 1;
+	}
+	host->nr_hw_queues = hba->nr_hw_queues;
+
 	host->can_queue = hba->nutrs - UFSHCD_NUM_RESERVED;
 	host->cmd_per_lun = hba->nutrs - UFSHCD_NUM_RESERVED;
 	host->max_id = UFSHCD_MAX_ID;
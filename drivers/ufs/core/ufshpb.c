@@ -24,6 +24,7 @@
 #define READ_TO_EXPIRIES 100
 #define POLLING_INTERVAL_MS 200
 #define THROTTLE_MAP_REQ_DEFAULT 1
+#define PREFETCH_THRESHOLD 4 /* 4 sequential IOs */
 
 /* memory management */
 static struct kmem_cache *ufshpb_mctx_cache;
@@ -340,6 +341,72 @@ ufshpb_set_hpb_read_to_upiu(struct ufs_hba *hba, struct ufshcd_lrb *lrbp,
 	lrbp->cmd->cmd_len = UFS_CDB_SIZE;
 }
 
+/*
+ * In host control mode a subregion is only activated once it has seen
+ * activation_thld reads, so a sequential stream misses on every subregion it
+ * enters. Once the stream has been sequential for prefetch_thld reads, ask
+ * for the subregion one ahead of it so that its map is loaded in time.
+ */
+static void ufshpb_prefetch_srgn(struct ufshpb_lu *hpb, unsigned long lpn,
+				 int transfer_len)
+{
+	struct ufshpb_region *rgn;
+	struct ufshpb_subregion *srgn;
+	int rgn_idx, srgn_idx, srgn_offset;
+	unsigned long flags;
+	bool sequential;
+
+	if (!hpb->params.prefetch_thld)
+		return;
+
+	spin_lock_irqsave(&hpb->rsp_list_lock, flags);
+	if (lpn == hpb->seq_next_lpn) {
+		if (hpb->seq_reads < hpb->params.prefetch_thld)
+			hpb->seq_reads++;
+	} else {
+		hpb->seq_reads = 0;
+	}
+	hpb->seq_next_lpn = lpn + transfer_len;
+	sequential = hpb->seq_reads >= hpb->params.prefetch_thld;
+	spin_unlock_irqrestore(&hpb->rsp_list_lock, flags);
+
+	if (!sequential)
+		return;
+
+	ufshpb_get_pos_from_lpn(hpb, lpn + transfer_len + hpb->entries_per_srgn,
+				&rgn_idx, &srgn_idx, &srgn_offset);
+	if (rgn_idx >= hpb->rgns_per_lu || ufshpb_is_pinned_region(hpb, rgn_idx))
+		return;
+
+	rgn = hpb->rgn_tbl + rgn_idx;
+	if (srgn_idx >= rgn->srgn_cnt)
+		return;
+	srgn = rgn->srgn_tbl + srgn_idx;
+
+	spin_lock_irqsave(&hpb->rgn_state_lock, flags);
+	if (rgn->rgn_state != HPB_RGN_INACTIVE &&
+	    (srgn->srgn_state == HPB_SRGN_VALID ||
+	     srgn->srgn_state == HPB_SRGN_ISSUED)) {
+		spin_unlock_irqrestore(&hpb->rgn_state_lock, flags);
+		return;
+	}
+	spin_unlock_irqrestore(&hpb->rgn_state_lock, flags);
+
+	spin_lock_irqsave(&hpb->rsp_list_lock, flags);
+	if (!list_empty(&srgn->list_act_srgn)) {
+		spin_unlock_irqrestore(&hpb->rsp_list_lock, flags);
+		return;
+	}
+	ufshpb_update_active_info(hpb, rgn_idx, srgn_idx);
+	hpb->stats.prefetch_cnt++;
+	spin_unlock_irqrestore(&hpb->rsp_list_lock, flags);
+
+	dev_dbg(&hpb->sdev_ufs_lu->sdev_dev, "prefetch region %d-%d\n",
+		rgn_idx, srgn_idx);
+
+	ufshpb_kick_map_work(hpb);
+}
+
 /*
  * This function will set up HPB read command using host-side L2P map data.
  */
@@ -401,6 +468,8 @@ int ufshpb_prep(struct ufs_hba *hba, struct ufshcd_lrb *lrbp)
 		ufshpb_iterate_rgn(hpb, rgn_idx, srgn_idx, srgn_offset,
 				   transfer_len, false);
 
+		ufshpb_prefetch_srgn(hpb, lpn, transfer_len);
+
 		/* keep those counters normalized */
 		if (rgn->reads > hpb->entries_per_srgn)
 			schedule_work(&hpb->ufshpb_normalization_work);
@@ -1763,6 +1832,7 @@ ufshpb_sysfs_attr_show_func(rcmd_active_cnt);
 ufshpb_sysfs_attr_show_func(rcmd_inactive_cnt);
 ufshpb_sysfs_attr_show_func(map_req_cnt);
 ufshpb_sysfs_attr_show_func(umap_req_cnt);
+ufshpb_sysfs_attr_show_func(prefetch_cnt);
 
 static struct attribute *hpb_dev_stat_attrs[] = {
 	&dev_attr_hit_cnt.attr,
@@ -1772,6 +1842,7 @@ static struct attribute *hpb_dev_stat_attrs[] = {
 	&dev_attr_rcmd_inactive_cnt.attr,
 	&dev_attr_map_req_cnt.attr,
 	&dev_attr_umap_req_cnt.attr,
+	&dev_attr_prefetch_cnt.attr,
 	NULL,
 };
 
@@ -2037,6 +2108,30 @@ static ssize_t inflight_map_req_store(struct device *dev,
 }
 static DEVICE_ATTR_RW(inflight_map_req);
 
+ufshpb_sysfs_param_show_func(prefetch_thld);
+static ssize_t
+prefetch_thld_store(struct device *dev, struct device_attribute *attr,
+		    const char *buf, size_t count)
+{
+	struct scsi_device *sdev = to_scsi_device(dev);
+	struct ufshpb_lu *hpb = ufshpb_get_hpb_data(sdev);
+	int val;
+
+	if (!hpb)
+		return -ENODEV;
+
+	if (!hpb->is_hcm)
+		return -EOPNOTSUPP;
+
+	if (kstrtouint(buf, 0, &val))
+		return -EINVAL;
+
+	hpb->params.prefetch_thld = val;
+
+	return count;
+}
+static DEVICE_ATTR_RW(prefetch_thld);
+
 static void ufshpb_hcm_param_init(struct ufshpb_lu *hpb)
 {
 	hpb->params.activation_thld = ACTIVATION_THRESHOLD;
@@ -2047,6 +2142,7 @@ static void ufshpb_hcm_param_init(struct ufshpb_lu *hpb)
 	hpb->params.read_timeout_expiries = READ_TO_EXPIRIES;
 	hpb->params.timeout_polling_interval_ms = POLLING_INTERVAL_MS;
 	hpb->params.inflight_map_req = THROTTLE_MAP_REQ_DEFAULT;
+	hpb->params.prefetch_thld = PREFETCH_THRESHOLD;
 }
 
 static struct attribute *hpb_dev_param_attrs[] = {
@@ -2059,6 +2155,7 @@ static struct attribute *hpb_dev_param_attrs[] = {
 	&dev_attr_read_timeout_expiries.attr,
 	&dev_attr_timeout_polling_interval_ms.attr,
 	&dev_attr_inflight_map_req.attr,
+	&dev_attr_prefetch_thld.attr,
 	NULL,
 };
 
@@ -2137,6 +2234,7 @@ static void ufshpb_stat_init(struct ufshpb_lu *hpb)
 	hpb->stats.rcmd_inactive_cnt = 0;
 	hpb->stats.map_req_cnt = 0;
 	hpb->stats.umap_req_cnt = 0;
+	hpb->stats.prefetch_cnt = 0;
 }
 
 static void ufshpb_param_init(struct ufshpb_lu *hpb)
@@ -195,6 +195,8 @@ struct victim_select_info {
  * @read_timeout_expiries - amount of allowable timeout expireis
  * @timeout_polling_interval_ms - frequency in which timeouts are checked
  * @inflight_map_req - number of inflight map requests
+ * @prefetch_thld - min sequential reads [IOs] before the next subregion is
+ *	activated ahead of the stream, 0 disables read-ahead
  */
 struct ufshpb_params {
 	unsigned int requeue_timeout_ms;
@@ -206,6 +208,7 @@ struct ufshpb_params {
 	unsigned int read_timeout_expiries;
 	unsigned int timeout_polling_interval_ms;
 	unsigned int inflight_map_req;
+	unsigned int prefetch_thld;
 };
 
 struct ufshpb_stats {
@@ -217,6 +220,7 @@ struct ufshpb_stats {
 	u64 map_req_cnt;
 	u64 pre_req_cnt;
 	u64 umap_req_cnt;
+	u64 prefetch_cnt;
 };
 
 struct ufshpb_lu {
@@ -252,6 +256,10 @@ struct ufshpb_lu {
 	unsigned long work_data_bits;
 #define TIMEOUT_WORK_RUNNING 0
 
+	/* sequential read detection - for host mode, hold rsp_list_lock */
+	unsigned long seq_next_lpn;
+	unsigned int seq_reads;
+
 	/* pinned region information */
 	u32 lu_pinned_start;
 	u32 lu_pinned_end;
@@ -176,6 +176,7 @@ static void dwc3_gadget_del_and_unmap_request(struct dwc3_ep *dep,
 		struct dwc3_request *req, int status)
 {
 	struct dwc3			*dwc = dep->dwc;
+	bool				dma_mapped;
 
 	list_del(&req->list);
 	req->remaining = 0;
@@ -184,9 +185,17 @@ static void dwc3_gadget_del_and_unmap_request(struct dwc3_ep *dep,
 	if (req->request.status == -EINPROGRESS)
 		req->request.status = status;
 
-	if (req->trb)
-		usb_gadget_unmap_request_by_dev(dwc->sysdev,
-				&req->request, req->direction);
+	/*
+	 * The request may have been mapped without getting any TRB. Unmapping
+	 * is a no-op for requests that aren't mapped by us.
+	 */
+	dma_mapped = req->request.dma_mapped;
+	usb_gadget_unmap_request_by_dev(dwc->sysdev, &req->request,
+			req->direction);
+
+	/* Don't mistake a stale address for a premapped buffer */
+	if (dma_mapped)
+		req->request.dma = 0;
 
 	req->trb = NULL;
 	trace_dwc3_gadget_giveback(req);
@@ -1506,6 +1515,31 @@ static int dwc3_prepare_trbs_linear(struct dwc3_ep *dep,
 	return dwc3_prepare_last_sg(dep, req, req->request.length, 0);
 }
 
+/*
+ * dwc3_gadget_map_request - map a request for DMA
+ * @dep: endpoint the request is queued on
+ * @req: the request to map
+ *
+ * A request which couldn't get any TRB is left on the pending list with its
+ * mapping in place, so don't map it a second time. Gadget drivers recycling
+ * the same buffers may also map them once and pass the DMA address in, as
+ * described in struct usb_request; those are used as is.
+ */
+static int dwc3_gadget_map_request(struct dwc3_ep *dep,
+		struct dwc3_request *req)
+{
+	struct usb_request	*request = &req->request;
+
+	if (request->num_mapped_sgs || request->dma_mapped)
+		return 0;
+
+	if (!request->num_sgs && request->dma)
+		return 0;
+
+	return usb_gadget_map_request_by_dev(dep->dwc->sysdev, request,
+					     dep->direction);
+}
+
 /*
  * dwc3_prepare_trbs - setup TRBs from requests
  * @dep: endpoint for which requests are being prepared
@@ -1556,8 +1590,7 @@ static int dwc3_prepare_trbs(struct dwc3_ep *dep)
 	list_for_each_entry_safe(req, n, &dep->pending_list, list) {
 		struct dwc3	*dwc = dep->dwc;
 
-		ret = usb_gadget_map_request_by_dev(dwc->sysdev, &req->request,
-						    dep->direction);
+		ret = dwc3_gadget_map_request(dep, req);
 		if (ret)
 			return ret;
 
@@ -40,6 +40,11 @@ module_param(experimental_zcopytx, int, 0444);
 MODULE_PARM_DESC(experimental_zcopytx, "Enable Zero Copy TX;"
 		                       " 1 -Enable; 0 - Disable");
 
+static bool split_workers;
+module_param(split_workers, bool, 0444);
+MODULE_PARM_DESC(split_workers,
+		 "Run TX and RX of each device in separate worker threads");
+
 /* Max number of bytes transferred before requeueing the job.
  * Using this limit prevents one virtqueue from starving others. */
 #define VHOST_NET_WEIGHT 0x80000
@@ -545,7 +550,8 @@ static void vhost_net_busy_poll(struct vhost_net *net,
 	endtime = busy_clock() + busyloop_timeout;
 
 	while (vhost_can_busy_poll(endtime)) {
-		if (vhost_has_work(&net->dev)) {
+		/* Only our own worker's backlog is delayed by spinning. */
+		if (vhost_vq_has_work(poll_rx ? rvq : tvq)) {
 			*busyloop_intr = true;
 			break;
 		}
@@ -1340,9 +1346,12 @@ static int vhost_net_open(struct inode *inode, struct file *f)
 		       UIO_MAXIOV + VHOST_NET_BATCH,
 		       VHOST_NET_PKT_WEIGHT, VHOST_NET_WEIGHT, true,
 		       NULL);
+	dev->worker_per_vq = split_workers;
 
 	vhost_poll_init(n->poll + VHOST_NET_VQ_TX, handle_tx_net, EPOLLOUT, dev);
 	vhost_poll_init(n->poll + VHOST_NET_VQ_RX, handle_rx_net, EPOLLIN, dev);
+	n->poll[VHOST_NET_VQ_TX].vq = vqs[VHOST_NET_VQ_TX];
+	n->poll[VHOST_NET_VQ_RX].vq = vqs[VHOST_NET_VQ_RX];
 
 	f->private_data = n;
 	n->page_frag.page = NULL;
@@ -77,6 +77,7 @@ struct vring_desc_state_packed {
 	struct vring_packed_desc *indir_desc; /* Indirect descriptor, if any. */
 	u16 num;			/* Descriptor list length. */
 	u16 last;			/* The last desc state in a list. */
+	u32 total_in_len;		/* Device-writable bytes, for in-order. */
 };
 
 struct vring_desc_extra {
@@ -139,6 +140,14 @@ struct vring_virtqueue_packed {
 	 */
 	u16 event_flags_shadow;
 
+	/*
+	 * In-order only: id and len of the used descriptor that completes
+	 * the batch being reclaimed, or an id of vring.num when no batch is
+	 * pending.
+	 */
+	u16 batch_last_id;
+	u32 batch_last_len;
+
 	/* Per-descriptor state. */
 	struct vring_desc_state_packed *desc_state;
 	struct vring_desc_extra *desc_extra;
@@ -172,6 +181,9 @@ struct vring_virtqueue {
 	/* Host publishes avail event idx */
 	bool event;
 
+	/* Host uses buffers in the order they were made available */
+	bool in_order;
+
 	/* Head of free buffer list. */
 	unsigned int free_head;
 	/* Number we've added since last sync. */
@@ -1238,6 +1250,7 @@ static int virtqueue_add_indirect_packed(struct vring_virtqueue *vq,
 	struct vring_packed_desc *desc;
 	struct scatterlist *sg;
 	unsigned int i, n, err_idx;
+	u32 total_in_len = 0;
 	u16 head, id;
 	dma_addr_t addr;
 
@@ -1268,6 +1281,8 @@ static int virtqueue_add_indirect_packed(struct vring_virtqueue *vq,
 						0 : VRING_DESC_F_WRITE);
 			desc[i].addr = cpu_to_le64(addr);
 			desc[i].len = cpu_to_le32(sg->length);
+			if (n >= out_sgs)
+				total_in_len += sg->length;
 			i++;
 		}
 	}
@@ -1321,6 +1336,7 @@ static int virtqueue_add_indirect_packed(struct vring_virtqueue *vq,
 	vq->packed.desc_state[id].data = data;
 	vq->packed.desc_state[id].indir_desc = desc;
 	vq->packed.desc_state[id].last = id;
+	vq->packed.desc_state[id].total_in_len = total_in_len;
 
 	vq->num_added += 1;
 
@@ -1354,6 +1370,7 @@ static inline int virtqueue_add_packed(struct virtqueue *_vq,
 	struct vring_packed_desc *desc;
 	struct scatterlist *sg;
 	unsigned int i, n, c, descs_used, err_idx;
+	u32 total_in_len = 0;
 	__le16 head_flags, flags;
 	u16 head, id, prev, curr, avail_used_flags;
 	int err;
@@ -1422,6 +1439,8 @@ static inline int virtqueue_add_packed(struct virtqueue *_vq,
 			desc[i].addr = cpu_to_le64(addr);
 			desc[i].len = cpu_to_le32(sg->length);
 			desc[i].id = cpu_to_le16(id);
+			if (n >= out_sgs)
+				total_in_len += sg->length;
 
 			if (unlikely(vq->use_dma_api)) {
 				vq->packed.desc_extra[curr].addr = addr;
@@ -1456,6 +1475,7 @@ static inline int virtqueue_add_packed(struct virtqueue *_vq,
 	vq->packed.desc_state[id].data = data;
 	vq->packed.desc_state[id].indir_desc = ctx;
 	vq->packed.desc_state[id].last = prev;
+	vq->packed.desc_state[id].total_in_len = total_in_len;
 
 	/*
 	 * A driver MUST NOT make the first descriptor in the list
@@ -1553,8 +1573,15 @@ static void detach_buf_packed(struct vring_virtqueue *vq,
 	/* Clear data ptr. */
 	state->data = NULL;
 
-	vq->packed.desc_extra[state->last].next = vq->free_head;
-	vq->free_head = id;
+	/*
+	 * In order, descriptors are reclaimed in the order they were made
+	 * available, so the desc_extra chain stays the sequential ring order
+	 * it was initialized with and free_head keeps tracking next_avail_idx.
+	 */
+	if (!vq->in_order) {
+		vq->packed.desc_extra[state->last].next = vq->free_head;
+		vq->free_head = id;
+	}
 	vq->vq.num_free += state->num;
 
 	if (unlikely(vq->use_dma_api)) {
@@ -1606,12 +1633,110 @@ static inline bool more_used_packed(const struct vring_virtqueue *vq)
 	u16 last_used_idx;
 	bool used_wrap_counter;
 
+	/* The rest of an in-order batch is used without its own descriptor. */
+	if (vq->in_order && vq->packed.batch_last_id != vq->packed.vring.num)
+		return true;
+
 	last_used_idx = READ_ONCE(vq->last_used_idx);
 	last_used = packed_last_used(last_used_idx);
 	used_wrap_counter = packed_used_wrap_counter(last_used_idx);
 	return is_used_desc_packed(vq, last_used, used_wrap_counter);
 }
 
+static void update_last_used_packed(struct vring_virtqueue *vq,
+				    u16 last_used, bool used_wrap_counter)
+{
+	last_used = (last_used | (used_wrap_counter << VRING_PACKED_EVENT_F_WRAP_CTR));
+	WRITE_ONCE(vq->last_used_idx, last_used);
+
+	/*
+	 * If we expect an interrupt for the next entry, tell host
+	 * by writing event index and flush out the write before
+	 * the read in the next get_buf call.
+	 */
+	if (vq->packed.event_flags_shadow == VRING_PACKED_EVENT_FLAG_DESC)
+		virtio_store_mb(vq->weak_barriers,
+				&vq->packed.vring.driver->off_wrap,
+				cpu_to_le16(vq->last_used_idx));
+}
+
+/*
+ * With VIRTIO_F_IN_ORDER the device may complete a whole batch of buffers by
+ * writing a single used descriptor that carries the id of the last buffer and
+ * then skipping the ring forward past the batch. Since buffers are made
+ * available with their head slot as id, the buffer to return is always the
+ * one at last_used: the ring only has to be read once per batch, and the
+ * buffers in front of the last one are reported as completely written.
+ */
+static void *virtqueue_get_buf_ctx_packed_in_order(struct vring_virtqueue *vq,
+						   unsigned int *len,
+						   void **ctx)
+{
+	u16 last_used, id, last_used_idx;
+	bool used_wrap_counter;
+	void *ret;
+
+	START_USE(vq);
+
+	if (unlikely(vq->broken)) {
+		END_USE(vq);
+		return NULL;
+	}
+
+	last_used_idx = READ_ONCE(vq->last_used_idx);
+	used_wrap_counter = packed_used_wrap_counter(last_used_idx);
+	last_used = packed_last_used(last_used_idx);
+
+	if (vq->packed.batch_last_id == vq->packed.vring.num) {
+		if (!is_used_desc_packed(vq, last_used, used_wrap_counter)) {
+			pr_debug("No more buffers in queue\n");
+			END_USE(vq);
+			return NULL;
+		}
+
+		/* Only get used elements after they have been exposed by host. */
+		virtio_rmb(vq->weak_barriers);
+
+		id = le16_to_cpu(vq->packed.vring.desc[last_used].id);
+		if (unlikely(id >= vq->packed.vring.num)) {
+			BAD_RING(vq, "id %u out of range\n", id);
+			return NULL;
+		}
+		vq->packed.batch_last_id = id;
+		vq->packed.batch_last_len =
+			le32_to_cpu(vq->packed.vring.desc[last_used].len);
+	}
+
+	id = last_used;
+	if (unlikely(!vq->packed.desc_state[id].data)) {
+		BAD_RING(vq, "id %u is not a head!\n", id);
+		return NULL;
+	}
+
+	if (id == vq->packed.batch_last_id) {
+		*len = vq->packed.batch_last_len;
+		vq->packed.batch_last_id = vq->packed.vring.num;
+	} else {
+		*len = vq->packed.desc_state[id].total_in_len;
+	}
+
+	/* detach_buf_packed clears data, so grab it now. */
+	ret = vq->packed.desc_state[id].data;
+	detach_buf_packed(vq, id, ctx);
+
+	last_used += vq->packed.desc_state[id].num;
+	if (unlikely(last_used >= vq->packed.vring.num)) {
+		last_used -= vq->packed.vring.num;
+		used_wrap_counter ^= 1;
+	}
+	update_last_used_packed(vq, last_used, used_wrap_counter);
+
+	LAST_ADD_TIME_INVALID(vq);
+
+	END_USE(vq);
+	return ret;
+}
+
 static void *virtqueue_get_buf_ctx_packed(struct virtqueue *_vq,
 					  unsigned int *len,
 					  void **ctx)
@@ -1621,6 +1746,9 @@ static void *virtqueue_get_buf_ctx_packed(struct virtqueue *_vq,
 	bool used_wrap_counter;
 	void *ret;
 
+	if (vq->in_order)
+		return virtqueue_get_buf_ctx_packed_in_order(vq, len, ctx);
+
 	START_USE(vq);
 
 	if (unlikely(vq->broken)) {
@@ -1661,19 +1789,7 @@ static void *virtqueue_get_buf_ctx_packed(struct virtqueue *_vq,
 		last_used -= vq->packed.vring.num;
 		used_wrap_counter ^= 1;
 	}
-
-	last_used = (last_used | (used_wrap_counter << VRING_PACKED_EVENT_F_WRAP_CTR));
-	WRITE_ONCE(vq->last_used_idx, last_used);
-
-	/*
-	 * If we expect an interrupt for the next entry, tell host
-	 * by writing event index and flush out the write before
-	 * the read in the next get_buf call.
-	 */
-	if (vq->packed.event_flags_shadow == VRING_PACKED_EVENT_FLAG_DESC)
-		virtio_store_mb(vq->weak_barriers,
-				&vq->packed.vring.driver->off_wrap,
-				cpu_to_le16(vq->last_used_idx));
+	update_last_used_packed(vq, last_used, used_wrap_counter);
 
 	LAST_ADD_TIME_INVALID(vq);
 
@@ -1731,6 +1847,9 @@ static bool virtqueue_poll_packed(struct virtqueue *_vq, u16 off_wrap)
 	bool wrap_counter;
 	u16 used_idx;
 
+	if (vq->in_order && vq->packed.batch_last_id != vq->packed.vring.num)
+		return true;
+
 	wrap_counter = off_wrap >> VRING_PACKED_EVENT_F_WRAP_CTR;
 	used_idx = off_wrap & ~(1 << VRING_PACKED_EVENT_F_WRAP_CTR);
 
@@ -1947,6 +2066,7 @@ static void virtqueue_vring_init_packed(struct vring_virtqueue_packed *vring_pac
 	vring_packed->avail_wrap_counter = 1;
 	vring_packed->event_flags_shadow = 0;
 	vring_packed->avail_used_flags = 1 << VRING_PACKED_DESC_F_AVAIL;
+	vring_packed->batch_last_id = vring_packed->vring.num;
 
 	/* No callback?  Tell other side not to bother us. */
 	if (!callback) {
@@ -1975,6 +2095,10 @@ static void virtqueue_reinit_packed(struct vring_virtqueue *vq)
 
 	virtqueue_init(vq, vq->packed.vring.num);
 	virtqueue_vring_init_packed(&vq->packed, !!vq->vq.callback);
+
+	/* In order, buffer ids must restart at the first ring slot. */
+	if (vq->in_order)
+		vq->free_head = 0;
 }
 
 static struct virtqueue *vring_create_virtqueue_packed(
@@ -2019,6 +2143,7 @@ static struct virtqueue *vring_create_virtqueue_packed(
 	vq->indirect = virtio_has_feature(vdev, VIRTIO_RING_F_INDIRECT_DESC) &&
 		!context;
 	vq->event = virtio_has_feature(vdev, VIRTIO_RING_F_EVENT_IDX);
+	vq->in_order = virtio_has_feature(vdev, VIRTIO_F_IN_ORDER);
 
 	if (virtio_has_feature(vdev, VIRTIO_F_ORDER_PLATFORM))
 		vq->weak_barriers = false;
@@ -2512,6 +2637,7 @@ static struct virtqueue *__vring_new_virtqueue(unsigned int index,
 	vq->indirect = virtio_has_feature(vdev, VIRTIO_RING_F_INDIRECT_DESC) &&
 		!context;
 	vq->event = virtio_has_feature(vdev, VIRTIO_RING_F_EVENT_IDX);
+	vq->in_order = false;
 
 	if (virtio_has_feature(vdev, VIRTIO_F_ORDER_PLATFORM))
 		vq->weak_barriers = false;
@@ -2718,6 +2844,11 @@ void vring_transport_features(struct virtio_device *vdev)
 			break;
 		case VIRTIO_F_ORDER_PLATFORM:
 			break;
+		case VIRTIO_F_IN_ORDER:
+			/* Only the packed ring implements in-order completion. */
+			if (!__virtio_test_bit(vdev, VIRTIO_F_RING_PACKED))
+				__virtio_clear_bit(vdev, i);
+			break;
 		default:
 			/* We don't understand this bit. */
 			__virtio_clear_bit(vdev, i);
@@ -155,10 +155,8 @@ static void cachefiles_flush_reqs(struct cachefiles_cache *cache)
 	smp_mb();
 
 	xa_lock(xa);
-	xa_for_each(xa, index, req) {
-		req->error = -EIO;
-		complete(&req->done);
-	}
+	xa_for_each(xa, index, req)
+		cachefiles_req_finish(req, -EIO);
 	xa_unlock(xa);
 
 	xa_destroy(&cache->reqs);
@@ -769,6 +767,9 @@ static int cachefiles_daemon_bind(struct cachefiles_cache *cache, char *args)
 	if (IS_ENABLED(CONFIG_CACHEFILES_ONDEMAND)) {
 		if (!strcmp(args, "ondemand")) {
 			set_bit(CACHEFILES_ONDEMAND_MODE, &cache->flags);
+		} else if (!strcmp(args, "ondemand,batch")) {
+			set_bit(CACHEFILES_ONDEMAND_MODE, &cache->flags);
+			set_bit(CACHEFILES_ONDEMAND_BATCH, &cache->flags);
 		} else if (*args) {
 			pr_err("Invalid argument to the 'bind' command\n");
 			return -EINVAL;
@@ -62,6 +62,7 @@ struct cachefiles_object {
 #define CACHEFILES_OBJECT_USING_TMPFILE	0		/* Have an unlinked tmpfile */
 #ifdef CONFIG_CACHEFILES_ONDEMAND
 	int				ondemand_id;
+	loff_t				ondemand_prefetch_end; /* End of last prefetch hint */
 #endif
 };
 
@@ -106,6 +107,7 @@ struct cachefiles_cache {
 #define CACHEFILES_CULLING		2	/* T if cull engaged */
 #define CACHEFILES_STATE_CHANGED	3	/* T if state changed (poll trigger) */
 #define CACHEFILES_ONDEMAND_MODE	4	/* T if in on-demand read mode */
+#define CACHEFILES_ONDEMAND_BATCH	5	/* T if daemon takes batched reads and hints */
 	char				*rootdirname;	/* name of cache root directory */
 	char				*secctx;	/* LSM security context */
 	char				*tag;		/* cache binding tag */
@@ -126,11 +128,25 @@ struct cachefiles_req {
 	struct cachefiles_object *object;
 	struct completion done;
 	int error;
+	bool nowait;		/* Nobody waits for it, free on completion */
 	struct cachefiles_msg msg;
 };
 
 #define CACHEFILES_REQ_NEW	XA_MARK_1
 
+/*
+ * Finish a request that has been taken off cache->reqs.
+ */
+static inline void cachefiles_req_finish(struct cachefiles_req *req, int error)
+{
+	if (req->nowait) {
+		kfree(req);
+		return;
+	}
+	req->error = error;
+	complete(&req->done);
+}
+
 #include <trace/events/cachefiles.h>
 
 static inline
@@ -28,6 +28,7 @@ struct cachefiles_kiocb {
 	bool			was_async;
 	unsigned int		inval_counter;	/* Copy of cookie->inval_counter */
 	u64			b_writing;
+	ktime_t			issue_time;	/* When the read was issued */
 };
 
 static inline void cachefiles_put_kiocb(struct cachefiles_kiocb *ki)
@@ -52,6 +53,8 @@ static void cachefiles_read_complete(struct kiocb *iocb, long ret)
 	if (ret < 0)
 		trace_cachefiles_io_error(ki->object, inode, ret,
 					  cachefiles_trace_read_error);
+	else
+		fscache_count_read_latency(ki->object->cookie, ki->issue_time);
 
 	if (ki->term_func) {
 		if (ret >= 0) {
@@ -145,6 +148,7 @@ static int cachefiles_read(struct netfs_cache_resources *cres,
 	ki->term_func		= term_func;
 	ki->term_func_priv	= term_func_priv;
 	ki->was_async		= true;
+	ki->issue_time		= ktime_get();
 
 	if (ki->term_func)
 		ki->iocb.ki_complete = cachefiles_read_complete;
@@ -403,6 +407,7 @@ static enum netfs_io_source cachefiles_prepare_read(struct netfs_io_subrequest *
 	enum netfs_io_source ret = NETFS_DOWNLOAD_FROM_SERVER;
 	loff_t off, to;
 	ino_t ino = file ? file_inode(file)->i_ino : 0;
+	bool missed = false;
 	int rc;
 
 	_enter("%zx @%llx/%llx", subreq->len, subreq->start, i_size);
@@ -484,6 +489,8 @@ static enum netfs_io_source cachefiles_prepare_read(struct netfs_io_subrequest *
 	goto out;
 
 download_and_store:
+	/* Data fetched on demand and then read from the cache is a miss too */
+	missed = true;
 	__set_bit(NETFS_SREQ_COPY_TO_CACHE, &subreq->flags);
 	if (test_bit(NETFS_SREQ_ONDEMAND, &subreq->flags)) {
 		rc = cachefiles_ondemand_read(object, subreq->start,
@@ -497,6 +504,8 @@ static enum netfs_io_source cachefiles_prepare_read(struct netfs_io_subrequest *
 out:
 	cachefiles_end_secure(cache, saved_cred);
 out_no_object:
+	if (ret == NETFS_READ_FROM_CACHE || ret == NETFS_DOWNLOAD_FROM_SERVER)
+		fscache_count_lookup(cookie, ret == NETFS_READ_FROM_CACHE && !missed);
 	trace_cachefiles_prep_read(subreq, ret, why, ino);
 	return ret;
 }
@@ -4,6 +4,14 @@
 #include <linux/uio.h>
 #include "internal.h"
 
+/*
+ * Prefetch hint, carrying a struct cachefiles_read.  It has no reply and is
+ * only sent to daemons bound with "ondemand,batch".
+ */
+#ifndef CACHEFILES_OP_PREFETCH
+#define CACHEFILES_OP_PREFETCH	3
+#endif
+
 static int cachefiles_ondemand_fd_release(struct inode *inode,
 					  struct file *file)
 {
@@ -18,14 +26,17 @@ static int cachefiles_ondemand_fd_release(struct inode *inode,
 
 	/*
 	 * Flush all pending READ requests since their completion depends on
-	 * anon_fd.
+	 * anon_fd.  Also drop the prefetch hints the daemon has not picked up
+	 * yet; the ones it is picking up are freed by the daemon read.
 	 */
 	xas_for_each(&xas, req, ULONG_MAX) {
-		if (req->msg.object_id == object_id &&
-		    req->msg.opcode == CACHEFILES_OP_READ) {
-			req->error = -EIO;
-			complete(&req->done);
+		if (req->msg.object_id != object_id)
+			continue;
+		if (req->msg.opcode == CACHEFILES_OP_READ ||
+		    (req->msg.opcode == CACHEFILES_OP_PREFETCH &&
+		     xas_get_mark(&xas, CACHEFILES_REQ_NEW))) {
 			xas_store(&xas, NULL);
+			cachefiles_req_finish(req, -EIO);
 		}
 	}
 	xa_unlock(&cache->reqs);
@@ -234,8 +245,9 @@ static int cachefiles_ondemand_get_fd(struct cachefiles_req *req)
 	return ret;
 }
 
-ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
-					char __user *_buffer, size_t buflen)
+static ssize_t cachefiles_ondemand_daemon_read_one(struct cachefiles_cache *cache,
+						   char __user *_buffer,
+						   size_t buflen)
 {
 	struct cachefiles_req *req;
 	struct cachefiles_msg *msg;
@@ -286,10 +298,11 @@ ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
 		goto err_put_fd;
 	}
 
-	/* CLOSE request has no reply */
-	if (msg->opcode == CACHEFILES_OP_CLOSE) {
+	/* CLOSE request and prefetch hints have no reply */
+	if (msg->opcode == CACHEFILES_OP_CLOSE ||
+	    msg->opcode == CACHEFILES_OP_PREFETCH) {
 		xa_erase(&cache->reqs, id);
-		complete(&req->done);
+		cachefiles_req_finish(req, 0);
 	}
 
 	return n;
@@ -299,11 +312,34 @@ ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
 		close_fd(((struct cachefiles_open *)msg->data)->fd);
 error:
 	xa_erase(&cache->reqs, id);
-	req->error = ret;
-	complete(&req->done);
+	cachefiles_req_finish(req, ret);
 	return ret;
 }
 
+/*
+ * Hand pending requests to the daemon.  A daemon bound in batch mode gets as
+ * many requests as fit into its buffer, one cachefiles_msg after another,
+ * instead of a single one per read.
+ */
+ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
+					char __user *_buffer, size_t buflen)
+{
+	size_t done = 0;
+	ssize_t ret;
+
+	do {
+		ret = cachefiles_ondemand_daemon_read_one(cache,
+							  _buffer + done,
+							  buflen - done);
+		if (ret <= 0)
+			break;
+		done += ret;
+	} while (test_bit(CACHEFILES_ONDEMAND_BATCH, &cache->flags) &&
+		 done < buflen);
+
+	return done ? done : ret;
+}
+
 typedef int (*init_req_fn)(struct cachefiles_req *req, void *private);
 
 static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
@@ -313,6 +349,8 @@ static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
 					void *private)
 {
 	struct cachefiles_cache *cache = object->volume->cache;
+	/* Prefetch hints are not waited for and must not touch the object */
+	bool nowait = opcode == CACHEFILES_OP_PREFETCH;
 	struct cachefiles_req *req;
 	XA_STATE(xas, &cache->reqs, 0);
 	int ret;
@@ -328,6 +366,7 @@ static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
 		return -ENOMEM;
 
 	req->object = object;
+	req->nowait = nowait;
 	init_completion(&req->done);
 	req->msg.opcode = opcode;
 	req->msg.len = sizeof(struct cachefiles_msg) + data_len;
@@ -385,6 +424,9 @@ static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
 		goto out;
 
 	wake_up_all(&cache->daemon_pollwq);
+	/* The daemon may already have completed and freed a nowait request */
+	if (nowait)
+		return 0;
 	wait_for_completion(&req->done);
 	ret = req->error;
 out:
@@ -503,12 +545,43 @@ void cachefiles_ondemand_clean_object(struct cachefiles_object *object)
 			cachefiles_ondemand_init_close_req, NULL);
 }
 
+/*
+ * Hint the daemon to fetch the range following a demand read, so that a
+ * sequential reader finds the next chunk in the cache already.  Ranges that
+ * have been hinted before are not hinted again.
+ */
+static void cachefiles_ondemand_prefetch(struct cachefiles_object *object,
+					 loff_t pos, size_t len)
+{
+	struct cachefiles_cache *cache = object->volume->cache;
+	loff_t end = min(pos + (loff_t)len, object->cookie->object_size);
+	struct cachefiles_read_ctx read_ctx;
+
+	if (!test_bit(CACHEFILES_ONDEMAND_BATCH, &cache->flags))
+		return;
+
+	pos = max(pos, READ_ONCE(object->ondemand_prefetch_end));
+	if (pos >= end)
+		return;
+	WRITE_ONCE(object->ondemand_prefetch_end, end);
+
+	read_ctx.off = pos;
+	read_ctx.len = end - pos;
+	cachefiles_ondemand_send_req(object, CACHEFILES_OP_PREFETCH,
+			sizeof(struct cachefiles_read),
+			cachefiles_ondemand_init_read_req, &read_ctx);
+}
+
 int cachefiles_ondemand_read(struct cachefiles_object *object,
 			     loff_t pos, size_t len)
 {
 	struct cachefiles_read_ctx read_ctx = {pos, len};
+	int ret;
 
-	return cachefiles_ondemand_send_req(object, CACHEFILES_OP_READ,
+	ret = cachefiles_ondemand_send_req(object, CACHEFILES_OP_READ,
 			sizeof(struct cachefiles_read),
 			cachefiles_ondemand_init_read_req, &read_ctx);
+	if (!ret)
+		cachefiles_ondemand_prefetch(object, pos + len, len);
+	return ret;
 }
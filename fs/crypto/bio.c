@@ -47,50 +47,62 @@ bool fscrypt_decrypt_bio(struct bio *bio)
 }
 EXPORT_SYMBOL(fscrypt_decrypt_bio);
 
+/*
+ * With inline encryption the zeroes are encrypted by the block layer, so the
+ * zero page can be written directly.  Build bios that are as large as the DUN
+ * contiguity allows, with one crypto context each, and chain them so that they
+ * are all in flight at once; only the last one is waited for.
+ */
 static int fscrypt_zeroout_range_inline_crypt(const struct inode *inode,
 					      pgoff_t lblk, sector_t pblk,
 					      unsigned int len)
 {
 	const unsigned int blockbits = inode->i_blkbits;
 	const unsigned int blocks_per_page = 1 << (PAGE_SHIFT - blockbits);
-	struct bio *bio;
+	struct bio *bio = NULL;
 	int ret, err = 0;
-	int num_pages = 0;
-
-	/* This always succeeds since __GFP_DIRECT_RECLAIM is set. */
-	bio = bio_alloc(inode->i_sb->s_bdev, BIO_MAX_VECS, REQ_OP_WRITE,
-			GFP_NOFS);
 
-	while (len) {
-		unsigned int blocks_this_page = min(len, blocks_per_page);
-		unsigned int bytes_this_page = blocks_this_page << blockbits;
-
-		if (num_pages == 0) {
-			fscrypt_set_bio_crypt_ctx(bio, inode, lblk, GFP_NOFS);
-			bio->bi_iter.bi_sector =
-					pblk << (blockbits - SECTOR_SHIFT);
-		}
-		ret = bio_add_page(bio, ZERO_PAGE(0), bytes_this_page, 0);
-		if (WARN_ON(ret != bytes_this_page)) {
-			err = -EIO;
-			goto out;
-		}
-		num_pages++;
-		len -= blocks_this_page;
-		lblk += blocks_this_page;
-		pblk += blocks_this_page;
-		if (num_pages == BIO_MAX_VECS || !len ||
-		    !fscrypt_mergeable_bio(bio, inode, lblk)) {
-			err = submit_bio_wait(bio);
-			if (err)
-				goto out;
-			bio_reset(bio, inode->i_sb->s_bdev, REQ_OP_WRITE);
-			num_pages = 0;
+	while (len && !err) {
+		unsigned int nr_blocks = fscrypt_limit_io_blocks(inode, lblk,
+								 len);
+		unsigned int num_pages = 0;
+
+		/* This always succeeds since __GFP_DIRECT_RECLAIM is set. */
+		bio = blk_next_bio(bio, inode->i_sb->s_bdev,
+				   min_t(unsigned int, BIO_MAX_VECS,
+					 DIV_ROUND_UP(nr_blocks,
+						      blocks_per_page)),
+				   REQ_OP_WRITE, GFP_NOFS);
+		fscrypt_set_bio_crypt_ctx(bio, inode, lblk, GFP_NOFS);
+		bio->bi_iter.bi_sector = pblk << (blockbits - SECTOR_SHIFT);
+
+		while (nr_blocks && num_pages < BIO_MAX_VECS) {
+			unsigned int blocks_this_page = min(nr_blocks,
+							    blocks_per_page);
+			unsigned int bytes_this_page =
+					blocks_this_page << blockbits;
+
+			ret = bio_add_page(bio, ZERO_PAGE(0), bytes_this_page,
+					   0);
+			if (WARN_ON(ret != bytes_this_page)) {
+				err = -EIO;
+				break;
+			}
+			num_pages++;
+			nr_blocks -= blocks_this_page;
+			len -= blocks_this_page;
+			lblk += blocks_this_page;
+			pblk += blocks_this_page;
 		}
 	}
-out:
+
+	/*
+	 * Errors of the chained bios are propagated to the last one, which also
+	 * has to be waited for on failure since the earlier ones are in flight.
+	 */
+	ret = submit_bio_wait(bio);
 	bio_put(bio);
-	return err;
+	return err ?: ret;
 }
 
 /**
@@ -142,6 +142,7 @@ static void *z_erofs_lz4_handle_overlap(struct z_erofs_lz4_decompress_ctx *ctx,
 				if (rq->out[j] == rq->in[i])
 					goto docopy;
 		}
+		atomic_long_inc(&EROFS_SB(rq->sb)->lz4_inplace_cnt);
 	}
 
 	if (ctx->inpages <= 1) {
@@ -157,13 +158,21 @@ static void *z_erofs_lz4_handle_overlap(struct z_erofs_lz4_decompress_ctx *ctx,
 	return src;
 
 docopy:
-	/* Or copy compressed data which can be overlapped to per-CPU buffer */
+	/* Or copy compressed data which can be overlapped to a bounce buffer */
+	atomic_long_inc(&EROFS_SB(rq->sb)->lz4_bounce_cnt);
 	in = rq->in;
-	src = erofs_get_pcpubuf(ctx->inpages);
-	if (!src) {
-		DBG_BUGON(1);
-		kunmap_atomic(inpage);
-		return ERR_PTR(-EFAULT);
+	kunmap_atomic(inpage);
+	inpage = NULL;
+	src = erofs_get_bouncebuf(ctx->inpages);
+	if (src) {
+		*maptype = 3;
+	} else {
+		src = erofs_get_pcpubuf(ctx->inpages);
+		if (!src) {
+			DBG_BUGON(1);
+			return ERR_PTR(-EFAULT);
+		}
+		*maptype = 2;
 	}
 
 	tmp = src;
@@ -182,7 +191,6 @@ static void *z_erofs_lz4_handle_overlap(struct z_erofs_lz4_decompress_ctx *ctx,
 		++in;
 		*inputmargin = 0;
 	}
-	*maptype = 2;
 	return src;
 }
 
@@ -266,6 +274,8 @@ static int z_erofs_lz4_decompress_mem(struct z_erofs_lz4_decompress_ctx *ctx,
 		vm_unmap_ram(src, ctx->inpages);
 	} else if (maptype == 2) {
 		erofs_put_pcpubuf(src);
+	} else if (maptype == 3) {
+		erofs_put_bouncebuf(src);
 	} else {
 		DBG_BUGON(1);
 		return -EFAULT;
@@ -132,6 +132,10 @@ struct erofs_sb_info {
 
 	struct erofs_sb_lz4_info lz4;
 	struct inode *packed_inode;
+
+	/* pclusters decompressed in place or via a bounce buffer */
+	atomic_long_t lz4_inplace_cnt;
+	atomic_long_t lz4_bounce_cnt;
 #endif	/* CONFIG_EROFS_FS_ZIP */
 	struct erofs_dev_context *devs;
 	struct dax_device *dax_dev;
@@ -525,7 +529,9 @@ static inline void *erofs_vm_map_ram(struct page **pages, unsigned int count)
 void *erofs_get_pcpubuf(unsigned int requiredpages);
 void erofs_put_pcpubuf(void *ptr);
 int erofs_pcpubuf_growsize(unsigned int nrpages);
-void erofs_pcpubuf_init(void);
+void *erofs_get_bouncebuf(unsigned int requiredpages);
+void erofs_put_bouncebuf(void *ptr);
+int erofs_pcpubuf_init(void);
 void erofs_pcpubuf_exit(void);
 
 /* sysfs.c */
@@ -5,7 +5,7 @@
  * For low-latency decompression algorithms (e.g. lz4), reserve consecutive
  * per-CPU virtual memory (in pages) in advance to store such inplace I/O
  * data if inplace decompression is failed (due to unmet inplace margin for
- * example).
+ * example), and keep a pool of physically contiguous bounce buffers.
  */
 #include "internal.h"
 
@@ -18,6 +18,95 @@ struct erofs_pcpubuf {
 
 static DEFINE_PER_CPU(struct erofs_pcpubuf, erofs_pcb);
 
+/*
+ * Besides the per-CPU buffers, keep a global pool of physically contiguous
+ * bounce buffers. They are taken in sleepable context, so unlike the per-CPU
+ * buffers decompression doesn't need to run with preemption disabled, and
+ * they are sized by the pcluster at hand instead of the largest pcluster of
+ * all mounted filesystems. Idle buffers are given back by a shrinker; the
+ * per-CPU buffers remain as the fallback if no high-order page is available.
+ */
+#define EROFS_BOUNCEBUF_MIN_ORDER	2
+
+static DEFINE_SPINLOCK(erofs_bouncebuf_lock);
+static LIST_HEAD(erofs_bouncebuf_list);
+static unsigned long erofs_bouncebuf_nrpages;
+static unsigned int erofs_bouncebuf_nrbufs;
+
+void *erofs_get_bouncebuf(unsigned int requiredpages)
+{
+	unsigned int order = max_t(unsigned int, EROFS_BOUNCEBUF_MIN_ORDER,
+				   get_order(requiredpages << PAGE_SHIFT));
+	struct page *page;
+
+	might_sleep();
+	spin_lock(&erofs_bouncebuf_lock);
+	list_for_each_entry(page, &erofs_bouncebuf_list, lru) {
+		if (compound_order(page) < order)
+			continue;
+		list_del(&page->lru);
+		erofs_bouncebuf_nrpages -= 1UL << compound_order(page);
+		--erofs_bouncebuf_nrbufs;
+		spin_unlock(&erofs_bouncebuf_lock);
+		return page_address(page);
+	}
+	spin_unlock(&erofs_bouncebuf_lock);
+
+	page = alloc_pages(GFP_NOFS | __GFP_COMP | __GFP_NOWARN |
+			   __GFP_NORETRY, order);
+	return page ? page_address(page) : NULL;
+}
+
+void erofs_put_bouncebuf(void *ptr)
+{
+	struct page *page = virt_to_head_page(ptr);
+
+	spin_lock(&erofs_bouncebuf_lock);
+	/* no need to keep more buffers than CPUs that could use them */
+	if (erofs_bouncebuf_nrbufs < num_online_cpus()) {
+		list_add(&page->lru, &erofs_bouncebuf_list);
+		erofs_bouncebuf_nrpages += 1UL << compound_order(page);
+		++erofs_bouncebuf_nrbufs;
+		page = NULL;
+	}
+	spin_unlock(&erofs_bouncebuf_lock);
+
+	if (page)
+		__free_pages(page, compound_order(page));
+}
+
+static unsigned long erofs_bouncebuf_count(struct shrinker *shrink,
+					   struct shrink_control *sc)
+{
+	return READ_ONCE(erofs_bouncebuf_nrpages) ?: SHRINK_EMPTY;
+}
+
+static unsigned long erofs_bouncebuf_scan(struct shrinker *shrink,
+					  struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	struct page *page;
+
+	spin_lock(&erofs_bouncebuf_lock);
+	while (freed < sc->nr_to_scan && !list_empty(&erofs_bouncebuf_list)) {
+		page = list_first_entry(&erofs_bouncebuf_list,
+					struct page, lru);
+		list_del(&page->lru);
+		erofs_bouncebuf_nrpages -= 1UL << compound_order(page);
+		--erofs_bouncebuf_nrbufs;
+		freed += 1UL << compound_order(page);
+		__free_pages(page, compound_order(page));
+	}
+	spin_unlock(&erofs_bouncebuf_lock);
+	return freed ?: SHRINK_STOP;
+}
+
+static struct shrinker erofs_bouncebuf_shrinker = {
+	.scan_objects = erofs_bouncebuf_scan,
+	.count_objects = erofs_bouncebuf_count,
+	.seeks = DEFAULT_SEEKS,
+};
+
 void *erofs_get_pcpubuf(unsigned int requiredpages)
 	__acquires(pcb->lock)
 {
@@ -114,7 +203,7 @@ int erofs_pcpubuf_growsize(unsigned int nrpages)
 	return ret;
 }
 
-void erofs_pcpubuf_init(void)
+int erofs_pcpubuf_init(void)
 {
 	int cpu;
 
@@ -123,12 +212,22 @@ void erofs_pcpubuf_init(void)
 
 		raw_spin_lock_init(&pcb->lock);
 	}
+	return register_shrinker(&erofs_bouncebuf_shrinker,
+				 "erofs-bouncebuf");
 }
 
 void erofs_pcpubuf_exit(void)
 {
+	struct page *page, *n;
 	int cpu, i;
 
+	unregister_shrinker(&erofs_bouncebuf_shrinker);
+	list_for_each_entry_safe(page, n, &erofs_bouncebuf_list, lru)
+		__free_pages(page, compound_order(page));
+	INIT_LIST_HEAD(&erofs_bouncebuf_list);
+	erofs_bouncebuf_nrpages = 0;
+	erofs_bouncebuf_nrbufs = 0;
+
 	for_each_possible_cpu(cpu) {
 		struct erofs_pcpubuf *pcb = &per_cpu(erofs_pcb, cpu);
 
@@ -1000,7 +1000,10 @@ static int __init erofs_module_init(void)
 	if (err)
 		goto lzma_err;
 
-	erofs_pcpubuf_init();
+	err = erofs_pcpubuf_init();
+	if (err)
+		goto pcpubuf_err;
+
 	err = z_erofs_init_zip_subsystem();
 	if (err)
 		goto zip_err;
@@ -1020,6 +1023,8 @@ static int __init erofs_module_init(void)
 sysfs_err:
 	z_erofs_exit_zip_subsystem();
 zip_err:
+	erofs_pcpubuf_exit();
+pcpubuf_err:
 	z_erofs_lzma_exit();
 lzma_err:
 	erofs_exit_shrinker();
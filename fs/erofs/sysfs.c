@@ -12,6 +12,7 @@ enum {
 	attr_feature,
 	attr_pointer_ui,
 	attr_pointer_bool,
+	attr_pointer_atomic_long,
 };
 
 enum {
@@ -53,15 +54,22 @@ static struct erofs_attr erofs_attr_##_name = {			\
 #define EROFS_ATTR_RW_BOOL(_name, _struct)	\
 	EROFS_ATTR_RW(_name, pointer_bool, _struct)
 
+#define EROFS_RO_ATTR_ATOMIC_LONG(_name, _struct)	\
+	EROFS_RO_ATTR(_name, pointer_atomic_long, _struct)
+
 #define ATTR_LIST(name) (&erofs_attr_##name.attr)
 
 #ifdef CONFIG_EROFS_FS_ZIP
 EROFS_ATTR_RW_UI(sync_decompress, erofs_mount_opts);
+EROFS_RO_ATTR_ATOMIC_LONG(lz4_inplace_cnt, erofs_sb_info);
+EROFS_RO_ATTR_ATOMIC_LONG(lz4_bounce_cnt, erofs_sb_info);
 #endif
 
 static struct attribute *erofs_attrs[] = {
 #ifdef CONFIG_EROFS_FS_ZIP
 	ATTR_LIST(sync_decompress),
+	ATTR_LIST(lz4_inplace_cnt),
+	ATTR_LIST(lz4_bounce_cnt),
 #endif
 	NULL,
 };
@@ -123,6 +131,11 @@ static ssize_t erofs_attr_show(struct kobject *kobj,
 		if (!ptr)
 			return 0;
 		return sysfs_emit(buf, "%d\n", *(bool *)ptr);
+	case attr_pointer_atomic_long:
+		if (!ptr)
+			return 0;
+		return sysfs_emit(buf, "%ld\n",
+				  atomic_long_read((atomic_long_t *)ptr));
 	}
 	return 0;
 }
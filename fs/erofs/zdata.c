@@ -6,6 +6,7 @@
  */
 #include "zdata.h"
 #include "compress.h"
+#include <linux/cpuhotplug.h>
 #include <linux/prefetch.h>
 #include <linux/psi.h>
 
@@ -196,8 +197,146 @@ typedef tagptr1_t compressed_page_t;
 
 static struct workqueue_struct *z_erofs_workqueue __read_mostly;
 
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+static struct kthread_worker __rcu **z_erofs_pcpu_workers;
+
+static void erofs_destroy_percpu_workers(void)
+{
+	struct kthread_worker *worker;
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		worker = rcu_dereference_protected(
+					z_erofs_pcpu_workers[cpu], 1);
+		rcu_assign_pointer(z_erofs_pcpu_workers[cpu], NULL);
+		if (worker)
+			kthread_destroy_worker(worker);
+	}
+	kfree(z_erofs_pcpu_workers);
+}
+
+static struct kthread_worker *erofs_init_percpu_worker(int cpu)
+{
+	struct kthread_worker *worker =
+		kthread_create_worker_on_cpu(cpu, 0, "erofs_worker/%u", cpu);
+
+	if (IS_ERR(worker))
+		return worker;
+	if (IS_ENABLED(CONFIG_EROFS_FS_PCPU_KTHREAD_HIPRI))
+		sched_set_fifo_low(worker->task);
+	else
+		sched_set_normal(worker->task, 0);
+	return worker;
+}
+
+static int erofs_init_percpu_workers(void)
+{
+	struct kthread_worker *worker;
+	unsigned int cpu;
+
+	z_erofs_pcpu_workers = kcalloc(nr_cpu_ids,
+			sizeof(struct kthread_worker *), GFP_KERNEL);
+	if (!z_erofs_pcpu_workers)
+		return -ENOMEM;
+
+	/* a CPU without a worker falls back to the workqueue */
+	for_each_online_cpu(cpu) {
+		worker = erofs_init_percpu_worker(cpu);
+		if (!IS_ERR(worker))
+			rcu_assign_pointer(z_erofs_pcpu_workers[cpu], worker);
+	}
+	return 0;
+}
+
+#ifdef CONFIG_HOTPLUG_CPU
+static DEFINE_SPINLOCK(z_erofs_pcpu_worker_lock);
+static enum cpuhp_state erofs_cpuhp_state;
+
+static int erofs_cpu_online(unsigned int cpu)
+{
+	struct kthread_worker *worker, *old;
+
+	worker = erofs_init_percpu_worker(cpu);
+	if (IS_ERR(worker))
+		return PTR_ERR(worker);
+
+	spin_lock(&z_erofs_pcpu_worker_lock);
+	old = rcu_dereference_protected(z_erofs_pcpu_workers[cpu],
+			lockdep_is_held(&z_erofs_pcpu_worker_lock));
+	if (!old)
+		rcu_assign_pointer(z_erofs_pcpu_workers[cpu], worker);
+	spin_unlock(&z_erofs_pcpu_worker_lock);
+	if (old)
+		kthread_destroy_worker(worker);
+	return 0;
+}
+
+static int erofs_cpu_offline(unsigned int cpu)
+{
+	struct kthread_worker *worker;
+
+	spin_lock(&z_erofs_pcpu_worker_lock);
+	worker = rcu_dereference_protected(z_erofs_pcpu_workers[cpu],
+			lockdep_is_held(&z_erofs_pcpu_worker_lock));
+	rcu_assign_pointer(z_erofs_pcpu_workers[cpu], NULL);
+	spin_unlock(&z_erofs_pcpu_worker_lock);
+
+	synchronize_rcu();
+	if (worker)
+		kthread_destroy_worker(worker);
+	return 0;
+}
+
+static int erofs_cpu_hotplug_init(void)
+{
+	int state;
+
+	state = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN,
+			"fs/erofs:online", erofs_cpu_online, erofs_cpu_offline);
+	if (state < 0)
+		return state;
+
+	erofs_cpuhp_state = state;
+	return 0;
+}
+
+static void erofs_cpu_hotplug_destroy(void)
+{
+	if (erofs_cpuhp_state)
+		cpuhp_remove_state_nocalls(erofs_cpuhp_state);
+}
+#else /* !CONFIG_HOTPLUG_CPU */
+static inline int erofs_cpu_hotplug_init(void) { return 0; }
+static inline void erofs_cpu_hotplug_destroy(void) {}
+#endif
+
+static void z_erofs_destroy_pcpu_workers(void)
+{
+	erofs_cpu_hotplug_destroy();
+	erofs_destroy_percpu_workers();
+}
+
+static int z_erofs_init_pcpu_workers(void)
+{
+	int err;
+
+	err = erofs_init_percpu_workers();
+	if (err)
+		return err;
+
+	err = erofs_cpu_hotplug_init();
+	if (err)
+		erofs_destroy_percpu_workers();
+	return err;
+}
+#else /* !CONFIG_EROFS_FS_PCPU_KTHREAD */
+static inline void z_erofs_destroy_pcpu_workers(void) {}
+static inline int z_erofs_init_pcpu_workers(void) { return 0; }
+#endif
+
 void z_erofs_exit_zip_subsystem(void)
 {
+	z_erofs_destroy_pcpu_workers();
 	destroy_workqueue(z_erofs_workqueue);
 	z_erofs_destroy_pcluster_pool();
 }
@@ -224,7 +363,17 @@ int __init z_erofs_init_zip_subsystem(void)
 		return err;
 	err = z_erofs_init_workqueue();
 	if (err)
-		z_erofs_destroy_pcluster_pool();
+		goto out_error_workqueue_init;
+
+	err = z_erofs_init_pcpu_workers();
+	if (err)
+		goto out_error_pcpu_worker;
+	return 0;
+
+out_error_pcpu_worker:
+	destroy_workqueue(z_erofs_workqueue);
+out_error_workqueue_init:
+	z_erofs_destroy_pcluster_pool();
 	return err;
 }
 
@@ -1167,6 +1316,104 @@ static void z_erofs_decompressqueue_work(struct work_struct *work)
 	kvfree(bgq);
 }
 
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+/* the minimal number of pclusters worth handing over to another CPU */
+#define Z_EROFS_FANOUT_MIN_PCLUSTERS	4
+
+static void z_erofs_decompressqueue_kthread_work(struct kthread_work *work)
+{
+	struct z_erofs_decompressqueue *bgq =
+		container_of(work, struct z_erofs_decompressqueue,
+			     u.kthread_work);
+
+	z_erofs_decompressqueue_work(&bgq->u.work);
+}
+
+static void z_erofs_queue_part(struct z_erofs_decompressqueue *q,
+			       unsigned int *cpu)
+{
+	struct kthread_worker *worker;
+
+	*cpu = cpumask_next(*cpu, cpu_online_mask);
+	if (*cpu >= nr_cpu_ids)
+		*cpu = cpumask_first(cpu_online_mask);
+
+	rcu_read_lock();
+	worker = rcu_dereference(z_erofs_pcpu_workers[*cpu]);
+	if (!worker) {
+		INIT_WORK(&q->u.work, z_erofs_decompressqueue_work);
+		queue_work(z_erofs_workqueue, &q->u.work);
+	} else {
+		kthread_init_work(&q->u.kthread_work,
+				  z_erofs_decompressqueue_kthread_work);
+		kthread_queue_work(worker, &q->u.kthread_work);
+	}
+	rcu_read_unlock();
+}
+
+/*
+ * Split a long chain of pclusters into parts and hand all but the first one
+ * over to the workers of other online CPUs, so that the decompression of a
+ * large readahead window is not bound by a single core. Pclusters are
+ * independent of each other; the chain is only cut by replacing the next
+ * pointer of the last pcluster of a part with Z_EROFS_PCLUSTER_TAIL_CLOSED,
+ * which nobody else can claim.
+ */
+static void z_erofs_fanout_queue(struct z_erofs_decompressqueue *io)
+{
+	struct z_erofs_decompressqueue *q, *prev = NULL;
+	unsigned int nr = 0, nr_parts, per_part, i = 0;
+	unsigned int cpu = raw_smp_processor_id();
+	z_erofs_next_pcluster_t owned = io->head;
+	struct z_erofs_pcluster *pcl;
+
+	while (owned != Z_EROFS_PCLUSTER_TAIL_CLOSED) {
+		pcl = container_of(owned, struct z_erofs_pcluster, next);
+		owned = READ_ONCE(pcl->next);
+		++nr;
+	}
+
+	nr_parts = min(nr / Z_EROFS_FANOUT_MIN_PCLUSTERS, num_online_cpus());
+	if (nr_parts <= 1)
+		return;
+	per_part = DIV_ROUND_UP(nr, nr_parts);
+
+	owned = io->head;
+	while (owned != Z_EROFS_PCLUSTER_TAIL_CLOSED) {
+		pcl = container_of(owned, struct z_erofs_pcluster, next);
+		owned = READ_ONCE(pcl->next);
+		if (++i < per_part || owned == Z_EROFS_PCLUSTER_TAIL_CLOSED)
+			continue;
+
+		q = kvzalloc(sizeof(*q), GFP_KERNEL | __GFP_NOWARN);
+		if (!q)
+			break;
+		q->sb = io->sb;
+		q->eio = io->eio;
+		q->head = owned;
+		WRITE_ONCE(pcl->next, Z_EROFS_PCLUSTER_TAIL_CLOSED);
+
+		/* the previous part is complete now that it has been cut */
+		if (prev)
+			z_erofs_queue_part(prev, &cpu);
+		prev = q;
+		i = 0;
+	}
+	if (prev)
+		z_erofs_queue_part(prev, &cpu);
+}
+
+static void z_erofs_decompressqueue_fanout_work(struct kthread_work *work)
+{
+	struct z_erofs_decompressqueue *bgq =
+		container_of(work, struct z_erofs_decompressqueue,
+			     u.kthread_work);
+
+	z_erofs_fanout_queue(bgq);
+	z_erofs_decompressqueue_work(&bgq->u.work);
+}
+#endif
+
 static void z_erofs_decompress_kickoff(struct z_erofs_decompressqueue *io,
 				       bool sync, int bios)
 {
@@ -1183,7 +1430,22 @@ static void z_erofs_decompress_kickoff(struct z_erofs_decompressqueue *io,
 		return;
 	/* Use workqueue and sync decompression for atomic contexts only */
 	if (in_atomic() || irqs_disabled()) {
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+		struct kthread_worker *worker;
+
+		rcu_read_lock();
+		worker = rcu_dereference(
+				z_erofs_pcpu_workers[raw_smp_processor_id()]);
+		if (!worker) {
+			INIT_WORK(&io->u.work, z_erofs_decompressqueue_work);
+			queue_work(z_erofs_workqueue, &io->u.work);
+		} else {
+			kthread_queue_work(worker, &io->u.kthread_work);
+		}
+		rcu_read_unlock();
+#else
 		queue_work(z_erofs_workqueue, &io->u.work);
+#endif
 		/* enable sync decompression for readahead */
 		if (sbi->opt.sync_decompress == EROFS_SYNC_DECOMPRESS_AUTO)
 			sbi->opt.sync_decompress = EROFS_SYNC_DECOMPRESS_FORCE_ON;
@@ -1317,7 +1579,12 @@ jobqueue_init(struct super_block *sb,
 			*fg = true;
 			goto fg_out;
 		}
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+		kthread_init_work(&q->u.kthread_work,
+				  z_erofs_decompressqueue_fanout_work);
+#else
 		INIT_WORK(&q->u.work, z_erofs_decompressqueue_work);
+#endif
 	} else {
 fg_out:
 		q = fgq;
@@ -1169,4 +1169,33 @@ const struct seq_operations fscache_cookies_seq_ops = {
 	.stop   = fscache_cookies_seq_stop,
 	.show   = fscache_cookies_seq_show,
 };
+
+#ifdef CONFIG_FSCACHE_STATS
+/*
+ * Generate a list of the I/O statistics of the cookies in
+ * /proc/fs/fscache/cookie_stats
+ */
+static int fscache_cookie_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct fscache_cookie *cookie;
+
+	if (v == &fscache_cookies) {
+		seq_puts(m, "COOKIE   VOLUME   " FSCACHE_IO_STATS_HEADER "\n");
+		return 0;
+	}
+
+	cookie = list_entry(v, struct fscache_cookie, proc_link);
+	seq_printf(m, "%08x %08x ", cookie->debug_id, cookie->volume->debug_id);
+	fscache_io_stats_show(m, &cookie->io_stats);
+	seq_putc(m, '\n');
+	return 0;
+}
+
+const struct seq_operations fscache_cookie_stats_seq_ops = {
+	.start  = fscache_cookies_seq_start,
+	.next   = fscache_cookies_seq_next,
+	.stop   = fscache_cookies_seq_stop,
+	.show   = fscache_cookie_stats_seq_show,
+};
+#endif /* CONFIG_FSCACHE_STATS */
 #endif
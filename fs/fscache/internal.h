@@ -129,6 +129,11 @@ static inline void fscache_stat_d(atomic_t *stat)
 #define __fscache_stat(stat) (stat)
 
 int fscache_stats_show(struct seq_file *m, void *v);
+void fscache_io_stats_show(struct seq_file *m, struct fscache_io_stats *st);
+#define FSCACHE_IO_STATS_HEADER \
+	"HITS     MISSES   READ LATENCY (<1 1 2 4 ... 16384+ us)"
+extern const struct seq_operations fscache_cookie_stats_seq_ops;
+extern const struct seq_operations fscache_volume_stats_seq_ops;
 #else
 
 #define __fscache_stat(stat) (NULL)
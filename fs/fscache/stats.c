@@ -49,6 +49,20 @@ EXPORT_SYMBOL(fscache_n_no_create_space);
 atomic_t fscache_n_culled;
 EXPORT_SYMBOL(fscache_n_culled);
 
+/*
+ * display the I/O statistics of a volume or a cookie
+ */
+void fscache_io_stats_show(struct seq_file *m, struct fscache_io_stats *st)
+{
+	int i;
+
+	seq_printf(m, "%8u %8u",
+		   atomic_read(&st->hits),
+		   atomic_read(&st->misses));
+	for (i = 0; i < FSCACHE_IO_LAT_BUCKETS; i++)
+		seq_printf(m, " %u", atomic_read(&st->read_lat[i]));
+}
+
 /*
  * display the general statistics
  */
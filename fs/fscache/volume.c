@@ -514,4 +514,33 @@ const struct seq_operations fscache_volumes_seq_ops = {
 	.stop   = fscache_volumes_seq_stop,
 	.show   = fscache_volumes_seq_show,
 };
+
+#ifdef CONFIG_FSCACHE_STATS
+/*
+ * Generate a list of the I/O statistics of the volumes in
+ * /proc/fs/fscache/volume_stats
+ */
+static int fscache_volume_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct fscache_volume *volume;
+
+	if (v == &fscache_volumes) {
+		seq_puts(m, "VOLUME   " FSCACHE_IO_STATS_HEADER " KEY\n");
+		return 0;
+	}
+
+	volume = list_entry(v, struct fscache_volume, proc_link);
+	seq_printf(m, "%08x ", volume->debug_id);
+	fscache_io_stats_show(m, &volume->io_stats);
+	seq_printf(m, " %s\n", volume->key + 1);
+	return 0;
+}
+
+const struct seq_operations fscache_volume_stats_seq_ops = {
+	.start  = fscache_volumes_seq_start,
+	.next   = fscache_volumes_seq_next,
+	.stop   = fscache_volumes_seq_stop,
+	.show   = fscache_volume_stats_seq_show,
+};
+#endif /* CONFIG_FSCACHE_STATS */
 #endif /* CONFIG_PROC_FS */
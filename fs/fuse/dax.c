@@ -57,6 +57,9 @@ struct fuse_dax_mapping {
 
 	/* reference count when the mapping is used by dax iomap. */
 	refcount_t refcnt;
+
+	/* Set on every access, cleared when the reclaim clock passes by */
+	bool referenced;
 };
 
 /* Per-inode dax map */
@@ -418,6 +421,8 @@ static void fuse_fill_iomap(struct inode *inode, loff_t pos, loff_t length,
 		 * shared/exclusive.
 		 */
 		refcount_inc(&dmap->refcnt);
+		if (!READ_ONCE(dmap->referenced))
+			WRITE_ONCE(dmap->referenced, true);
 
 		/* iomap->private should be NULL */
 		WARN_ON_ONCE(iomap->private);
@@ -918,13 +923,14 @@ static int reclaim_one_dmap_locked(struct inode *inode,
 	return 0;
 }
 
-/* Find first mapped dmap for an inode and return file offset. Caller needs
- * to hold fi->dax->sem lock either shared or exclusive.
+/* Find a mapped dmap of an inode to reclaim. Prefer the first one which was
+ * not accessed since the last scan, fall back to the first idle one. Caller
+ * needs to hold fi->dax->sem lock either shared or exclusive.
  */
 static struct fuse_dax_mapping *inode_lookup_first_dmap(struct inode *inode)
 {
 	struct fuse_inode *fi = get_fuse_inode(inode);
-	struct fuse_dax_mapping *dmap;
+	struct fuse_dax_mapping *dmap, *idle = NULL;
 	struct interval_tree_node *node;
 
 	for (node = interval_tree_iter_first(&fi->dax->tree, 0, -1); node;
@@ -934,10 +940,15 @@ static struct fuse_dax_mapping *inode_lookup_first_dmap(struct inode *inode)
 		if (refcount_read(&dmap->refcnt) > 1)
 			continue;
 
-		return dmap;
+		if (!READ_ONCE(dmap->referenced))
+			return dmap;
+
+		WRITE_ONCE(dmap->referenced, false);
+		if (!idle)
+			idle = dmap;
 	}
 
-	return NULL;
+	return idle;
 }
 
 /*
@@ -1068,85 +1079,140 @@ alloc_dax_mapping_reclaim(struct fuse_conn_dax *fcd, struct inode *inode)
 	}
 }
 
-static int lookup_and_reclaim_dmap_locked(struct fuse_conn_dax *fcd,
-					  struct inode *inode,
-					  unsigned long start_idx)
+/*
+ * Reclaim the ranges of an inode starting at the file indexes in @idx and
+ * remove all their mappings with a single FUSE_REMOVEMAPPING request. Ranges
+ * which went away or got busy in the meantime are skipped.
+ */
+static int lookup_and_reclaim_dmaps_locked(struct fuse_conn_dax *fcd,
+					   struct inode *inode,
+					   unsigned long *idx, unsigned int nr)
 {
-	int ret;
 	struct fuse_inode *fi = get_fuse_inode(inode);
-	struct fuse_dax_mapping *dmap;
+	struct fuse_dax_mapping *dmap, *n;
 	struct interval_tree_node *node;
+	LIST_HEAD(to_remove);
+	unsigned int i, num = 0;
+	int ret = 0, err;
 
-	/* Find fuse dax mapping at file offset inode. */
-	node = interval_tree_iter_first(&fi->dax->tree, start_idx, start_idx);
+	for (i = 0; i < nr; i++) {
+		/* Find fuse dax mapping at file offset inode. */
+		node = interval_tree_iter_first(&fi->dax->tree, idx[i], idx[i]);
 
-	/* Range already got cleaned up by somebody else */
-	if (!node)
-		return 0;
-	dmap = node_to_dmap(node);
+		/* Range already got cleaned up by somebody else */
+		if (!node)
+			continue;
+		dmap = node_to_dmap(node);
 
-	/* still in use. */
-	if (refcount_read(&dmap->refcnt) > 1)
-		return 0;
+		/* still in use. */
+		if (refcount_read(&dmap->refcnt) > 1)
+			continue;
 
-	ret = reclaim_one_dmap_locked(inode, dmap);
-	if (ret < 0)
+		ret = dmap_writeback_invalidate(inode, dmap);
+		if (ret)
+			break;
+
+		/* Remove dax mapping from inode interval tree now */
+		interval_tree_remove(&dmap->itn, &fi->dax->tree);
+		fi->dax->nr--;
+		list_add_tail(&dmap->list, &to_remove);
+		num++;
+	}
+
+	if (!num)
 		return ret;
 
-	/* Cleanup dmap entry and add back to free list */
+	/* It is possible that umount/shutdown has killed the fuse connection
+	 * and worker thread is trying to reclaim memory in parallel.  Don't
+	 * warn in that case.
+	 */
+	err = dmap_removemapping_list(inode, num, &to_remove);
+	if (err && err != -ENOTCONN)
+		pr_warn("Failed to remove %u mappings. ret=%d\n", num, err);
+
+	/* Cleanup dmap entries and add back to free list */
 	spin_lock(&fcd->lock);
-	dmap_reinit_add_to_free_pool(fcd, dmap);
+	list_for_each_entry_safe(dmap, n, &to_remove, list) {
+		list_del_init(&dmap->list);
+		dmap_reinit_add_to_free_pool(fcd, dmap);
+	}
 	spin_unlock(&fcd->lock);
 	return ret;
 }
 
 /*
- * Free a range of memory.
+ * Free ranges of memory of one inode.
  * Locking:
  * 1. Take mapping->invalidate_lock to block dax faults.
  * 2. Take fi->dax->sem to protect interval tree and also to make sure
  *    read/write can not reuse a dmap which we might be freeing.
  */
-static int lookup_and_reclaim_dmap(struct fuse_conn_dax *fcd,
-				   struct inode *inode,
-				   unsigned long start_idx,
-				   unsigned long end_idx)
+static int lookup_and_reclaim_dmaps(struct fuse_conn_dax *fcd,
+				    struct inode *inode,
+				    unsigned long *idx, unsigned int nr)
 {
-	int ret;
+	int ret = 0;
 	struct fuse_inode *fi = get_fuse_inode(inode);
-	loff_t dmap_start = start_idx << FUSE_DAX_SHIFT;
-	loff_t dmap_end = (dmap_start + FUSE_DAX_SZ) - 1;
+	loff_t dmap_start;
+	unsigned int i;
 
 	filemap_invalidate_lock(inode->i_mapping);
-	ret = fuse_dax_break_layouts(inode, dmap_start, dmap_end);
-	if (ret) {
-		pr_debug("virtio_fs: fuse_dax_break_layouts() failed. err=%d\n",
-			 ret);
-		goto out_mmap_sem;
+	for (i = 0; i < nr; i++) {
+		dmap_start = (loff_t)idx[i] << FUSE_DAX_SHIFT;
+		ret = fuse_dax_break_layouts(inode, dmap_start,
+					     dmap_start + FUSE_DAX_SZ - 1);
+		if (ret) {
+			pr_debug("virtio_fs: fuse_dax_break_layouts() failed. err=%d\n",
+				 ret);
+			goto out_mmap_sem;
+		}
 	}
 
 	down_write(&fi->dax->sem);
-	ret = lookup_and_reclaim_dmap_locked(fcd, inode, start_idx);
+	ret = lookup_and_reclaim_dmaps_locked(fcd, inode, idx, nr);
 	up_write(&fi->dax->sem);
 out_mmap_sem:
 	filemap_invalidate_unlock(inode->i_mapping);
 	return ret;
 }
 
+/*
+ * Second chance (CLOCK) check of the reclaim hand passing a busy range.
+ * A range which was accessed since the hand last passed gets its referenced
+ * bit cleared and is moved to the tail of the busy list, and is only
+ * reclaimed if it stays idle until the hand comes back. Returns true if the
+ * range can be reclaimed. Called with fcd->lock held.
+ */
+static bool dmap_clock_expired(struct fuse_conn_dax *fcd,
+			       struct fuse_dax_mapping *dmap)
+{
+	/* skip this range if it's in use. */
+	if (refcount_read(&dmap->refcnt) > 1)
+		return false;
+
+	if (READ_ONCE(dmap->referenced)) {
+		WRITE_ONCE(dmap->referenced, false);
+		list_move_tail(&dmap->busy_list, &fcd->busy_ranges);
+		return false;
+	}
+
+	return true;
+}
+
 static int try_to_free_dmap_chunks(struct fuse_conn_dax *fcd,
 				   unsigned long nr_to_free)
 {
-	struct fuse_dax_mapping *dmap, *pos, *temp;
-	int ret, nr_freed = 0;
-	unsigned long start_idx = 0, end_idx = 0;
-	struct inode *inode = NULL;
-
-	/* Pick first busy range and free it for now*/
-	while (1) {
-		if (nr_freed >= nr_to_free)
-			break;
+	struct fuse_dax_mapping *victims[FUSE_DAX_RECLAIM_CHUNK];
+	unsigned long idx[FUSE_DAX_RECLAIM_CHUNK];
+	struct fuse_dax_mapping *pos, *temp;
+	unsigned long nr_freed = 0, scan;
+	struct inode *inode;
+	unsigned int i, nr;
+	int ret;
 
-		dmap = NULL;
+	while (nr_freed < nr_to_free) {
+		inode = NULL;
+		nr = 0;
 		spin_lock(&fcd->lock);
 
 		if (!fcd->nr_busy_ranges) {
@@ -1154,39 +1220,55 @@ static int try_to_free_dmap_chunks(struct fuse_conn_dax *fcd,
 			return 0;
 		}
 
+		/*
+		 * Two revolutions of the clock hand are enough to find every
+		 * idle range. Collect the victims of the first inode found so
+		 * that they can be removed with a single request.
+		 */
+		scan = 2 * fcd->nr_busy_ranges;
 		list_for_each_entry_safe(pos, temp, &fcd->busy_ranges,
-						busy_list) {
-			/* skip this range if it's in use. */
-			if (refcount_read(&pos->refcnt) > 1)
+					 busy_list) {
+			if (!scan--)
+				break;
+			if (!dmap_clock_expired(fcd, pos))
 				continue;
 
-			inode = igrab(pos->inode);
-			/*
-			 * This inode is going away. That will free
-			 * up all the ranges anyway, continue to
-			 * next range.
-			 */
-			if (!inode)
+			if (!inode) {
+				inode = igrab(pos->inode);
+				/*
+				 * This inode is going away. That will free
+				 * up all the ranges anyway, continue to
+				 * next range.
+				 */
+				if (!inode)
+					continue;
+			} else if (pos->inode != inode) {
 				continue;
-			/*
-			 * Take this element off list and add it tail. If
-			 * this element can't be freed, it will help with
-			 * selecting new element in next iteration of loop.
-			 */
-			dmap = pos;
-			list_move_tail(&dmap->busy_list, &fcd->busy_ranges);
-			start_idx = end_idx = dmap->itn.start;
-			break;
+			}
+
+			victims[nr] = pos;
+			idx[nr++] = pos->itn.start;
+			if (nr == ARRAY_SIZE(idx) ||
+			    nr_freed + nr >= nr_to_free)
+				break;
 		}
+
+		/*
+		 * Move the victims to the tail. If they can't be freed, it
+		 * will help with selecting new ranges in next iteration.
+		 */
+		for (i = 0; i < nr; i++)
+			list_move_tail(&victims[i]->busy_list,
+				       &fcd->busy_ranges);
 		spin_unlock(&fcd->lock);
-		if (!dmap)
+		if (!inode)
 			return 0;
 
-		ret = lookup_and_reclaim_dmap(fcd, inode, start_idx, end_idx);
+		ret = lookup_and_reclaim_dmaps(fcd, inode, idx, nr);
 		iput(inode);
 		if (ret)
 			return ret;
-		nr_freed++;
+		nr_freed += nr;
 	}
 	return 0;
 }
@@ -21,6 +21,8 @@
 #include <linux/swap.h>
 #include <linux/splice.h>
 #include <linux/sched.h>
+#include <linux/percpu.h>
+#include <linux/io_uring.h>
 
 MODULE_ALIAS_MISCDEV(FUSE_MINOR);
 MODULE_ALIAS("devname:fuse");
@@ -194,8 +196,7 @@ EXPORT_SYMBOL_GPL(fuse_len_args);
 
 u64 fuse_get_unique(struct fuse_iqueue *fiq)
 {
-	fiq->reqctr += FUSE_REQ_ID_STEP;
-	return fiq->reqctr;
+	return atomic64_add_return(FUSE_REQ_ID_STEP, &fiq->reqctr);
 }
 EXPORT_SYMBOL_GPL(fuse_get_unique);
 
@@ -204,6 +205,18 @@ static unsigned int fuse_req_hash(u64 unique)
 	return hash_long(unique & ~FUSE_INT_REQ_BIT, FUSE_PQ_HASH_BITS);
 }
 
+#ifdef CONFIG_FUSE_IO_URING
+static void fuse_uring_kick(struct list_head *cmds);
+static void fuse_uring_abort(struct list_head *cmds);
+#else
+static inline void fuse_uring_kick(struct list_head *cmds)
+{
+}
+static inline void fuse_uring_abort(struct list_head *cmds)
+{
+}
+#endif
+
 /**
  * A new request is available, wake fiq->waitq
  */
@@ -211,6 +224,7 @@ static void fuse_dev_wake_and_unlock(struct fuse_iqueue *fiq)
 __releases(fiq->lock)
 {
 	wake_up(&fiq->waitq);
+	fuse_uring_kick(&fiq->uring_cmds);
 	kill_fasync(&fiq->fasync, SIGIO, POLL_IN);
 	spin_unlock(&fiq->lock);
 }
@@ -222,17 +236,178 @@ const struct fuse_iqueue_ops fuse_dev_fiq_ops = {
 };
 EXPORT_SYMBOL_GPL(fuse_dev_fiq_ops);
 
-static void queue_request_and_unlock(struct fuse_iqueue *fiq,
-				     struct fuse_req *req)
-__releases(fiq->lock)
+static void fuse_set_in_len(struct fuse_req *req)
 {
 	req->in.h.len = sizeof(struct fuse_in_header) +
 		fuse_len_args(req->args->in_numargs,
 			      (struct fuse_arg *) req->args->in_args);
+}
+
+static void queue_request_and_unlock(struct fuse_iqueue *fiq,
+				     struct fuse_req *req)
+__releases(fiq->lock)
+{
+	fuse_set_in_len(req);
 	list_add_tail(&req->list, &fiq->pending);
 	fiq->ops->wake_pending_and_unlock(fiq);
 }
 
+/*
+ * Queue @req on the request channel of the current CPU if a fuse device is
+ * bound to it.  Returns false if the request has to go through the shared
+ * input queue instead.
+ */
+static bool fuse_chan_queue_request(struct fuse_conn *fc,
+				    struct fuse_req *req)
+{
+	struct fuse_chan __percpu *chans = smp_load_acquire(&fc->chans);
+	struct fuse_chan *chan;
+
+	if (!chans)
+		return false;
+
+	chan = raw_cpu_ptr(chans);
+	if (!READ_ONCE(chan->nr_devs))
+		return false;
+
+	spin_lock(&chan->lock);
+	if (!chan->connected || !chan->nr_devs) {
+		spin_unlock(&chan->lock);
+		return false;
+	}
+	req->in.h.unique = fuse_get_unique(&fc->iq);
+	fuse_set_in_len(req);
+	req->chan = chan;
+	list_add_tail(&req->list, &chan->pending);
+	wake_up(&chan->waitq);
+	fuse_uring_kick(&chan->uring_cmds);
+	spin_unlock(&chan->lock);
+
+	return true;
+}
+
+/*
+ * Move the requests pending on @chan to the shared input queue.  Called with
+ * fiq->lock held when the last device is unbound from the channel or the
+ * connection is aborted.
+ */
+static bool fuse_chan_flush(struct fuse_iqueue *fiq, struct fuse_chan *chan)
+{
+	struct fuse_req *req;
+
+	lockdep_assert_held(&fiq->lock);
+	lockdep_assert_held(&chan->lock);
+
+	if (list_empty(&chan->pending))
+		return false;
+
+	list_for_each_entry(req, &chan->pending, list)
+		req->chan = NULL;
+	list_splice_tail_init(&chan->pending, &fiq->pending);
+	return true;
+}
+
+static int fuse_chan_bind(struct fuse_dev *fud, unsigned int cpu)
+{
+	struct fuse_conn *fc = fud->fc;
+	struct fuse_iqueue *fiq = &fc->iq;
+	struct fuse_chan __percpu *chans;
+	struct fuse_chan *chan;
+	int err = 0;
+
+	if (cpu >= nr_cpu_ids || !cpu_possible(cpu))
+		return -EINVAL;
+
+	if (fiq->ops != &fuse_dev_fiq_ops)
+		return -EOPNOTSUPP;
+
+	chans = alloc_percpu(struct fuse_chan);
+	if (!chans)
+		return -ENOMEM;
+
+	spin_lock(&fiq->lock);
+	if (!fc->chans) {
+		unsigned int i;
+
+		for_each_possible_cpu(i) {
+			chan = per_cpu_ptr(chans, i);
+			spin_lock_init(&chan->lock);
+			chan->connected = fiq->connected;
+			init_waitqueue_head(&chan->waitq);
+			INIT_LIST_HEAD(&chan->pending);
+			INIT_LIST_HEAD(&chan->uring_cmds);
+		}
+		/* Pairs with smp_load_acquire() in fuse_chan_queue_request() */
+		smp_store_release(&fc->chans, chans);
+		chans = NULL;
+	}
+
+	chan = per_cpu_ptr(fc->chans, cpu);
+	spin_lock(&chan->lock);
+	if (fud->chan) {
+		err = -EBUSY;
+	} else if (!chan->connected) {
+		err = fc->aborted ? -ECONNABORTED : -ENODEV;
+	} else {
+		chan->nr_devs++;
+		fud->chan = chan;
+	}
+	spin_unlock(&chan->lock);
+	spin_unlock(&fiq->lock);
+
+	free_percpu(chans);
+	return err;
+}
+
+static void fuse_chan_unbind(struct fuse_dev *fud)
+{
+	struct fuse_iqueue *fiq = &fud->fc->iq;
+	struct fuse_chan *chan = fud->chan;
+	bool flushed = false;
+
+	spin_lock(&fiq->lock);
+	spin_lock(&chan->lock);
+	if (!--chan->nr_devs)
+		flushed = fuse_chan_flush(fiq, chan);
+	spin_unlock(&chan->lock);
+	fud->chan = NULL;
+
+	if (flushed && fiq->connected)
+		fiq->ops->wake_pending_and_unlock(fiq);
+	else
+		spin_unlock(&fiq->lock);
+}
+
+/*
+ * Take a request that has not been read by userspace yet off the queue it
+ * is pending on.  Returns false if userspace already has it.
+ */
+static bool fuse_dequeue_pending(struct fuse_iqueue *fiq, struct fuse_req *req)
+{
+	struct fuse_chan *chan = READ_ONCE(req->chan);
+	bool pending;
+
+	if (chan) {
+		spin_lock(&chan->lock);
+		if (req->chan == chan) {
+			list_del(&req->list);
+			req->chan = NULL;
+			spin_unlock(&chan->lock);
+			return true;
+		}
+		/* Read by userspace or moved to the shared queue meanwhile */
+		spin_unlock(&chan->lock);
+	}
+
+	spin_lock(&fiq->lock);
+	pending = test_bit(FR_PENDING, &req->flags);
+	if (pending)
+		list_del(&req->list);
+	spin_unlock(&fiq->lock);
+
+	return pending;
+}
+
 void fuse_queue_forget(struct fuse_conn *fc, struct fuse_forget_link *forget,
 		       u64 nodeid, u64 nlookup)
 {
@@ -263,6 +438,8 @@ static void flush_bg_queue(struct fuse_conn *fc)
 		req = list_first_entry(&fc->bg_queue, struct fuse_req, list);
 		list_del(&req->list);
 		fc->active_background++;
+		if (fuse_chan_queue_request(fc, req))
+			continue;
 		spin_lock(&fiq->lock);
 		req->in.h.unique = fuse_get_unique(fiq);
 		queue_request_and_unlock(fiq, req);
@@ -388,16 +565,12 @@ static void request_wait_answer(struct fuse_req *req)
 		if (!err)
 			return;
 
-		spin_lock(&fiq->lock);
 		/* Request is not yet in userspace, bail out */
-		if (test_bit(FR_PENDING, &req->flags)) {
-			list_del(&req->list);
-			spin_unlock(&fiq->lock);
+		if (fuse_dequeue_pending(fiq, req)) {
 			__fuse_put_request(req);
 			req->out.h.error = -EINTR;
 			return;
 		}
-		spin_unlock(&fiq->lock);
 	}
 
 	/*
@@ -409,24 +582,29 @@ static void request_wait_answer(struct fuse_req *req)
 
 static void __fuse_request_send(struct fuse_req *req)
 {
-	struct fuse_iqueue *fiq = &req->fm->fc->iq;
+	struct fuse_conn *fc = req->fm->fc;
+	struct fuse_iqueue *fiq = &fc->iq;
 
 	BUG_ON(test_bit(FR_BACKGROUND, &req->flags));
-	spin_lock(&fiq->lock);
-	if (!fiq->connected) {
-		spin_unlock(&fiq->lock);
-		req->out.h.error = -ENOTCONN;
-	} else {
+
+	/* acquire extra reference, since request is still needed
+	   after fuse_request_end() */
+	__fuse_get_request(req);
+	if (!fuse_chan_queue_request(fc, req)) {
+		spin_lock(&fiq->lock);
+		if (!fiq->connected) {
+			spin_unlock(&fiq->lock);
+			__fuse_put_request(req);
+			req->out.h.error = -ENOTCONN;
+			return;
+		}
 		req->in.h.unique = fuse_get_unique(fiq);
-		/* acquire extra reference, since request is still needed
-		   after fuse_request_end() */
-		__fuse_get_request(req);
 		queue_request_and_unlock(fiq, req);
-
-		request_wait_answer(req);
-		/* Pairs with smp_wmb() in fuse_request_end() */
-		smp_rmb();
 	}
+
+	request_wait_answer(req);
+	/* Pairs with smp_wmb() in fuse_request_end() */
+	smp_rmb();
 }
 
 static void fuse_adjust_compat(struct fuse_conn *fc, struct fuse_args *args)
@@ -1189,6 +1367,46 @@ __releases(fiq->lock)
 		return fuse_read_batch_forget(fiq, cs, nbytes);
 }
 
+/*
+ * Wait for and dequeue the next request on the channel a device is bound
+ * to.  Bound devices never see the shared input queue.
+ */
+static struct fuse_req *fuse_chan_read_request(struct fuse_conn *fc,
+					       struct fuse_chan *chan,
+					       bool nonblock)
+{
+	struct fuse_req *req;
+	int err;
+
+	for (;;) {
+		spin_lock(&chan->lock);
+		if (!chan->connected || !list_empty(&chan->pending))
+			break;
+		spin_unlock(&chan->lock);
+
+		if (nonblock)
+			return ERR_PTR(-EAGAIN);
+		err = wait_event_interruptible_exclusive(chan->waitq,
+				!READ_ONCE(chan->connected) ||
+				!list_empty(&chan->pending));
+		if (err)
+			return ERR_PTR(err);
+	}
+
+	if (!chan->connected) {
+		spin_unlock(&chan->lock);
+		return ERR_PTR(fc->aborted ? -ECONNABORTED : -ENODEV);
+	}
+
+	req = list_first_entry(&chan->pending, struct fuse_req, list);
+	clear_bit(FR_PENDING, &req->flags);
+	list_del_init(&req->list);
+	req->chan = NULL;
+	spin_unlock(&chan->lock);
+
+	return req;
+}
+
 /*
  * Read a single request into the userspace filesystem's buffer.  This
  * function waits until a request is available, then removes it from
@@ -1198,7 +1416,7 @@ __releases(fiq->lock)
  * fuse_request_end().  Otherwise add it to the processing list, and set
  * the 'sent' flag.
  */
-static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
+static ssize_t fuse_dev_do_read(struct fuse_dev *fud, bool nonblock,
 				struct fuse_copy_state *cs, size_t nbytes)
 {
 	ssize_t err;
@@ -1229,13 +1447,20 @@ static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
 		return -EINVAL;
 
  restart:
+	if (fud->chan) {
+		req = fuse_chan_read_request(fc, fud->chan, nonblock);
+		if (IS_ERR(req))
+			return PTR_ERR(req);
+		goto dequeued;
+	}
+
 	for (;;) {
 		spin_lock(&fiq->lock);
 		if (!fiq->connected || request_pending(fiq))
 			break;
 		spin_unlock(&fiq->lock);
 
-		if (file->f_flags & O_NONBLOCK)
+		if (nonblock)
 			return -EAGAIN;
 		err = wait_event_interruptible_exclusive(fiq->waitq,
 				!fiq->connected || request_pending(fiq));
@@ -1267,6 +1492,7 @@ static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
 	list_del_init(&req->list);
 	spin_unlock(&fiq->lock);
 
+dequeued:
 	args = req->args;
 	reqsize = req->in.h.len;
 
@@ -1361,7 +1587,8 @@ static ssize_t fuse_dev_read(struct kiocb *iocb, struct iov_iter *to)
 
 	fuse_copy_init(&cs, 1, to);
 
-	return fuse_dev_do_read(fud, file, &cs, iov_iter_count(to));
+	return fuse_dev_do_read(fud, file->f_flags & O_NONBLOCK, &cs,
+				iov_iter_count(to));
 }
 
 static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
@@ -1385,7 +1612,7 @@ static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
 	fuse_copy_init(&cs, 1, NULL);
 	cs.pipebufs = bufs;
 	cs.pipe = pipe;
-	ret = fuse_dev_do_read(fud, in, &cs, len);
+	ret = fuse_dev_do_read(fud, in->f_flags & O_NONBLOCK, &cs, len);
 	if (ret < 0)
 		goto out;
 
@@ -2060,6 +2287,21 @@ static __poll_t fuse_dev_poll(struct file *file, poll_table *wait)
 	if (!fud)
 		return EPOLLERR;
 
+	if (fud->chan) {
+		struct fuse_chan *chan = fud->chan;
+
+		poll_wait(file, &chan->waitq, wait);
+
+		spin_lock(&chan->lock);
+		if (!chan->connected)
+			mask = EPOLLERR;
+		else if (!list_empty(&chan->pending))
+			mask |= EPOLLIN | EPOLLRDNORM;
+		spin_unlock(&chan->lock);
+
+		return mask;
+	}
+
 	fiq = &fud->fc->iq;
 	poll_wait(file, &fiq->waitq, wait);
 
@@ -2165,12 +2407,25 @@ void fuse_abort_conn(struct fuse_conn *fc)
 
 		spin_lock(&fiq->lock);
 		fiq->connected = 0;
+		if (fc->chans) {
+			for_each_possible_cpu(i) {
+				struct fuse_chan *chan = per_cpu_ptr(fc->chans, i);
+
+				spin_lock(&chan->lock);
+				chan->connected = 0;
+				fuse_chan_flush(fiq, chan);
+				wake_up_all(&chan->waitq);
+				fuse_uring_abort(&chan->uring_cmds);
+				spin_unlock(&chan->lock);
+			}
+		}
 		list_for_each_entry(req, &fiq->pending, list)
 			clear_bit(FR_PENDING, &req->flags);
 		list_splice_tail_init(&fiq->pending, &to_end);
 		while (forget_pending(fiq))
 			kfree(fuse_dequeue_forget(fiq, 1, NULL));
 		wake_up_all(&fiq->waitq);
+		fuse_uring_abort(&fiq->uring_cmds);
 		spin_unlock(&fiq->lock);
 		kill_fasync(&fiq->fasync, SIGIO, POLL_IN);
 		end_polls(fc);
@@ -2201,6 +2456,9 @@ int fuse_dev_release(struct inode *inode, struct file *file)
 		LIST_HEAD(to_end);
 		unsigned int i;
 
+		if (fud->chan)
+			fuse_chan_unbind(fud);
+
 		spin_lock(&fpq->lock);
 		WARN_ON(!list_empty(&fpq->io));
 		for (i = 0; i < FUSE_PQ_HASH_SIZE; i++)
@@ -2248,11 +2506,21 @@ static int fuse_device_clone(struct fuse_conn *fc, struct file *new)
 	return 0;
 }
 
+/*
+ * Bind a (cloned) device to the request channel of the CPU passed as
+ * argument.  Requests submitted on that CPU are then only read through the
+ * devices bound to it.
+ */
+#ifndef FUSE_DEV_IOC_BIND_CPU
+#define FUSE_DEV_IOC_BIND_CPU		_IOW(FUSE_DEV_IOC_MAGIC, 8, uint32_t)
+#endif
+
 static long fuse_dev_ioctl(struct file *file, unsigned int cmd,
 			   unsigned long arg)
 {
 	int res;
 	int oldfd;
+	u32 cpu;
 	struct fuse_dev *fud = NULL;
 
 	switch (cmd) {
@@ -2280,6 +2548,13 @@ static long fuse_dev_ioctl(struct file *file, unsigned int cmd,
 			}
 		}
 		break;
+	case FUSE_DEV_IOC_BIND_CPU:
+		res = -EFAULT;
+		if (!get_user(cpu, (__u32 __user *)arg)) {
+			fud = fuse_get_dev(file);
+			res = fud ? fuse_chan_bind(fud, cpu) : -EPERM;
+		}
+		break;
 	default:
 		res = -ENOTTY;
 		break;
@@ -2287,6 +2562,249 @@ static long fuse_dev_ioctl(struct file *file, unsigned int cmd,
 	return res;
 }
 
+#ifdef CONFIG_FUSE_IO_URING
+/*
+ * io_uring transport
+ *
+ * Instead of read() and write() on the device, the daemon submits
+ * FUSE_URING_CMD_FETCH commands pointing to a buffer.  Each one completes
+ * once the next request has been copied into that buffer.  The reply is
+ * written into the same buffer and handed back with
+ * FUSE_URING_CMD_COMMIT_AND_FETCH, which also re-arms the fetch, so every
+ * FUSE operation costs a single SQE/CQE pair.  A successful fetch completes
+ * with res 0; the request length is in the fuse_in_header.
+ *
+ * Fetch commands that find no pending request are parked on the queue that
+ * a read() on the same device would wait on and are handed back to their
+ * task through task work once a request shows up.  Parked commands are
+ * cancelable, so that a dying daemon does not keep the device file, and
+ * with it the connection, alive; they complete with -ECONNABORTED when the
+ * connection is aborted or the ring cancels them.
+ */
+#ifndef FUSE_URING_CMD_FETCH
+#define FUSE_URING_CMD_FETCH			1
+#define FUSE_URING_CMD_COMMIT_AND_FETCH		2
+
+/* Payload in the SQE command area */
+struct fuse_uring_cmd_req {
+	__u64	buf;
+	__u32	buf_len;
+	/* COMMIT_AND_FETCH: length of the reply at the start of buf */
+	__u32	reply_len;
+};
+#endif
+
+/* Per-command state kept in io_uring_cmd->pdu */
+struct fuse_uring_pdu {
+	struct list_head	entry;
+	u64			buf;
+	u32			buf_len;
+};
+
+static inline struct fuse_uring_pdu *fuse_uring_pdu(struct io_uring_cmd *cmd)
+{
+	return (struct fuse_uring_pdu *)cmd->pdu;
+}
+
+static bool fuse_uring_park(struct fuse_dev *fud, struct io_uring_cmd *cmd)
+{
+	struct fuse_uring_pdu *pdu = fuse_uring_pdu(cmd);
+	struct fuse_iqueue *fiq = &fud->fc->iq;
+	struct fuse_chan *chan = fud->chan;
+	bool parked = false;
+
+	if (chan) {
+		spin_lock(&chan->lock);
+		if (chan->connected && list_empty(&chan->pending)) {
+			list_add_tail(&pdu->entry, &chan->uring_cmds);
+			parked = true;
+		}
+		spin_unlock(&chan->lock);
+	} else {
+		spin_lock(&fiq->lock);
+		if (fiq->connected && !request_pending(fiq)) {
+			list_add_tail(&pdu->entry, &fiq->uring_cmds);
+			parked = true;
+		}
+		spin_unlock(&fiq->lock);
+	}
+
+	return parked;
+}
+
+/*
+ * Copy the next request into the buffer of a fetch command.  Returns
+ * -EIOCBQUEUED if the command has been parked until a request arrives.
+ */
+static ssize_t fuse_uring_fetch(struct io_uring_cmd *cmd)
+{
+	struct fuse_uring_pdu *pdu = fuse_uring_pdu(cmd);
+	struct fuse_dev *fud = fuse_get_dev(cmd->file);
+	struct fuse_copy_state cs;
+	struct iov_iter iter;
+	struct iovec iov;
+	ssize_t ret;
+
+	for (;;) {
+		ret = import_single_range(READ, u64_to_user_ptr(pdu->buf),
+					  pdu->buf_len, &iov, &iter);
+		if (ret)
+			return ret;
+
+		fuse_copy_init(&cs, 1, &iter);
+		ret = fuse_dev_do_read(fud, true, &cs, pdu->buf_len);
+		if (ret != -EAGAIN)
+			return ret;
+
+		if (fuse_uring_park(fud, cmd))
+			return -EIOCBQUEUED;
+	}
+}
+
+static void fuse_uring_fetch_tw(struct io_uring_cmd *cmd)
+{
+	ssize_t ret;
+
+	/* Ring teardown, there is no user memory left to copy into */
+	if (unlikely(current->flags & (PF_EXITING | PF_KTHREAD))) {
+		io_uring_cmd_done(cmd, -ECANCELED, 0);
+		return;
+	}
+
+	ret = fuse_uring_fetch(cmd);
+	if (ret != -EIOCBQUEUED)
+		io_uring_cmd_done(cmd, ret < 0 ? ret : 0, 0);
+}
+
+/*
+ * Hand one parked fetch command back to its task.  Called with the lock
+ * protecting @cmds held.
+ */
+static void fuse_uring_kick(struct list_head *cmds)
+{
+	struct fuse_uring_pdu *pdu;
+
+	pdu = list_first_entry_or_null(cmds, struct fuse_uring_pdu, entry);
+	if (!pdu)
+		return;
+
+	list_del_init(&pdu->entry);
+	io_uring_cmd_complete_in_task(container_of((void *)pdu,
+						   struct io_uring_cmd, pdu),
+				      fuse_uring_fetch_tw);
+}
+
+static void fuse_uring_abort_tw(struct io_uring_cmd *cmd)
+{
+	io_uring_cmd_done(cmd, -ECONNABORTED, 0);
+}
+
+/* Fail all parked fetch commands, called with the lock protecting @cmds held */
+static void fuse_uring_abort(struct list_head *cmds)
+{
+	struct fuse_uring_pdu *pdu, *tmp;
+
+	list_for_each_entry_safe(pdu, tmp, cmds, entry) {
+		list_del_init(&pdu->entry);
+		io_uring_cmd_complete_in_task(container_of((void *)pdu,
+							   struct io_uring_cmd,
+							   pdu),
+					      fuse_uring_abort_tw);
+	}
+}
+
+/*
+ * The ring cancels a parked command.  If it has already been taken off the
+ * queue, it is about to complete from task work.
+ */
+static void fuse_uring_cancel(struct io_uring_cmd *cmd, struct fuse_dev *fud)
+{
+	struct fuse_uring_pdu *pdu = fuse_uring_pdu(cmd);
+	spinlock_t *lock = fud->chan ? &fud->chan->lock : &fud->fc->iq.lock;
+	bool parked;
+
+	spin_lock(lock);
+	parked = !list_empty(&pdu->entry);
+	list_del_init(&pdu->entry);
+	spin_unlock(lock);
+
+	if (parked)
+		io_uring_cmd_done(cmd, -ECONNABORTED, 0);
+}
+
+static ssize_t fuse_uring_commit(struct fuse_dev *fud,
+				 struct fuse_uring_pdu *pdu, u32 len)
+{
+	struct fuse_copy_state cs;
+	struct iov_iter iter;
+	struct iovec iov;
+	ssize_t ret;
+
+	if (len > pdu->buf_len)
+		return -EINVAL;
+
+	ret = import_single_range(WRITE, u64_to_user_ptr(pdu->buf), len,
+				  &iov, &iter);
+	if (ret)
+		return ret;
+
+	fuse_copy_init(&cs, 0, &iter);
+	return fuse_dev_do_write(fud, &cs, len);
+}
+
+static int fuse_dev_uring_cmd(struct io_uring_cmd *cmd,
+			      unsigned int issue_flags)
+{
+	const struct fuse_uring_cmd_req *req = cmd->cmd;
+	struct fuse_uring_pdu *pdu = fuse_uring_pdu(cmd);
+	struct fuse_dev *fud = fuse_get_dev(cmd->file);
+	ssize_t ret;
+
+	BUILD_BUG_ON(sizeof(*pdu) > sizeof(cmd->pdu));
+
+	if (!fud)
+		return -EPERM;
+
+	if (issue_flags & IO_URING_F_CANCEL) {
+		fuse_uring_cancel(cmd, fud);
+		return 0;
+	}
+
+	/* Completions are driven by requests, not by polling */
+	if (issue_flags & IO_URING_F_IOPOLL)
+		return -EOPNOTSUPP;
+
+	INIT_LIST_HEAD(&pdu->entry);
+	pdu->buf = READ_ONCE(req->buf);
+	pdu->buf_len = READ_ONCE(req->buf_len);
+
+	switch (cmd->cmd_op) {
+	case FUSE_URING_CMD_COMMIT_AND_FETCH:
+		ret = fuse_uring_commit(fud, pdu, READ_ONCE(req->reply_len));
+		if (ret < 0)
+			return ret;
+		fallthrough;
+	case FUSE_URING_CMD_FETCH:
+		/* once parked, a kick may complete it before we return */
+		io_uring_cmd_mark_cancelable(cmd, issue_flags);
+		ret = fuse_uring_fetch(cmd);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/*
+	 * A request that was already pending is returned right away;
+	 * io_uring_cmd_done() must not be called from the issue path.
+	 */
+	if (ret == -EIOCBQUEUED)
+		return ret;
+	if (ret < 0)
+		return ret;
+	return 0;
+}
+#endif
+
 const struct file_operations fuse_dev_operations = {
 	.owner		= THIS_MODULE,
 	.open		= fuse_dev_open,
@@ -2300,6 +2818,9 @@ const struct file_operations fuse_dev_operations = {
 	.fasync		= fuse_dev_fasync,
 	.unlocked_ioctl = fuse_dev_ioctl,
 	.compat_ioctl   = compat_ptr_ioctl,
+#ifdef CONFIG_FUSE_IO_URING
+	.uring_cmd	= fuse_dev_uring_cmd,
+#endif
 };
 EXPORT_SYMBOL_GPL(fuse_dev_operations);
 
@@ -18,6 +18,8 @@
 #include <linux/falloc.h>
 #include <linux/uio.h>
 #include <linux/fs.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 static int fuse_send_open(struct fuse_mount *fm, u64 nodeid,
 			  unsigned int open_flags, int opcode,
@@ -887,6 +889,39 @@ static int fuse_read_folio(struct file *file, struct folio *folio)
 	return err;
 }
 
+/* Interval over which readahead throughput is sampled */
+#define FUSE_RA_SAMPLE_NS	(100 * NSEC_PER_MSEC)
+
+/*
+ * Grow the readahead window of a stream while doing so keeps increasing the
+ * throughput seen from the server, and shrink it again once throughput
+ * drops.  For a network backed server this keeps enough READ requests in
+ * flight to cover its latency.  The window stays between the bdi default
+ * and the limit negotiated in FUSE_INIT.
+ */
+static void fuse_readahead_adapt(struct fuse_file *ff,
+				 struct file_ra_state *ra,
+				 unsigned int min_pages, unsigned int max_pages)
+{
+	u64 now = ktime_get_ns();
+	u64 elapsed = now - ff->ra.sample_start;
+	u64 bw, last;
+
+	if (elapsed < FUSE_RA_SAMPLE_NS)
+		return;
+
+	bw = mul_u64_u64_div_u64(atomic64_xchg(&ff->ra.bytes, 0),
+				 NSEC_PER_SEC, elapsed);
+	last = ff->ra.last_bw;
+	ff->ra.last_bw = bw;
+	ff->ra.sample_start = now;
+
+	if (bw > last + last / 8)
+		ra->ra_pages = min(ra->ra_pages * 2, max_pages);
+	else if (bw < last - last / 4)
+		ra->ra_pages = max(ra->ra_pages / 2, min_pages);
+}
+
 static void fuse_readpages_end(struct fuse_mount *fm, struct fuse_args *args,
 			       int err)
 {
@@ -922,8 +957,11 @@ static void fuse_readpages_end(struct fuse_mount *fm, struct fuse_args *args,
 		unlock_page(page);
 		put_page(page);
 	}
-	if (ia->ff)
+	if (ia->ff) {
+		if (!err)
+			atomic64_add(num_read, &ia->ff->ra.bytes);
 		fuse_file_put(ia->ff, false, false);
+	}
 
 	fuse_io_free(ia);
 }
@@ -976,6 +1014,14 @@ static void fuse_readahead(struct readahead_control *rac)
 	max_pages = min_t(unsigned int, fc->max_pages,
 			fc->max_read / PAGE_SIZE);
 
+	/* Throughput is only sampled for asynchronous reads */
+	if (fc->async_read && rac->ra && rac->file) {
+		unsigned int min_ra = inode_to_bdi(inode)->ra_pages;
+
+		fuse_readahead_adapt(rac->file->private_data, rac->ra, min_ra,
+				     max(min_ra, fc->max_ra_pages));
+	}
+
 	for (;;) {
 		struct fuse_io_args *ia;
 		struct fuse_args_pages *ap;
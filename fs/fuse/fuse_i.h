@@ -38,6 +38,9 @@
 /** Maximum of max_pages received in init_out */
 #define FUSE_MAX_MAX_PAGES 256
 
+/** Readahead limit offered to the server in FUSE_INIT, in bytes */
+#define FUSE_MAX_READAHEAD (8 * 1024 * 1024)
+
 /** Bias for fi->writectr, meaning new writepages must not be sent */
 #define FUSE_NOWRITE INT_MIN
 
@@ -226,6 +229,18 @@ struct fuse_file {
 
 	/** Has flock been performed on this file? */
 	bool flock:1;
+
+	/* Adaptive readahead state */
+	struct {
+		/* Start of the current throughput sample */
+		u64 sample_start;
+
+		/* Bytes read ahead and completed during the sample */
+		atomic64_t bytes;
+
+		/* Throughput of the previous sample in bytes per second */
+		u64 last_bw;
+	} ra;
 };
 
 /** One input argument of a request */
@@ -374,6 +389,9 @@ struct fuse_req {
 
 	/** fuse_mount this request belongs to */
 	struct fuse_mount *fm;
+
+	/** Request channel this request is pending on, if any */
+	struct fuse_chan *chan;
 };
 
 struct fuse_iqueue;
@@ -425,7 +443,7 @@ struct fuse_iqueue {
 	wait_queue_head_t waitq;
 
 	/** The next unique request id */
-	u64 reqctr;
+	atomic64_t reqctr;
 
 	/** The list of pending requests */
 	struct list_head pending;
@@ -443,6 +461,9 @@ struct fuse_iqueue {
 	/** O_ASYNC requests */
 	struct fasync_struct *fasync;
 
+	/** io_uring fetch commands waiting for a request */
+	struct list_head uring_cmds;
+
 	/** Device-specific callbacks */
 	const struct fuse_iqueue_ops *ops;
 
@@ -467,6 +488,37 @@ struct fuse_pqueue {
 	struct list_head io;
 };
 
+/**
+ * Per-CPU request channel
+ *
+ * Requests submitted on a CPU that has a fuse device bound to it are queued
+ * here instead of on the shared input queue, so that the daemon thread
+ * serving that CPU picks them up without touching fiq->lock.  Interrupts,
+ * forgets and requests from CPUs without a bound device still go through
+ * the shared input queue.
+ *
+ * Lock order is fiq->lock, then chan->lock.
+ */
+struct fuse_chan {
+	/** Lock protecting accesses to members of this structure */
+	spinlock_t lock;
+
+	/** Channel accepts requests */
+	unsigned connected;
+
+	/** Number of fuse devices bound to this channel */
+	unsigned int nr_devs;
+
+	/** Readers bound to this channel are waiting on this */
+	wait_queue_head_t waitq;
+
+	/** The list of pending requests */
+	struct list_head pending;
+
+	/** io_uring fetch commands waiting for a request */
+	struct list_head uring_cmds;
+};
+
 /**
  * Fuse device instance
  */
@@ -477,6 +529,9 @@ struct fuse_dev {
 	/** Processing queue */
 	struct fuse_pqueue pq;
 
+	/** Request channel this device is bound to, NULL for the shared queue */
+	struct fuse_chan *chan;
+
 	/** list entry on fc->devices */
 	struct list_head entry;
 };
@@ -572,9 +627,15 @@ struct fuse_conn {
 	/** Constrain ->max_pages to this value during feature negotiation */
 	unsigned int max_pages_limit;
 
+	/** Upper bound for the adaptive readahead window, in pages */
+	unsigned int max_ra_pages;
+
 	/** Input queue */
 	struct fuse_iqueue iq;
 
+	/** Per-CPU request channels, allocated on first bind */
+	struct fuse_chan __percpu *chans;
+
 	/** The next unique kernel file handle */
 	atomic64_t khctr;
 
@@ -801,6 +801,7 @@ static void fuse_iqueue_init(struct fuse_iqueue *fiq,
 	init_waitqueue_head(&fiq->waitq);
 	INIT_LIST_HEAD(&fiq->pending);
 	INIT_LIST_HEAD(&fiq->interrupts);
+	INIT_LIST_HEAD(&fiq->uring_cmds);
 	fiq->forget_list_tail = &fiq->forget_list_head;
 	fiq->connected = 1;
 	fiq->ops = ops;
@@ -864,6 +865,7 @@ void fuse_conn_put(struct fuse_conn *fc)
 			fuse_dax_conn_free(fc);
 		if (fiq->ops->release)
 			fiq->ops->release(fiq);
+		free_percpu(fc->chans);
 		put_pid_ns(fc->pid_ns);
 		put_user_ns(fc->user_ns);
 		bucket = rcu_dereference_protected(fc->curr_bucket, 1);
@@ -1207,6 +1209,7 @@ static void process_init_reply(struct fuse_mount *fm, struct fuse_args *args,
 			fc->no_flock = 1;
 		}
 
+		fc->max_ra_pages = ra_pages;
 		fm->sb->s_bdi->ra_pages =
 				min(fm->sb->s_bdi->ra_pages, ra_pages);
 		fc->minor = arg->minor;
@@ -1234,7 +1237,13 @@ void fuse_send_init(struct fuse_mount *fm)
 
 	ia->in.major = FUSE_KERNEL_VERSION;
 	ia->in.minor = FUSE_KERNEL_MINOR_VERSION;
-	ia->in.max_readahead = fm->sb->s_bdi->ra_pages * PAGE_SIZE;
+	/*
+	 * Offer more than the bdi default so that fuse_readahead() has room
+	 * to grow the window of fast sequential streams.  The bdi default
+	 * still applies until then.
+	 */
+	ia->in.max_readahead = max_t(unsigned long, FUSE_MAX_READAHEAD,
+				     fm->sb->s_bdi->ra_pages * PAGE_SIZE);
 	flags =
 		FUSE_ASYNC_READ | FUSE_POSIX_LOCKS | FUSE_ATOMIC_O_TRUNC |
 		FUSE_EXPORT_SUPPORT | FUSE_BIG_WRITES | FUSE_DONT_MASK |
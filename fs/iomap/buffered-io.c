@@ -23,6 +23,17 @@
 
 #define IOEND_BATCH_SIZE	4096
 
+/*
+ * Upper bound for the amount of data copied into the page cache per
+ * iteration of a buffered write.  Page cache folios are never larger
+ * than this.
+ */
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+#define IOMAP_MAX_WRITE_CHUNK	HPAGE_PMD_SIZE
+#else
+#define IOMAP_MAX_WRITE_CHUNK	(PAGE_SIZE << 8)
+#endif
+
 /*
  * Structure allocated for each folio when block size < folio size
  * to track sub-folio uptodate status and I/O completions.
@@ -727,26 +738,64 @@ static size_t iomap_write_end(struct iomap_iter *iter, loff_t pos, size_t len,
 	return ret;
 }
 
+/*
+ * Copy into a possibly large folio.  copy_page_from_iter_atomic() can only
+ * map a single page at a time on highmem configurations, so walk the folio
+ * page by page there.
+ */
+static size_t iomap_copy_from_iter(struct folio *folio, size_t offset,
+		size_t bytes, struct iov_iter *i)
+{
+	size_t copied = 0;
+
+	if (!folio_test_highmem(folio))
+		return copy_page_from_iter_atomic(&folio->page, offset, bytes, i);
+
+	do {
+		struct page *page = folio_page(folio, offset >> PAGE_SHIFT);
+		size_t poff = offset_in_page(offset);
+		size_t n = min_t(size_t, PAGE_SIZE - poff, bytes - copied);
+		size_t ret;
+
+		ret = copy_page_from_iter_atomic(page, poff, n, i);
+		copied += ret;
+		offset += ret;
+		if (ret < n)
+			break;
+	} while (copied < bytes);
+
+	return copied;
+}
+
 static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 {
 	loff_t length = iomap_length(iter);
+	size_t chunk = PAGE_SIZE;
 	loff_t pos = iter->pos;
 	ssize_t written = 0;
 	long status = 0;
 	struct address_space *mapping = iter->inode->i_mapping;
 	unsigned int bdp_flags = (iter->flags & IOMAP_NOWAIT) ? BDP_ASYNC : 0;
 
+	/*
+	 * With large folios in the page cache a single write_begin/write_end
+	 * cycle can cover a whole folio, so copy up to the largest folio size
+	 * per iteration instead of a page.  The mapping and the dirty and
+	 * uptodate state are then updated once per folio.
+	 */
+	if (mapping_large_folio_support(mapping))
+		chunk = IOMAP_MAX_WRITE_CHUNK;
+
 	do {
 		struct folio *folio;
-		struct page *page;
-		unsigned long offset;	/* Offset into pagecache page */
-		unsigned long bytes;	/* Bytes to write to page */
+		size_t offset;		/* Offset into folio */
+		size_t bytes;		/* Bytes to write to folio */
 		size_t copied;		/* Bytes copied from user */
 
-		offset = offset_in_page(pos);
-		bytes = min_t(unsigned long, PAGE_SIZE - offset,
-						iov_iter_count(i));
+		bytes = iov_iter_count(i);
 again:
+		offset = pos & (chunk - 1);
+		bytes = min(chunk - offset, bytes);
 		status = balance_dirty_pages_ratelimited_flags(mapping,
 							       bdp_flags);
 		if (unlikely(status))
@@ -774,11 +823,15 @@ static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 		if (unlikely(status))
 			break;
 
-		page = folio_file_page(folio, pos >> PAGE_SHIFT);
+		/* The folio we got back may be smaller than the chunk */
+		offset = offset_in_folio(folio, pos);
+		if (bytes > folio_size(folio) - offset)
+			bytes = folio_size(folio) - offset;
+
 		if (mapping_writably_mapped(mapping))
-			flush_dcache_page(page);
+			flush_dcache_folio(folio);
 
-		copied = copy_page_from_iter_atomic(page, offset, bytes, i);
+		copied = iomap_copy_from_iter(folio, offset, bytes, i);
 
 		status = iomap_write_end(iter, pos, bytes, copied, folio);
 
@@ -791,8 +844,12 @@ static loff_t iomap_write_iter(struct iomap_iter *iter, struct iov_iter *i)
 			 * A short copy made iomap_write_end() reject the
 			 * thing entirely.  Might be memory poisoning
 			 * halfway through, might be a race with munmap,
-			 * might be severe memory pressure.
+			 * might be severe memory pressure.  Retry with a
+			 * smaller chunk so that a large folio does not keep
+			 * failing as a whole.
 			 */
+			if (chunk > PAGE_SIZE)
+				chunk /= 2;
 			if (copied)
 				bytes = copied;
 			goto again;
@@ -20,6 +20,7 @@
  * Private flags for iomap_dio, must not overlap with the public ones in
  * iomap.h:
  */
+#define IOMAP_DIO_INLINE_COMP	(1 << 27)
 #define IOMAP_DIO_WRITE_FUA	(1 << 28)
 #define IOMAP_DIO_NEED_SYNC	(1 << 29)
 #define IOMAP_DIO_WRITE		(1 << 30)
@@ -54,6 +55,15 @@ struct iomap_dio {
 static struct bio *iomap_dio_alloc_bio(const struct iomap_iter *iter,
 		struct iomap_dio *dio, unsigned short nr_vecs, blk_opf_t opf)
 {
+	/*
+	 * The issuer (io_uring) guarantees that the per-cpu bio cache can be
+	 * used for this request.  Bio sets without a cache simply ignore the
+	 * flag.  iomap_dio_submit_bio() drops it again for bios that end up
+	 * not being polled.
+	 */
+	if (dio->iocb->ki_flags & IOCB_ALLOC_CACHE)
+		opf |= REQ_ALLOC_CACHE;
+
 	if (dio->dops && dio->dops->bio_set)
 		return bio_alloc_bioset(iter->iomap.bdev, nr_vecs, opf,
 					GFP_KERNEL, dio->dops->bio_set);
@@ -69,6 +79,12 @@ static void iomap_dio_submit_bio(const struct iomap_iter *iter,
 	if ((dio->iocb->ki_flags & IOCB_HIPRI) && !is_sync_kiocb(dio->iocb)) {
 		bio_set_polled(bio, dio->iocb);
 		dio->submit.poll_bio = bio;
+	} else {
+		/*
+		 * The bio cache isn't IRQ safe, only polled bios are known to
+		 * be put from task context.
+		 */
+		bio->bi_opf &= ~REQ_ALLOC_CACHE;
 	}
 
 	if (dio->dops && dio->dops->submit_io)
@@ -167,13 +183,19 @@ void iomap_dio_bio_end_io(struct bio *bio)
 			struct task_struct *waiter = dio->submit.waiter;
 			WRITE_ONCE(dio->submit.waiter, NULL);
 			blk_wake_io_task(waiter);
-		} else if (dio->flags & IOMAP_DIO_WRITE) {
+		} else if ((dio->flags & IOMAP_DIO_WRITE) &&
+			   !((dio->flags & IOMAP_DIO_INLINE_COMP) &&
+			     (bio->bi_opf & REQ_POLLED) && in_task())) {
 			struct inode *inode = file_inode(dio->iocb->ki_filp);
 
 			WRITE_ONCE(dio->iocb->private, NULL);
 			INIT_WORK(&dio->aio.work, iomap_dio_complete_work);
 			queue_work(inode->i_sb->s_dio_done_wq, &dio->aio.work);
 		} else {
+			/*
+			 * Reads, and pure overwrites that were reaped by a
+			 * polling task, are completed inline.
+			 */
 			WRITE_ONCE(dio->iocb->private, NULL);
 			iomap_dio_complete_work(&dio->aio.work);
 		}
@@ -297,6 +319,15 @@ static loff_t iomap_dio_bio_iter(const struct iomap_iter *iter,
 	    ((dio->flags & IOMAP_DIO_WRITE) && pos >= i_size_read(inode)))
 		dio->iocb->ki_flags &= ~IOCB_HIPRI;
 
+	/*
+	 * Only pure overwrites can be completed from the polling task:
+	 * extent conversion, COW remapping and size updates in ->end_io
+	 * need the workqueue.
+	 */
+	if (need_zeroout || (dio->flags & IOMAP_DIO_COW) ||
+	    pos + length > i_size_read(inode))
+		dio->flags &= ~IOMAP_DIO_INLINE_COMP;
+
 	if (need_zeroout) {
 		/* zero out from the start of the block to the write offset */
 		pad = pos & (fs_block_size - 1);
@@ -539,6 +570,14 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 		iomi.flags |= IOMAP_WRITE;
 		dio->flags |= IOMAP_DIO_WRITE;
 
+		/*
+		 * Polled writes may be completed by the task reaping them
+		 * instead of bouncing through s_dio_done_wq.  The mapping
+		 * code clears this again if completion needs more work.
+		 */
+		if ((iocb->ki_flags & IOCB_HIPRI) && !wait_for_completion)
+			dio->flags |= IOMAP_DIO_INLINE_COMP;
+
 		if (iocb->ki_flags & IOCB_NOWAIT) {
 			if (filemap_range_has_page(mapping, iomi.pos, end)) {
 				ret = -EAGAIN;
@@ -638,6 +677,10 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	if (dio->flags & IOMAP_DIO_WRITE_FUA)
 		dio->flags &= ~IOMAP_DIO_NEED_SYNC;
 
+	/* A cache flush on completion has to be issued from the workqueue */
+	if (dio->flags & IOMAP_DIO_NEED_SYNC)
+		dio->flags &= ~IOMAP_DIO_INLINE_COMP;
+
 	WRITE_ONCE(iocb->private, dio->submit.poll_bio);
 
 	/*
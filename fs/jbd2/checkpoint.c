@@ -20,6 +20,7 @@
 #include <linux/errno.h>
 #include <linux/slab.h>
 #include <linux/blkdev.h>
+#include <linux/math64.h>
 #include <trace/events/jbd2.h>
 
 /*
@@ -168,6 +169,98 @@ __releases(&journal->j_state_lock)
 	}
 }
 
+/*
+ * Log occupancy in percent.  Requires j_state_lock.
+ */
+static unsigned int jbd2_log_used_percent(journal_t *journal)
+{
+	unsigned long size = journal->j_last - journal->j_first;
+
+	if (!size || journal->j_free >= size)
+		return 0;
+	return (size - journal->j_free) * 100 / size;
+}
+
+/*
+ * jbd2_log_kick_checkpoint: start background checkpointing if the log
+ * filled up beyond the checkpoint watermark.
+ *
+ * Checkpointing from __jbd2_log_wait_for_space() blocks all new handles
+ * until the log has room for a full transaction again.  Checkpointing the
+ * oldest transactions early, while the log still has room, avoids most of
+ * those stalls.
+ */
+void jbd2_log_kick_checkpoint(journal_t *journal)
+{
+	unsigned int used;
+
+	if (!journal->j_checkpoint_watermark ||
+	    delayed_work_pending(&journal->j_checkpoint_work))
+		return;
+
+	read_lock(&journal->j_state_lock);
+	used = jbd2_log_used_percent(journal);
+	if (used >= journal->j_checkpoint_watermark &&
+	    !(journal->j_flags & (JBD2_UNMOUNT | JBD2_ABORT)))
+		queue_delayed_work(jbd2_log_wq, &journal->j_checkpoint_work, 0);
+	read_unlock(&journal->j_state_lock);
+}
+
+/*
+ * Background checkpointing: checkpoint one transaction per run, then back
+ * off.  The time the checkpoint took is a measure of what the device can
+ * do, so the back-off is derived from it: just above the watermark the
+ * checkpoint keeps the device busy for about an eighth of the time, and the
+ * duty cycle grows linearly to continuous checkpointing as the log fills.
+ */
+void jbd2_checkpoint_work(struct work_struct *work)
+{
+	journal_t *journal = container_of(to_delayed_work(work), journal_t,
+					  j_checkpoint_work);
+	unsigned int used, watermark, span, over;
+	ktime_t start;
+	u64 elapsed;
+
+	read_lock(&journal->j_state_lock);
+	used = jbd2_log_used_percent(journal);
+	watermark = journal->j_checkpoint_watermark;
+	if (!watermark || used < watermark ||
+	    (journal->j_flags & (JBD2_UNMOUNT | JBD2_ABORT))) {
+		read_unlock(&journal->j_state_lock);
+		return;
+	}
+	read_unlock(&journal->j_state_lock);
+
+	/* Somebody else is checkpointing already, a later commit kicks us */
+	if (!mutex_trylock(&journal->j_checkpoint_mutex))
+		return;
+
+	spin_lock(&journal->j_list_lock);
+	if (!journal->j_checkpoint_transactions) {
+		spin_unlock(&journal->j_list_lock);
+		mutex_unlock(&journal->j_checkpoint_mutex);
+		return;
+	}
+	spin_unlock(&journal->j_list_lock);
+
+	start = ktime_get();
+	jbd2_log_do_checkpoint(journal);
+	mutex_unlock(&journal->j_checkpoint_mutex);
+	elapsed = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	read_lock(&journal->j_state_lock);
+	used = jbd2_log_used_percent(journal);
+	if (used >= watermark &&
+	    !(journal->j_flags & (JBD2_UNMOUNT | JBD2_ABORT))) {
+		span = max(100 - watermark, 1U);
+		over = clamp(used - watermark, DIV_ROUND_UP(span, 8), span);
+		queue_delayed_work(jbd2_log_wq, &journal->j_checkpoint_work,
+				   nsecs_to_jiffies(div_u64(elapsed * (span - over),
+							    over)));
+	}
+	read_unlock(&journal->j_state_lock);
+}
+
 static void
 __flush_batch(journal_t *journal, int *batch_count)
 {
@@ -24,6 +24,7 @@
 #include <linux/bio.h>
 #include <linux/blkdev.h>
 #include <linux/bitops.h>
+#include <linux/workqueue.h>
 #include <trace/events/jbd2.h>
 
 /*
@@ -372,6 +373,91 @@ static void jbd2_block_tag_csum_set(journal_t *j, journal_block_tag_t *tag,
 	else
 		tag->t_checksum = cpu_to_be16(csum32);
 }
+
+static void jbd2_submit_log_bh(struct buffer_head *bh)
+{
+	lock_buffer(bh);
+	clear_buffer_dirty(bh);
+	set_buffer_uptodate(bh);
+	bh->b_end_io = journal_end_buffer_io_sync;
+	submit_bh(REQ_OP_WRITE | REQ_SYNC, bh);
+}
+
+/*
+ * With block tag checksums, checksumming the metadata blocks dominates the
+ * time kjournald2 spends in the log writeout loop.  So once a descriptor
+ * block is full, its blocks are checksummed and submitted by a worker while
+ * kjournald2 goes on with the next descriptor block.  The commit waits for
+ * all batches to be submitted before it waits for their IO.
+ */
+struct jbd2_log_batch {
+	struct work_struct	work;
+	journal_t		*journal;
+	tid_t			tid;
+	atomic_t		*pending;	/* Batches not yet submitted */
+	int			nr;
+	struct {
+		struct buffer_head	*bh;
+		journal_block_tag_t	*tag;	/* NULL for the descriptor */
+	} blocks[];
+};
+
+static void jbd2_log_batch_work(struct work_struct *work)
+{
+	struct jbd2_log_batch *batch = container_of(work, struct jbd2_log_batch,
+						    work);
+	journal_t *journal = batch->journal;
+	atomic_t *pending = batch->pending;
+	struct blk_plug plug;
+	int i;
+
+	for (i = 0; i < batch->nr; i++)
+		if (batch->blocks[i].tag)
+			jbd2_block_tag_csum_set(journal, batch->blocks[i].tag,
+						batch->blocks[i].bh, batch->tid);
+	/* The descriptor goes first and covers the tag checksums */
+	jbd2_descriptor_block_csum_set(journal, batch->blocks[0].bh);
+
+	blk_start_plug(&plug);
+	for (i = 0; i < batch->nr; i++)
+		jbd2_submit_log_bh(batch->blocks[i].bh);
+	blk_finish_plug(&plug);
+	kfree(batch);
+
+	if (atomic_dec_and_test(pending))
+		wake_up_var(pending);
+}
+
+static struct jbd2_log_batch *jbd2_alloc_log_batch(journal_t *journal,
+						   transaction_t *transaction,
+						   atomic_t *pending)
+{
+	struct jbd2_log_batch *batch;
+
+	batch = kzalloc(struct_size(batch, blocks, journal->j_wbufsize),
+			GFP_NOFS);
+	if (!batch)
+		return NULL;
+
+	INIT_WORK(&batch->work, jbd2_log_batch_work);
+	batch->journal = journal;
+	batch->tid = transaction->t_tid;
+	batch->pending = pending;
+	return batch;
+}
+
+static void jbd2_queue_log_batch(struct jbd2_log_batch *batch,
+				 struct buffer_head **wbuf, int bufs)
+{
+	int i;
+
+	for (i = 0; i < bufs; i++)
+		batch->blocks[i].bh = wbuf[i];
+	batch->nr = bufs;
+	atomic_inc(batch->pending);
+	queue_work(jbd2_log_wq, &batch->work);
+}
+
 /*
  * jbd2_journal_commit_transaction
  *
@@ -401,6 +487,9 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	struct buffer_head *cbh = NULL; /* For transactional checksums */
 	__u32 crc32_sum = ~0;
 	struct blk_plug plug;
+	struct jbd2_log_batch *batch = NULL;
+	atomic_t batches_pending = ATOMIC_INIT(0);
+	bool parallel_log;
 	/* Tail of the journal */
 	unsigned long first_block;
 	tid_t first_tid;
@@ -605,6 +694,14 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	J_ASSERT(commit_transaction->t_nr_buffers <=
 		 atomic_read(&commit_transaction->t_outstanding_credits));
 
+	/*
+	 * The v1 transaction checksum is computed over all log blocks in
+	 * order, so it needs the blocks to be submitted from here.
+	 */
+	parallel_log = num_online_cpus() > 1 &&
+		       jbd2_journal_has_csum_v2or3(journal) &&
+		       !jbd2_has_feature_checksum(journal);
+
 	err = 0;
 	bufs = 0;
 	descriptor = NULL;
@@ -660,6 +757,10 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 			set_buffer_jwrite(descriptor);
 			set_buffer_dirty(descriptor);
 			wbuf[bufs++] = descriptor;
+			if (parallel_log)
+				batch = jbd2_alloc_log_batch(journal,
+							     commit_transaction,
+							     &batches_pending);
 
 			/* Record it so that we can wait for IO
                            completion later */
@@ -715,8 +816,11 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 		tag = (journal_block_tag_t *) tagp;
 		write_tag_block(journal, tag, jh2bh(jh)->b_blocknr);
 		tag->t_flags = cpu_to_be16(tag_flag);
-		jbd2_block_tag_csum_set(journal, tag, wbuf[bufs],
-					commit_transaction->t_tid);
+		if (batch)
+			batch->blocks[bufs].tag = tag;
+		else
+			jbd2_block_tag_csum_set(journal, tag, wbuf[bufs],
+						commit_transaction->t_tid);
 		tagp += tag_bytes;
 		space_left -= tag_bytes;
 		bufs++;
@@ -743,6 +847,12 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 
 			tag->t_flags |= cpu_to_be16(JBD2_FLAG_LAST_TAG);
 start_journal_io:
+			if (batch) {
+				jbd2_queue_log_batch(batch, wbuf, bufs);
+				batch = NULL;
+				goto next_descriptor;
+			}
+
 			if (descriptor)
 				jbd2_descriptor_block_csum_set(journal,
 							descriptor);
@@ -757,12 +867,9 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 					    jbd2_checksum_data(crc32_sum, bh);
 				}
 
-				lock_buffer(bh);
-				clear_buffer_dirty(bh);
-				set_buffer_uptodate(bh);
-				bh->b_end_io = journal_end_buffer_io_sync;
-				submit_bh(REQ_OP_WRITE | REQ_SYNC, bh);
+				jbd2_submit_log_bh(bh);
 			}
+next_descriptor:
 			cond_resched();
 
 			/* Force a new descriptor to be generated next
@@ -772,6 +879,9 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 		}
 	}
 
+	/* All log blocks must be submitted before we wait for them */
+	wait_var_event(&batches_pending, !atomic_read(&batches_pending));
+
 	err = journal_finish_inode_data_buffers(journal, commit_transaction);
 	if (err) {
 		printk(KERN_WARNING
@@ -1181,6 +1291,8 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	wake_up(&journal->j_wait_done_commit);
 	wake_up(&journal->j_fc_wait);
 
+	jbd2_log_kick_checkpoint(journal);
+
 	/*
 	 * Calculate overall stats
 	 */
@@ -1373,6 +1373,8 @@ static journal_t *journal_init_common(struct block_device *bdev,
 	journal->j_commit_interval = (HZ * JBD2_DEFAULT_MAX_COMMIT_AGE);
 	journal->j_min_batch_time = 0;
 	journal->j_max_batch_time = 15000; /* 15ms */
+	journal->j_checkpoint_watermark = JBD2_DEFAULT_CHECKPOINT_WATERMARK;
+	INIT_DELAYED_WORK(&journal->j_checkpoint_work, jbd2_checkpoint_work);
 	atomic_set(&journal->j_reserved_credits, 0);
 
 	/* The journal is marked for error until we succeed with recovery! */
@@ -2127,6 +2129,9 @@ int jbd2_journal_destroy(journal_t *journal)
 	/* Wait for the commit thread to wake up and die. */
 	journal_kill_thread(journal);
 
+	/* JBD2_UNMOUNT is set now, so the work won't be queued again */
+	cancel_delayed_work_sync(&journal->j_checkpoint_work);
+
 	/* Force a final log commit */
 	if (journal->j_running_transaction)
 		jbd2_journal_commit_transaction(journal);
@@ -3139,6 +3144,9 @@ static void jbd2_journal_destroy_handle_cache(void)
  * Module startup and shutdown
  */
 
+/* Workers for log block submission and background checkpointing */
+struct workqueue_struct *jbd2_log_wq;
+
 static int __init journal_init_caches(void)
 {
 	int ret;
@@ -3175,6 +3183,12 @@ static int __init journal_init(void)
 	BUILD_BUG_ON(sizeof(struct journal_superblock_s) != 1024);
 
 	ret = journal_init_caches();
+	if (ret == 0) {
+		jbd2_log_wq = alloc_workqueue("jbd2-log",
+					      WQ_MEM_RECLAIM | WQ_UNBOUND, 0);
+		if (!jbd2_log_wq)
+			ret = -ENOMEM;
+	}
 	if (ret == 0) {
 		jbd2_create_jbd_stats_proc_entry();
 	} else {
@@ -3191,6 +3205,7 @@ static void __exit journal_exit(void)
 		printk(KERN_ERR "JBD2: leaked %d journal_heads!\n", n);
 #endif
 	jbd2_remove_jbd_stats_proc_entry();
+	destroy_workqueue(jbd2_log_wq);
 	jbd2_journal_destroy_caches();
 }
 
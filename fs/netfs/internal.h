@@ -57,6 +57,7 @@ extern atomic_t netfs_n_rh_readahead;
 extern atomic_t netfs_n_rh_readpage;
 extern atomic_t netfs_n_rh_rreq;
 extern atomic_t netfs_n_rh_sreq;
+extern atomic_t netfs_n_rh_sreq_split;
 extern atomic_t netfs_n_rh_download;
 extern atomic_t netfs_n_rh_download_done;
 extern atomic_t netfs_n_rh_download_failed;
@@ -12,10 +12,21 @@
 #include <linux/pagemap.h>
 #include <linux/slab.h>
 #include <linux/uio.h>
+#include <linux/math64.h>
 #include <linux/sched/mm.h>
 #include <linux/task_io_accounting_ops.h>
 #include "internal.h"
 
+/*
+ * Download subrequests are cut to about the bandwidth-delay product observed
+ * for the inode so that a large read is split into slices that are in flight
+ * at the same time, but no slice is so small that it is dominated by the
+ * latency of the server.
+ */
+#define NETFS_READ_MIN_SLICE	(256 * 1024)	/* Smallest slice to cut */
+#define NETFS_READ_MAX_SLICES	16		/* Most slices per request */
+#define NETFS_READ_MIN_SAMPLES	4		/* Samples before adapting */
+
 /*
  * Clear the unread part of an I/O request.
  */
@@ -88,9 +99,64 @@ static void netfs_read_from_server(struct netfs_io_request *rreq,
 				   struct netfs_io_subrequest *subreq)
 {
 	netfs_stat(&netfs_n_rh_download);
+	subreq->issue_time = ktime_get();
 	rreq->netfs_ops->issue_read(subreq);
 }
 
+/*
+ * Fold a completed download into the read stats of the inode.  The latency is
+ * a minimum filter over the elapsed times which is allowed to creep up so that
+ * it follows a link that got slower; the bandwidth is a moving average.  No
+ * lock is taken: racing completions may lose a sample, which is harmless.
+ */
+static void netfs_read_stats_sample(struct netfs_io_subrequest *subreq,
+				    size_t transferred)
+{
+	struct netfs_read_stats *st = &netfs_inode(subreq->rreq->inode)->read_stats;
+	u64 elapsed, lat;
+	unsigned long bw, old_bw;
+
+	elapsed = max_t(s64, ktime_to_ns(ktime_sub(ktime_get(),
+						   subreq->issue_time)), 1);
+
+	lat = READ_ONCE(st->lat_ns);
+	lat = lat ? min(elapsed, lat + (lat >> 6)) : elapsed;
+	WRITE_ONCE(st->lat_ns, lat);
+
+	bw = div64_u64((u64)transferred * NSEC_PER_MSEC, elapsed);
+	old_bw = READ_ONCE(st->bw);
+	if (old_bw)
+		bw = old_bw - (old_bw >> 3) + (bw >> 3);
+	WRITE_ONCE(st->bw, bw);
+
+	if (READ_ONCE(st->nr_samples) < NETFS_READ_MIN_SAMPLES)
+		WRITE_ONCE(st->nr_samples, st->nr_samples + 1);
+}
+
+/*
+ * Work out how much of the rest of a read to put into the next slice.
+ */
+static size_t netfs_read_slice_len(struct netfs_io_request *rreq)
+{
+	struct netfs_read_stats *st = &netfs_inode(rreq->inode)->read_stats;
+	size_t len = rreq->len - rreq->submitted;
+	u64 slice;
+
+	if (READ_ONCE(st->nr_samples) < NETFS_READ_MIN_SAMPLES)
+		return len;
+
+	slice = div_u64((u64)READ_ONCE(st->bw) * READ_ONCE(st->lat_ns),
+			NSEC_PER_MSEC);
+	slice = max_t(u64, slice, NETFS_READ_MIN_SLICE);
+	slice = max_t(u64, slice, DIV_ROUND_UP(rreq->len, NETFS_READ_MAX_SLICES));
+	slice = round_up(slice, PAGE_SIZE);
+	if (slice >= len)
+		return len;
+
+	netfs_stat(&netfs_n_rh_sreq_split);
+	return slice;
+}
+
 /*
  * Release those waiting.
  */
@@ -406,6 +472,8 @@ void netfs_subreq_terminated(struct netfs_io_subrequest *subreq,
 		break;
 	case NETFS_DOWNLOAD_FROM_SERVER:
 		netfs_stat(&netfs_n_rh_download_done);
+		if (transferred_or_error > 0)
+			netfs_read_stats_sample(subreq, transferred_or_error);
 		break;
 	default:
 		break;
@@ -549,7 +617,7 @@ static bool netfs_rreq_submit_slice(struct netfs_io_request *rreq,
 
 	subreq->debug_index	= (*_debug_index)++;
 	subreq->start		= rreq->start + rreq->submitted;
-	subreq->len		= rreq->len   - rreq->submitted;
+	subreq->len		= netfs_read_slice_len(rreq);
 
 	_debug("slice %llx,%zx,%zx", subreq->start, subreq->len, rreq->submitted);
 	list_add_tail(&subreq->rreq_link, &rreq->subrequests);
@@ -124,7 +124,14 @@ int fsnotify_insert_event(struct fsnotify_group *group,
 		insert(group, event);
 	spin_unlock(&group->notification_lock);
 
-	wake_up(&group->notification_waitq);
+	/*
+	 * Under load the reader is usually already running and draining the
+	 * queue, so skip the waitqueue lock when nobody waits on it.  Readers
+	 * and pollers queue themselves before they check the queue under
+	 * notification_lock, so they either see this event or are seen here.
+	 */
+	if (wq_has_sleeper(&group->notification_waitq))
+		wake_up(&group->notification_waitq);
 	kill_fasync(&group->fsn_fa, SIGIO, POLL_IN);
 	return ret;
 }
@@ -19,6 +19,7 @@
 #include <linux/fdtable.h>
 #include <linux/ratelimit.h>
 #include <linux/exportfs.h>
+#include <linux/workqueue.h>
 #include "overlayfs.h"
 
 #define OVL_COPY_UP_CHUNK_SIZE (1 << 20)
@@ -952,9 +953,86 @@ static int ovl_copy_up_meta_inode_data(struct ovl_copy_up_ctx *c)
 	return err;
 }
 
+/*
+ * With lazy_copyup=on, the data of a file that was copied up metadata only is
+ * copied up in the background, so that the first write to it usually finds
+ * the data already in place instead of copying the whole file.  A writer that
+ * comes while the background copy up is running waits for it to finish on the
+ * copy up lock, as it would for any other racing copy up.
+ */
+static struct workqueue_struct *ovl_copy_up_wq;
+
+struct ovl_lazy_copy_up {
+	struct work_struct work;
+	struct dentry *dentry;
+};
+
+static void ovl_lazy_copy_up_work(struct work_struct *work)
+{
+	struct ovl_lazy_copy_up *lc =
+		container_of(work, struct ovl_lazy_copy_up, work);
+	struct dentry *dentry = lc->dentry;
+	struct ovl_fs *ofs = OVL_FS(dentry->d_sb);
+
+	/*
+	 * Failure is not an error here, the data will be copied up by the
+	 * first writer instead.  Don't bother with files that are gone.
+	 */
+	if (!d_unhashed(dentry) && !ovl_want_write(dentry)) {
+		ovl_copy_up_with_data(dentry);
+		ovl_drop_write(dentry);
+	}
+	dput(dentry);
+	kfree(lc);
+
+	if (atomic_dec_and_test(&ofs->lazy_copy_ups))
+		wake_up_var(&ofs->lazy_copy_ups);
+}
+
+static void ovl_queue_lazy_copy_up(struct dentry *dentry)
+{
+	struct ovl_fs *ofs = OVL_FS(dentry->d_sb);
+	struct ovl_lazy_copy_up *lc;
+
+	lc = kmalloc(sizeof(*lc), GFP_KERNEL);
+	if (!lc)
+		return;
+
+	INIT_WORK(&lc->work, ovl_lazy_copy_up_work);
+	lc->dentry = dget(dentry);
+	atomic_inc(&ofs->lazy_copy_ups);
+	queue_work(ovl_copy_up_wq, &lc->work);
+}
+
+/* Called on unmount, before the dentries of the overlay are pruned. */
+void ovl_wait_lazy_copy_ups(struct ovl_fs *ofs)
+{
+	wait_var_event(&ofs->lazy_copy_ups, !atomic_read(&ofs->lazy_copy_ups));
+}
+
+int __init ovl_copy_up_wq_init(void)
+{
+	/*
+	 * Background copy up is only an optimization, don't let it compete
+	 * with foreground I/O for more than one worker per CPU.
+	 */
+	ovl_copy_up_wq = alloc_workqueue("ovl_copy_up", 0, 1);
+	if (!ovl_copy_up_wq)
+		return -ENOMEM;
+
+	return 0;
+}
+
+void ovl_copy_up_wq_destroy(void)
+{
+	destroy_workqueue(ovl_copy_up_wq);
+}
+
 static int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 			   int flags)
 {
+	struct ovl_fs *ofs = OVL_FS(dentry->d_sb);
+	bool lazy = false;
 	int err;
 	DEFINE_DELAYED_CALL(done);
 	struct path parentpath;
@@ -1003,8 +1081,11 @@ static int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 		if (err > 0)
 			err = 0;
 	} else {
-		if (!ovl_dentry_upper(dentry))
+		if (!ovl_dentry_upper(dentry)) {
 			err = ovl_do_copy_up(&ctx);
+			lazy = !err && ctx.metacopy &&
+			       ofs->config.lazy_copyup;
+		}
 		if (!err && parent && !ovl_dentry_has_upper_alias(dentry))
 			err = ovl_link_up(&ctx);
 		if (!err && ovl_dentry_needs_data_copy_up_locked(dentry, flags))
@@ -1013,6 +1094,9 @@ static int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 	}
 	do_delayed_call(&done);
 
+	if (lazy && !ovl_has_upperdata(d_inode(dentry)))
+		ovl_queue_lazy_copy_up(dentry);
+
 	return err;
 }
 
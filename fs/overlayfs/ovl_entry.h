@@ -18,6 +18,7 @@ struct ovl_config {
 	bool nfs_export;
 	int xino;
 	bool metacopy;
+	bool lazy_copyup;
 	bool userxattr;
 	bool ovl_volatile;
 };
@@ -83,6 +84,8 @@ struct ovl_fs {
 	struct dentry *whiteout;
 	/* r/o snapshot of upperdir sb's only taken on volatile mounts */
 	errseq_t errseq;
+	/* Number of queued background data copy ups */
+	atomic_t lazy_copy_ups;
 };
 
 static inline struct vfsmount *ovl_upper_mnt(struct ovl_fs *ofs)
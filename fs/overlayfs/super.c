@@ -382,6 +382,8 @@ static int ovl_show_options(struct seq_file *m, struct dentry *dentry)
 	if (ofs->config.metacopy != ovl_metacopy_def)
 		seq_printf(m, ",metacopy=%s",
 			   ofs->config.metacopy ? "on" : "off");
+	if (ofs->config.lazy_copyup)
+		seq_puts(m, ",lazy_copyup=on");
 	if (ofs->config.ovl_volatile)
 		seq_puts(m, ",volatile");
 	if (ofs->config.userxattr)
@@ -440,6 +442,8 @@ enum {
 	OPT_XINO_AUTO,
 	OPT_METACOPY_ON,
 	OPT_METACOPY_OFF,
+	OPT_LAZY_COPYUP_ON,
+	OPT_LAZY_COPYUP_OFF,
 	OPT_VOLATILE,
 	OPT_ERR,
 };
@@ -462,6 +466,8 @@ static const match_table_t ovl_tokens = {
 	{OPT_XINO_AUTO,			"xino=auto"},
 	{OPT_METACOPY_ON,		"metacopy=on"},
 	{OPT_METACOPY_OFF,		"metacopy=off"},
+	{OPT_LAZY_COPYUP_ON,		"lazy_copyup=on"},
+	{OPT_LAZY_COPYUP_OFF,		"lazy_copyup=off"},
 	{OPT_VOLATILE,			"volatile"},
 	{OPT_ERR,			NULL}
 };
@@ -615,6 +621,14 @@ static int ovl_parse_opt(char *opt, struct ovl_config *config)
 			metacopy_opt = true;
 			break;
 
+		case OPT_LAZY_COPYUP_ON:
+			config->lazy_copyup = true;
+			break;
+
+		case OPT_LAZY_COPYUP_OFF:
+			config->lazy_copyup = false;
+			break;
+
 		case OPT_VOLATILE:
 			config->ovl_volatile = true;
 			break;
@@ -748,6 +762,12 @@ static int ovl_parse_opt(char *opt, struct ovl_config *config)
 		config->metacopy = false;
 	}
 
+	/* Resolve lazy_copyup -> metacopy dependency */
+	if (config->lazy_copyup && !config->metacopy) {
+		pr_info("disabling lazy_copyup due to metacopy=off\n");
+		config->lazy_copyup = false;
+	}
+
 	return 0;
 }
 
@@ -2181,12 +2201,20 @@ static struct dentry *ovl_mount(struct file_system_type *fs_type, int flags,
 	return mount_nodev(fs_type, flags, raw_data, ovl_fill_super);
 }
 
+static void ovl_kill_sb(struct super_block *sb)
+{
+	/* Background copy ups hold dentry references, let them finish first */
+	if (sb->s_root)
+		ovl_wait_lazy_copy_ups(OVL_FS(sb));
+	kill_anon_super(sb);
+}
+
 static struct file_system_type ovl_fs_type = {
 	.owner		= THIS_MODULE,
 	.name		= "overlay",
 	.fs_flags	= FS_USERNS_MOUNT,
 	.mount		= ovl_mount,
-	.kill_sb	= kill_anon_super,
+	.kill_sb	= ovl_kill_sb,
 };
 MODULE_ALIAS_FS("overlay");
 
@@ -2210,13 +2238,21 @@ static int __init ovl_init(void)
 		return -ENOMEM;
 
 	err = ovl_aio_request_cache_init();
-	if (!err) {
-		err = register_filesystem(&ovl_fs_type);
-		if (!err)
-			return 0;
+	if (err)
+		goto out_inode_cache;
 
-		ovl_aio_request_cache_destroy();
-	}
+	err = ovl_copy_up_wq_init();
+	if (err)
+		goto out_aio_cache;
+
+	err = register_filesystem(&ovl_fs_type);
+	if (!err)
+		return 0;
+
+	ovl_copy_up_wq_destroy();
+out_aio_cache:
+	ovl_aio_request_cache_destroy();
+out_inode_cache:
 	kmem_cache_destroy(ovl_inode_cachep);
 
 	return err;
@@ -2232,6 +2268,7 @@ static void __exit ovl_exit(void)
 	 */
 	rcu_barrier();
 	kmem_cache_destroy(ovl_inode_cachep);
+	ovl_copy_up_wq_destroy();
 	ovl_aio_request_cache_destroy();
 }
 
@@ -91,6 +91,7 @@
 #include <linux/user_namespace.h>
 #include <linux/fs_struct.h>
 #include <linux/kthread.h>
+#include <linux/proc_pidstats.h>
 
 #include <asm/processor.h>
 #include "internal.h"
@@ -696,6 +697,59 @@ int proc_pid_statm(struct seq_file *m, struct pid_namespace *ns,
 	return 0;
 }
 
+/*
+ * Fill in a /proc/pidstats record for the thread group of @task.  This is the
+ * binary counterpart of proc_tgid_stat() and reports the same values, without
+ * the ones that depend on ptrace access.
+ */
+void proc_pid_fill_stats(struct proc_pidstats *st, struct pid_namespace *ns,
+			 struct user_namespace *user_ns,
+			 struct task_struct *task)
+{
+	struct mm_struct *mm;
+	unsigned long flags;
+	u64 utime = 0, stime = 0;
+
+	memset(st, 0, sizeof(*st));
+	st->size = sizeof(*st);
+	st->pid = task_tgid_nr_ns(task, ns);
+	st->state = *get_task_state(task);
+	st->nice = task_nice(task);
+	st->start_time_ns = timens_add_boottime_ns(task->start_boottime);
+	rcu_read_lock();
+	st->uid = from_kuid_munged(user_ns, task_uid(task));
+	rcu_read_unlock();
+	__get_task_comm(st->comm, sizeof(st->comm), task);
+
+	mm = get_task_mm(task);
+	if (mm) {
+		st->vsize = task_vsize(mm);
+		st->rss_anon = get_mm_counter(mm, MM_ANONPAGES) << PAGE_SHIFT;
+		st->rss_file = get_mm_counter(mm, MM_FILEPAGES) << PAGE_SHIFT;
+		st->rss_shmem = get_mm_counter(mm, MM_SHMEMPAGES) << PAGE_SHIFT;
+		mmput(mm);
+	}
+
+	if (lock_task_sighand(task, &flags)) {
+		struct signal_struct *sig = task->signal;
+		struct task_struct *t = task;
+
+		st->num_threads = get_nr_threads(task);
+		do {
+			st->min_flt += t->min_flt;
+			st->maj_flt += t->maj_flt;
+		} while_each_thread(task, t);
+		st->min_flt += sig->min_flt;
+		st->maj_flt += sig->maj_flt;
+		thread_group_cputime_adjusted(task, &utime, &stime);
+		st->ppid = task_tgid_nr_ns(task->real_parent, ns);
+
+		unlock_task_sighand(task, &flags);
+	}
+	st->utime_ns = utime;
+	st->stime_ns = stime;
+}
+
 #ifdef CONFIG_PROC_CHILDREN
 static struct pid *
 get_children_pid(struct inode *inode, struct pid *pid_prev, loff_t pos)
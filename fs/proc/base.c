@@ -96,6 +96,7 @@
 #include <linux/time_namespace.h>
 #include <linux/resctrl.h>
 #include <linux/cn_proc.h>
+#include <linux/proc_pidstats.h>
 #include <trace/events/oom.h>
 #include "internal.h"
 #include "fd.h"
@@ -3545,6 +3546,69 @@ int proc_pid_readdir(struct file *file, struct dir_context *ctx)
 	return 0;
 }
 
+/*
+ * /proc/pidstats: the stat and memory counters of many thread groups per
+ * read(2), as fixed size binary records.  The file position is the tgid to
+ * continue from.
+ */
+static ssize_t proc_pidstats_read(struct file *file, char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	struct proc_fs_info *fs_info = proc_sb_info(file_inode(file)->i_sb);
+	struct pid_namespace *ns = proc_pid_ns(file_inode(file)->i_sb);
+	struct user_namespace *user_ns = file->f_cred->user_ns;
+	struct proc_pidstats st;
+	struct tgid_iter iter;
+	ssize_t done = 0;
+	int ret = 0;
+
+	if (count < sizeof(st))
+		return -EINVAL;
+	if (*ppos < 0)
+		return -EINVAL;
+	if (*ppos >= PID_MAX_LIMIT)
+		return 0;
+
+	iter.tgid = *ppos;
+	iter.task = NULL;
+	for (iter = next_tgid(ns, iter);
+	     iter.task;
+	     iter.tgid += 1, iter = next_tgid(ns, iter)) {
+		if (count - done < sizeof(st)) {
+			put_task_struct(iter.task);
+			break;
+		}
+
+		cond_resched();
+		if (!has_pid_permissions(fs_info, iter.task, HIDEPID_INVISIBLE))
+			continue;
+
+		proc_pid_fill_stats(&st, ns, user_ns, iter.task);
+		if (copy_to_user(buf + done, &st, sizeof(st))) {
+			put_task_struct(iter.task);
+			ret = -EFAULT;
+			break;
+		}
+		done += sizeof(st);
+		*ppos = iter.tgid + 1;
+	}
+	if (!iter.task)
+		*ppos = PID_MAX_LIMIT;
+
+	return done ?: ret;
+}
+
+static const struct proc_ops proc_pidstats_ops = {
+	.proc_flags	= PROC_ENTRY_PERMANENT,
+	.proc_read	= proc_pidstats_read,
+	.proc_lseek	= default_llseek,
+};
+
+void __init proc_pidstats_init(void)
+{
+	proc_create("pidstats", 0444, NULL, &proc_pidstats_ops);
+}
+
 /*
  * proc_tid_comm_permission is a special permission function exclusively
  * used for the node /proc/<pid>/task/<tid>/comm.
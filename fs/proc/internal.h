@@ -157,6 +157,9 @@ extern int proc_pid_status(struct seq_file *, struct pid_namespace *,
 			   struct pid *, struct task_struct *);
 extern int proc_pid_statm(struct seq_file *, struct pid_namespace *,
 			  struct pid *, struct task_struct *);
+struct proc_pidstats;
+extern void proc_pid_fill_stats(struct proc_pidstats *, struct pid_namespace *,
+				struct user_namespace *, struct task_struct *);
 
 /*
  * base.c
@@ -167,6 +170,7 @@ extern int pid_getattr(struct user_namespace *, const struct path *,
 extern int proc_setattr(struct user_namespace *, struct dentry *,
 			struct iattr *);
 extern void proc_pid_evict_inode(struct proc_inode *);
+extern void proc_pidstats_init(void);
 extern struct inode *proc_pid_make_inode(struct super_block *, struct task_struct *, umode_t);
 extern void pid_update_inode(struct task_struct *, struct inode *);
 extern int pid_delete_dentry(const struct dentry *);
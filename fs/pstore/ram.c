@@ -21,6 +21,11 @@
 #include <linux/pstore_ram.h>
 #include <linux/of.h>
 #include <linux/of_address.h>
+#include <linux/console.h>
+#include <linux/crypto.h>
+#include <linux/irq_work.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
 #include "internal.h"
 
 #define RAMOOPS_KERNMSG_HDR "===="
@@ -35,6 +40,11 @@ static ulong ramoops_console_size = MIN_MEM_SIZE;
 module_param_named(console_size, ramoops_console_size, ulong, 0400);
 MODULE_PARM_DESC(console_size, "size of kernel console log");
 
+static char *ramoops_console_compress;
+module_param_named(console_compress, ramoops_console_compress, charp, 0400);
+MODULE_PARM_DESC(console_compress,
+		"compression algorithm for the console log archive (default: none)");
+
 static ulong ramoops_ftrace_size = MIN_MEM_SIZE;
 module_param_named(ftrace_size, ramoops_ftrace_size, ulong, 0400);
 MODULE_PARM_DESC(ftrace_size, "size of ftrace log");
@@ -78,6 +88,7 @@ MODULE_PARM_DESC(dump_oops,
 struct ramoops_context {
 	struct persistent_ram_zone **dprzs;	/* Oops dump zones */
 	struct persistent_ram_zone *cprz;	/* Console zone */
+	struct persistent_ram_zone *czprz;	/* Compressed console archive */
 	struct persistent_ram_zone **fprzs;	/* Ftrace zones */
 	struct persistent_ram_zone *mprz;	/* PMSG zone */
 	phys_addr_t phys_addr;
@@ -97,6 +108,14 @@ struct ramoops_context {
 	unsigned int max_ftrace_cnt;
 	unsigned int ftrace_read_cnt;
 	unsigned int pmsg_read_cnt;
+	/* Console archiving, only used when czprz is set */
+	struct crypto_comp *console_tfm;
+	char *console_buf;
+	char *console_zbuf;
+	size_t console_written;
+	struct irq_work console_irq_work;
+	struct work_struct console_work;
+	struct mutex console_mutex;	/* archive work vs. erase */
 	struct pstore_info pstore;
 };
 
@@ -173,6 +192,176 @@ static bool prz_ok(struct persistent_ram_zone *prz)
 			   persistent_ram_ecc_string(prz, NULL, 0));
 }
 
+/*
+ * Console log archive.
+ *
+ * With console_compress set, the console area is split into a small raw
+ * console zone, which keeps receiving the console output exactly as before, and
+ * an archive zone that takes the rest.  Once the raw zone is half full, a
+ * worker moves its contents into the archive as one compressed chunk and
+ * empties it.  All compression happens from process context, so nothing is
+ * added to what runs at panic time: whatever hasn't been archived yet is still
+ * in the raw zone.  On the next boot, the archived chunks followed by the raw
+ * zone are presented as the console record.
+ *
+ * The archive is a ring like every other zone, so its oldest chunk may have
+ * been partially overwritten.  Chunks are located by their magic and skipped
+ * when they don't look right or fail to decompress.
+ */
+#define RAMOOPS_CONSOLE_CHUNK_MAGIC	0x4b4e4843	/* CHNK */
+#define RAMOOPS_CONSOLE_CHUNK_RAW	BIT(0)
+
+struct ramoops_console_chunk {
+	u32 magic;
+	u32 flags;
+	u32 size;	/* uncompressed size */
+	u32 zsize;	/* stored size */
+};
+
+static void ramoops_console_irq_work(struct irq_work *work)
+{
+	struct ramoops_context *cxt = container_of(work, struct ramoops_context,
+						   console_irq_work);
+
+	queue_work(system_unbound_wq, &cxt->console_work);
+}
+
+static void ramoops_console_archive_work(struct work_struct *work)
+{
+	struct ramoops_context *cxt = container_of(work, struct ramoops_context,
+						   console_work);
+	struct ramoops_console_chunk chunk = {
+		.magic = RAMOOPS_CONSOLE_CHUNK_MAGIC,
+	};
+	unsigned int zsize = cxt->cprz->buffer_size;
+	size_t len, written, keep = 0;
+
+	mutex_lock(&cxt->console_mutex);
+
+	/* Console writes are serialized by the console lock. */
+	console_lock();
+	len = persistent_ram_copy(cxt->cprz, cxt->console_buf);
+	written = cxt->console_written;
+	console_unlock();
+	if (!len)
+		goto out;
+
+	chunk.size = len;
+	if (!crypto_comp_compress(cxt->console_tfm, cxt->console_buf, len,
+				  cxt->console_zbuf, &zsize) && zsize < len) {
+		chunk.zsize = zsize;
+		persistent_ram_write(cxt->czprz, &chunk, sizeof(chunk));
+		persistent_ram_write(cxt->czprz, cxt->console_zbuf, zsize);
+	} else {
+		chunk.flags = RAMOOPS_CONSOLE_CHUNK_RAW;
+		chunk.zsize = len;
+		persistent_ram_write(cxt->czprz, &chunk, sizeof(chunk));
+		persistent_ram_write(cxt->czprz, cxt->console_buf, len);
+	}
+
+	/*
+	 * Empty the raw zone, keeping whatever was written to it while the
+	 * chunk was being compressed.
+	 */
+	console_lock();
+	if (cxt->console_written != written) {
+		len = persistent_ram_copy(cxt->cprz, cxt->console_buf);
+		keep = min(cxt->console_written - written, len);
+	}
+	persistent_ram_zap(cxt->cprz);
+	if (keep)
+		persistent_ram_write(cxt->cprz, cxt->console_buf + len - keep,
+				     keep);
+	cxt->console_written = keep;
+	console_unlock();
+out:
+	mutex_unlock(&cxt->console_mutex);
+}
+
+static void ramoops_console_write(struct ramoops_context *cxt,
+				  const char *buf, size_t size)
+{
+	persistent_ram_write(cxt->cprz, buf, size);
+	if (!cxt->czprz)
+		return;
+
+	/* This may run in any context, so defer the archiving via irq_work. */
+	cxt->console_written += size;
+	if (cxt->console_written >= cxt->cprz->buffer_size / 2)
+		irq_work_queue(&cxt->console_irq_work);
+}
+
+/* Find the next plausible chunk at or after *off in the old archive. */
+static bool ramoops_console_next_chunk(const char *log, size_t log_size,
+				       size_t max_size, size_t *off,
+				       struct ramoops_console_chunk *chunk)
+{
+	for (; *off + sizeof(*chunk) <= log_size; (*off)++) {
+		memcpy(chunk, log + *off, sizeof(*chunk));
+		if (chunk->magic != RAMOOPS_CONSOLE_CHUNK_MAGIC ||
+		    chunk->size > max_size || !chunk->zsize ||
+		    chunk->zsize > log_size - *off - sizeof(*chunk))
+			continue;
+		if (chunk->flags & RAMOOPS_CONSOLE_CHUNK_RAW ?
+		    chunk->zsize != chunk->size : chunk->zsize >= chunk->size)
+			continue;
+		return true;
+	}
+	return false;
+}
+
+static ssize_t ramoops_read_console(struct ramoops_context *cxt,
+				    struct pstore_record *record)
+{
+	struct persistent_ram_zone *prz = cxt->cprz;
+	const char *log = persistent_ram_old(cxt->czprz);
+	size_t log_size = persistent_ram_old_size(cxt->czprz);
+	size_t raw_size = persistent_ram_old_size(prz);
+	size_t max_size = prz->buffer_size;
+	struct ramoops_console_chunk chunk;
+	size_t off, total = raw_size;
+	ssize_t size = 0;
+
+	for (off = 0; log &&
+	     ramoops_console_next_chunk(log, log_size, max_size, &off, &chunk);
+	     off += sizeof(chunk) + chunk.zsize)
+		total += chunk.size;
+	if (!total)
+		return 0;
+
+	record->type = PSTORE_TYPE_CONSOLE;
+	record->id = 0;
+	record->ecc_notice_size = persistent_ram_ecc_string(prz, NULL, 0);
+	record->buf = kmalloc(total + record->ecc_notice_size + 1, GFP_KERNEL);
+	if (!record->buf)
+		return -ENOMEM;
+
+	for (off = 0; log &&
+	     ramoops_console_next_chunk(log, log_size, max_size, &off, &chunk);
+	     off += sizeof(chunk) + chunk.zsize) {
+		const char *data = log + off + sizeof(chunk);
+		unsigned int dlen = chunk.size;
+
+		if (chunk.flags & RAMOOPS_CONSOLE_CHUNK_RAW)
+			memcpy(record->buf + size, data, chunk.size);
+		else if (crypto_comp_decompress(cxt->console_tfm, data,
+						chunk.zsize,
+						record->buf + size, &dlen) ||
+			 dlen != chunk.size)
+			continue;
+		size += chunk.size;
+	}
+
+	if (raw_size)
+		memcpy(record->buf + size, persistent_ram_old(prz), raw_size);
+	size += raw_size;
+
+	persistent_ram_ecc_string(prz, record->buf + size,
+				  record->ecc_notice_size + 1);
+
+	return size;
+}
+
 static ssize_t ramoops_pstore_read(struct pstore_record *record)
 {
 	ssize_t size = 0;
@@ -207,8 +396,16 @@ static ssize_t ramoops_pstore_read(struct pstore_record *record)
 		}
 	}
 
-	if (!prz_ok(prz) && !cxt->console_read_cnt++)
-		prz = ramoops_get_next_prz(&cxt->cprz, 0 /* single */, record);
+	if (!prz_ok(prz) && !cxt->console_read_cnt++) {
+		if (cxt->czprz) {
+			size = ramoops_read_console(cxt, record);
+			if (size)
+				return size;
+		} else {
+			prz = ramoops_get_next_prz(&cxt->cprz, 0 /* single */,
+						   record);
+		}
+	}
 
 	if (!prz_ok(prz) && !cxt->pmsg_read_cnt++)
 		prz = ramoops_get_next_prz(&cxt->mprz, 0 /* single */, record);
@@ -313,7 +510,7 @@ static int notrace ramoops_pstore_write(struct pstore_record *record)
 	if (record->type == PSTORE_TYPE_CONSOLE) {
 		if (!cxt->cprz)
 			return -ENOMEM;
-		persistent_ram_write(cxt->cprz, record->buf, record->size);
+		ramoops_console_write(cxt, record->buf, record->size);
 		return 0;
 	} else if (record->type == PSTORE_TYPE_FTRACE) {
 		int zonenum;
@@ -416,6 +613,16 @@ static int ramoops_pstore_erase(struct pstore_record *record)
 		break;
 	case PSTORE_TYPE_CONSOLE:
 		prz = cxt->cprz;
+		if (cxt->czprz) {
+			/* Don't let the archive work write a chunk meanwhile. */
+			mutex_lock(&cxt->console_mutex);
+			persistent_ram_free_old(cxt->czprz);
+			persistent_ram_zap(cxt->czprz);
+			persistent_ram_free_old(prz);
+			persistent_ram_zap(prz);
+			mutex_unlock(&cxt->console_mutex);
+			return 0;
+		}
 		break;
 	case PSTORE_TYPE_FTRACE:
 		if (record->id >= cxt->max_ftrace_cnt)
@@ -600,6 +807,77 @@ static int ramoops_init_prz(const char *name,
 	return 0;
 }
 
+static void ramoops_free_console(struct ramoops_context *cxt)
+{
+	if (cxt->czprz) {
+		irq_work_sync(&cxt->console_irq_work);
+		cancel_work_sync(&cxt->console_work);
+		persistent_ram_free(cxt->czprz);
+		cxt->czprz = NULL;
+	}
+	kfree(cxt->console_buf);
+	kfree(cxt->console_zbuf);
+	cxt->console_buf = cxt->console_zbuf = NULL;
+	if (cxt->console_tfm) {
+		crypto_free_comp(cxt->console_tfm);
+		cxt->console_tfm = NULL;
+	}
+	persistent_ram_free(cxt->cprz);
+	cxt->cprz = NULL;
+}
+
+static int ramoops_init_console(struct device *dev,
+				struct ramoops_context *cxt,
+				phys_addr_t *paddr)
+{
+	size_t raw_size = cxt->console_size;
+	int err;
+
+	/* Give the raw console zone a quarter of the area, the archive the rest. */
+	if (IS_ENABLED(CONFIG_PSTORE_COMPRESS) && ramoops_console_compress &&
+	    *ramoops_console_compress &&
+	    cxt->console_size >= 4 * MIN_MEM_SIZE) {
+		cxt->console_tfm = crypto_alloc_comp(ramoops_console_compress,
+						     0, 0);
+		if (IS_ERR(cxt->console_tfm)) {
+			dev_warn(dev, "console compression %s unavailable: %ld\n",
+				 ramoops_console_compress,
+				 PTR_ERR(cxt->console_tfm));
+			cxt->console_tfm = NULL;
+		} else {
+			raw_size = cxt->console_size / 4;
+			init_irq_work(&cxt->console_irq_work,
+				      ramoops_console_irq_work);
+			INIT_WORK(&cxt->console_work,
+				  ramoops_console_archive_work);
+			mutex_init(&cxt->console_mutex);
+		}
+	}
+
+	err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, paddr,
+			       raw_size, 0);
+	if (err || !cxt->console_tfm)
+		goto fail;
+
+	err = ramoops_init_prz("console", dev, cxt, &cxt->czprz, paddr,
+			       cxt->console_size - raw_size, 0);
+	if (err)
+		goto fail;
+
+	err = -ENOMEM;
+	cxt->console_buf = kmalloc(cxt->cprz->buffer_size, GFP_KERNEL);
+	cxt->console_zbuf = kmalloc(cxt->cprz->buffer_size, GFP_KERNEL);
+	if (!cxt->console_buf || !cxt->console_zbuf)
+		goto fail;
+
+	return 0;
+
+fail:
+	if (err)
+		ramoops_free_console(cxt);
+	return err;
+}
+
 /* Read a u32 from a dt property and make sure it's safe for an int. */
 static int ramoops_parse_dt_u32(struct platform_device *pdev,
 				const char *propname,
@@ -774,8 +1052,7 @@ static int ramoops_probe(struct platform_device *pdev)
 	if (err)
 		goto fail_out;
 
-	err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, &paddr,
-			       cxt->console_size, 0);
+	err = ramoops_init_console(dev, cxt, &paddr);
 	if (err)
 		goto fail_init_cprz;
 
@@ -860,7 +1137,7 @@ static int ramoops_probe(struct platform_device *pdev)
 	persistent_ram_free(cxt->mprz);
 fail_init_mprz:
 fail_init_fprz:
-	persistent_ram_free(cxt->cprz);
+	ramoops_free_console(cxt);
 fail_init_cprz:
 	ramoops_free_przs(cxt);
 fail_out:
@@ -877,7 +1154,7 @@ static int ramoops_remove(struct platform_device *pdev)
 	cxt->pstore.bufsize = 0;
 
 	persistent_ram_free(cxt->mprz);
-	persistent_ram_free(cxt->cprz);
+	ramoops_free_console(cxt);
 	ramoops_free_przs(cxt);
 
 	return 0;
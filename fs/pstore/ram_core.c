@@ -312,6 +312,23 @@ void persistent_ram_save_old(struct persistent_ram_zone *prz)
 	memcpy_fromio(prz->old_log + size - start, &buffer->data[0], start);
 }
 
+/*
+ * Copy the current contents of the zone into @dst, oldest byte first.  @dst
+ * must be able to hold prz->buffer_size bytes.  Returns the number of bytes
+ * copied.  The caller must keep writers to the zone away.
+ */
+size_t persistent_ram_copy(struct persistent_ram_zone *prz, void *dst)
+{
+	struct persistent_ram_buffer *buffer = prz->buffer;
+	size_t size = buffer_size(prz);
+	size_t start = buffer_start(prz);
+
+	memcpy_fromio(dst, &buffer->data[start], size - start);
+	memcpy_fromio(dst + size - start, &buffer->data[0], start);
+
+	return size;
+}
+
 int notrace persistent_ram_write(struct persistent_ram_zone *prz,
 	const void *s, unsigned int count)
 {
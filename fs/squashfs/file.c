@@ -34,6 +34,8 @@
 #include <linux/string.h>
 #include <linux/pagemap.h>
 #include <linux/mutex.h>
+#include <linux/wait_bit.h>
+#include <linux/workqueue.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -533,6 +535,128 @@ static int squashfs_readahead_fragment(struct page **page,
 	return error;
 }
 
+/*
+ * Decompress one datablock directly into the readahead pages covering it,
+ * then unlock and release those pages.
+ */
+static void squashfs_readahead_block(struct inode *inode, struct page **pages,
+	unsigned int nr_pages, u64 block, int bsize, unsigned int expected,
+	bool file_end)
+{
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	struct squashfs_page_actor *actor;
+	struct page *last_page = NULL;
+	int i, res = -ENOMEM;
+
+	actor = squashfs_page_actor_init_special(msblk, pages, nr_pages,
+						 expected);
+	if (actor) {
+		res = squashfs_read_data(inode->i_sb, block, bsize, NULL, actor);
+
+		last_page = squashfs_page_actor_free(actor);
+	}
+
+	if (res == expected) {
+		int bytes;
+
+		/* Last page (if present) may have trailing bytes not filled */
+		bytes = res % PAGE_SIZE;
+		if (file_end && bytes && last_page)
+			memzero_page(last_page, bytes, PAGE_SIZE - bytes);
+
+		for (i = 0; i < nr_pages; i++) {
+			flush_dcache_page(pages[i]);
+			SetPageUptodate(pages[i]);
+		}
+	}
+
+	for (i = 0; i < nr_pages; i++) {
+		unlock_page(pages[i]);
+		put_page(pages[i]);
+	}
+}
+
+#ifdef CONFIG_SQUASHFS_READAHEAD_PARALLEL
+/*
+ * Blocks of a readahead window are independent of each other, so with
+ * more than one decompressor available they are handed to unbound
+ * workers and decompressed concurrently.  The reading task keeps
+ * decompressing blocks itself once enough workers are busy, and waits
+ * for all of them before returning from ->readahead().
+ */
+struct squashfs_ra_work {
+	struct work_struct	work;
+	atomic_t		*pending;
+	struct inode		*inode;
+	u64			block;
+	int			bsize;
+	unsigned int		expected;
+	unsigned int		nr_pages;
+	bool			file_end;
+	struct page		*pages[];
+};
+
+static void squashfs_readahead_work(struct work_struct *work)
+{
+	struct squashfs_ra_work *raw = container_of(work,
+					struct squashfs_ra_work, work);
+	atomic_t *pending = raw->pending;
+
+	squashfs_readahead_block(raw->inode, raw->pages, raw->nr_pages,
+				 raw->block, raw->bsize, raw->expected,
+				 raw->file_end);
+	kfree(raw);
+
+	if (atomic_dec_and_test(pending))
+		wake_up_var(pending);
+}
+
+static bool squashfs_readahead_queue(struct inode *inode, atomic_t *pending,
+	struct page **pages, unsigned int nr_pages, u64 block, int bsize,
+	unsigned int expected, bool file_end)
+{
+	struct squashfs_ra_work *raw;
+
+	/* Leave one CPU for the reading task itself */
+	if (atomic_read(pending) >= num_online_cpus() - 1)
+		return false;
+
+	raw = kmalloc(struct_size(raw, pages, nr_pages), GFP_NOIO);
+	if (!raw)
+		return false;
+
+	INIT_WORK(&raw->work, squashfs_readahead_work);
+	raw->pending = pending;
+	raw->inode = inode;
+	raw->block = block;
+	raw->bsize = bsize;
+	raw->expected = expected;
+	raw->nr_pages = nr_pages;
+	raw->file_end = file_end;
+	memcpy(raw->pages, pages, nr_pages * sizeof(*pages));
+
+	atomic_inc(pending);
+	queue_work(system_unbound_wq, &raw->work);
+	return true;
+}
+
+static void squashfs_readahead_wait(atomic_t *pending)
+{
+	wait_var_event(pending, !atomic_read(pending));
+}
+#else
+static inline bool squashfs_readahead_queue(struct inode *inode,
+	atomic_t *pending, struct page **pages, unsigned int nr_pages,
+	u64 block, int bsize, unsigned int expected, bool file_end)
+{
+	return false;
+}
+
+static inline void squashfs_readahead_wait(atomic_t *pending)
+{
+}
+#endif
+
 static void squashfs_readahead(struct readahead_control *ractl)
 {
 	struct inode *inode = ractl->mapping->host;
@@ -541,11 +665,12 @@ static void squashfs_readahead(struct readahead_control *ractl)
 	unsigned short shift = msblk->block_log - PAGE_SHIFT;
 	loff_t start = readahead_pos(ractl) & ~mask;
 	size_t len = readahead_length(ractl) + readahead_pos(ractl) - start;
-	struct squashfs_page_actor *actor;
+	atomic_t pending = ATOMIC_INIT(0);
 	unsigned int nr_pages = 0;
 	struct page **pages;
 	int i, file_end = i_size_read(inode) >> msblk->block_log;
 	unsigned int max_pages = 1UL << shift;
+	pgoff_t next_index;
 
 	readahead_expand(ractl, start, (len | mask) + 1);
 
@@ -553,29 +678,42 @@ static void squashfs_readahead(struct readahead_control *ractl)
 	if (!pages)
 		return;
 
+	next_index = readahead_index(ractl);
+
 	for (;;) {
 		pgoff_t index;
 		int res, bsize;
 		u64 block = 0;
-		unsigned int expected;
-		struct page *last_page;
+		unsigned int expected, block_pages, offset;
 
-		expected = start >> msblk->block_log == file_end ?
+		index = next_index >> shift;
+		expected = index == file_end ?
 			   (i_size_read(inode) & (msblk->block_size - 1)) :
 			    msblk->block_size;
 
-		max_pages = (expected + PAGE_SIZE - 1) >> PAGE_SHIFT;
+		/*
+		 * readahead_expand() may not have been able to align the
+		 * start of the window to a block (e.g. because a page in
+		 * front of it is already cached).  Never let a batch extend
+		 * past the end of the current block, otherwise every batch
+		 * straddles two blocks and has to be handed back to
+		 * ->read_folio() a page at a time.
+		 */
+		block_pages = (expected + PAGE_SIZE - 1) >> PAGE_SHIFT;
+		offset = next_index & ((1UL << shift) - 1);
+		max_pages = block_pages > offset ? block_pages - offset : 1;
 
 		nr_pages = __readahead_batch(ractl, pages, max_pages);
 		if (!nr_pages)
 			break;
 
+		next_index = pages[nr_pages - 1]->index + 1;
+
 		if (readahead_pos(ractl) >= i_size_read(inode))
 			goto skip_pages;
 
-		index = pages[0]->index >> shift;
-
-		if ((pages[nr_pages - 1]->index >> shift) != index)
+		if ((pages[0]->index >> shift) != index ||
+		    (pages[nr_pages - 1]->index >> shift) != index)
 			goto skip_pages;
 
 		if (index == file_end && squashfs_i(inode)->fragment_block !=
@@ -588,39 +726,30 @@ static void squashfs_readahead(struct readahead_control *ractl)
 		}
 
 		bsize = read_blocklist(inode, index, &block);
-		if (bsize == 0)
+		if (bsize < 0)
 			goto skip_pages;
 
-		actor = squashfs_page_actor_init_special(msblk, pages, nr_pages,
-							 expected);
-		if (!actor)
-			goto skip_pages;
-
-		res = squashfs_read_data(inode->i_sb, block, bsize, NULL, actor);
-
-		last_page = squashfs_page_actor_free(actor);
-
-		if (res == expected) {
-			int bytes;
-
-			/* Last page (if present) may have trailing bytes not filled */
-			bytes = res % PAGE_SIZE;
-			if (index == file_end && bytes && last_page)
-				memzero_page(last_page, bytes,
-					     PAGE_SIZE - bytes);
-
+		if (bsize == 0) {
+			/* Sparse block, no need to go through ->read_folio() */
 			for (i = 0; i < nr_pages; i++) {
+				memzero_page(pages[i], 0, PAGE_SIZE);
 				flush_dcache_page(pages[i]);
 				SetPageUptodate(pages[i]);
+				unlock_page(pages[i]);
+				put_page(pages[i]);
 			}
+			continue;
 		}
 
-		for (i = 0; i < nr_pages; i++) {
-			unlock_page(pages[i]);
-			put_page(pages[i]);
-		}
+		if (!squashfs_readahead_queue(inode, &pending, pages, nr_pages,
+					      block, bsize, expected,
+					      index == file_end))
+			squashfs_readahead_block(inode, pages, nr_pages, block,
+						 bsize, expected,
+						 index == file_end);
 	}
 
+	squashfs_readahead_wait(&pending);
 	kfree(pages);
 	return;
 
@@ -629,6 +758,7 @@ static void squashfs_readahead(struct readahead_control *ractl)
 		unlock_page(pages[i]);
 		put_page(pages[i]);
 	}
+	squashfs_readahead_wait(&pending);
 	kfree(pages);
 }
 
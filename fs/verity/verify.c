@@ -57,7 +57,8 @@ static inline int cmp_hashes(const struct fsverity_info *vi,
 }
 
 /*
- * Verify a single data page against the file's Merkle tree.
+ * Get the level 0 hash page covering the given data page, verifying it first if
+ * needed.
  *
  * In principle, we need to verify the entire path to the root node.  However,
  * for efficiency the filesystem may cache the hash pages.  Therefore we need
@@ -71,15 +72,18 @@ static inline int cmp_hashes(const struct fsverity_info *vi,
  * Note that multiple processes may race to verify a hash page and mark it
  * Checked, but it doesn't matter; the result will be the same either way.
  *
- * Return: true if the page is valid, else false.
+ * Return: the verified, referenced level 0 hash page; NULL if the tree has no
+ * levels (the data page is then checked directly against the root hash); or an
+ * ERR_PTR() on failure.
  */
-static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
-			struct ahash_request *req, struct page *data_page,
-			unsigned long level0_ra_pages)
+static struct page *get_verified_leaf_page(struct inode *inode,
+					   const struct fsverity_info *vi,
+					   struct ahash_request *req,
+					   pgoff_t index,
+					   unsigned long level0_ra_pages)
 {
 	const struct merkle_tree_params *params = &vi->tree_params;
 	const unsigned int hsize = params->digest_size;
-	const pgoff_t index = data_page->index;
 	int level;
 	u8 _want_hash[FS_VERITY_MAX_DIGEST_SIZE];
 	const u8 *want_hash;
@@ -88,10 +92,8 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 	unsigned int hoffsets[FS_VERITY_MAX_LEVELS];
 	int err;
 
-	if (WARN_ON_ONCE(!PageLocked(data_page) || PageUptodate(data_page)))
-		return false;
-
-	pr_debug_ratelimited("Verifying data page %lu...\n", index);
+	if (params->num_levels == 0)
+		return NULL;
 
 	/*
 	 * Starting at the leaf level, ascend the tree saving hash pages along
@@ -119,6 +121,8 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		}
 
 		if (PageChecked(hpage)) {
+			if (level == 0)
+				return hpage;
 			memcpy_from_page(_want_hash, hpage, hoffset, hsize);
 			want_hash = _want_hash;
 			put_page(hpage);
@@ -136,7 +140,7 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 	pr_debug("Want root hash: %s:%*phN\n",
 		 params->hash_alg->name, hsize, want_hash);
 descend:
-	/* Descend the tree verifying hash pages */
+	/* Descend the tree verifying hash pages, stopping at the leaf */
 	for (; level > 0; level--) {
 		struct page *hpage = hpages[level - 1];
 		unsigned int hoffset = hoffsets[level - 1];
@@ -148,23 +152,78 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		if (err)
 			goto out;
 		SetPageChecked(hpage);
+		if (level == 1)
+			return hpage;
 		memcpy_from_page(_want_hash, hpage, hoffset, hsize);
 		want_hash = _want_hash;
 		put_page(hpage);
 		pr_debug("Verified hash page at level %d, now want %s:%*phN\n",
 			 level - 1, params->hash_alg->name, hsize, want_hash);
 	}
-
-	/* Finally, verify the data page */
-	err = fsverity_hash_page(params, inode, req, data_page, real_hash);
-	if (err)
-		goto out;
-	err = cmp_hashes(vi, want_hash, real_hash, index, -1);
+	/* Not reached: level 0 is either Checked or verified above */
+	err = -EINVAL;
 out:
 	for (; level > 0; level--)
 		put_page(hpages[level - 1]);
 
-	return err == 0;
+	return ERR_PTR(err);
+}
+
+/*
+ * Verify a single data page against its (already verified) level 0 hash page,
+ * or against the root hash if the tree has no levels.
+ */
+static bool verify_data_page(struct inode *inode,
+			     const struct fsverity_info *vi,
+			     struct ahash_request *req, struct page *data_page,
+			     struct page *leaf)
+{
+	const struct merkle_tree_params *params = &vi->tree_params;
+	const unsigned int hsize = params->digest_size;
+	const pgoff_t index = data_page->index;
+	u8 _want_hash[FS_VERITY_MAX_DIGEST_SIZE];
+	const u8 *want_hash = vi->root_hash;
+	u8 real_hash[FS_VERITY_MAX_DIGEST_SIZE];
+
+	if (leaf) {
+		pgoff_t hindex;
+		unsigned int hoffset;
+
+		hash_at_level(params, index, 0, &hindex, &hoffset);
+		memcpy_from_page(_want_hash, leaf, hoffset, hsize);
+		want_hash = _want_hash;
+	}
+
+	if (fsverity_hash_page(params, inode, req, data_page, real_hash))
+		return false;
+	return cmp_hashes(vi, want_hash, real_hash, index, -1) == 0;
+}
+
+/*
+ * Verify a single data page against the file's Merkle tree.
+ *
+ * Return: true if the page is valid, else false.
+ */
+static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
+			struct ahash_request *req, struct page *data_page,
+			unsigned long level0_ra_pages)
+{
+	struct page *leaf;
+	bool valid;
+
+	if (WARN_ON_ONCE(!PageLocked(data_page) || PageUptodate(data_page)))
+		return false;
+
+	pr_debug_ratelimited("Verifying data page %lu...\n", data_page->index);
+
+	leaf = get_verified_leaf_page(inode, vi, req, data_page->index,
+				      level0_ra_pages);
+	if (IS_ERR(leaf))
+		return false;
+	valid = verify_data_page(inode, vi, req, data_page, leaf);
+	if (leaf)
+		put_page(leaf);
+	return valid;
 }
 
 /**
@@ -219,6 +278,8 @@ void fsverity_verify_bio(struct bio *bio)
 	struct bio_vec *bv;
 	struct bvec_iter_all iter_all;
 	unsigned long max_ra_pages = 0;
+	struct page *leaf = NULL;
+	unsigned long leaf_index = 0;
 
 	/* This allocation never fails, since it's mempool-backed. */
 	req = fsverity_alloc_hash_request(params->hash_alg, GFP_NOFS);
@@ -238,17 +299,39 @@ void fsverity_verify_bio(struct bio *bio)
 		max_ra_pages /= 4;
 	}
 
+	/*
+	 * Consecutive data pages of a bio are nearly always covered by the same
+	 * level 0 hash page, so keep the last verified one around and only walk
+	 * the tree again once a page falls outside of it.
+	 */
 	bio_for_each_segment_all(bv, bio, iter_all) {
 		struct page *page = bv->bv_page;
 		unsigned long level0_index = page->index >> params->log_arity;
 		unsigned long level0_ra_pages =
 			min(max_ra_pages, params->level0_blocks - level0_index);
 
-		if (!PageError(page) &&
-		    !verify_page(inode, vi, req, page, level0_ra_pages))
+		if (PageError(page))
+			continue;
+		if (WARN_ON_ONCE(!PageLocked(page) || PageUptodate(page))) {
+			SetPageError(page);
+			continue;
+		}
+
+		if (!leaf || level0_index != leaf_index) {
+			if (leaf && !IS_ERR(leaf))
+				put_page(leaf);
+			leaf = get_verified_leaf_page(inode, vi, req,
+						      page->index,
+						      level0_ra_pages);
+			leaf_index = level0_index;
+		}
+		if (IS_ERR(leaf) ||
+		    !verify_data_page(inode, vi, req, page, leaf))
 			SetPageError(page);
 	}
 
+	if (leaf && !IS_ERR(leaf))
+		put_page(leaf);
 	fsverity_free_hash_request(params->hash_alg, req);
 }
 EXPORT_SYMBOL_GPL(fsverity_verify_bio);
@@ -357,7 +357,8 @@ struct ceph_gcm_nonce {
 struct ceph_connection_v2_info {
 	struct iov_iter in_iter;
 	struct kvec in_kvecs[5];  /* recvmsg */
-	struct bio_vec in_bvec;  /* recvmsg (in_cursor) */
+	struct bio_vec in_bvecs[16];  /* recvmsg (in_cursor, in_enc_pages) */
+	int in_bvec_cnt;
 	int in_kvec_cnt;
 	int in_state;  /* IN_S_* */
 
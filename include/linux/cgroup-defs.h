@@ -477,6 +477,12 @@ struct cgroup {
 	struct cgroup_rstat_cpu __percpu *rstat_cpu;
 	struct list_head rstat_css_list;
 
+	/*
+	 * Sequence number of the last completed flush of the subtree rooted
+	 * here.  Protected by root->rstat_lock.
+	 */
+	u64 rstat_flush_done;
+
 	/* cgroup basic resource statistics */
 	struct cgroup_base_stat last_bstat;
 	struct cgroup_base_stat bstat;
@@ -538,6 +544,12 @@ struct cgroup_root {
 	/* Number of cgroups in the hierarchy, used only for /proc/cgroups */
 	atomic_t nr_cgrps;
 
+	/* Serializes rstat flushes within this hierarchy */
+	spinlock_t rstat_lock;
+
+	/* Sequence number of the last rstat flush started in this hierarchy */
+	u64 rstat_flush_seq;
+
 	/* A list running through the active hierarchies */
 	struct list_head root_list;
 
@@ -95,6 +95,8 @@ struct cpuidle_device {
 	unsigned int		poll_time_limit:1;
 	unsigned int		cpu;
 	ktime_t			next_hrtimer;
+	ktime_t			next_irq_event;
+	u64			next_irq_ns;
 
 	int			last_state_idx;
 	u64			last_residency_ns;
@@ -273,6 +275,22 @@ struct cpuidle_governor {
 
 extern int cpuidle_register_governor(struct cpuidle_governor *gov);
 extern s64 cpuidle_governor_latency_req(unsigned int cpu);
+#ifdef CONFIG_CPU_IDLE_GOV_IRQ_TIMINGS
+/*
+ * Time in nanoseconds till the next device interrupt on the local CPU as
+ * predicted from the timings of the recent ones when this idle period began,
+ * or U64_MAX if there is no prediction.
+ */
+static inline u64 cpuidle_governor_irq_next_ns(struct cpuidle_device *dev)
+{
+	return dev->next_irq_ns;
+}
+#else
+static inline u64 cpuidle_governor_irq_next_ns(struct cpuidle_device *dev)
+{
+	return U64_MAX;
+}
+#endif
 
 #define __CPU_PM_CPU_IDLE_ENTER(low_level_idle_enter,			\
 				idx,					\
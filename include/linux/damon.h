@@ -88,6 +88,10 @@ struct damon_target {
  * @DAMOS_NOHUGEPAGE:	Call ``madvise()`` for the region with MADV_NOHUGEPAGE.
  * @DAMOS_LRU_PRIO:	Prioritize the region on its LRU lists.
  * @DAMOS_LRU_DEPRIO:	Deprioritize the region on its LRU lists.
+ * @DAMOS_MIGRATE_HOT:	Migrate the region to &damos->target_nid, hottest
+ *			regions first.
+ * @DAMOS_MIGRATE_COLD:	Migrate the region to &damos->target_nid, coldest
+ *			regions first.
  * @DAMOS_STAT:		Do nothing but count the stat.
  * @NR_DAMOS_ACTIONS:	Total number of DAMOS actions
  */
@@ -99,6 +103,8 @@ enum damos_action {
 	DAMOS_NOHUGEPAGE,
 	DAMOS_LRU_PRIO,
 	DAMOS_LRU_DEPRIO,
+	DAMOS_MIGRATE_HOT,
+	DAMOS_MIGRATE_COLD,
 	DAMOS_STAT,		/* Do nothing but only record the stat */
 	NR_DAMOS_ACTIONS,
 };
@@ -240,6 +246,7 @@ struct damos_access_pattern {
  * @quota:		Control the aggressiveness of this scheme.
  * @wmarks:		Watermarks for automated (in)activation of this scheme.
  * @stat:		Statistics of this scheme.
+ * @target_nid:		Destination node of the migration actions.
  * @list:		List head for siblings.
  *
  * For each aggregation interval, DAMON finds regions which fit in the
@@ -257,6 +264,12 @@ struct damos_access_pattern {
  * After applying the &action to each region, &stat_count and &stat_sz is
  * updated to reflect the number of regions and total size of regions that the
  * &action is applied.
+ *
+ * The migration actions move the memory of the regions to &target_nid, e.g.
+ * to promote hot memory to a fast node and demote cold memory to a slow (CXL)
+ * node of a tiered memory system.  &quota limits the rate of the migrations.
+ * &target_nid is ``NUMA_NO_NODE`` unless set after damon_new_scheme(), and
+ * the migration actions do nothing then.
  */
 struct damos {
 	struct damos_access_pattern pattern;
@@ -264,6 +277,7 @@ struct damos {
 	struct damos_quota quota;
 	struct damos_watermarks wmarks;
 	struct damos_stat stat;
+	int target_nid;
 	struct list_head list;
 };
 
@@ -398,6 +412,8 @@ struct damon_callback {
  *				regions.
  * @max_nr_regions:		The maximum number of adaptive monitoring
  *				regions.
+ * @nr_workers:			The number of threads checking the accesses
+ *				of the regions in parallel.
  *
  * For each @sample_interval, DAMON checks whether each region is accessed or
  * not.  It aggregates and keeps the access information (number of accesses to
@@ -407,6 +423,11 @@ struct damon_callback {
  * @ops_update_interval.  All time intervals are in micro-seconds.
  * Please refer to &struct damon_operations and &struct damon_callback for more
  * detail.
+ *
+ * Monitoring operations that support it split the access checks of the regions
+ * between @nr_workers threads, including the kdamond itself, so that a large
+ * number of regions can be checked within @sample_interval.  Zero means the
+ * same as one, i.e., the kdamond checks all regions on its own.
  */
 struct damon_attrs {
 	unsigned long sample_interval;
@@ -414,6 +435,7 @@ struct damon_attrs {
 	unsigned long ops_update_interval;
 	unsigned long min_nr_regions;
 	unsigned long max_nr_regions;
+	unsigned long nr_workers;
 };
 
 /**
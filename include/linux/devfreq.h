@@ -21,6 +21,7 @@
 #define DEVFREQ_GOV_POWERSAVE		"powersave"
 #define DEVFREQ_GOV_USERSPACE		"userspace"
 #define DEVFREQ_GOV_PASSIVE		"passive"
+#define DEVFREQ_GOV_MEMLAT		"mem_latency"
 
 /* DEVFREQ notifier interface */
 #define DEVFREQ_TRANSITION_NOTIFIER	(0)
@@ -338,6 +339,38 @@ struct devfreq_passive_data {
 };
 #endif
 
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_MEMLAT)
+struct devfreq_memlat_cpu;
+
+/**
+ * struct devfreq_memlat_data - ``void *data`` fed to struct devfreq
+ *	and devfreq_add_device
+ * @cpus:	the CPUs whose memory stalls drive the device, all CPUs if NULL.
+ * @stall_pct:	A CPU is memory-bound if this share (%) of its cycles stall.
+ *		Specify 0 to use the default. Valid value = 0 to 100.
+ * @stall_event:	Raw PMU event counting stalled cycles, e.g. the
+ *			STALL_BACKEND_MEM event of Arm cores. Specify 0 to use
+ *			the generic backend stall event.
+ * @this:	the devfreq instance of own device.
+ * @node:	the CPU hotplug instance of own device.
+ * @cpu_data:	the state of the CPUs being sampled.
+ *
+ * The devfreq_memlat_data have to set the cpus, stall_pct and stall_event.
+ * The rest of the fields are for the memlat governor's internal use and
+ * don't need to be set.
+ */
+struct devfreq_memlat_data {
+	const struct cpumask *cpus;
+	unsigned int stall_pct;
+	u64 stall_event;
+
+	/* For memlat governor's internal use. Don't need to set them */
+	struct devfreq *this;
+	struct hlist_node node;
+	struct devfreq_memlat_cpu *cpu_data;
+};
+#endif
+
 #else /* !CONFIG_PM_DEVFREQ */
 static inline struct devfreq *devfreq_add_device(struct device *dev,
 					struct devfreq_dev_profile *profile,
@@ -311,6 +311,21 @@ void dma_free_pages(struct device *dev, size_t size, struct page *page,
 int dma_mmap_pages(struct device *dev, struct vm_area_struct *vma,
 		size_t size, struct page *page);
 
+#ifdef CONFIG_DMA_CMA
+unsigned int dma_contiguous_prefill(struct device *dev, size_t size,
+		unsigned int count, gfp_t gfp);
+void dma_contiguous_drain(struct device *dev, size_t size);
+#else
+static inline unsigned int dma_contiguous_prefill(struct device *dev,
+		size_t size, unsigned int count, gfp_t gfp)
+{
+	return 0;
+}
+static inline void dma_contiguous_drain(struct device *dev, size_t size)
+{
+}
+#endif /* CONFIG_DMA_CMA */
+
 static inline void *dma_alloc_noncoherent(struct device *dev, size_t size,
 		dma_addr_t *dma_handle, enum dma_data_direction dir, gfp_t gfp)
 {
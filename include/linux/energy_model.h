@@ -36,9 +36,22 @@ struct em_perf_state {
  */
 #define EM_PERF_STATE_INEFFICIENT BIT(0)
 
+/**
+ * struct em_perf_table - Runtime modifiable table of performance states
+ * @rcu:	RCU head used to free the table once it has been replaced
+ * @state:	List of performance states, in ascending order
+ */
+struct em_perf_table {
+	struct rcu_head rcu;
+	struct em_perf_state state[];
+};
+
 /**
  * struct em_perf_domain - Performance domain
- * @table:		List of performance states, in ascending order
+ * @table:		List of performance states, in ascending order, as
+ *			registered
+ * @em_table:		Copy of @table used for energy estimation, which can
+ *			be replaced at runtime with em_dev_update_perf_domain()
  * @nr_perf_states:	Number of performance states
  * @flags:		See "em_perf_domain flags"
  * @cpus:		Cpumask covering the CPUs of the domain. It's here
@@ -54,6 +67,7 @@ struct em_perf_state {
  */
 struct em_perf_domain {
 	struct em_perf_state *table;
+	struct em_perf_table __rcu *em_table;
 	int nr_perf_states;
 	unsigned long flags;
 	unsigned long cpus[];
@@ -172,11 +186,17 @@ int em_dev_register_perf_domain(struct device *dev, unsigned int nr_states,
 				struct em_data_callback *cb, cpumask_t *span,
 				bool microwatts);
 void em_dev_unregister_perf_domain(struct device *dev);
+struct em_perf_table *em_table_alloc(struct em_perf_domain *pd);
+void em_table_free(struct em_perf_table *table);
+int em_dev_update_perf_domain(struct device *dev,
+			      struct em_perf_table *new_table);
 
 /**
  * em_pd_get_efficient_state() - Get an efficient performance state from the EM
- * @pd   : Performance domain for which we want an efficient frequency
- * @freq : Frequency to map with the EM
+ * @table		: List of performance states, in ascending order
+ * @nr_perf_states	: Number of performance states
+ * @freq		: Frequency to map with the EM
+ * @pd_flags		: Performance domain flags
  *
  * It is called from the scheduler code quite frequently and as a consequence
  * doesn't implement any check.
@@ -185,16 +205,18 @@ void em_dev_unregister_perf_domain(struct device *dev);
  * requirement.
  */
 static inline
-struct em_perf_state *em_pd_get_efficient_state(struct em_perf_domain *pd,
-						unsigned long freq)
+struct em_perf_state *em_pd_get_efficient_state(struct em_perf_state *table,
+						int nr_perf_states,
+						unsigned long freq,
+						unsigned long pd_flags)
 {
 	struct em_perf_state *ps;
 	int i;
 
-	for (i = 0; i < pd->nr_perf_states; i++) {
-		ps = &pd->table[i];
+	for (i = 0; i < nr_perf_states; i++) {
+		ps = &table[i];
 		if (ps->frequency >= freq) {
-			if (pd->flags & EM_PERF_DOMAIN_SKIP_INEFFICIENCIES &&
+			if (pd_flags & EM_PERF_DOMAIN_SKIP_INEFFICIENCIES &&
 			    ps->flags & EM_PERF_STATE_INEFFICIENT)
 				continue;
 			break;
@@ -216,6 +238,7 @@ struct em_perf_state *em_pd_get_efficient_state(struct em_perf_domain *pd,
  * This function must be used only for CPU devices. There is no validation,
  * i.e. if the EM is a CPU type and has cpumask allocated. It is called from
  * the scheduler code quite frequently and that is why there is not checks.
+ * The caller must hold the RCU read lock, which protects the runtime table.
  *
  * Return: the sum of the energy consumed by the CPUs of the domain assuming
  * a capacity state satisfying the max utilization of the domain.
@@ -224,6 +247,7 @@ static inline unsigned long em_cpu_energy(struct em_perf_domain *pd,
 				unsigned long max_util, unsigned long sum_util,
 				unsigned long allowed_cpu_cap)
 {
+	struct em_perf_table *em_table;
 	unsigned long freq, scale_cpu;
 	struct em_perf_state *ps;
 	int cpu;
@@ -241,7 +265,8 @@ static inline unsigned long em_cpu_energy(struct em_perf_domain *pd,
 	 */
 	cpu = cpumask_first(to_cpumask(pd->cpus));
 	scale_cpu = arch_scale_cpu_capacity(cpu);
-	ps = &pd->table[pd->nr_perf_states - 1];
+	em_table = rcu_dereference(pd->em_table);
+	ps = &em_table->state[pd->nr_perf_states - 1];
 
 	max_util = map_util_perf(max_util);
 	max_util = min(max_util, allowed_cpu_cap);
@@ -251,7 +276,8 @@ static inline unsigned long em_cpu_energy(struct em_perf_domain *pd,
 	 * Find the lowest performance state of the Energy Model above the
 	 * requested frequency.
 	 */
-	ps = em_pd_get_efficient_state(pd, freq);
+	ps = em_pd_get_efficient_state(em_table->state, pd->nr_perf_states,
+				       freq, pd->flags);
 
 	/*
 	 * The capacity of a CPU in the domain at the performance state (ps)
@@ -334,6 +360,18 @@ static inline struct em_perf_domain *em_pd_get(struct device *dev)
 {
 	return NULL;
 }
+static inline struct em_perf_table *em_table_alloc(struct em_perf_domain *pd)
+{
+	return NULL;
+}
+static inline void em_table_free(struct em_perf_table *table)
+{
+}
+static inline int em_dev_update_perf_domain(struct device *dev,
+					    struct em_perf_table *new_table)
+{
+	return -EINVAL;
+}
 static inline unsigned long em_cpu_energy(struct em_perf_domain *pd,
 			unsigned long max_util, unsigned long sum_util,
 			unsigned long allowed_cpu_cap)
@@ -15,6 +15,8 @@
 #define _LINUX_FSCACHE_CACHE_H
 
 #include <linux/fscache.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
 
 enum fscache_cache_trace;
 enum fscache_cookie_trace;
@@ -194,12 +196,54 @@ extern atomic_t fscache_n_culled;
 #define fscache_count_no_write_space() atomic_inc(&fscache_n_no_write_space)
 #define fscache_count_no_create_space() atomic_inc(&fscache_n_no_create_space)
 #define fscache_count_culled() atomic_inc(&fscache_n_culled)
+
+/**
+ * fscache_count_lookup - Note whether a read found its data in the cache
+ * @cookie: The cookie being read from
+ * @hit: True if the read can be served from the cache
+ *
+ * Account a cache hit or miss to a cookie and its volume.
+ */
+static inline void fscache_count_lookup(struct fscache_cookie *cookie, bool hit)
+{
+	if (hit) {
+		atomic_inc(&cookie->io_stats.hits);
+		atomic_inc(&cookie->volume->io_stats.hits);
+	} else {
+		atomic_inc(&cookie->io_stats.misses);
+		atomic_inc(&cookie->volume->io_stats.misses);
+	}
+}
+
+/**
+ * fscache_count_read_latency - Note the latency of a read from the cache
+ * @cookie: The cookie that was read from
+ * @start: When the read was issued
+ *
+ * Account a completed cache read to the latency histograms of a cookie and
+ * its volume.
+ */
+static inline void fscache_count_read_latency(struct fscache_cookie *cookie,
+					      ktime_t start)
+{
+	s64 us = ktime_us_delta(ktime_get(), start);
+	unsigned int bucket = 0;
+
+	if (us > 0)
+		bucket = min_t(unsigned int, ilog2(us) + 1,
+			       FSCACHE_IO_LAT_BUCKETS - 1);
+	atomic_inc(&cookie->io_stats.read_lat[bucket]);
+	atomic_inc(&cookie->volume->io_stats.read_lat[bucket]);
+}
 #else
 #define fscache_count_read() do {} while(0)
 #define fscache_count_write() do {} while(0)
 #define fscache_count_no_write_space() do {} while(0)
 #define fscache_count_no_create_space() do {} while(0)
 #define fscache_count_culled() do {} while(0)
+static inline void fscache_count_lookup(struct fscache_cookie *cookie, bool hit) {}
+static inline void fscache_count_read_latency(struct fscache_cookie *cookie,
+					      ktime_t start) {}
 #endif
 
 #endif /* _LINUX_FSCACHE_CACHE_H */
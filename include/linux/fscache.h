@@ -66,6 +66,20 @@ enum fscache_cookie_state {
 #define FSCACHE_COOKIE_STATE__NR (FSCACHE_COOKIE_STATE_DROPPED + 1)
 } __attribute__((mode(byte)));
 
+/*
+ * Cache I/O statistics of a volume or a data cookie.  Read latencies are kept
+ * as a histogram of power-of-two buckets in microseconds: bucket 0 counts reads
+ * that took less than 1us, bucket n those that took [2^(n-1), 2^n)us and the
+ * last bucket anything slower.
+ */
+#define FSCACHE_IO_LAT_BUCKETS	16
+
+struct fscache_io_stats {
+	atomic_t			hits;		/* Reads served from the cache */
+	atomic_t			misses;		/* Reads that went to the server */
+	atomic_t			read_lat[FSCACHE_IO_LAT_BUCKETS];
+};
+
 /*
  * Volume representation cookie.
  */
@@ -88,6 +102,9 @@ struct fscache_volume {
 #define FSCACHE_VOLUME_COLLIDED_WITH	2	/* Volume was collided with */
 #define FSCACHE_VOLUME_ACQUIRE_PENDING	3	/* Volume is waiting to complete acquisition */
 #define FSCACHE_VOLUME_CREATING		4	/* Volume is being created on disk */
+#ifdef CONFIG_FSCACHE_STATS
+	struct fscache_io_stats		io_stats;	/* I/O on the volume's cookies */
+#endif
 	u8				coherency_len;	/* Length of the coherency data */
 	u8				coherency[];	/* Coherency data */
 };
@@ -133,6 +150,9 @@ struct fscache_cookie {
 #define FSCACHE_COOKIE_DO_INVALIDATE	15		/* T if cookie needs invalidation */
 
 	enum fscache_cookie_state	state;
+#ifdef CONFIG_FSCACHE_STATS
+	struct fscache_io_stats		io_stats;	/* I/O on this cookie */
+#endif
 	u8				advice;		/* FSCACHE_ADV_* */
 	u8				key_len;	/* Length of index key */
 	u8				aux_len;	/* Length of auxiliary data */
@@ -67,6 +67,11 @@
  *                later.
  * IRQF_NO_DEBUG - Exclude from runnaway detection for IPI and similar handlers,
  *		   depends on IRQF_PERCPU.
+ * IRQF_THREAD_POLL - Call the threaded handler again as long as it returns
+ *                IRQ_HANDLED, up to a budget per thread wakeup, before the
+ *                thread goes back to sleep. Together with IRQF_ONESHOT the
+ *                line stays masked meanwhile. The threaded handler must
+ *                return IRQ_NONE once it finds no more work.
  */
 #define IRQF_SHARED		0x00000080
 #define IRQF_PROBE_SHARED	0x00000100
@@ -82,6 +87,7 @@
 #define IRQF_COND_SUSPEND	0x00040000
 #define IRQF_NO_AUTOEN		0x00080000
 #define IRQF_NO_DEBUG		0x00100000
+#define IRQF_THREAD_POLL	0x00200000
 
 #define IRQF_TIMER		(__IRQF_TIMER | IRQF_NO_SUSPEND | IRQF_NO_THREAD)
 
@@ -281,6 +287,10 @@ struct irq_affinity_notify {
  *			of interrupt sets
  * @priv:		Private data for usage by @calc_sets, usually a
  *			pointer to driver/device specific data.
+ * @prefer_perf:	On systems with asymmetric CPU capacity, give the
+ *			highest capacity CPUs vectors of their own first when
+ *			there are fewer vectors than CPUs, instead of sharing
+ *			vectors proportionally to capacity
  */
 struct irq_affinity {
 	unsigned int	pre_vectors;
@@ -289,6 +299,7 @@ struct irq_affinity {
 	unsigned int	set_size[IRQ_AFFINITY_MAX_SETS];
 	void		(*calc_sets)(struct irq_affinity *, unsigned int nvecs);
 	void		*priv;
+	bool		prefer_perf;
 };
 
 /**
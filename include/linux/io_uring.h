@@ -16,8 +16,14 @@ enum io_uring_cmd_flags {
 	IO_URING_F_SQE128		= 4,
 	IO_URING_F_CQE32		= 8,
 	IO_URING_F_IOPOLL		= 16,
+
+	/* set when io_uring cancels a command marked cancelable */
+	IO_URING_F_CANCEL		= 32,
 };
 
+/* internal, io_uring_cmd_mark_cancelable() was called on the command */
+#define IORING_URING_CMD_CANCELABLE	(1U << 30)
+
 struct io_uring_cmd {
 	struct file	*file;
 	const void	*cmd;
@@ -38,6 +44,8 @@ int io_uring_cmd_import_fixed(u64 ubuf, unsigned long len, int rw,
 void io_uring_cmd_done(struct io_uring_cmd *cmd, ssize_t ret, ssize_t res2);
 void io_uring_cmd_complete_in_task(struct io_uring_cmd *ioucmd,
 			void (*task_work_cb)(struct io_uring_cmd *));
+void io_uring_cmd_mark_cancelable(struct io_uring_cmd *cmd,
+				  unsigned int issue_flags);
 struct sock *io_uring_get_socket(struct file *file);
 void __io_uring_cancel(bool cancel_all);
 void __io_uring_free(struct task_struct *tsk);
@@ -75,6 +83,10 @@ static inline void io_uring_cmd_complete_in_task(struct io_uring_cmd *ioucmd,
 			void (*task_work_cb)(struct io_uring_cmd *))
 {
 }
+static inline void io_uring_cmd_mark_cancelable(struct io_uring_cmd *cmd,
+						unsigned int issue_flags)
+{
+}
 static inline struct sock *io_uring_get_socket(struct file *file)
 {
 	return NULL;
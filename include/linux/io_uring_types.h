@@ -174,7 +174,14 @@ struct io_submit_state {
 	bool			plug_started;
 	bool			need_plug;
 	unsigned short		submit_nr;
+	/* aux CQEs posted from task_work, flushed with compl_reqs */
+	unsigned int		cqes_count;
+	/* IORING_MSG_DATA requests queued for the ring in ->msg_file */
+	unsigned int		msg_nr;
+	struct file		*msg_file;
 	struct blk_plug		plug;
+	struct io_uring_cqe	cqes[16];
+	struct io_kiocb		*msg_reqs[8];
 };
 
 struct io_ev_fd {
@@ -247,6 +254,8 @@ struct io_ring_ctx {
 		struct list_head	io_buffers_cache;
 
 		struct io_hash_table	cancel_table_locked;
+		/* uring_cmd requests marked cancelable */
+		struct hlist_head	cancelable_uring_cmd;
 		struct list_head	cq_overflow_list;
 		struct io_alloc_cache	apoll_cache;
 		struct io_alloc_cache	netmsg_cache;
@@ -256,6 +265,11 @@ struct io_ring_ctx {
 	struct io_wq_work_list	locked_free_list;
 	unsigned int		locked_free_nr;
 
+	/* recycled overflow entries and spill count, under ->completion_lock */
+	struct list_head	cq_overflow_cache;
+	unsigned int		cq_overflow_cached;
+	unsigned long		cq_overflow_spills;
+
 	const struct cred	*sq_creds;	/* cred used for __io_sq_thread() */
 	struct io_sq_data	*sq_data;	/* if using sq thread polling */
 
@@ -353,8 +367,13 @@ struct io_ring_ctx {
 
 	struct list_head		defer_list;
 	unsigned			sq_thread_idle;
+	/* SQPOLL submit quantum multiplier, from the creator's nice level */
+	unsigned			sq_weight;
 	/* protected by ->completion_lock */
 	unsigned			evfd_last_cq_tail;
+#ifdef CONFIG_IO_URING_LATENCY_HIST
+	struct io_lat_hist		*lat_hist;
+#endif
 };
 
 enum {
@@ -570,6 +589,10 @@ struct io_kiocb {
 	/* custom credentials, valid IFF REQ_F_CREDS is set */
 	const struct cred		*creds;
 	struct io_wq_work		work;
+#ifdef CONFIG_IO_URING_LATENCY_HIST
+	u64				submit_ns;
+	u64				issue_ns;
+#endif
 };
 
 struct io_overflow_cqe {
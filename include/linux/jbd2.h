@@ -25,6 +25,7 @@
 #include <linux/stddef.h>
 #include <linux/mutex.h>
 #include <linux/timer.h>
+#include <linux/workqueue.h>
 #include <linux/slab.h>
 #include <linux/bit_spinlock.h>
 #include <linux/blkdev.h>
@@ -47,6 +48,12 @@
  */
 #define JBD2_DEFAULT_MAX_COMMIT_AGE 5
 
+/*
+ * The default log occupancy, in percent, above which old transactions are
+ * checkpointed in the background.
+ */
+#define JBD2_DEFAULT_CHECKPOINT_WATERMARK 50
+
 #ifdef CONFIG_JBD2_DEBUG
 /*
  * Define JBD2_EXPENSIVE_CHECKING to enable more expensive internal
@@ -905,6 +912,22 @@ struct journal_s
 	 */
 	struct buffer_head	*j_chkpt_bhs[JBD2_NR_BATCH];
 
+	/**
+	 * @j_checkpoint_watermark:
+	 *
+	 * Log occupancy, in percent, above which old transactions are
+	 * checkpointed in the background.  0 disables background
+	 * checkpointing.
+	 */
+	unsigned int		j_checkpoint_watermark;
+
+	/**
+	 * @j_checkpoint_work:
+	 *
+	 * Work item doing the background checkpointing.
+	 */
+	struct delayed_work	j_checkpoint_work;
+
 	/**
 	 * @j_shrinker:
 	 *
@@ -1479,6 +1502,7 @@ extern int jbd2_journal_write_metadata_buffer(transaction_t *transaction,
 					      struct journal_head *jh_in,
 					      struct buffer_head **bh_out,
 					      sector_t blocknr);
+extern struct workqueue_struct *jbd2_log_wq;
 
 /* Transaction cache support */
 extern void jbd2_journal_destroy_transaction_cache(void);
@@ -1651,6 +1675,8 @@ int jbd2_log_wait_commit(journal_t *journal, tid_t tid);
 int jbd2_transaction_committed(journal_t *journal, tid_t tid);
 int jbd2_complete_transaction(journal_t *journal, tid_t tid);
 int jbd2_log_do_checkpoint(journal_t *journal);
+void jbd2_log_kick_checkpoint(journal_t *journal);
+void jbd2_checkpoint_work(struct work_struct *work);
 int jbd2_trans_will_send_data_barrier(journal_t *journal, tid_t tid);
 
 void __jbd2_log_wait_for_space(journal_t *journal);
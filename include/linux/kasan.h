@@ -103,6 +103,10 @@ struct kasan_cache {
 	int free_meta_offset;
 #endif
 	bool is_kmalloc;
+#ifdef CONFIG_KASAN_HW_TAGS
+	u8 sample;
+	atomic64_t nr_sampled;
+#endif
 };
 
 void __kasan_unpoison_range(const void *addr, size_t size);
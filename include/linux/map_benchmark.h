@@ -7,14 +7,27 @@
 #define _KERNEL_DMA_BENCHMARK_H
 
 #define DMA_MAP_BENCHMARK       _IOWR('d', 1, struct map_benchmark)
+/*
+ * The layout up to @sg_nents, as used before @flags was added. Binaries
+ * built against it keep working; the fields after it read as zero.
+ */
+#define DMA_MAP_BENCHMARK_V1    _IOC(_IOC_READ | _IOC_WRITE, 'd', 1, \
+				     offsetof(struct map_benchmark, flags))
 #define DMA_MAP_MAX_THREADS     1024
 #define DMA_MAP_MAX_SECONDS     300
 #define DMA_MAP_MAX_TRANS_DELAY (10 * NSEC_PER_MSEC)
+#define DMA_MAP_MAX_GRANULE     1024
 
 #define DMA_MAP_BIDIRECTIONAL   0
 #define DMA_MAP_TO_DEVICE       1
 #define DMA_MAP_FROM_DEVICE     2
 
+/* time the cache maintenance and bounce buffering apart from map/unmap */
+#define DMA_MAP_F_SPLIT_SYNC    (1U << 0)
+/* spread the threads over all online nodes, ignoring @node */
+#define DMA_MAP_F_NODE_SPREAD   (1U << 1)
+#define DMA_MAP_F_MASK          (DMA_MAP_F_SPLIT_SYNC | DMA_MAP_F_NODE_SPREAD)
+
 struct map_benchmark {
 	__u64 avg_map_100ns; /* average map latency in 100ns */
 	__u64 map_stddev; /* standard deviation of map latency */
@@ -27,5 +40,11 @@ struct map_benchmark {
 	__u32 dma_dir; /* DMA data direction */
 	__u32 dma_trans_ns; /* time for DMA transmission in ns */
 	__u32 granule;  /* how many PAGE_SIZE will do map/unmap once a time */
+	__u32 sg_nents; /* if non-zero, map that many granules with dma_map_sg */
+	__u32 flags; /* DMA_MAP_F_* */
+	__u32 reserved; /* keep the layout equal on 32-bit userspace */
+	__u64 avg_sync_100ns; /* average sync latency, DMA_MAP_F_SPLIT_SYNC only */
+	__u64 sync_stddev;
+	__u8 expansion[64]; /* for future use, keeps the ioctl number stable */
 };
 #endif /* _KERNEL_DMA_BENCHMARK_H */
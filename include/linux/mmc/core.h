@@ -161,6 +161,9 @@ struct mmc_request {
 	/* Allow other commands during this ongoing data transfer or busy wait */
 	bool			cap_cmd_during_tfr;
 
+	/* More CQE requests follow, CQE may wait for ->cqe_commit_rqs() */
+	bool			cqe_defer_start;
+
 	int			tag;
 
 #ifdef CONFIG_MMC_CRYPTO
@@ -349,6 +349,8 @@ struct mod_kallsyms {
 	unsigned int num_symtab;
 	char *strtab;
 	char *typetab;
+	/* symtab indices sorted by name, NULL while the module initializes */
+	unsigned int *sorted;
 };
 
 #ifdef CONFIG_LIVEPATCH
@@ -15,6 +15,7 @@
 #define _LINUX_NETFS_H
 
 #include <linux/workqueue.h>
+#include <linux/ktime.h>
 #include <linux/fs.h>
 #include <linux/pagemap.h>
 
@@ -118,6 +119,16 @@ enum netfs_io_source {
 typedef void (*netfs_io_terminated_t)(void *priv, ssize_t transferred_or_error,
 				      bool was_async);
 
+/*
+ * Observed performance of reads from the server, used to size the download
+ * subrequests of a read.  Updated locklessly on subrequest completion.
+ */
+struct netfs_read_stats {
+	u64			lat_ns;		/* Estimated per-request latency */
+	unsigned long		bw;		/* Average transfer rate (bytes/ms) */
+	unsigned int		nr_samples;	/* Samples taken (saturating) */
+};
+
 /*
  * Per-inode context.  This wraps the VFS inode.
  */
@@ -128,6 +139,7 @@ struct netfs_inode {
 	struct fscache_cookie	*cache;
 #endif
 	loff_t			remote_i_size;	/* Size of the remote file */
+	struct netfs_read_stats	read_stats;	/* Server read performance */
 };
 
 /*
@@ -150,6 +162,7 @@ struct netfs_io_subrequest {
 	loff_t			start;		/* Where to start the I/O */
 	size_t			len;		/* Size of the I/O */
 	size_t			transferred;	/* Amount of data transferred */
+	ktime_t			issue_time;	/* When the download was issued */
 	refcount_t		ref;
 	short			error;		/* 0 or error that occurred */
 	unsigned short		debug_index;	/* Index in list (for debugging output) */
@@ -314,6 +327,7 @@ static inline void netfs_inode_init(struct netfs_inode *ctx,
 {
 	ctx->ops = ops;
 	ctx->remote_i_size = i_size_read(&ctx->inode);
+	memset(&ctx->read_stats, 0, sizeof(ctx->read_stats));
 #if IS_ENABLED(CONFIG_FSCACHE)
 	ctx->cache = NULL;
 #endif
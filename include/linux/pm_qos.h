@@ -15,6 +15,7 @@
 #include <linux/plist.h>
 #include <linux/notifier.h>
 #include <linux/device.h>
+#include <linux/cpumask.h>
 
 enum pm_qos_flags_status {
 	PM_QOS_FLAGS_UNDEFINED = -1,
@@ -63,6 +64,11 @@ struct pm_qos_request {
 	struct pm_qos_constraints *qos;
 };
 
+struct cpus_latency_qos_request {
+	struct pm_qos_request __percpu *reqs;
+	cpumask_var_t cpus;
+};
+
 struct pm_qos_flags_request {
 	struct list_head node;
 	s32 flags;	/* Do not change to 64 bit */
@@ -149,6 +155,15 @@ bool cpu_latency_qos_request_active(struct pm_qos_request *req);
 void cpu_latency_qos_add_request(struct pm_qos_request *req, s32 value);
 void cpu_latency_qos_update_request(struct pm_qos_request *req, s32 new_value);
 void cpu_latency_qos_remove_request(struct pm_qos_request *req);
+s32 cpu_latency_qos_cpu_limit(int cpu);
+bool cpus_latency_qos_request_active(struct cpus_latency_qos_request *req);
+int cpus_latency_qos_add_request(struct cpus_latency_qos_request *req,
+				 const struct cpumask *cpus, s32 value);
+int cpu_cluster_latency_qos_add_request(struct cpus_latency_qos_request *req,
+					int cpu, s32 value);
+void cpus_latency_qos_update_request(struct cpus_latency_qos_request *req,
+				     s32 new_value);
+void cpus_latency_qos_remove_request(struct cpus_latency_qos_request *req);
 #else
 static inline s32 cpu_latency_qos_limit(void) { return INT_MAX; }
 static inline bool cpu_latency_qos_request_active(struct pm_qos_request *req)
@@ -160,6 +175,29 @@ static inline void cpu_latency_qos_add_request(struct pm_qos_request *req,
 static inline void cpu_latency_qos_update_request(struct pm_qos_request *req,
 						  s32 new_value) {}
 static inline void cpu_latency_qos_remove_request(struct pm_qos_request *req) {}
+static inline s32 cpu_latency_qos_cpu_limit(int cpu) { return INT_MAX; }
+static inline bool
+cpus_latency_qos_request_active(struct cpus_latency_qos_request *req)
+{
+	return false;
+}
+static inline int
+cpus_latency_qos_add_request(struct cpus_latency_qos_request *req,
+			     const struct cpumask *cpus, s32 value)
+{
+	return 0;
+}
+static inline int
+cpu_cluster_latency_qos_add_request(struct cpus_latency_qos_request *req,
+				    int cpu, s32 value)
+{
+	return 0;
+}
+static inline void
+cpus_latency_qos_update_request(struct cpus_latency_qos_request *req,
+				s32 new_value) {}
+static inline void
+cpus_latency_qos_remove_request(struct cpus_latency_qos_request *req) {}
 #endif
 
 #ifdef CONFIG_PM
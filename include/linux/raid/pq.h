@@ -68,6 +68,8 @@ extern const char raid6_empty_zero_page[PAGE_SIZE];
 #define EXPORT_SYMBOL_GPL(sym)
 #define MODULE_LICENSE(licence)
 #define MODULE_DESCRIPTION(desc)
+#define MODULE_PARM_DESC(parm, desc)
+#define module_param_named(name, value, type, perm)
 #define subsys_initcall(x)
 #define module_exit(x)
 
@@ -170,6 +172,7 @@ void raid6_dual_recov(int disks, size_t bytes, int faila, int failb,
 # define jiffies	raid6_jiffies()
 # define printk 	printf
 # define pr_err(format, ...) fprintf(stderr, format, ## __VA_ARGS__)
+# define pr_warn(format, ...) fprintf(stderr, format, ## __VA_ARGS__)
 # define pr_info(format, ...) fprintf(stdout, format, ## __VA_ARGS__)
 # define GFP_KERNEL	0
 # define __get_free_pages(x, y)	((unsigned long)mmap(NULL, PAGE_SIZE << (y), \
@@ -460,11 +460,14 @@ enum rproc_crash_type {
  *				recovery
  * @RPROC_COREDUMP_INLINE:	Read segments directly from device memory. Stall
  *				recovery until all segments are read
+ * @RPROC_COREDUMP_COMPRESSED:	Compress dump into a separate buffer and carry
+ *				on with recovery
  */
 enum rproc_dump_mechanism {
 	RPROC_COREDUMP_DISABLED,
 	RPROC_COREDUMP_ENABLED,
 	RPROC_COREDUMP_INLINE,
+	RPROC_COREDUMP_COMPRESSED,
 };
 
 /**
@@ -165,6 +165,7 @@ struct kmem_cache *kmem_cache_create_usercopy(const char *name,
 			void (*ctor)(void *));
 void kmem_cache_destroy(struct kmem_cache *s);
 int kmem_cache_shrink(struct kmem_cache *s);
+bool kmem_cache_name_match(const char *list, const char *name);
 
 /*
  * Please use this macro to create slab caches. Simply specify the
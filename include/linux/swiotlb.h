@@ -87,6 +87,8 @@ dma_addr_t swiotlb_map(struct device *dev, phys_addr_t phys,
  * @for_alloc:  %true if the pool is used for memory allocation
  * @nareas:  The area number in the pool.
  * @area_nslabs: The slot number in the area.
+ * @can_grow:	%true if more pools may be added at run time.
+ * @next:	The next pool added at run time, or %NULL.
  */
 struct io_tlb_mem {
 	phys_addr_t start;
@@ -102,14 +104,34 @@ struct io_tlb_mem {
 	unsigned int area_nslabs;
 	struct io_tlb_area *areas;
 	struct io_tlb_slot *slots;
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+	bool can_grow;
+	struct io_tlb_mem *next;
+#endif
 };
 extern struct io_tlb_mem io_tlb_default_mem;
 
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+struct io_tlb_mem *swiotlb_find_pool(struct device *dev, phys_addr_t paddr);
+#endif
+
 static inline bool is_swiotlb_buffer(struct device *dev, phys_addr_t paddr)
 {
 	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
 
-	return mem && paddr >= mem->start && paddr < mem->end;
+	if (!mem)
+		return false;
+	if (paddr >= mem->start && paddr < mem->end)
+		return true;
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+	/*
+	 * Only devices which have been given buffers from a pool added at
+	 * run time need to look beyond their initial pool.
+	 */
+	if (unlikely(READ_ONCE(dev->dma_uses_io_tlb)))
+		return swiotlb_find_pool(dev, paddr) != NULL;
+#endif
+	return false;
 }
 
 static inline bool is_swiotlb_force_bounce(struct device *dev)
@@ -623,6 +623,11 @@ asmlinkage long sys_set_robust_list(struct robust_list_head __user *head,
 asmlinkage long sys_futex_waitv(struct futex_waitv *waiters,
 				unsigned int nr_futexes, unsigned int flags,
 				struct __kernel_timespec __user *timeout, clockid_t clockid);
+asmlinkage long sys_futex_wakev(struct futex_waitv __user *wakers,
+				unsigned int nr_futexes, unsigned int flags);
+asmlinkage long sys_futex_requeuev(struct futex_waitv __user *waiters,
+				   unsigned int nr_futexes, unsigned int flags,
+				   int nr_wake);
 
 /* kernel/hrtimer.c */
 asmlinkage long sys_nanosleep(struct __kernel_timespec __user *rqtp,
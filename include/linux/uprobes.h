@@ -55,6 +55,9 @@ enum uprobe_task_state {
 	UTASK_SSTEP_TRAPPED,
 };
 
+/* Number of recently hit uprobes remembered per task */
+#define UPROBE_TASK_CACHE_SIZE	4
+
 /*
  * uprobe_task: Metadata of a task while it singlesteps.
  */
@@ -78,6 +81,8 @@ struct uprobe_task {
 
 	struct return_instance		*return_instances;
 	unsigned int			depth;
+
+	struct uprobe			*cache[UPROBE_TASK_CACHE_SIZE];
 };
 
 struct return_instance {
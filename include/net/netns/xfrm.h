@@ -10,6 +10,7 @@
 #include <net/dst_ops.h>
 
 struct ctl_table_header;
+struct xfrm_state_lookup_cache;
 
 struct xfrm_policy_hash {
 	struct hlist_head	__rcu *table;
@@ -46,6 +47,12 @@ struct netns_xfrm {
 	unsigned int		state_hmask;
 	unsigned int		state_num;
 	struct work_struct	state_hash_work;
+	/*
+	 * Per-CPU cache of recent xfrm_state_lookup() results, valid while
+	 * state_lookup_genid is unchanged; bumped on every byspi change.
+	 */
+	struct xfrm_state_lookup_cache __percpu *state_lookup_cache;
+	unsigned int		state_lookup_genid;
 
 	struct list_head	policy_all;
 	struct hlist_head	*policy_byidx;
@@ -886,8 +886,13 @@ __SYSCALL(__NR_futex_waitv, sys_futex_waitv)
 #define __NR_set_mempolicy_home_node 450
 __SYSCALL(__NR_set_mempolicy_home_node, sys_set_mempolicy_home_node)
 
+#define __NR_futex_wakev 451
+__SYSCALL(__NR_futex_wakev, sys_futex_wakev)
+#define __NR_futex_requeuev 452
+__SYSCALL(__NR_futex_requeuev, sys_futex_requeuev)
+
 #undef __NR_syscalls
-#define __NR_syscalls 451
+#define __NR_syscalls 453
 
 /*
  * 32 bit systems traditionally used different
@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+#ifndef _UAPI_LINUX_PROC_PIDSTATS_H
+#define _UAPI_LINUX_PROC_PIDSTATS_H
+
+#include <linux/types.h>
+
+/*
+ * Record format of /proc/pidstats.
+ *
+ * A read returns as many whole records as fit into the buffer, one per
+ * thread group visible in the pid namespace of the procfs instance, in
+ * increasing pid order.  The file position is the pid to continue from, so
+ * lseek(fd, pid, SEEK_SET) starts a scan at @pid.
+ *
+ * New fields are only ever appended.  @size is the size of the records as
+ * written by the kernel; userspace must step through the buffer by @size and
+ * ignore trailing fields it doesn't know about.
+ */
+struct proc_pidstats {
+	__u32	size;		/* size of this record in bytes */
+	__u32	pid;
+	__u32	ppid;
+	__u32	uid;		/* real uid */
+	__u32	num_threads;
+	__u32	state;		/* state character, as in /proc/<pid>/stat */
+	__s32	nice;
+	__u32	__reserved;
+	__u64	utime_ns;	/* user time of the whole thread group */
+	__u64	stime_ns;	/* system time of the whole thread group */
+	__u64	start_time_ns;	/* start time after boot */
+	__u64	min_flt;
+	__u64	maj_flt;
+	__u64	vsize;		/* virtual memory size in bytes */
+	__u64	rss_anon;	/* resident anonymous memory in bytes */
+	__u64	rss_file;	/* resident file mappings in bytes */
+	__u64	rss_shmem;	/* resident shmem mappings in bytes */
+	char	comm[16];
+};
+
+#endif /* _UAPI_LINUX_PROC_PIDSTATS_H */
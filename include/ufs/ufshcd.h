@@ -297,6 +297,9 @@ struct ufs_pwr_mode_info {
  * @config_scaling_param: called to configure clock scaling parameters
  * @program_key: program or evict an inline encryption key
  * @event_notify: called to notify important events
+ * @mcq_config_resource: called to set &struct ufs_hba.mcq_base and
+ *	&struct ufs_hba.mcq_size to the MMIO region holding the MCQ registers.
+ *	MCQ mode is only used on hosts that implement it.
  */
 struct ufs_hba_variant_ops {
 	const char *name;
@@ -335,6 +338,7 @@ struct ufs_hba_variant_ops {
 			       const union ufs_crypto_cfg_entry *cfg, int slot);
 	void	(*event_notify)(struct ufs_hba *hba,
 				enum ufs_event_type evt, void *data);
+	int	(*mcq_config_resource)(struct ufs_hba *hba);
 };
 
 /* clock gating state  */
@@ -723,6 +727,42 @@ struct ufs_hba_monitor {
 	bool enabled;
 };
 
+/**
+ * struct ufs_hw_queue - MCQ submission/completion queue pair
+ * @mcq_sq_head: base of the SQ head/tail pointer registers
+ * @mcq_sq_is: base of the SQ interrupt status registers
+ * @mcq_cq_head: base of the CQ head/tail pointer registers
+ * @mcq_cq_is: base of the CQ interrupt status/enable registers
+ * @sqe_base_addr: submission queue entries, one UTRD each
+ * @sqe_dma_addr: DMA address of @sqe_base_addr
+ * @cqe_base_addr: completion queue entries
+ * @cqe_dma_addr: DMA address of @cqe_base_addr
+ * @max_entries: number of entries in each of the two rings
+ * @id: hardware queue ID, also the index into &struct ufs_hba.uhq
+ * @sq_tail_slot: next free submission queue slot
+ * @cq_head_slot: next completion queue entry to be consumed
+ * @sq_lock: serializes submissions to this queue
+ * @cq_lock: serializes completion processing of this queue
+ */
+struct ufs_hw_queue {
+	void __iomem *mcq_sq_head;
+	void __iomem *mcq_sq_is;
+	void __iomem *mcq_cq_head;
+	void __iomem *mcq_cq_is;
+
+	struct utp_transfer_req_desc *sqe_base_addr;
+	dma_addr_t sqe_dma_addr;
+	struct cq_entry *cqe_base_addr;
+	dma_addr_t cqe_dma_addr;
+	u32 max_entries;
+	u32 id;
+	u32 sq_tail_slot;
+	u32 cq_head_slot;
+
+	spinlock_t sq_lock;
+	spinlock_t cq_lock;
+};
+
 /**
  * struct ufs_hba - per adapter private structure
  * @mmio_base: UFSHCI base register address
@@ -828,6 +868,17 @@ struct ufs_hba_monitor {
  *	device
  * @complete_put: whether or not to call ufshcd_rpm_put() from inside
  *	ufshcd_resume_complete()
+ * @mcq_capabilities: Content of the MCQ capabilities register (0x04)
+ * @mcq_sup: whether or not the controller supports Multi-Circular Queue mode
+ * @mcq_enabled: whether or not transfer requests go through @uhq instead of
+ *	the single doorbell-driven transfer request list
+ * @mcq_base: base address the MCQ register offsets published by the
+ *	controller are relative to
+ * @mcq_size: size of the MMIO region mapped at @mcq_base
+ * @uhq: array of @nr_hw_queues MCQ hardware queues
+ * @nr_hw_queues: number of hardware queues exposed to the block layer
+ * @intr_aggr_cnt: UTRIACR counter threshold, in completed requests
+ * @intr_aggr_tmout: UTRIACR timeout, in units of 40 us
  */
 struct ufs_hba {
 	void __iomem *mmio_base;
@@ -975,6 +1026,17 @@ struct ufs_hba {
 #endif
 	u32 luns_avail;
 	bool complete_put;
+
+	u32 mcq_capabilities;
+	bool mcq_sup;
+	bool mcq_enabled;
+	void __iomem *mcq_base;
+	resource_size_t mcq_size;
+	struct ufs_hw_queue *uhq;
+	unsigned int nr_hw_queues;
+
+	u8 intr_aggr_cnt;
+	u8 intr_aggr_tmout;
 };
 
 /* Returns true if clocks can be gated. Otherwise false */
@@ -999,8 +1061,17 @@ static inline bool ufshcd_is_rpm_autosuspend_allowed(struct ufs_hba *hba)
 	return hba->caps & UFSHCD_CAP_RPM_AUTOSUSPEND;
 }
 
+static inline bool is_mcq_enabled(struct ufs_hba *hba)
+{
+	return hba->mcq_enabled;
+}
+
 static inline bool ufshcd_is_intr_aggr_allowed(struct ufs_hba *hba)
 {
+	/* The UTRIACR counter only covers doorbell-driven transfers */
+	if (is_mcq_enabled(hba))
+		return false;
+
 	return (hba->caps & UFSHCD_CAP_INTR_AGGR) &&
 		!(hba->quirks & UFSHCD_QUIRK_BROKEN_INTR_AGGR);
 }
@@ -22,6 +22,7 @@ enum {
 /* UFSHCI Registers */
 enum {
 	REG_CONTROLLER_CAPABILITIES		= 0x00,
+	REG_MCQCAP				= 0x04,
 	REG_UFS_VERSION				= 0x08,
 	REG_CONTROLLER_DEV_ID			= 0x10,
 	REG_CONTROLLER_PROD_ID			= 0x14,
@@ -56,6 +57,9 @@ enum {
 	REG_UFS_CCAP				= 0x100,
 	REG_UFS_CRYPTOCAP			= 0x104,
 
+	REG_UFS_MEM_CFG				= 0x300,
+	REG_UFS_MCQ_CFG				= 0x380,
+
 	UFSHCI_CRYPTO_REG_SPACE_SIZE		= 0x400,
 };
 
@@ -68,8 +72,60 @@ enum {
 	MASK_OUT_OF_ORDER_DATA_DELIVERY_SUPPORT	= 0x02000000,
 	MASK_UIC_DME_TEST_MODE_SUPPORT		= 0x04000000,
 	MASK_CRYPTO_SUPPORT			= 0x10000000,
+	MASK_MCQ_SUPPORT			= 0x40000000,
+};
+
+/* MCQCAP - Multi-Circular Queue Capabilities 04h */
+#define MCQCAP_MAXQ_MASK		GENMASK(7, 0)
+#define MCQCAP_QCFGPTR_MASK		GENMASK(23, 16)
+#define MCQCAP_QCFGPTR_UNIT		0x200
+
+/* UFS_MEM_CFG - Global Config 300h */
+#define MCQ_MODE_SELECT			BIT(0)
+
+/* UFS_MCQ_CFG - MCQ Config 380h */
+#define MCQ_CFG_MAC_MASK		GENMASK(16, 8)
+
+/* MCQ queue configuration registers, one 40h block per queue */
+enum {
+	MCQ_QCFG_SIZE			= 0x40,
+
+	REG_SQATTR			= 0x00,
+	REG_SQLBA			= 0x04,
+	REG_SQUBA			= 0x08,
+	REG_SQDAO			= 0x0C,
+	REG_SQISAO			= 0x10,
+
+	REG_CQATTR			= 0x20,
+	REG_CQLBA			= 0x24,
+	REG_CQUBA			= 0x28,
+	REG_CQDAO			= 0x2C,
+	REG_CQISAO			= 0x30,
+};
+
+/* SQATTR/CQATTR - queue attributes */
+#define MCQ_QUEUE_EN			BIT(31)
+#define MCQ_SQ_CQID_MASK		GENMASK(23, 16)
+#define MCQ_QUEUE_SIZE_MASK		GENMASK(15, 0)
+#define MCQ_ENTRY_SIZE_IN_DWORD		8
+
+/* MCQ operation and runtime registers, offsets within each block */
+enum {
+	MCQ_OPR_SIZE			= 0x08,
+
+	REG_SQHP			= 0x00,
+	REG_SQTP			= 0x04,
+
+	REG_CQHP			= 0x00,
+	REG_CQTP			= 0x04,
+
+	REG_CQIS			= 0x00,
+	REG_CQIE			= 0x04,
 };
 
+/* CQIS/CQIE - Tail Entry Push Status */
+#define MCQ_CQIS_TEPS			BIT(0)
+
 #define UFS_MASK(mask, offset)		((mask) << (offset))
 
 /* UFS Version 08h */
@@ -126,6 +182,7 @@ static inline u32 ufshci_version(u32 major, u32 minor)
 #define CONTROLLER_FATAL_ERROR			0x10000
 #define SYSTEM_BUS_FATAL_ERROR			0x20000
 #define CRYPTO_ENGINE_FATAL_ERROR		0x40000
+#define MCQ_CQ_EVENT_STATUS			0x100000
 
 #define UFSHCD_UIC_HIBERN8_MASK	(UIC_HIBERNATE_ENTER |\
 				UIC_HIBERNATE_EXIT)
@@ -478,6 +535,28 @@ struct utp_transfer_req_desc {
 	__le16  prd_table_offset;
 };
 
+/* MCQ Completion Queue Entry */
+struct cq_entry {
+	/* DW 0-1 */
+	__le64 command_desc_base_addr;
+
+	/* DW 2 */
+	__le16  response_upiu_length;
+	__le16  response_upiu_offset;
+
+	/* DW 3 */
+	__le16  prd_table_length;
+	__le16  prd_table_offset;
+
+	/* DW 4 */
+	__le32 status;
+
+	/* DW 5-7 */
+	__le32 reserved[3];
+};
+
+#define CQE_UCD_BA			GENMASK_ULL(63, 7)
+
 /*
  * UTMRD structure.
  */
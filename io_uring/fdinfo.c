@@ -48,6 +48,43 @@ static __cold int io_uring_show_cred(struct seq_file *m, unsigned int id,
 	return 0;
 }
 
+#ifdef CONFIG_IO_URING_LATENCY_HIST
+static __cold void io_uring_show_lat_hist(struct io_ring_ctx *ctx,
+					  struct seq_file *m)
+{
+	static const char * const stage[IO_LAT_NR] = {
+		[IO_LAT_SUBMIT_ISSUE]	= "submit-issue",
+		[IO_LAT_ISSUE_COMPLETE]	= "issue-complete",
+	};
+	unsigned int op, st, b;
+
+	/* bucket n counts latencies in [2^(n-1), 2^n) usecs, 0 is < 1us */
+	seq_puts(m, "LatHist:\n");
+	for (op = 0; op < IORING_OP_LAST; op++) {
+		for (st = 0; st < IO_LAT_NR; st++) {
+			atomic_long_t *h = ctx->lat_hist->buckets[op][st];
+			int last = -1;
+
+			for (b = 0; b < IO_LAT_BUCKETS; b++)
+				if (atomic_long_read(&h[b]))
+					last = b;
+			if (last < 0)
+				continue;
+			seq_printf(m, "  %s %s:", io_uring_get_opcode(op),
+				   stage[st]);
+			for (b = 0; b <= last; b++)
+				seq_printf(m, " %ld", atomic_long_read(&h[b]));
+			seq_puts(m, "\n");
+		}
+	}
+}
+#else
+static inline void io_uring_show_lat_hist(struct io_ring_ctx *ctx,
+					  struct seq_file *m)
+{
+}
+#endif
+
 static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 					  struct seq_file *m)
 {
@@ -62,6 +99,7 @@ static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 	unsigned int cq_shift = 0;
 	unsigned int sq_shift = 0;
 	unsigned int sq_entries, cq_entries;
+	unsigned long coalesced = 0;
 	bool has_lock;
 	unsigned int i;
 
@@ -161,7 +199,13 @@ static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 		unsigned int len = buf->ubuf_end - buf->ubuf;
 
 		seq_printf(m, "%5u: 0x%llx/%u\n", i, buf->ubuf, len);
+		/* count the page segments folded into large folio bvecs */
+		if (buf->folio_shift > PAGE_SHIFT)
+			coalesced += PFN_UP(buf->ubuf_end) - PFN_DOWN(buf->ubuf) -
+				     buf->nr_bvecs;
 	}
+	if (has_lock)
+		seq_printf(m, "UserBufsCoalesced:\t%lu\n", coalesced);
 	if (has_lock && !xa_empty(&ctx->personalities)) {
 		unsigned long index;
 		const struct cred *cred;
@@ -185,8 +229,9 @@ static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 		spin_unlock(&hb->lock);
 	}
 
-	seq_puts(m, "CqOverflowList:\n");
 	spin_lock(&ctx->completion_lock);
+	seq_printf(m, "CqOverflowSpills:\t%lu\n", ctx->cq_overflow_spills);
+	seq_puts(m, "CqOverflowList:\n");
 	list_for_each_entry(ocqe, &ctx->cq_overflow_list, list) {
 		struct io_uring_cqe *cqe = &ocqe->cqe;
 
@@ -196,6 +241,8 @@ static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 	}
 
 	spin_unlock(&ctx->completion_lock);
+
+	io_uring_show_lat_hist(ctx, m);
 }
 
 __cold void io_uring_show_fdinfo(struct seq_file *m, struct file *f)
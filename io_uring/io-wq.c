@@ -536,13 +536,67 @@ static void io_assign_current_work(struct io_worker *worker,
 
 static void io_wqe_enqueue(struct io_wqe *wqe, struct io_wq_work *work);
 
-static void io_worker_handle_work(struct io_worker *worker)
+static void io_worker_run_work(struct io_worker *worker,
+			       struct io_wq_work *work)
 {
 	struct io_wqe_acct *acct = io_wqe_get_acct(worker);
 	struct io_wqe *wqe = worker->wqe;
 	struct io_wq *wq = wqe->wq;
 	bool do_kill = test_bit(IO_WQ_BIT_EXIT, &wq->state);
 
+	__io_worker_busy(wqe, worker);
+
+	/*
+	 * Make sure cancelation can find this, even before it becomes the
+	 * active work. That avoids a window where the work has been removed
+	 * from our general work list, but isn't yet discoverable as the
+	 * current work item for this worker.
+	 */
+	raw_spin_lock(&worker->lock);
+	worker->next_work = work;
+	raw_spin_unlock(&worker->lock);
+
+	io_assign_current_work(worker, work);
+	__set_current_state(TASK_RUNNING);
+
+	/* handle a whole dependent link */
+	do {
+		struct io_wq_work *next_hashed, *linked;
+		unsigned int hash = io_get_work_hash(work);
+
+		next_hashed = wq_next_work(work);
+
+		if (unlikely(do_kill) && (work->flags & IO_WQ_WORK_UNBOUND))
+			work->flags |= IO_WQ_WORK_CANCEL;
+		wq->do_work(work);
+		io_assign_current_work(worker, NULL);
+
+		linked = wq->free_work(work);
+		work = next_hashed;
+		if (!work && linked && !io_wq_is_hashed(linked)) {
+			work = linked;
+			linked = NULL;
+		}
+		io_assign_current_work(worker, work);
+		if (linked)
+			io_wqe_enqueue(wqe, linked);
+
+		if (hash != -1U && !next_hashed) {
+			/* serialize hash clear with wake_up() */
+			spin_lock_irq(&wq->hash->wait.lock);
+			clear_bit(hash, &wq->hash->map);
+			clear_bit(IO_ACCT_STALLED_BIT, &acct->flags);
+			spin_unlock_irq(&wq->hash->wait.lock);
+			if (wq_has_sleeper(&wq->hash->wait))
+				wake_up(&wq->hash->wait);
+		}
+	} while (work);
+}
+
+static void io_worker_handle_work(struct io_worker *worker)
+{
+	struct io_wqe_acct *acct = io_wqe_get_acct(worker);
+
 	do {
 		struct io_wq_work *work;
 
@@ -556,60 +610,73 @@ static void io_worker_handle_work(struct io_worker *worker)
 		raw_spin_lock(&acct->lock);
 		work = io_get_next_work(acct, worker);
 		raw_spin_unlock(&acct->lock);
-		if (work) {
-			__io_worker_busy(wqe, worker);
-
-			/*
-			 * Make sure cancelation can find this, even before
-			 * it becomes the active work. That avoids a window
-			 * where the work has been removed from our general
-			 * work list, but isn't yet discoverable as the
-			 * current work item for this worker.
-			 */
-			raw_spin_lock(&worker->lock);
-			worker->next_work = work;
-			raw_spin_unlock(&worker->lock);
-		} else {
+		if (!work)
 			break;
-		}
-		io_assign_current_work(worker, work);
-		__set_current_state(TASK_RUNNING);
-
-		/* handle a whole dependent link */
-		do {
-			struct io_wq_work *next_hashed, *linked;
-			unsigned int hash = io_get_work_hash(work);
-
-			next_hashed = wq_next_work(work);
-
-			if (unlikely(do_kill) && (work->flags & IO_WQ_WORK_UNBOUND))
-				work->flags |= IO_WQ_WORK_CANCEL;
-			wq->do_work(work);
-			io_assign_current_work(worker, NULL);
-
-			linked = wq->free_work(work);
-			work = next_hashed;
-			if (!work && linked && !io_wq_is_hashed(linked)) {
-				work = linked;
-				linked = NULL;
-			}
-			io_assign_current_work(worker, work);
-			if (linked)
-				io_wqe_enqueue(wqe, linked);
-
-			if (hash != -1U && !next_hashed) {
-				/* serialize hash clear with wake_up() */
-				spin_lock_irq(&wq->hash->wait.lock);
-				clear_bit(hash, &wq->hash->map);
-				clear_bit(IO_ACCT_STALLED_BIT, &acct->flags);
-				spin_unlock_irq(&wq->hash->wait.lock);
-				if (wq_has_sleeper(&wq->hash->wait))
-					wake_up(&wq->hash->wait);
-			}
-		} while (work);
+		io_worker_run_work(worker, work);
 	} while (1);
 }
 
+/*
+ * Our own node has nothing runnable. Before going idle, look at the other
+ * nodes of this io_wq and take the first unhashed item of the same bound
+ * type. Hashed work is left alone, as the hash tail tracking is per wqe.
+ */
+static struct io_wq_work *io_wqe_steal_work(struct io_worker *worker)
+{
+	struct io_wqe *wqe = worker->wqe;
+	struct io_wq *wq = wqe->wq;
+	int index = io_wqe_get_acct(worker)->index;
+	int node;
+
+	for_each_node(node) {
+		struct io_wqe *victim = wq->wqes[node];
+		struct io_wq_work_node *pos, *prev;
+		struct io_wqe_acct *acct;
+
+		if (victim == wqe)
+			continue;
+		acct = &victim->acct[index];
+		if (wq_list_empty(&acct->work_list))
+			continue;
+		if (!cpumask_intersects(victim->cpu_mask, wqe->cpu_mask))
+			continue;
+
+		raw_spin_lock(&acct->lock);
+		wq_list_for_each(pos, prev, &acct->work_list) {
+			struct io_wq_work *work;
+
+			work = container_of(pos, struct io_wq_work, list);
+			if (io_wq_is_hashed(work))
+				continue;
+			wq_list_del(&acct->work_list, pos, prev);
+			raw_spin_unlock(&acct->lock);
+			return work;
+		}
+		raw_spin_unlock(&acct->lock);
+	}
+
+	return NULL;
+}
+
+static bool io_worker_steal_work(struct io_worker *worker)
+{
+	struct io_wq_work *work;
+
+	/*
+	 * All workers of a node already share its work lists, and work is
+	 * only ever queued to online nodes, so a single node has nobody to
+	 * steal from.
+	 */
+	if (num_online_nodes() <= 1)
+		return false;
+
+	work = io_wqe_steal_work(worker);
+	if (!work)
+		return false;
+	io_worker_run_work(worker, work);
+	return true;
+}
+
 static int io_wqe_worker(void *data)
 {
 	struct io_worker *worker = data;
@@ -630,6 +697,9 @@ static int io_wqe_worker(void *data)
 		set_current_state(TASK_INTERRUPTIBLE);
 		while (io_acct_run_queue(acct))
 			io_worker_handle_work(worker);
+		if (!test_bit(IO_WQ_BIT_EXIT, &wq->state) &&
+		    io_worker_steal_work(worker))
+			continue;
 
 		raw_spin_lock(&wqe->lock);
 		/* timed out, exit unless we're the last worker */
@@ -91,10 +91,12 @@
 #include "cancel.h"
 #include "net.h"
 #include "notif.h"
+#include "msg_ring.h"
 
 #include "timeout.h"
 #include "poll.h"
 #include "alloc_cache.h"
+#include "uring_cmd.h"
 
 #define IORING_MAX_ENTRIES	32768
 #define IORING_MAX_CQ_ENTRIES	(2 * IORING_MAX_ENTRIES)
@@ -167,7 +169,10 @@ EXPORT_SYMBOL(io_uring_get_socket);
 
 static inline void io_submit_flush_completions(struct io_ring_ctx *ctx)
 {
-	if (!wq_list_empty(&ctx->submit_state.compl_reqs))
+	if (ctx->submit_state.msg_nr)
+		io_msg_ring_flush(ctx);
+	if (!wq_list_empty(&ctx->submit_state.compl_reqs) ||
+	    ctx->submit_state.cqes_count)
 		__io_submit_flush_completions(ctx);
 }
 
@@ -294,6 +299,9 @@ static __cold struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
 	/* set invalid range, so io_import_fixed() fails meeting it */
 	ctx->dummy_ubuf->ubuf = -1UL;
 
+	if (io_lat_hist_alloc(ctx))
+		goto err;
+
 	if (percpu_ref_init(&ctx->refs, io_ring_ctx_ref_free,
 			    0, GFP_KERNEL))
 		goto err;
@@ -302,6 +310,8 @@ static __cold struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
 	init_waitqueue_head(&ctx->sqo_sq_wait);
 	INIT_LIST_HEAD(&ctx->sqd_list);
 	INIT_LIST_HEAD(&ctx->cq_overflow_list);
+	INIT_HLIST_HEAD(&ctx->cancelable_uring_cmd);
+	INIT_LIST_HEAD(&ctx->cq_overflow_cache);
 	INIT_LIST_HEAD(&ctx->io_buffers_cache);
 	io_alloc_cache_init(&ctx->apoll_cache);
 	io_alloc_cache_init(&ctx->netmsg_cache);
@@ -329,6 +339,7 @@ static __cold struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
 	INIT_WQ_LIST(&ctx->submit_state.compl_reqs);
 	return ctx;
 err:
+	io_lat_hist_free(ctx);
 	kfree(ctx->dummy_ubuf);
 	kfree(ctx->cancel_table.hbs);
 	kfree(ctx->cancel_table_locked.hbs);
@@ -621,8 +632,18 @@ static bool __io_cqring_overflow_flush(struct io_ring_ctx *ctx, bool force)
 		else
 			io_account_cq_overflow(ctx);
 
-		list_del(&ocqe->list);
-		kfree(ocqe);
+		/*
+		 * Keep up to a CQ ring's worth of entries around, so the next
+		 * burst doesn't have to go to the allocator from atomic
+		 * context for every completion that doesn't fit.
+		 */
+		if (ctx->cq_overflow_cached < ctx->cq_entries) {
+			list_move(&ocqe->list, &ctx->cq_overflow_cache);
+			ctx->cq_overflow_cached++;
+		} else {
+			list_del(&ocqe->list);
+			kfree(ocqe);
+		}
 	}
 
 	all_flushed = list_empty(&ctx->cq_overflow_list);
@@ -692,7 +713,14 @@ static bool io_cqring_event_overflow(struct io_ring_ctx *ctx, u64 user_data,
 	if (is_cqe32)
 		ocq_size += sizeof(struct io_uring_cqe);
 
-	ocqe = kmalloc(ocq_size, GFP_ATOMIC | __GFP_ACCOUNT);
+	ocqe = list_first_entry_or_null(&ctx->cq_overflow_cache,
+					struct io_overflow_cqe, list);
+	if (ocqe) {
+		list_del(&ocqe->list);
+		ctx->cq_overflow_cached--;
+	} else {
+		ocqe = kmalloc(ocq_size, GFP_ATOMIC | __GFP_ACCOUNT);
+	}
 	trace_io_uring_cqe_overflow(ctx, user_data, res, cflags, ocqe);
 	if (!ocqe) {
 		/*
@@ -709,6 +737,7 @@ static bool io_cqring_event_overflow(struct io_ring_ctx *ctx, u64 user_data,
 		atomic_or(IORING_SQ_CQ_OVERFLOW, &ctx->rings->sq_flags);
 
 	}
+	ctx->cq_overflow_spills++;
 	ocqe->cqe.user_data = user_data;
 	ocqe->cqe.res = res;
 	ocqe->cqe.flags = cflags;
@@ -818,6 +847,58 @@ bool io_post_aux_cqe(struct io_ring_ctx *ctx,
 	return filled;
 }
 
+static void __io_flush_post_cqes(struct io_ring_ctx *ctx)
+	__must_hold(&ctx->uring_lock)
+	__must_hold(&ctx->completion_lock)
+{
+	struct io_submit_state *state = &ctx->submit_state;
+	unsigned int i;
+
+	for (i = 0; i < state->cqes_count; i++) {
+		struct io_uring_cqe *cqe = &state->cqes[i];
+
+		io_fill_cqe_aux(ctx, cqe->user_data, cqe->res, cqe->flags, true);
+	}
+	state->cqes_count = 0;
+}
+
+/*
+ * Post an aux CQE. If @defer is set, the caller holds ->uring_lock and the
+ * CQE is stashed and filled in with the next completion flush, so that a
+ * task_work run posting many multishot CQEs only takes ->completion_lock
+ * and wakes waiters once.
+ */
+bool io_aux_cqe(struct io_ring_ctx *ctx, bool defer, u64 user_data, s32 res,
+		u32 cflags, bool allow_overflow)
+{
+	struct io_submit_state *state = &ctx->submit_state;
+	struct io_uring_cqe *cqe;
+
+	if (!defer)
+		return io_post_aux_cqe(ctx, user_data, res, cflags, allow_overflow);
+
+	lockdep_assert_held(&ctx->uring_lock);
+
+	if (state->cqes_count == ARRAY_SIZE(state->cqes)) {
+		io_cq_lock(ctx);
+		__io_flush_post_cqes(ctx);
+		__io_cq_unlock_post(ctx);
+	}
+
+	/*
+	 * Not as strict as the non-deferred case, but it still prevents
+	 * unbounded posting of completions once we have overflowed.
+	 */
+	if (!allow_overflow && test_bit(IO_CHECK_CQ_OVERFLOW_BIT, &ctx->check_cq))
+		return false;
+
+	cqe = &state->cqes[state->cqes_count++];
+	cqe->user_data = user_data;
+	cqe->res = res;
+	cqe->flags = cflags;
+	return true;
+}
+
 static void __io_req_complete_put(struct io_kiocb *req)
 {
 	/*
@@ -892,6 +973,7 @@ static void io_preinit_req(struct io_kiocb *req, struct io_ring_ctx *ctx)
 	req->async_data = NULL;
 	/* not necessary, but safer to zero */
 	req->cqe.res = 0;
+	io_lat_init(req);
 }
 
 static void io_flush_cached_locked_reqs(struct io_ring_ctx *ctx,
@@ -1339,6 +1421,9 @@ static void __io_submit_flush_completions(struct io_ring_ctx *ctx)
 	struct io_submit_state *state = &ctx->submit_state;
 
 	io_cq_lock(ctx);
+	/* aux CQEs were posted before any of the batched requests completed */
+	if (state->cqes_count)
+		__io_flush_post_cqes(ctx);
 	wq_list_for_each(node, prev, &state->compl_reqs) {
 		struct io_kiocb *req = container_of(node, struct io_kiocb,
 					    comp_list);
@@ -1348,8 +1433,10 @@ static void __io_submit_flush_completions(struct io_ring_ctx *ctx)
 	}
 	__io_cq_unlock_post(ctx);
 
-	io_free_batch_list(ctx, state->compl_reqs.first);
-	INIT_WQ_LIST(&state->compl_reqs);
+	if (!wq_list_empty(&state->compl_reqs)) {
+		io_free_batch_list(ctx, state->compl_reqs.first);
+		INIT_WQ_LIST(&state->compl_reqs);
+	}
 }
 
 /*
@@ -1735,6 +1822,7 @@ static int io_issue_sqe(struct io_kiocb *req, unsigned int issue_flags)
 	if (!def->audit_skip)
 		audit_uring_entry(req->opcode);
 
+	io_lat_issue(req);
 	ret = def->issue(req, issue_flags);
 
 	if (!def->audit_skip)
@@ -2002,6 +2090,7 @@ static int io_init_req(struct io_ring_ctx *ctx, struct io_kiocb *req,
 	req->file = NULL;
 	req->rsrc_node = NULL;
 	req->task = current;
+	io_lat_submit(req);
 
 	if (unlikely(opcode >= IORING_OP_LAST)) {
 		req->opcode = 0;
@@ -2590,6 +2679,14 @@ static __cold void io_ring_ctx_free(struct io_ring_ctx *ctx)
 		__io_sqe_files_unregister(ctx);
 	if (ctx->rings)
 		__io_cqring_overflow_flush(ctx, true);
+	while (!list_empty(&ctx->cq_overflow_cache)) {
+		struct io_overflow_cqe *ocqe;
+
+		ocqe = list_first_entry(&ctx->cq_overflow_cache,
+					struct io_overflow_cqe, list);
+		list_del(&ocqe->list);
+		kfree(ocqe);
+	}
 	io_eventfd_unregister(ctx);
 	io_alloc_cache_free(&ctx->apoll_cache, io_apoll_cache_free);
 	io_alloc_cache_free(&ctx->netmsg_cache, io_netmsg_cache_free);
@@ -2633,6 +2730,7 @@ static __cold void io_ring_ctx_free(struct io_ring_ctx *ctx)
 		io_wq_put_hash(ctx->hash_map);
 	kfree(ctx->cancel_table.hbs);
 	kfree(ctx->cancel_table_locked.hbs);
+	io_lat_hist_free(ctx);
 	kfree(ctx->dummy_ubuf);
 	kfree(ctx->io_bl);
 	xa_destroy(&ctx->io_bl_xa);
@@ -2932,6 +3030,7 @@ static __cold bool io_uring_try_cancel_requests(struct io_ring_ctx *ctx,
 	ret |= io_cancel_defer_files(ctx, task, cancel_all);
 	mutex_lock(&ctx->uring_lock);
 	ret |= io_poll_remove_all(ctx, task, cancel_all);
+	ret |= io_uring_try_cancel_uring_cmd(ctx, task, cancel_all);
 	mutex_unlock(&ctx->uring_lock);
 	ret |= io_kill_timeouts(ctx, task, cancel_all);
 	if (task)
@@ -28,6 +28,17 @@ struct io_provide_buf {
 	__u16				bid;
 };
 
+/*
+ * Classic provided buffers of a different length than the ones already in
+ * a group are kept on their own list, so selection can pick the smallest
+ * buffer that fits the transfer.
+ */
+struct io_buffer_class {
+	struct list_head list;
+	struct list_head buf_list;
+	__u32 len;
+};
+
 static inline struct io_buffer_list *io_buffer_get_list(struct io_ring_ctx *ctx,
 							unsigned int bgid)
 {
@@ -47,6 +58,88 @@ static int io_buffer_add_list(struct io_ring_ctx *ctx,
 	return xa_err(xa_store(&ctx->io_bl_xa, bgid, bl, GFP_KERNEL));
 }
 
+static void io_buffer_list_init(struct io_buffer_list *bl)
+{
+	INIT_LIST_HEAD(&bl->buf_list);
+	INIT_LIST_HEAD(&bl->classes);
+	bl->buf_len = 0;
+	bl->buf_seq = 0;
+}
+
+/*
+ * Return the list holding buffers of length @len in this group. The first
+ * length ever provided lives in ->buf_list, others in ->classes sorted by
+ * ascending length. If @alloc is set, a missing class is created.
+ */
+static struct list_head *io_buffer_class_list(struct io_buffer_list *bl,
+					      __u32 len, bool alloc)
+{
+	struct io_buffer_class *cls, *new;
+
+	if (!bl->buf_len && list_empty(&bl->classes))
+		bl->buf_len = len;
+	if (bl->buf_len == len)
+		return &bl->buf_list;
+
+	list_for_each_entry(cls, &bl->classes, list) {
+		if (cls->len == len)
+			return &cls->buf_list;
+		if (cls->len > len)
+			break;
+	}
+	if (!alloc)
+		return NULL;
+
+	new = kmalloc(sizeof(*new), GFP_KERNEL_ACCOUNT);
+	if (!new)
+		return NULL;
+	INIT_LIST_HEAD(&new->buf_list);
+	new->len = len;
+	/* insert before the first larger class, or at the tail */
+	list_add_tail(&new->list, &cls->list);
+	return &new->buf_list;
+}
+
+static void io_buffer_free_classes(struct io_buffer_list *bl)
+{
+	struct io_buffer_class *cls, *tmp;
+
+	list_for_each_entry_safe(cls, tmp, &bl->classes, list) {
+		list_del(&cls->list);
+		kfree(cls);
+	}
+	bl->buf_len = 0;
+}
+
+static bool io_buffer_list_empty(struct io_buffer_list *bl)
+{
+	struct io_buffer_class *cls;
+
+	if (!list_empty(&bl->buf_list))
+		return false;
+	list_for_each_entry(cls, &bl->classes, list)
+		if (!list_empty(&cls->buf_list))
+			return false;
+	return true;
+}
+
+/*
+ * Put a buffer back where it was taken from. Buffers are taken from the
+ * head of their list, but several may come back in any order, so insert by
+ * the order they were provided in to keep each list FIFO.
+ */
+static void io_buffer_list_insert(struct list_head *buf_list,
+				  struct io_buffer *buf)
+{
+	struct io_buffer *pos;
+
+	list_for_each_entry(pos, buf_list, list) {
+		if ((s32)(pos->seq - buf->seq) > 0)
+			break;
+	}
+	list_add_tail(&buf->list, &pos->list);
+}
+
 void io_kbuf_recycle_legacy(struct io_kiocb *req, unsigned issue_flags)
 {
 	struct io_ring_ctx *ctx = req->ctx;
@@ -66,7 +159,13 @@ void io_kbuf_recycle_legacy(struct io_kiocb *req, unsigned issue_flags)
 
 	buf = req->kbuf;
 	bl = io_buffer_get_list(ctx, buf->bgid);
-	list_add(&buf->list, &bl->buf_list);
+	/*
+	 * The buffer's class may have been freed while it was in use. If it
+	 * can't be recreated, any list will do, selection clamps the length
+	 * to the buffer's own.
+	 */
+	io_buffer_list_insert(io_buffer_class_list(bl, buf->len, true) ?:
+			      &bl->buf_list, buf);
 	req->flags &= ~REQ_F_BUFFER_SELECTED;
 	req->buf_index = buf->bgid;
 
@@ -107,13 +206,57 @@ unsigned int __io_put_kbuf(struct io_kiocb *req, unsigned issue_flags)
 	return cflags;
 }
 
+/*
+ * Pick the list to take a classic buffer from. Without any extra size
+ * classes this is always ->buf_list. Otherwise use the smallest non-empty
+ * class that fits @len, or the largest non-empty one if none does or if
+ * no length was given.
+ */
+static struct list_head *io_provided_buffer_class(struct io_buffer_list *bl,
+						  size_t len)
+{
+	struct list_head *best = NULL, *largest = NULL;
+	__u32 best_len = 0, largest_len = 0;
+	struct io_buffer_class *cls;
+
+	if (likely(list_empty(&bl->classes)))
+		return &bl->buf_list;
+
+	if (!list_empty(&bl->buf_list)) {
+		if (bl->buf_len >= len) {
+			best = &bl->buf_list;
+			best_len = bl->buf_len;
+		}
+		largest = &bl->buf_list;
+		largest_len = bl->buf_len;
+	}
+	list_for_each_entry(cls, &bl->classes, list) {
+		if (list_empty(&cls->buf_list))
+			continue;
+		if (cls->len >= len && (!best || cls->len < best_len)) {
+			best = &cls->buf_list;
+			best_len = cls->len;
+		}
+		if (!largest || cls->len > largest_len) {
+			largest = &cls->buf_list;
+			largest_len = cls->len;
+		}
+	}
+
+	if (len && best)
+		return best;
+	return largest ?: &bl->buf_list;
+}
+
 static void __user *io_provided_buffer_select(struct io_kiocb *req, size_t *len,
 					      struct io_buffer_list *bl)
 {
-	if (!list_empty(&bl->buf_list)) {
+	struct list_head *buf_list = io_provided_buffer_class(bl, *len);
+
+	if (!list_empty(buf_list)) {
 		struct io_buffer *kbuf;
 
-		kbuf = list_first_entry(&bl->buf_list, struct io_buffer, list);
+		kbuf = list_first_entry(buf_list, struct io_buffer, list);
 		list_del(&kbuf->list);
 		if (*len == 0 || *len > kbuf->len)
 			*len = kbuf->len;
@@ -198,7 +341,7 @@ static __cold int io_init_bl_list(struct io_ring_ctx *ctx)
 		return -ENOMEM;
 
 	for (i = 0; i < BGID_ARRAY; i++) {
-		INIT_LIST_HEAD(&ctx->io_bl[i].buf_list);
+		io_buffer_list_init(&ctx->io_bl[i]);
 		ctx->io_bl[i].bgid = i;
 	}
 
@@ -224,7 +367,7 @@ static int __io_remove_buffers(struct io_ring_ctx *ctx,
 		bl->buf_pages = NULL;
 		bl->buf_nr_pages = 0;
 		/* make sure it's seen as empty */
-		INIT_LIST_HEAD(&bl->buf_list);
+		io_buffer_list_init(bl);
 		return i;
 	}
 
@@ -238,6 +381,24 @@ static int __io_remove_buffers(struct io_ring_ctx *ctx,
 			return i;
 		cond_resched();
 	}
+
+	if (!list_empty(&bl->classes)) {
+		struct io_buffer_class *cls;
+
+		list_for_each_entry(cls, &bl->classes, list) {
+			while (!list_empty(&cls->buf_list)) {
+				struct io_buffer *nxt;
+
+				nxt = list_first_entry(&cls->buf_list,
+						       struct io_buffer, list);
+				list_del(&nxt->list);
+				if (++i == nbufs)
+					return i;
+				cond_resched();
+			}
+		}
+		io_buffer_free_classes(bl);
+	}
 	i++;
 
 	return i;
@@ -396,19 +557,33 @@ static int io_refill_buffer_cache(struct io_ring_ctx *ctx)
 static int io_add_buffers(struct io_ring_ctx *ctx, struct io_provide_buf *pbuf,
 			  struct io_buffer_list *bl)
 {
+	__u32 len = min_t(__u32, pbuf->len, MAX_RW_COUNT);
+	struct list_head *buf_list;
 	struct io_buffer *buf;
 	u64 addr = pbuf->addr;
 	int i, bid = pbuf->bid;
 
+	/*
+	 * An empty group starts over from the length provided next, rather
+	 * than keeping ->buf_len for buffers that are all gone.
+	 */
+	if (bl->buf_len && io_buffer_list_empty(bl))
+		io_buffer_free_classes(bl);
+
+	buf_list = io_buffer_class_list(bl, len, true);
+	if (!buf_list)
+		return -ENOMEM;
+
 	for (i = 0; i < pbuf->nbufs; i++) {
 		if (list_empty(&ctx->io_buffers_cache) &&
 		    io_refill_buffer_cache(ctx))
 			break;
 		buf = list_first_entry(&ctx->io_buffers_cache, struct io_buffer,
 					list);
-		list_move_tail(&buf->list, &bl->buf_list);
+		list_move_tail(&buf->list, buf_list);
 		buf->addr = addr;
-		buf->len = min_t(__u32, pbuf->len, MAX_RW_COUNT);
+		buf->len = len;
+		buf->seq = bl->buf_seq++;
 		buf->bid = bid;
 		buf->bgid = pbuf->bgid;
 		addr += pbuf->len;
@@ -441,7 +616,7 @@ int io_provide_buffers(struct io_kiocb *req, unsigned int issue_flags)
 			ret = -ENOMEM;
 			goto err;
 		}
-		INIT_LIST_HEAD(&bl->buf_list);
+		io_buffer_list_init(bl);
 		ret = io_buffer_add_list(ctx, bl, p->bgid);
 		if (ret) {
 			kfree(bl);
@@ -498,12 +673,14 @@ int io_register_pbuf_ring(struct io_ring_ctx *ctx, void __user *arg)
 	bl = io_buffer_get_list(ctx, reg.bgid);
 	if (bl) {
 		/* if mapped buffer ring OR classic exists, don't allow */
-		if (bl->buf_nr_pages || !list_empty(&bl->buf_list))
+		if (bl->buf_nr_pages || !list_empty(&bl->buf_list) ||
+		    !list_empty(&bl->classes))
 			return -EEXIST;
 	} else {
 		free_bl = bl = kzalloc(sizeof(*bl), GFP_KERNEL);
 		if (!bl)
 			return -ENOMEM;
+		io_buffer_list_init(bl);
 	}
 
 	pages = io_pin_pages(reg.ring_addr,
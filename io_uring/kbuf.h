@@ -18,6 +18,11 @@ struct io_buffer_list {
 	};
 	__u16 bgid;
 
+	/* below is for classic provided buffers */
+	__u32 buf_len;
+	__u32 buf_seq;
+	struct list_head classes;
+
 	/* below is for ring provided buffers */
 	__u16 buf_nr_pages;
 	__u16 nr_entries;
@@ -29,6 +34,8 @@ struct io_buffer {
 	struct list_head list;
 	__u64 addr;
 	__u32 len;
+	/* order the buffer was provided in, see io_kbuf_recycle_legacy() */
+	__u32 seq;
 	__u16 bid;
 	__u16 bgid;
 };
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef IOU_LAT_HIST_H
+#define IOU_LAT_HIST_H
+
+#include <linux/io_uring_types.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/slab.h>
+
+enum {
+	IO_LAT_SUBMIT_ISSUE,
+	IO_LAT_ISSUE_COMPLETE,
+	IO_LAT_NR,
+};
+
+/* log2 buckets of microseconds, the last one catches everything above */
+#define IO_LAT_BUCKETS		24
+
+struct io_lat_hist {
+	atomic_long_t	buckets[IORING_OP_LAST][IO_LAT_NR][IO_LAT_BUCKETS];
+};
+
+#ifdef CONFIG_IO_URING_LATENCY_HIST
+static inline void io_lat_hist_add(struct io_ring_ctx *ctx, u8 opcode,
+				   int stage, u64 delta_ns)
+{
+	unsigned int b = fls64(delta_ns / NSEC_PER_USEC);
+
+	if (b >= IO_LAT_BUCKETS)
+		b = IO_LAT_BUCKETS - 1;
+	atomic_long_inc(&ctx->lat_hist->buckets[opcode][stage][b]);
+}
+
+static inline void io_lat_init(struct io_kiocb *req)
+{
+	req->submit_ns = 0;
+	req->issue_ns = 0;
+}
+
+static inline void io_lat_submit(struct io_kiocb *req)
+{
+	req->submit_ns = ktime_get_ns();
+	req->issue_ns = 0;
+}
+
+/* only the first issue attempt counts, retries are part of the issue time */
+static inline void io_lat_issue(struct io_kiocb *req)
+{
+	u64 now;
+
+	if (req->issue_ns || !req->submit_ns)
+		return;
+	now = ktime_get_ns();
+	req->issue_ns = now;
+	io_lat_hist_add(req->ctx, req->opcode, IO_LAT_SUBMIT_ISSUE,
+			now - req->submit_ns);
+}
+
+static inline void io_lat_complete(struct io_kiocb *req)
+{
+	if (!req->issue_ns)
+		return;
+	io_lat_hist_add(req->ctx, req->opcode, IO_LAT_ISSUE_COMPLETE,
+			ktime_get_ns() - req->issue_ns);
+	req->issue_ns = 0;
+}
+
+static inline int io_lat_hist_alloc(struct io_ring_ctx *ctx)
+{
+	ctx->lat_hist = kvzalloc(sizeof(*ctx->lat_hist), GFP_KERNEL_ACCOUNT);
+	return ctx->lat_hist ? 0 : -ENOMEM;
+}
+
+static inline void io_lat_hist_free(struct io_ring_ctx *ctx)
+{
+	kvfree(ctx->lat_hist);
+	ctx->lat_hist = NULL;
+}
+#else
+static inline void io_lat_init(struct io_kiocb *req)
+{
+}
+static inline void io_lat_submit(struct io_kiocb *req)
+{
+}
+static inline void io_lat_issue(struct io_kiocb *req)
+{
+}
+static inline void io_lat_complete(struct io_kiocb *req)
+{
+}
+static inline int io_lat_hist_alloc(struct io_ring_ctx *ctx)
+{
+	return 0;
+}
+static inline void io_lat_hist_free(struct io_ring_ctx *ctx)
+{
+}
+#endif
+
+#endif
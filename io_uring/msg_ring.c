@@ -23,18 +23,68 @@ struct io_msg {
 	u32 flags;
 };
 
-static int io_msg_ring_data(struct io_kiocb *req)
+/*
+ * Post the data messages queued by inline issue to their target ring, with
+ * a single completion lock round trip and CQ wakeup for the whole batch.
+ * This runs before the completions of the sending requests are posted, so
+ * a message that can't be delivered still fails its request.
+ */
+void io_msg_ring_flush(struct io_ring_ctx *ctx)
+	__must_hold(&ctx->uring_lock)
+{
+	struct io_submit_state *state = &ctx->submit_state;
+	struct io_ring_ctx *target_ctx = state->msg_file->private_data;
+	unsigned int i;
+
+	io_cq_lock(target_ctx);
+	for (i = 0; i < state->msg_nr; i++) {
+		struct io_kiocb *req = state->msg_reqs[i];
+		struct io_msg *msg = io_kiocb_to_cmd(req, struct io_msg);
+
+		if (!io_fill_cqe_aux(target_ctx, msg->user_data, msg->len, 0,
+				     true)) {
+			req_set_fail(req);
+			io_req_set_res(req, -EOVERFLOW, 0);
+		}
+	}
+	io_cq_unlock_post(target_ctx);
+
+	fput(state->msg_file);
+	state->msg_file = NULL;
+	state->msg_nr = 0;
+}
+
+static int io_msg_ring_data(struct io_kiocb *req, unsigned int issue_flags)
 {
 	struct io_ring_ctx *target_ctx = req->file->private_data;
 	struct io_msg *msg = io_kiocb_to_cmd(req, struct io_msg);
+	struct io_submit_state *state = &req->ctx->submit_state;
 
 	if (msg->src_fd || msg->dst_fd || msg->flags)
 		return -EINVAL;
 
-	if (io_post_aux_cqe(target_ctx, msg->user_data, msg->len, 0, true))
-		return 0;
+	/*
+	 * Unless our completion is deferred to the submit state, post
+	 * directly. Otherwise queue the request and let the completion flush
+	 * at the end of this submit or task_work run deliver the message
+	 * together with its neighbours, before our own CQE. As overflow is
+	 * allowed, posting can only fail if we can't allocate an overflow
+	 * entry, which fails the request with -EOVERFLOW.
+	 */
+	if (!(issue_flags & IO_URING_F_COMPLETE_DEFER)) {
+		if (io_post_aux_cqe(target_ctx, msg->user_data, msg->len, 0, true))
+			return 0;
+		return -EOVERFLOW;
+	}
 
-	return -EOVERFLOW;
+	if (state->msg_nr && (state->msg_file != req->file ||
+			      state->msg_nr == ARRAY_SIZE(state->msg_reqs)))
+		io_msg_ring_flush(req->ctx);
+	if (!state->msg_nr)
+		state->msg_file = get_file(req->file);
+
+	state->msg_reqs[state->msg_nr++] = req;
+	return 0;
 }
 
 static void io_double_unlock_ctx(struct io_ring_ctx *ctx,
@@ -153,7 +203,7 @@ int io_msg_ring(struct io_kiocb *req, unsigned int issue_flags)
 
 	switch (msg->cmd) {
 	case IORING_MSG_DATA:
-		ret = io_msg_ring_data(req);
+		ret = io_msg_ring_data(req, issue_flags);
 		break;
 	case IORING_MSG_SEND_FD:
 		ret = io_msg_send_fd(req, issue_flags);
@@ -539,7 +539,8 @@ int io_recvmsg_prep_async(struct io_kiocb *req)
 	return ret;
 }
 
-#define RECVMSG_FLAGS (IORING_RECVSEND_POLL_FIRST | IORING_RECV_MULTISHOT)
+#define RECVMSG_FLAGS (IORING_RECVSEND_POLL_FIRST | IORING_RECV_MULTISHOT | \
+		       IORING_RECVSEND_FIXED_BUF)
 
 int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 {
@@ -567,6 +568,20 @@ int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 			return -EINVAL;
 		req->flags |= REQ_F_APOLL_MULTISHOT;
 	}
+	if (sr->flags & IORING_RECVSEND_FIXED_BUF) {
+		struct io_ring_ctx *ctx = req->ctx;
+		unsigned idx = READ_ONCE(sqe->buf_index);
+
+		/* plain recv only, straight into a registered buffer */
+		if (req->opcode != IORING_OP_RECV ||
+		    (req->flags & REQ_F_BUFFER_SELECT))
+			return -EINVAL;
+		if (unlikely(idx >= ctx->nr_user_bufs))
+			return -EFAULT;
+		idx = array_index_nospec(idx, ctx->nr_user_bufs);
+		req->imu = READ_ONCE(ctx->user_bufs[idx]);
+		io_req_set_rsrc_node(req, ctx, 0);
+	}
 
 #ifdef CONFIG_COMPAT
 	if (req->ctx->compat)
@@ -847,7 +862,12 @@ int io_recv(struct io_kiocb *req, unsigned int issue_flags)
 		sr->buf = buf;
 	}
 
-	ret = import_single_range(READ, sr->buf, len, &iov, &msg.msg_iter);
+	if (sr->flags & IORING_RECVSEND_FIXED_BUF)
+		ret = io_import_fixed(READ, &msg.msg_iter, req->imu,
+				      (u64)(uintptr_t)sr->buf, len);
+	else
+		ret = import_single_range(READ, sr->buf, len, &iov,
+					  &msg.msg_iter);
 	if (unlikely(ret))
 		goto out_free;
 
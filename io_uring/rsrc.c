@@ -142,8 +142,16 @@ static void io_buffer_unmap(struct io_ring_ctx *ctx, struct io_mapped_ubuf **slo
 	unsigned int i;
 
 	if (imu != ctx->dummy_ubuf) {
-		for (i = 0; i < imu->nr_bvecs; i++)
-			unpin_user_page(imu->bvec[i].bv_page);
+		for (i = 0; i < imu->nr_bvecs; i++) {
+			struct bio_vec *bv = &imu->bvec[i];
+
+			if (imu->folio_shift == PAGE_SHIFT)
+				unpin_user_page(bv->bv_page);
+			else
+				unpin_user_page_range_dirty_lock(bv->bv_page,
+					DIV_ROUND_UP(bv->bv_offset + bv->bv_len,
+						     PAGE_SIZE), false);
+		}
 		if (imu->acct_pages)
 			io_unaccount_mem(ctx, imu->acct_pages);
 		kvfree(imu);
@@ -1183,15 +1191,65 @@ struct page **io_pin_pages(unsigned long ubuf, unsigned long len, int *npages)
 	return pages;
 }
 
+/*
+ * Check whether the pinned pages can be described by one bvec per folio.
+ * This is the case if every folio is large, of the same size, and fully
+ * covered by the buffer except for the first and last one. On success,
+ * ->folio_shift is set and *nr_head holds the number of pages used from
+ * the first folio.
+ */
+static bool io_buffer_can_coalesce(struct page **pages, int nr_pages,
+				   unsigned int *folio_shift, int *nr_head)
+{
+	struct folio *folio = page_folio(pages[0]);
+	long nr_mid = folio_nr_pages(folio);
+	int i, count = 1, nr_folios = 1;
+
+	if (nr_pages <= 1 || nr_mid == 1)
+		return false;
+
+	*folio_shift = folio_shift(folio);
+	*nr_head = 0;
+	for (i = 1; i < nr_pages; i++) {
+		if (page_folio(pages[i]) == folio &&
+		    pages[i] == pages[i - 1] + 1) {
+			count++;
+			continue;
+		}
+
+		if (nr_folios == 1) {
+			/* the first folio must be used up to its end */
+			if (folio_page_idx(folio, pages[i - 1]) != nr_mid - 1)
+				return false;
+			*nr_head = count;
+		} else if (count != nr_mid) {
+			return false;
+		}
+
+		folio = page_folio(pages[i]);
+		if (folio_shift(folio) != *folio_shift ||
+		    folio_page_idx(folio, pages[i]) != 0)
+			return false;
+		count = 1;
+		nr_folios++;
+	}
+
+	/* all in one folio, nothing but the head */
+	if (nr_folios == 1)
+		*nr_head = count;
+	return true;
+}
+
 static int io_sqe_buffer_register(struct io_ring_ctx *ctx, struct iovec *iov,
 				  struct io_mapped_ubuf **pimu,
 				  struct page **last_hpage)
 {
 	struct io_mapped_ubuf *imu = NULL;
 	struct page **pages = NULL;
+	unsigned int folio_shift;
 	unsigned long off;
 	size_t size;
-	int ret, nr_pages, i;
+	int ret, nr_pages, nr_bvecs, nr_head, i;
 
 	*pimu = ctx->dummy_ubuf;
 	if (!iov->iov_base)
@@ -1218,20 +1276,44 @@ static int io_sqe_buffer_register(struct io_ring_ctx *ctx, struct iovec *iov,
 
 	off = (unsigned long) iov->iov_base & ~PAGE_MASK;
 	size = iov->iov_len;
-	for (i = 0; i < nr_pages; i++) {
-		size_t vec_len;
-
-		vec_len = min_t(size_t, size, PAGE_SIZE - off);
-		imu->bvec[i].bv_page = pages[i];
-		imu->bvec[i].bv_len = vec_len;
-		imu->bvec[i].bv_offset = off;
-		off = 0;
-		size -= vec_len;
+	if (io_buffer_can_coalesce(pages, nr_pages, &folio_shift, &nr_head)) {
+		/*
+		 * One multi-page bvec per folio. The first one starts at the
+		 * first pinned page and runs to the end of its folio, all the
+		 * others start at a folio boundary.
+		 */
+		size_t seg = ((size_t)nr_head << PAGE_SHIFT) - off;
+
+		for (i = 0, nr_bvecs = 0; i < nr_pages; nr_bvecs++) {
+			size_t vec_len = min_t(size_t, size, seg);
+
+			imu->bvec[nr_bvecs].bv_page = pages[i];
+			imu->bvec[nr_bvecs].bv_len = vec_len;
+			imu->bvec[nr_bvecs].bv_offset = off;
+			i += DIV_ROUND_UP(off + vec_len, PAGE_SIZE);
+			size -= vec_len;
+			seg = 1UL << folio_shift;
+			off = 0;
+		}
+	} else {
+		folio_shift = PAGE_SHIFT;
+		for (i = 0; i < nr_pages; i++) {
+			size_t vec_len;
+
+			vec_len = min_t(size_t, size, PAGE_SIZE - off);
+			imu->bvec[i].bv_page = pages[i];
+			imu->bvec[i].bv_len = vec_len;
+			imu->bvec[i].bv_offset = off;
+			off = 0;
+			size -= vec_len;
+		}
+		nr_bvecs = nr_pages;
 	}
 	/* store original address for later verification */
 	imu->ubuf = (unsigned long) iov->iov_base;
 	imu->ubuf_end = imu->ubuf + iov->iov_len;
-	imu->nr_bvecs = nr_pages;
+	imu->nr_bvecs = nr_bvecs;
+	imu->folio_shift = folio_shift;
 	*pimu = imu;
 	ret = 0;
 done:
@@ -1336,7 +1418,8 @@ int io_import_fixed(int ddir, struct iov_iter *iter,
 		 * we know that:
 		 *
 		 * 1) it's a BVEC iter, we set it up
-		 * 2) all bvecs are PAGE_SIZE in size, except potentially the
+		 * 2) all bvecs are the same size (PAGE_SIZE, or the folio
+		 *    size for a coalesced buffer), except potentially the
 		 *    first and last bvec
 		 *
 		 * So just find our index, and adjust the iterator afterwards.
@@ -1354,12 +1437,12 @@ int io_import_fixed(int ddir, struct iov_iter *iter,
 
 			/* skip first vec */
 			offset -= bvec->bv_len;
-			seg_skip = 1 + (offset >> PAGE_SHIFT);
+			seg_skip = 1 + (offset >> imu->folio_shift);
 
 			iter->bvec = bvec + seg_skip;
 			iter->nr_segs -= seg_skip;
 			iter->count -= bvec->bv_len + offset;
-			iter->iov_offset = offset & ~PAGE_MASK;
+			iter->iov_offset = offset & ((1UL << imu->folio_shift) - 1);
 		}
 	}
 
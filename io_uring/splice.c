@@ -8,6 +8,8 @@
 #include <linux/namei.h>
 #include <linux/io_uring.h>
 #include <linux/splice.h>
+#include <linux/pipe_fs_i.h>
+#include <linux/net.h>
 
 #include <uapi/linux/io_uring.h>
 
@@ -37,6 +39,28 @@ static int __io_splice_prep(struct io_kiocb *req,
 	return 0;
 }
 
+/*
+ * Splice and tee normally go straight to io-wq, as the file side may
+ * block. If each end is either a pipe or a non-blocking socket, a
+ * SPLICE_F_NONBLOCK attempt can't sleep, so try that inline first and
+ * only punt if it returns -EAGAIN.
+ */
+static bool io_splice_file_nowait(struct file *file)
+{
+	if (get_pipe_info(file, true))
+		return true;
+#if defined(CONFIG_NET)
+	if (sock_from_file(file) && (file->f_flags & O_NONBLOCK))
+		return true;
+#endif
+	return false;
+}
+
+static bool io_splice_nowait(struct file *in, struct file *out)
+{
+	return io_splice_file_nowait(in) && io_splice_file_nowait(out);
+}
+
 int io_tee_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 {
 	if (READ_ONCE(sqe->splice_off_in) || READ_ONCE(sqe->off))
@@ -52,9 +76,6 @@ int io_tee(struct io_kiocb *req, unsigned int issue_flags)
 	struct file *in;
 	long ret = 0;
 
-	if (issue_flags & IO_URING_F_NONBLOCK)
-		return -EAGAIN;
-
 	if (sp->flags & SPLICE_F_FD_IN_FIXED)
 		in = io_file_get_fixed(req, sp->splice_fd_in, issue_flags);
 	else
@@ -64,8 +85,19 @@ int io_tee(struct io_kiocb *req, unsigned int issue_flags)
 		goto done;
 	}
 
-	if (sp->len)
+	if (issue_flags & IO_URING_F_NONBLOCK) {
+		if (!io_splice_nowait(in, out))
+			ret = -EAGAIN;
+		else if (sp->len)
+			ret = do_tee(in, out, sp->len, flags | SPLICE_F_NONBLOCK);
+		if (ret == -EAGAIN) {
+			if (!(sp->flags & SPLICE_F_FD_IN_FIXED))
+				io_put_file(in);
+			return -EAGAIN;
+		}
+	} else if (sp->len) {
 		ret = do_tee(in, out, sp->len, flags);
+	}
 
 	if (!(sp->flags & SPLICE_F_FD_IN_FIXED))
 		io_put_file(in);
@@ -94,9 +126,6 @@ int io_splice(struct io_kiocb *req, unsigned int issue_flags)
 	struct file *in;
 	long ret = 0;
 
-	if (issue_flags & IO_URING_F_NONBLOCK)
-		return -EAGAIN;
-
 	if (sp->flags & SPLICE_F_FD_IN_FIXED)
 		in = io_file_get_fixed(req, sp->splice_fd_in, issue_flags);
 	else
@@ -109,8 +138,20 @@ int io_splice(struct io_kiocb *req, unsigned int issue_flags)
 	poff_in = (sp->off_in == -1) ? NULL : &sp->off_in;
 	poff_out = (sp->off_out == -1) ? NULL : &sp->off_out;
 
-	if (sp->len)
+	if (issue_flags & IO_URING_F_NONBLOCK) {
+		if (!io_splice_nowait(in, out))
+			ret = -EAGAIN;
+		else if (sp->len)
+			ret = do_splice(in, poff_in, out, poff_out, sp->len,
+					flags | SPLICE_F_NONBLOCK);
+		if (ret == -EAGAIN) {
+			if (!(sp->flags & SPLICE_F_FD_IN_FIXED))
+				io_put_file(in);
+			return -EAGAIN;
+		}
+	} else if (sp->len) {
 		ret = do_splice(in, poff_in, out, poff_out, sp->len, flags);
+	}
 
 	if (!(sp->flags & SPLICE_F_FD_IN_FIXED))
 		io_put_file(in);
@@ -10,6 +10,7 @@
 #include <linux/slab.h>
 #include <linux/audit.h>
 #include <linux/security.h>
+#include <linux/sysctl.h>
 #include <linux/io_uring.h>
 
 #include <uapi/linux/io_uring.h>
@@ -18,6 +19,32 @@
 #include "sqpoll.h"
 
 #define IORING_SQPOLL_CAP_ENTRIES_VALUE 8
+#define IORING_SQPOLL_MAX_WEIGHT	4
+
+/* shorten the idle spin after a burst, see io_sqd_idle_window() */
+static int sysctl_io_uring_sqpoll_adaptive_idle __read_mostly;
+
+#ifdef CONFIG_SYSCTL
+static struct ctl_table io_sqpoll_sysctl_table[] = {
+	{
+		.procname	= "io_uring_sqpoll_adaptive_idle",
+		.data		= &sysctl_io_uring_sqpoll_adaptive_idle,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= SYSCTL_ONE,
+	},
+	{}
+};
+
+static __init int io_sqpoll_sysctl_init(void)
+{
+	register_sysctl_init("kernel", io_sqpoll_sysctl_table);
+	return 0;
+}
+__initcall(io_sqpoll_sysctl_init);
+#endif
 
 enum {
 	IO_SQ_THREAD_SHOULD_STOP = 0,
@@ -170,9 +197,16 @@ static int __io_sq_thread(struct io_ring_ctx *ctx, bool cap_entries)
 	int ret = 0;
 
 	to_submit = io_sqring_entries(ctx);
-	/* if we're handling multiple rings, cap submit size for fairness */
-	if (cap_entries && to_submit > IORING_SQPOLL_CAP_ENTRIES_VALUE)
-		to_submit = IORING_SQPOLL_CAP_ENTRIES_VALUE;
+	/*
+	 * If we're handling multiple rings, cap submit size for fairness.
+	 * Rings set up by higher priority tasks get a bigger share.
+	 */
+	if (cap_entries) {
+		unsigned int cap = IORING_SQPOLL_CAP_ENTRIES_VALUE * ctx->sq_weight;
+
+		if (to_submit > cap)
+			to_submit = cap;
+	}
 
 	if (!wq_list_empty(&ctx->iopoll_list) || to_submit) {
 		const struct cred *creds = NULL;
@@ -202,6 +236,41 @@ static int __io_sq_thread(struct io_ring_ctx *ctx, bool cap_entries)
 	return ret;
 }
 
+/*
+ * Track how far apart submitting passes are. A sample is capped at the
+ * configured idle time, anything longer means we went to sleep anyway.
+ */
+static void io_sqd_update_gap(struct io_sq_data *sqd)
+{
+	u64 now = ktime_get_ns();
+
+	if (sqd->last_submit_ns) {
+		u64 gap = min_t(u64, now - sqd->last_submit_ns,
+				jiffies_to_nsecs(sqd->sq_thread_idle));
+
+		sqd->avg_gap_ns -= sqd->avg_gap_ns >> 3;
+		sqd->avg_gap_ns += gap >> 3;
+	}
+	sqd->last_submit_ns = now;
+}
+
+/*
+ * How long to keep spinning after the last submission. If submissions have
+ * been arriving close together, spinning for the whole sq_thread_idle just
+ * burns the CPU once the burst is over. With the adaptive idle sysctl set,
+ * spin for twice the average gap instead. The configured idle time is
+ * always the upper bound, and is used unchanged by default.
+ */
+static unsigned long io_sqd_idle_window(struct io_sq_data *sqd)
+{
+	unsigned long idle;
+
+	if (!READ_ONCE(sysctl_io_uring_sqpoll_adaptive_idle) || !sqd->avg_gap_ns)
+		return sqd->sq_thread_idle;
+	idle = nsecs_to_jiffies(2 * sqd->avg_gap_ns) + 1;
+	return min_t(unsigned long, idle, sqd->sq_thread_idle);
+}
+
 static bool io_sqd_handle_event(struct io_sq_data *sqd)
 {
 	bool did_sig = false;
@@ -237,7 +306,7 @@ static int io_sq_thread(void *data)
 
 	mutex_lock(&sqd->lock);
 	while (1) {
-		bool cap_entries, sqt_spin = false;
+		bool cap_entries, sqt_spin = false, submitted = false;
 
 		if (io_sqd_events_pending(sqd) || signal_pending(current)) {
 			if (io_sqd_handle_event(sqd))
@@ -249,16 +318,23 @@ static int io_sq_thread(void *data)
 		list_for_each_entry(ctx, &sqd->ctx_list, sqd_list) {
 			int ret = __io_sq_thread(ctx, cap_entries);
 
+			if (ret > 0)
+				submitted = true;
 			if (!sqt_spin && (ret > 0 || !wq_list_empty(&ctx->iopoll_list)))
 				sqt_spin = true;
 		}
+		/* don't let the same ring always go first */
+		if (cap_entries)
+			list_rotate_left(&sqd->ctx_list);
+		if (submitted && READ_ONCE(sysctl_io_uring_sqpoll_adaptive_idle))
+			io_sqd_update_gap(sqd);
 		if (io_run_task_work())
 			sqt_spin = true;
 
 		if (sqt_spin || !time_after(jiffies, timeout)) {
 			cond_resched();
 			if (sqt_spin)
-				timeout = jiffies + sqd->sq_thread_idle;
+				timeout = jiffies + io_sqd_idle_window(sqd);
 			continue;
 		}
 
@@ -369,6 +445,11 @@ __cold int io_sq_offload_create(struct io_ring_ctx *ctx,
 		ctx->sq_thread_idle = msecs_to_jiffies(p->sq_thread_idle);
 		if (!ctx->sq_thread_idle)
 			ctx->sq_thread_idle = HZ;
+		/* one extra share per 5 nice levels below 0 */
+		ctx->sq_weight = 1;
+		if (task_nice(current) < 0)
+			ctx->sq_weight += min(-task_nice(current) / 5,
+					      IORING_SQPOLL_MAX_WEIGHT - 1);
 
 		io_sq_thread_park(sqd);
 		list_add(&ctx->sqd_list, &sqd->ctx_list);
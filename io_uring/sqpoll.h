@@ -12,6 +12,9 @@ struct io_sq_data {
 	struct wait_queue_head	wait;
 
 	unsigned		sq_thread_idle;
+	/* EWMA of the time between submitting passes, for adaptive idle */
+	u64			last_submit_ns;
+	u64			avg_gap_ns;
 	int			sq_cpu;
 	pid_t			task_pid;
 	pid_t			task_tgid;
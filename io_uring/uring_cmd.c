@@ -16,9 +16,74 @@ static void io_uring_cmd_work(struct io_kiocb *req, bool *locked)
 {
 	struct io_uring_cmd *ioucmd = io_kiocb_to_cmd(req, struct io_uring_cmd);
 
+	/* completing a cancelable command unlinks it under ->uring_lock */
+	if (ioucmd->flags & IORING_URING_CMD_CANCELABLE)
+		io_tw_lock(req->ctx, locked);
+
 	ioucmd->task_work_cb(ioucmd);
 }
 
+/*
+ * Mark a command as cancelable, before it is made visible to whatever will
+ * complete it and before ->uring_cmd() returns -EIOCBQUEUED for it. If the
+ * issue ends up returning anything else, the mark is dropped again. When its
+ * task exits or the ring goes away, ->uring_cmd() is called on it again with
+ * IO_URING_F_CANCEL set, and should complete it unless that is already
+ * underway. Cancelable commands must only be completed from the cancel call
+ * or from task work, see io_uring_cmd_complete_in_task().
+ */
+void io_uring_cmd_mark_cancelable(struct io_uring_cmd *cmd,
+				  unsigned int issue_flags)
+{
+	struct io_kiocb *req = cmd_to_io_kiocb(cmd);
+	struct io_ring_ctx *ctx = req->ctx;
+
+	if (cmd->flags & IORING_URING_CMD_CANCELABLE)
+		return;
+
+	io_ring_submit_lock(ctx, issue_flags);
+	cmd->flags |= IORING_URING_CMD_CANCELABLE;
+	hlist_add_head(&req->hash_node, &ctx->cancelable_uring_cmd);
+	io_ring_submit_unlock(ctx, issue_flags);
+}
+EXPORT_SYMBOL_GPL(io_uring_cmd_mark_cancelable);
+
+static void io_uring_cmd_del_cancelable(struct io_uring_cmd *cmd)
+{
+	struct io_kiocb *req = cmd_to_io_kiocb(cmd);
+
+	if (!(cmd->flags & IORING_URING_CMD_CANCELABLE))
+		return;
+
+	lockdep_assert_held(&req->ctx->uring_lock);
+	cmd->flags &= ~IORING_URING_CMD_CANCELABLE;
+	hlist_del(&req->hash_node);
+}
+
+bool io_uring_try_cancel_uring_cmd(struct io_ring_ctx *ctx,
+				   struct task_struct *task, bool cancel_all)
+{
+	struct hlist_node *tmp;
+	struct io_kiocb *req;
+	bool ret = false;
+
+	lockdep_assert_held(&ctx->uring_lock);
+
+	hlist_for_each_entry_safe(req, tmp, &ctx->cancelable_uring_cmd,
+				  hash_node) {
+		struct io_uring_cmd *cmd = io_kiocb_to_cmd(req,
+						struct io_uring_cmd);
+
+		if (!cancel_all && req->task != task)
+			continue;
+
+		req->file->f_op->uring_cmd(cmd, IO_URING_F_CANCEL);
+		ret = true;
+	}
+
+	return ret;
+}
+
 void io_uring_cmd_complete_in_task(struct io_uring_cmd *ioucmd,
 			void (*task_work_cb)(struct io_uring_cmd *))
 {
@@ -46,6 +111,9 @@ void io_uring_cmd_done(struct io_uring_cmd *ioucmd, ssize_t ret, ssize_t res2)
 {
 	struct io_kiocb *req = cmd_to_io_kiocb(ioucmd);
 
+	/* before ->hash_node gets reused for the CQE32 extras */
+	io_uring_cmd_del_cancelable(ioucmd);
+
 	if (ret < 0)
 		req_set_fail(req);
 
@@ -129,6 +197,13 @@ int io_uring_cmd(struct io_kiocb *req, unsigned int issue_flags)
 		ioucmd->cmd = req->async_data;
 
 	ret = file->f_op->uring_cmd(ioucmd, issue_flags);
+	/* marked cancelable, but completed or retried from the issue path */
+	if (ret != -EIOCBQUEUED &&
+	    (ioucmd->flags & IORING_URING_CMD_CANCELABLE)) {
+		io_ring_submit_lock(ctx, issue_flags);
+		io_uring_cmd_del_cancelable(ioucmd);
+		io_ring_submit_unlock(ctx, issue_flags);
+	}
 	if (ret == -EAGAIN) {
 		if (!req_has_async_data(req)) {
 			if (io_alloc_async_data(req))
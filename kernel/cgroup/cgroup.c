@@ -2024,6 +2024,7 @@ void init_cgroup_root(struct cgroup_fs_context *ctx)
 
 	INIT_LIST_HEAD(&root->root_list);
 	atomic_set(&root->nr_cgrps, 1);
+	spin_lock_init(&root->rstat_lock);
 	cgrp->root = root;
 	init_cgroup_housekeeping(cgrp);
 
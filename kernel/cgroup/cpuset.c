@@ -1121,6 +1121,72 @@ partition_and_rebuild_sched_domains(int ndoms_new, cpumask_var_t doms_new[],
 	mutex_unlock(&sched_domains_mutex);
 }
 
+/*
+ * Sched domain rebuilds can be deferred by writing 1 to the root's
+ * defer_sched_domains file, so that a batch of cpuset updates costs a single
+ * rebuild when 0 is written back.  A deferral which is not ended within
+ * CPUSET_DEFER_TIMEOUT is ended by cpuset_defer_workfn(), and CPU hotplug
+ * always ends it, as the domains must not keep offline CPUs.
+ *
+ * Both flags are protected by cpuset_rwsem.
+ */
+static bool sched_domains_deferred;
+static bool sched_domains_dirty;
+
+#define CPUSET_DEFER_TIMEOUT	HZ
+
+static void cpuset_defer_workfn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(cpuset_defer_work, cpuset_defer_workfn);
+
+static void rebuild_sched_domains_locked(void);
+
+static bool cpuset_sched_domains_deferred(void)
+{
+	return sched_domains_deferred;
+}
+
+/* End a deferral without rebuilding, returns whether a rebuild is due */
+static bool cpuset_end_defer(void)
+{
+	bool dirty = sched_domains_dirty;
+
+	if (!sched_domains_deferred)
+		return false;
+
+	sched_domains_deferred = false;
+	sched_domains_dirty = false;
+	cancel_delayed_work(&cpuset_defer_work);
+	return dirty;
+}
+
+static void cpuset_defer_sched_domains(bool defer)
+{
+	lockdep_assert_cpus_held();
+	percpu_rwsem_assert_held(&cpuset_rwsem);
+
+	if (!defer) {
+		if (cpuset_end_defer())
+			rebuild_sched_domains_locked();
+		return;
+	}
+
+	if (!sched_domains_deferred)
+		mod_delayed_work(system_wq, &cpuset_defer_work,
+				 CPUSET_DEFER_TIMEOUT);
+	sched_domains_deferred = true;
+}
+
+static void cpuset_defer_workfn(struct work_struct *work)
+{
+	cpus_read_lock();
+	percpu_down_write(&cpuset_rwsem);
+	if (sched_domains_deferred)
+		pr_warn_ratelimited("cpuset: sched domain rebuild deferred for too long, rebuilding\n");
+	cpuset_defer_sched_domains(false);
+	percpu_up_write(&cpuset_rwsem);
+	cpus_read_unlock();
+}
+
 /*
  * Rebuild scheduler domains.
  *
@@ -1143,6 +1209,11 @@ static void rebuild_sched_domains_locked(void)
 	lockdep_assert_cpus_held();
 	percpu_rwsem_assert_held(&cpuset_rwsem);
 
+	if (sched_domains_deferred) {
+		sched_domains_dirty = true;
+		return;
+	}
+
 	/*
 	 * If we have raced with CPU hotplug, return early to avoid
 	 * passing doms with offlined cpu to partition_sched_domains().
@@ -1187,12 +1258,28 @@ static void rebuild_sched_domains_locked(void)
 static void rebuild_sched_domains_locked(void)
 {
 }
+
+static bool cpuset_sched_domains_deferred(void)
+{
+	return false;
+}
+
+static bool cpuset_end_defer(void)
+{
+	return false;
+}
+
+static void cpuset_defer_sched_domains(bool defer)
+{
+}
 #endif /* CONFIG_SMP */
 
 void rebuild_sched_domains(void)
 {
 	cpus_read_lock();
 	percpu_down_write(&cpuset_rwsem);
+	/* hotplug and the scheduler need their rebuild now, not on commit */
+	cpuset_end_defer();
 	rebuild_sched_domains_locked();
 	percpu_up_write(&cpuset_rwsem);
 	cpus_read_unlock();
@@ -2588,6 +2675,7 @@ typedef enum {
 	FILE_MEMORY_PRESSURE,
 	FILE_SPREAD_PAGE,
 	FILE_SPREAD_SLAB,
+	FILE_DEFER_SCHED_DOMAINS,
 } cpuset_filetype_t;
 
 static int cpuset_write_u64(struct cgroup_subsys_state *css, struct cftype *cft,
@@ -2629,6 +2717,9 @@ static int cpuset_write_u64(struct cgroup_subsys_state *css, struct cftype *cft,
 	case FILE_SPREAD_SLAB:
 		retval = update_flag(CS_SPREAD_SLAB, cs, val);
 		break;
+	case FILE_DEFER_SCHED_DOMAINS:
+		cpuset_defer_sched_domains(!!val);
+		break;
 	default:
 		retval = -EINVAL;
 		break;
@@ -2796,6 +2887,8 @@ static u64 cpuset_read_u64(struct cgroup_subsys_state *css, struct cftype *cft)
 		return is_spread_page(cs);
 	case FILE_SPREAD_SLAB:
 		return is_spread_slab(cs);
+	case FILE_DEFER_SCHED_DOMAINS:
+		return cpuset_sched_domains_deferred();
 	default:
 		BUG();
 	}
@@ -2988,6 +3081,14 @@ static struct cftype legacy_files[] = {
 		.private = FILE_MEMORY_PRESSURE_ENABLED,
 	},
 
+	{
+		.name = "defer_sched_domains",
+		.flags = CFTYPE_ONLY_ON_ROOT,
+		.read_u64 = cpuset_read_u64,
+		.write_u64 = cpuset_write_u64,
+		.private = FILE_DEFER_SCHED_DOMAINS,
+	},
+
 	{ }	/* terminate */
 };
 
@@ -3042,6 +3143,14 @@ static struct cftype dfl_files[] = {
 		.flags = CFTYPE_DEBUG,
 	},
 
+	{
+		.name = "defer_sched_domains",
+		.read_u64 = cpuset_read_u64,
+		.write_u64 = cpuset_write_u64,
+		.private = FILE_DEFER_SCHED_DOMAINS,
+		.flags = CFTYPE_ONLY_ON_ROOT,
+	},
+
 	{ }	/* terminate */
 };
 
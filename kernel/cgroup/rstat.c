@@ -7,7 +7,6 @@
 #include <linux/btf.h>
 #include <linux/btf_ids.h>
 
-static DEFINE_SPINLOCK(cgroup_rstat_lock);
 static DEFINE_PER_CPU(raw_spinlock_t, cgroup_rstat_cpu_lock);
 
 static void cgroup_base_stat_flush(struct cgroup *cgrp, int cpu);
@@ -170,13 +169,48 @@ __weak noinline void bpf_rstat_flush(struct cgroup *cgrp,
 
 __diag_pop();
 
+/*
+ * Flushes are serialized per hierarchy by cgroup_root->rstat_lock.  A
+ * flusher that had to wait for the lock can skip its own walk if a flush
+ * of @cgrp or of one of its ancestors has been started and completed in
+ * the meantime, since that one already collected all updates which
+ * happened before the flusher came along.
+ *
+ * @seq is the hierarchy's flush sequence number sampled before taking the
+ * lock.  The smp_mb() pairs with the one in cgroup_rstat_flush_locked(),
+ * so that either a flush started after the sample sees the updates the
+ * caller made before it, or the sample sees that flush's sequence number.
+ */
+static u64 cgroup_rstat_flush_seq(struct cgroup *cgrp)
+{
+	smp_mb();
+	return READ_ONCE(cgrp->root->rstat_flush_seq);
+}
+
+static bool cgroup_rstat_flush_covered(struct cgroup *cgrp, u64 seq)
+{
+	for (; cgrp; cgrp = cgroup_parent(cgrp))
+		if (cgrp->rstat_flush_done > seq)
+			return true;
+	return false;
+}
+
 /* see cgroup_rstat_flush() */
-static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
-	__releases(&cgroup_rstat_lock) __acquires(&cgroup_rstat_lock)
+static void cgroup_rstat_flush_locked(struct cgroup *cgrp, u64 seq,
+				      bool may_sleep)
+	__releases(&cgrp->root->rstat_lock) __acquires(&cgrp->root->rstat_lock)
 {
+	spinlock_t *lock = &cgrp->root->rstat_lock;
 	int cpu;
 
-	lockdep_assert_held(&cgroup_rstat_lock);
+	lockdep_assert_held(lock);
+
+	if (cgroup_rstat_flush_covered(cgrp, seq))
+		return;
+
+	seq = ++cgrp->root->rstat_flush_seq;
+	/* pairs with smp_mb() in cgroup_rstat_flush_seq() */
+	smp_mb();
 
 	for_each_possible_cpu(cpu) {
 		raw_spinlock_t *cpu_lock = per_cpu_ptr(&cgroup_rstat_cpu_lock,
@@ -185,7 +219,7 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 		unsigned long flags;
 
 		/*
-		 * The _irqsave() is needed because cgroup_rstat_lock is
+		 * The _irqsave() is needed because the rstat_lock is
 		 * spinlock_t which is a sleeping lock on PREEMPT_RT. Acquiring
 		 * this lock with the _irq() suffix only disables interrupts on
 		 * a non-PREEMPT_RT kernel. The raw_spinlock_t below disables
@@ -208,14 +242,15 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 		raw_spin_unlock_irqrestore(cpu_lock, flags);
 
 		/* if @may_sleep, play nice and yield if necessary */
-		if (may_sleep && (need_resched() ||
-				  spin_needbreak(&cgroup_rstat_lock))) {
-			spin_unlock_irq(&cgroup_rstat_lock);
+		if (may_sleep && (need_resched() || spin_needbreak(lock))) {
+			spin_unlock_irq(lock);
 			if (!cond_resched())
 				cpu_relax();
-			spin_lock_irq(&cgroup_rstat_lock);
+			spin_lock_irq(lock);
 		}
 	}
+
+	cgrp->rstat_flush_done = seq;
 }
 
 /**
@@ -229,15 +264,20 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
  * This also gets all cgroups in the subtree including @cgrp off the
  * ->updated_children lists.
  *
+ * Flushes in different hierarchies don't contend with each other, and a
+ * flush which waited for a concurrent flush covering @cgrp is skipped.
+ *
  * This function may block.
  */
 void cgroup_rstat_flush(struct cgroup *cgrp)
 {
+	u64 seq = cgroup_rstat_flush_seq(cgrp);
+
 	might_sleep();
 
-	spin_lock_irq(&cgroup_rstat_lock);
-	cgroup_rstat_flush_locked(cgrp, true);
-	spin_unlock_irq(&cgroup_rstat_lock);
+	spin_lock_irq(&cgrp->root->rstat_lock);
+	cgroup_rstat_flush_locked(cgrp, seq, true);
+	spin_unlock_irq(&cgrp->root->rstat_lock);
 }
 
 /**
@@ -248,11 +288,12 @@ void cgroup_rstat_flush(struct cgroup *cgrp)
  */
 void cgroup_rstat_flush_irqsafe(struct cgroup *cgrp)
 {
+	u64 seq = cgroup_rstat_flush_seq(cgrp);
 	unsigned long flags;
 
-	spin_lock_irqsave(&cgroup_rstat_lock, flags);
-	cgroup_rstat_flush_locked(cgrp, false);
-	spin_unlock_irqrestore(&cgroup_rstat_lock, flags);
+	spin_lock_irqsave(&cgrp->root->rstat_lock, flags);
+	cgroup_rstat_flush_locked(cgrp, seq, false);
+	spin_unlock_irqrestore(&cgrp->root->rstat_lock, flags);
 }
 
 /**
@@ -265,20 +306,23 @@ void cgroup_rstat_flush_irqsafe(struct cgroup *cgrp)
  * This function may block.
  */
 void cgroup_rstat_flush_hold(struct cgroup *cgrp)
-	__acquires(&cgroup_rstat_lock)
+	__acquires(&cgrp->root->rstat_lock)
 {
+	u64 seq = cgroup_rstat_flush_seq(cgrp);
+
 	might_sleep();
-	spin_lock_irq(&cgroup_rstat_lock);
-	cgroup_rstat_flush_locked(cgrp, true);
+	spin_lock_irq(&cgrp->root->rstat_lock);
+	cgroup_rstat_flush_locked(cgrp, seq, true);
 }
 
 /**
  * cgroup_rstat_flush_release - release cgroup_rstat_flush_hold()
+ * @cgrp: target cgroup passed to cgroup_rstat_flush_hold()
  */
-void cgroup_rstat_flush_release(void)
-	__releases(&cgroup_rstat_lock)
+void cgroup_rstat_flush_release(struct cgroup *cgrp)
+	__releases(&cgrp->root->rstat_lock)
 {
-	spin_unlock_irq(&cgroup_rstat_lock);
+	spin_unlock_irq(&cgrp->root->rstat_lock);
 }
 
 int cgroup_rstat_init(struct cgroup *cgrp)
@@ -504,7 +548,7 @@ void cgroup_base_stat_cputime_show(struct seq_file *seq)
 #ifdef CONFIG_SCHED_CORE
 		forceidle_time = cgrp->bstat.forceidle_sum;
 #endif
-		cgroup_rstat_flush_release();
+		cgroup_rstat_flush_release(cgrp);
 	} else {
 		root_cgroup_cputime(&bstat);
 		usage = bstat.cputime.sum_exec_runtime;
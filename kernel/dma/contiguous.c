@@ -50,6 +50,9 @@
 #include <linux/sizes.h>
 #include <linux/dma-map-ops.h>
 #include <linux/cma.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 
 #ifdef CONFIG_CMA_SIZE_MBYTES
 #define CMA_SIZE_MBYTES CONFIG_CMA_SIZE_MBYTES
@@ -279,13 +282,203 @@ bool dma_release_from_contiguous(struct device *dev, struct page *pages,
 	return cma_release(dev_get_cma_area(dev), pages, count);
 }
 
+/*
+ * Blocks allocated ahead of use by dma_contiguous_prefill(). Allocating
+ * from CMA migrates the movable pages out of the range in the caller's
+ * context, which can take long for large buffers; a prefilled block of the
+ * right size is handed out without that wait.
+ *
+ * A block is on the list from the time its allocation is queued until it is
+ * claimed by an allocation or by dma_contiguous_drain(). Whoever claims it
+ * waits for its work item and frees it.
+ */
+struct dma_contiguous_block {
+	struct list_head list;
+	struct work_struct work;
+	struct device *dev;
+	struct cma *cma;
+	struct page *page;
+	size_t size;
+	bool claimed;
+};
+
+static LIST_HEAD(dma_contiguous_blocks);
+static DEFINE_SPINLOCK(dma_contiguous_blocks_lock);
+
+static struct page *dma_contiguous_take_block(struct cma *cma, size_t size)
+{
+	struct dma_contiguous_block *block, *found = NULL;
+	struct page *page;
+
+	if (list_empty_careful(&dma_contiguous_blocks))
+		return NULL;
+
+	spin_lock(&dma_contiguous_blocks_lock);
+	list_for_each_entry(block, &dma_contiguous_blocks, list) {
+		if (block->cma == cma && block->size == size) {
+			list_del(&block->list);
+			block->claimed = true;
+			found = block;
+			break;
+		}
+	}
+	spin_unlock(&dma_contiguous_blocks_lock);
+
+	if (!found)
+		return NULL;
+
+	/* an allocation already in flight is done sooner than a new one */
+	flush_work(&found->work);
+	page = found->page;
+	kfree(found);
+
+	return page;
+}
+
 static struct page *cma_alloc_aligned(struct cma *cma, size_t size, gfp_t gfp)
 {
 	unsigned int align = min(get_order(size), CONFIG_CMA_ALIGNMENT);
+	struct page *page;
+
+	page = dma_contiguous_take_block(cma, size);
+	if (page)
+		return page;
 
 	return cma_alloc(cma, size >> PAGE_SHIFT, align, gfp & __GFP_NOWARN);
 }
 
+static void dma_contiguous_prefill_fn(struct work_struct *work)
+{
+	struct dma_contiguous_block *block =
+		container_of(work, struct dma_contiguous_block, work);
+	struct page *page;
+
+	/* not cma_alloc_aligned(), which would take a prefilled block */
+	page = cma_alloc(block->cma, block->size >> PAGE_SHIFT,
+			 min(get_order(block->size), CONFIG_CMA_ALIGNMENT),
+			 true);
+	if (!page)
+		pr_debug("prefill of %zu bytes failed\n", block->size);
+
+	spin_lock(&dma_contiguous_blocks_lock);
+	block->page = page;
+	/* a failed block nobody waits for is of no use */
+	if (!page && !block->claimed) {
+		list_del(&block->list);
+		kfree(block);
+	}
+	spin_unlock(&dma_contiguous_blocks_lock);
+}
+
+/*
+ * The area dma_alloc_contiguous() tries first for an allocation of @size
+ * bytes with @gfp, or NULL if it doesn't use CMA for it.
+ */
+static struct cma *dma_contiguous_area(struct device *dev, size_t size,
+				       gfp_t gfp)
+{
+#ifdef CONFIG_DMA_PERNUMA_CMA
+	int nid = dev_to_node(dev);
+#endif
+
+	if (dev->cma_area)
+		return dev->cma_area;
+	if (size <= PAGE_SIZE)
+		return NULL;
+
+#ifdef CONFIG_DMA_PERNUMA_CMA
+	if (nid != NUMA_NO_NODE && !(gfp & (GFP_DMA | GFP_DMA32)) &&
+	    dma_contiguous_pernuma_area[nid])
+		return dma_contiguous_pernuma_area[nid];
+#endif
+	return dma_contiguous_default_area;
+}
+
+/**
+ * dma_contiguous_prefill() - allocate contiguous blocks ahead of use
+ * @dev:   Pointer to device which will allocate the blocks.
+ * @size:  Size of each block, as it will be allocated.
+ * @count: Number of blocks to allocate.
+ * @gfp:   Allocation flags the blocks will be allocated with.
+ *
+ * Queues the allocation of @count blocks of @size bytes from the CMA area
+ * that dma_alloc_contiguous() picks for @dev and @gfp, and returns without
+ * waiting for them. Each block is allocated by its own work item on the
+ * unbound workqueue, so that the page migration for several blocks runs on
+ * several CPUs at once. Later CMA allocations of the same size from that
+ * area take these blocks, waiting for one still in flight, instead of
+ * migrating pages themselves.
+ *
+ * Blocks which end up unused must be returned with dma_contiguous_drain().
+ *
+ * Returns the number of allocations queued.
+ */
+unsigned int dma_contiguous_prefill(struct device *dev, size_t size,
+				    unsigned int count, gfp_t gfp)
+{
+	struct dma_contiguous_block *block;
+	struct cma *cma;
+	unsigned int i;
+
+	size = PAGE_ALIGN(size);
+	cma = dma_contiguous_area(dev, size, gfp);
+	if (!cma)
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		block = kzalloc(sizeof(*block), GFP_KERNEL);
+		if (!block)
+			break;
+		INIT_WORK(&block->work, dma_contiguous_prefill_fn);
+		block->dev = dev;
+		block->cma = cma;
+		block->size = size;
+
+		spin_lock(&dma_contiguous_blocks_lock);
+		list_add_tail(&block->list, &dma_contiguous_blocks);
+		spin_unlock(&dma_contiguous_blocks_lock);
+
+		queue_work(system_unbound_wq, &block->work);
+	}
+
+	return i;
+}
+EXPORT_SYMBOL_GPL(dma_contiguous_prefill);
+
+/**
+ * dma_contiguous_drain() - release unused prefilled blocks
+ * @dev:   Pointer to device the blocks were prefilled for.
+ * @size:  Size of the blocks, as passed to dma_contiguous_prefill().
+ *
+ * Allocations still queued by dma_contiguous_prefill() are cancelled, or
+ * waited for if they already run, so no block is left behind for @dev.
+ */
+void dma_contiguous_drain(struct device *dev, size_t size)
+{
+	struct dma_contiguous_block *block, *tmp;
+	LIST_HEAD(drain);
+
+	size = PAGE_ALIGN(size);
+
+	spin_lock(&dma_contiguous_blocks_lock);
+	list_for_each_entry_safe(block, tmp, &dma_contiguous_blocks, list) {
+		if (block->dev == dev && block->size == size) {
+			block->claimed = true;
+			list_move(&block->list, &drain);
+		}
+	}
+	spin_unlock(&dma_contiguous_blocks_lock);
+
+	list_for_each_entry_safe(block, tmp, &drain, list) {
+		cancel_work_sync(&block->work);
+		if (block->page)
+			cma_release(block->cma, block->page,
+				    size >> PAGE_SHIFT);
+		kfree(block);
+	}
+}
+EXPORT_SYMBOL_GPL(dma_contiguous_drain);
+
 /**
  * dma_alloc_contiguous() - allocate contiguous pages
  * @dev:   Pointer to device for which the allocation is performed.
@@ -303,30 +496,22 @@ static struct page *cma_alloc_aligned(struct cma *cma, size_t size, gfp_t gfp)
  */
 struct page *dma_alloc_contiguous(struct device *dev, size_t size, gfp_t gfp)
 {
-#ifdef CONFIG_DMA_PERNUMA_CMA
-	int nid = dev_to_node(dev);
-#endif
+	struct cma *cma;
+	struct page *page;
 
 	/* CMA can be used only in the context which permits sleeping */
 	if (!gfpflags_allow_blocking(gfp))
 		return NULL;
-	if (dev->cma_area)
-		return cma_alloc_aligned(dev->cma_area, size, gfp);
-	if (size <= PAGE_SIZE)
+
+	cma = dma_contiguous_area(dev, size, gfp);
+	if (!cma)
 		return NULL;
 
-#ifdef CONFIG_DMA_PERNUMA_CMA
-	if (nid != NUMA_NO_NODE && !(gfp & (GFP_DMA | GFP_DMA32))) {
-		struct cma *cma = dma_contiguous_pernuma_area[nid];
-		struct page *page;
-
-		if (cma) {
-			page = cma_alloc_aligned(cma, size, gfp);
-			if (page)
-				return page;
-		}
-	}
-#endif
+	page = cma_alloc_aligned(cma, size, gfp);
+	if (page || cma == dev->cma_area || cma == dma_contiguous_default_area)
+		return page;
+
+	/* the per-numa area is exhausted, fall back to the global one */
 	if (!dma_contiguous_default_area)
 		return NULL;
 
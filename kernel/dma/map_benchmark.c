@@ -16,6 +16,7 @@
 #include <linux/module.h>
 #include <linux/pci.h>
 #include <linux/platform_device.h>
+#include <linux/scatterlist.h>
 #include <linux/slab.h>
 #include <linux/timekeeping.h>
 
@@ -26,28 +27,119 @@ struct map_benchmark_data {
 	enum dma_data_direction dir;
 	atomic64_t sum_map_100ns;
 	atomic64_t sum_unmap_100ns;
+	atomic64_t sum_sync_100ns;
 	atomic64_t sum_sq_map;
 	atomic64_t sum_sq_unmap;
+	atomic64_t sum_sq_sync;
 	atomic64_t loops;
 };
 
-static int map_benchmark_thread(void *data)
-{
+struct map_benchmark_buf {
 	void *buf;
+	u64 size;
+	unsigned int nents;
+	struct sg_table sgt;
 	dma_addr_t dma_addr;
+};
+
+static void map_benchmark_account(ktime_t delta, atomic64_t *sum,
+				  atomic64_t *sum_sq)
+{
+	u64 delta_100ns = div64_ul(delta, 100);
+
+	atomic64_add(delta_100ns, sum);
+	atomic64_add(delta_100ns * delta_100ns, sum_sq);
+}
+
+static int map_benchmark_map(struct map_benchmark_data *map,
+			     struct map_benchmark_buf *b, unsigned long attrs)
+{
+	int ret;
+
+	if (b->nents) {
+		ret = dma_map_sgtable(map->dev, &b->sgt, map->dir, attrs);
+		if (unlikely(ret))
+			pr_err("dma_map_sgtable failed on %s\n",
+				dev_name(map->dev));
+		return ret;
+	}
+
+	b->dma_addr = dma_map_single_attrs(map->dev, b->buf, b->size,
+					   map->dir, attrs);
+	if (unlikely(dma_mapping_error(map->dev, b->dma_addr))) {
+		pr_err("dma_map_single failed on %s\n", dev_name(map->dev));
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void map_benchmark_unmap(struct map_benchmark_data *map,
+				struct map_benchmark_buf *b,
+				unsigned long attrs)
+{
+	if (b->nents)
+		dma_unmap_sgtable(map->dev, &b->sgt, map->dir, attrs);
+	else
+		dma_unmap_single_attrs(map->dev, b->dma_addr, b->size,
+				       map->dir, attrs);
+}
+
+static void map_benchmark_sync(struct map_benchmark_data *map,
+			       struct map_benchmark_buf *b, bool for_device)
+{
+	if (b->nents) {
+		if (for_device)
+			dma_sync_sgtable_for_device(map->dev, &b->sgt,
+						    map->dir);
+		else
+			dma_sync_sgtable_for_cpu(map->dev, &b->sgt, map->dir);
+	} else {
+		if (for_device)
+			dma_sync_single_for_device(map->dev, b->dma_addr,
+						   b->size, map->dir);
+		else
+			dma_sync_single_for_cpu(map->dev, b->dma_addr,
+						b->size, map->dir);
+	}
+}
+
+static int map_benchmark_thread(void *data)
+{
 	struct map_benchmark_data *map = data;
-	int npages = map->bparam.granule;
-	u64 size = npages * PAGE_SIZE;
+	bool split_sync = map->bparam.flags & DMA_MAP_F_SPLIT_SYNC;
+	unsigned long attrs = split_sync ? DMA_ATTR_SKIP_CPU_SYNC : 0;
+	struct map_benchmark_buf b = {
+		.size = map->bparam.granule * PAGE_SIZE,
+		.nents = map->bparam.sg_nents,
+	};
+	u64 total = b.size * max(b.nents, 1U);
+	struct scatterlist *sg;
 	int ret = 0;
+	int i;
 
-	buf = alloc_pages_exact(size, GFP_KERNEL);
-	if (!buf)
+	b.buf = alloc_pages_exact(total, GFP_KERNEL);
+	if (!b.buf)
 		return -ENOMEM;
 
+	/*
+	 * In scatterlist mode every granule is a separate entry, so that the
+	 * cost of mapping and unmapping nents buffers at once can be compared
+	 * against nents calls of the single mapping mode.
+	 */
+	if (b.nents) {
+		ret = sg_alloc_table(&b.sgt, b.nents, GFP_KERNEL);
+		if (ret) {
+			free_pages_exact(b.buf, total);
+			return ret;
+		}
+		for_each_sgtable_sg(&b.sgt, sg, i)
+			sg_set_buf(sg, b.buf + i * b.size, b.size);
+	}
+
 	while (!kthread_should_stop())  {
-		u64 map_100ns, unmap_100ns, map_sq, unmap_sq;
 		ktime_t map_stime, map_etime, unmap_stime, unmap_etime;
-		ktime_t map_delta, unmap_delta;
+		ktime_t sync_delta = 0;
 
 		/*
 		 * for a non-coherent device, if we don't stain them in the
@@ -56,43 +148,56 @@ static int map_benchmark_thread(void *data)
 		 * 66 means evertything goes well! 66 is lucky.
 		 */
 		if (map->dir != DMA_FROM_DEVICE)
-			memset(buf, 0x66, size);
+			memset(b.buf, 0x66, total);
 
 		map_stime = ktime_get();
-		dma_addr = dma_map_single(map->dev, buf, size, map->dir);
-		if (unlikely(dma_mapping_error(map->dev, dma_addr))) {
-			pr_err("dma_map_single failed on %s\n",
-				dev_name(map->dev));
-			ret = -ENOMEM;
+		ret = map_benchmark_map(map, &b, attrs);
+		if (ret)
 			goto out;
-		}
 		map_etime = ktime_get();
-		map_delta = ktime_sub(map_etime, map_stime);
+
+		/*
+		 * With DMA_MAP_F_SPLIT_SYNC the cache maintenance and bounce
+		 * buffering is timed on its own, leaving the map and unmap
+		 * latency to the IOVA allocation, page table updates and IOTLB
+		 * invalidation.
+		 */
+		if (split_sync) {
+			map_benchmark_sync(map, &b, true);
+			sync_delta = ktime_sub(ktime_get(), map_etime);
+		}
 
 		/* Pretend DMA is transmitting */
 		ndelay(map->bparam.dma_trans_ns);
 
+		if (split_sync) {
+			ktime_t sync_stime = ktime_get();
+
+			map_benchmark_sync(map, &b, false);
+			sync_delta = ktime_add(sync_delta,
+					       ktime_sub(ktime_get(), sync_stime));
+		}
+
 		unmap_stime = ktime_get();
-		dma_unmap_single(map->dev, dma_addr, size, map->dir);
+		map_benchmark_unmap(map, &b, attrs);
 		unmap_etime = ktime_get();
-		unmap_delta = ktime_sub(unmap_etime, unmap_stime);
 
 		/* calculate sum and sum of squares */
-
-		map_100ns = div64_ul(map_delta,  100);
-		unmap_100ns = div64_ul(unmap_delta, 100);
-		map_sq = map_100ns * map_100ns;
-		unmap_sq = unmap_100ns * unmap_100ns;
-
-		atomic64_add(map_100ns, &map->sum_map_100ns);
-		atomic64_add(unmap_100ns, &map->sum_unmap_100ns);
-		atomic64_add(map_sq, &map->sum_sq_map);
-		atomic64_add(unmap_sq, &map->sum_sq_unmap);
+		map_benchmark_account(ktime_sub(map_etime, map_stime),
+				      &map->sum_map_100ns, &map->sum_sq_map);
+		map_benchmark_account(ktime_sub(unmap_etime, unmap_stime),
+				      &map->sum_unmap_100ns,
+				      &map->sum_sq_unmap);
+		if (split_sync)
+			map_benchmark_account(sync_delta, &map->sum_sync_100ns,
+					      &map->sum_sq_sync);
 		atomic64_inc(&map->loops);
 	}
 
 out:
-	free_pages_exact(buf, size);
+	if (b.nents)
+		sg_free_table(&b.sgt);
+	free_pages_exact(b.buf, total);
 	return ret;
 }
 
@@ -100,8 +205,8 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 {
 	struct task_struct **tsk;
 	int threads = map->bparam.threads;
-	int node = map->bparam.node;
-	const cpumask_t *cpu_mask = cpumask_of_node(node);
+	bool spread = map->bparam.flags & DMA_MAP_F_NODE_SPREAD;
+	int node = spread ? first_node(node_states[N_CPU]) : map->bparam.node;
 	u64 loops;
 	int ret = 0;
 	int i;
@@ -114,7 +219,7 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 
 	for (i = 0; i < threads; i++) {
 		tsk[i] = kthread_create_on_node(map_benchmark_thread, map,
-				map->bparam.node, "dma-map-benchmark/%d", i);
+				node, "dma-map-benchmark/%d", i);
 		if (IS_ERR(tsk[i])) {
 			pr_err("create dma_map thread failed\n");
 			ret = PTR_ERR(tsk[i]);
@@ -122,14 +227,26 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 		}
 
 		if (node != NUMA_NO_NODE)
-			kthread_bind_mask(tsk[i], cpu_mask);
+			kthread_bind_mask(tsk[i], cpumask_of_node(node));
+
+		/*
+		 * hand out the nodes with CPUs to the threads round-robin,
+		 * a memory-only node would leave the thread nowhere to run
+		 */
+		if (spread) {
+			node = next_node(node, node_states[N_CPU]);
+			if (node >= MAX_NUMNODES)
+				node = first_node(node_states[N_CPU]);
+		}
 	}
 
 	/* clear the old value in the previous benchmark */
 	atomic64_set(&map->sum_map_100ns, 0);
 	atomic64_set(&map->sum_unmap_100ns, 0);
+	atomic64_set(&map->sum_sync_100ns, 0);
 	atomic64_set(&map->sum_sq_map, 0);
 	atomic64_set(&map->sum_sq_unmap, 0);
+	atomic64_set(&map->sum_sq_sync, 0);
 	atomic64_set(&map->loops, 0);
 
 	for (i = 0; i < threads; i++) {
@@ -167,6 +284,18 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 				map->bparam.avg_unmap_100ns;
 		map->bparam.map_stddev = int_sqrt64(map_variance);
 		map->bparam.unmap_stddev = int_sqrt64(unmap_variance);
+
+		if (map->bparam.flags & DMA_MAP_F_SPLIT_SYNC) {
+			u64 sum_sync = atomic64_read(&map->sum_sync_100ns);
+			u64 sum_sq_sync = atomic64_read(&map->sum_sq_sync);
+			u64 sync_variance;
+
+			map->bparam.avg_sync_100ns = div64_u64(sum_sync, loops);
+			sync_variance = div64_u64(sum_sq_sync, loops) -
+					map->bparam.avg_sync_100ns *
+					map->bparam.avg_sync_100ns;
+			map->bparam.sync_stddev = int_sqrt64(sync_variance);
+		}
 	}
 
 out:
@@ -182,14 +311,21 @@ static long map_benchmark_ioctl(struct file *file, unsigned int cmd,
 {
 	struct map_benchmark_data *map = file->private_data;
 	void __user *argp = (void __user *)arg;
+	size_t size = _IOC_SIZE(cmd);
 	u64 old_dma_mask;
 	int ret;
 
-	if (copy_from_user(&map->bparam, argp, sizeof(map->bparam)))
+	if (cmd != DMA_MAP_BENCHMARK && cmd != DMA_MAP_BENCHMARK_V1)
+		return -EINVAL;
+
+	/* fields an old binary doesn't know about read as zero */
+	memset(&map->bparam, 0, sizeof(map->bparam));
+	if (copy_from_user(&map->bparam, argp, size))
 		return -EFAULT;
 
 	switch (cmd) {
 	case DMA_MAP_BENCHMARK:
+	case DMA_MAP_BENCHMARK_V1:
 		if (map->bparam.threads == 0 ||
 		    map->bparam.threads > DMA_MAP_MAX_THREADS) {
 			pr_err("invalid thread number\n");
@@ -207,17 +343,29 @@ static long map_benchmark_ioctl(struct file *file, unsigned int cmd,
 			return -EINVAL;
 		}
 
+		if (map->bparam.flags & ~DMA_MAP_F_MASK) {
+			pr_err("invalid flags\n");
+			return -EINVAL;
+		}
+
 		if (map->bparam.node != NUMA_NO_NODE &&
 		    !node_possible(map->bparam.node)) {
 			pr_err("invalid numa node\n");
 			return -EINVAL;
 		}
 
-		if (map->bparam.granule < 1 || map->bparam.granule > 1024) {
+		if (map->bparam.granule < 1 ||
+		    map->bparam.granule > DMA_MAP_MAX_GRANULE) {
 			pr_err("invalid granule size\n");
 			return -EINVAL;
 		}
 
+		if (map->bparam.sg_nents > DMA_MAP_MAX_GRANULE /
+					   map->bparam.granule) {
+			pr_err("invalid number of scatterlist entries\n");
+			return -EINVAL;
+		}
+
 		switch (map->bparam.dma_dir) {
 		case DMA_MAP_BIDIRECTIONAL:
 			map->dir = DMA_BIDIRECTIONAL;
@@ -257,7 +405,7 @@ static long map_benchmark_ioctl(struct file *file, unsigned int cmd,
 		return -EINVAL;
 	}
 
-	if (copy_to_user(argp, &map->bparam, sizeof(map->bparam)))
+	if (copy_to_user(argp, &map->bparam, size))
 		return -EFAULT;
 
 	return ret;
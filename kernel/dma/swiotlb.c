@@ -41,11 +41,14 @@
 #include <linux/string.h>
 #include <linux/swiotlb.h>
 #include <linux/types.h>
+#include <linux/workqueue.h>
+#if defined(CONFIG_DMA_RESTRICTED_POOL) || defined(CONFIG_SWIOTLB_DYNAMIC)
+#include <linux/slab.h>
+#endif
 #ifdef CONFIG_DMA_RESTRICTED_POOL
 #include <linux/of.h>
 #include <linux/of_fdt.h>
 #include <linux/of_reserved_mem.h>
-#include <linux/slab.h>
 #endif
 
 #define CREATE_TRACE_POINTS
@@ -300,6 +303,18 @@ static void swiotlb_init_io_tlb_mem(struct io_tlb_mem *mem, phys_addr_t start,
 	return;
 }
 
+/*
+ * Pools for which the memory has to be remapped (e.g. Xen) or is accessed
+ * through an unencrypted alias cannot be extended with plain pages.
+ */
+static void swiotlb_set_can_grow(struct io_tlb_mem *mem,
+		int (*remap)(void *tlb, unsigned long nslabs))
+{
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+	mem->can_grow = !remap && !swiotlb_unencrypted_base;
+#endif
+}
+
 /*
  * Statically reserve bounce buffer space and initialize bounce buffer data
  * structures for the software IO TLB used to implement the DMA API.
@@ -370,6 +385,7 @@ void __init swiotlb_init_remap(bool addressing_limit, unsigned int flags,
 
 	swiotlb_init_io_tlb_mem(mem, __pa(tlb), nslabs, flags, false,
 				default_nareas);
+	swiotlb_set_can_grow(mem, remap);
 
 	if (flags & SWIOTLB_VERBOSE)
 		swiotlb_print_info();
@@ -451,6 +467,7 @@ int swiotlb_init_late(size_t size, gfp_t gfp_mask,
 			     (nslabs << IO_TLB_SHIFT) >> PAGE_SHIFT);
 	swiotlb_init_io_tlb_mem(mem, virt_to_phys(vstart), nslabs, 0, true,
 				default_nareas);
+	swiotlb_set_can_grow(mem, remap);
 
 	swiotlb_print_info();
 	return 0;
@@ -505,13 +522,148 @@ static unsigned int swiotlb_align_offset(struct device *dev, u64 addr)
 	return addr & dma_get_min_align_mask(dev) & (IO_TLB_SIZE - 1);
 }
 
+static inline struct io_tlb_mem *swiotlb_next_pool(struct io_tlb_mem *mem)
+{
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+	/* Pairs with smp_store_release() in swiotlb_grow_fn() */
+	return smp_load_acquire(&mem->next);
+#else
+	return NULL;
+#endif
+}
+
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+/**
+ * swiotlb_find_pool() - find the swiotlb pool a bounce buffer belongs to
+ * @dev:	Device which has mapped the buffer.
+ * @paddr:	Physical address within the bounce buffer.
+ *
+ * Return: The pool containing @paddr, or %NULL if @paddr is not within any
+ * of the pools of @dev.
+ */
+struct io_tlb_mem *swiotlb_find_pool(struct device *dev, phys_addr_t paddr)
+{
+	struct io_tlb_mem *mem;
+
+	for (mem = dev->dma_io_tlb_mem; mem; mem = swiotlb_next_pool(mem))
+		if (paddr >= mem->start && paddr < mem->end)
+			return mem;
+
+	return NULL;
+}
+
+/* Memory added at run time is limited to this multiple of the initial pool */
+#define IO_TLB_GROW_FACTOR	3
+
+static unsigned long io_tlb_grown_nslabs;
+
+/*
+ * Allocate additional pools from the same zone as the initial pool, so that
+ * they are addressable by all the devices the initial pool is for.
+ */
+static gfp_t swiotlb_grow_gfp(struct io_tlb_mem *mem)
+{
+	phys_addr_t limit = mem->end - 1;
+
+	if (IS_ENABLED(CONFIG_ZONE_DMA) && limit <= DMA_BIT_MASK(zone_dma_bits))
+		return GFP_KERNEL | GFP_DMA;
+	if (IS_ENABLED(CONFIG_ZONE_DMA32) && limit <= DMA_BIT_MASK(32))
+		return GFP_KERNEL | GFP_DMA32;
+	return GFP_KERNEL;
+}
+
+static void swiotlb_grow_fn(struct work_struct *work)
+{
+	struct io_tlb_mem *mem = &io_tlb_default_mem, *pool, *tail;
+	unsigned long nslabs;
+	unsigned int order, nareas;
+	void *vstart;
+
+	nslabs = min_t(unsigned long, mem->nslabs,
+		       SLABS_PER_PAGE << (MAX_ORDER - 1));
+	if (io_tlb_grown_nslabs + nslabs > mem->nslabs * IO_TLB_GROW_FACTOR)
+		return;
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (!pool)
+		return;
+
+	for (order = get_order(nslabs << IO_TLB_SHIFT); ; order--) {
+		nslabs = SLABS_PER_PAGE << order;
+		if (nslabs < IO_TLB_MIN_SLABS)
+			goto error_tlb;
+		vstart = (void *)__get_free_pages(swiotlb_grow_gfp(mem) |
+						  __GFP_NOWARN, order);
+		if (vstart)
+			break;
+	}
+
+	/* Keep every area at least one segment large */
+	nareas = rounddown_pow_of_two(min_t(unsigned long, mem->nareas,
+					    nslabs / IO_TLB_SEGSIZE));
+	pool->areas = kcalloc(nareas, sizeof(*pool->areas), GFP_KERNEL);
+	if (!pool->areas)
+		goto error_areas;
+
+	pool->slots = kcalloc(nslabs, sizeof(*pool->slots), GFP_KERNEL);
+	if (!pool->slots)
+		goto error_slots;
+
+	set_memory_decrypted((unsigned long)vstart,
+			     (nslabs << IO_TLB_SHIFT) >> PAGE_SHIFT);
+	swiotlb_init_io_tlb_mem(pool, virt_to_phys(vstart), nslabs, 0, true,
+				nareas);
+	pool->force_bounce = mem->force_bounce;
+
+	/* Only this work adds pools, so the list cannot change under us. */
+	for (tail = mem; tail->next; tail = tail->next)
+		;
+	smp_store_release(&tail->next, pool);
+	io_tlb_grown_nslabs += nslabs;
+
+	pr_info("added %lu MB pool, %lu MB added in total\n",
+		(nslabs << IO_TLB_SHIFT) >> 20,
+		(io_tlb_grown_nslabs << IO_TLB_SHIFT) >> 20);
+	return;
+
+error_slots:
+	kfree(pool->areas);
+error_areas:
+	free_pages((unsigned long)vstart, order);
+error_tlb:
+	kfree(pool);
+}
+static DECLARE_WORK(swiotlb_grow_work, swiotlb_grow_fn);
+
+/*
+ * Ask for another pool once @mem could not satisfy a mapping. The mapping
+ * itself still fails, as it may well come from atomic context, but the ones
+ * after it can use the new pool.
+ */
+static void swiotlb_grow(struct io_tlb_mem *mem)
+{
+	if (mem->can_grow)
+		schedule_work(&swiotlb_grow_work);
+}
+#else
+static inline struct io_tlb_mem *swiotlb_find_pool(struct device *dev,
+						   phys_addr_t paddr)
+{
+	return dev->dma_io_tlb_mem;
+}
+
+static inline void swiotlb_grow(struct io_tlb_mem *mem)
+{
+}
+#endif /* CONFIG_SWIOTLB_DYNAMIC */
+
 /*
  * Bounce: copy the swiotlb buffer from or back to the original dma location
  */
 static void swiotlb_bounce(struct device *dev, phys_addr_t tlb_addr, size_t size,
 			   enum dma_data_direction dir)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = swiotlb_find_pool(dev, tlb_addr);
 	int index = (tlb_addr - mem->start) >> IO_TLB_SHIFT;
 	phys_addr_t orig_addr = mem->slots[index].orig_addr;
 	size_t alloc_size = mem->slots[index].alloc_size;
@@ -604,11 +756,10 @@ static unsigned int wrap_area_index(struct io_tlb_mem *mem, unsigned int index)
  * Find a suitable number of IO TLB entries size that will fit this request and
  * allocate a buffer from that IO TLB pool.
  */
-static int swiotlb_do_find_slots(struct device *dev, int area_index,
-		phys_addr_t orig_addr, size_t alloc_size,
+static int swiotlb_do_find_slots(struct device *dev, struct io_tlb_mem *mem,
+		int area_index, phys_addr_t orig_addr, size_t alloc_size,
 		unsigned int alloc_align_mask)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
 	struct io_tlb_area *area = mem->areas + area_index;
 	unsigned long boundary_mask = dma_get_seg_boundary(dev);
 	dma_addr_t tbl_dma_addr =
@@ -694,21 +845,42 @@ static int swiotlb_do_find_slots(struct device *dev, int area_index,
 	return slot_index;
 }
 
+/*
+ * Try the pools of @dev in the order they were added, starting with the
+ * area of the current CPU in each. On success, return the slot index and
+ * the pool it belongs to in @retpool.
+ */
 static int swiotlb_find_slots(struct device *dev, phys_addr_t orig_addr,
-		size_t alloc_size, unsigned int alloc_align_mask)
+		size_t alloc_size, unsigned int alloc_align_mask,
+		struct io_tlb_mem **retpool)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
-	int start = raw_smp_processor_id() & (mem->nareas - 1);
-	int i = start, index;
+	struct io_tlb_mem *mem;
+	int start, i, index;
 
-	do {
-		index = swiotlb_do_find_slots(dev, i, orig_addr, alloc_size,
-					      alloc_align_mask);
-		if (index >= 0)
-			return index;
-		if (++i >= mem->nareas)
-			i = 0;
-	} while (i != start);
+	for (mem = dev->dma_io_tlb_mem; mem; mem = swiotlb_next_pool(mem)) {
+		/*
+		 * The initial pool suits all devices using it, but a pool
+		 * added later may be out of reach of this one.
+		 */
+		if (mem != dev->dma_io_tlb_mem &&
+		    !dma_capable(dev, phys_to_dma_unencrypted(dev, mem->end - 1),
+				 1, true))
+			continue;
+
+		start = raw_smp_processor_id() & (mem->nareas - 1);
+		i = start;
+		do {
+			index = swiotlb_do_find_slots(dev, mem, i, orig_addr,
+						      alloc_size,
+						      alloc_align_mask);
+			if (index >= 0) {
+				*retpool = mem;
+				return index;
+			}
+			if (++i >= mem->nareas)
+				i = 0;
+		} while (i != start);
+	}
 
 	return -1;
 }
@@ -728,7 +900,7 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 		unsigned int alloc_align_mask, enum dma_data_direction dir,
 		unsigned long attrs)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = dev->dma_io_tlb_mem, *pool;
 	unsigned int offset = swiotlb_align_offset(dev, orig_addr);
 	unsigned int i;
 	int index;
@@ -750,8 +922,9 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 	}
 
 	index = swiotlb_find_slots(dev, orig_addr,
-				   alloc_size + offset, alloc_align_mask);
+				   alloc_size + offset, alloc_align_mask, &pool);
 	if (index == -1) {
+		swiotlb_grow(mem);
 		if (!(attrs & DMA_ATTR_NO_WARN))
 			dev_warn_ratelimited(dev,
 	"swiotlb buffer is full (sz: %zd bytes), total %lu (slots), used %lu (slots)\n",
@@ -759,14 +932,23 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 		return (phys_addr_t)DMA_MAPPING_ERROR;
 	}
 
+#ifdef CONFIG_SWIOTLB_DYNAMIC
+	/*
+	 * Set before the buffer is handed out, so that unmapping and syncing
+	 * it will look it up beyond the initial pool.
+	 */
+	if (pool != mem && !READ_ONCE(dev->dma_uses_io_tlb))
+		WRITE_ONCE(dev->dma_uses_io_tlb, true);
+#endif
+
 	/*
 	 * Save away the mapping from the original address to the DMA address.
 	 * This is needed when we sync the memory.  Then we sync the buffer if
 	 * needed.
 	 */
 	for (i = 0; i < nr_slots(alloc_size + offset); i++)
-		mem->slots[index + i].orig_addr = slot_addr(orig_addr, i);
-	tlb_addr = slot_addr(mem->start, index) + offset;
+		pool->slots[index + i].orig_addr = slot_addr(orig_addr, i);
+	tlb_addr = slot_addr(pool->start, index) + offset;
 	/*
 	 * When dir == DMA_FROM_DEVICE we could omit the copy from the orig
 	 * to the tlb buffer, if we knew for sure the device will
@@ -780,7 +962,7 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 
 static void swiotlb_release_slots(struct device *dev, phys_addr_t tlb_addr)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = swiotlb_find_pool(dev, tlb_addr);
 	unsigned long flags;
 	unsigned int offset = swiotlb_align_offset(dev, tlb_addr);
 	int index = (tlb_addr - offset - mem->start) >> IO_TLB_SHIFT;
@@ -950,18 +1132,18 @@ late_initcall(swiotlb_create_default_debugfs);
 
 struct page *swiotlb_alloc(struct device *dev, size_t size)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = dev->dma_io_tlb_mem, *pool;
 	phys_addr_t tlb_addr;
 	int index;
 
 	if (!mem)
 		return NULL;
 
-	index = swiotlb_find_slots(dev, 0, size, 0);
+	index = swiotlb_find_slots(dev, 0, size, 0, &pool);
 	if (index == -1)
 		return NULL;
 
-	tlb_addr = slot_addr(mem->start, index);
+	tlb_addr = slot_addr(pool->start, index);
 
 	return pfn_to_page(PFN_DOWN(tlb_addr));
 }
@@ -192,9 +192,15 @@ __perf_output_begin(struct perf_output_handle *handle,
 	perf_output_get_handle(handle);
 
 	do {
-		tail = READ_ONCE(rb->user_page->data_tail);
 		offset = head = local_read(&rb->head);
 		if (!rb->overwrite) {
+			/*
+			 * Only a writable (non-overwrite) buffer needs to look
+			 * at the consumer position; this avoids touching the
+			 * tail, which is written by the reader on another CPU,
+			 * in the overwrite case.
+			 */
+			tail = READ_ONCE(rb->user_page->data_tail);
 			if (unlikely(!ring_buffer_has_space(head, tail,
 							    perf_data_size(rb),
 							    size, backward)))
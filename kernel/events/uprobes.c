@@ -1716,6 +1716,7 @@ void uprobe_free_utask(struct task_struct *t)
 {
 	struct uprobe_task *utask = t->utask;
 	struct return_instance *ri;
+	int i;
 
 	if (!utask)
 		return;
@@ -1723,6 +1724,11 @@ void uprobe_free_utask(struct task_struct *t)
 	if (utask->active_uprobe)
 		put_uprobe(utask->active_uprobe);
 
+	for (i = 0; i < UPROBE_TASK_CACHE_SIZE; i++) {
+		if (utask->cache[i])
+			put_uprobe(utask->cache[i]);
+	}
+
 	ri = utask->return_instances;
 	while (ri)
 		ri = free_ret_instance(ri);
@@ -2040,6 +2046,59 @@ static int is_trap_at_addr(struct mm_struct *mm, unsigned long vaddr)
 	return is_trap_insn(&opcode);
 }
 
+static struct uprobe **uprobe_cache_slot(struct uprobe_task *utask,
+					 unsigned long bp_vaddr)
+{
+	return &utask->cache[(bp_vaddr / UPROBE_SWBP_INSN_SIZE) %
+			     UPROBE_TASK_CACHE_SIZE];
+}
+
+/*
+ * Look up the uprobe hit at @bp_vaddr in the per-task cache of recently hit
+ * uprobes first, which avoids taking uprobes_treelock and walking the tree
+ * for hot probes. The vma has been looked up already, so checking inode and
+ * offset is enough to tell that the mapping has not changed underneath us;
+ * a uprobe that has been unregistered meanwhile is dropped from the cache.
+ */
+static struct uprobe *uprobe_cache_lookup(unsigned long bp_vaddr,
+					  struct inode *inode, loff_t offset)
+{
+	struct uprobe_task *utask = current->utask;
+	struct uprobe **slot, *uprobe;
+
+	if (!utask)
+		return NULL;
+
+	slot = uprobe_cache_slot(utask, bp_vaddr);
+	uprobe = *slot;
+	if (!uprobe)
+		return NULL;
+
+	if (!uprobe_is_active(uprobe)) {
+		*slot = NULL;
+		put_uprobe(uprobe);
+		return NULL;
+	}
+
+	if (uprobe->inode != inode || uprobe->offset != offset)
+		return NULL;
+
+	return get_uprobe(uprobe);
+}
+
+static void uprobe_cache_store(struct uprobe_task *utask,
+			       unsigned long bp_vaddr, struct uprobe *uprobe)
+{
+	struct uprobe **slot = uprobe_cache_slot(utask, bp_vaddr);
+
+	if (*slot == uprobe)
+		return;
+
+	if (*slot)
+		put_uprobe(*slot);
+	*slot = get_uprobe(uprobe);
+}
+
 static struct uprobe *find_active_uprobe(unsigned long bp_vaddr, int *is_swbp)
 {
 	struct mm_struct *mm = current->mm;
@@ -2053,7 +2112,9 @@ static struct uprobe *find_active_uprobe(unsigned long bp_vaddr, int *is_swbp)
 			struct inode *inode = file_inode(vma->vm_file);
 			loff_t offset = vaddr_to_offset(vma, bp_vaddr);
 
-			uprobe = find_uprobe(inode, offset);
+			uprobe = uprobe_cache_lookup(bp_vaddr, inode, offset);
+			if (!uprobe)
+				uprobe = find_uprobe(inode, offset);
 		}
 
 		if (!uprobe)
@@ -2237,6 +2298,8 @@ static void handle_swbp(struct pt_regs *regs)
 	if (!get_utask())
 		goto out;
 
+	uprobe_cache_store(current->utask, bp_vaddr, uprobe);
+
 	if (arch_uprobe_ignore(&uprobe->arch, regs))
 		goto out;
 
@@ -42,16 +42,19 @@
 #include "../locking/rtmutex_common.h"
 
 /*
- * The base of the bucket array and its size are always used together
- * (after initialization only in futex_hash()), so ensure that they
- * reside in the same cacheline.
+ * The hash is split into one bucket array per possible NUMA node, each
+ * allocated on its node. The array bases and their common size are always
+ * used together (after initialization only in futex_hash()), so ensure that
+ * they reside in the same cacheline.
  */
 static struct {
-	struct futex_hash_bucket *queues;
+	struct futex_hash_bucket **queues;
 	unsigned long            hashsize;
-} __futex_data __read_mostly __aligned(2*sizeof(long));
-#define futex_queues   (__futex_data.queues)
-#define futex_hashsize (__futex_data.hashsize)
+	unsigned int             hashshift;
+} __futex_data __read_mostly __aligned(4*sizeof(long));
+#define futex_queues    (__futex_data.queues)
+#define futex_hashsize  (__futex_data.hashsize)
+#define futex_hashshift (__futex_data.hashshift)
 
 
 /*
@@ -105,6 +108,33 @@ late_initcall(fail_futex_debugfs);
 
 #endif /* CONFIG_FAIL_FUTEX */
 
+/*
+ * Pick the node whose bucket array a key hashes into.
+ *
+ * Keys of process private futexes, and of shared anonymous ones which are
+ * also keyed on the mm, go to the node the mm_struct was allocated on. All
+ * futexes of a process thus share the buckets local to where the process
+ * was started, which is where its threads usually run, and processes
+ * started on other nodes no longer collide with it. Inode based keys are
+ * spread over the nodes by hash.
+ */
+static inline int futex_key_node(union futex_key *key, u32 hash)
+{
+	int node;
+
+	if (nr_node_ids == 1)
+		return 0;
+
+	if (!(key->both.offset & FUT_OFF_INODE) && key->private.mm)
+		return page_to_nid(virt_to_page(key->private.mm));
+
+	node = (hash >> futex_hashshift) % nr_node_ids;
+	if (!node_possible(node))
+		node = next_node_in(node, node_possible_map);
+
+	return node;
+}
+
 /**
  * futex_hash - Return the hash bucket in the global hash
  * @key:	Pointer to the futex key for which the hash is calculated
@@ -116,8 +146,9 @@ struct futex_hash_bucket *futex_hash(union futex_key *key)
 {
 	u32 hash = jhash2((u32 *)key, offsetof(typeof(*key), both.offset) / 4,
 			  key->both.offset);
+	int node = futex_key_node(key, hash);
 
-	return &futex_queues[hash & (futex_hashsize - 1)];
+	return &futex_queues[node][hash & (futex_hashsize - 1)];
 }
 
 
@@ -1114,26 +1145,51 @@ void futex_exit_release(struct task_struct *tsk)
 
 static int __init futex_init(void)
 {
+	struct futex_hash_bucket *hb;
 	unsigned int futex_shift;
 	unsigned long i;
+	int node;
+
+	futex_queues = kcalloc(nr_node_ids, sizeof(*futex_queues), GFP_KERNEL);
+	if (!futex_queues)
+		panic("Failed to allocate futex hash\n");
 
 #if CONFIG_BASE_SMALL
 	futex_hashsize = 16;
 #else
-	futex_hashsize = roundup_pow_of_two(256 * num_possible_cpus());
+	/* Size each node's array for the CPUs of an average node */
+	futex_hashsize = roundup_pow_of_two(256 *
+			DIV_ROUND_UP(num_possible_cpus(), num_possible_nodes()));
 #endif
 
-	futex_queues = alloc_large_system_hash("futex", sizeof(*futex_queues),
-					       futex_hashsize, 0,
-					       futex_hashsize < 256 ? HASH_SMALL : 0,
-					       &futex_shift, NULL,
-					       futex_hashsize, futex_hashsize);
-	futex_hashsize = 1UL << futex_shift;
-
-	for (i = 0; i < futex_hashsize; i++) {
-		atomic_set(&futex_queues[i].waiters, 0);
-		plist_head_init(&futex_queues[i].chain);
-		spin_lock_init(&futex_queues[i].lock);
+	if (nr_node_ids == 1) {
+		futex_queues[0] = alloc_large_system_hash("futex", sizeof(*hb),
+					futex_hashsize, 0,
+					futex_hashsize < 256 ? HASH_SMALL : 0,
+					&futex_shift, NULL,
+					futex_hashsize, futex_hashsize);
+		futex_hashsize = 1UL << futex_shift;
+	} else {
+		for_each_node_mask(node, node_possible_map) {
+			futex_queues[node] = kvmalloc_node(futex_hashsize *
+							   sizeof(*hb),
+							   GFP_KERNEL, node);
+			if (!futex_queues[node])
+				panic("Failed to allocate futex hash\n");
+		}
+		pr_info("futex hash table entries: %lu per node (order: %d, %lu bytes)\n",
+			futex_hashsize, get_order(futex_hashsize * sizeof(*hb)),
+			futex_hashsize * sizeof(*hb));
+	}
+	futex_hashshift = ilog2(futex_hashsize);
+
+	for_each_node_mask(node, node_possible_map) {
+		for (i = 0; i < futex_hashsize; i++) {
+			hb = &futex_queues[node][i];
+			atomic_set(&hb->waiters, 0);
+			plist_head_init(&hb->chain);
+			spin_lock_init(&hb->lock);
+		}
 	}
 
 	return 0;
@@ -186,6 +186,28 @@ SYSCALL_DEFINE6(futex, u32 __user *, uaddr, int, op, u32, val,
 /* Mask of available flags for each futex in futex_waitv list */
 #define FUTEXV_WAITER_MASK (FUTEX_32 | FUTEX_PRIVATE_FLAG)
 
+/**
+ * futex_parse_waitv_entry - Copy and check one futex_waitv from userspace
+ * @aux:	Kernel side copy to be filled
+ * @uwaitv:	Userspace entry to be parsed
+ *
+ * Return: Error code on failure, 0 on success
+ */
+static int futex_parse_waitv_entry(struct futex_waitv *aux,
+				   struct futex_waitv __user *uwaitv)
+{
+	if (copy_from_user(aux, uwaitv, sizeof(*aux)))
+		return -EFAULT;
+
+	if ((aux->flags & ~FUTEXV_WAITER_MASK) || aux->__reserved)
+		return -EINVAL;
+
+	if (!(aux->flags & FUTEX_32))
+		return -EINVAL;
+
+	return 0;
+}
+
 /**
  * futex_parse_waitv - Parse a waitv array from userspace
  * @futexv:	Kernel side list of waiters to be filled
@@ -200,16 +222,12 @@ static int futex_parse_waitv(struct futex_vector *futexv,
 {
 	struct futex_waitv aux;
 	unsigned int i;
+	int ret;
 
 	for (i = 0; i < nr_futexes; i++) {
-		if (copy_from_user(&aux, &uwaitv[i], sizeof(aux)))
-			return -EFAULT;
-
-		if ((aux.flags & ~FUTEXV_WAITER_MASK) || aux.__reserved)
-			return -EINVAL;
-
-		if (!(aux.flags & FUTEX_32))
-			return -EINVAL;
+		ret = futex_parse_waitv_entry(&aux, &uwaitv[i]);
+		if (ret)
+			return ret;
 
 		futexv[i].w.flags = aux.flags;
 		futexv[i].w.val = aux.val;
@@ -302,6 +320,144 @@ SYSCALL_DEFINE5(futex_waitv, struct futex_waitv __user *, waiters,
 	return ret;
 }
 
+/**
+ * futex_parse_wakev - Parse a wake or requeue list from userspace
+ * @futexv:	Kernel side list to be filled
+ * @uwakev:	Userspace list to be parsed
+ * @nr_futexes:	Length of futexv
+ *
+ * Return: Error code on failure, 0 on success
+ */
+static int futex_parse_wakev(struct futex_waitv *futexv,
+			     struct futex_waitv __user *uwakev,
+			     unsigned int nr_futexes)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < nr_futexes; i++) {
+		ret = futex_parse_waitv_entry(&futexv[i], &uwakev[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * sys_futex_wakev - Wake up waiters on a list of futexes
+ * @wakers:	List of futexes to wake
+ * @nr_futexes:	Length of wakers
+ * @flags:	Flag for future extensions, must be 0
+ *
+ * Given an array of `struct futex_waitv`, wake up at most `val` waiters on
+ * each uaddr, in a single system call and with a single pass of wakeups for
+ * all of them. Each entry has individual flags, as for futex_waitv().
+ *
+ * Returns the total number of woken waiters. If one of the futexes fails,
+ * the ones after it are not woken and the number of waiters woken so far is
+ * returned, or the error if there are none.
+ */
+SYSCALL_DEFINE3(futex_wakev, struct futex_waitv __user *, wakers,
+		unsigned int, nr_futexes, unsigned int, flags)
+{
+	struct futex_waitv *futexv;
+	unsigned int i;
+	int ret;
+
+	/* This syscall supports no flags for now */
+	if (flags)
+		return -EINVAL;
+
+	if (!nr_futexes || nr_futexes > FUTEX_WAITV_MAX || !wakers)
+		return -EINVAL;
+
+	futexv = kcalloc(nr_futexes, sizeof(*futexv), GFP_KERNEL);
+	if (!futexv)
+		return -ENOMEM;
+
+	ret = futex_parse_wakev(futexv, wakers, nr_futexes);
+	for (i = 0; !ret && i < nr_futexes; i++) {
+		if (!futexv[i].val || futexv[i].val > INT_MAX)
+			ret = -EINVAL;
+	}
+	if (!ret)
+		ret = futex_wake_multiple(futexv, nr_futexes);
+
+	kfree(futexv);
+	return ret;
+}
+
+/**
+ * sys_futex_requeuev - Wake up and requeue the waiters of a futex
+ * @waiters:	List of futexes: the source followed by the requeue targets
+ * @nr_futexes:	Length of waiters, at least 2
+ * @flags:	Flag for future extensions, must be 0
+ * @nr_wake:	Number of waiters on the source futex to wake up
+ *
+ * Like FUTEX_CMP_REQUEUE, but requeues to many futexes at once: after
+ * @nr_wake waiters of waiters[0] have been woken, at most waiters[i].val of
+ * the remaining ones are requeued to each waiters[i].uaddr in order.
+ * waiters[0].val is the expected value of the source futex, which is checked
+ * before each requeue step; -EAGAIN is returned if it changed before any
+ * waiter was woken or requeued. All entries must use the same flags.
+ *
+ * Returns the total number of woken and requeued waiters, or an error code
+ * if that number is 0.
+ */
+SYSCALL_DEFINE4(futex_requeuev, struct futex_waitv __user *, waiters,
+		unsigned int, nr_futexes, unsigned int, flags, int, nr_wake)
+{
+	struct futex_waitv *futexv;
+	unsigned int i, fflags;
+	int ret, total = 0;
+	u32 cmpval;
+
+	/* This syscall supports no flags for now */
+	if (flags)
+		return -EINVAL;
+
+	if (nr_futexes < 2 || nr_futexes > FUTEX_WAITV_MAX || !waiters ||
+	    nr_wake < 0)
+		return -EINVAL;
+
+	futexv = kcalloc(nr_futexes, sizeof(*futexv), GFP_KERNEL);
+	if (!futexv)
+		return -ENOMEM;
+
+	ret = futex_parse_wakev(futexv, waiters, nr_futexes);
+	if (ret)
+		goto out;
+
+	for (i = 1; i < nr_futexes; i++) {
+		if (futexv[i].flags != futexv[0].flags ||
+		    futexv[i].val > INT_MAX) {
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+	fflags = (futexv[0].flags & FUTEX_PRIVATE_FLAG) ? 0 : FLAGS_SHARED;
+	cmpval = futexv[0].val;
+
+	for (i = 1; i < nr_futexes; i++) {
+		ret = futex_requeue(u64_to_user_ptr(futexv[0].uaddr), fflags,
+				    u64_to_user_ptr(futexv[i].uaddr),
+				    nr_wake, futexv[i].val, &cmpval, 0);
+		if (ret < 0)
+			break;
+		total += ret;
+		/* Only the first step wakes, the others just requeue */
+		nr_wake = 0;
+	}
+
+	if (total)
+		ret = total;
+out:
+	kfree(futexv);
+	return ret;
+}
+
 #ifdef CONFIG_COMPAT
 COMPAT_SYSCALL_DEFINE2(set_robust_list,
 		struct compat_robust_list_head __user *, head,
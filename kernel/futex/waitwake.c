@@ -138,15 +138,16 @@ void futex_wake_mark(struct wake_q_head *wake_q, struct futex_q *q)
 }
 
 /*
- * Wake up waiters matching bitset queued on this futex (uaddr).
+ * Mark up to @nr_wake waiters matching bitset queued on this futex (uaddr)
+ * for wakeup in @wake_q.
  */
-int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
+static int __futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake,
+			u32 bitset, struct wake_q_head *wake_q)
 {
 	struct futex_hash_bucket *hb;
 	struct futex_q *this, *next;
 	union futex_key key = FUTEX_KEY_INIT;
 	int ret;
-	DEFINE_WAKE_Q(wake_q);
 
 	if (!bitset)
 		return -EINVAL;
@@ -174,17 +175,62 @@ int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 			if (!(this->bitset & bitset))
 				continue;
 
-			futex_wake_mark(&wake_q, this);
+			futex_wake_mark(wake_q, this);
 			if (++ret >= nr_wake)
 				break;
 		}
 	}
 
 	spin_unlock(&hb->lock);
+	return ret;
+}
+
+/*
+ * Wake up waiters matching bitset queued on this futex (uaddr).
+ */
+int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
+{
+	DEFINE_WAKE_Q(wake_q);
+	int ret;
+
+	ret = __futex_wake(uaddr, flags, nr_wake, bitset, &wake_q);
 	wake_up_q(&wake_q);
 	return ret;
 }
 
+/**
+ * futex_wake_multiple - Wake up waiters on a list of futexes
+ * @ws:		List of futexes to wake, @ws[i].val waiters on each at most
+ * @count:	Length of @ws
+ *
+ * The waiters of all futexes are collected first and woken up in one go,
+ * after all hash bucket locks have been dropped.
+ *
+ * Return:
+ *  - >=0 - the total number of woken waiters;
+ *  -  <0 - the error of the first futex that failed, if no waiter was woken
+ *	    before it. The futexes after a failing one are not woken.
+ */
+int futex_wake_multiple(struct futex_waitv *ws, unsigned int count)
+{
+	unsigned int flags, i;
+	int ret = 0, woken = 0;
+	DEFINE_WAKE_Q(wake_q);
+
+	for (i = 0; i < count; i++) {
+		flags = (ws[i].flags & FUTEX_PRIVATE_FLAG) ? 0 : FLAGS_SHARED;
+
+		ret = __futex_wake(u64_to_user_ptr(ws[i].uaddr), flags,
+				   ws[i].val, FUTEX_BITSET_MATCH_ANY, &wake_q);
+		if (ret < 0)
+			break;
+		woken += ret;
+	}
+
+	wake_up_q(&wake_q);
+	return woken ? woken : ret;
+}
+
 static int futex_atomic_op_inuser(unsigned int encoded_op, u32 __user *uaddr)
 {
 	unsigned int op =	  (encoded_op & 0x70000000) >> 28;
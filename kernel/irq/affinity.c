@@ -8,11 +8,12 @@
 #include <linux/slab.h>
 #include <linux/cpu.h>
 #include <linux/sort.h>
+#include <linux/sched/topology.h>
 
 static void irq_spread_init_one(struct cpumask *irqmsk, struct cpumask *nmsk,
 				unsigned int cpus_per_vec)
 {
-	const struct cpumask *siblmsk;
+	const struct cpumask *siblmsk, *clstmsk;
 	int cpu, sibl;
 
 	for ( ; cpus_per_vec > 0; ) {
@@ -37,7 +38,179 @@ static void irq_spread_init_one(struct cpumask *irqmsk, struct cpumask *nmsk,
 			cpumask_set_cpu(sibl, irqmsk);
 			cpus_per_vec--;
 		}
+
+		/* Then the other cpus of its cluster, so as not to straddle clusters */
+		clstmsk = topology_cluster_cpumask(cpu);
+		for (sibl = -1; cpus_per_vec > 0; ) {
+			sibl = cpumask_next(sibl, clstmsk);
+			if (sibl >= nr_cpu_ids)
+				break;
+			if (!cpumask_test_and_clear_cpu(sibl, nmsk))
+				continue;
+			cpumask_set_cpu(sibl, irqmsk);
+			cpus_per_vec--;
+		}
+	}
+}
+
+/*
+ * Spread @nvectors vectors, starting at *@curvec, over the @ncpus CPUs in
+ * @nmsk. Wrapping has to be considered given *@curvec may start anywhere
+ * between @firstvec and @last_affv.
+ */
+static void irq_spread_vectors(struct irq_affinity_desc *masks,
+			       struct cpumask *nmsk, unsigned int ncpus,
+			       unsigned int nvectors, unsigned int *curvec,
+			       unsigned int firstvec, unsigned int last_affv)
+{
+	unsigned int v, cpus_per_vec, extra_vecs;
+
+	/* Account for rounding errors */
+	extra_vecs = ncpus - nvectors * (ncpus / nvectors);
+
+	for (v = 0; v < nvectors; v++, (*curvec)++) {
+		cpus_per_vec = ncpus / nvectors;
+
+		/* Account for extra vectors to compensate rounding errors */
+		if (extra_vecs) {
+			cpus_per_vec++;
+			--extra_vecs;
+		}
+
+		if (*curvec >= last_affv)
+			*curvec = firstvec;
+		irq_spread_init_one(&masks[*curvec].mask, nmsk, cpus_per_vec);
+	}
+}
+
+/*
+ * On systems with asymmetric CPU capacity, e.g. big.LITTLE, the CPUs of a
+ * node are split into groups of equal capacity and the node's vectors are
+ * distributed over the groups, so that no vector mixes CPUs of different
+ * capacity and the higher capacity CPUs share their vectors with fewer
+ * other CPUs.
+ */
+#define IRQ_CAPACITY_GROUPS_MAX	4
+
+struct capacity_group {
+	unsigned long	capacity;	/* of each CPU in the group */
+	unsigned int	ncpus;
+	unsigned int	nvectors;
+};
+
+/*
+ * Sort the CPUs in @nmsk into groups of equal capacity, highest capacity
+ * first. Returns the number of groups, or 0 if the capacity is symmetric or
+ * there are too many different capacities.
+ */
+static unsigned int irq_capacity_groups(const struct cpumask *nmsk,
+					struct capacity_group *groups)
+{
+	unsigned int i, n = 0;
+	unsigned long cap;
+	int cpu;
+
+	for_each_cpu(cpu, nmsk) {
+		cap = arch_scale_cpu_capacity(cpu);
+
+		for (i = 0; i < n && groups[i].capacity > cap; i++)
+			;
+		if (i < n && groups[i].capacity == cap) {
+			groups[i].ncpus++;
+			continue;
+		}
+
+		if (n == IRQ_CAPACITY_GROUPS_MAX)
+			return 0;
+		memmove(&groups[i + 1], &groups[i], (n - i) * sizeof(*groups));
+		groups[i].capacity = cap;
+		groups[i].ncpus = 1;
+		groups[i].nvectors = 0;
+		n++;
+	}
+
+	return n > 1 ? n : 0;
+}
+
+/*
+ * Distribute @nvectors over the @ngroups capacity groups, at least one per
+ * group and at most one per CPU. By default each group gets a share that is
+ * proportional to its total capacity. With @prefer_perf the highest capacity
+ * groups are served first, so that their CPUs get vectors of their own, and
+ * the CPUs of the other groups share what is left.
+ *
+ * @nvectors must be >= @ngroups and <= the number of CPUs in the groups.
+ */
+static void irq_alloc_capacity_vectors(struct capacity_group *groups,
+				       unsigned int ngroups,
+				       unsigned int nvectors, bool prefer_perf)
+{
+	unsigned int g, want, reserve, left = nvectors;
+	unsigned long weight, total = 0;
+
+	for (g = 0; g < ngroups; g++)
+		total += groups[g].capacity * groups[g].ncpus;
+
+	for (g = 0; g < ngroups; g++) {
+		weight = groups[g].capacity * groups[g].ncpus;
+		/* Leave one vector for each of the remaining groups */
+		reserve = ngroups - g - 1;
+
+		if (prefer_perf)
+			want = groups[g].ncpus;
+		else
+			want = DIV_ROUND_CLOSEST(left * weight, total);
+
+		groups[g].nvectors = clamp_t(unsigned int, want, 1,
+					     min(groups[g].ncpus, left - reserve));
+		left -= groups[g].nvectors;
+		total -= weight;
+	}
+
+	/* Hand out what rounding left over to the groups with spare CPUs */
+	for (g = 0; left && g < ngroups; g++) {
+		want = min(left, groups[g].ncpus - groups[g].nvectors);
+		groups[g].nvectors += want;
+		left -= want;
+	}
+}
+
+/*
+ * Spread @nvectors vectors over the CPUs in @nmsk by capacity group.
+ * Returns false, without touching anything, if the CPUs in @nmsk are
+ * symmetric or the vectors are too few to give each group one.
+ */
+static bool irq_spread_capacity_vectors(struct irq_affinity_desc *masks,
+					struct cpumask *nmsk,
+					struct cpumask *gmsk,
+					unsigned int nvectors,
+					unsigned int *curvec,
+					unsigned int firstvec,
+					unsigned int last_affv,
+					bool prefer_perf)
+{
+	struct capacity_group groups[IRQ_CAPACITY_GROUPS_MAX];
+	unsigned int g, ngroups;
+	int cpu;
+
+	ngroups = irq_capacity_groups(nmsk, groups);
+	if (!ngroups || nvectors < ngroups)
+		return false;
+
+	irq_alloc_capacity_vectors(groups, ngroups, nvectors, prefer_perf);
+
+	for (g = 0; g < ngroups; g++) {
+		cpumask_clear(gmsk);
+		for_each_cpu(cpu, nmsk) {
+			if (arch_scale_cpu_capacity(cpu) == groups[g].capacity)
+				cpumask_set_cpu(cpu, gmsk);
+		}
+		irq_spread_vectors(masks, gmsk, groups[g].ncpus,
+				   groups[g].nvectors, curvec, firstvec,
+				   last_affv);
 	}
+
+	return true;
 }
 
 static cpumask_var_t *alloc_node_to_cpumask(void)
@@ -250,9 +423,11 @@ static int __irq_build_affinity_masks(unsigned int startvec,
 				      cpumask_var_t *node_to_cpumask,
 				      const struct cpumask *cpu_mask,
 				      struct cpumask *nmsk,
-				      struct irq_affinity_desc *masks)
+				      struct cpumask *gmsk,
+				      struct irq_affinity_desc *masks,
+				      bool prefer_perf)
 {
-	unsigned int i, n, nodes, cpus_per_vec, extra_vecs, done = 0;
+	unsigned int i, n, nodes, done = 0;
 	unsigned int last_affv = firstvec + numvecs;
 	unsigned int curvec = startvec;
 	nodemask_t nodemsk = NODE_MASK_NONE;
@@ -289,7 +464,7 @@ static int __irq_build_affinity_masks(unsigned int startvec,
 			    nodemsk, nmsk, node_vectors);
 
 	for (i = 0; i < nr_node_ids; i++) {
-		unsigned int ncpus, v;
+		unsigned int ncpus;
 		struct node_vectors *nv = &node_vectors[i];
 
 		if (nv->nvectors == UINT_MAX)
@@ -303,28 +478,18 @@ static int __irq_build_affinity_masks(unsigned int startvec,
 
 		WARN_ON_ONCE(nv->nvectors > ncpus);
 
-		/* Account for rounding errors */
-		extra_vecs = ncpus - nv->nvectors * (ncpus / nv->nvectors);
-
-		/* Spread allocated vectors on CPUs of the current node */
-		for (v = 0; v < nv->nvectors; v++, curvec++) {
-			cpus_per_vec = ncpus / nv->nvectors;
-
-			/* Account for extra vectors to compensate rounding errors */
-			if (extra_vecs) {
-				cpus_per_vec++;
-				--extra_vecs;
-			}
-
-			/*
-			 * wrapping has to be considered given 'startvec'
-			 * may start anywhere
-			 */
-			if (curvec >= last_affv)
-				curvec = firstvec;
-			irq_spread_init_one(&masks[curvec].mask, nmsk,
-						cpus_per_vec);
-		}
+		/*
+		 * Spread allocated vectors on CPUs of the current node, by
+		 * capacity group if CPUs have to share vectors on an
+		 * asymmetric node.
+		 */
+		if (nv->nvectors == ncpus ||
+		    !irq_spread_capacity_vectors(masks, nmsk, gmsk,
+						 nv->nvectors, &curvec,
+						 firstvec, last_affv,
+						 prefer_perf))
+			irq_spread_vectors(masks, nmsk, ncpus, nv->nvectors,
+					   &curvec, firstvec, last_affv);
 		done += nv->nvectors;
 	}
 	kfree(node_vectors);
@@ -338,19 +503,23 @@ static int __irq_build_affinity_masks(unsigned int startvec,
  */
 static int irq_build_affinity_masks(unsigned int startvec, unsigned int numvecs,
 				    unsigned int firstvec,
-				    struct irq_affinity_desc *masks)
+				    struct irq_affinity_desc *masks,
+				    bool prefer_perf)
 {
 	unsigned int curvec = startvec, nr_present = 0, nr_others = 0;
 	cpumask_var_t *node_to_cpumask;
-	cpumask_var_t nmsk, npresmsk;
+	cpumask_var_t nmsk, gmsk, npresmsk;
 	int ret = -ENOMEM;
 
 	if (!zalloc_cpumask_var(&nmsk, GFP_KERNEL))
 		return ret;
 
-	if (!zalloc_cpumask_var(&npresmsk, GFP_KERNEL))
+	if (!zalloc_cpumask_var(&gmsk, GFP_KERNEL))
 		goto fail_nmsk;
 
+	if (!zalloc_cpumask_var(&npresmsk, GFP_KERNEL))
+		goto fail_gmsk;
+
 	node_to_cpumask = alloc_node_to_cpumask();
 	if (!node_to_cpumask)
 		goto fail_npresmsk;
@@ -362,7 +531,7 @@ static int irq_build_affinity_masks(unsigned int startvec, unsigned int numvecs,
 	/* Spread on present CPUs starting from affd->pre_vectors */
 	ret = __irq_build_affinity_masks(curvec, numvecs, firstvec,
 					 node_to_cpumask, cpu_present_mask,
-					 nmsk, masks);
+					 nmsk, gmsk, masks, prefer_perf);
 	if (ret < 0)
 		goto fail_build_affinity;
 	nr_present = ret;
@@ -379,8 +548,8 @@ static int irq_build_affinity_masks(unsigned int startvec, unsigned int numvecs,
 		curvec = firstvec + nr_present;
 	cpumask_andnot(npresmsk, cpu_possible_mask, cpu_present_mask);
 	ret = __irq_build_affinity_masks(curvec, numvecs, firstvec,
-					 node_to_cpumask, npresmsk, nmsk,
-					 masks);
+					 node_to_cpumask, npresmsk, nmsk, gmsk,
+					 masks, prefer_perf);
 	if (ret >= 0)
 		nr_others = ret;
 
@@ -395,6 +564,9 @@ static int irq_build_affinity_masks(unsigned int startvec, unsigned int numvecs,
  fail_npresmsk:
 	free_cpumask_var(npresmsk);
 
+ fail_gmsk:
+	free_cpumask_var(gmsk);
+
  fail_nmsk:
 	free_cpumask_var(nmsk);
 	return ret < 0 ? ret : 0;
@@ -464,7 +636,8 @@ irq_create_affinity_masks(unsigned int nvecs, struct irq_affinity *affd)
 		int ret;
 
 		ret = irq_build_affinity_masks(curvec, this_vecs,
-					       curvec, masks);
+					       curvec, masks,
+					       affd->prefer_perf);
 		if (ret) {
 			kfree(masks);
 			return NULL;
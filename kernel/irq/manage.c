@@ -1210,6 +1210,44 @@ static irqreturn_t irq_thread_fn(struct irq_desc *desc,
 	return ret;
 }
 
+/*
+ * Maximum number of threaded handler calls per thread wakeup for
+ * interrupts requested with IRQF_THREAD_POLL.
+ */
+#define IRQ_THREAD_POLL_BUDGET	64
+
+/*
+ * Interrupts requested with IRQF_THREAD_POLL keep calling the threaded
+ * handler while it finds work, so a device raising events at a high rate
+ * is serviced without a hard interrupt and a thread wakeup per event. Stop
+ * once the budget is spent or something else wants to run, and let the
+ * device interrupt again if it still has work.
+ */
+static irqreturn_t irq_thread_poll_fn(struct irq_desc *desc,
+				      struct irqaction *action)
+{
+	unsigned int budget = IRQ_THREAD_POLL_BUDGET;
+	bool handled = false;
+	irqreturn_t ret;
+
+	for (;;) {
+		ret = action->thread_fn(action->irq, action->dev_id);
+		if (ret != IRQ_HANDLED)
+			break;
+		handled = true;
+		if (!--budget || need_resched())
+			break;
+	}
+
+	if (handled) {
+		atomic_inc(&desc->threads_handled);
+		ret = IRQ_HANDLED;
+	}
+
+	irq_finalize_oneshot(desc, action);
+	return ret;
+}
+
 static void wake_threads_waitq(struct irq_desc *desc)
 {
 	if (atomic_dec_and_test(&desc->threads_active))
@@ -1298,6 +1336,8 @@ static int irq_thread(void *data)
 	if (force_irqthreads() && test_bit(IRQTF_FORCED_THREAD,
 					   &action->thread_flags))
 		handler_fn = irq_forced_thread_fn;
+	else if (action->flags & IRQF_THREAD_POLL)
+		handler_fn = irq_thread_poll_fn;
 	else
 		handler_fn = irq_thread_fn;
 
@@ -2134,6 +2174,7 @@ const void *free_nmi(unsigned int irq, void *dev_id)
  *	IRQF_SHARED		Interrupt is shared
  *	IRQF_TRIGGER_*		Specify active edge(s) or level
  *	IRQF_ONESHOT		Run thread_fn with interrupt line masked
+ *	IRQF_THREAD_POLL	Call thread_fn again while it returns IRQ_HANDLED
  */
 int request_threaded_irq(unsigned int irq, irq_handler_t handler,
 			 irq_handler_t thread_fn, unsigned long irqflags,
@@ -2158,11 +2199,14 @@ int request_threaded_irq(unsigned int irq, irq_handler_t handler,
 	 *
 	 * Also IRQF_COND_SUSPEND only makes sense for shared interrupts and
 	 * it cannot be set along with IRQF_NO_SUSPEND.
+	 *
+	 * IRQF_THREAD_POLL needs a threaded handler to poll.
 	 */
 	if (((irqflags & IRQF_SHARED) && !dev_id) ||
 	    ((irqflags & IRQF_SHARED) && (irqflags & IRQF_NO_AUTOEN)) ||
 	    (!(irqflags & IRQF_SHARED) && (irqflags & IRQF_COND_SUSPEND)) ||
-	    ((irqflags & IRQF_NO_SUSPEND) && (irqflags & IRQF_COND_SUSPEND)))
+	    ((irqflags & IRQF_NO_SUSPEND) && (irqflags & IRQF_COND_SUSPEND)) ||
+	    ((irqflags & IRQF_THREAD_POLL) && !thread_fn))
 		return -EINVAL;
 
 	desc = irq_to_desc(irq);
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Collect lock contention wait time histograms
+ *
+ * When CONFIG_LOCK_CONTENTION_PROFILE is enabled, the wait times of
+ * contended mutexes and rwsems and the spin times in osq_lock() can be
+ * recorded and are reported under the <debugfs>/lock_contention/ directory:
+ *
+ *   enable	- write 1 to start and 0 to stop recording
+ *   sites	- one line per lock and callsite seen waiting
+ *   reset	- write anything to clear all recorded data
+ *
+ * Each line of "sites" looks like:
+ *
+ *   <type> <lock> <callsite> <count> <total_ns> <max_ns> <bucket>:<n> ...
+ *
+ * where bucket i counts the waits that took [2^i, 2^(i+1)) nanoseconds and
+ * only non-empty buckets are listed. The callsite is 0 for the lock types
+ * where it is not known at the point of the wait; those are accounted per
+ * lock instance only.
+ *
+ * Unlike lock_stat, this needs neither lockdep nor any per-lock storage so
+ * it is cheap enough to be switched on for a while on a production machine:
+ * when disabled the hooks cost a static branch, when enabled a clock read
+ * and a few atomic updates on a shared table, both only in the contended
+ * slowpaths. Once the table is full, new lock/callsite pairs are counted as
+ * dropped.
+ */
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/hash.h>
+#include <linux/log2.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+
+#include "lock_contention.h"
+
+#define LOCK_CONTENTION_DIR		"lock_contention"
+#define LOCK_CONTENTION_HASH_BITS	10
+#define LOCK_CONTENTION_NR_SITES	(1U << LOCK_CONTENTION_HASH_BITS)
+#define LOCK_CONTENTION_PROBES		8
+#define LOCK_CONTENTION_NR_BUCKETS	40
+
+struct lock_contention_site {
+	unsigned long	lock;		/* 0 if the slot is free */
+	unsigned long	ip;
+	unsigned int	type;
+	atomic_long_t	count;
+	atomic64_t	total_ns;
+	atomic64_t	max_ns;
+	atomic_long_t	hist[LOCK_CONTENTION_NR_BUCKETS];
+};
+
+static const char * const lock_contention_names[LOCK_CONTENTION_NR_TYPES] = {
+	[LOCK_CONTENTION_MUTEX]		= "mutex",
+	[LOCK_CONTENTION_RWSEM_READ]	= "rwsem_read",
+	[LOCK_CONTENTION_RWSEM_WRITE]	= "rwsem_write",
+	[LOCK_CONTENTION_OSQ]		= "osq",
+};
+
+DEFINE_STATIC_KEY_FALSE(lock_contention_enabled);
+
+static struct lock_contention_site *lock_contention_sites;
+static atomic_long_t lock_contention_dropped;
+static DEFINE_MUTEX(lock_contention_mutex);
+
+static struct lock_contention_site *
+lock_contention_find(unsigned long lock, unsigned long ip, unsigned int type)
+{
+	unsigned long key = lock ^ ip ^ type;
+	unsigned int idx = hash_long(key, LOCK_CONTENTION_HASH_BITS);
+	struct lock_contention_site *site;
+	unsigned long old;
+	int i;
+
+	for (i = 0; i < LOCK_CONTENTION_PROBES; i++) {
+		site = &lock_contention_sites[(idx + i) % LOCK_CONTENTION_NR_SITES];
+
+		old = READ_ONCE(site->lock);
+		if (!old) {
+			old = cmpxchg(&site->lock, 0, lock);
+			if (!old) {
+				/*
+				 * A concurrent lookup may not see @ip and @type
+				 * yet and claim a second slot for the same
+				 * pair; that only splits its statistics over
+				 * two lines.
+				 */
+				WRITE_ONCE(site->ip, ip);
+				WRITE_ONCE(site->type, type);
+				return site;
+			}
+		}
+
+		if (old == lock && READ_ONCE(site->ip) == ip &&
+		    READ_ONCE(site->type) == type)
+			return site;
+	}
+
+	return NULL;
+}
+
+void __lock_contention_record(const void *lock, unsigned long ip,
+			      enum lock_contention_type type, u64 wait_ns)
+{
+	struct lock_contention_site *site;
+	s64 max;
+
+	/* local_clock() is not synchronized across CPUs we migrated between */
+	if ((s64)wait_ns <= 0)
+		wait_ns = 1;
+
+	site = lock_contention_find((unsigned long)lock, ip, type);
+	if (!site) {
+		atomic_long_inc(&lock_contention_dropped);
+		return;
+	}
+
+	atomic_long_inc(&site->count);
+	atomic64_add(wait_ns, &site->total_ns);
+	atomic_long_inc(&site->hist[min_t(unsigned int, ilog2(wait_ns),
+					  LOCK_CONTENTION_NR_BUCKETS - 1)]);
+
+	max = atomic64_read(&site->max_ns);
+	while (max < wait_ns &&
+	       !atomic64_try_cmpxchg_relaxed(&site->max_ns, &max, wait_ns))
+		;
+}
+
+static int lock_contention_show(struct seq_file *m, void *v)
+{
+	struct lock_contention_site *site;
+	unsigned int i, b;
+	unsigned long n;
+
+	for (i = 0; i < LOCK_CONTENTION_NR_SITES; i++) {
+		site = &lock_contention_sites[i];
+		if (!READ_ONCE(site->lock) || !atomic_long_read(&site->count))
+			continue;
+
+		seq_printf(m, "%s %pS %pS %lu %lld %lld",
+			   lock_contention_names[site->type],
+			   (void *)site->lock, (void *)site->ip,
+			   atomic_long_read(&site->count),
+			   atomic64_read(&site->total_ns),
+			   atomic64_read(&site->max_ns));
+		for (b = 0; b < LOCK_CONTENTION_NR_BUCKETS; b++) {
+			n = atomic_long_read(&site->hist[b]);
+			if (n)
+				seq_printf(m, " %u:%lu", b, n);
+		}
+		seq_putc(m, '\n');
+	}
+
+	n = atomic_long_read(&lock_contention_dropped);
+	if (n)
+		seq_printf(m, "dropped %lu\n", n);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(lock_contention);
+
+static ssize_t lock_contention_enable_read(struct file *file,
+					   char __user *user_buf,
+					   size_t count, loff_t *ppos)
+{
+	char buf[3];
+
+	buf[0] = static_key_enabled(&lock_contention_enabled) ? '1' : '0';
+	buf[1] = '\n';
+	buf[2] = '\0';
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, 2);
+}
+
+static ssize_t lock_contention_enable_write(struct file *file,
+					    const char __user *user_buf,
+					    size_t count, loff_t *ppos)
+{
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(user_buf, count, &enable);
+	if (ret)
+		return ret;
+
+	mutex_lock(&lock_contention_mutex);
+	if (enable)
+		static_branch_enable(&lock_contention_enabled);
+	else
+		static_branch_disable(&lock_contention_enabled);
+	mutex_unlock(&lock_contention_mutex);
+
+	return count;
+}
+
+static const struct file_operations fops_lock_contention_enable = {
+	.read = lock_contention_enable_read,
+	.write = lock_contention_enable_write,
+	.llseek = default_llseek,
+};
+
+/*
+ * Clearing the table while recording is enabled races with concurrent
+ * updates, which may leave a few stale counts or a partially initialized
+ * slot behind. Disable recording first for exact results.
+ */
+static ssize_t lock_contention_reset_write(struct file *file,
+					   const char __user *user_buf,
+					   size_t count, loff_t *ppos)
+{
+	struct lock_contention_site *site;
+	unsigned int i, b;
+
+	mutex_lock(&lock_contention_mutex);
+	for (i = 0; i < LOCK_CONTENTION_NR_SITES; i++) {
+		site = &lock_contention_sites[i];
+
+		atomic_long_set(&site->count, 0);
+		atomic64_set(&site->total_ns, 0);
+		atomic64_set(&site->max_ns, 0);
+		for (b = 0; b < LOCK_CONTENTION_NR_BUCKETS; b++)
+			atomic_long_set(&site->hist[b], 0);
+		WRITE_ONCE(site->ip, 0);
+		WRITE_ONCE(site->type, 0);
+		smp_store_release(&site->lock, 0);
+	}
+	atomic_long_set(&lock_contention_dropped, 0);
+	mutex_unlock(&lock_contention_mutex);
+
+	return count;
+}
+
+static const struct file_operations fops_lock_contention_reset = {
+	.write = lock_contention_reset_write,
+	.llseek = default_llseek,
+};
+
+/*
+ * Initialize debugfs for the lock contention histograms.
+ */
+static int __init init_lock_contention(void)
+{
+	struct dentry *d_dir;
+
+	lock_contention_sites = kvcalloc(LOCK_CONTENTION_NR_SITES,
+					 sizeof(*lock_contention_sites),
+					 GFP_KERNEL);
+	if (!lock_contention_sites)
+		return -ENOMEM;
+
+	/*
+	 * As reading the histograms walks the whole table, only root is
+	 * allowed to access these files.
+	 */
+	d_dir = debugfs_create_dir(LOCK_CONTENTION_DIR, NULL);
+	debugfs_create_file("enable", 0600, d_dir, NULL,
+			    &fops_lock_contention_enable);
+	debugfs_create_file("sites", 0400, d_dir, NULL,
+			    &lock_contention_fops);
+	debugfs_create_file("reset", 0200, d_dir, NULL,
+			    &fops_lock_contention_reset);
+
+	return 0;
+}
+fs_initcall(init_lock_contention);
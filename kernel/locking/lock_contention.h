@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Lock contention profiling
+ *
+ * Records how long tasks wait for sleeping locks and how long they spin in
+ * osq_lock(), as per-lock, and where known per-callsite, log2 histograms.
+ * The hooks sit next to the contention tracepoints and cost a single static
+ * branch unless profiling is enabled through
+ * <debugfs>/lock_contention/enable.
+ */
+#ifndef __LOCKING_LOCK_CONTENTION_H
+#define __LOCKING_LOCK_CONTENTION_H
+
+#include <linux/jump_label.h>
+#include <linux/sched/clock.h>
+
+enum lock_contention_type {
+	LOCK_CONTENTION_MUTEX,
+	LOCK_CONTENTION_RWSEM_READ,
+	LOCK_CONTENTION_RWSEM_WRITE,
+	LOCK_CONTENTION_OSQ,
+	LOCK_CONTENTION_NR_TYPES,
+};
+
+#ifdef CONFIG_LOCK_CONTENTION_PROFILE
+
+DECLARE_STATIC_KEY_FALSE(lock_contention_enabled);
+
+void __lock_contention_record(const void *lock, unsigned long ip,
+			      enum lock_contention_type type, u64 wait_ns);
+
+/*
+ * Returns the start time of a wait, or 0 if profiling is disabled.
+ */
+static __always_inline u64 lock_contention_start(void)
+{
+	if (static_branch_unlikely(&lock_contention_enabled))
+		return local_clock();
+	return 0;
+}
+
+/*
+ * @ip is the callsite of the lock operation, or 0 when it is not known and
+ * the wait is accounted to @lock only.
+ */
+static __always_inline void lock_contention_end(const void *lock,
+						unsigned long ip,
+						enum lock_contention_type type,
+						u64 start)
+{
+	if (start)
+		__lock_contention_record(lock, ip, type, local_clock() - start);
+}
+
+#else  /* CONFIG_LOCK_CONTENTION_PROFILE */
+
+static inline u64 lock_contention_start(void)
+{
+	return 0;
+}
+
+static inline void lock_contention_end(const void *lock, unsigned long ip,
+				       enum lock_contention_type type,
+				       u64 start)
+{
+}
+
+#endif /* CONFIG_LOCK_CONTENTION_PROFILE */
+#endif /* __LOCKING_LOCK_CONTENTION_H */
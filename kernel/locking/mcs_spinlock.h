@@ -45,6 +45,16 @@ do {									\
 	smp_store_release((l), 1)
 #endif
 
+#ifndef arch_mcs_lock_handoff
+/*
+ * Same as arch_mcs_spin_unlock_contended(), but hands @val rather than 1
+ * over to the next waiter. The NUMA-aware qspinlock uses this to pass its
+ * secondary queue along with the lock.
+ */
+#define arch_mcs_lock_handoff(l, val)					\
+	smp_store_release((l), (val))
+#endif
+
 /*
  * Note: the smp_load_acquire/smp_store_release pair is not
  * sufficient to form a full memory barrier across
@@ -3,6 +3,8 @@
 #include <linux/sched.h>
 #include <linux/osq_lock.h>
 
+#include "lock_contention.h"
+
 /*
  * An MCS like lock especially tailored for optimistic spinning for sleeping
  * lock implementations (mutex, rwsem, etc).
@@ -92,7 +94,8 @@ bool osq_lock(struct optimistic_spin_queue *lock)
 	struct optimistic_spin_node *node = this_cpu_ptr(&osq_node);
 	struct optimistic_spin_node *prev, *next;
 	int curr = encode_cpu(smp_processor_id());
-	int old;
+	u64 wait_start;
+	int old, locked;
 
 	node->locked = 0;
 	node->next = NULL;
@@ -140,8 +143,11 @@ bool osq_lock(struct optimistic_spin_queue *lock)
 	 * is implemented with a monitor-wait. vcpu_is_preempted() relies on
 	 * polling, be careful.
 	 */
-	if (smp_cond_load_relaxed(&node->locked, VAL || need_resched() ||
-				  vcpu_is_preempted(node_cpu(node->prev))))
+	wait_start = lock_contention_start();
+	locked = smp_cond_load_relaxed(&node->locked, VAL || need_resched() ||
+				       vcpu_is_preempted(node_cpu(node->prev)));
+	lock_contention_end(lock, _RET_IP_, LOCK_CONTENTION_OSQ, wait_start);
+	if (locked)
 		return true;
 
 	/* unqueue */
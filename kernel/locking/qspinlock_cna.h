@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _GEN_CNA_LOCK_SLOWPATH
+#error "do not include this file"
+#endif
+
+#include <linux/jump_label.h>
+#include <linux/topology.h>
+
+/*
+ * Implement a NUMA-aware version of MCS (aka CNA, or compact NUMA-aware lock).
+ *
+ * In CNA, spinning threads are organized in two queues, a primary queue for
+ * threads running on the same locality domain as the current lock holder, and
+ * a secondary queue for threads running on other domains. A domain is either
+ * a NUMA node or, with "numa_spinlock=cluster", a CPU cluster as reported by
+ * the architecture topology code.
+ *
+ * While spinning at the head of the primary queue, waiting for the lock owner
+ * to go away, a thread moves waiters of other domains that sit right behind
+ * it into the secondary queue. At unlock time the lock is therefore passed to
+ * a waiter of the same domain whenever one is queued, and the lock cacheline
+ * and the data it protects stay within that domain.
+ *
+ * The secondary queue is circular: its tail points to its head. It is handed
+ * over from one queue head to the next through mcs->locked, which holds the
+ * encoded tail of the secondary queue instead of 1 when it is not empty.
+ * Encoded tails are always larger than 1, see encode_tail().
+ *
+ * The secondary queue is spliced back in front of the primary queue when the
+ * primary queue runs empty, or after cna_handoff_threshold consecutive
+ * handoffs within one domain, which bounds the unfairness towards remote
+ * waiters.
+ *
+ * For more details, see https://arxiv.org/abs/1810.05600.
+ */
+
+struct cna_node {
+	struct mcs_spinlock	mcs;
+	u32			domain;		/* preferred domain */
+	u32			real_domain;	/* domain of this CPU */
+	u32			encoded_tail;	/* self */
+	u32			handoffs;	/* consecutive local handoffs */
+};
+
+enum {
+	CNA_MODE_OFF,
+	CNA_MODE_NODE,
+	CNA_MODE_CLUSTER,
+};
+
+static int cna_mode __initdata = CNA_MODE_OFF;
+
+/*
+ * Number of consecutive handoffs within one domain after which the
+ * secondary queue is flushed.
+ */
+static unsigned int cna_handoff_threshold __ro_after_init = 1U << 8;
+
+static DEFINE_STATIC_KEY_FALSE(cna_spinlock_enabled);
+
+void __cna_queued_spin_lock_slowpath(struct qspinlock *lock, u32 val);
+void native_queued_spin_lock_slowpath(struct qspinlock *lock, u32 val);
+
+static inline bool cna_secondary_empty(struct mcs_spinlock *node)
+{
+	return (u32)node->locked <= 1;
+}
+
+static __always_inline void cna_init_node(struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+
+	cn->domain = cn->real_domain;
+	cn->handoffs = 0;
+}
+
+/*
+ * cna_splice_next -- move @next, the waiter right behind @node, to the tail
+ * of the secondary queue. @nnext is the waiter behind @next; it must be set
+ * so that nobody is about to write @next->next.
+ */
+static void cna_splice_next(struct mcs_spinlock *node,
+			    struct mcs_spinlock *next,
+			    struct mcs_spinlock *nnext)
+{
+	/* remove @next from the primary queue */
+	node->next = nnext;
+
+	if (cna_secondary_empty(node)) {
+		/* create the secondary queue */
+		next->next = next;
+	} else {
+		/* add to the tail of the secondary queue */
+		struct mcs_spinlock *tail_2nd = decode_tail(node->locked);
+		struct mcs_spinlock *head_2nd = tail_2nd->next;
+
+		tail_2nd->next = next;
+		next->next = head_2nd;
+	}
+
+	node->locked = ((struct cna_node *)next)->encoded_tail;
+}
+
+/*
+ * cna_order_queue -- check whether the waiter behind @node runs on the
+ * preferred domain, and move it to the secondary queue if it does not.
+ *
+ * Returns true once a local successor has been found.
+ */
+static bool cna_order_queue(struct mcs_spinlock *node)
+{
+	struct mcs_spinlock *next = READ_ONCE(node->next);
+	struct cna_node *cn = (struct cna_node *)node;
+	struct mcs_spinlock *nnext;
+
+	if (!next)
+		return false;
+
+	if (((struct cna_node *)next)->real_domain == cn->domain)
+		return true;
+
+	nnext = READ_ONCE(next->next);
+	if (nnext)
+		cna_splice_next(node, next, nnext);
+
+	return false;
+}
+
+static __always_inline u32 cna_wait_head_or_lock(struct qspinlock *lock,
+						 struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+
+	/*
+	 * Once the threshold is reached the secondary queue gets flushed at
+	 * handoff time; sorting the primary queue would only grow it further.
+	 */
+	if (cn->handoffs >= cna_handoff_threshold)
+		return 0;
+
+	/*
+	 * Put the time otherwise spent spin waiting on _Q_LOCKED_PENDING_MASK
+	 * to use by sorting the queue.
+	 */
+	while ((atomic_read(&lock->val) & _Q_LOCKED_PENDING_MASK) &&
+	       !cna_order_queue(node))
+		cpu_relax();
+
+	return 0; /* we lied; we didn't wait, go do so now */
+}
+
+static inline bool cna_try_clear_tail(struct qspinlock *lock, u32 val,
+				      struct mcs_spinlock *node)
+{
+	struct mcs_spinlock *head_2nd, *tail_2nd;
+	u32 new;
+
+	/* If the secondary queue is empty, do what MCS does. */
+	if (cna_secondary_empty(node))
+		return __try_clear_tail(lock, val, node);
+
+	/*
+	 * Try to update the tail value to the last node in the secondary
+	 * queue. If successful, pass the MCS lock to the first waiter in the
+	 * secondary queue. Doing those two actions effectively moves all
+	 * nodes from the secondary queue into the primary one.
+	 */
+	tail_2nd = decode_tail(node->locked);
+	head_2nd = tail_2nd->next;
+	new = ((struct cna_node *)tail_2nd)->encoded_tail + _Q_LOCKED_VAL;
+
+	if (atomic_try_cmpxchg_relaxed(&lock->val, &val, new)) {
+		/*
+		 * Try to reset @next in tail_2nd to NULL, but no need to check
+		 * the result - if it failed, a new successor has updated it.
+		 */
+		cmpxchg_relaxed(&tail_2nd->next, head_2nd, NULL);
+		arch_mcs_lock_handoff(&head_2nd->locked, 1);
+		return true;
+	}
+
+	return false;
+}
+
+static inline void cna_lock_handoff(struct mcs_spinlock *node,
+				    struct mcs_spinlock *next)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+	struct cna_node *cn_next;
+	u32 val = 1;
+
+	/* Nothing was reordered, this is a plain MCS handoff. */
+	if (cna_secondary_empty(node)) {
+		arch_mcs_lock_handoff(&next->locked, 1);
+		return;
+	}
+
+	/*
+	 * cna_order_queue() may have moved the waiter the caller saw behind
+	 * us to the secondary queue; reload @next.
+	 */
+	next = node->next;
+
+	if (cn->handoffs < cna_handoff_threshold) {
+		/*
+		 * Preserve the secondary queue and pass on the domain of the
+		 * primary queue, to maintain the preference even if the next
+		 * waiter runs on a different domain.
+		 */
+		val = node->locked;
+		cn_next = (struct cna_node *)next;
+		cn_next->domain = cn->domain;
+		cn_next->handoffs = cn->handoffs + 1;
+	} else {
+		/*
+		 * Splice the secondary queue in front of the primary queue and
+		 * pass the lock to the longest waiting remote waiter.
+		 */
+		struct mcs_spinlock *tail_2nd = decode_tail(node->locked);
+
+		lockevent_inc(lock_cna_flush);
+		next = tail_2nd->next;
+		tail_2nd->next = node->next;
+	}
+
+	arch_mcs_lock_handoff(&next->locked, val);
+}
+
+/*
+ * The cluster masks of the secondary CPUs are only filled in as they come
+ * online, after cna_init(), but the cluster ids are parsed from the firmware
+ * tables before. Cluster ids need not be unique across nodes, hence the node
+ * in the upper half.
+ */
+static u32 __init cna_cpu_domain(int cpu)
+{
+	int cluster = topology_cluster_id(cpu);
+
+	if (cna_mode == CNA_MODE_CLUSTER && cluster >= 0)
+		return ((u32)cpu_to_node(cpu) << 16) | (cluster & 0xffff);
+
+	return cpu_to_node(cpu);
+}
+
+/*
+ * "numa_spinlock=node" or "numa_spinlock=cluster" enables the NUMA-aware
+ * slowpath, "numa_spinlock=off" (the default) keeps the native one.
+ */
+static int __init numa_spinlock_setup(char *str)
+{
+	if (!str)
+		return -EINVAL;
+
+	if (!strcmp(str, "node"))
+		cna_mode = CNA_MODE_NODE;
+	else if (!strcmp(str, "cluster"))
+		cna_mode = CNA_MODE_CLUSTER;
+	else if (!strcmp(str, "off"))
+		cna_mode = CNA_MODE_OFF;
+	else
+		return -EINVAL;
+
+	return 0;
+}
+early_param("numa_spinlock", numa_spinlock_setup);
+
+static int __init numa_spinlock_threshold_setup(char *str)
+{
+	unsigned int threshold;
+
+	if (kstrtouint(str, 0, &threshold) || !threshold)
+		return -EINVAL;
+
+	cna_handoff_threshold = threshold;
+	return 0;
+}
+early_param("numa_spinlock_threshold", numa_spinlock_threshold_setup);
+
+static int __init cna_init(void)
+{
+	int cpu, i;
+
+	BUILD_BUG_ON(sizeof(struct cna_node) > sizeof(struct qnode));
+
+	if (cna_mode == CNA_MODE_OFF)
+		return 0;
+
+	for_each_possible_cpu(cpu) {
+		for (i = 0; i < MAX_NODES; i++) {
+			struct cna_node *cn;
+
+			cn = (struct cna_node *)per_cpu_ptr(&qnodes[i].mcs, cpu);
+
+			cn->real_domain = cna_cpu_domain(cpu);
+			cn->encoded_tail = encode_tail(cpu, i);
+		}
+	}
+
+	static_branch_enable(&cna_spinlock_enabled);
+	pr_info("Enabling CNA spinlock (%s, handoff threshold %u)\n",
+		cna_mode == CNA_MODE_CLUSTER ? "cluster" : "node",
+		cna_handoff_threshold);
+
+	return 0;
+}
+early_initcall(cna_init);
@@ -25,12 +25,14 @@
 #include <linux/sched/signal.h>
 #include <linux/sched/clock.h>
 #include <linux/export.h>
+#include <linux/moduleparam.h>
 #include <linux/rwsem.h>
 #include <linux/atomic.h>
 #include <trace/events/lock.h>
 
 #ifndef CONFIG_PREEMPT_RT
 #include "lock_events.h"
+#include "lock_contention.h"
 
 /*
  * The least significant 2 bits of the owner value has the following
@@ -361,6 +363,23 @@ enum rwsem_wake_type {
  */
 #define RWSEM_WAIT_TIMEOUT	DIV_ROUND_UP(HZ, 250)
 
+/*
+ * The handoff timeout can be tuned through
+ * /sys/module/rwsem/parameters/handoff_timeout_ms. A longer timeout allows
+ * more lock stealing, and so fewer sleep/wakeup cycles, at the expense of
+ * the latency of the waiters at the front of the queue. 0 selects the
+ * default above.
+ */
+static unsigned int rwsem_handoff_timeout_ms;
+module_param_named(handoff_timeout_ms, rwsem_handoff_timeout_ms, uint, 0644);
+
+static inline unsigned long rwsem_wait_timeout(void)
+{
+	unsigned int ms = READ_ONCE(rwsem_handoff_timeout_ms);
+
+	return ms ? msecs_to_jiffies(ms) : RWSEM_WAIT_TIMEOUT;
+}
+
 /*
  * Magic number to batch-wakeup waiting readers, even when writers are
  * also present in the queue. This both limits the amount of work the
@@ -943,6 +962,86 @@ static bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 	return taken;
 }
 
+/*
+ * Reader optimistic spinning
+ *
+ * A reader that enters the slowpath because a writer owns the rwsem has
+ * already added its RWSEM_READER_BIAS to the count, so it gets the read lock
+ * as soon as the writer releases it, unless a handoff is pending. Rather
+ * than queueing and sleeping, it can spin until that happens for as long as
+ * the writer is running on a CPU, bounded by reader_spin_max_us. Readers
+ * don't compete with each other for the lock, so no OSQ is needed.
+ *
+ * This is disabled by default and is enabled through
+ * /sys/module/rwsem/parameters/reader_spin.
+ */
+static bool rwsem_reader_spin;
+module_param_named(reader_spin, rwsem_reader_spin, bool, 0644);
+
+static unsigned int rwsem_reader_spin_max_us = 25;
+module_param_named(reader_spin_max_us, rwsem_reader_spin_max_us, uint, 0644);
+
+/*
+ * Returns true, with the count observed at that time in @cntp, if the
+ * writer went away and the read lock has been acquired.
+ */
+static bool rwsem_reader_optimistic_spin(struct rw_semaphore *sem, long *cntp)
+{
+	enum owner_state owner_state;
+	bool taken = false;
+	u64 deadline;
+	long count;
+	int loop = 0;
+
+	if ((*cntp & (RWSEM_WRITER_LOCKED | RWSEM_FLAG_HANDOFF)) !=
+	    RWSEM_WRITER_LOCKED)
+		return false;
+
+	if (!READ_ONCE(rwsem_reader_spin) || !rwsem_can_spin_on_owner(sem))
+		return false;
+
+	preempt_disable();
+	deadline = sched_clock() +
+		   (u64)READ_ONCE(rwsem_reader_spin_max_us) * NSEC_PER_USEC;
+
+	for (;;) {
+		owner_state = rwsem_spin_on_owner(sem);
+
+		count = atomic_long_read(&sem->count);
+		if (!(count & (RWSEM_WRITER_LOCKED | RWSEM_FLAG_HANDOFF))) {
+			taken = true;
+			break;
+		}
+
+		/*
+		 * Stop if a waiter asked for a handoff, or if the lock isn't
+		 * owned by a running writer. A NULL owner is a writer that is
+		 * just acquiring or releasing the lock.
+		 */
+		if ((count & RWSEM_FLAG_HANDOFF) ||
+		    !(owner_state & (OWNER_WRITER | OWNER_NULL)))
+			break;
+
+		if (need_resched())
+			break;
+
+		/* As in rwsem_optimistic_spin(), check the clock every 16 loops */
+		if (!(++loop & 0xf) && (sched_clock() > deadline))
+			break;
+
+		cpu_relax();
+	}
+	preempt_enable();
+
+	if (taken) {
+		/* Provide lock ACQUIRE */
+		smp_acquire__after_ctrl_dep();
+		*cntp = count;
+	}
+	lockevent_cond_inc(rwsem_opt_rlock, taken);
+	return taken;
+}
+
 /*
  * Clear the owner's RWSEM_NONSPINNABLE bit if it is set. This should
  * only be called when the reader count reaches 0.
@@ -964,6 +1063,12 @@ static inline bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 	return false;
 }
 
+static inline bool rwsem_reader_optimistic_spin(struct rw_semaphore *sem,
+						long *cntp)
+{
+	return false;
+}
+
 static inline void clear_nonspinnable(struct rw_semaphore *sem) { }
 
 static inline enum owner_state
@@ -1008,6 +1113,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 	long rcnt = (count >> RWSEM_READER_SHIFT);
 	struct rwsem_waiter waiter;
 	DEFINE_WAKE_Q(wake_q);
+	u64 wait_start;
 
 	/*
 	 * To prevent a constant stream of readers from starving a sleeping
@@ -1019,9 +1125,12 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 		goto queue;
 
 	/*
-	 * Reader optimistic lock stealing.
+	 * Reader optimistic lock stealing, either right away or after
+	 * spinning on a running writer.
 	 */
-	if (!(count & (RWSEM_WRITER_LOCKED | RWSEM_FLAG_HANDOFF))) {
+	if (!(count & (RWSEM_WRITER_LOCKED | RWSEM_FLAG_HANDOFF)) ||
+	    rwsem_reader_optimistic_spin(sem, &count)) {
+		rcnt = count >> RWSEM_READER_SHIFT;
 		rwsem_set_reader_owned(sem);
 		lockevent_inc(rwsem_rlock_steal);
 
@@ -1043,7 +1152,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 queue:
 	waiter.task = current;
 	waiter.type = RWSEM_WAITING_FOR_READ;
-	waiter.timeout = jiffies + RWSEM_WAIT_TIMEOUT;
+	waiter.timeout = jiffies + rwsem_wait_timeout();
 	waiter.handoff_set = false;
 
 	raw_spin_lock_irq(&sem->wait_lock);
@@ -1075,6 +1184,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 	if (!wake_q_empty(&wake_q))
 		wake_up_q(&wake_q);
 
+	wait_start = lock_contention_start();
 	trace_contention_begin(sem, LCB_F_READ);
 
 	/* wait to be given the lock */
@@ -1099,6 +1209,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 	__set_current_state(TASK_RUNNING);
 	lockevent_inc(rwsem_rlock);
 	trace_contention_end(sem, 0);
+	lock_contention_end(sem, 0, LOCK_CONTENTION_RWSEM_READ, wait_start);
 	return sem;
 
 out_nolock:
@@ -1106,6 +1217,7 @@ rwsem_down_read_slowpath(struct rw_semaphore *sem, long count, unsigned int stat
 	__set_current_state(TASK_RUNNING);
 	lockevent_inc(rwsem_rlock_fail);
 	trace_contention_end(sem, -EINTR);
+	lock_contention_end(sem, 0, LOCK_CONTENTION_RWSEM_READ, wait_start);
 	return ERR_PTR(-EINTR);
 }
 
@@ -1117,6 +1229,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 {
 	struct rwsem_waiter waiter;
 	DEFINE_WAKE_Q(wake_q);
+	u64 wait_start;
 
 	/* do optimistic spinning and steal lock if possible */
 	if (rwsem_can_spin_on_owner(sem) && rwsem_optimistic_spin(sem)) {
@@ -1130,7 +1243,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	 */
 	waiter.task = current;
 	waiter.type = RWSEM_WAITING_FOR_WRITE;
-	waiter.timeout = jiffies + RWSEM_WAIT_TIMEOUT;
+	waiter.timeout = jiffies + rwsem_wait_timeout();
 	waiter.handoff_set = false;
 
 	raw_spin_lock_irq(&sem->wait_lock);
@@ -1155,6 +1268,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 
 	/* wait until we successfully acquire the lock */
 	set_current_state(state);
+	wait_start = lock_contention_start();
 	trace_contention_begin(sem, LCB_F_WRITE);
 
 	for (;;) {
@@ -1197,6 +1311,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	raw_spin_unlock_irq(&sem->wait_lock);
 	lockevent_inc(rwsem_wlock);
 	trace_contention_end(sem, 0);
+	lock_contention_end(sem, 0, LOCK_CONTENTION_RWSEM_WRITE, wait_start);
 	return sem;
 
 out_nolock:
@@ -1205,6 +1320,7 @@ rwsem_down_write_slowpath(struct rw_semaphore *sem, int state)
 	rwsem_del_wake_waiter(sem, &waiter, &wake_q);
 	lockevent_inc(rwsem_wlock_fail);
 	trace_contention_end(sem, -EINTR);
+	lock_contention_end(sem, 0, LOCK_CONTENTION_RWSEM_WRITE, wait_start);
 	return ERR_PTR(-EINTR);
 }
 
@@ -9,6 +9,7 @@
 #include <linux/kallsyms.h>
 #include <linux/buildid.h>
 #include <linux/bsearch.h>
+#include <linux/sort.h>
 #include "internal.h"
 
 /* Lookup exported symbol in given range of kernel_symbols */
@@ -140,6 +141,11 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	/* Note add_kallsyms() computes strtab_size as core_typeoffs - stroffs */
 	info->core_typeoffs = mod->data_layout.size;
 	mod->data_layout.size += ndst * sizeof(char);
+	/* And the name index for find_kallsyms_symbol_value() */
+	info->core_sortoffs = ALIGN(mod->data_layout.size,
+				    __alignof__(unsigned int));
+	mod->data_layout.size = info->core_sortoffs +
+				ndst * sizeof(unsigned int);
 	mod->data_layout.size = strict_align(mod->data_layout.size);
 
 	/* Put string table section at end of init part of module. */
@@ -158,6 +164,24 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	mod->init_layout.size = strict_align(mod->init_layout.size);
 }
 
+static const char *kallsyms_symbol_name(struct mod_kallsyms *kallsyms,
+					unsigned int symnum);
+
+/* Order by name, and by symtab index among symbols of the same name */
+static int cmp_kallsyms_sorted(const void *a, const void *b, const void *priv)
+{
+	struct mod_kallsyms *kallsyms = (struct mod_kallsyms *)priv;
+	unsigned int ia = *(const unsigned int *)a;
+	unsigned int ib = *(const unsigned int *)b;
+	int ret;
+
+	ret = strcmp(kallsyms_symbol_name(kallsyms, ia),
+		     kallsyms_symbol_name(kallsyms, ib));
+	if (ret)
+		return ret;
+	return ia < ib ? -1 : ia > ib;
+}
+
 /*
  * We use the full symtab and strtab which layout_symtab arranged to
  * be appended to the init section.  Later we switch to the cut-down
@@ -184,6 +208,7 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	rcu_dereference(mod->kallsyms)->strtab =
 		(void *)info->sechdrs[info->index.str].sh_addr;
 	rcu_dereference(mod->kallsyms)->typetab = mod->init_layout.base + info->init_typeoffs;
+	rcu_dereference(mod->kallsyms)->sorted = NULL;
 
 	/*
 	 * Now populate the cut down core kallsyms for after init
@@ -216,6 +241,16 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	}
 	rcu_read_unlock();
 	mod->core_kallsyms.num_symtab = ndst;
+
+	/*
+	 * Looking up a symbol by name bisects this index once the module
+	 * runs on the core symbols, instead of scanning the whole symtab.
+	 */
+	mod->core_kallsyms.sorted = mod->data_layout.base + info->core_sortoffs;
+	for (i = 0; i < ndst; i++)
+		mod->core_kallsyms.sorted[i] = i;
+	sort_r(mod->core_kallsyms.sorted, ndst, sizeof(unsigned int),
+	       cmp_kallsyms_sorted, NULL, &mod->core_kallsyms);
 }
 
 #if IS_ENABLED(CONFIG_STACKTRACE_BUILD_ID)
@@ -444,14 +479,39 @@ int module_get_kallsym(unsigned int symnum, unsigned long *value, char *type,
 /* Given a module and name of symbol, find and return the symbol's value */
 unsigned long find_kallsyms_symbol_value(struct module *mod, const char *name)
 {
-	unsigned int i;
+	unsigned int i, lo, hi, mid;
 	struct mod_kallsyms *kallsyms = rcu_dereference_sched(mod->kallsyms);
+	const Elf_Sym *sym;
 
-	for (i = 0; i < kallsyms->num_symtab; i++) {
-		const Elf_Sym *sym = &kallsyms->symtab[i];
+	if (!kallsyms->sorted) {
+		for (i = 0; i < kallsyms->num_symtab; i++) {
+			sym = &kallsyms->symtab[i];
+
+			if (strcmp(name, kallsyms_symbol_name(kallsyms, i)) == 0 &&
+			    sym->st_shndx != SHN_UNDEF)
+				return kallsyms_symbol_value(sym);
+		}
+		return 0;
+	}
 
-		if (strcmp(name, kallsyms_symbol_name(kallsyms, i)) == 0 &&
-		    sym->st_shndx != SHN_UNDEF)
+	/* Find the first entry of @name, then the first defined one */
+	lo = 0;
+	hi = kallsyms->num_symtab;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(kallsyms_symbol_name(kallsyms,
+						kallsyms->sorted[mid]), name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < kallsyms->num_symtab; lo++) {
+		i = kallsyms->sorted[lo];
+		if (strcmp(name, kallsyms_symbol_name(kallsyms, i)) != 0)
+			break;
+		sym = &kallsyms->symtab[i];
+		if (sym->st_shndx != SHN_UNDEF)
 			return kallsyms_symbol_value(sym);
 	}
 	return 0;
@@ -106,14 +106,58 @@ static void em_debug_create_pd(struct device *dev) {}
 static void em_debug_remove_pd(struct device *dev) {}
 #endif
 
+/*
+ * Compute the cost of each performance state of @table from its power and
+ * frequency, or ask the driver for it for artificial EMs, and mark the
+ * inefficient states.
+ */
+static int em_compute_costs(struct device *dev, struct em_perf_state *table,
+			    int nr_states, struct em_data_callback *cb,
+			    unsigned long flags)
+{
+	unsigned long prev_cost = ULONG_MAX;
+	int i, ret;
+	u64 fmax;
+
+	fmax = (u64) table[nr_states - 1].frequency;
+	for (i = nr_states - 1; i >= 0; i--) {
+		unsigned long power_res, cost;
+
+		if (flags & EM_PERF_DOMAIN_ARTIFICIAL) {
+			ret = cb->get_cost(dev, table[i].frequency, &cost);
+			if (ret || !cost || cost > EM_MAX_POWER) {
+				dev_err(dev, "EM: invalid cost %lu %d\n",
+					cost, ret);
+				return -EINVAL;
+			}
+		} else {
+			power_res = table[i].power;
+			cost = div64_u64(fmax * power_res, table[i].frequency);
+		}
+
+		table[i].cost = cost;
+
+		if (table[i].cost >= prev_cost) {
+			table[i].flags = EM_PERF_STATE_INEFFICIENT;
+			dev_dbg(dev, "EM: OPP:%lu is inefficient\n",
+				table[i].frequency);
+		} else {
+			table[i].flags = 0;
+			prev_cost = table[i].cost;
+		}
+	}
+
+	return 0;
+}
+
 static int em_create_perf_table(struct device *dev, struct em_perf_domain *pd,
 				int nr_states, struct em_data_callback *cb,
 				unsigned long flags)
 {
-	unsigned long power, freq, prev_freq = 0, prev_cost = ULONG_MAX;
+	unsigned long power, freq, prev_freq = 0;
+	struct em_perf_table *em_table;
 	struct em_perf_state *table;
 	int i, ret;
-	u64 fmax;
 
 	table = kcalloc(nr_states, sizeof(*table), GFP_KERNEL);
 	if (!table)
@@ -157,35 +201,19 @@ static int em_create_perf_table(struct device *dev, struct em_perf_domain *pd,
 		table[i].frequency = prev_freq = freq;
 	}
 
-	/* Compute the cost of each performance state. */
-	fmax = (u64) table[nr_states - 1].frequency;
-	for (i = nr_states - 1; i >= 0; i--) {
-		unsigned long power_res, cost;
+	if (em_compute_costs(dev, table, nr_states, cb, flags))
+		goto free_ps_table;
 
-		if (flags & EM_PERF_DOMAIN_ARTIFICIAL) {
-			ret = cb->get_cost(dev, table[i].frequency, &cost);
-			if (ret || !cost || cost > EM_MAX_POWER) {
-				dev_err(dev, "EM: invalid cost %lu %d\n",
-					cost, ret);
-				goto free_ps_table;
-			}
-		} else {
-			power_res = table[i].power;
-			cost = div64_u64(fmax * power_res, table[i].frequency);
-		}
-
-		table[i].cost = cost;
-
-		if (table[i].cost >= prev_cost) {
-			table[i].flags = EM_PERF_STATE_INEFFICIENT;
-			dev_dbg(dev, "EM: OPP:%lu is inefficient\n",
-				table[i].frequency);
-		} else {
-			prev_cost = table[i].cost;
-		}
+	/* The runtime table starts out as a copy of the registered one */
+	em_table = kmalloc(struct_size(em_table, state, nr_states), GFP_KERNEL);
+	if (!em_table) {
+		kfree(table);
+		return -ENOMEM;
 	}
+	memcpy(em_table->state, table, nr_states * sizeof(*table));
 
 	pd->table = table;
+	RCU_INIT_POINTER(pd->em_table, em_table);
 	pd->nr_perf_states = nr_states;
 
 	return 0;
@@ -433,9 +461,125 @@ void em_dev_unregister_perf_domain(struct device *dev)
 	mutex_lock(&em_pd_mutex);
 	em_debug_remove_pd(dev);
 
+	kfree_rcu(rcu_dereference_protected(dev->em_pd->em_table,
+					    lockdep_is_held(&em_pd_mutex)), rcu);
 	kfree(dev->em_pd->table);
 	kfree(dev->em_pd);
 	dev->em_pd = NULL;
 	mutex_unlock(&em_pd_mutex);
 }
 EXPORT_SYMBOL_GPL(em_dev_unregister_perf_domain);
+
+/**
+ * em_table_alloc() - Allocate a copy of the runtime table of a perf. domain
+ * @pd		: Performance domain whose table is to be copied
+ *
+ * The copy is meant to be modified and then installed with
+ * em_dev_update_perf_domain(). If it isn't installed, it must be released
+ * with em_table_free().
+ *
+ * Return: the new table, or NULL on allocation failure.
+ */
+struct em_perf_table *em_table_alloc(struct em_perf_domain *pd)
+{
+	struct em_perf_table *table;
+
+	table = kmalloc(struct_size(table, state, pd->nr_perf_states),
+			GFP_KERNEL);
+	if (!table)
+		return NULL;
+
+	rcu_read_lock();
+	memcpy(table->state, rcu_dereference(pd->em_table)->state,
+	       pd->nr_perf_states * sizeof(*table->state));
+	rcu_read_unlock();
+
+	return table;
+}
+EXPORT_SYMBOL_GPL(em_table_alloc);
+
+/**
+ * em_table_free() - Free a table allocated by em_table_alloc()
+ * @table	: Table which has not been installed
+ */
+void em_table_free(struct em_perf_table *table)
+{
+	kfree(table);
+}
+EXPORT_SYMBOL_GPL(em_table_free);
+
+/**
+ * em_dev_update_perf_domain() - Update the runtime Energy Model of a device
+ * @dev		: Device for which the EM is registered
+ * @new_table	: Table obtained from em_table_alloc() with updated power
+ *		values
+ *
+ * Replace the table used for energy estimation, e.g. with power values
+ * measured by a power meter, which vary with temperature and silicon. Only
+ * the power of the performance states may change: the costs and
+ * inefficiencies are recomputed from it, while the frequencies must be
+ * left as they are. The table registered with em_dev_register_perf_domain()
+ * is kept unchanged. Readers under RCU see either the old or the new table,
+ * and the old one is freed after a grace period.
+ *
+ * On success the EM takes ownership of @new_table, otherwise the caller
+ * still has to free it.
+ *
+ * Return 0 on success
+ */
+int em_dev_update_perf_domain(struct device *dev,
+			      struct em_perf_table *new_table)
+{
+	struct em_perf_table *old_table;
+	struct em_perf_domain *pd;
+	unsigned long power;
+	int i, ret = 0;
+
+	if (IS_ERR_OR_NULL(dev) || !new_table)
+		return -EINVAL;
+
+	mutex_lock(&em_pd_mutex);
+
+	pd = dev->em_pd;
+	if (!pd) {
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	/* Costs of artificial EMs don't derive from the power values */
+	if (em_is_artificial(pd)) {
+		dev_err(dev, "EM: cannot update artificial EM\n");
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	for (i = 0; i < pd->nr_perf_states; i++) {
+		if (new_table->state[i].frequency != pd->table[i].frequency) {
+			dev_err(dev, "EM: frequency mismatch: %lu\n",
+				new_table->state[i].frequency);
+			ret = -EINVAL;
+			goto unlock;
+		}
+
+		power = new_table->state[i].power;
+		if (!power || power > EM_MAX_POWER) {
+			dev_err(dev, "EM: invalid power: %lu\n", power);
+			ret = -EINVAL;
+			goto unlock;
+		}
+	}
+
+	ret = em_compute_costs(dev, new_table->state, pd->nr_perf_states, NULL,
+			       pd->flags);
+	if (ret)
+		goto unlock;
+
+	old_table = rcu_replace_pointer(pd->em_table, new_table,
+					lockdep_is_held(&em_pd_mutex));
+	kfree_rcu(old_table, rcu);
+
+unlock:
+	mutex_unlock(&em_pd_mutex);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(em_dev_update_perf_domain);
@@ -37,6 +37,7 @@
 
 
 static int nocompress;
+static int hib_zstd;
 static int noresume;
 static int nohibernate;
 static int resume_wait;
@@ -759,10 +760,13 @@ int hibernate(void)
 
 		if (hibernation_mode == HIBERNATION_PLATFORM)
 			flags |= SF_PLATFORM_MODE;
-		if (nocompress)
+		if (nocompress) {
 			flags |= SF_NOCOMPRESS_MODE;
-		else
+		} else {
 		        flags |= SF_CRC32_MODE;
+			if (hib_zstd)
+				flags |= SF_ZSTD_MODE;
+		}
 
 		pm_pr_dbg("Writing hibernation image.\n");
 		error = swsusp_write(flags);
@@ -1311,6 +1315,9 @@ static int __init hibernate_setup(char *str)
 		noresume = 1;
 	} else if (!strncmp(str, "nocompress", 10)) {
 		nocompress = 1;
+	} else if (IS_ENABLED(CONFIG_HIBERNATION_COMP_ZSTD)
+		   && !strncmp(str, "zstd", 4)) {
+		hib_zstd = 1;
 	} else if (!strncmp(str, "no", 2)) {
 		noresume = 1;
 		nohibernate = 1;
@@ -171,6 +171,7 @@ extern int swsusp_swap_in_use(void);
 #define SF_NOCOMPRESS_MODE	2
 #define SF_CRC32_MODE	        4
 #define SF_HW_SIG		8
+#define SF_ZSTD_MODE		16
 
 /* kernel/power/hibernate.c */
 extern int swsusp_check(void);
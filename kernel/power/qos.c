@@ -15,7 +15,8 @@
  * or through a built-in notification mechanism.
  *
  * In addition to the basic functionality, more specific interfaces for managing
- * global CPU latency QoS requests and frequency QoS requests are provided.
+ * global and per-CPU CPU latency QoS requests and frequency QoS requests are
+ * provided.
  */
 
 /*#define DEBUG*/
@@ -34,6 +35,9 @@
 #include <linux/kernel.h>
 #include <linux/debugfs.h>
 #include <linux/seq_file.h>
+#include <linux/percpu.h>
+#include <linux/sched/idle.h>
+#include <linux/topology.h>
 
 #include <linux/uaccess.h>
 #include <linux/export.h>
@@ -330,6 +334,180 @@ void cpu_latency_qos_remove_request(struct pm_qos_request *req)
 }
 EXPORT_SYMBOL_GPL(cpu_latency_qos_remove_request);
 
+/*
+ * Per-CPU latency QoS constraints, which only restrict the idle states of the
+ * CPUs they are requested for.
+ */
+static DEFINE_PER_CPU(struct pm_qos_constraints, cpu_latency_constraints_pcpu);
+
+static int __init cpu_latency_qos_pcpu_init(void)
+{
+	struct pm_qos_constraints *c;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		c = per_cpu_ptr(&cpu_latency_constraints_pcpu, cpu);
+		plist_head_init(&c->list);
+		c->target_value = PM_QOS_CPU_LATENCY_DEFAULT_VALUE;
+		c->default_value = PM_QOS_CPU_LATENCY_DEFAULT_VALUE;
+		c->no_constraint_value = PM_QOS_CPU_LATENCY_DEFAULT_VALUE;
+		c->type = PM_QOS_MIN;
+	}
+
+	return 0;
+}
+early_initcall(cpu_latency_qos_pcpu_init);
+
+/**
+ * cpu_latency_qos_cpu_limit - Return current CPU latency QoS limit of a CPU.
+ * @cpu: Target CPU.
+ *
+ * Return: the tighter of the system-wide limit and the limit requested for
+ * @cpu with cpus_latency_qos_add_request().
+ */
+s32 cpu_latency_qos_cpu_limit(int cpu)
+{
+	s32 cpu_limit = pm_qos_read_value(per_cpu_ptr(&cpu_latency_constraints_pcpu,
+						      cpu));
+
+	return min(cpu_limit, cpu_latency_qos_limit());
+}
+
+/**
+ * cpus_latency_qos_request_active - Check the given per-CPU PM QoS request.
+ * @req: PM QoS request to check.
+ */
+bool cpus_latency_qos_request_active(struct cpus_latency_qos_request *req)
+{
+	return req->reqs != NULL;
+}
+EXPORT_SYMBOL_GPL(cpus_latency_qos_request_active);
+
+static void cpus_latency_qos_apply(struct cpus_latency_qos_request *req,
+				   enum pm_qos_req_action action, s32 value)
+{
+	struct pm_qos_request *r;
+	int cpu;
+
+	for_each_cpu(cpu, req->cpus) {
+		r = per_cpu_ptr(req->reqs, cpu);
+		/* Only the CPU whose constraint got tighter needs to react */
+		if (pm_qos_update_target(r->qos, &r->node, action, value) > 0)
+			wake_up_if_idle(cpu);
+	}
+}
+
+/**
+ * cpus_latency_qos_add_request - Add new per-CPU CPU latency QoS request.
+ * @req: Pointer to a preallocated handle.
+ * @cpus: CPUs the request applies to.
+ * @value: Requested constraint value.
+ *
+ * Unlike cpu_latency_qos_add_request(), the constraint only keeps the CPUs in
+ * @cpus out of idle states with a larger exit latency, so that a driver can
+ * restrict the CPUs serving its interrupts and leave the others alone. It is
+ * honored by the cpuidle governors through cpu_latency_qos_cpu_limit().
+ *
+ * This function may sleep. Updating the request does not.
+ *
+ * Return: 0 on success or a negative error code.
+ */
+int cpus_latency_qos_add_request(struct cpus_latency_qos_request *req,
+				 const struct cpumask *cpus, s32 value)
+{
+	int cpu;
+
+	if (!req || cpumask_empty(cpus))
+		return -EINVAL;
+
+	if (cpus_latency_qos_request_active(req)) {
+		WARN(1, KERN_ERR "%s called for already added request\n", __func__);
+		return -EINVAL;
+	}
+
+	if (!zalloc_cpumask_var(&req->cpus, GFP_KERNEL))
+		return -ENOMEM;
+
+	req->reqs = alloc_percpu(struct pm_qos_request);
+	if (!req->reqs) {
+		free_cpumask_var(req->cpus);
+		return -ENOMEM;
+	}
+
+	cpumask_and(req->cpus, cpus, cpu_possible_mask);
+	for_each_cpu(cpu, req->cpus)
+		per_cpu_ptr(req->reqs, cpu)->qos =
+			per_cpu_ptr(&cpu_latency_constraints_pcpu, cpu);
+
+	cpus_latency_qos_apply(req, PM_QOS_ADD_REQ, value);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(cpus_latency_qos_add_request);
+
+/**
+ * cpu_cluster_latency_qos_add_request - Add new CPU latency QoS request for
+ *					 the cluster of a CPU.
+ * @req: Pointer to a preallocated handle.
+ * @cpu: A CPU of the target cluster.
+ * @value: Requested constraint value.
+ *
+ * Like cpus_latency_qos_add_request() for all CPUs sharing the cluster of
+ * @cpu, as reported by the architecture topology code.
+ */
+int cpu_cluster_latency_qos_add_request(struct cpus_latency_qos_request *req,
+					int cpu, s32 value)
+{
+	return cpus_latency_qos_add_request(req, topology_cluster_cpumask(cpu),
+					    value);
+}
+EXPORT_SYMBOL_GPL(cpu_cluster_latency_qos_add_request);
+
+/**
+ * cpus_latency_qos_update_request - Modify existing per-CPU CPU latency QoS
+ *				     request.
+ * @req : QoS request to update.
+ * @new_value: New requested constraint value.
+ */
+void cpus_latency_qos_update_request(struct cpus_latency_qos_request *req,
+				     s32 new_value)
+{
+	if (!req)
+		return;
+
+	if (!cpus_latency_qos_request_active(req)) {
+		WARN(1, KERN_ERR "%s called for unknown object\n", __func__);
+		return;
+	}
+
+	cpus_latency_qos_apply(req, PM_QOS_UPDATE_REQ, new_value);
+}
+EXPORT_SYMBOL_GPL(cpus_latency_qos_update_request);
+
+/**
+ * cpus_latency_qos_remove_request - Remove existing per-CPU CPU latency QoS
+ *				     request.
+ * @req: QoS request to remove.
+ *
+ * This function may sleep.
+ */
+void cpus_latency_qos_remove_request(struct cpus_latency_qos_request *req)
+{
+	if (!req)
+		return;
+
+	if (!cpus_latency_qos_request_active(req)) {
+		WARN(1, KERN_ERR "%s called for unknown object\n", __func__);
+		return;
+	}
+
+	cpus_latency_qos_apply(req, PM_QOS_REMOVE_REQ, PM_QOS_DEFAULT_VALUE);
+	free_percpu(req->reqs);
+	free_cpumask_var(req->cpus);
+	memset(req, 0, sizeof(*req));
+}
+EXPORT_SYMBOL_GPL(cpus_latency_qos_remove_request);
+
 /* User space interface to the CPU latency QoS via misc device. */
 
 static int cpu_latency_qos_open(struct inode *inode, struct file *filp)
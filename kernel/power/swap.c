@@ -24,6 +24,7 @@
 #include <linux/pm.h>
 #include <linux/slab.h>
 #include <linux/lzo.h>
+#include <linux/zstd.h>
 #include <linux/vmalloc.h>
 #include <linux/cpumask.h>
 #include <linux/atomic.h>
@@ -528,6 +529,16 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 /* Maximum number of threads for compression/decompression. */
 #define LZO_THREADS	3
 
+/*
+ * zstd needs several times the CPU time of LZO for the same data, so it gets
+ * more threads to keep up with the swap device.
+ */
+#define ZSTD_THREADS	8
+#define CMP_THREADS	ZSTD_THREADS
+
+/* zstd compression level, favouring speed over ratio. */
+#define HIB_ZSTD_LEVEL	1
+
 /* Minimum/maximum number of pages for read buffering. */
 #define LZO_MIN_RD_PAGES	1024
 #define LZO_MAX_RD_PAGES	8192
@@ -592,8 +603,8 @@ struct crc_data {
 	wait_queue_head_t go;                     /* start crc update */
 	wait_queue_head_t done;                   /* crc update done */
 	u32 *crc32;                               /* points to handle's crc32 */
-	size_t *unc_len[LZO_THREADS];             /* uncompressed lengths */
-	unsigned char *unc[LZO_THREADS];          /* uncompressed data */
+	size_t *unc_len[CMP_THREADS];             /* uncompressed lengths */
+	unsigned char *unc[CMP_THREADS];          /* uncompressed data */
 };
 
 /**
@@ -624,7 +635,7 @@ static int crc32_threadfn(void *data)
 	return 0;
 }
 /**
- * Structure used for LZO data compression.
+ * Structure used for LZO or zstd data compression.
  */
 struct cmp_data {
 	struct task_struct *thr;                  /* thread */
@@ -638,12 +649,70 @@ struct cmp_data {
 	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
 	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
 	unsigned char wrk[LZO1X_1_MEM_COMPRESS];  /* compression workspace */
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+	zstd_parameters params;                   /* zstd parameters */
+	zstd_cctx *cctx;                          /* zstd context, NULL for LZO */
+	void *zwrk;                               /* zstd workspace */
+#endif
 };
 
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+static int hib_zstd_init_cmp(struct cmp_data *d)
+{
+	size_t size;
+
+	d->params = zstd_get_params(HIB_ZSTD_LEVEL, LZO_UNC_SIZE);
+	size = zstd_cctx_workspace_bound(&d->params.cParams);
+	d->zwrk = vmalloc(size);
+	if (!d->zwrk)
+		return -ENOMEM;
+
+	d->cctx = zstd_init_cctx(d->zwrk, size);
+	return d->cctx ? 0 : -EINVAL;
+}
+
+static void hib_zstd_free_cmp(struct cmp_data *d)
+{
+	vfree(d->zwrk);
+}
+
+static int hib_compress(struct cmp_data *d)
+{
+	size_t ret;
+
+	if (!d->cctx)
+		return lzo1x_1_compress(d->unc, d->unc_len,
+		                        d->cmp + LZO_HEADER, &d->cmp_len,
+		                        d->wrk);
+
+	ret = zstd_compress_cctx(d->cctx, d->cmp + LZO_HEADER,
+	                         LZO_CMP_SIZE - LZO_HEADER,
+	                         d->unc, d->unc_len, &d->params);
+	if (zstd_is_error(ret))
+		return -1;
+
+	d->cmp_len = ret;
+	return 0;
+}
+#else
+static int hib_zstd_init_cmp(struct cmp_data *d)
+{
+	return -EOPNOTSUPP;
+}
+
+static void hib_zstd_free_cmp(struct cmp_data *d) { }
+
+static int hib_compress(struct cmp_data *d)
+{
+	return lzo1x_1_compress(d->unc, d->unc_len,
+	                        d->cmp + LZO_HEADER, &d->cmp_len, d->wrk);
+}
+#endif
+
 /**
  * Compression function that runs in its own thread.
  */
-static int lzo_compress_threadfn(void *data)
+static int compress_threadfn(void *data)
 {
 	struct cmp_data *d = data;
 
@@ -659,9 +728,7 @@ static int lzo_compress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->ret = lzo1x_1_compress(d->unc, d->unc_len,
-		                          d->cmp + LZO_HEADER, &d->cmp_len,
-		                          d->wrk);
+		d->ret = hib_compress(d);
 		atomic_set(&d->stop, 1);
 		wake_up(&d->done);
 	}
@@ -669,14 +736,15 @@ static int lzo_compress_threadfn(void *data)
 }
 
 /**
- * save_image_lzo - Save the suspend image data compressed with LZO.
+ * save_image_compressed - Save the suspend image data compressed.
  * @handle: Swap map handle to use for saving the image.
  * @snapshot: Image to read data from.
  * @nr_to_write: Number of pages to save.
+ * @zstd: Compress with zstd rather than LZO.
  */
-static int save_image_lzo(struct swap_map_handle *handle,
-                          struct snapshot_handle *snapshot,
-                          unsigned int nr_to_write)
+static int save_image_compressed(struct swap_map_handle *handle,
+                                 struct snapshot_handle *snapshot,
+                                 unsigned int nr_to_write, bool zstd)
 {
 	unsigned int m;
 	int ret = 0;
@@ -698,18 +766,18 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	 * footprint.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, zstd ? ZSTD_THREADS : LZO_THREADS);
 
 	page = (void *)__get_free_page(GFP_NOIO | __GFP_HIGH);
 	if (!page) {
-		pr_err("Failed to allocate LZO page\n");
+		pr_err("Failed to allocate compression page\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
 
 	data = vzalloc(array_size(nr_threads, sizeof(*data)));
 	if (!data) {
-		pr_err("Failed to allocate LZO data\n");
+		pr_err("Failed to allocate compression data\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
@@ -728,7 +796,15 @@ static int save_image_lzo(struct swap_map_handle *handle,
 		init_waitqueue_head(&data[thr].go);
 		init_waitqueue_head(&data[thr].done);
 
-		data[thr].thr = kthread_run(lzo_compress_threadfn,
+		if (zstd) {
+			ret = hib_zstd_init_cmp(&data[thr]);
+			if (ret) {
+				pr_err("Cannot set up zstd compression\n");
+				goto out_clean;
+			}
+		}
+
+		data[thr].thr = kthread_run(compress_threadfn,
 		                            &data[thr],
 		                            "image_compress/%u", thr);
 		if (IS_ERR(data[thr].thr)) {
@@ -766,7 +842,8 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	 */
 	handle->reqd_free_pages = reqd_free_pages();
 
-	pr_info("Using %u thread(s) for compression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s compression\n", nr_threads,
+		zstd ? "zstd" : "LZO");
 	pr_info("Compressing and saving image data (%u pages)...\n",
 		nr_to_write);
 	m = nr_to_write / 10;
@@ -816,14 +893,14 @@ static int save_image_lzo(struct swap_map_handle *handle,
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO compression failed\n");
+				pr_err("Compression failed\n");
 				goto out_finish;
 			}
 
 			if (unlikely(!data[thr].cmp_len ||
 			             data[thr].cmp_len >
 			             lzo1x_worst_compress(data[thr].unc_len))) {
-				pr_err("Invalid LZO compressed length\n");
+				pr_err("Invalid compressed length\n");
 				ret = -1;
 				goto out_finish;
 			}
@@ -869,9 +946,11 @@ static int save_image_lzo(struct swap_map_handle *handle,
 		kfree(crc);
 	}
 	if (data) {
-		for (thr = 0; thr < nr_threads; thr++)
+		for (thr = 0; thr < nr_threads; thr++) {
 			if (data[thr].thr)
 				kthread_stop(data[thr].thr);
+			hib_zstd_free_cmp(&data[thr]);
+		}
 		vfree(data);
 	}
 	if (page) free_page((unsigned long)page);
@@ -941,7 +1020,8 @@ int swsusp_write(unsigned int flags)
 	if (!error) {
 		error = (flags & SF_NOCOMPRESS_MODE) ?
 			save_image(&handle, &snapshot, pages - 1) :
-			save_image_lzo(&handle, &snapshot, pages - 1);
+			save_image_compressed(&handle, &snapshot, pages - 1,
+					      flags & SF_ZSTD_MODE);
 	}
 out_finish:
 	error = swap_writer_finish(&handle, flags, error);
@@ -1108,7 +1188,7 @@ static int load_image(struct swap_map_handle *handle,
 }
 
 /**
- * Structure used for LZO data decompression.
+ * Structure used for LZO or zstd data decompression.
  */
 struct dec_data {
 	struct task_struct *thr;                  /* thread */
@@ -1121,12 +1201,67 @@ struct dec_data {
 	size_t cmp_len;                           /* compressed length */
 	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
 	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+	zstd_dctx *dctx;                          /* zstd context, NULL for LZO */
+	void *zwrk;                               /* zstd workspace */
+#endif
 };
 
+#ifdef CONFIG_HIBERNATION_COMP_ZSTD
+static int hib_zstd_init_dec(struct dec_data *d)
+{
+	size_t size = zstd_dctx_workspace_bound();
+
+	d->zwrk = vmalloc(size);
+	if (!d->zwrk)
+		return -ENOMEM;
+
+	d->dctx = zstd_init_dctx(d->zwrk, size);
+	return d->dctx ? 0 : -EINVAL;
+}
+
+static void hib_zstd_free_dec(struct dec_data *d)
+{
+	vfree(d->zwrk);
+}
+
+static int hib_decompress(struct dec_data *d)
+{
+	size_t ret;
+
+	d->unc_len = LZO_UNC_SIZE;
+	if (!d->dctx)
+		return lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
+		                             d->unc, &d->unc_len);
+
+	ret = zstd_decompress_dctx(d->dctx, d->unc, d->unc_len,
+	                           d->cmp + LZO_HEADER, d->cmp_len);
+	if (zstd_is_error(ret))
+		return -1;
+
+	d->unc_len = ret;
+	return 0;
+}
+#else
+static int hib_zstd_init_dec(struct dec_data *d)
+{
+	return -EOPNOTSUPP;
+}
+
+static void hib_zstd_free_dec(struct dec_data *d) { }
+
+static int hib_decompress(struct dec_data *d)
+{
+	d->unc_len = LZO_UNC_SIZE;
+	return lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
+	                             d->unc, &d->unc_len);
+}
+#endif
+
 /**
  * Decompression function that runs in its own thread.
  */
-static int lzo_decompress_threadfn(void *data)
+static int decompress_threadfn(void *data)
 {
 	struct dec_data *d = data;
 
@@ -1142,9 +1277,7 @@ static int lzo_decompress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->unc_len = LZO_UNC_SIZE;
-		d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
-		                               d->unc, &d->unc_len);
+		d->ret = hib_decompress(d);
 		if (clean_pages_on_decompress)
 			flush_icache_range((unsigned long)d->unc,
 					   (unsigned long)d->unc + d->unc_len);
@@ -1156,14 +1289,15 @@ static int lzo_decompress_threadfn(void *data)
 }
 
 /**
- * load_image_lzo - Load compressed image data and decompress them with LZO.
+ * load_image_compressed - Load compressed image data and decompress them.
  * @handle: Swap map handle to use for loading data.
  * @snapshot: Image to copy uncompressed data into.
  * @nr_to_read: Number of pages to load.
+ * @zstd: The image was compressed with zstd rather than LZO.
  */
-static int load_image_lzo(struct swap_map_handle *handle,
-                          struct snapshot_handle *snapshot,
-                          unsigned int nr_to_read)
+static int load_image_compressed(struct swap_map_handle *handle,
+                                 struct snapshot_handle *snapshot,
+                                 unsigned int nr_to_read, bool zstd)
 {
 	unsigned int m;
 	int ret = 0;
@@ -1188,18 +1322,18 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	 * footprint.
 	 */
 	nr_threads = num_online_cpus() - 1;
-	nr_threads = clamp_val(nr_threads, 1, LZO_THREADS);
+	nr_threads = clamp_val(nr_threads, 1, zstd ? ZSTD_THREADS : LZO_THREADS);
 
 	page = vmalloc(array_size(LZO_MAX_RD_PAGES, sizeof(*page)));
 	if (!page) {
-		pr_err("Failed to allocate LZO page\n");
+		pr_err("Failed to allocate compression page\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
 
 	data = vzalloc(array_size(nr_threads, sizeof(*data)));
 	if (!data) {
-		pr_err("Failed to allocate LZO data\n");
+		pr_err("Failed to allocate compression data\n");
 		ret = -ENOMEM;
 		goto out_clean;
 	}
@@ -1220,7 +1354,15 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		init_waitqueue_head(&data[thr].go);
 		init_waitqueue_head(&data[thr].done);
 
-		data[thr].thr = kthread_run(lzo_decompress_threadfn,
+		if (zstd) {
+			ret = hib_zstd_init_dec(&data[thr]);
+			if (ret) {
+				pr_err("Cannot set up zstd decompression\n");
+				goto out_clean;
+			}
+		}
+
+		data[thr].thr = kthread_run(decompress_threadfn,
 		                            &data[thr],
 		                            "image_decompress/%u", thr);
 		if (IS_ERR(data[thr].thr)) {
@@ -1272,7 +1414,7 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		if (!page[i]) {
 			if (i < LZO_CMP_PAGES) {
 				ring_size = i;
-				pr_err("Failed to allocate LZO pages\n");
+				pr_err("Failed to allocate compression pages\n");
 				ret = -ENOMEM;
 				goto out_clean;
 			} else {
@@ -1282,7 +1424,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	}
 	want = ring_size = i;
 
-	pr_info("Using %u thread(s) for decompression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s decompression\n", nr_threads,
+		zstd ? "zstd" : "LZO");
 	pr_info("Loading and decompressing image data (%u pages)...\n",
 		nr_to_read);
 	m = nr_to_read / 10;
@@ -1344,7 +1487,7 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			if (unlikely(!data[thr].cmp_len ||
 			             data[thr].cmp_len >
 			             lzo1x_worst_compress(LZO_UNC_SIZE))) {
-				pr_err("Invalid LZO compressed length\n");
+				pr_err("Invalid compressed length\n");
 				ret = -1;
 				goto out_finish;
 			}
@@ -1395,14 +1538,14 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO decompression failed\n");
+				pr_err("Decompression failed\n");
 				goto out_finish;
 			}
 
 			if (unlikely(!data[thr].unc_len ||
 			             data[thr].unc_len > LZO_UNC_SIZE ||
 			             data[thr].unc_len & (PAGE_SIZE - 1))) {
-				pr_err("Invalid LZO uncompressed length\n");
+				pr_err("Invalid uncompressed length\n");
 				ret = -1;
 				goto out_finish;
 			}
@@ -1463,9 +1606,11 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		kfree(crc);
 	}
 	if (data) {
-		for (thr = 0; thr < nr_threads; thr++)
+		for (thr = 0; thr < nr_threads; thr++) {
 			if (data[thr].thr)
 				kthread_stop(data[thr].thr);
+			hib_zstd_free_dec(&data[thr]);
+		}
 		vfree(data);
 	}
 	vfree(page);
@@ -1499,7 +1644,9 @@ int swsusp_read(unsigned int *flags_p)
 	if (!error) {
 		error = (*flags_p & SF_NOCOMPRESS_MODE) ?
 			load_image(&handle, &snapshot, header->pages - 1) :
-			load_image_lzo(&handle, &snapshot, header->pages - 1);
+			load_image_compressed(&handle, &snapshot,
+					      header->pages - 1,
+					      *flags_p & SF_ZSTD_MODE);
 	}
 	swap_reader_finish(&handle);
 end:
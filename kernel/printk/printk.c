@@ -42,6 +42,7 @@
 #include <linux/rculist.h>
 #include <linux/poll.h>
 #include <linux/irq_work.h>
+#include <linux/kthread.h>
 #include <linux/ctype.h>
 #include <linux/uio.h>
 #include <linux/sched/clock.h>
@@ -2224,6 +2225,111 @@ int vprintk_store(int facility, int level,
 	return ret;
 }
 
+/*
+ * With printk.kthread=1, printk() only stores the record and wakes a
+ * printer thread once that runs, which then feeds all consoles in its own,
+ * preemptible context. A slow console therefore no longer holds up the CPU
+ * calling printk(), which may be a hot path or hold important locks.
+ *
+ * Messages of KERN_CRIT and above are still printed directly, as is
+ * everything before the thread is started, during panic, oops and shutdown,
+ * and while the thread has not got around to a wakeup for more than
+ * PRINTK_KTHREAD_STALL: the thread may never run again on a system in
+ * trouble. The thread is off by default.
+ */
+static bool printk_kthread_enabled;
+module_param_named(kthread, printk_kthread_enabled, bool, 0444);
+
+#define PRINTK_KTHREAD_STALL	HZ
+
+static struct task_struct *printk_kthread __read_mostly;
+static DECLARE_WAIT_QUEUE_HEAD(printk_kthread_wait);
+static bool printk_kthread_work;
+static unsigned long printk_kthread_woken;
+
+static bool printk_kthread_should_print(void)
+{
+	if (!READ_ONCE(printk_kthread))
+		return false;
+
+	if (panic_in_progress() || oops_in_progress ||
+	    system_state > SYSTEM_RUNNING)
+		return false;
+
+	if (!READ_ONCE(printk_kthread_work))
+		return true;
+
+	/* a pending wakeup the thread has not picked up in time? */
+	smp_rmb();
+	return !time_after(jiffies, READ_ONCE(printk_kthread_woken) +
+				    PRINTK_KTHREAD_STALL);
+}
+
+static bool printk_is_emergency(int level, const char *fmt)
+{
+	if (level == LOGLEVEL_DEFAULT)
+		printk_parse_prefix(fmt, &level, NULL);
+
+	return level != LOGLEVEL_DEFAULT && level <= LOGLEVEL_CRIT;
+}
+
+/* Called from irq_work, see wake_up_klogd_work_func(). */
+static void printk_kthread_wake(void)
+{
+	if (!READ_ONCE(printk_kthread_work)) {
+		WRITE_ONCE(printk_kthread_woken, jiffies);
+		/* pairs with smp_rmb() in printk_kthread_should_print() */
+		smp_wmb();
+		WRITE_ONCE(printk_kthread_work, true);
+	}
+	wake_up_interruptible(&printk_kthread_wait);
+}
+
+static int printk_kthread_func(void *unused)
+{
+	for (;;) {
+		wait_event_interruptible(printk_kthread_wait,
+					 READ_ONCE(printk_kthread_work) ||
+					 kthread_should_stop());
+		if (kthread_should_stop())
+			break;
+
+		/*
+		 * Clear the request before looking at the ringbuffer, so that
+		 * records stored from here on wake the thread once more.
+		 */
+		if (!xchg(&printk_kthread_work, false))
+			continue;
+
+		/* console_lock() allows console_unlock() to cond_resched() */
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
+static int __init printk_kthread_init(void)
+{
+	struct task_struct *tsk;
+
+	if (!printk_kthread_enabled)
+		return 0;
+
+	tsk = kthread_run(printk_kthread_func, NULL, "pr/console");
+	if (IS_ERR(tsk)) {
+		pr_err("failed to start console printing thread\n");
+		return PTR_ERR(tsk);
+	}
+	WRITE_ONCE(printk_kthread, tsk);
+
+	/* pick up what was stored before the thread was there */
+	defer_console_output();
+
+	return 0;
+}
+late_initcall(printk_kthread_init);
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const struct dev_printk_info *dev_info,
 			    const char *fmt, va_list args)
@@ -2248,6 +2354,15 @@ asmlinkage int vprintk_emit(int facility, int level,
 
 	printed_len = vprintk_store(facility, level, dev_info, fmt, args);
 
+	/*
+	 * Leave the consoles to the printer thread. It is woken through
+	 * irq_work, which is safe from any context, scheduler included.
+	 */
+	if (printk_kthread_should_print() && !printk_is_emergency(level, fmt)) {
+		defer_console_output();
+		return printed_len;
+	}
+
 	/* If called from the scheduler, we can not call up(). */
 	if (!in_sched) {
 		/*
@@ -3446,8 +3561,10 @@ static void wake_up_klogd_work_func(struct irq_work *irq_work)
 	int pending = this_cpu_xchg(printk_pending, 0);
 
 	if (pending & PRINTK_PENDING_OUTPUT) {
+		if (printk_kthread_should_print())
+			printk_kthread_wake();
 		/* If trylock fails, someone else is doing the printing */
-		if (console_trylock())
+		else if (console_trylock())
 			console_unlock();
 	}
 
@@ -279,8 +279,15 @@ static FORCE_INLINE int LZ4_decompress_generic(
 			if (!partialDecoding || (cpy == oend) || (ip >= (iend - 2)))
 				break;
 		} else {
-			/* may overwrite up to WILDCOPYLENGTH beyond cpy */
-			LZ4_wildCopy(op, ip, cpy);
+			if (endOnInput && length > 16 &&
+			    cpy <= oend - WILDCOPY16LENGTH &&
+			    ip + length <= iend - WILDCOPY16LENGTH) {
+				/* may overwrite up to 15 bytes beyond cpy */
+				LZ4_wildCopy16(op, ip, cpy);
+			} else {
+				/* may overwrite up to WILDCOPYLENGTH beyond cpy */
+				LZ4_wildCopy(op, ip, cpy);
+			}
 			ip += length;
 			op = cpy;
 		}
@@ -435,6 +442,13 @@ static FORCE_INLINE int LZ4_decompress_generic(
 			}
 			while (op < cpy)
 				*op++ = *match++;
+		} else if (offset >= 16 && length > 16 &&
+			   cpy <= oend - WILDCOPY16LENGTH) {
+			/*
+			 * The source of every 16 byte step lies entirely
+			 * before its destination, so it is already final.
+			 */
+			LZ4_wildCopy16(op, match, cpy);
 		} else {
 			LZ4_copy8(op, match);
 			if (length > 16)
@@ -121,6 +121,14 @@ const struct raid6_recov_calls *const raid6_recov_algos[] = {
 #define RAID6_TEST_DISKS	8
 #define RAID6_TEST_DISKS_ORDER	3
 
+/*
+ * Benchmarking every algorithm at boot takes a few jiffies each. Machines
+ * that already know which one wins on their CPU can name it here instead.
+ */
+static char *raid6_algo_name;
+module_param_named(algo, raid6_algo_name, charp, 0444);
+MODULE_PARM_DESC(algo, "Use this gen_syndrome() algorithm instead of benchmarking");
+
 static inline const struct raid6_recov_calls *raid6_choose_recov(void)
 {
 	const struct raid6_recov_calls *const *algo;
@@ -142,6 +150,23 @@ static inline const struct raid6_recov_calls *raid6_choose_recov(void)
 	return best;
 }
 
+static const struct raid6_calls *raid6_find_gen(const char *name)
+{
+	const struct raid6_calls *const *algo;
+
+	for (algo = raid6_algos; *algo; algo++) {
+		if (strcmp((*algo)->name, name))
+			continue;
+
+		if ((*algo)->valid && !(*algo)->valid())
+			break;
+
+		return *algo;
+	}
+
+	return NULL;
+}
+
 static inline const struct raid6_calls *raid6_choose_gen(
 	void *(*const dptrs)[RAID6_TEST_DISKS], const int disks)
 {
@@ -150,6 +175,19 @@ static inline const struct raid6_calls *raid6_choose_gen(
 	const struct raid6_calls *const *algo;
 	const struct raid6_calls *best;
 
+	if (raid6_algo_name) {
+		best = raid6_find_gen(raid6_algo_name);
+		if (best) {
+			raid6_call = *best;
+			pr_info("raid6: skipped pq benchmark and selected %s\n",
+				best->name);
+			return best;
+		}
+
+		pr_warn("raid6: %s is not available, falling back\n",
+			raid6_algo_name);
+	}
+
 	for (bestgenperf = 0, best = NULL, algo = raid6_algos; *algo; algo++) {
 		if (!best || (*algo)->priority >= best->priority) {
 			if ((*algo)->valid && !(*algo)->valid())
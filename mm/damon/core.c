@@ -288,6 +288,7 @@ struct damos *damon_new_scheme(struct damos_access_pattern *pattern,
 	scheme->pattern = *pattern;
 	scheme->action = action;
 	scheme->stat = (struct damos_stat){};
+	scheme->target_nid = NUMA_NO_NODE;
 	INIT_LIST_HEAD(&scheme->list);
 
 	scheme->quota = *(damos_quota_init_priv(quota));
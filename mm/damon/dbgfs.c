@@ -90,6 +90,8 @@ static ssize_t dbgfs_attrs_write(struct file *file,
 		goto unlock_out;
 	}
 
+	/* The number of workers is not exposed through debugfs */
+	attrs.nr_workers = ctx->attrs.nr_workers;
 	ret = damon_set_attrs(ctx, &attrs);
 	if (!ret)
 		ret = count;
@@ -7,11 +7,13 @@
 
 #define pr_fmt(fmt) "damon-pa: " fmt
 
+#include <linux/migrate.h>
 #include <linux/mmu_notifier.h>
 #include <linux/page_idle.h>
 #include <linux/pagemap.h>
 #include <linux/rmap.h>
 #include <linux/swap.h>
+#include <linux/workqueue.h>
 
 #include "../internal.h"
 #include "ops-common.h"
@@ -70,17 +72,6 @@ static void __damon_pa_prepare_access_check(struct damon_region *r)
 	damon_pa_mkold(r->sampling_addr);
 }
 
-static void damon_pa_prepare_access_checks(struct damon_ctx *ctx)
-{
-	struct damon_target *t;
-	struct damon_region *r;
-
-	damon_for_each_target(t, ctx) {
-		damon_for_each_region(r, t)
-			__damon_pa_prepare_access_check(r);
-	}
-}
-
 struct damon_pa_access_chk_result {
 	unsigned long page_sz;
 	bool accessed;
@@ -165,43 +156,168 @@ static bool damon_pa_young(unsigned long paddr, unsigned long *page_sz)
 	return result.accessed;
 }
 
-static void __damon_pa_check_access(struct damon_region *r)
-{
-	static unsigned long last_addr;
-	static unsigned long last_page_sz = PAGE_SIZE;
-	static bool last_accessed;
+/*
+ * struct damon_pa_worker - A share of the regions of a context to check.
+ * @work:		Work item running the check unless done by the kdamond.
+ * @t:			Target of @start.
+ * @start:		First region to check.
+ * @nr_regions:		Number of regions to check, possibly across targets.
+ * @check:		Check the accesses rather than prepare the checks.
+ * @max_nr_accesses:	Maximum nr_accesses of the checked regions.
+ * @last_addr:		Sampling address of the last checked page.
+ * @last_page_sz:	Size of the last checked page.
+ * @last_accessed:	Whether the last checked page was accessed.
+ *
+ * The result of the last check is kept per worker, so that the regions it
+ * checks in a row within the same (huge) page share one rmap walk.
+ */
+struct damon_pa_worker {
+	struct work_struct work;
+	struct damon_target *t;
+	struct damon_region *start;
+	unsigned int nr_regions;
+	bool check;
+	unsigned int max_nr_accesses;
+	unsigned long last_addr;
+	unsigned long last_page_sz;
+	bool last_accessed;
+};
+
+/* Maximum number of threads used for the access checks of a context */
+#define DAMON_PA_MAX_WORKERS		32
+
+/* Minimum number of regions worth handing over to another thread */
+#define DAMON_PA_MIN_WORKER_REGIONS	64
 
+static void __damon_pa_check_access(struct damon_region *r,
+		struct damon_pa_worker *w)
+{
 	/* If the region is in the last checked page, reuse the result */
-	if (ALIGN_DOWN(last_addr, last_page_sz) ==
-				ALIGN_DOWN(r->sampling_addr, last_page_sz)) {
-		if (last_accessed)
+	if (w->last_page_sz && ALIGN_DOWN(w->last_addr, w->last_page_sz) ==
+				ALIGN_DOWN(r->sampling_addr, w->last_page_sz)) {
+		if (w->last_accessed)
 			r->nr_accesses++;
 		return;
 	}
 
-	last_accessed = damon_pa_young(r->sampling_addr, &last_page_sz);
-	if (last_accessed)
+	w->last_accessed = damon_pa_young(r->sampling_addr, &w->last_page_sz);
+	if (w->last_accessed)
 		r->nr_accesses++;
 
-	last_addr = r->sampling_addr;
+	w->last_addr = r->sampling_addr;
 }
 
-static unsigned int damon_pa_check_accesses(struct damon_ctx *ctx)
+static void damon_pa_run_worker(struct damon_pa_worker *w)
 {
+	struct damon_target *t = w->t;
+	struct damon_region *r = w->start;
+	unsigned int i;
+
+	for (i = 0; i < w->nr_regions; i++) {
+		/* Move on to the next target at the end of the regions list */
+		while (&r->list == &t->regions_list) {
+			t = list_next_entry(t, list);
+			r = damon_first_region(t);
+		}
+
+		if (w->check) {
+			__damon_pa_check_access(r, w);
+			w->max_nr_accesses = max(r->nr_accesses,
+					w->max_nr_accesses);
+		} else {
+			__damon_pa_prepare_access_check(r);
+		}
+		r = damon_next_region(r);
+		cond_resched();
+	}
+}
+
+static void damon_pa_worker_fn(struct work_struct *work)
+{
+	damon_pa_run_worker(container_of(work, struct damon_pa_worker, work));
+}
+
+/*
+ * Split the regions of @ctx into consecutive shares of about the same size,
+ * check them in parallel on up to attrs.nr_workers threads, of which the
+ * kdamond is one, and wait for all of them.  The shares are only handed out
+ * if they are large enough to be worth the overhead.
+ */
+static unsigned int damon_pa_for_each_region(struct damon_ctx *ctx,
+		bool check)
+{
+	struct damon_pa_worker one = {}, *workers = &one;
+	unsigned int nr_workers, nr_regions = 0, per_worker, i;
+	unsigned int max_nr_accesses = 0;
 	struct damon_target *t;
 	struct damon_region *r;
-	unsigned int max_nr_accesses = 0;
 
+	damon_for_each_target(t, ctx)
+		nr_regions += damon_nr_regions(t);
+	if (!nr_regions)
+		return 0;
+
+	nr_workers = min3(ctx->attrs.nr_workers,
+			(unsigned long)DAMON_PA_MAX_WORKERS,
+			(unsigned long)nr_regions / DAMON_PA_MIN_WORKER_REGIONS);
+	if (nr_workers > 1) {
+		workers = kcalloc(nr_workers, sizeof(*workers), GFP_KERNEL);
+		if (!workers) {
+			workers = &one;
+			nr_workers = 1;
+		}
+	} else {
+		nr_workers = 1;
+	}
+	per_worker = DIV_ROUND_UP(nr_regions, nr_workers);
+
+	/* Find where the share of each worker starts */
+	i = 0;
+	nr_regions = 0;
 	damon_for_each_target(t, ctx) {
 		damon_for_each_region(r, t) {
-			__damon_pa_check_access(r);
-			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
+			if (nr_regions++ % per_worker)
+				continue;
+			workers[i].t = t;
+			workers[i].start = r;
+			workers[i].nr_regions = per_worker;
+			workers[i].check = check;
+			i++;
 		}
 	}
+	/* The last share may be smaller, and some workers may get none */
+	nr_workers = i;
+	workers[nr_workers - 1].nr_regions = nr_regions -
+		(nr_workers - 1) * per_worker;
+
+	for (i = 1; i < nr_workers; i++) {
+		INIT_WORK(&workers[i].work, damon_pa_worker_fn);
+		queue_work(system_unbound_wq, &workers[i].work);
+	}
+	damon_pa_run_worker(&workers[0]);
 
+	for (i = 0; i < nr_workers; i++) {
+		if (i)
+			flush_work(&workers[i].work);
+		max_nr_accesses = max(workers[i].max_nr_accesses,
+				max_nr_accesses);
+	}
+
+	if (workers != &one)
+		kfree(workers);
 	return max_nr_accesses;
 }
 
+static void damon_pa_prepare_access_checks(struct damon_ctx *ctx)
+{
+	damon_pa_for_each_region(ctx, false);
+}
+
+static unsigned int damon_pa_check_accesses(struct damon_ctx *ctx)
+{
+	return damon_pa_for_each_region(ctx, true);
+}
+
 static unsigned long damon_pa_pageout(struct damon_region *r)
 {
 	unsigned long addr, applied;
@@ -261,6 +377,61 @@ static unsigned long damon_pa_deactivate_pages(struct damon_region *r)
 	return damon_pa_mark_accessed_or_deactivate(r, false);
 }
 
+/*
+ * Migrate the pages of @r to the target node of @s.  Pages that are already
+ * there, or that can't be isolated or migrated right away are skipped, so that
+ * the quota is charged for the memory that actually moved.
+ */
+static unsigned long damon_pa_migrate(struct damon_region *r, struct damos *s)
+{
+	struct migration_target_control mtc = {
+		.nid = s->target_nid,
+		/* don't stall kdamond on reclaim of the destination node */
+		.gfp_mask = (GFP_HIGHUSER_MOVABLE & ~__GFP_DIRECT_RECLAIM) |
+			__GFP_THISNODE | __GFP_NOWARN | __GFP_NOMEMALLOC,
+	};
+	unsigned int nr_succeeded = 0;
+	unsigned long addr;
+	LIST_HEAD(page_list);
+
+	if (s->target_nid < 0 || s->target_nid >= MAX_NUMNODES ||
+			!node_online(s->target_nid))
+		return 0;
+
+	for (addr = r->ar.start; addr < r->ar.end; addr += PAGE_SIZE) {
+		struct page *page = damon_get_page(PHYS_PFN(addr));
+
+		if (!page)
+			continue;
+
+		page = compound_head(page);
+		if (page_to_nid(page) == s->target_nid || isolate_lru_page(page)) {
+			put_page(page);
+			continue;
+		}
+		if (PageUnevictable(page)) {
+			putback_lru_page(page);
+		} else {
+			list_add_tail(&page->lru, &page_list);
+			mod_node_page_state(page_pgdat(page),
+					NR_ISOLATED_ANON + page_is_file_lru(page),
+					thp_nr_pages(page));
+		}
+		put_page(page);
+	}
+
+	if (!list_empty(&page_list)) {
+		if (migrate_pages(&page_list, alloc_migration_target, NULL,
+				(unsigned long)&mtc, MIGRATE_ASYNC,
+				s->action == DAMOS_MIGRATE_HOT ?
+				MR_NUMA_MISPLACED : MR_DEMOTION,
+				&nr_succeeded))
+			putback_movable_pages(&page_list);
+	}
+	cond_resched();
+	return (unsigned long)nr_succeeded * PAGE_SIZE;
+}
+
 static unsigned long damon_pa_apply_scheme(struct damon_ctx *ctx,
 		struct damon_target *t, struct damon_region *r,
 		struct damos *scheme)
@@ -272,6 +443,9 @@ static unsigned long damon_pa_apply_scheme(struct damon_ctx *ctx,
 		return damon_pa_mark_accessed(r);
 	case DAMOS_LRU_DEPRIO:
 		return damon_pa_deactivate_pages(r);
+	case DAMOS_MIGRATE_HOT:
+	case DAMOS_MIGRATE_COLD:
+		return damon_pa_migrate(r, scheme);
 	case DAMOS_STAT:
 		break;
 	default:
@@ -292,6 +466,10 @@ static int damon_pa_scheme_score(struct damon_ctx *context,
 		return damon_hot_score(context, r, scheme);
 	case DAMOS_LRU_DEPRIO:
 		return damon_cold_score(context, r, scheme);
+	case DAMOS_MIGRATE_HOT:
+		return damon_hot_score(context, r, scheme);
+	case DAMOS_MIGRATE_COLD:
+		return damon_cold_score(context, r, scheme);
 	default:
 		break;
 	}
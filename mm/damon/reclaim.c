@@ -52,6 +52,40 @@ module_param(commit_inputs, bool, 0600);
 static unsigned long min_age __read_mostly = 120000000;
 module_param(min_age, ulong, 0600);
 
+/*
+ * Node to demote cold memory regions to.
+ *
+ * If this is set to a NUMA node, e.g. a slow or CXL memory node of a tiered
+ * memory system, DAMON_RECLAIM migrates the cold memory regions to that node
+ * instead of paging them out, under the same quota.  -1, which means paging
+ * out, by default.
+ */
+static int demote_target_nid __read_mostly = NUMA_NO_NODE;
+
+static int damon_reclaim_demote_target_nid_store(const char *val,
+		const struct kernel_param *kp)
+{
+	int nid, rc;
+
+	rc = kstrtoint(val, 0, &nid);
+	if (rc < 0)
+		return rc;
+
+	if (nid != NUMA_NO_NODE && (nid < 0 || nid >= MAX_NUMNODES))
+		return -EINVAL;
+
+	*(int *)kp->arg = nid;
+	return 0;
+}
+
+static const struct kernel_param_ops demote_target_nid_param_ops = {
+	.set = damon_reclaim_demote_target_nid_store,
+	.get = param_get_int,
+};
+
+module_param_cb(demote_target_nid, &demote_target_nid_param_ops,
+		&demote_target_nid, 0600);
+
 static struct damos_quota damon_reclaim_quota = {
 	/* use up to 10 ms time, reclaim up to 128 MiB per 1 sec by default */
 	.ms = 10,
@@ -130,15 +164,20 @@ static struct damos *damon_reclaim_new_scheme(void)
 			damon_reclaim_mon_attrs.aggr_interval,
 		.max_age_region = UINT_MAX,
 	};
+	struct damos *scheme;
 
-	return damon_new_scheme(
+	scheme = damon_new_scheme(
 			&pattern,
-			/* page out those, as soon as found */
-			DAMOS_PAGEOUT,
+			/* page out or demote those, as soon as found */
+			demote_target_nid == NUMA_NO_NODE ?
+			DAMOS_PAGEOUT : DAMOS_MIGRATE_COLD,
 			/* under the quota. */
 			&damon_reclaim_quota,
 			/* (De)activate this according to the watermarks. */
 			&damon_reclaim_wmarks);
+	if (scheme)
+		scheme->target_nid = demote_target_nid;
+	return scheme;
 }
 
 static int damon_reclaim_apply_parameters(void)
@@ -221,6 +221,16 @@ static inline bool ____kasan_slab_free(struct kmem_cache *cache, void *object,
 	if (unlikely(cache->flags & SLAB_TYPESAFE_BY_RCU))
 		return false;
 
+	/*
+	 * Objects that were not sampled were never unpoisoned; leave their
+	 * memory tags alone but still honor init_on_free.
+	 */
+	if (kasan_sampled_out(cache, tagged_object)) {
+		if (init)
+			memset(object, 0, cache->object_size);
+		return false;
+	}
+
 	if (!kasan_byte_accessible(tagged_object)) {
 		kasan_report_invalid_free(tagged_object, ip, KASAN_REPORT_DOUBLE_FREE);
 		return true;
@@ -307,6 +317,16 @@ void * __must_check __kasan_slab_alloc(struct kmem_cache *cache,
 	if (is_kfence_address(object))
 		return (void *)object;
 
+	/*
+	 * Hand out a match-all pointer for objects that are not sampled. The
+	 * allocator relies on KASAN to initialize the memory in this mode.
+	 */
+	if (!kasan_sample_object(cache)) {
+		if (init)
+			memset(object, 0, cache->object_size);
+		return set_tag(object, KASAN_TAG_KERNEL);
+	}
+
 	/*
 	 * Generate and assign random tag for tag-based modes.
 	 * Tag is ignored in set_tag() for the generic mode.
@@ -342,6 +362,10 @@ static inline void *____kasan_kmalloc(struct kmem_cache *cache,
 	if (is_kfence_address(kasan_reset_tag(object)))
 		return (void *)object;
 
+	/* Objects that were not sampled have no redzone. */
+	if (kasan_sampled_out(cache, object))
+		return (void *)object;
+
 	/*
 	 * The object has already been unpoisoned by kasan_slab_alloc() for
 	 * kmalloc() or by kasan_krealloc() for krealloc().
@@ -423,6 +447,11 @@ void * __must_check __kasan_krealloc(const void *object, size_t size, gfp_t flag
 	if (unlikely(object == ZERO_SIZE_PTR))
 		return (void *)object;
 
+	slab = virt_to_slab(object);
+
+	if (slab && kasan_sampled_out(slab->slab_cache, object))
+		return (void *)object;
+
 	/*
 	 * Unpoison the object's data.
 	 * Part of it might already have been unpoisoned, but it's unknown
@@ -430,8 +459,6 @@ void * __must_check __kasan_krealloc(const void *object, size_t size, gfp_t flag
 	 */
 	kasan_unpoison(object, size, false);
 
-	slab = virt_to_slab(object);
-
 	/* Piggy-back on kmalloc() instrumentation to poison the redzone. */
 	if (unlikely(!slab))
 		return __kasan_kmalloc_large(object, size, flags);
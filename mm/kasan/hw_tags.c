@@ -8,11 +8,15 @@
 
 #define pr_fmt(fmt) "kasan: " fmt
 
+#include <linux/debugfs.h>
 #include <linux/init.h>
 #include <linux/kasan.h>
 #include <linux/kernel.h>
 #include <linux/memory.h>
 #include <linux/mm.h>
+#include <linux/percpu.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
 #include <linux/static_key.h>
 #include <linux/string.h>
 #include <linux/types.h>
@@ -59,6 +63,17 @@ EXPORT_SYMBOL_GPL(kasan_mode);
 /* Whether to enable vmalloc tagging. */
 DEFINE_STATIC_KEY_TRUE(kasan_flag_vmalloc);
 
+/* Whether slab allocations are sampled, see kasan_sample_object(). */
+DEFINE_STATIC_KEY_FALSE(kasan_flag_sample);
+
+/* One in this many allocations from the sampled caches gets a tag. */
+static unsigned int kasan_sample_interval __ro_after_init = 1;
+
+/* Comma-separated names of the sampled caches, a trailing '*' is a wildcard. */
+static char kasan_sample_caches[128] __ro_after_init;
+
+static DEFINE_PER_CPU(int, kasan_sample_countdown);
+
 /* kasan=off/on */
 static int __init early_kasan_flag(char *arg)
 {
@@ -112,6 +127,36 @@ static int __init early_kasan_flag_vmalloc(char *arg)
 }
 early_param("kasan.vmalloc", early_kasan_flag_vmalloc);
 
+/* kasan.sample=<interval> */
+static int __init early_kasan_sample(char *arg)
+{
+	unsigned int interval;
+
+	if (!arg)
+		return -EINVAL;
+
+	if (kstrtouint(arg, 0, &interval) || !interval)
+		return -EINVAL;
+
+	kasan_sample_interval = interval;
+
+	return 0;
+}
+early_param("kasan.sample", early_kasan_sample);
+
+/* kasan.sample.caches=<name>[,<name>...] */
+static int __init early_kasan_sample_caches(char *arg)
+{
+	if (!arg)
+		return -EINVAL;
+
+	if (strscpy(kasan_sample_caches, arg, sizeof(kasan_sample_caches)) < 0)
+		return -EINVAL;
+
+	return 0;
+}
+early_param("kasan.sample.caches", early_kasan_sample_caches);
+
 static inline const char *kasan_mode_info(void)
 {
 	if (kasan_mode == KASAN_MODE_ASYNC)
@@ -186,6 +231,10 @@ void __init kasan_init_hw_tags(void)
 		break;
 	}
 
+	/* Sampling only applies to the caches that opt in. */
+	if (kasan_sample_interval > 1 && kasan_sample_caches[0])
+		static_branch_enable(&kasan_flag_sample);
+
 	kasan_init_tags();
 
 	/* KASAN is now initialized, enable it. */
@@ -195,8 +244,95 @@ void __init kasan_init_hw_tags(void)
 		kasan_mode_info(),
 		kasan_vmalloc_enabled() ? "on" : "off",
 		kasan_stack_collection_enabled() ? "on" : "off");
+
+	if (kasan_sample_enabled())
+		pr_info("tagging 1 in %u allocations from %s\n",
+			kasan_sample_interval, kasan_sample_caches);
 }
 
+static u8 kasan_sample_init_cache(struct kmem_cache *cache)
+{
+	u8 sample = KASAN_SAMPLE_OFF;
+
+	/*
+	 * Objects of caches with a constructor or SLAB_TYPESAFE_BY_RCU keep
+	 * their tag across allocations, see assign_tag(); always tag them.
+	 */
+	if (!cache->ctor && !(cache->flags & SLAB_TYPESAFE_BY_RCU) &&
+	    kmem_cache_name_match(kasan_sample_caches, cache->name))
+		sample = KASAN_SAMPLE_ON;
+
+	WRITE_ONCE(cache->kasan_info.sample, sample);
+
+	return sample;
+}
+
+bool __kasan_sample_object(struct kmem_cache *cache)
+{
+	u8 sample = READ_ONCE(cache->kasan_info.sample);
+
+	if (unlikely(sample == KASAN_SAMPLE_UNKNOWN))
+		sample = kasan_sample_init_cache(cache);
+
+	if (sample != KASAN_SAMPLE_ON)
+		return true;
+
+	/*
+	 * The countdown is shared by all sampled caches on a CPU. Racing with
+	 * an interrupt only shifts the sampling point.
+	 */
+	if (this_cpu_dec_return(kasan_sample_countdown) > 0)
+		return false;
+
+	this_cpu_write(kasan_sample_countdown, kasan_sample_interval);
+	atomic64_inc(&cache->kasan_info.nr_sampled);
+
+	return true;
+}
+
+#ifdef CONFIG_DEBUG_FS
+
+/*
+ * One line per sampled cache: <name> <tagged> <estimated allocations>.
+ * Only tagged allocations are counted to keep the untagged path cheap.
+ */
+static int kasan_sample_stats_show(struct seq_file *m, void *v)
+{
+	struct kmem_cache *cache;
+	s64 sampled;
+
+	mutex_lock(&slab_mutex);
+	list_for_each_entry(cache, &slab_caches, list) {
+		if (READ_ONCE(cache->kasan_info.sample) != KASAN_SAMPLE_ON)
+			continue;
+
+		sampled = atomic64_read(&cache->kasan_info.nr_sampled);
+		seq_printf(m, "%s %lld %lld\n", cache->name, sampled,
+			   sampled * kasan_sample_interval);
+	}
+	mutex_unlock(&slab_mutex);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(kasan_sample_stats);
+
+static int __init kasan_sample_debugfs_init(void)
+{
+	struct dentry *d_dir;
+
+	if (!kasan_sample_enabled())
+		return 0;
+
+	d_dir = debugfs_create_dir("kasan", NULL);
+	debugfs_create_file("sample_stats", 0400, d_dir, NULL,
+			    &kasan_sample_stats_fops);
+
+	return 0;
+}
+late_initcall(kasan_sample_debugfs_init);
+
+#endif /* CONFIG_DEBUG_FS */
+
 #ifdef CONFIG_KASAN_VMALLOC
 
 static void unpoison_vmalloc_pages(const void *addr, u8 tag)
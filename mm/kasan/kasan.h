@@ -407,6 +407,47 @@ static inline const void *arch_kasan_set_tag(const void *addr, u8 tag)
 
 void kasan_enable_tagging(void);
 
+/* Values of kasan_info.sample, resolved at the first allocation. */
+enum kasan_sample_state {
+	KASAN_SAMPLE_UNKNOWN,
+	KASAN_SAMPLE_OFF,
+	KASAN_SAMPLE_ON,
+};
+
+DECLARE_STATIC_KEY_FALSE(kasan_flag_sample);
+
+static inline bool kasan_sample_enabled(void)
+{
+	return static_branch_unlikely(&kasan_flag_sample);
+}
+
+bool __kasan_sample_object(struct kmem_cache *cache);
+
+/*
+ * Whether an object being allocated from @cache gets a tag. With sampling
+ * enabled, only one in kasan.sample allocations from the caches listed in
+ * kasan.sample.caches does; all others get a match-all pointer.
+ */
+static inline bool kasan_sample_object(struct kmem_cache *cache)
+{
+	if (!kasan_sample_enabled())
+		return true;
+
+	return __kasan_sample_object(cache);
+}
+
+/*
+ * Whether @object was not tagged by kasan_sample_object(). Random tags never
+ * are KASAN_TAG_KERNEL, and sampled caches do not preassign tags.
+ */
+static inline bool kasan_sampled_out(struct kmem_cache *cache,
+				     const void *object)
+{
+	return kasan_sample_enabled() &&
+	       READ_ONCE(cache->kasan_info.sample) == KASAN_SAMPLE_ON &&
+	       get_tag(object) == KASAN_TAG_KERNEL;
+}
+
 #else /* CONFIG_KASAN_HW_TAGS */
 
 #define hw_enable_tagging_sync()
@@ -415,6 +456,22 @@ void kasan_enable_tagging(void);
 
 static inline void kasan_enable_tagging(void) { }
 
+static inline bool kasan_sample_enabled(void)
+{
+	return false;
+}
+
+static inline bool kasan_sample_object(struct kmem_cache *cache)
+{
+	return true;
+}
+
+static inline bool kasan_sampled_out(struct kmem_cache *cache,
+				     const void *object)
+{
+	return false;
+}
+
 #endif /* CONFIG_KASAN_HW_TAGS */
 
 #if defined(CONFIG_KASAN_SW_TAGS) || defined(CONFIG_KASAN_HW_TAGS)
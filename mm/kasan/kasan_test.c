@@ -53,6 +53,11 @@ static int kasan_test_init(struct kunit *test)
 		return -1;
 	}
 
+	if (kasan_sample_enabled()) {
+		kunit_err(test, "can't run KASAN tests with sampled tagging");
+		return -1;
+	}
+
 	multishot = kasan_save_enable_multi_shot();
 	test_status.report_found = false;
 	test_status.sync_fault = false;
@@ -108,6 +108,24 @@ module_param_named(deferrable, kfence_deferrable, bool, 0444);
 static bool kfence_check_on_panic __read_mostly;
 module_param_named(check_on_panic, kfence_check_on_panic, bool, 0444);
 
+/* If true, adapt the sample interval to the allocation rate and pool usage. */
+static bool kfence_adaptive_interval __read_mostly;
+module_param_named(adaptive_interval, kfence_adaptive_interval, bool, 0644);
+
+/*
+ * Comma-separated names of the slab caches to focus on, a trailing '*' is a
+ * wildcard. Allocations from other caches are focus_weight times less likely
+ * to be sampled.
+ */
+static char kfence_focus_caches[128] __read_mostly;
+module_param_string(focus_caches, kfence_focus_caches, sizeof(kfence_focus_caches), 0444);
+
+static unsigned int kfence_focus_weight __read_mostly = 8;
+module_param_named(focus_weight, kfence_focus_weight, uint, 0644);
+
+/* Current adaptive sample interval in milliseconds, updated by the timer. */
+static unsigned long kfence_cur_interval;
+
 /* The pool of pages used for guard pages and objects. */
 char *__kfence_pool __read_mostly;
 EXPORT_SYMBOL(__kfence_pool); /* Export for test modules. */
@@ -168,6 +186,7 @@ enum kfence_counter_id {
 	KFENCE_COUNTER_SKIP_INCOMPAT,
 	KFENCE_COUNTER_SKIP_CAPACITY,
 	KFENCE_COUNTER_SKIP_COVERED,
+	KFENCE_COUNTER_SKIP_UNFOCUSED,
 	KFENCE_COUNTER_COUNT,
 };
 static atomic_long_t counters[KFENCE_COUNTER_COUNT];
@@ -180,6 +199,7 @@ static const char *const counter_names[] = {
 	[KFENCE_COUNTER_SKIP_INCOMPAT]	= "skipped allocations (incompatible)",
 	[KFENCE_COUNTER_SKIP_CAPACITY]	= "skipped allocations (capacity)",
 	[KFENCE_COUNTER_SKIP_COVERED]	= "skipped allocations (covered)",
+	[KFENCE_COUNTER_SKIP_UNFOCUSED]	= "skipped allocations (unfocused)",
 };
 static_assert(ARRAY_SIZE(counter_names) == KFENCE_COUNTER_COUNT);
 
@@ -192,6 +212,20 @@ static inline bool should_skip_covered(void)
 	return atomic_long_read(&counters[KFENCE_COUNTER_ALLOCATED]) > thresh;
 }
 
+/*
+ * Let an allocation from an unfocused cache take the sample with a probability
+ * of 1/focus_weight only, so that the focused caches get most of the samples.
+ */
+static inline bool should_skip_unfocused(struct kmem_cache *s)
+{
+	unsigned int weight = READ_ONCE(kfence_focus_weight);
+
+	if (!kfence_focus_caches[0] || weight <= 1)
+		return false;
+
+	return prandom_u32_max(weight) && !kmem_cache_name_match(kfence_focus_caches, s->name);
+}
+
 static u32 get_alloc_stack_hash(unsigned long *stack_entries, size_t num_entries)
 {
 	num_entries = min(num_entries, UNIQUE_ALLOC_STACK_DEPTH);
@@ -675,6 +709,8 @@ static int stats_show(struct seq_file *seq, void *v)
 	int i;
 
 	seq_printf(seq, "enabled: %i\n", READ_ONCE(kfence_enabled));
+	if (READ_ONCE(kfence_adaptive_interval))
+		seq_printf(seq, "sample interval: %lu\n", READ_ONCE(kfence_cur_interval));
 	for (i = 0; i < KFENCE_COUNTER_COUNT; i++)
 		seq_printf(seq, "%s: %ld\n", counter_names[i], atomic_long_read(&counters[i]));
 
@@ -767,6 +803,9 @@ static struct notifier_block kfence_check_canary_notifier = {
 
 static struct delayed_work kfence_timer;
 
+/* Bounds of the adaptive interval, relative to kfence.sample_interval. */
+#define KFENCE_ADAPTIVE_RANGE	8
+
 #ifdef CONFIG_KFENCE_STATIC_KEYS
 /* Wait queue to wake up allocation-gate timer task. */
 static DECLARE_WAIT_QUEUE_HEAD(allocation_wait);
@@ -778,6 +817,36 @@ static void wake_up_kfence_timer(struct irq_work *work)
 static DEFINE_IRQ_WORK(wake_up_kfence_timer_work, wake_up_kfence_timer);
 #endif
 
+/*
+ * Scale the sample interval within KFENCE_ADAPTIVE_RANGE of the configured
+ * one: sample more often while the pool is mostly unused and the previous
+ * sample was consumed, i.e. allocations are frequent enough to make use of a
+ * shorter interval, and back off while the pool fills up and samples would
+ * mostly be skipped for lack of capacity.
+ */
+static unsigned long next_sample_interval(bool consumed)
+{
+	unsigned long base = READ_ONCE(kfence_sample_interval);
+	unsigned long cur = kfence_cur_interval ?: base;
+	long allocated = atomic_long_read(&counters[KFENCE_COUNTER_ALLOCATED]);
+
+	if (!READ_ONCE(kfence_adaptive_interval) || !base) {
+		WRITE_ONCE(kfence_cur_interval, 0);
+		return base;
+	}
+
+	if (allocated > CONFIG_KFENCE_NUM_OBJECTS / 2)
+		cur *= 2;
+	else if (consumed && allocated < CONFIG_KFENCE_NUM_OBJECTS / 4)
+		cur /= 2;
+
+	cur = clamp(cur, max(base / KFENCE_ADAPTIVE_RANGE, 1UL),
+		    base * KFENCE_ADAPTIVE_RANGE);
+	WRITE_ONCE(kfence_cur_interval, cur);
+
+	return cur;
+}
+
 /*
  * Set up delayed work, which will enable and disable the static key. We need to
  * use a work queue (rather than a simple timer), since enabling and disabling a
@@ -791,9 +860,13 @@ static DEFINE_IRQ_WORK(wake_up_kfence_timer_work, wake_up_kfence_timer);
  */
 static void toggle_allocation_gate(struct work_struct *work)
 {
+	bool consumed;
+
 	if (!READ_ONCE(kfence_enabled))
 		return;
 
+	/* Whether an allocation went through the gate since it was opened. */
+	consumed = atomic_read(&kfence_allocation_gate);
 	atomic_set(&kfence_allocation_gate, 0);
 #ifdef CONFIG_KFENCE_STATIC_KEYS
 	/* Enable static key, and await allocation to happen. */
@@ -814,7 +887,7 @@ static void toggle_allocation_gate(struct work_struct *work)
 	static_branch_disable(&kfence_allocation_key);
 #endif
 	queue_delayed_work(system_unbound_wq, &kfence_timer,
-			   msecs_to_jiffies(kfence_sample_interval));
+			   msecs_to_jiffies(next_sample_interval(consumed)));
 }
 
 /* === Public interface ===================================================== */
@@ -999,6 +1072,12 @@ void *__kfence_alloc(struct kmem_cache *s, size_t size, gfp_t flags)
 	if (s->flags & SLAB_SKIP_KFENCE)
 		return NULL;
 
+	/* Leave the sample to an allocation from a focused cache. */
+	if (should_skip_unfocused(s)) {
+		atomic_long_inc(&counters[KFENCE_COUNTER_SKIP_UNFOCUSED]);
+		return NULL;
+	}
+
 	if (atomic_inc_return(&kfence_allocation_gate) > 1)
 		return NULL;
 #ifdef CONFIG_KFENCE_STATIC_KEYS
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Matching of slab cache names against boot and module parameter lists.
+ */
+
+#include <linux/slab.h>
+#include <linux/string.h>
+
+/**
+ * kmem_cache_name_match - check a slab cache name against a list of names
+ * @list: comma-separated cache names, a trailing '*' makes an entry a prefix
+ * @name: the cache name to look up
+ *
+ * Return: true if @name matches any entry of @list.
+ */
+bool kmem_cache_name_match(const char *list, const char *name)
+{
+	const char *p = list;
+	size_t len;
+
+	while (*p) {
+		len = strchrnul(p, ',') - p;
+
+		if (len && p[len - 1] == '*') {
+			if (!strncmp(name, p, len - 1))
+				return true;
+		} else if (len && strlen(name) == len && !strncmp(name, p, len)) {
+			return true;
+		}
+
+		p += len;
+		if (*p)
+			p++;
+	}
+
+	return false;
+}
@@ -232,8 +232,9 @@ static void set_in_bvec(struct ceph_connection *con, const struct bio_vec *bv)
 {
 	WARN_ON(iov_iter_count(&con->v2.in_iter));
 
-	con->v2.in_bvec = *bv;
-	iov_iter_bvec(&con->v2.in_iter, READ, &con->v2.in_bvec, 1, bv->bv_len);
+	con->v2.in_bvecs[0] = *bv;
+	con->v2.in_bvec_cnt = 1;
+	iov_iter_bvec(&con->v2.in_iter, READ, con->v2.in_bvecs, 1, bv->bv_len);
 }
 
 static void set_in_skip(struct ceph_connection *con, int len)
@@ -869,6 +870,32 @@ static void get_bvec_at(struct ceph_msg_data_cursor *cursor,
 	bv->bv_len = len;
 }
 
+/*
+ * Point in_iter at as many destination pieces as fit into in_bvecs, so
+ * that a single recvmsg() can fill several pages.  The cursor is advanced
+ * past all of them right away, the data crc is computed once the whole
+ * batch has been received.
+ */
+static void set_in_data_bvecs(struct ceph_connection *con)
+{
+	struct ceph_msg_data_cursor *cursor = &con->v2.in_cursor;
+	struct bio_vec *bv = con->v2.in_bvecs;
+	size_t len = 0;
+	int i;
+
+	WARN_ON(iov_iter_count(&con->v2.in_iter));
+
+	for (i = 0; i < ARRAY_SIZE(con->v2.in_bvecs) && cursor->total_resid;
+	     i++) {
+		get_bvec_at(cursor, &bv[i]);
+		ceph_msg_data_advance(cursor, bv[i].bv_len);
+		len += bv[i].bv_len;
+	}
+
+	con->v2.in_bvec_cnt = i;
+	iov_iter_bvec(&con->v2.in_iter, READ, bv, i, len);
+}
+
 static int calc_sg_cnt(void *buf, int buf_len)
 {
 	int sg_cnt;
@@ -1761,7 +1788,6 @@ static int prepare_read_data(struct ceph_connection *con)
 	ceph_msg_data_cursor_init(&con->v2.in_cursor, con->in_msg,
 				  data_len(con->in_msg));
 
-	get_bvec_at(&con->v2.in_cursor, &bv);
 	if (ceph_test_opt(from_msgr(con->msgr), RXBOUNCE)) {
 		if (unlikely(!con->bounce_page)) {
 			con->bounce_page = alloc_page(GFP_NOIO);
@@ -1771,10 +1797,13 @@ static int prepare_read_data(struct ceph_connection *con)
 			}
 		}
 
+		get_bvec_at(&con->v2.in_cursor, &bv);
 		bv.bv_page = con->bounce_page;
 		bv.bv_offset = 0;
+		set_in_bvec(con, &bv);
+	} else {
+		set_in_data_bvecs(con);
 	}
-	set_in_bvec(con, &bv);
 	con->v2.in_state = IN_S_PREPARE_READ_DATA_CONT;
 	return 0;
 }
@@ -1782,31 +1811,37 @@ static int prepare_read_data(struct ceph_connection *con)
 static void prepare_read_data_cont(struct ceph_connection *con)
 {
 	struct bio_vec bv;
+	int i;
 
 	if (ceph_test_opt(from_msgr(con->msgr), RXBOUNCE)) {
 		con->in_data_crc = crc32c(con->in_data_crc,
 					  page_address(con->bounce_page),
-					  con->v2.in_bvec.bv_len);
+					  con->v2.in_bvecs[0].bv_len);
 
 		get_bvec_at(&con->v2.in_cursor, &bv);
 		memcpy_to_page(bv.bv_page, bv.bv_offset,
 			       page_address(con->bounce_page),
-			       con->v2.in_bvec.bv_len);
+			       con->v2.in_bvecs[0].bv_len);
+		ceph_msg_data_advance(&con->v2.in_cursor,
+				      con->v2.in_bvecs[0].bv_len);
 	} else {
-		con->in_data_crc = ceph_crc32c_page(con->in_data_crc,
-						    con->v2.in_bvec.bv_page,
-						    con->v2.in_bvec.bv_offset,
-						    con->v2.in_bvec.bv_len);
+		for (i = 0; i < con->v2.in_bvec_cnt; i++)
+			con->in_data_crc =
+				ceph_crc32c_page(con->in_data_crc,
+						 con->v2.in_bvecs[i].bv_page,
+						 con->v2.in_bvecs[i].bv_offset,
+						 con->v2.in_bvecs[i].bv_len);
 	}
 
-	ceph_msg_data_advance(&con->v2.in_cursor, con->v2.in_bvec.bv_len);
 	if (con->v2.in_cursor.total_resid) {
-		get_bvec_at(&con->v2.in_cursor, &bv);
 		if (ceph_test_opt(from_msgr(con->msgr), RXBOUNCE)) {
+			get_bvec_at(&con->v2.in_cursor, &bv);
 			bv.bv_page = con->bounce_page;
 			bv.bv_offset = 0;
+			set_in_bvec(con, &bv);
+		} else {
+			set_in_data_bvecs(con);
 		}
-		set_in_bvec(con, &bv);
 		WARN_ON(con->v2.in_state != IN_S_PREPARE_READ_DATA_CONT);
 		return;
 	}
@@ -3446,15 +3481,28 @@ static void revoke_at_prepare_read_data(struct ceph_connection *con)
 
 static void revoke_at_prepare_read_data_cont(struct ceph_connection *con)
 {
-	int recved, resid;  /* current piece of data */
+	int recved, resid;  /* current piece(s) of data */
 	int remaining;
 
 	WARN_ON(con_secure(con));
 	WARN_ON(!data_len(con->in_msg));
 	WARN_ON(!iov_iter_is_bvec(&con->v2.in_iter));
 	resid = iov_iter_count(&con->v2.in_iter);
-	WARN_ON(!resid || resid > con->v2.in_bvec.bv_len);
-	recved = con->v2.in_bvec.bv_len - resid;
+	WARN_ON(!resid);
+
+	if (!ceph_test_opt(from_msgr(con->msgr), RXBOUNCE)) {
+		/* the cursor is already past the whole in_bvecs batch */
+		remaining = resid + CEPH_EPILOGUE_PLAIN_LEN;
+		dout("%s con %p resid %d total_resid %zu\n", __func__, con,
+		     resid, con->v2.in_cursor.total_resid);
+		con->v2.in_iter.count -= resid;
+		set_in_skip(con, con->v2.in_cursor.total_resid + remaining);
+		con->v2.in_state = IN_S_FINISH_SKIP;
+		return;
+	}
+
+	WARN_ON(resid > con->v2.in_bvecs[0].bv_len);
+	recved = con->v2.in_bvecs[0].bv_len - resid;
 	dout("%s con %p recved %d resid %d\n", __func__, con, recved, resid);
 
 	if (recved)
@@ -3476,7 +3524,7 @@ static void revoke_at_prepare_read_enc_page(struct ceph_connection *con)
 	WARN_ON(!con_secure(con));
 	WARN_ON(!iov_iter_is_bvec(&con->v2.in_iter));
 	resid = iov_iter_count(&con->v2.in_iter);
-	WARN_ON(!resid || resid > con->v2.in_bvec.bv_len);
+	WARN_ON(!resid || resid > con->v2.in_bvecs[0].bv_len);
 
 	dout("%s con %p resid %d enc_resid %d\n", __func__, con, resid,
 	     con->v2.in_enc_resid);
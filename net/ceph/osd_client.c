@@ -1217,6 +1217,11 @@ static struct ceph_osd *create_osd(struct ceph_osd_client *osdc, int onum)
 	osd->o_osdc = osdc;
 	osd->o_osd = onum;
 
+	/*
+	 * One session per OSD: the OSD identifies the client by entity
+	 * name and messenger nonce, so a second connection would simply
+	 * replace (reset) this one.
+	 */
 	ceph_con_init(&osd->o_con, osd, &osd_con_ops, &osdc->client->msgr);
 
 	return osd;
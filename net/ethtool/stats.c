@@ -103,6 +103,21 @@ static int stats_parse_request(struct ethnl_req_info *req_base,
 	return 0;
 }
 
+static bool stats_dev_has_groups(const struct net_device *dev,
+				 const unsigned long *stat_mask)
+{
+	const struct ethtool_ops *ops = dev->ethtool_ops;
+
+	return (test_bit(ETHTOOL_STATS_ETH_PHY, stat_mask) &&
+		ops->get_eth_phy_stats) ||
+	       (test_bit(ETHTOOL_STATS_ETH_MAC, stat_mask) &&
+		ops->get_eth_mac_stats) ||
+	       (test_bit(ETHTOOL_STATS_ETH_CTRL, stat_mask) &&
+		ops->get_eth_ctrl_stats) ||
+	       (test_bit(ETHTOOL_STATS_RMON, stat_mask) &&
+		ops->get_rmon_stats);
+}
+
 static int stats_prepare_data(const struct ethnl_req_info *req_base,
 			      struct ethnl_reply_data *reply_base,
 			      struct genl_info *info)
@@ -112,6 +127,13 @@ static int stats_prepare_data(const struct ethnl_req_info *req_base,
 	struct net_device *dev = reply_base->dev;
 	int ret;
 
+	/* A dump (no info) skips devices which can't report any of the
+	 * requested groups instead of resuming them only to send back an
+	 * empty message; the dump code treats -EOPNOTSUPP as "skip".
+	 */
+	if (!info && !stats_dev_has_groups(dev, req_info->stat_mask))
+		return -EOPNOTSUPP;
+
 	ret = ethnl_ops_begin(dev);
 	if (ret < 0)
 		return ret;
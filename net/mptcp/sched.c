@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0
+/* Multipath TCP
+ *
+ * Packet scheduler registry and the built-in schedulers.
+ */
+
+#define pr_fmt(fmt) "MPTCP: " fmt
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/list.h>
+#include <linux/rculist.h>
+#include <linux/spinlock.h>
+#include "protocol.h"
+
+static DEFINE_SPINLOCK(mptcp_sched_list_lock);
+static LIST_HEAD(mptcp_sched_list);
+
+static struct mptcp_sched_ops mptcp_sched_default = {
+	.get_subflow	= mptcp_subflow_get_send,
+	.name		= "default",
+	.owner		= THIS_MODULE,
+};
+
+/* Prefer the active subflow with the lowest smoothed RTT that still has
+ * room in its send buffer, backup subflows are used only when no other
+ * subflow is active.
+ */
+static struct sock *mptcp_sched_lowrtt_get_subflow(struct mptcp_sock *msk)
+{
+	struct sock *send_ssk[SSK_MODE_MAX] = { NULL, NULL };
+	u32 send_srtt[SSK_MODE_MAX] = { U32_MAX, U32_MAX };
+	struct mptcp_subflow_context *subflow;
+	struct sock *sk = (struct sock *)msk;
+	int nr_active = 0;
+
+	mptcp_for_each_subflow(msk, subflow) {
+		struct sock *ssk = mptcp_subflow_tcp_sock(subflow);
+		u32 srtt;
+
+		if (!mptcp_subflow_active(subflow))
+			continue;
+
+		nr_active += !subflow->backup;
+		if (!sk_stream_memory_free(ssk))
+			continue;
+
+		srtt = READ_ONCE(tcp_sk(ssk)->srtt_us);
+		if (srtt < send_srtt[subflow->backup]) {
+			send_ssk[subflow->backup] = ssk;
+			send_srtt[subflow->backup] = srtt;
+		}
+	}
+	mptcp_set_timeout(sk);
+
+	/* bursts are a property of the default scheduler only */
+	msk->last_snd = NULL;
+
+	if (!nr_active)
+		return send_ssk[SSK_MODE_BACKUP];
+
+	return send_ssk[SSK_MODE_ACTIVE];
+}
+
+static struct mptcp_sched_ops mptcp_sched_lowrtt = {
+	.get_subflow	= mptcp_sched_lowrtt_get_subflow,
+	.name		= "lowrtt",
+	.owner		= THIS_MODULE,
+};
+
+/* Must be called with rcu read lock held */
+struct mptcp_sched_ops *mptcp_sched_find(const char *name)
+{
+	struct mptcp_sched_ops *sched;
+
+	list_for_each_entry_rcu(sched, &mptcp_sched_list, list) {
+		if (!strcmp(sched->name, name))
+			return sched;
+	}
+
+	return NULL;
+}
+
+int mptcp_register_scheduler(struct mptcp_sched_ops *sched)
+{
+	if (!sched->get_subflow)
+		return -EINVAL;
+
+	spin_lock(&mptcp_sched_list_lock);
+	if (mptcp_sched_find(sched->name)) {
+		spin_unlock(&mptcp_sched_list_lock);
+		return -EEXIST;
+	}
+	list_add_tail_rcu(&sched->list, &mptcp_sched_list);
+	spin_unlock(&mptcp_sched_list_lock);
+
+	pr_debug("%s registered", sched->name);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(mptcp_register_scheduler);
+
+void mptcp_unregister_scheduler(struct mptcp_sched_ops *sched)
+{
+	if (sched == &mptcp_sched_default)
+		return;
+
+	spin_lock(&mptcp_sched_list_lock);
+	list_del_rcu(&sched->list);
+	spin_unlock(&mptcp_sched_list_lock);
+
+	/* sockets only pin the module, make sure no reader is still walking
+	 * the list past this entry
+	 */
+	synchronize_rcu();
+}
+EXPORT_SYMBOL_GPL(mptcp_unregister_scheduler);
+
+void mptcp_sched_init(void)
+{
+	mptcp_register_scheduler(&mptcp_sched_default);
+	mptcp_register_scheduler(&mptcp_sched_lowrtt);
+}
+
+/* Attach @sched to @msk, falling back to the default scheduler when @sched
+ * is NULL or its module is going away.
+ */
+void mptcp_init_sched(struct mptcp_sock *msk, struct mptcp_sched_ops *sched)
+{
+	if (!sched || !try_module_get(sched->owner))
+		sched = &mptcp_sched_default;
+
+	msk->sched = sched;
+	if (msk->sched->init)
+		msk->sched->init(msk);
+
+	pr_debug("sched=%s", msk->sched->name);
+}
+
+void mptcp_init_sched_by_name(struct mptcp_sock *msk, const char *name)
+{
+	struct mptcp_sched_ops *sched;
+
+	rcu_read_lock();
+	sched = mptcp_sched_find(name);
+	if (!sched)
+		pr_warn_once("unknown scheduler %s, using default", name);
+	mptcp_init_sched(msk, sched);
+	rcu_read_unlock();
+}
+
+void mptcp_release_sched(struct mptcp_sock *msk)
+{
+	struct mptcp_sched_ops *sched = msk->sched;
+
+	if (!sched)
+		return;
+
+	msk->sched = NULL;
+	if (sched->release)
+		sched->release(msk);
+
+	module_put(sched->owner);
+}
+
+struct sock *mptcp_sched_get_send(struct mptcp_sock *msk)
+{
+	sock_owned_by_me((struct sock *)msk);
+
+	if (__mptcp_check_fallback(msk)) {
+		if (!msk->first)
+			return NULL;
+		return __tcp_can_send(msk->first) &&
+		       sk_stream_memory_free(msk->first) ? msk->first : NULL;
+	}
+
+	return msk->sched->get_subflow(msk);
+}
@@ -1487,6 +1487,13 @@ static void do_one_broadcast(struct sock *sk,
 	sock_put(sk);
 }
 
+/* All listeners share one trimmed skb (each is charged its truesize), so the
+ * cost of a notification burst is bounded by the listener's receive buffer,
+ * not by copies. The shared-memory ring that used to sit here was removed
+ * because it could not be made safe against concurrent ring access by user
+ * space; listeners that must survive bursts should size SO_RCVBUF(FORCE)
+ * accordingly and resync on ENOBUFS.
+ */
 int netlink_broadcast(struct sock *ssk, struct sk_buff *skb, u32 portid,
 		      u32 group, gfp_t allocation)
 {
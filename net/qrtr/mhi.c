@@ -17,7 +17,14 @@ struct qrtr_mhi_dev {
 	struct device *dev;
 };
 
-/* From MHI to QRTR */
+/* From MHI to QRTR
+ *
+ * The downlink buffers are allocated and queued by the MHI core on our behalf
+ * (see mhi_prepare_for_transfer_autoqueue()) and are recycled as soon as this
+ * callback returns, so the payload can't be attached to an skb as a fragment;
+ * qrtr_endpoint_post() has to copy it. QRTR packets are small control
+ * messages, so the copy is cheap next to the MHI completion itself.
+ */
 static void qcom_mhi_qrtr_dl_callback(struct mhi_device *mhi_dev,
 				      struct mhi_result *mhi_res)
 {
@@ -11,6 +11,7 @@
 #include <linux/rhashtable.h>
 #include <linux/refcount.h>
 #include <linux/in6.h>
+#include <linux/log2.h>
 
 #include "info.h"
 
@@ -909,6 +910,16 @@ void rds6_inc_info_copy(struct rds_incoming *inc,
 			int flip);
 
 /* send.c */
+extern unsigned int rds_mpath_lanes;
+
+static inline int rds_mpath_max_lanes(void)
+{
+	unsigned int lanes = READ_ONCE(rds_mpath_lanes);
+
+	return rounddown_pow_of_two(clamp_t(unsigned int, lanes, 1,
+					    RDS_MPATH_WORKERS));
+}
+
 int rds_sendmsg(struct socket *sock, struct msghdr *msg, size_t payload_len);
 void rds_send_path_reset(struct rds_conn_path *conn);
 int rds_send_xmit(struct rds_conn_path *cp);
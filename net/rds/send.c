@@ -56,6 +56,15 @@ static int send_batch_count = SZ_1K;
 module_param(send_batch_count, int, 0444);
 MODULE_PARM_DESC(send_batch_count, " batch factor when working the send queue");
 
+/*
+ * mpath_lanes is the number of paths we offer to multipath capable peers;
+ * a connection uses the smaller of the two sides' offers. It is rounded
+ * down to a power of 2 no larger than RDS_MPATH_WORKERS.
+ */
+unsigned int rds_mpath_lanes = RDS_MPATH_WORKERS;
+module_param_named(mpath_lanes, rds_mpath_lanes, uint, 0644);
+MODULE_PARM_DESC(mpath_lanes, " number of paths offered per multipath connection");
+
 static void rds_send_remove_from_sock(struct list_head *messages, int status);
 
 /*
@@ -1460,7 +1469,7 @@ rds_send_probe(struct rds_conn_path *cp, __be16 sport,
 
 	if (RDS_HS_PROBE(be16_to_cpu(sport), be16_to_cpu(dport)) &&
 	    cp->cp_conn->c_trans->t_mp_capable) {
-		u16 npaths = cpu_to_be16(RDS_MPATH_WORKERS);
+		u16 npaths = cpu_to_be16(rds_mpath_max_lanes());
 		u32 my_gen_num = cpu_to_be32(cp->cp_conn->c_my_gen_num);
 
 		rds_message_add_extension(&rm->m_inc.i_hdr,
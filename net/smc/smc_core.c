@@ -2002,6 +2002,37 @@ static struct smc_buf_desc *smc_buf_get_slot(int compressed_bufsize,
 	return NULL;
 }
 
+/* no idle buffer of the requested size is left in the link group; before
+ * registering a new one, try to reuse an idle buffer of a larger size class.
+ * Returns the buffer and updates @bufsize_short, or NULL if none is idle.
+ */
+static struct smc_buf_desc *smc_buf_get_larger_slot(struct smc_link_group *lgr,
+						    int *bufsize_short,
+						    bool is_smcd, bool is_rmb)
+{
+	int max = is_smcd ? SMCD_DMBE_SIZES : SMCR_RMBE_SIZES;
+	struct smc_buf_desc *buf_desc;
+	struct list_head *buf_list;
+	struct mutex *lock;
+	int i;
+
+	for (i = *bufsize_short + 1; i <= max; i++) {
+		if (is_rmb) {
+			lock = &lgr->rmbs_lock;
+			buf_list = &lgr->rmbs[i];
+		} else {
+			lock = &lgr->sndbufs_lock;
+			buf_list = &lgr->sndbufs[i];
+		}
+		buf_desc = smc_buf_get_slot(i, lock, buf_list);
+		if (buf_desc) {
+			*bufsize_short = i;
+			return buf_desc;
+		}
+	}
+	return NULL;
+}
+
 /* one of the conditions for announcing a receiver's current window size is
  * that it "results in a minimum increase in the window size of 10% of the
  * receive buffer space" [RFC7609]
@@ -2329,6 +2360,11 @@ static int __smc_buf_create(struct smc_sock *smc, bool is_smcd, bool is_rmb)
 
 		/* check for reusable slot in the link group */
 		buf_desc = smc_buf_get_slot(bufsize_short, lock, buf_list);
+		if (!buf_desc && !is_dgraded) {
+			buf_desc = smc_buf_get_larger_slot(lgr, &bufsize_short,
+							   is_smcd, is_rmb);
+			bufsize = smc_uncompress_bufsize(bufsize_short);
+		}
 		if (buf_desc) {
 			buf_desc->is_dma_need_sync = 0;
 			SMC_STAT_RMB_SIZE(smc, is_smcd, is_rmb, bufsize);
@@ -54,6 +54,7 @@ struct tls_decrypt_arg {
 	);
 
 	struct sk_buff *skb;
+	bool async_done;
 };
 
 struct tls_decrypt_ctx {
@@ -188,6 +189,10 @@ static void tls_decrypt_done(struct crypto_async_request *req, int err)
 	unsigned int pages;
 	struct sock *sk;
 
+	/* A backlogged request has been moved to the engine queue */
+	if (err == -EINPROGRESS)
+		return;
+
 	sk = (struct sock *)req->data;
 	tls_ctx = tls_get_ctx(sk);
 	ctx = tls_sw_ctx_rx(tls_ctx);
@@ -218,6 +223,21 @@ static void tls_decrypt_done(struct crypto_async_request *req, int err)
 	spin_unlock_bh(&ctx->decrypt_compl_lock);
 }
 
+/* Wait for all in-flight async decryptions to complete */
+static int tls_decrypt_async_wait(struct tls_sw_context_rx *ctx)
+{
+	int pending;
+
+	spin_lock_bh(&ctx->decrypt_compl_lock);
+	reinit_completion(&ctx->async_wait.completion);
+	pending = atomic_read(&ctx->decrypt_pending);
+	spin_unlock_bh(&ctx->decrypt_compl_lock);
+	if (pending)
+		return crypto_wait_req(-EINPROGRESS, &ctx->async_wait);
+
+	return 0;
+}
+
 static int tls_do_decryption(struct sock *sk,
 			     struct scatterlist *sgin,
 			     struct scatterlist *sgout,
@@ -249,7 +269,18 @@ static int tls_do_decryption(struct sock *sk,
 	}
 
 	ret = crypto_aead_decrypt(aead_req);
-	if (ret == -EINPROGRESS) {
+	darg->async_done = false;
+	if (ret == -EBUSY && darg->async) {
+		/* The engine queue is full and the request got backlogged.
+		 * Let the records already in flight drain before submitting
+		 * more, the backlogged one completes along with them and its
+		 * callback has released the request.
+		 */
+		ret = tls_decrypt_async_wait(ctx);
+		darg->async_done = true;
+		if (!ret)
+			return 0;
+	} else if (ret == -EINPROGRESS || ret == -EBUSY) {
 		if (darg->async)
 			return 0;
 
@@ -1202,6 +1233,10 @@ static int tls_sw_do_sendpage(struct sock *sk, struct page *page,
 			full_record = true;
 		}
 
+		/* The page is referenced, not copied: AEAD reads the plaintext
+		 * straight from it and writes the ciphertext into msg_en, so
+		 * sendfile() from page cache needs no TLS_TX_ZEROCOPY_RO here.
+		 */
 		sk_msg_page_add(msg_pl, page, copy, offset);
 		sk_mem_charge(sk, copy);
 
@@ -1567,8 +1602,11 @@ static int tls_decrypt_sg(struct sock *sk, struct iov_iter *out_iov,
 	/* Prepare and submit AEAD request */
 	err = tls_do_decryption(sk, sgin, sgout, dctx->iv,
 				data_len + prot->tail_size, aead_req, darg);
-	if (err)
+	if (err) {
+		if (darg->async_done)
+			goto exit_free_skb;
 		goto exit_free_pages;
+	}
 
 	darg->skb = clear_skb ?: tls_strp_msg(ctx);
 	clear_skb = NULL;
@@ -2082,16 +2120,10 @@ int tls_sw_recvmsg(struct sock *sk,
 
 recv_end:
 	if (async) {
-		int ret, pending;
+		int ret;
 
 		/* Wait for all previously submitted records to be decrypted */
-		spin_lock_bh(&ctx->decrypt_compl_lock);
-		reinit_completion(&ctx->async_wait.completion);
-		pending = atomic_read(&ctx->decrypt_pending);
-		spin_unlock_bh(&ctx->decrypt_compl_lock);
-		ret = 0;
-		if (pending)
-			ret = crypto_wait_req(-EINPROGRESS, &ctx->async_wait);
+		ret = tls_decrypt_async_wait(ctx);
 		__skb_queue_purge(&ctx->async_hold);
 
 		if (ret) {
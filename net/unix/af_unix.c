@@ -2258,6 +2258,10 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 	return sent ? : err;
 }
 
+/* Pages handed in here are attached to the skb by reference, so data spliced
+ * into the socket (e.g. vmsplice() into a pipe, then splice() to the socket)
+ * is only copied once, by the receiver.
+ */
 static ssize_t unix_stream_sendpage(struct socket *socket, struct page *page,
 				    int offset, size_t size, int flags)
 {
@@ -31,6 +31,7 @@
 #include "xsk.h"
 
 #define TX_BATCH_SIZE 32
+#define TX_CQ_RESERVE_BATCH 16
 
 static DEFINE_PER_CPU(struct list_head, xskmap_flush_list);
 
@@ -222,6 +223,14 @@ static int xsk_rcv_check(struct xdp_sock *xs, struct xdp_buff *xdp)
 	if (xs->dev != xdp->rxq->dev || xs->queue_id != xdp->rxq->queue_index)
 		return -EINVAL;
 
+	/* Only the linear part of a frame fits into a descriptor. Drop
+	 * multi-buffer frames rather than deliver them truncated.
+	 */
+	if (unlikely(xdp_buff_has_frags(xdp))) {
+		xs->rx_dropped++;
+		return -EMSGSIZE;
+	}
+
 	sk_mark_napi_id_once_xdp(&xs->sk, xdp);
 	return 0;
 }
@@ -516,6 +525,7 @@ static int xsk_generic_xmit(struct sock *sk)
 	struct xdp_sock *xs = xdp_sk(sk);
 	u32 max_batch = TX_BATCH_SIZE;
 	bool sent_frame = false;
+	u32 reserved = 0;
 	struct xdp_desc desc;
 	struct sk_buff *skb;
 	unsigned long flags;
@@ -542,20 +552,27 @@ static int xsk_generic_xmit(struct sock *sk)
 		 * Reserve space in the completion queue and only proceed
 		 * if there is space in it. This avoids having to implement
 		 * any buffering in the Tx path.
+		 *
+		 * The cq_lock is shared with the skb destructors of all
+		 * sockets on this pool, so reserve entries for a batch of
+		 * descriptors at a time and give back the unused ones at
+		 * the end.
 		 */
-		spin_lock_irqsave(&xs->pool->cq_lock, flags);
-		if (xskq_prod_reserve(xs->pool->cq)) {
+		if (!reserved) {
+			u32 want = min3(max_batch + 1, (u32)TX_CQ_RESERVE_BATCH,
+					xskq_cons_nb_entries(xs->tx,
+							     TX_CQ_RESERVE_BATCH));
+
+			spin_lock_irqsave(&xs->pool->cq_lock, flags);
+			reserved = xskq_prod_reserve_n(xs->pool->cq, want);
 			spin_unlock_irqrestore(&xs->pool->cq_lock, flags);
-			goto out;
+			if (!reserved)
+				goto out;
 		}
-		spin_unlock_irqrestore(&xs->pool->cq_lock, flags);
 
 		skb = xsk_build_skb(xs, &desc);
 		if (IS_ERR(skb)) {
 			err = PTR_ERR(skb);
-			spin_lock_irqsave(&xs->pool->cq_lock, flags);
-			xskq_prod_cancel(xs->pool->cq);
-			spin_unlock_irqrestore(&xs->pool->cq_lock, flags);
 			goto out;
 		}
 
@@ -563,15 +580,14 @@ static int xsk_generic_xmit(struct sock *sk)
 		if  (err == NETDEV_TX_BUSY) {
 			/* Tell user-space to retry the send */
 			skb->destructor = sock_wfree;
-			spin_lock_irqsave(&xs->pool->cq_lock, flags);
-			xskq_prod_cancel(xs->pool->cq);
-			spin_unlock_irqrestore(&xs->pool->cq_lock, flags);
 			/* Free skb without triggering the perf drop trace */
 			consume_skb(skb);
 			err = -EAGAIN;
 			goto out;
 		}
 
+		/* The skb destructor now owns this completion entry */
+		reserved--;
 		xskq_cons_release(xs->tx);
 		/* Ignore NET_XMIT_CN as packet might have been sent */
 		if (err == NET_XMIT_DROP) {
@@ -586,6 +602,11 @@ static int xsk_generic_xmit(struct sock *sk)
 	xs->tx->queue_empty_descs++;
 
 out:
+	if (reserved) {
+		spin_lock_irqsave(&xs->pool->cq_lock, flags);
+		xskq_prod_cancel_n(xs->pool->cq, reserved);
+		spin_unlock_irqrestore(&xs->pool->cq_lock, flags);
+	}
 	if (sent_frame)
 		if (xsk_tx_writeable(xs))
 			sk->sk_write_space(sk);
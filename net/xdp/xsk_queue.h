@@ -330,6 +330,11 @@ static inline void xskq_prod_cancel(struct xsk_queue *q)
 	q->cached_prod--;
 }
 
+static inline void xskq_prod_cancel_n(struct xsk_queue *q, u32 cnt)
+{
+	q->cached_prod -= cnt;
+}
+
 static inline int xskq_prod_reserve(struct xsk_queue *q)
 {
 	if (xskq_prod_is_full(q))
@@ -340,6 +345,16 @@ static inline int xskq_prod_reserve(struct xsk_queue *q)
 	return 0;
 }
 
+/* Reserve up to @max entries, returns the number actually reserved. */
+static inline u32 xskq_prod_reserve_n(struct xsk_queue *q, u32 max)
+{
+	u32 nb_entries = xskq_prod_nb_free(q, max);
+
+	/* A, matches D */
+	q->cached_prod += nb_entries;
+	return nb_entries;
+}
+
 static inline int xskq_prod_reserve_addr(struct xsk_queue *q, u64 addr)
 {
 	struct xdp_umem_ring *ring = (struct xdp_umem_ring *)q->ring;
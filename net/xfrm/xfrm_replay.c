@@ -507,6 +507,14 @@ static int xfrm_replay_check_esn(struct xfrm_state *x,
 	return -EINVAL;
 }
 
+/* Replay checking is done twice per packet under x->lock: once before
+ * decryption to drop obvious replays cheaply, and once more (recheck +
+ * advance) after it. Decryption itself runs without the lock, so packets of
+ * one SA spread over several CPUs, or handed to an async crypto engine, are
+ * only serialized for these few bitmap operations. The window update has to
+ * be atomic with the recheck, otherwise two CPUs could both accept the same
+ * sequence number, and with ESN seq_hi must move together with the bitmap.
+ */
 int xfrm_replay_check(struct xfrm_state *x,
 		      struct sk_buff *skb, __be32 net_seq)
 {
@@ -84,6 +84,26 @@ static unsigned int xfrm_seq_hash(struct net *net, u32 seq)
 	return __xfrm_seq_hash(seq, net->xfrm.state_hmask);
 }
 
+#define XFRM_STATE_LOOKUP_CACHE_SIZE	16
+
+struct xfrm_state_lookup_ent {
+	struct xfrm_state	*x;
+	u32			mark;
+	unsigned int		genid;
+};
+
+struct xfrm_state_lookup_cache {
+	struct xfrm_state_lookup_ent	ent[XFRM_STATE_LOOKUP_CACHE_SIZE];
+};
+
+/* Called with xfrm_state_lock held after changing the byspi table. */
+static void xfrm_state_lookup_invalidate(struct net *net)
+{
+	smp_wmb();
+	WRITE_ONCE(net->xfrm.state_lookup_genid,
+		   net->xfrm.state_lookup_genid + 1);
+}
+
 static void xfrm_hash_transfer(struct hlist_head *list,
 			       struct hlist_head *ndsttable,
 			       struct hlist_head *nsrctable,
@@ -159,6 +179,7 @@ static void xfrm_hash_resize(struct work_struct *work)
 
 	spin_lock_bh(&net->xfrm.xfrm_state_lock);
 	write_seqcount_begin(&net->xfrm.xfrm_state_hash_generation);
+	xfrm_state_lookup_invalidate(net);
 
 	nhashmask = (nsize / sizeof(struct hlist_head)) - 1U;
 	odst = xfrm_state_deref_prot(net->xfrm.state_bydst, net);
@@ -689,8 +710,10 @@ int __xfrm_state_delete(struct xfrm_state *x)
 		hlist_del_rcu(&x->bysrc);
 		if (x->km.seq)
 			hlist_del_rcu(&x->byseq);
-		if (x->id.spi)
+		if (x->id.spi) {
 			hlist_del_rcu(&x->byspi);
+			xfrm_state_lookup_invalidate(net);
+		}
 		net->xfrm.state_num--;
 		spin_unlock(&net->xfrm.xfrm_state_lock);
 
@@ -1172,6 +1195,7 @@ xfrm_state_find(const xfrm_address_t *daddr, const xfrm_address_t *saddr,
 			if (x->id.spi) {
 				h = xfrm_spi_hash(net, &x->id.daddr, x->id.spi, x->id.proto, encap_family);
 				hlist_add_head_rcu(&x->byspi, net->xfrm.state_byspi + h);
+				xfrm_state_lookup_invalidate(net);
 			}
 			if (x->km.seq) {
 				h = xfrm_seq_hash(net, x->km.seq);
@@ -1290,6 +1314,7 @@ static void __xfrm_state_insert(struct xfrm_state *x)
 				  x->props.family);
 
 		hlist_add_head_rcu(&x->byspi, net->xfrm.state_byspi + h);
+		xfrm_state_lookup_invalidate(net);
 	}
 
 	if (x->km.seq) {
@@ -1806,14 +1831,70 @@ int xfrm_state_check_expire(struct xfrm_state *x)
 }
 EXPORT_SYMBOL(xfrm_state_check_expire);
 
+static struct xfrm_state_lookup_ent *
+xfrm_state_lookup_slot(struct net *net, __be32 spi)
+{
+	struct xfrm_state_lookup_cache *cache;
+
+	cache = this_cpu_ptr(net->xfrm.state_lookup_cache);
+
+	return &cache->ent[ntohl(spi) & (XFRM_STATE_LOOKUP_CACHE_SIZE - 1)];
+}
+
+/* Must be called from softirq context under rcu_read_lock(). An entry is
+ * only trusted while the generation it was filled under is current: any
+ * state leaving the byspi table bumps the generation before the state can
+ * be freed, and freeing waits for a grace period, so the entry's state
+ * can't have been freed under us.
+ */
+static struct xfrm_state *
+xfrm_state_lookup_cached(struct net *net, u32 mark, const xfrm_address_t *daddr,
+			__be32 spi, u8 proto, unsigned short family)
+{
+	struct xfrm_state_lookup_ent *e = xfrm_state_lookup_slot(net, spi);
+	struct xfrm_state *x = e->x;
+
+	if (!x || e->genid != READ_ONCE(net->xfrm.state_lookup_genid) ||
+	    e->mark != mark)
+		return NULL;
+	if (x->props.family != family ||
+	    x->id.spi       != spi ||
+	    x->id.proto     != proto ||
+	    !xfrm_addr_equal(&x->id.daddr, daddr, family))
+		return NULL;
+	if (!xfrm_state_hold_rcu(x))
+		return NULL;
+	return x;
+}
+
 struct xfrm_state *
 xfrm_state_lookup(struct net *net, u32 mark, const xfrm_address_t *daddr, __be32 spi,
 		  u8 proto, unsigned short family)
 {
+	struct xfrm_state_lookup_ent *e;
+	bool use_cache = in_softirq();
+	unsigned int genid = 0;
 	struct xfrm_state *x;
 
 	rcu_read_lock();
+	if (use_cache) {
+		x = xfrm_state_lookup_cached(net, mark, daddr, spi, proto,
+					    family);
+		if (x)
+			goto out;
+		/* Pairs with smp_wmb() in xfrm_state_lookup_invalidate() */
+		genid = READ_ONCE(net->xfrm.state_lookup_genid);
+		smp_rmb();
+	}
+
 	x = __xfrm_state_lookup(net, mark, daddr, spi, proto, family);
+	if (use_cache && x) {
+		e = xfrm_state_lookup_slot(net, spi);
+		e->x = x;
+		e->mark = mark;
+		e->genid = genid;
+	}
+out:
 	rcu_read_unlock();
 	return x;
 }
@@ -2086,6 +2167,7 @@ int xfrm_alloc_spi(struct xfrm_state *x, u32 low, u32 high)
 		x->id.spi = newspi;
 		h = xfrm_spi_hash(net, &x->id.daddr, x->id.spi, x->id.proto, x->props.family);
 		hlist_add_head_rcu(&x->byspi, net->xfrm.state_byspi + h);
+		xfrm_state_lookup_invalidate(net);
 		spin_unlock_bh(&net->xfrm.xfrm_state_lock);
 
 		err = 0;
@@ -2737,6 +2819,11 @@ int __net_init xfrm_state_init(struct net *net)
 		goto out_byseq;
 	net->xfrm.state_hmask = ((sz / sizeof(struct hlist_head)) - 1);
 
+	net->xfrm.state_lookup_cache = alloc_percpu(struct xfrm_state_lookup_cache);
+	if (!net->xfrm.state_lookup_cache)
+		goto out_cache;
+	net->xfrm.state_lookup_genid = 0;
+
 	net->xfrm.state_num = 0;
 	INIT_WORK(&net->xfrm.state_hash_work, xfrm_hash_resize);
 	spin_lock_init(&net->xfrm.xfrm_state_lock);
@@ -2744,6 +2831,8 @@ int __net_init xfrm_state_init(struct net *net)
 			       &net->xfrm.xfrm_state_lock);
 	return 0;
 
+out_cache:
+	xfrm_hash_free(net->xfrm.state_byseq, sz);
 out_byseq:
 	xfrm_hash_free(net->xfrm.state_byspi, sz);
 out_byspi:
@@ -2773,6 +2862,7 @@ void xfrm_state_fini(struct net *net)
 	xfrm_hash_free(net->xfrm.state_bysrc, sz);
 	WARN_ON(!hlist_empty(net->xfrm.state_bydst));
 	xfrm_hash_free(net->xfrm.state_bydst, sz);
+	free_percpu(net->xfrm.state_lookup_cache);
 }
 
 #ifdef CONFIG_AUDITSYSCALL
@@ -20,6 +20,12 @@
 
 #define LPASS_PLATFORM_BUFFER_SIZE	(24 *  2 * 1024)
 #define LPASS_PLATFORM_PERIODS		2
+/*
+ * Small periods let low latency clients run with ~1 ms periods; the DMA
+ * transfers INCR4 bursts of 32-bit words, so keep periods burst aligned.
+ */
+#define LPASS_PLATFORM_PERIOD_BYTES_MIN	64
+#define LPASS_PLATFORM_PERIOD_BYTES_ALIGN	16
 #define LPASS_RXTX_CDC_DMA_LPM_BUFF_SIZE (8 * 1024)
 #define LPASS_VA_CDC_DMA_LPM_BUFF_SIZE (12 * 1024)
 #define LPASS_CDC_DMA_REGISTER_FIELDS_MAX 15
@@ -29,7 +35,8 @@ static const struct snd_pcm_hardware lpass_platform_pcm_hardware = {
 					SNDRV_PCM_INFO_MMAP_VALID |
 					SNDRV_PCM_INFO_INTERLEAVED |
 					SNDRV_PCM_INFO_PAUSE |
-					SNDRV_PCM_INFO_RESUME,
+					SNDRV_PCM_INFO_RESUME |
+					SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.formats		=	SNDRV_PCM_FMTBIT_S16 |
 					SNDRV_PCM_FMTBIT_S24 |
 					SNDRV_PCM_FMTBIT_S32,
@@ -41,10 +48,10 @@ static const struct snd_pcm_hardware lpass_platform_pcm_hardware = {
 	.buffer_bytes_max	=	LPASS_PLATFORM_BUFFER_SIZE,
 	.period_bytes_max	=	LPASS_PLATFORM_BUFFER_SIZE /
 						LPASS_PLATFORM_PERIODS,
-	.period_bytes_min	=	LPASS_PLATFORM_BUFFER_SIZE /
-						LPASS_PLATFORM_PERIODS,
+	.period_bytes_min	=	LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.periods_min		=	LPASS_PLATFORM_PERIODS,
-	.periods_max		=	LPASS_PLATFORM_PERIODS,
+	.periods_max		=	LPASS_PLATFORM_BUFFER_SIZE /
+						LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.fifo_size		=	0,
 };
 
@@ -53,7 +60,8 @@ static const struct snd_pcm_hardware lpass_platform_rxtx_hardware = {
 					SNDRV_PCM_INFO_MMAP_VALID |
 					SNDRV_PCM_INFO_INTERLEAVED |
 					SNDRV_PCM_INFO_PAUSE |
-					SNDRV_PCM_INFO_RESUME,
+					SNDRV_PCM_INFO_RESUME |
+					SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.formats		=	SNDRV_PCM_FMTBIT_S16 |
 					SNDRV_PCM_FMTBIT_S24 |
 					SNDRV_PCM_FMTBIT_S32,
@@ -65,10 +73,10 @@ static const struct snd_pcm_hardware lpass_platform_rxtx_hardware = {
 	.buffer_bytes_max	=	LPASS_RXTX_CDC_DMA_LPM_BUFF_SIZE,
 	.period_bytes_max	=	LPASS_RXTX_CDC_DMA_LPM_BUFF_SIZE /
 						LPASS_PLATFORM_PERIODS,
-	.period_bytes_min	=	LPASS_RXTX_CDC_DMA_LPM_BUFF_SIZE /
-						LPASS_PLATFORM_PERIODS,
+	.period_bytes_min	=	LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.periods_min		=	LPASS_PLATFORM_PERIODS,
-	.periods_max		=	LPASS_PLATFORM_PERIODS,
+	.periods_max		=	LPASS_RXTX_CDC_DMA_LPM_BUFF_SIZE /
+						LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.fifo_size		=	0,
 };
 
@@ -77,7 +85,8 @@ static const struct snd_pcm_hardware lpass_platform_va_hardware = {
 					SNDRV_PCM_INFO_MMAP_VALID |
 					SNDRV_PCM_INFO_INTERLEAVED |
 					SNDRV_PCM_INFO_PAUSE |
-					SNDRV_PCM_INFO_RESUME,
+					SNDRV_PCM_INFO_RESUME |
+					SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.formats		=	SNDRV_PCM_FMTBIT_S16 |
 					SNDRV_PCM_FMTBIT_S24 |
 					SNDRV_PCM_FMTBIT_S32,
@@ -89,10 +98,10 @@ static const struct snd_pcm_hardware lpass_platform_va_hardware = {
 	.buffer_bytes_max	=	LPASS_VA_CDC_DMA_LPM_BUFF_SIZE,
 	.period_bytes_max	=	LPASS_VA_CDC_DMA_LPM_BUFF_SIZE /
 						LPASS_PLATFORM_PERIODS,
-	.period_bytes_min	=	LPASS_VA_CDC_DMA_LPM_BUFF_SIZE /
-						LPASS_PLATFORM_PERIODS,
+	.period_bytes_min	=	LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.periods_min		=	LPASS_PLATFORM_PERIODS,
-	.periods_max		=	LPASS_PLATFORM_PERIODS,
+	.periods_max		=	LPASS_VA_CDC_DMA_LPM_BUFF_SIZE /
+						LPASS_PLATFORM_PERIOD_BYTES_MIN,
 	.fifo_size		=	0,
 };
 
@@ -277,6 +286,16 @@ static int lpass_platform_pcmops_open(struct snd_soc_component *component,
 		return -EINVAL;
 	}
 
+	ret = snd_pcm_hw_constraint_step(runtime, 0,
+			SNDRV_PCM_HW_PARAM_PERIOD_BYTES,
+			LPASS_PLATFORM_PERIOD_BYTES_ALIGN);
+	if (ret < 0) {
+		kfree(data);
+		dev_err(soc_runtime->dev, "setting constraints failed: %d\n",
+			ret);
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -761,6 +780,13 @@ static int lpass_platform_pcmops_trigger(struct snd_soc_component *component,
 			return -EINVAL;
 		}
 
+		/*
+		 * Clients that poll the DMA position do not want the period
+		 * interrupt, xrun and bus errors are still reported.
+		 */
+		if (rt->no_period_wakeup)
+			val_irqen &= ~LPAIF_IRQ_PER(ch);
+
 		ret = regmap_write_bits(map, reg_irqclr, val_irqclr, val_irqclr);
 		if (ret) {
 			dev_err(soc_runtime->dev, "error writing to irqclear reg: %d\n", ret);
@@ -873,13 +899,11 @@ static snd_pcm_uframes_t lpass_platform_pcmops_pointer(
 	map = __lpass_get_regmap_handle(substream, component);
 	ch = pcm_data->dma_ch;
 
-	ret = regmap_read(map,
-			LPAIF_DMABASE_REG(v, ch, dir, dai_id), &base_addr);
-	if (ret) {
-		dev_err(soc_runtime->dev,
-			"error reading from rdmabase reg: %d\n", ret);
-		return ret;
-	}
+	/*
+	 * Polling clients call this at a high rate: use the base address
+	 * programmed at prepare time rather than reading DMABASE back.
+	 */
+	base_addr = lower_32_bits(rt->dma_addr);
 
 	ret = regmap_read(map,
 			LPAIF_DMACURR_REG(v, ch, dir, dai_id), &curr_addr);
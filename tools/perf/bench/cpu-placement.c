@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Topology aware placement of benchmark threads.
+ *
+ * "pack" keeps the CPUs of a cluster together, so that consecutive threads
+ * share a cluster as long as it has CPUs left. "spread" alternates between
+ * the clusters, so that consecutive threads run on different clusters. This
+ * allows comparing lock handoffs and wakeups within a cluster to those that
+ * cross clusters, which matters on heterogeneous systems. Clusters are taken
+ * from the topology the kernel exports in sysfs; on systems without clusters
+ * every package counts as one.
+ *
+ * DynamIQ systems report the same cluster_id for all cores, big and little
+ * ones alike. When a package has a single cluster, its CPUs are grouped by
+ * cpufreq policy instead, or by CPU capacity without cpufreq.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <api/fs/fs.h>
+#include <perf/cpumap.h>
+#include "cpu-placement.h"
+
+struct placement_cpu {
+	int cpu;
+	int package;
+	int cluster;
+	int rank;	/* position within its cluster */
+};
+
+static int topology_read_id(int cpu, const char *name)
+{
+	char path[PATH_MAX];
+	int id;
+
+	snprintf(path, sizeof(path), "devices/system/cpu/cpu%d/topology/%s",
+		 cpu, name);
+	if (sysfs__read_int(path, &id) || id < 0)
+		return 0;
+
+	return id;
+}
+
+/* The first CPU of the cpufreq policy of @cpu, or else its capacity */
+static int topology_read_group(int cpu)
+{
+	char path[PATH_MAX];
+	size_t len;
+	char *buf;
+	int id;
+
+	snprintf(path, sizeof(path),
+		 "devices/system/cpu/cpu%d/cpufreq/related_cpus", cpu);
+	if (!sysfs__read_str(path, &buf, &len)) {
+		id = atoi(buf);
+		free(buf);
+		return id;
+	}
+
+	snprintf(path, sizeof(path), "devices/system/cpu/cpu%d/cpu_capacity",
+		 cpu);
+	if (sysfs__read_int(path, &id) || id < 0)
+		return 0;
+
+	return id;
+}
+
+static int cmp_pack(const void *a, const void *b)
+{
+	const struct placement_cpu *pa = a, *pb = b;
+
+	if (pa->package != pb->package)
+		return pa->package - pb->package;
+	if (pa->cluster != pb->cluster)
+		return pa->cluster - pb->cluster;
+	return pa->cpu - pb->cpu;
+}
+
+static int cmp_spread(const void *a, const void *b)
+{
+	const struct placement_cpu *pa = a, *pb = b;
+
+	if (pa->rank != pb->rank)
+		return pa->rank - pb->rank;
+	return cmp_pack(a, b);
+}
+
+/*
+ * Returns the CPUs of @cpus in the order threads should be placed on them,
+ * as an array of perf_cpu_map__nr(@cpus) CPU numbers to be freed by the
+ * caller. A NULL @placement keeps the order of @cpus. Returns NULL with
+ * errno set if @placement is not known or on allocation failure.
+ */
+int *bench__cpu_placement(struct perf_cpu_map *cpus, const char *placement)
+{
+	int i, nr = perf_cpu_map__nr(cpus);
+	struct placement_cpu *pcpus;
+	bool spread = false;
+	int *order;
+
+	if (placement) {
+		if (!strcmp(placement, "spread"))
+			spread = true;
+		else if (strcmp(placement, "pack")) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	order = calloc(nr, sizeof(*order));
+	pcpus = calloc(nr, sizeof(*pcpus));
+	if (!order || !pcpus)
+		goto out_free;
+
+	for (i = 0; i < nr; i++) {
+		pcpus[i].cpu = perf_cpu_map__cpu(cpus, i).cpu;
+		if (!placement)
+			continue;
+		pcpus[i].package = topology_read_id(pcpus[i].cpu, "physical_package_id");
+		pcpus[i].cluster = topology_read_id(pcpus[i].cpu, "cluster_id");
+	}
+
+	if (placement) {
+		bool clusters = false;
+
+		qsort(pcpus, nr, sizeof(*pcpus), cmp_pack);
+
+		for (i = 1; i < nr; i++) {
+			if (pcpus[i].package == pcpus[i - 1].package &&
+			    pcpus[i].cluster != pcpus[i - 1].cluster)
+				clusters = true;
+		}
+
+		if (!clusters) {
+			for (i = 0; i < nr; i++)
+				pcpus[i].cluster = topology_read_group(pcpus[i].cpu);
+			qsort(pcpus, nr, sizeof(*pcpus), cmp_pack);
+		}
+
+		for (i = 1; i < nr; i++) {
+			if (pcpus[i].package == pcpus[i - 1].package &&
+			    pcpus[i].cluster == pcpus[i - 1].cluster)
+				pcpus[i].rank = pcpus[i - 1].rank + 1;
+		}
+
+		if (spread)
+			qsort(pcpus, nr, sizeof(*pcpus), cmp_spread);
+	}
+
+	for (i = 0; i < nr; i++)
+		order[i] = pcpus[i].cpu;
+
+	free(pcpus);
+	return order;
+
+out_free:
+	free(pcpus);
+	free(order);
+	return NULL;
+}
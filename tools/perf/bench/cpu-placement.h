@@ -0,0 +1,9 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef BENCH_CPU_PLACEMENT_H
+#define BENCH_CPU_PLACEMENT_H
+
+struct perf_cpu_map;
+
+int *bench__cpu_placement(struct perf_cpu_map *cpus, const char *placement);
+
+#endif /* BENCH_CPU_PLACEMENT_H */
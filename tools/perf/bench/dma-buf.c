@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * dma-buf.c
+ *
+ * dma-buf: Benchmark for the latency of allocating a buffer from a DMA-BUF
+ * heap, mapping it, bracketing a CPU write with DMA_BUF_IOCTL_SYNC and
+ * freeing it again. Each phase is timed separately.
+ */
+#include <subcmd/parse-options.h>
+#include "bench.h"
+
+#include <err.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+
+#define DMABUF_LOOPS_DEFAULT	1000
+#define DMABUF_SIZE_DEFAULT	1024
+
+static const char *heap_name = "system";
+static unsigned int loops = DMABUF_LOOPS_DEFAULT;
+static unsigned int size_kb = DMABUF_SIZE_DEFAULT;
+
+static const struct option options[] = {
+	OPT_STRING('H', "heap", &heap_name, "name", "Allocate from /dev/dma_heap/<name>"),
+	OPT_UINTEGER('s', "size", &size_kb, "Size of each buffer (in KiB)"),
+	OPT_UINTEGER('l', "loop", &loops, "Specify number of loops"),
+	OPT_END()
+};
+
+static const char * const bench_dmabuf_heap_usage[] = {
+	"perf bench dma-buf heap <options>",
+	NULL
+};
+
+enum {
+	DMABUF_ALLOC,
+	DMABUF_MMAP,
+	DMABUF_SYNC,
+	DMABUF_FREE,
+	DMABUF_NR_PHASES,
+};
+
+static const char * const phase_names[DMABUF_NR_PHASES] = {
+	[DMABUF_ALLOC]	= "alloc",
+	[DMABUF_MMAP]	= "mmap",
+	[DMABUF_SYNC]	= "sync+write",
+	[DMABUF_FREE]	= "munmap+close",
+};
+
+static unsigned long long phase_usec[DMABUF_NR_PHASES];
+
+static void account(int phase, struct timeval *start)
+{
+	struct timeval now, diff;
+
+	gettimeofday(&now, NULL);
+	timersub(&now, start, &diff);
+	phase_usec[phase] += diff.tv_sec * 1000000ULL + diff.tv_usec;
+	*start = now;
+}
+
+static void dma_buf_sync(int fd, unsigned long long flags)
+{
+	struct dma_buf_sync sync = { .flags = flags };
+
+	if (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync))
+		err(EXIT_FAILURE, "DMA_BUF_IOCTL_SYNC");
+}
+
+int bench_dmabuf_heap(int argc, const char **argv)
+{
+	size_t len = (size_t)size_kb << 10;
+	unsigned long long total = 0;
+	struct timeval start;
+	char path[256];
+	unsigned int i;
+	int heap_fd, p;
+	void *ptr;
+
+	argc = parse_options(argc, argv, options, bench_dmabuf_heap_usage, 0);
+	if (argc || !len)
+		usage_with_options(bench_dmabuf_heap_usage, options);
+
+	snprintf(path, sizeof(path), "/dev/dma_heap/%s", heap_name);
+	heap_fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (heap_fd < 0)
+		err(EXIT_FAILURE, "open %s", path);
+
+	for (i = 0; i < loops; i++) {
+		struct dma_heap_allocation_data data = {
+			.len = len,
+			.fd_flags = O_RDWR | O_CLOEXEC,
+		};
+
+		gettimeofday(&start, NULL);
+
+		if (ioctl(heap_fd, DMA_HEAP_IOCTL_ALLOC, &data))
+			err(EXIT_FAILURE, "DMA_HEAP_IOCTL_ALLOC");
+		account(DMABUF_ALLOC, &start);
+
+		ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED,
+			   data.fd, 0);
+		if (ptr == MAP_FAILED)
+			err(EXIT_FAILURE, "mmap");
+		account(DMABUF_MMAP, &start);
+
+		dma_buf_sync(data.fd, DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE);
+		memset(ptr, i, len);
+		dma_buf_sync(data.fd, DMA_BUF_SYNC_END | DMA_BUF_SYNC_WRITE);
+		account(DMABUF_SYNC, &start);
+
+		munmap(ptr, len);
+		close(data.fd);
+		account(DMABUF_FREE, &start);
+	}
+
+	close(heap_fd);
+
+	for (p = 0; p < DMABUF_NR_PHASES; p++)
+		total += phase_usec[p];
+
+	switch (bench_format) {
+	case BENCH_FORMAT_DEFAULT:
+		printf("# Executed %'u %u KiB buffer cycles on the %s heap\n",
+		       loops, size_kb, heap_name);
+		printf(" %14s: %llu.%03llu [sec]\n\n", "Total time",
+		       total / 1000000, (total / 1000) % 1000);
+		for (p = 0; p < DMABUF_NR_PHASES; p++)
+			printf(" %14s: %14lf usecs/op\n", phase_names[p],
+			       loops ? (double)phase_usec[p] / loops : 0);
+		break;
+
+	case BENCH_FORMAT_SIMPLE:
+		printf("%llu.%03llu\n", total / 1000000, (total / 1000) % 1000);
+		break;
+
+	default:
+		/* reaching here is something disaster */
+		fprintf(stderr, "Unknown format:%d\n", bench_format);
+		exit(1);
+		break;
+	}
+
+	return 0;
+}
@@ -17,7 +17,9 @@
 #include <errno.h>
 #include <perf/cpumap.h>
 #include "bench.h"
+#include "cpu-placement.h"
 #include "futex.h"
+#include "latency.h"
 
 #include <err.h>
 #include <stdlib.h>
@@ -29,6 +31,7 @@ struct worker {
 	u_int32_t *futex;
 	pthread_t thread;
 	unsigned long ops;
+	struct lat_hist *lat;
 };
 
 static u_int32_t global_futex = 0;
@@ -51,6 +54,10 @@ static const struct option options[] = {
 	OPT_BOOLEAN( 's', "silent",  &params.silent, "Silent mode: do not display data/details"),
 	OPT_BOOLEAN( 'S', "shared",  &params.fshared, "Use shared futexes instead of private ones"),
 	OPT_BOOLEAN( 'm', "mlockall", &params.mlockall, "Lock all current and future memory"),
+	OPT_BOOLEAN( 'L', "latency", &params.latency, "Report lock acquisition latency percentiles"),
+	OPT_STRING(  'C', "cpu",     &params.cpu_list, "cpu", "List of CPUs to run the threads on"),
+	OPT_STRING(  'P', "placement", &params.placement, "pack|spread",
+		     "Place consecutive threads within a CPU cluster (pack) or across clusters (spread)"),
 	OPT_END()
 };
 
@@ -67,6 +74,16 @@ static void print_summary(void)
 	printf("%sAveraged %ld operations/sec (+- %.2f%%), total secs = %d\n",
 	       !params.silent ? "\n" : "", avg, rel_stddev_stats(stddev, avg),
 	       (int)bench__runtime.tv_sec);
+
+	if (params.latency) {
+		struct lat_hist lat;
+		unsigned int i;
+
+		lat_hist__init(&lat);
+		for (i = 0; i < params.nthreads; i++)
+			lat_hist__merge(&lat, worker[i].lat);
+		lat_hist__print(&lat, "Lock acquisition");
+	}
 }
 
 static void toggle_done(int sig __maybe_unused,
@@ -92,6 +109,7 @@ static void *workerfn(void *arg)
 	mutex_unlock(&thread_lock);
 
 	do {
+		u64 start = w->lat ? lat_now_ns() : 0;
 		int ret;
 	again:
 		ret = futex_lock_pi(w->futex, NULL, futex_flag);
@@ -106,6 +124,9 @@ static void *workerfn(void *arg)
 			goto again;
 		}
 
+		if (w->lat)
+			lat_hist__add(w->lat, lat_now_ns() - start);
+
 		usleep(1);
 		ret = futex_unlock_pi(w->futex, futex_flag);
 		if (ret && !params.silent)
@@ -119,11 +140,11 @@ static void *workerfn(void *arg)
 }
 
 static void create_threads(struct worker *w, pthread_attr_t thread_attr,
-			   struct perf_cpu_map *cpu)
+			   struct perf_cpu_map *cpu, int *cpu_order)
 {
 	cpu_set_t *cpuset;
 	unsigned int i;
-	int nrcpus =  perf_cpu_map__nr(cpu);
+	int nrcpus = perf_cpu_map__max(cpu).cpu + 1;
 	size_t size;
 
 	threads_starting = params.nthreads;
@@ -142,8 +163,15 @@ static void create_threads(struct worker *w, pthread_attr_t thread_attr,
 		} else
 			worker[i].futex = &global_futex;
 
+		if (params.latency) {
+			worker[i].lat = malloc(sizeof(*worker[i].lat));
+			if (!worker[i].lat)
+				err(EXIT_FAILURE, "malloc");
+			lat_hist__init(worker[i].lat);
+		}
+
 		CPU_ZERO_S(size, cpuset);
-		CPU_SET_S(perf_cpu_map__cpu(cpu, i % perf_cpu_map__nr(cpu)).cpu, size, cpuset);
+		CPU_SET_S(cpu_order[i % perf_cpu_map__nr(cpu)], size, cpuset);
 
 		if (pthread_attr_setaffinity_np(&thread_attr, size, cpuset)) {
 			CPU_FREE(cpuset);
@@ -165,15 +193,20 @@ int bench_futex_lock_pi(int argc, const char **argv)
 	struct sigaction act;
 	pthread_attr_t thread_attr;
 	struct perf_cpu_map *cpu;
+	int *cpu_order;
 
 	argc = parse_options(argc, argv, options, bench_futex_lock_pi_usage, 0);
 	if (argc)
 		goto err;
 
-	cpu = perf_cpu_map__new(NULL);
+	cpu = perf_cpu_map__new(params.cpu_list);
 	if (!cpu)
 		err(EXIT_FAILURE, "calloc");
 
+	cpu_order = bench__cpu_placement(cpu, params.placement);
+	if (!cpu_order)
+		err(EXIT_FAILURE, "cpu placement");
+
 	memset(&act, 0, sizeof(act));
 	sigfillset(&act.sa_mask);
 	act.sa_sigaction = toggle_done;
@@ -206,7 +239,7 @@ int bench_futex_lock_pi(int argc, const char **argv)
 	pthread_attr_init(&thread_attr);
 	gettimeofday(&bench__start, NULL);
 
-	create_threads(worker, thread_attr, cpu);
+	create_threads(worker, thread_attr, cpu, cpu_order);
 	pthread_attr_destroy(&thread_attr);
 
 	mutex_lock(&thread_lock);
@@ -244,7 +277,10 @@ int bench_futex_lock_pi(int argc, const char **argv)
 
 	print_summary();
 
+	for (i = 0; i < params.nthreads; i++)
+		zfree(&worker[i].lat);
 	free(worker);
+	free(cpu_order);
 	perf_cpu_map__put(cpu);
 	return ret;
 err:
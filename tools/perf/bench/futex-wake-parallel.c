@@ -30,6 +30,8 @@ int bench_futex_wake_parallel(int argc __maybe_unused, const char **argv __maybe
 #include <linux/time64.h>
 #include <errno.h>
 #include "futex.h"
+#include "cpu-placement.h"
+#include "latency.h"
 #include <perf/cpumap.h>
 
 #include <err.h>
@@ -41,6 +43,7 @@ struct thread_data {
 	pthread_t worker;
 	unsigned int nwoken;
 	struct timeval runtime;
+	u64 wake_ns;
 };
 
 static unsigned int nwakes = 1;
@@ -54,6 +57,7 @@ static struct mutex thread_lock;
 static struct cond thread_parent, thread_worker;
 static pthread_barrier_t barrier;
 static struct stats waketime_stats, wakeup_stats;
+static struct lat_hist waketime_lat;
 static unsigned int threads_starting;
 static int futex_flag = 0;
 
@@ -65,6 +69,10 @@ static const struct option options[] = {
 	OPT_BOOLEAN( 's', "silent",  &params.silent, "Silent mode: do not display data/details"),
 	OPT_BOOLEAN( 'S', "shared",  &params.fshared, "Use shared futexes instead of private ones"),
 	OPT_BOOLEAN( 'm', "mlockall", &params.mlockall, "Lock all current and future memory"),
+	OPT_BOOLEAN( 'L', "latency", &params.latency, "Report futex_wake() latency percentiles"),
+	OPT_STRING(  'C', "cpu",     &params.cpu_list, "cpu", "List of CPUs to run the blocked threads on"),
+	OPT_STRING(  'P', "placement", &params.placement, "pack|spread",
+		     "Place consecutive blocked threads within a CPU cluster (pack) or across clusters (spread)"),
 
 	OPT_END()
 };
@@ -78,12 +86,15 @@ static void *waking_workerfn(void *arg)
 {
 	struct thread_data *waker = (struct thread_data *) arg;
 	struct timeval start, end;
+	u64 wake_start;
 
 	pthread_barrier_wait(&barrier);
 
 	gettimeofday(&start, NULL);
 
+	wake_start = lat_now_ns();
 	waker->nwoken = futex_wake(&futex, nwakes, futex_flag);
+	waker->wake_ns = lat_now_ns() - wake_start;
 	if (waker->nwoken != nwakes)
 		warnx("couldn't wakeup all tasks (%d/%d)",
 		      waker->nwoken, nwakes);
@@ -143,11 +154,11 @@ static void *blocked_workerfn(void *arg __maybe_unused)
 }
 
 static void block_threads(pthread_t *w, pthread_attr_t thread_attr,
-			  struct perf_cpu_map *cpu)
+			  struct perf_cpu_map *cpu, int *cpu_order)
 {
 	cpu_set_t *cpuset;
 	unsigned int i;
-	int nrcpus = perf_cpu_map__nr(cpu);
+	int nrcpus = perf_cpu_map__max(cpu).cpu + 1;
 	size_t size;
 
 	threads_starting = params.nthreads;
@@ -159,7 +170,7 @@ static void block_threads(pthread_t *w, pthread_attr_t thread_attr,
 	/* create and block all threads */
 	for (i = 0; i < params.nthreads; i++) {
 		CPU_ZERO_S(size, cpuset);
-		CPU_SET_S(perf_cpu_map__cpu(cpu, i % perf_cpu_map__nr(cpu)).cpu, size, cpuset);
+		CPU_SET_S(cpu_order[i % perf_cpu_map__nr(cpu)], size, cpuset);
 
 		if (pthread_attr_setaffinity_np(&thread_attr, size, cpuset)) {
 			CPU_FREE(cpuset);
@@ -212,6 +223,9 @@ static void print_summary(void)
 	       params.nthreads,
 	       waketime_avg / USEC_PER_MSEC,
 	       rel_stddev_stats(waketime_stddev, waketime_avg));
+
+	if (params.latency)
+		lat_hist__print(&waketime_lat, "Per-thread futex_wake()");
 }
 
 
@@ -222,8 +236,9 @@ static void do_run_stats(struct thread_data *waking_worker)
 	for (i = 0; i < params.nwakes; i++) {
 		update_stats(&waketime_stats, waking_worker[i].runtime.tv_usec);
 		update_stats(&wakeup_stats, waking_worker[i].nwoken);
+		if (params.latency)
+			lat_hist__add(&waketime_lat, waking_worker[i].wake_ns);
 	}
-
 }
 
 static void toggle_done(int sig __maybe_unused,
@@ -241,6 +256,7 @@ int bench_futex_wake_parallel(int argc, const char **argv)
 	pthread_attr_t thread_attr;
 	struct thread_data *waking_worker;
 	struct perf_cpu_map *cpu;
+	int *cpu_order;
 
 	argc = parse_options(argc, argv, options,
 			     bench_futex_wake_parallel_usage, 0);
@@ -259,10 +275,14 @@ int bench_futex_wake_parallel(int argc, const char **argv)
 			err(EXIT_FAILURE, "mlockall");
 	}
 
-	cpu = perf_cpu_map__new(NULL);
+	cpu = perf_cpu_map__new(params.cpu_list);
 	if (!cpu)
 		err(EXIT_FAILURE, "calloc");
 
+	cpu_order = bench__cpu_placement(cpu, params.placement);
+	if (!cpu_order)
+		err(EXIT_FAILURE, "cpu placement");
+
 	if (!params.nthreads)
 		params.nthreads = perf_cpu_map__nr(cpu);
 
@@ -293,6 +313,7 @@ int bench_futex_wake_parallel(int argc, const char **argv)
 
 	init_stats(&wakeup_stats);
 	init_stats(&waketime_stats);
+	lat_hist__init(&waketime_lat);
 
 	pthread_attr_init(&thread_attr);
 	mutex_init(&thread_lock);
@@ -305,7 +326,7 @@ int bench_futex_wake_parallel(int argc, const char **argv)
 			err(EXIT_FAILURE, "calloc");
 
 		/* create, launch & block all threads */
-		block_threads(blocked_worker, thread_attr, cpu);
+		block_threads(blocked_worker, thread_attr, cpu, cpu_order);
 
 		/* make sure all threads are already blocked */
 		mutex_lock(&thread_lock);
@@ -341,6 +362,7 @@ int bench_futex_wake_parallel(int argc, const char **argv)
 	print_summary();
 
 	free(blocked_worker);
+	free(cpu_order);
 	perf_cpu_map__put(cpu);
 	return ret;
 }
@@ -20,6 +20,9 @@ struct bench_futex_parameters {
 	bool multi; /* lock-pi */
 	bool pi; /* requeue-pi */
 	bool broadcast; /* requeue */
+	bool latency; /* lock-pi, wake-parallel */
+	const char *cpu_list; /* lock-pi, wake-parallel */
+	const char *placement; /* lock-pi, wake-parallel */
 	unsigned int runtime; /* seconds*/
 	unsigned int nthreads;
 	unsigned int nfutexes;
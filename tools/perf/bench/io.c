@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * io.c
+ *
+ * io: Benchmark for random block reads from a file, done either with
+ * pread(2) one block at a time or with io_uring at a given queue depth,
+ * optionally with registered (fixed) buffers and completion polling.
+ *
+ * Unless --file is given, a temporary file of --size MiB is created in the
+ * current directory. Use --direct to bypass the page cache; --iopoll needs it.
+ */
+#include <subcmd/parse-options.h>
+#include "bench.h"
+
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#define IO_OPS_DEFAULT		100000
+#define IO_FILE_SIZE_DEFAULT	64
+#define IO_BLOCK_SIZE_DEFAULT	4096
+#define IO_QUEUE_DEPTH_DEFAULT	32
+#define IO_BUF_ALIGN		4096
+
+static const char *filename;
+static unsigned int nr_ops = IO_OPS_DEFAULT;
+static unsigned int file_size_mb = IO_FILE_SIZE_DEFAULT;
+static unsigned int block_size = IO_BLOCK_SIZE_DEFAULT;
+static unsigned int queue_depth = IO_QUEUE_DEPTH_DEFAULT;
+static bool direct, fixed_buffers, iopoll, sqpoll;
+
+static const struct option pread_options[] = {
+	OPT_STRING('f', "file", &filename, "path", "Read from this file instead of a temporary one"),
+	OPT_UINTEGER('s', "size", &file_size_mb, "Size of the temporary file (in MiB)"),
+	OPT_UINTEGER('b', "block-size", &block_size, "Size of each read (in bytes)"),
+	OPT_UINTEGER('n', "nr-ops", &nr_ops, "Specify number of reads"),
+	OPT_BOOLEAN('d', "direct", &direct, "Open the file with O_DIRECT"),
+	OPT_END()
+};
+
+static const struct option uring_options[] = {
+	OPT_STRING('f', "file", &filename, "path", "Read from this file instead of a temporary one"),
+	OPT_UINTEGER('s', "size", &file_size_mb, "Size of the temporary file (in MiB)"),
+	OPT_UINTEGER('b', "block-size", &block_size, "Size of each read (in bytes)"),
+	OPT_UINTEGER('n', "nr-ops", &nr_ops, "Specify number of reads"),
+	OPT_BOOLEAN('d', "direct", &direct, "Open the file with O_DIRECT"),
+	OPT_UINTEGER('q', "queue-depth", &queue_depth, "Number of reads in flight"),
+	OPT_BOOLEAN('F', "fixed-buffers", &fixed_buffers, "Register the buffers and use IORING_OP_READ_FIXED"),
+	OPT_BOOLEAN('p', "iopoll", &iopoll, "Poll for completions (IORING_SETUP_IOPOLL, needs --direct)"),
+	OPT_BOOLEAN('S', "sqpoll", &sqpoll, "Let a kernel thread poll the submission queue (IORING_SETUP_SQPOLL)"),
+	OPT_END()
+};
+
+static const char * const bench_io_pread_usage[] = {
+	"perf bench io pread <options>",
+	NULL
+};
+
+static const char * const bench_io_uring_usage[] = {
+	"perf bench io uring <options>",
+	NULL
+};
+
+struct io_uring_rings {
+	int fd;
+	unsigned int *sq_head, *sq_tail, *sq_mask, *sq_flags, *sq_array;
+	unsigned int *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+};
+
+static char tmp_filename[] = "perf-bench-io.XXXXXX";
+static unsigned long long nr_blocks;
+static unsigned int seed;
+
+static int open_file(void)
+{
+	int flags = O_RDONLY | (direct ? O_DIRECT : 0);
+	size_t len = (size_t)file_size_mb << 20;
+	struct stat st;
+	char *buf;
+	int fd;
+
+	if (filename) {
+		fd = open(filename, flags);
+		if (fd < 0)
+			err(EXIT_FAILURE, "open %s", filename);
+		if (fstat(fd, &st))
+			err(EXIT_FAILURE, "fstat");
+		nr_blocks = st.st_size / block_size;
+	} else {
+		fd = mkstemp(tmp_filename);
+		if (fd < 0)
+			err(EXIT_FAILURE, "mkstemp");
+
+		buf = malloc(1 << 20);
+		if (!buf)
+			err(EXIT_FAILURE, "malloc");
+		memset(buf, 0x5a, 1 << 20);
+		for (size_t done = 0; done < len; done += 1 << 20) {
+			if (write(fd, buf, 1 << 20) != 1 << 20)
+				err(EXIT_FAILURE, "write");
+		}
+		free(buf);
+		if (fsync(fd))
+			err(EXIT_FAILURE, "fsync");
+		close(fd);
+
+		fd = open(tmp_filename, flags);
+		unlink(tmp_filename);
+		if (fd < 0)
+			err(EXIT_FAILURE, "open %s", tmp_filename);
+		nr_blocks = len / block_size;
+	}
+
+	if (!nr_blocks)
+		errx(EXIT_FAILURE, "file smaller than one block");
+
+	return fd;
+}
+
+static off_t random_offset(void)
+{
+	return (off_t)(rand_r(&seed) % nr_blocks) * block_size;
+}
+
+static void *alloc_buffer(void)
+{
+	void *buf;
+
+	if (posix_memalign(&buf, IO_BUF_ALIGN, block_size))
+		err(EXIT_FAILURE, "posix_memalign");
+
+	return buf;
+}
+
+static void print_result(const char *what, struct timeval *diff)
+{
+	unsigned long long result_usec = diff->tv_sec * 1000000ULL + diff->tv_usec;
+	double secs = (double)result_usec / 1000000;
+
+	switch (bench_format) {
+	case BENCH_FORMAT_DEFAULT:
+		printf("# Executed %'u %u byte %s\n", nr_ops, block_size, what);
+
+		printf(" %14s: %lu.%03lu [sec]\n\n", "Total time",
+		       (unsigned long) diff->tv_sec,
+		       (unsigned long) (diff->tv_usec / 1000));
+
+		printf(" %14lf usecs/op\n", (double)result_usec / nr_ops);
+		printf(" %'14llu ops/sec\n",
+		       secs ? (unsigned long long)(nr_ops / secs) : 0);
+		printf(" %14.2lf MiB/sec\n",
+		       secs ? (double)nr_ops * block_size / secs / (1 << 20) : 0);
+		break;
+
+	case BENCH_FORMAT_SIMPLE:
+		printf("%lu.%03lu\n",
+		       (unsigned long) diff->tv_sec,
+		       (unsigned long) (diff->tv_usec / 1000));
+		break;
+
+	default:
+		/* reaching here is something disaster */
+		fprintf(stderr, "Unknown format:%d\n", bench_format);
+		exit(1);
+		break;
+	}
+}
+
+int bench_io_pread(int argc, const char **argv)
+{
+	struct timeval start, stop, diff;
+	unsigned int i;
+	void *buf;
+	int fd;
+
+	argc = parse_options(argc, argv, pread_options, bench_io_pread_usage, 0);
+	if (argc)
+		usage_with_options(bench_io_pread_usage, pread_options);
+
+	fd = open_file();
+	buf = alloc_buffer();
+
+	gettimeofday(&start, NULL);
+
+	for (i = 0; i < nr_ops; i++) {
+		if (pread(fd, buf, block_size, random_offset()) != block_size)
+			err(EXIT_FAILURE, "pread");
+	}
+
+	gettimeofday(&stop, NULL);
+	timersub(&stop, &start, &diff);
+
+	print_result("pread() calls", &diff);
+
+	free(buf);
+	close(fd);
+
+	return 0;
+}
+
+static void *map_ring(int fd, size_t len, off_t offset)
+{
+	void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			 MAP_SHARED | MAP_POPULATE, fd, offset);
+
+	if (ptr == MAP_FAILED)
+		err(EXIT_FAILURE, "mmap io_uring");
+
+	return ptr;
+}
+
+static void setup_rings(struct io_uring_rings *ring)
+{
+	struct io_uring_params p;
+	void *sq, *cq;
+
+	memset(&p, 0, sizeof(p));
+	if (iopoll)
+		p.flags |= IORING_SETUP_IOPOLL;
+	if (sqpoll)
+		p.flags |= IORING_SETUP_SQPOLL;
+
+	ring->fd = syscall(__NR_io_uring_setup, queue_depth, &p);
+	if (ring->fd < 0)
+		err(EXIT_FAILURE, "io_uring_setup");
+
+	sq = map_ring(ring->fd, p.sq_off.array + p.sq_entries * sizeof(unsigned int),
+		      IORING_OFF_SQ_RING);
+	ring->sq_head = sq + p.sq_off.head;
+	ring->sq_tail = sq + p.sq_off.tail;
+	ring->sq_mask = sq + p.sq_off.ring_mask;
+	ring->sq_flags = sq + p.sq_off.flags;
+	ring->sq_array = sq + p.sq_off.array;
+
+	ring->sqes = map_ring(ring->fd, p.sq_entries * sizeof(struct io_uring_sqe),
+			      IORING_OFF_SQES);
+
+	cq = map_ring(ring->fd, p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe),
+		      IORING_OFF_CQ_RING);
+	ring->cq_head = cq + p.cq_off.head;
+	ring->cq_tail = cq + p.cq_off.tail;
+	ring->cq_mask = cq + p.cq_off.ring_mask;
+	ring->cqes = cq + p.cq_off.cqes;
+}
+
+static void queue_read(struct io_uring_rings *ring, int fd, void **bufs,
+		       unsigned int idx)
+{
+	unsigned int tail = *ring->sq_tail;
+	unsigned int slot = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[slot];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = fd;
+	sqe->addr = (unsigned long)bufs[idx];
+	sqe->len = block_size;
+	sqe->off = random_offset();
+	sqe->buf_index = fixed_buffers ? idx : 0;
+	sqe->user_data = idx;
+	ring->sq_array[slot] = slot;
+
+	/* Publish the SQE before the new tail */
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+int bench_io_uring(int argc, const char **argv)
+{
+	unsigned int submitted = 0, completed = 0, to_submit = 0, nr_free, i;
+	struct timeval start, stop, diff;
+	struct io_uring_rings ring;
+	unsigned int *free_bufs;
+	struct iovec *iovs;
+	void **bufs;
+	int fd;
+
+	argc = parse_options(argc, argv, uring_options, bench_io_uring_usage, 0);
+	if (argc || !queue_depth)
+		usage_with_options(bench_io_uring_usage, uring_options);
+
+	if (iopoll && !direct)
+		errx(EXIT_FAILURE, "--iopoll needs --direct");
+
+	fd = open_file();
+	setup_rings(&ring);
+
+	bufs = calloc(queue_depth, sizeof(*bufs));
+	iovs = calloc(queue_depth, sizeof(*iovs));
+	free_bufs = calloc(queue_depth, sizeof(*free_bufs));
+	if (!bufs || !iovs || !free_bufs)
+		err(EXIT_FAILURE, "calloc");
+
+	for (i = 0; i < queue_depth; i++) {
+		bufs[i] = alloc_buffer();
+		iovs[i].iov_base = bufs[i];
+		iovs[i].iov_len = block_size;
+		free_bufs[i] = i;
+	}
+	nr_free = queue_depth;
+
+	if (fixed_buffers &&
+	    syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS,
+		    iovs, queue_depth))
+		err(EXIT_FAILURE, "IORING_REGISTER_BUFFERS");
+
+	gettimeofday(&start, NULL);
+
+	while (completed < nr_ops) {
+		unsigned int flags = IORING_ENTER_GETEVENTS;
+		unsigned int head, tail;
+		int ret;
+
+		while (nr_free && submitted < nr_ops) {
+			queue_read(&ring, fd, bufs, free_bufs[--nr_free]);
+			submitted++;
+			to_submit++;
+		}
+
+		if (sqpoll &&
+		    (__atomic_load_n(ring.sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_NEED_WAKEUP))
+			flags |= IORING_ENTER_SQ_WAKEUP;
+
+		ret = syscall(__NR_io_uring_enter, ring.fd, sqpoll ? 0 : to_submit,
+			      1, flags, NULL, 0);
+		if (ret < 0 && errno != EINTR)
+			err(EXIT_FAILURE, "io_uring_enter");
+		if (!sqpoll && ret > 0)
+			to_submit -= ret;
+
+		head = *ring.cq_head;
+		tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+
+			if (cqe->res != (int)block_size)
+				errx(EXIT_FAILURE, "read failed: %s",
+				     cqe->res < 0 ? strerror(-cqe->res) : "short read");
+
+			free_bufs[nr_free++] = cqe->user_data;
+			completed++;
+		}
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	gettimeofday(&stop, NULL);
+	timersub(&stop, &start, &diff);
+
+	print_result("io_uring reads", &diff);
+
+	for (i = 0; i < queue_depth; i++)
+		free(bufs[i]);
+	free(free_bufs);
+	free(iovs);
+	free(bufs);
+	close(ring.fd);
+	close(fd);
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Latency histograms shared by the benchmarks that report percentiles.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "latency.h"
+
+void lat_hist__init(struct lat_hist *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+}
+
+void lat_hist__merge(struct lat_hist *dst, const struct lat_hist *src)
+{
+	unsigned int i;
+
+	for (i = 0; i < LAT_HIST_NR_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+	dst->count += src->count;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/* Largest value that falls into bucket @idx */
+static u64 lat_hist__bucket_max(unsigned int idx)
+{
+	unsigned int shift;
+
+	if (idx < LAT_HIST_SUB)
+		return idx;
+
+	shift = idx / LAT_HIST_SUB - 1;
+	return ((u64)(LAT_HIST_SUB + idx % LAT_HIST_SUB + 1) << shift) - 1;
+}
+
+/*
+ * Returns the latency at or below which @pct percent of the samples fall,
+ * rounded up to the end of its bucket but never above the largest sample.
+ */
+u64 lat_hist__percentile(const struct lat_hist *hist, double pct)
+{
+	u64 target, seen = 0;
+	unsigned int i;
+
+	if (!hist->count)
+		return 0;
+
+	target = hist->count * pct / 100;
+	if (target < hist->count * pct / 100 || !target)
+		target++;
+
+	for (i = 0; i < LAT_HIST_NR_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen >= target)
+			break;
+	}
+
+	if (i == LAT_HIST_NR_BUCKETS || lat_hist__bucket_max(i) > hist->max)
+		return hist->max;
+
+	return lat_hist__bucket_max(i);
+}
+
+void lat_hist__print(const struct lat_hist *hist, const char *name)
+{
+	printf("%s latency [nsec]: p50 %llu, p99 %llu, p99.9 %llu, max %llu (%llu samples)\n",
+	       name,
+	       (unsigned long long)lat_hist__percentile(hist, 50),
+	       (unsigned long long)lat_hist__percentile(hist, 99),
+	       (unsigned long long)lat_hist__percentile(hist, 99.9),
+	       (unsigned long long)hist->max,
+	       (unsigned long long)hist->count);
+}
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef BENCH_LATENCY_H
+#define BENCH_LATENCY_H
+
+#include <time.h>
+#include <linux/bitops.h>
+#include <linux/time64.h>
+#include <linux/types.h>
+
+/*
+ * Log-linear histogram of per-operation latencies in nanoseconds. Values
+ * below LAT_HIST_SUB get a bucket each, every power of two above that is
+ * split into LAT_HIST_SUB buckets, so reported percentiles are within 1/16
+ * of the real value whatever their magnitude.
+ */
+#define LAT_HIST_SUB_BITS	4
+#define LAT_HIST_SUB		(1U << LAT_HIST_SUB_BITS)
+#define LAT_HIST_NR_BUCKETS	((64 - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB)
+
+struct lat_hist {
+	u64 count;
+	u64 max;
+	u64 buckets[LAT_HIST_NR_BUCKETS];
+};
+
+static inline u64 lat_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static inline unsigned int lat_hist__bucket(u64 ns)
+{
+	unsigned int shift;
+
+	if (ns < LAT_HIST_SUB)
+		return ns;
+
+	shift = fls64(ns) - 1 - LAT_HIST_SUB_BITS;
+	return (shift + 1) * LAT_HIST_SUB + (ns >> shift) - LAT_HIST_SUB;
+}
+
+/* Not atomic: every thread records into its own histogram */
+static inline void lat_hist__add(struct lat_hist *hist, u64 ns)
+{
+	hist->buckets[lat_hist__bucket(ns)]++;
+	hist->count++;
+	if (ns > hist->max)
+		hist->max = ns;
+}
+
+void lat_hist__init(struct lat_hist *hist);
+void lat_hist__merge(struct lat_hist *dst, const struct lat_hist *src);
+u64 lat_hist__percentile(const struct lat_hist *hist, double pct);
+void lat_hist__print(const struct lat_hist *hist, const char *name);
+
+#endif /* BENCH_LATENCY_H */
@@ -24,10 +24,12 @@
 #include <sys/socket.h>
 #include <sys/wait.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <poll.h>
 #include <limits.h>
 #include <err.h>
 #include <linux/time64.h>
+#include "latency.h"
 
 #define DATASIZE 100
 
@@ -35,6 +37,7 @@ static bool use_pipes = false;
 static unsigned int nr_loops = 100;
 static bool thread_mode = false;
 static unsigned int num_groups = 10;
+static bool latency = false;
 
 struct sender_context {
 	unsigned int num_fds;
@@ -48,6 +51,7 @@ struct receiver_context {
 	int in_fds[2];
 	int ready_out;
 	int wakefd;
+	struct lat_hist *lat;
 };
 
 static void fdpair(int fds[2])
@@ -91,6 +95,12 @@ static void *sender(struct sender_context *ctx)
 		for (j = 0; j < ctx->num_fds; j++) {
 			int ret, done = 0;
 
+			/* Stamp each message with the time it is sent */
+			if (latency) {
+				u64 now = lat_now_ns();
+
+				memcpy(data, &now, sizeof(now));
+			}
 again:
 			ret = write(ctx->out_fds[j], data + done,
 				    sizeof(data)-done);
@@ -129,6 +139,13 @@ static void *receiver(struct receiver_context* ctx)
 		done += ret;
 		if (done < DATASIZE)
 			goto again;
+
+		if (ctx->lat) {
+			u64 sent;
+
+			memcpy(&sent, data, sizeof(sent));
+			lat_hist__add(ctx->lat, lat_now_ns() - sent);
+		}
 	}
 
 	return NULL;
@@ -192,7 +209,8 @@ static void reap_worker(pthread_t id)
 static unsigned int group(pthread_t *pth,
 		unsigned int num_fds,
 		int ready_out,
-		int wakefd)
+		int wakefd,
+		struct lat_hist *lat)
 {
 	unsigned int i;
 	struct sender_context *snd_ctx = malloc(sizeof(struct sender_context)
@@ -217,6 +235,7 @@ static unsigned int group(pthread_t *pth,
 		ctx->in_fds[1] = fds[1];
 		ctx->ready_out = ready_out;
 		ctx->wakefd = wakefd;
+		ctx->lat = lat ? &lat[i] : NULL;
 
 		pth[i] = create_worker(ctx, (void *)receiver);
 
@@ -250,6 +269,8 @@ static const struct option options[] = {
 		    "Be multi thread instead of multi process"),
 	OPT_UINTEGER('g', "group", &num_groups, "Specify number of groups"),
 	OPT_UINTEGER('l', "nr_loops", &nr_loops, "Specify the number of loops to run (default: 100)"),
+	OPT_BOOLEAN('L', "latency", &latency,
+		    "Report the latency of each message from write to read as percentiles"),
 	OPT_END()
 };
 
@@ -266,6 +287,8 @@ int bench_sched_messaging(int argc, const char **argv)
 	int readyfds[2], wakefds[2];
 	char dummy;
 	pthread_t *pth_tab;
+	struct lat_hist *lat = NULL, total_lat;
+	size_t lat_size = 0;
 
 	argc = parse_options(argc, argv, options,
 			     bench_sched_message_usage, 0);
@@ -274,13 +297,23 @@ int bench_sched_messaging(int argc, const char **argv)
 	if (!pth_tab)
 		err(EXIT_FAILURE, "main:malloc()");
 
+	/* Receivers may be separate processes, share their histograms */
+	if (latency) {
+		lat_size = num_groups * num_fds * sizeof(*lat);
+		lat = mmap(NULL, lat_size, PROT_READ | PROT_WRITE,
+			   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (lat == MAP_FAILED)
+			err(EXIT_FAILURE, "main:mmap()");
+	}
+
 	fdpair(readyfds);
 	fdpair(wakefds);
 
 	total_children = 0;
 	for (i = 0; i < num_groups; i++)
 		total_children += group(pth_tab+total_children, num_fds,
-					readyfds[1], wakefds[0]);
+					readyfds[1], wakefds[0],
+					lat ? lat + i * num_fds : NULL);
 
 	/* Wait for everyone to be ready */
 	for (i = 0; i < total_children; i++)
@@ -311,6 +344,12 @@ int bench_sched_messaging(int argc, const char **argv)
 		printf(" %14s: %lu.%03lu [sec]\n", "Total time",
 		       (unsigned long) diff.tv_sec,
 		       (unsigned long) (diff.tv_usec / USEC_PER_MSEC));
+		if (lat) {
+			lat_hist__init(&total_lat);
+			for (i = 0; i < num_groups * num_fds; i++)
+				lat_hist__merge(&total_lat, &lat[i]);
+			lat_hist__print(&total_lat, " Message");
+		}
 		break;
 	case BENCH_FORMAT_SIMPLE:
 		printf("%lu.%03lu\n", (unsigned long) diff.tv_sec,
@@ -324,6 +363,8 @@ int bench_sched_messaging(int argc, const char **argv)
 	}
 
 	free(pth_tab);
+	if (lat)
+		munmap(lat, lat_size);
 
 	return 0;
 }
@@ -21,6 +21,25 @@ static char *directions[] = {
 	"FROM_DEVICE",
 };
 
+static void run_benchmark(int fd, struct map_benchmark *map)
+{
+	if (ioctl(fd, DMA_MAP_BENCHMARK, map)) {
+		perror("ioctl");
+		exit(1);
+	}
+
+	printf("dma mapping benchmark: threads:%d seconds:%d node:%d dir:%s granule: %d sg_nents: %d\n",
+			map->threads, map->seconds, map->node,
+			directions[map->dma_dir], map->granule, map->sg_nents);
+	printf("average map latency(us):%.1f standard deviation:%.1f\n",
+			map->avg_map_100ns/10.0, map->map_stddev/10.0);
+	printf("average unmap latency(us):%.1f standard deviation:%.1f\n",
+			map->avg_unmap_100ns/10.0, map->unmap_stddev/10.0);
+	if (map->flags & DMA_MAP_F_SPLIT_SYNC)
+		printf("average sync latency(us):%.1f standard deviation:%.1f\n",
+				map->avg_sync_100ns/10.0, map->sync_stddev/10.0);
+}
+
 int main(int argc, char **argv)
 {
 	struct map_benchmark map;
@@ -31,11 +50,13 @@ int main(int argc, char **argv)
 	int bits = 32, xdelay = 0, dir = DMA_MAP_BIDIRECTIONAL;
 	/* default granule 1 PAGESIZE */
 	int granule = 1;
+	/* default single mapping, no scatterlist */
+	int nents = 0;
+	/* default no sweep over granules and directions */
+	int max_granule = 0, all_dirs = 0;
+	unsigned int flags = 0;
 
-	int cmd = DMA_MAP_BENCHMARK;
-	char *p;
-
-	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:")) != -1) {
+	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:e:G:aSN")) != -1) {
 		switch (opt) {
 		case 't':
 			threads = atoi(optarg);
@@ -58,6 +79,21 @@ int main(int argc, char **argv)
 		case 'g':
 			granule = atoi(optarg);
 			break;
+		case 'e':
+			nents = atoi(optarg);
+			break;
+		case 'G':
+			max_granule = atoi(optarg);
+			break;
+		case 'a':
+			all_dirs = 1;
+			break;
+		case 'S':
+			flags |= DMA_MAP_F_SPLIT_SYNC;
+			break;
+		case 'N':
+			flags |= DMA_MAP_F_NODE_SPREAD;
+			break;
 		default:
 			return -1;
 		}
@@ -93,11 +129,26 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
-	if (granule < 1 || granule > 1024) {
+	if (granule < 1 || granule > DMA_MAP_MAX_GRANULE) {
 		fprintf(stderr, "invalid granule size\n");
 		exit(1);
 	}
 
+	/* -G sweeps the granule in powers of two from -g up to its value */
+	if (!max_granule)
+		max_granule = granule;
+	if (max_granule < granule || max_granule > DMA_MAP_MAX_GRANULE) {
+		fprintf(stderr, "invalid maximum granule size, must be in %d-%d\n",
+			granule, DMA_MAP_MAX_GRANULE);
+		exit(1);
+	}
+
+	if (nents < 0 || nents > DMA_MAP_MAX_GRANULE / max_granule) {
+		fprintf(stderr, "invalid number of sg entries, must be in 0-%d\n",
+			DMA_MAP_MAX_GRANULE / max_granule);
+		exit(1);
+	}
+
 	fd = open("/sys/kernel/debug/dma_map_benchmark", O_RDWR);
 	if (fd == -1) {
 		perror("open");
@@ -111,19 +162,16 @@ int main(int argc, char **argv)
 	map.dma_bits = bits;
 	map.dma_dir = dir;
 	map.dma_trans_ns = xdelay;
-	map.granule = granule;
-
-	if (ioctl(fd, cmd, &map)) {
-		perror("ioctl");
-		exit(1);
+	map.sg_nents = nents;
+	map.flags = flags;
+
+	for (map.dma_dir = all_dirs ? DMA_MAP_BIDIRECTIONAL : dir;
+	     map.dma_dir <= (all_dirs ? DMA_MAP_FROM_DEVICE : dir);
+	     map.dma_dir++) {
+		for (map.granule = granule; map.granule <= max_granule;
+		     map.granule *= 2)
+			run_benchmark(fd, &map);
 	}
 
-	printf("dma mapping benchmark: threads:%d seconds:%d node:%d dir:%s granule: %d\n",
-			threads, seconds, node, dir[directions], granule);
-	printf("average map latency(us):%.1f standard deviation:%.1f\n",
-			map.avg_map_100ns/10.0, map.map_stddev/10.0);
-	printf("average unmap latency(us):%.1f standard deviation:%.1f\n",
-			map.avg_unmap_100ns/10.0, map.unmap_stddev/10.0);
-
 	return 0;
 }
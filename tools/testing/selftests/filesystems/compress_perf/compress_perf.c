@@ -0,0 +1,370 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Workloads for the compressed block device and filesystem performance
+ * regression suite, see run_compress_perf.sh.
+ *
+ *   gen DIR MB		  populate DIR with a reproducible tree of files
+ *   write FILE MB	  write MB of generated data to FILE with O_DIRECT
+ *   read [-d] [-b SIZE] PATH
+ *			  read every file under PATH sequentially in SIZE
+ *			  chunks (1 MiB by default), with O_DIRECT if -d
+ *   randread [-n OPS] PATH
+ *			  fault in OPS random pages of the files under PATH
+ *			  through mmap, the way an application launch does
+ *
+ * The generated data mixes text-like blocks with random ones, so that it
+ * compresses about 2:1 with the common algorithms. Every workload prints
+ * its results as "<metric> <value>" lines on stdout.
+ */
+#define _GNU_SOURCE
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BLOCK_SIZE	4096
+#define CHUNK_SIZE	(1 << 20)
+#define MAX_FILES	65536
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dULL;
+
+/* xorshift64, fixed seed so that every run sees the same data */
+static uint64_t rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* One block in four is random, the others are words from a small vocabulary */
+static void fill_block(char *buf)
+{
+	static const char * const words[] = {
+		"static ", "int ", "return ", "struct ", "unsigned ", "long ",
+		"if (", "else ", "for (", "while (", "NULL", "err", "ret = ",
+		"->", "0x", "size", "offset", "page", "inode", "data", ");\n",
+		"{\n", "}\n", "\t", "0", "1", "linux", "kernel", "buffer ",
+	};
+	const int nr_words = sizeof(words) / sizeof(words[0]);
+	size_t len, pos = 0;
+	int i;
+
+	if (!(rng() & 3)) {
+		for (i = 0; i < BLOCK_SIZE; i += sizeof(uint64_t)) {
+			uint64_t v = rng();
+
+			memcpy(buf + i, &v, sizeof(v));
+		}
+		return;
+	}
+
+	while (pos < BLOCK_SIZE) {
+		const char *w = words[rng() % nr_words];
+
+		len = strlen(w);
+		if (len > BLOCK_SIZE - pos)
+			len = BLOCK_SIZE - pos;
+		memcpy(buf + pos, w, len);
+		pos += len;
+	}
+}
+
+static void write_data(int fd, size_t size)
+{
+	char *buf;
+	size_t done, i;
+	ssize_t ret;
+
+	if (posix_memalign((void **)&buf, BLOCK_SIZE, CHUNK_SIZE))
+		err(1, "posix_memalign");
+
+	for (done = 0; done < size; done += ret) {
+		size_t len = size - done < CHUNK_SIZE ? size - done : CHUNK_SIZE;
+
+		for (i = 0; i < len; i += BLOCK_SIZE)
+			fill_block(buf + i);
+
+		ret = write(fd, buf, len);
+		if (ret <= 0)
+			err(1, "write");
+	}
+
+	free(buf);
+}
+
+/*
+ * Files between 4 KiB and 1 MiB with a log-uniform size distribution,
+ * spread over a few directories, like the libraries and resources of an
+ * installed application.
+ */
+static int do_gen(int argc, char **argv)
+{
+	char path[PATH_MAX];
+	size_t total, done = 0;
+	int fd, nr = 0;
+
+	if (argc != 3)
+		errx(1, "usage: gen DIR MB");
+
+	total = strtoul(argv[2], NULL, 0) << 20;
+
+	while (done < total) {
+		size_t size = (size_t)BLOCK_SIZE << (rng() % 8);
+
+		size += (rng() % size) & ~(size_t)(BLOCK_SIZE - 1);
+		if (size > total - done)
+			size = total - done;
+
+		snprintf(path, sizeof(path), "%s/%02d", argv[1], nr % 16);
+		if (mkdir(path, 0755) && errno != EEXIST)
+			err(1, "mkdir %s", path);
+
+		snprintf(path, sizeof(path), "%s/%02d/%05d", argv[1], nr % 16, nr);
+		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			err(1, "open %s", path);
+		write_data(fd, size);
+		close(fd);
+
+		done += size;
+		nr++;
+	}
+
+	printf("files %d\n", nr);
+	return 0;
+}
+
+static int do_write(int argc, char **argv)
+{
+	size_t size;
+	double start;
+	int fd;
+
+	if (argc != 3)
+		errx(1, "usage: write FILE MB");
+
+	size = strtoul(argv[2], NULL, 0) << 20;
+
+	fd = open(argv[1], O_WRONLY | O_DIRECT);
+	if (fd < 0)
+		err(1, "open %s", argv[1]);
+
+	start = now();
+	write_data(fd, size);
+	if (fsync(fd))
+		err(1, "fsync");
+	printf("write_mbps %.1f\n", (size >> 20) / (now() - start));
+
+	close(fd);
+	return 0;
+}
+
+static char *files[MAX_FILES];
+static int nr_files;
+
+static int add_file(const char *path, const struct stat *st, int type,
+		    struct FTW *ftw)
+{
+	if (type != FTW_F)
+		return 0;
+	if (nr_files == MAX_FILES)
+		errx(1, "more than %d files", MAX_FILES);
+
+	files[nr_files] = strdup(path);
+	if (!files[nr_files++])
+		err(1, "strdup");
+
+	return 0;
+}
+
+static int cmp_path(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* Collect the files under @path in a stable order; a non-directory is used as is */
+static void collect_files(const char *path)
+{
+	struct stat st;
+
+	if (stat(path, &st))
+		err(1, "stat %s", path);
+
+	if (!S_ISDIR(st.st_mode)) {
+		files[nr_files++] = strdup(path);
+		return;
+	}
+
+	if (nftw(path, add_file, 32, FTW_PHYS))
+		err(1, "nftw %s", path);
+	qsort(files, nr_files, sizeof(files[0]), cmp_path);
+}
+
+static int do_read(int argc, char **argv)
+{
+	size_t bs = CHUNK_SIZE, total = 0;
+	int opt, flags = O_RDONLY;
+	double start;
+	ssize_t ret;
+	char *buf;
+	int i, fd;
+
+	while ((opt = getopt(argc, argv, "b:d")) != -1) {
+		switch (opt) {
+		case 'b':
+			bs = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			flags |= O_DIRECT;
+			break;
+		default:
+			errx(1, "usage: read [-d] [-b SIZE] PATH");
+		}
+	}
+	if (optind != argc - 1 || !bs)
+		errx(1, "usage: read [-d] [-b SIZE] PATH");
+
+	collect_files(argv[optind]);
+
+	if (posix_memalign((void **)&buf, BLOCK_SIZE, bs))
+		err(1, "posix_memalign");
+
+	start = now();
+	for (i = 0; i < nr_files; i++) {
+		fd = open(files[i], flags);
+		if (fd < 0)
+			err(1, "open %s", files[i]);
+
+		while ((ret = read(fd, buf, bs)) > 0)
+			total += ret;
+		if (ret < 0)
+			err(1, "read %s", files[i]);
+
+		close(fd);
+	}
+	printf("read_mbps %.1f\n", (total / (double)(1 << 20)) / (now() - start));
+
+	free(buf);
+	return 0;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static int do_randread(int argc, char **argv)
+{
+	size_t *first_page, nr_pages = 0, page, lo, hi, mid;
+	unsigned long i, ops = 4096;
+	volatile char sink;
+	char **maps;
+	double start, total = 0, *lat;
+	off_t len;
+	int opt, fd, f;
+
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		switch (opt) {
+		case 'n':
+			ops = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			errx(1, "usage: randread [-n OPS] PATH");
+		}
+	}
+	if (optind != argc - 1 || !ops)
+		errx(1, "usage: randread [-n OPS] PATH");
+
+	collect_files(argv[optind]);
+
+	first_page = calloc(nr_files + 1, sizeof(*first_page));
+	maps = calloc(nr_files, sizeof(*maps));
+	lat = calloc(ops, sizeof(*lat));
+	if (!first_page || !maps || !lat)
+		err(1, "calloc");
+
+	/* Mapping is not timed, only the page faults are */
+	for (f = 0; f < nr_files; f++) {
+		fd = open(files[f], O_RDONLY);
+		if (fd < 0)
+			err(1, "open %s", files[f]);
+
+		len = lseek(fd, 0, SEEK_END);
+		first_page[f] = nr_pages;
+		nr_pages += (len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		if (len) {
+			maps[f] = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (maps[f] == MAP_FAILED)
+				err(1, "mmap %s", files[f]);
+		}
+		close(fd);
+	}
+	first_page[nr_files] = nr_pages;
+	if (!nr_pages)
+		errx(1, "no data under %s", argv[optind]);
+
+	for (i = 0; i < ops; i++) {
+		page = rng() % nr_pages;
+
+		/* find the file that holds @page */
+		lo = 0;
+		hi = nr_files;
+		while (hi - lo > 1) {
+			mid = (lo + hi) / 2;
+			if (first_page[mid] <= page)
+				lo = mid;
+			else
+				hi = mid;
+		}
+
+		start = now();
+		sink = maps[lo][(page - first_page[lo]) * BLOCK_SIZE];
+		lat[i] = now() - start;
+		total += lat[i];
+	}
+	(void)sink;
+
+	qsort(lat, ops, sizeof(*lat), cmp_double);
+	printf("randread_iops %.0f\n", ops / total);
+	printf("randread_p50_us %.1f\n", lat[ops / 2] * 1e6);
+	printf("randread_p99_us %.1f\n", lat[ops * 99 / 100] * 1e6);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		errx(1, "usage: %s gen|write|read|randread ...", argv[0]);
+
+	if (!strcmp(argv[1], "gen"))
+		return do_gen(argc - 1, argv + 1);
+	if (!strcmp(argv[1], "write"))
+		return do_write(argc - 1, argv + 1);
+	if (!strcmp(argv[1], "read"))
+		return do_read(argc - 1, argv + 1);
+	if (!strcmp(argv[1], "randread"))
+		return do_randread(argc - 1, argv + 1);
+
+	errx(1, "unknown workload %s", argv[1]);
+}
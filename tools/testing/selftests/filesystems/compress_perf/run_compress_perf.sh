@@ -0,0 +1,270 @@
+#!/bin/bash
+# SPDX-License-Identifier: GPL-2.0
+#
+# Performance regression suite for compressed block devices and read-only
+# filesystems: zram, erofs and squashfs.
+#
+# For every compression algorithm of a backend, a reproducible data set is
+# stored on it and the following workloads are run with cold caches:
+#
+#   write	compression throughput (zram only)
+#   read	sequential read in 1 MiB chunks, i.e. decompression throughput
+#   ra<N>k_read	sequential read in 4 KiB chunks with read_ahead_kb set to
+#		each <N> of $RA_KB, which leaves the I/O size to readahead
+#   randread	random page faults through mmap like an application launch,
+#		as IOPS and p50/p99 fault latency
+#
+# The images and the data set are kept in tmpfs where available so that
+# the backing storage does not skew the results.
+#
+# Every result is printed, and appended to $RESULTS if set, as a line of
+#
+#   <kernel release> <backend> <algorithm> <metric> <value>
+#
+# If $BASELINE names the results of an earlier run, every metric is compared
+# to it and the test fails if one regressed by more than $THRESHOLD percent.
+# Metrics ending in _us are latencies where lower is better, higher is better
+# for all others.
+#
+# Tunables: DATA_MB (size of the data set, 64), RA_KB ("128 1024"),
+# THRESHOLD (20), ZRAM_ALGS (all that zram offers), EROFS_ALGS
+# ("none lz4 lz4hc lzma") and SQUASHFS_ALGS ("gzip lzo lz4 xz zstd").
+
+# Kselftest framework requirement - SKIP code is 4.
+ksft_skip=4
+
+DIR=$(dirname "$(readlink -f "$0")")
+PERF=$DIR/compress_perf
+
+DATA_MB=${DATA_MB:-64}
+RA_KB=${RA_KB:-"128 1024"}
+THRESHOLD=${THRESHOLD:-20}
+EROFS_ALGS=${EROFS_ALGS:-"none lz4 lz4hc lzma"}
+SQUASHFS_ALGS=${SQUASHFS_ALGS:-"gzip lzo lz4 xz zstd"}
+KERNEL=$(uname -r)
+
+ret=0
+tested=0
+LOOP=
+ZRAM=
+
+if [ $UID != 0 ]; then
+	echo "skip all tests: must be run as root" >&2
+	exit $ksft_skip
+fi
+
+if [ ! -x "$PERF" ]; then
+	echo "skip all tests: $PERF is not built" >&2
+	exit $ksft_skip
+fi
+
+if [ -d /dev/shm ]; then
+	WORK=$(mktemp -d /dev/shm/compress_perf.XXXXXX)
+else
+	WORK=$(mktemp -d)
+fi
+MNT=$WORK/mnt
+mkdir $MNT $WORK/src
+
+cleanup()
+{
+	mountpoint -q $MNT && umount $MNT
+	[ -n "$LOOP" ] && losetup -d $LOOP
+	[ -n "$ZRAM" ] && echo $ZRAM > /sys/class/zram-control/hot_remove
+	rm -rf $WORK
+}
+trap cleanup EXIT
+
+drop_caches()
+{
+	sync
+	echo 3 > /proc/sys/vm/drop_caches
+}
+
+# compare <backend> <algorithm> <metric> <value>
+compare()
+{
+	local old lower=0
+
+	[ -z "$BASELINE" ] && return
+	old=$(awk -v b=$1 -v a=$2 -v m=$3 \
+		'$2 == b && $3 == a && $4 == m { v = $5 } END { print v }' \
+		"$BASELINE")
+	[ -z "$old" ] && return
+
+	[[ $3 == *_us ]] && lower=1
+	if awk -v old=$old -v new=$4 -v lower=$lower -v t=$THRESHOLD \
+		'BEGIN { d = lower ? new - old : old - new; exit !(d * 100 > old * t) }'; then
+		echo "not ok: $1 $2 $3 regressed from $old to $4" >&2
+		ret=1
+	fi
+}
+
+# record <backend> <algorithm> <metric> <value>
+record()
+{
+	local line="$KERNEL $1 $2 $PREFIX$3 $4"
+
+	echo "$line"
+	[ -n "$RESULTS" ] && echo "$line" >> "$RESULTS"
+	compare $1 $2 $PREFIX$3 $4
+}
+
+# measure <backend> <algorithm> <compress_perf arguments>...
+measure()
+{
+	local backend=$1 alg=$2 out metric value
+	shift 2
+
+	if ! out=$("$PERF" "$@"); then
+		echo "not ok: $backend $alg: compress_perf $* failed" >&2
+		ret=1
+		return
+	fi
+
+	while read -r metric value; do
+		record $backend $alg $metric $value
+	done <<< "$out"
+}
+
+# ratio <backend> <algorithm> <uncompressed bytes> <compressed bytes>
+ratio()
+{
+	[ "$4" -gt 0 ] || return
+	record $1 $2 ratio $(awk -v u=$3 -v c=$4 'BEGIN { printf "%.2f", u / c }')
+}
+
+# run_reads <backend> <algorithm> <path> <block device> [read options]
+run_reads()
+{
+	local backend=$1 alg=$2 path=$3 bdev=$4 opts=$5 ra old_ra
+
+	drop_caches
+	measure $backend $alg read $opts $path
+
+	old_ra=$(blockdev --getra $bdev)
+	for ra in $RA_KB; do
+		blockdev --setra $((ra * 2)) $bdev
+		drop_caches
+		PREFIX=ra${ra}k_ measure $backend $alg read -b 4096 $path
+	done
+	blockdev --setra $old_ra $bdev
+
+	drop_caches
+	measure $backend $alg randread $path
+}
+
+test_zram()
+{
+	local sys dev alg algs orig compr
+
+	[ -e /sys/class/zram-control ] || modprobe zram num_devices=0 2>/dev/null
+	if [ ! -e /sys/class/zram-control/hot_add ]; then
+		echo "skip zram: zram-control is not available" >&2
+		return
+	fi
+
+	ZRAM=$(cat /sys/class/zram-control/hot_add)
+	sys=/sys/block/zram$ZRAM
+	dev=/dev/zram$ZRAM
+	algs=${ZRAM_ALGS:-$(sed 's/[][]//g' $sys/comp_algorithm)}
+
+	for alg in $algs; do
+		echo 1 > $sys/reset
+		if ! echo $alg > $sys/comp_algorithm 2>/dev/null; then
+			echo "skip zram $alg: not supported" >&2
+			continue
+		fi
+		echo ${DATA_MB}M > $sys/disksize
+
+		measure zram $alg write $dev $DATA_MB
+		read -r orig compr _ < $sys/mm_stat
+		ratio zram $alg $orig $compr
+		run_reads zram $alg $dev $dev -d
+		tested=$((tested + 1))
+	done
+
+	echo 1 > $sys/reset
+	echo $ZRAM > /sys/class/zram-control/hot_remove
+	ZRAM=
+}
+
+# test_image <fs> <algorithm> <mkfs command>...: builds $WORK/img and runs
+# the read workloads on it
+test_image()
+{
+	local fs=$1 alg=$2
+	shift 2
+
+	rm -f $WORK/img
+	if ! "$@" > /dev/null 2>&1; then
+		echo "skip $fs $alg: cannot create the image" >&2
+		return
+	fi
+
+	LOOP=$(losetup -f -r --show $WORK/img)
+	if [ -z "$LOOP" ] || ! mount -t $fs -o ro $LOOP $MNT; then
+		echo "skip $fs $alg: cannot mount the image" >&2
+		[ -n "$LOOP" ] && losetup -d $LOOP
+		LOOP=
+		return
+	fi
+
+	ratio $fs $alg $SRC_BYTES $(stat -c %s $WORK/img)
+	run_reads $fs $alg $MNT $LOOP
+	tested=$((tested + 1))
+
+	umount $MNT
+	losetup -d $LOOP
+	LOOP=
+}
+
+test_erofs()
+{
+	local alg
+
+	if ! command -v mkfs.erofs > /dev/null; then
+		echo "skip erofs: mkfs.erofs is not installed" >&2
+		return
+	fi
+
+	for alg in $EROFS_ALGS; do
+		if [ $alg = none ]; then
+			test_image erofs $alg mkfs.erofs $WORK/img $WORK/src
+		else
+			test_image erofs $alg mkfs.erofs -z$alg $WORK/img $WORK/src
+		fi
+	done
+}
+
+test_squashfs()
+{
+	local alg
+
+	if ! command -v mksquashfs > /dev/null; then
+		echo "skip squashfs: mksquashfs is not installed" >&2
+		return
+	fi
+
+	for alg in $SQUASHFS_ALGS; do
+		test_image squashfs $alg mksquashfs $WORK/src $WORK/img \
+			-comp $alg -noappend -no-progress
+	done
+}
+
+if ! "$PERF" gen $WORK/src $DATA_MB > /dev/null; then
+	echo "skip all tests: cannot generate the data set" >&2
+	exit $ksft_skip
+fi
+SRC_BYTES=$(du -sb $WORK/src | cut -f1)
+
+test_zram
+test_erofs
+test_squashfs
+
+if [ $tested = 0 ]; then
+	echo "skip all tests: no backend could be tested" >&2
+	exit $ksft_skip
+fi
+
+exit $ret
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * futex_wakev() and futex_requeuev() tests
+ */
+
+#include <errno.h>
+#include <error.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdint.h>
+#include "futextest.h"
+#include "futex2test.h"
+#include "logging.h"
+
+#define TEST_NAME "futex-wakev"
+#define timeout_ns  30000000
+#define WAKE_WAIT_US 10000
+#define NR_FUTEXES 8
+
+static struct futex_waitv futexv[NR_FUTEXES];
+static futex_t futexes[NR_FUTEXES];
+
+void usage(char *prog)
+{
+	printf("Usage: %s\n", prog);
+	printf("  -c	Use color\n");
+	printf("  -h	Display this help message\n");
+	printf("  -v L	Verbosity level: %d=QUIET %d=CRITICAL %d=INFO\n",
+	       VQUIET, VCRITICAL, VINFO);
+}
+
+void *waiterfn(void *arg)
+{
+	futex_t *f = arg;
+	struct timespec to;
+
+	to.tv_sec = 0;
+	to.tv_nsec = timeout_ns;
+
+	if (futex_wait(f, *f, &to, FUTEX_PRIVATE_FLAG))
+		printf("waiter failed errno %d\n", errno);
+
+	return NULL;
+}
+
+static void init_futexv(void)
+{
+	int i;
+
+	for (i = 0; i < NR_FUTEXES; i++) {
+		futexes[i] = 0;
+		futexv[i].uaddr = (uintptr_t)&futexes[i];
+		futexv[i].flags = FUTEX_32 | FUTEX_PRIVATE_FLAG;
+		futexv[i].val = 1;
+		futexv[i].__reserved = 0;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t waiter[NR_FUTEXES];
+	int res, ret = RET_PASS;
+	int c, i;
+
+	while ((c = getopt(argc, argv, "cht:v:")) != -1) {
+		switch (c) {
+		case 'c':
+			log_color(1);
+			break;
+		case 'h':
+			usage(basename(argv[0]));
+			exit(0);
+		case 'v':
+			log_verbosity(atoi(optarg));
+			break;
+		default:
+			usage(basename(argv[0]));
+			exit(1);
+		}
+	}
+
+	ksft_print_header();
+	ksft_set_plan(4);
+	ksft_print_msg("%s: Test FUTEX_WAKEV and FUTEX_REQUEUEV\n",
+		       basename(argv[0]));
+
+	/* Wake one waiter on each of the futexes */
+	init_futexv();
+	for (i = 0; i < NR_FUTEXES; i++) {
+		if (pthread_create(&waiter[i], NULL, waiterfn, (void *)&futexes[i]))
+			error("pthread_create failed\n", errno);
+	}
+
+	usleep(WAKE_WAIT_US);
+
+	res = futex_wakev(futexv, NR_FUTEXES, 0);
+	if (res != NR_FUTEXES) {
+		ksft_test_result_fail("futex_wakev returned: %d %s\n",
+				      res < 0 ? errno : res,
+				      res < 0 ? strerror(errno) : "");
+		ret = RET_FAIL;
+	} else {
+		ksft_test_result_pass("futex_wakev\n");
+	}
+
+	for (i = 0; i < NR_FUTEXES; i++)
+		pthread_join(waiter[i], NULL);
+
+	/* Requeue two waiters of futexes[0] to futexes[1] and futexes[2] */
+	init_futexv();
+	for (i = 0; i < 2; i++) {
+		if (pthread_create(&waiter[i], NULL, waiterfn, (void *)&futexes[0]))
+			error("pthread_create failed\n", errno);
+	}
+
+	usleep(WAKE_WAIT_US);
+
+	futexv[0].val = 0;
+	res = futex_requeuev(futexv, 3, 0, 0);
+	if (res != 2) {
+		ksft_test_result_fail("futex_requeuev returned: %d %s\n",
+				      res < 0 ? errno : res,
+				      res < 0 ? strerror(errno) : "");
+		ret = RET_FAIL;
+	} else {
+		ksft_test_result_pass("futex_requeuev\n");
+	}
+
+	res = futex_wakev(&futexv[1], 2, 0);
+	if (res != 2) {
+		ksft_test_result_fail("futex_wakev after requeue returned: %d %s\n",
+				      res < 0 ? errno : res,
+				      res < 0 ? strerror(errno) : "");
+		ret = RET_FAIL;
+	} else {
+		ksft_test_result_pass("futex_wakev requeued waiters\n");
+	}
+
+	for (i = 0; i < 2; i++)
+		pthread_join(waiter[i], NULL);
+
+	/* Testing a waker without FUTEX_32 flag */
+	init_futexv();
+	futexv[0].flags = FUTEX_PRIVATE_FLAG;
+
+	res = futex_wakev(futexv, NR_FUTEXES, 0);
+	if (res >= 0 || errno != EINVAL) {
+		ksft_test_result_fail("futex_wakev without FUTEX_32 returned: %d %s\n",
+				      res < 0 ? errno : res,
+				      res < 0 ? strerror(errno) : "");
+		ret = RET_FAIL;
+	} else {
+		ksft_test_result_pass("futex_wakev without FUTEX_32\n");
+	}
+
+	ksft_print_cnts();
+	return ret;
+}
@@ -20,3 +20,37 @@ static inline int futex_waitv(volatile struct futex_waitv *waiters, unsigned lon
 {
 	return syscall(__NR_futex_waitv, waiters, nr_waiters, flags, timo, clockid);
 }
+
+#ifndef __NR_futex_wakev
+#define __NR_futex_wakev 451
+#endif
+
+#ifndef __NR_futex_requeuev
+#define __NR_futex_requeuev 452
+#endif
+
+/**
+ * futex_wakev - Wake waiters at multiple futexes
+ * @wakers:    Array of futexes, with the number of waiters to wake in val
+ * @nr_wakers: Length of wakers array
+ * @flags: Operation flags
+ */
+static inline int futex_wakev(volatile struct futex_waitv *wakers, unsigned long nr_wakers,
+			      unsigned long flags)
+{
+	return syscall(__NR_futex_wakev, wakers, nr_wakers, flags);
+}
+
+/**
+ * futex_requeuev - Wake and requeue waiters of a futex to multiple futexes
+ * @waiters:    Source futex with its expected value, followed by the targets
+ *		with the number of waiters to requeue to each in val
+ * @nr_waiters: Length of waiters array
+ * @flags: Operation flags
+ * @nr_wake: Number of waiters to wake on the source futex
+ */
+static inline int futex_requeuev(volatile struct futex_waitv *waiters, unsigned long nr_waiters,
+				 unsigned long flags, int nr_wake)
+{
+	return syscall(__NR_futex_requeuev, waiters, nr_waiters, flags, nr_wake);
+}
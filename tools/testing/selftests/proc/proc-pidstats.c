@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Test that /proc/pidstats reports the calling process, honours the file
+ * position as the pid to continue from, and only returns whole records.
+ */
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <linux/proc_pidstats.h>
+
+#include "proc.h"
+
+int main(void)
+{
+	static char buf[64 * 1024];
+	struct proc_pidstats *st;
+	char comm[16];
+	pid_t pid;
+	ssize_t rv;
+	int fd;
+
+	fd = open("/proc/pidstats", O_RDONLY);
+	if (fd == -1) {
+		if (errno == ENOENT)
+			return 4;
+		return 1;
+	}
+
+	/* A buffer too small for a single record is rejected. */
+	rv = read(fd, buf, sizeof(*st) - 1);
+	assert(rv == -1 && errno == EINVAL);
+
+	pid = sys_getpid();
+	assert(prctl(PR_GET_NAME, comm) == 0);
+
+	assert(lseek(fd, pid, SEEK_SET) == pid);
+	rv = read(fd, buf, sizeof(buf));
+	assert(rv >= (ssize_t)sizeof(*st));
+
+	st = (struct proc_pidstats *)buf;
+	assert(st->size >= sizeof(*st));
+	assert(rv % st->size == 0);
+	assert(st->pid == pid);
+	assert(st->ppid == getppid());
+	assert(st->uid == getuid());
+	assert(st->num_threads == 1);
+	assert(st->state == 'R');
+	assert(st->vsize != 0);
+	assert(st->rss_anon + st->rss_file != 0);
+	assert(strncmp(st->comm, comm, sizeof(st->comm)) == 0);
+
+	/* Records come in increasing pid order. */
+	for (char *p = buf + st->size; p < buf + rv; p += st->size) {
+		struct proc_pidstats *next = (struct proc_pidstats *)p;
+
+		assert(next->pid > st->pid);
+		st = next;
+	}
+
+	return 0;
+}